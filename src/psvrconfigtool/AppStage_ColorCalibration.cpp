@@ -57,10 +57,11 @@ public:
         , gsUpperBuffer(nullptr)
         , maskedBuffer(nullptr)
     {
-        PSVRVector2f screenSize;
-        PSVR_GetTrackerScreenSize(trackerView->tracker_info.tracker_id, &screenSize);
-        const int frameWidth = static_cast<int>(screenSize.x);
-        const int frameHeight = static_cast<int>(screenSize.y);
+        // The service may downscale the preview video frames
+        PSVRVector2f frameSize;
+        PSVR_GetTrackerVideoFrameSize(trackerView->tracker_info.tracker_id, &frameSize);
+        const int frameWidth = static_cast<int>(frameSize.x);
+        const int frameHeight = static_cast<int>(frameSize.y);
 
         // Create a texture to render the video frame to
         videoTexture = new TextureAsset();
@@ -223,10 +224,10 @@ void AppStage_ColorCalibration::update()
         const unsigned char *video_buffer= nullptr;
         if (PSVR_GetTrackerVideoFrameBuffer(m_trackerView->tracker_info.tracker_id, PSVRVideoFrameSection_Primary, &video_buffer) == PSVRResult_Success)
         {
-            PSVRVector2f screenSize;
-            PSVR_GetTrackerScreenSize(m_trackerView->tracker_info.tracker_id, &screenSize);
-            const unsigned int frameWidth = static_cast<unsigned int>(screenSize.x);
-            const unsigned int frameHeight = static_cast<unsigned int>(screenSize.y);
+            PSVRVector2f frameSize;
+            PSVR_GetTrackerVideoFrameSize(m_trackerView->tracker_info.tracker_id, &frameSize);
+            const unsigned int frameWidth = static_cast<unsigned int>(frameSize.x);
+            const unsigned int frameHeight = static_cast<unsigned int>(frameSize.y);
             const unsigned char *display_buffer = video_buffer;
             const PSVR_HSVColorRange &preset = getColorPreset();
 
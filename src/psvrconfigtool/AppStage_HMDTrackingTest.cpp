@@ -914,10 +914,11 @@ void AppStage_HMDTrackingTest::handle_tracker_start_stream_response(
     // Open the shared memory that the video stream is being written to
     if (PSVR_OpenTrackerVideoStream(tracker_id) == PSVRResult_Success)
     {
-        PSVRVector2f screenSize;
-        PSVR_GetTrackerScreenSize(tracker_id, &screenSize);
-        const unsigned int frameWidth = static_cast<unsigned int>(screenSize.x);
-        const unsigned int frameHeight = static_cast<unsigned int>(screenSize.y);
+        // The service may downscale the preview video frames
+        PSVRVector2f frameSize;
+        PSVR_GetTrackerVideoFrameSize(tracker_id, &frameSize);
+        const unsigned int frameWidth = static_cast<unsigned int>(frameSize.x);
+        const unsigned int frameHeight = static_cast<unsigned int>(frameSize.y);
 
         // Create a texture to render the video frame to
         m_textureAsset[0] = new TextureAsset();
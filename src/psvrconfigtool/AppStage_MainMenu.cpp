@@ -2,6 +2,7 @@
 #include "AppStage_MainMenu.h"
 #include "AppStage_TrackerSettings.h"
 #include "AppStage_HMDSettings.h"
+#include "AppStage_PipelineStatistics.h"
 #include "App.h"
 #include "Camera.h"
 #include "Renderer.h"
@@ -51,6 +52,11 @@ void AppStage_MainMenu::renderUI()
         {
             m_app->setAppStage(AppStage_TrackerSettings::APP_STAGE_NAME);
         }
+
+        if (ImGui::Button("Pipeline Statistics"))
+        {
+            m_app->setAppStage(AppStage_PipelineStatistics::APP_STAGE_NAME);
+        }
     
         if (ImGui::Button("Exit"))
         {
@@ -0,0 +1,291 @@
+//-- inludes -----
+#include "AppStage_PipelineStatistics.h"
+#include "AppStage_MainMenu.h"
+#include "App.h"
+#include "Camera.h"
+#include "UIConstants.h"
+
+#include <imgui.h>
+#include <stdio.h>
+
+#ifdef _MSC_VER
+#pragma warning (disable: 4996) // 'This function or variable may be unsafe': snprintf
+#define snprintf _snprintf
+#endif
+
+//-- statics ----
+const char *AppStage_PipelineStatistics::APP_STAGE_NAME= "PipelineStatistics";
+
+//-- constants -----
+static const float k_statistics_refresh_interval_seconds = 0.5f;
+static const char *k_timeline_trace_path = "psvr_timeline_trace.json";
+
+static const char *k_tracker_stage_names[PSVRTrackerStage_COUNT] = {
+    "USB Packet", "Frame Assembly", "Debayer", "Segmentation", "Solve", "Publish"
+};
+static const char *k_hmd_stage_names[PSVRHmdStage_COUNT] = {
+    "Shape Solve", "Filter Enqueue", "Filter Update", "Publish"
+};
+
+//-- private methods -----
+static void render_latency_table(const char *table_id, const char **stage_names, const PSVRLatencyStatistics *stage_latency, int stage_count);
+
+//-- public methods -----
+AppStage_PipelineStatistics::AppStage_PipelineStatistics(App *app)
+    : AppStage(app)
+    , m_bFailedListRequest(false)
+    , m_bIsTimelineTraceRecording(false)
+    , m_timelineTraceStatus("")
+{ }
+
+void AppStage_PipelineStatistics::enter()
+{
+    m_app->setCameraType(_cameraFixed);
+
+    request_device_lists();
+}
+
+void AppStage_PipelineStatistics::exit()
+{
+    m_trackerEntries.clear();
+    m_hmdEntries.clear();
+}
+
+void AppStage_PipelineStatistics::update()
+{
+    std::chrono::time_point<std::chrono::high_resolution_clock> now = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<float, std::milli> refresh_age = now - m_lastRefreshTime;
+
+    if (refresh_age.count() >= k_statistics_refresh_interval_seconds * 1000.f)
+    {
+        refresh_statistics();
+    }
+}
+
+void AppStage_PipelineStatistics::renderUI()
+{
+    const char *k_window_title = "Pipeline Statistics";
+    const ImGuiWindowFlags window_flags =
+        ImGuiWindowFlags_ShowBorders |
+        ImGuiWindowFlags_NoResize |
+        ImGuiWindowFlags_NoMove |
+        ImGuiWindowFlags_NoCollapse;
+
+    ImGui::SetNextWindowPosCenter();
+    ImGui::SetNextWindowSize(ImVec2(550, 600));
+    ImGui::Begin(k_window_title, nullptr, window_flags);
+
+    if (m_bFailedListRequest)
+    {
+        ImGui::Text("Failed to get device lists!");
+
+        if (ImGui::Button("Retry"))
+        {
+            request_device_lists();
+        }
+    }
+    else
+    {
+        ImGui::TextWrapped("Latencies in milliseconds since the service started.");
+
+        for (const TrackerEntry &entry : m_trackerEntries)
+        {
+            char header[32];
+            snprintf(header, sizeof(header), "Tracker %d", entry.tracker_id);
+
+            ImGui::Separator();
+            ImGui::Text("%s", header);
+
+            if (entry.bHasStatistics)
+            {
+                render_latency_table(header, k_tracker_stage_names, entry.statistics.stage_latency, PSVRTrackerStage_COUNT);
+
+                ImGui::BulletText("Device Frames: %llu (%llu dropped, %llu overwritten)",
+                    entry.statistics.device_frame_count, entry.statistics.device_dropped_frame_count,
+                    entry.statistics.device_overwritten_frame_count);
+                ImGui::BulletText("Processed Frames: %llu (%llu dropped)",
+                    entry.statistics.processed_frame_count, entry.statistics.pipeline_dropped_frame_count);
+            }
+            else
+            {
+                ImGui::Text("Statistics unavailable");
+            }
+        }
+
+        for (const HmdEntry &entry : m_hmdEntries)
+        {
+            char header[32];
+            snprintf(header, sizeof(header), "HMD %d", entry.hmd_id);
+
+            ImGui::Separator();
+            ImGui::Text("%s", header);
+
+            if (entry.bHasStatistics)
+            {
+                render_latency_table(header, k_hmd_stage_names, entry.statistics.stage_latency, PSVRHmdStage_COUNT);
+
+                ImGui::BulletText("Filter Packets: %llu", entry.statistics.filter_packet_count);
+                ImGui::BulletText("Trimmed: %llu, Rewound: %llu, Late: %llu",
+                    entry.statistics.trimmed_filter_packet_count,
+                    entry.statistics.rewound_filter_packet_count,
+                    entry.statistics.late_filter_packet_count);
+                ImGui::BulletText("IMU to Pose: p50 %.2f, p99 %.2f, max %.2f",
+                    entry.motion_to_pose_latency.imu_to_pose.p50_ms,
+                    entry.motion_to_pose_latency.imu_to_pose.p99_ms,
+                    entry.motion_to_pose_latency.imu_to_pose.max_ms);
+                ImGui::BulletText("Optical to Pose: p50 %.2f, p99 %.2f, max %.2f",
+                    entry.motion_to_pose_latency.optical_to_pose.p50_ms,
+                    entry.motion_to_pose_latency.optical_to_pose.p99_ms,
+                    entry.motion_to_pose_latency.optical_to_pose.max_ms);
+            }
+            else
+            {
+                ImGui::Text("Statistics unavailable");
+            }
+        }
+
+        if (m_trackerEntries.size() == 0 && m_hmdEntries.size() == 0)
+        {
+            ImGui::Text("No trackers or HMDs");
+        }
+    }
+
+    ImGui::Separator();
+    if (!m_bIsTimelineTraceRecording)
+    {
+        if (ImGui::Button("Start Timeline Trace"))
+        {
+            if (PSVR_StartTimelineTrace() == PSVRResult_Success)
+            {
+                m_bIsTimelineTraceRecording = true;
+                m_timelineTraceStatus = "Recording...";
+            }
+            else
+            {
+                m_timelineTraceStatus = "Service built without timeline tracing";
+            }
+        }
+    }
+    else
+    {
+        if (ImGui::Button("Stop and Save Timeline Trace"))
+        {
+            m_bIsTimelineTraceRecording = false;
+            m_timelineTraceStatus =
+                (PSVR_StopTimelineTrace(k_timeline_trace_path) == PSVRResult_Success)
+                ? "Saved to psvr_timeline_trace.json"
+                : "Failed to save the timeline trace";
+        }
+    }
+    ImGui::SameLine();
+    ImGui::Text("%s", m_timelineTraceStatus);
+
+    if (ImGui::Button("Return to Main Menu"))
+    {
+        m_app->setAppStage(AppStage_MainMenu::APP_STAGE_NAME);
+    }
+
+    ImGui::End();
+}
+
+//-- protected methods -----
+bool AppStage_PipelineStatistics::onClientAPIEvent(
+    PSVREventType event_type)
+{
+    bool bHandled = false;
+
+    switch (event_type)
+    {
+    case PSVREvent_trackerListUpdated:
+    case PSVREvent_hmdListUpdated:
+        {
+            bHandled = true;
+            request_device_lists();
+        } break;
+    }
+
+    return bHandled;
+}
+
+void AppStage_PipelineStatistics::request_device_lists()
+{
+    m_trackerEntries.clear();
+    m_hmdEntries.clear();
+    m_bFailedListRequest = false;
+
+    PSVRTrackerList tracker_list;
+    PSVRHmdList hmd_list;
+    if (PSVR_GetTrackerList(&tracker_list) == PSVRResult_Success &&
+        PSVR_GetHmdList(&hmd_list) == PSVRResult_Success)
+    {
+        for (int tracker_index = 0; tracker_index < tracker_list.count; ++tracker_index)
+        {
+            TrackerEntry entry;
+            entry.tracker_id = tracker_list.trackers[tracker_index].tracker_id;
+            entry.bHasStatistics = false;
+            m_trackerEntries.push_back(entry);
+        }
+
+        for (int hmd_index = 0; hmd_index < hmd_list.count; ++hmd_index)
+        {
+            HmdEntry entry;
+            entry.hmd_id = hmd_list.hmds[hmd_index].hmd_id;
+            entry.bHasStatistics = false;
+            m_hmdEntries.push_back(entry);
+        }
+
+        refresh_statistics();
+    }
+    else
+    {
+        m_bFailedListRequest = true;
+    }
+}
+
+void AppStage_PipelineStatistics::refresh_statistics()
+{
+    for (TrackerEntry &entry : m_trackerEntries)
+    {
+        entry.bHasStatistics =
+            PSVR_GetTrackerStatistics(entry.tracker_id, &entry.statistics) == PSVRResult_Success;
+    }
+
+    for (HmdEntry &entry : m_hmdEntries)
+    {
+        entry.bHasStatistics =
+            PSVR_GetHmdStatistics(entry.hmd_id, &entry.statistics) == PSVRResult_Success &&
+            PSVR_GetHmdMotionToPoseLatency(entry.hmd_id, &entry.motion_to_pose_latency) == PSVRResult_Success;
+    }
+
+    m_lastRefreshTime = std::chrono::high_resolution_clock::now();
+}
+
+//-- private methods -----
+static void render_latency_table(
+    const char *table_id,
+    const char **stage_names,
+    const PSVRLatencyStatistics *stage_latency,
+    int stage_count)
+{
+    ImGui::Columns(5, table_id);
+    ImGui::Text("Stage"); ImGui::NextColumn();
+    ImGui::Text("Samples"); ImGui::NextColumn();
+    ImGui::Text("p50"); ImGui::NextColumn();
+    ImGui::Text("p99"); ImGui::NextColumn();
+    ImGui::Text("Max"); ImGui::NextColumn();
+    ImGui::Separator();
+
+    for (int stage_index = 0; stage_index < stage_count; ++stage_index)
+    {
+        const PSVRLatencyStatistics &latency = stage_latency[stage_index];
+
+        ImGui::Text("%s", stage_names[stage_index]); ImGui::NextColumn();
+        ImGui::Text("%llu", latency.sample_count); ImGui::NextColumn();
+        ImGui::Text("%.2f", latency.p50_ms); ImGui::NextColumn();
+        ImGui::Text("%.2f", latency.p99_ms); ImGui::NextColumn();
+        ImGui::Text("%.2f", latency.max_ms); ImGui::NextColumn();
+    }
+
+    ImGui::Columns(1);
+    ImGui::Separator();
+}
@@ -0,0 +1,53 @@
+#ifndef APP_STAGE_PIPELINE_STATISTICS_H
+#define APP_STAGE_PIPELINE_STATISTICS_H
+
+//-- includes -----
+#include "AppStage.h"
+#include <chrono>
+#include <vector>
+
+//-- definitions -----
+class AppStage_PipelineStatistics : public AppStage
+{
+public:
+    AppStage_PipelineStatistics(class App *app);
+
+    virtual void enter() override;
+    virtual void exit() override;
+    virtual void update() override;
+
+    virtual void renderUI() override;
+
+    static const char *APP_STAGE_NAME;
+
+protected:
+    virtual bool onClientAPIEvent(PSVREventType event_type) override;
+
+    void request_device_lists();
+    void refresh_statistics();
+
+private:
+    struct TrackerEntry
+    {
+        PSVRTrackerID tracker_id;
+        PSVRTrackerStatistics statistics;
+        bool bHasStatistics;
+    };
+
+    struct HmdEntry
+    {
+        PSVRHmdID hmd_id;
+        PSVRHmdStatistics statistics;
+        PSVRHmdMotionToPoseLatency motion_to_pose_latency;
+        bool bHasStatistics;
+    };
+
+    std::vector<TrackerEntry> m_trackerEntries;
+    std::vector<HmdEntry> m_hmdEntries;
+    std::chrono::time_point<std::chrono::high_resolution_clock> m_lastRefreshTime;
+    bool m_bFailedListRequest;
+    bool m_bIsTimelineTraceRecording;
+    const char *m_timelineTraceStatus;
+};
+
+#endif // APP_STAGE_PIPELINE_STATISTICS_H
@@ -1576,8 +1576,13 @@ void AppStage_StereoCalibration::handle_tracker_start_stream_response()
 {
     m_bStreamIsActive = true;
 
-    // Open the shared memory that the video stream is being written to
-    if (PSVR_OpenTrackerVideoStream(m_tracker_view->tracker_info.tracker_id) == PSVRResult_Success)
+    // Open the shared memory that the video stream is being written to.
+    // Calibration needs full size video frames (i.e. the service isn't downscaling its preview).
+    PSVRVector2f screenSize, frameSize;
+    if (PSVR_OpenTrackerVideoStream(m_tracker_view->tracker_info.tracker_id) == PSVRResult_Success &&
+        PSVR_GetTrackerScreenSize(m_tracker_view->tracker_info.tracker_id, &screenSize) == PSVRResult_Success &&
+        PSVR_GetTrackerVideoFrameSize(m_tracker_view->tracker_info.tracker_id, &frameSize) == PSVRResult_Success &&
+        screenSize.x == frameSize.x && screenSize.y == frameSize.y)
     {
         m_opencv_stereo_state->allocateVideoTextures(m_bypassCalibrationFlag);
 
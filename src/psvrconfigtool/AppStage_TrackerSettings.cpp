@@ -214,6 +214,14 @@ void AppStage_TrackerSettings::renderUI()
                 {
                     ImGui::BulletText("USB Driver Type: WMF");
                 } break;
+            case PSVRDriver_REPLAY:
+                {
+                    ImGui::BulletText("USB Driver Type: REPLAY");
+                } break;
+            case PSVRDriver_SYNTHETIC:
+                {
+                    ImGui::BulletText("USB Driver Type: SYNTHETIC");
+                } break;
             default:
                 assert(0 && "Unreachable");
             }
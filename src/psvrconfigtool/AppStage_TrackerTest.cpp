@@ -245,10 +245,11 @@ void AppStage_TrackerTest::handle_tracker_start_stream_response()
     if (PSVR_OpenTrackerVideoStream(m_tracker_view->tracker_info.tracker_id) == PSVRResult_Success &&
         PSVR_GetTrackerVideoFrameSectionCount(m_tracker_view->tracker_info.tracker_id, &m_section_count) == PSVRResult_Success)
     {
-        PSVRVector2f screenSize;
-        PSVR_GetTrackerScreenSize(m_tracker_view->tracker_info.tracker_id, &screenSize);
-        const unsigned int frameWidth = static_cast<unsigned int>(screenSize.x);
-        const unsigned int frameHeight = static_cast<unsigned int>(screenSize.y);
+        // The service may downscale the preview video frames
+        PSVRVector2f frameSize;
+        PSVR_GetTrackerVideoFrameSize(m_tracker_view->tracker_info.tracker_id, &frameSize);
+        const unsigned int frameWidth = static_cast<unsigned int>(frameSize.x);
+        const unsigned int frameHeight = static_cast<unsigned int>(frameSize.y);
 
         // Create a texture to render the video frame to
         m_video_texture = new TextureAsset();
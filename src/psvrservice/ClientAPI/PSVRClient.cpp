@@ -30,6 +30,9 @@ PSVRClient::PSVRClient()
 	, m_bHasTrackerListChanged(false)
 	, m_bHasHMDListChanged(false)
 {
+	memset(m_trackerVideoFrames, 0, sizeof(m_trackerVideoFrames));
+	memset(m_trackerVideoPropertyApplied, 0, sizeof(m_trackerVideoPropertyApplied));
+	memset(m_bHasTrackerVideoPropertyApplied, 0, sizeof(m_bHasTrackerVideoPropertyApplied));
 }
 
 PSVRClient::~PSVRClient()
@@ -55,6 +58,22 @@ bool PSVRClient::pollHasHMDListChanged()
 	return bHasHMDListChanged; 
 }
 
+bool PSVRClient::pollTrackerVideoPropertyApplied(
+	PSVRTrackerID tracker_id, 
+	PSVRVideoPropertyType property_type, 
+	PSVRVideoPropertyAppliedEvent &out_event)
+{
+	bool bHasApplied= m_bHasTrackerVideoPropertyApplied[tracker_id][property_type];
+
+	if (bHasApplied)
+	{
+		out_event= m_trackerVideoPropertyApplied[tracker_id][property_type];
+		m_bHasTrackerVideoPropertyApplied[tracker_id][property_type]= false;
+	}
+
+	return bHasApplied;
+}
+
 // -- ClientPSVRAPI System -----
 bool PSVRClient::startup(
     PSVRLogSeverityLevel log_level,
@@ -67,6 +86,7 @@ bool PSVRClient::startup(
 	// Reset status flags
 	m_bHasTrackerListChanged= false;
 	m_bHasHMDListChanged= false;
+	memset(m_bHasTrackerVideoPropertyApplied, 0, sizeof(m_bHasTrackerVideoPropertyApplied));
 
 	PSVR_LOG_INFO("PSVRClient") << "Successfully initialized PSVRClient";
 
@@ -188,6 +208,7 @@ bool PSVRClient::open_video_stream(PSVRTrackerID tracker_id)
 			if (m_requestHandler->get_shared_video_frame_buffer(tracker_id, &shared_buffer) == PSVRResult_Success)
 			{				
 				tracker->opaque_shared_video_frame_buffer= shared_buffer;
+				latch_video_frame(tracker_id);
 				bSuccess = true;
 			}
 		}
@@ -213,6 +234,7 @@ void PSVRClient::close_video_stream(PSVRTrackerID tracker_id)
 		PSVRTracker *tracker= &m_trackers[tracker_id];
 
 		tracker->opaque_shared_video_frame_buffer = nullptr;
+		memset(&m_trackerVideoFrames[tracker_id], 0, sizeof(SharedVideoFrameView));
 	}
 }
 
@@ -236,9 +258,9 @@ int PSVRClient::get_video_frame_section_count(PSVRTrackerID tracker_id) const
     return section_count;
 }
 
-const unsigned char *PSVRClient::get_video_frame_buffer(PSVRTrackerID tracker_id, PSVRVideoFrameSection section) const
+bool PSVRClient::get_video_frame_size(PSVRTrackerID tracker_id, int &out_width, int &out_height) const
 {
-	const unsigned char *buffer= nullptr;
+	bool bSuccess= false;
 
 	if (IS_VALID_TRACKER_INDEX(tracker_id))
 	{
@@ -249,7 +271,26 @@ const unsigned char *PSVRClient::get_video_frame_buffer(PSVRTrackerID tracker_id
 			const SharedVideoFrameBuffer *shared_buffer = 
 				reinterpret_cast<const SharedVideoFrameBuffer *>(tracker->opaque_shared_video_frame_buffer);
 
-			buffer= shared_buffer->getBuffer(section);
+			out_width= shared_buffer->getWidth();
+			out_height= shared_buffer->getHeight();
+			bSuccess= true;
+		}
+	}
+
+	return bSuccess;
+}
+
+const unsigned char *PSVRClient::get_video_frame_buffer(PSVRTrackerID tracker_id, PSVRVideoFrameSection section) const
+{
+	const unsigned char *buffer= nullptr;
+
+	if (IS_VALID_TRACKER_INDEX(tracker_id))
+	{
+		const SharedVideoFrameView &video_frame= m_trackerVideoFrames[tracker_id];
+
+		if (section >= 0 && section < video_frame.section_count)
+		{
+			buffer= video_frame.sections[section];
 		}
 	}
 
@@ -320,6 +361,9 @@ void PSVRClient::handle_data_frame(const DeviceOutputDataFrame &data_frame)
 				PSVRTracker *tracker= get_tracker_view(tracker_id);
 
 				applyTrackerDataFrame(tracker_packet, tracker);
+
+				// The service sends a tracker data frame when it publishes a new video frame
+				latch_video_frame(tracker_id);
 			}
         } break;
     case DeviceCategory_HMD:
@@ -386,6 +430,8 @@ static void applyHmdDataFrame(
     hmd->HmdType = hmd_packet.hmd_type;
     hmd->OutputSequenceNum = hmd_packet.output_sequence_num;
     hmd->IsConnected = hmd_packet.is_connected;
+    hmd->IMUSensorAgeMs = hmd_packet.imu_sensor_age_ms;
+    hmd->OpticalSensorAgeMs = hmd_packet.optical_sensor_age_ms;
 
     // Compute the data frame receive window statistics if we have received enough samples
     {
@@ -442,8 +488,40 @@ void PSVRClient::process_event_message(
     case PSVREvent_hmdListUpdated:
         m_bHasHMDListChanged= true;
         break;
+    case PSVREvent_trackerVideoPropertyApplied:
+        {
+            const PSVRVideoPropertyAppliedEvent &applied= event_message->event_payload.video_property_applied;
+
+            if (IS_VALID_TRACKER_INDEX(applied.tracker_id) &&
+                applied.property_type >= 0 && applied.property_type < PSVRVideoProperty_COUNT)
+            {
+                m_trackerVideoPropertyApplied[applied.tracker_id][applied.property_type]= applied;
+                m_bHasTrackerVideoPropertyApplied[applied.tracker_id][applied.property_type]= true;
+            }
+        }
+        break;
     default:
         assert(0 && "unreachable");
         break;
     }
 }
+
+// Video Frame Helpers
+//-----------------
+void PSVRClient::latch_video_frame(PSVRTrackerID tracker_id)
+{
+	const PSVRTracker *tracker= &m_trackers[tracker_id];
+
+	if (tracker->opaque_shared_video_frame_buffer != nullptr)
+	{
+		const SharedVideoFrameBuffer *shared_buffer = 
+			reinterpret_cast<const SharedVideoFrameBuffer *>(tracker->opaque_shared_video_frame_buffer);
+
+		// Keep the last frame if the writer happens to be mid way through the newest slot
+		SharedVideoFrameView video_frame;
+		if (shared_buffer->getLatestVideoFrame(video_frame))
+		{
+			m_trackerVideoFrames[tracker_id]= video_frame;
+		}
+	}
+}
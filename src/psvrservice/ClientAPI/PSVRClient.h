@@ -24,6 +24,8 @@ public:
 	// -- State Queries ----
 	bool pollHasTrackerListChanged();
 	bool pollHasHMDListChanged();
+	bool pollTrackerVideoPropertyApplied(
+		PSVRTrackerID tracker_id, PSVRVideoPropertyType property_type, PSVRVideoPropertyAppliedEvent &out_event);
 
     // -- Client PSVR API System -----
     bool startup(PSVRLogSeverityLevel log_level, class ServiceRequestHandler * request_handler);
@@ -39,6 +41,7 @@ public:
 	bool open_video_stream(PSVRTrackerID tracker_id);
 	void close_video_stream(PSVRTrackerID tracker_id);
     int get_video_frame_section_count(PSVRTrackerID tracker_id) const;
+    bool get_video_frame_size(PSVRTrackerID tracker_id, int &out_width, int &out_height) const;
 	const unsigned char *get_video_frame_buffer(PSVRTrackerID tracker_id, PSVRVideoFrameSection section) const;
 
     bool allocate_hmd_listener(PSVRHmdID HmdID);
@@ -55,6 +58,7 @@ protected:
     // Message Helpers
     //-----------------
 	void process_event_message(const PSVREventMessage *event_message);
+	void latch_video_frame(PSVRTrackerID tracker_id);
 
 private:
     //-- Request Handling -----
@@ -62,12 +66,18 @@ private:
     
     //-- Tracker Views -----
 	PSVRTracker m_trackers[PSVRSERVICE_MAX_TRACKER_COUNT];
+	// The video frame each tracker's buffer queries return until the next tracker data frame,
+	// so that all sections of a stereo frame come from the same frame
+	SharedVideoFrameView m_trackerVideoFrames[PSVRSERVICE_MAX_TRACKER_COUNT];
     
     //-- HMD Views -----
 	PSVRHeadMountedDisplay m_HMDs[PSVRSERVICE_MAX_HMD_COUNT];
 
 	bool m_bHasTrackerListChanged;
 	bool m_bHasHMDListChanged;
+	// Latest applied result of each tracker video property, for clients that don't poll the message queue
+	PSVRVideoPropertyAppliedEvent m_trackerVideoPropertyApplied[PSVRSERVICE_MAX_TRACKER_COUNT][PSVRVideoProperty_COUNT];
+	bool m_bHasTrackerVideoPropertyApplied[PSVRSERVICE_MAX_TRACKER_COUNT][PSVRVideoProperty_COUNT];
 
     //-- Messages -----
     // Queue of message received from the most recent call to update()
@@ -4,6 +4,7 @@
 #include "PSVRService.h"
 #include "ServiceRequestHandler.h"
 #include "Logger.h"
+#include "TimelineTrace.h"
 #include "MathUtility.h"
 
 #include <assert.h>
@@ -39,6 +40,26 @@ bool PSVR_HasHMDListChanged()
 	return g_psvr_client != nullptr && g_psvr_client->pollHasHMDListChanged();
 }
 
+PSVRResult PSVR_PollTrackerVideoPropertyApplied(
+	PSVRTrackerID tracker_id, 
+	PSVRVideoPropertyType property_type, 
+	PSVRVideoPropertyAppliedEvent *out_event)
+{
+	PSVRResult result= PSVRResult_Error;
+	assert(out_event != nullptr);
+
+	if (g_psvr_client != nullptr && IS_VALID_TRACKER_INDEX(tracker_id) &&
+		property_type >= 0 && property_type < PSVRVideoProperty_COUNT)
+	{
+		result= 
+			g_psvr_client->pollTrackerVideoPropertyApplied(tracker_id, property_type, *out_event)
+			? PSVRResult_Success
+			: PSVRResult_NoData;
+	}
+
+	return result;
+}
+
 PSVRResult PSVR_Initialize(PSVRLogSeverityLevel log_level)
 {
 	PSVRResult result= PSVRResult_Success;
@@ -135,18 +156,19 @@ PSVRResult PSVR_Update()
 
 PSVRResult PSVR_UpdateNoPollEvents()
 {
+    PSVR_TRACE_ZONE("PSVR_Update");
+
     PSVRResult result= PSVRResult_Error;
 
-	if (g_psvr_service != nullptr)
+	if (g_psvr_service != nullptr && g_psvr_client != nullptr)
 	{
-		g_psvr_service->update();
+		// Drop the unread messages from the last update first,
+		// otherwise the notifications the service publishes during its update would go with them
+		g_psvr_client->update();
 
-		if (g_psvr_client != nullptr)
-		{
-			g_psvr_client->update();
+		g_psvr_service->update();
 
-			result= PSVRResult_Success;
-		}
+		result= PSVRResult_Success;
 	}	
 
     return result;
@@ -367,6 +389,22 @@ PSVRResult PSVR_GetTrackerVideoFrameSectionCount(PSVRTrackerID tracker_id, int *
     return result;
 }
 
+PSVRResult PSVR_GetTrackerVideoFrameSize(PSVRTrackerID tracker_id, PSVRVector2f *out_frame_size)
+{
+    PSVRResult result= PSVRResult_Error;
+	assert(out_frame_size != nullptr);
+
+	int width, height;
+    if (g_psvr_client != nullptr && g_psvr_client->get_video_frame_size(tracker_id, width, height))
+    {
+        out_frame_size->x= static_cast<float>(width);
+        out_frame_size->y= static_cast<float>(height);
+		result= PSVRResult_Success;
+    }
+
+    return result;
+}
+
 PSVRResult PSVR_GetTrackerMode(PSVRTrackerID tracker_id, char *out_mode, size_t max_mode_name_size)
 {
     PSVRResult result= PSVRResult_Error;
@@ -428,6 +466,18 @@ PSVRResult PSVR_GetTrackerVideoFrameBuffer(PSVRTrackerID tracker_id, PSVRVideoFr
     return result;
 }
 
+PSVRResult PSVR_GetTrackerVideoStreamName(PSVRTrackerID tracker_id, char *out_stream_name, size_t max_stream_name_length)
+{
+    PSVRResult result= PSVRResult_Error;
+
+    if (g_psvr_service != nullptr && IS_VALID_TRACKER_INDEX(tracker_id) && out_stream_name != nullptr)
+    {
+		result= g_psvr_service->getRequestHandler()->get_tracker_video_stream_name(tracker_id, out_stream_name, max_stream_name_length);
+    }
+
+    return result;
+}
+
 PSVRResult PSVR_GetTrackerFrustum(PSVRTrackerID tracker_id, PSVRFrustum *out_frustum)
 {
     PSVRResult result= PSVRResult_Error;
@@ -477,6 +527,18 @@ PSVRResult PSVR_SetTrackerDebugFlags(PSMTrackerDebugFlags debug_flags)
     return result;
 }
 
+PSVRResult PSVR_GetTrackerStatistics(PSVRTrackerID tracker_id, PSVRTrackerStatistics *out_statistics)
+{
+    PSVRResult result= PSVRResult_Error;
+
+    if (g_psvr_service != nullptr && IS_VALID_TRACKER_INDEX(tracker_id) && out_statistics != nullptr)
+    {
+		result= g_psvr_service->getRequestHandler()->get_tracker_statistics(tracker_id, out_statistics);
+	}
+
+    return result;
+}
+
 /// HMD Pool
 PSVRHeadMountedDisplay *PSVR_GetHmd(PSVRHmdID hmd_id)
 {
@@ -577,6 +639,14 @@ PSVRResult PSVR_GetHmdPose(PSVRHmdID hmd_id, PSVRPosef *out_pose)
     if (g_psvr_client != nullptr && IS_VALID_HMD_INDEX(hmd_id))
     {
         PSVRHeadMountedDisplay *hmd= g_psvr_client->get_hmd_view(hmd_id);
+		bool bIsFilteredPoseValid= false;
+
+		// If the service runs the HMD's filter on its own thread, 
+		// read its latest output rather than the state cached at the last PSVR_Update()
+		if (g_psvr_service->getRequestHandler()->get_hmd_filtered_pose(hmd_id, out_pose, &bIsFilteredPoseValid) == PSVRResult_Success)
+		{
+			return bIsFilteredPoseValid ? PSVRResult_Success : PSVRResult_Error;
+		}
         
         switch (hmd->HmdType)
         {
@@ -925,6 +995,30 @@ PSVRResult PSVR_SetHmdTrackingColorID(PSVRHmdID hmd_id, PSVRTrackingColorType tr
     return result;
 }
 
+PSVRResult PSVR_GetHmdStatistics(PSVRHmdID hmd_id, PSVRHmdStatistics *out_statistics)
+{
+    PSVRResult result= PSVRResult_Error;
+
+    if (g_psvr_service != nullptr && IS_VALID_HMD_INDEX(hmd_id) && out_statistics != nullptr)
+    {
+		result= g_psvr_service->getRequestHandler()->get_hmd_statistics(hmd_id, out_statistics);
+    }
+
+    return result;
+}
+
+PSVRResult PSVR_GetHmdMotionToPoseLatency(PSVRHmdID hmd_id, PSVRHmdMotionToPoseLatency *out_latency)
+{
+    PSVRResult result= PSVRResult_Error;
+
+    if (g_psvr_service != nullptr && IS_VALID_HMD_INDEX(hmd_id) && out_latency != nullptr)
+    {
+		result= g_psvr_service->getRequestHandler()->get_hmd_motion_to_pose_latency(hmd_id, out_latency);
+    }
+
+    return result;
+}
+
 PSVRResult PSVR_SetTrackerColorFilter(
     PSVRTrackerID tracker_id, PSVRHmdID hmd_id, PSVRTrackingColorType tracking_color_type,
     PSVR_HSVColorRange *desired_color_filter, PSVR_HSVColorRange *out_color_filter)
@@ -941,4 +1035,52 @@ PSVRResult PSVR_SetTrackerColorFilter(
     }
 
     return result;
-}
\ No newline at end of file
+}
+
+PSVRResult PSVR_StartSessionRecording(const char *path)
+{
+    PSVRResult result= PSVRResult_Error;
+
+    if (g_psvr_service != nullptr && path != nullptr)
+    {
+		result= g_psvr_service->getRequestHandler()->start_session_recording(path);
+    }
+
+    return result;
+}
+
+PSVRResult PSVR_StopSessionRecording()
+{
+    PSVRResult result= PSVRResult_Error;
+
+    if (g_psvr_service != nullptr)
+    {
+		result= g_psvr_service->getRequestHandler()->stop_session_recording();
+    }
+
+    return result;
+}
+
+PSVRResult PSVR_StartTimelineTrace()
+{
+    PSVRResult result= PSVRResult_Error;
+
+    if (g_psvr_service != nullptr)
+    {
+		result= g_psvr_service->getRequestHandler()->start_timeline_trace();
+    }
+
+    return result;
+}
+
+PSVRResult PSVR_StopTimelineTrace(const char *path)
+{
+    PSVRResult result= PSVRResult_Error;
+
+    if (g_psvr_service != nullptr && path != nullptr)
+    {
+		result= g_psvr_service->getRequestHandler()->stop_timeline_trace(path);
+    }
+
+    return result;
+}
@@ -60,7 +60,9 @@ typedef enum
 {
     PSVRDriver_LIBUSB,
 	PSVRDriver_WINUSB,
-    PSVRDriver_WINDOWSMEDIAFRAMEWORK
+    PSVRDriver_WINDOWSMEDIAFRAMEWORK,
+    PSVRDriver_REPLAY,
+    PSVRDriver_SYNTHETIC
 } PSVRTrackerDriver;
 
 /// Tracked device data stream options
@@ -351,6 +353,8 @@ typedef struct
     bool            bValid;
     int             OutputSequenceNum;
     bool            IsConnected;
+    float           IMUSensorAgeMs;         ///< Time from the newest IMU report in the pose arriving to the pose being published (-1 if none)
+    float           OpticalSensorAgeMs;     ///< Time from the newest video frame in the pose being captured to the pose being published (-1 if none)
     long long       DataFrameLastReceivedTime;
     float           DataFrameAverageFPS;
     int             ListenerCount;
@@ -362,14 +366,28 @@ typedef struct
 typedef enum 
 {
     PSVREvent_trackerListUpdated,
-    PSVREvent_hmdListUpdated
+    PSVREvent_hmdListUpdated,
+    PSVREvent_trackerVideoPropertyApplied  ///< See \ref PSVRVideoPropertyAppliedEvent
 } PSVREventType;
 
+/// Sent once a \ref PSVR_SetTrackerVideoProperty change has reached the tracker hardware (or failed to).
+/// Changes made faster than the tracker can apply them are coalesced, so only the latest value of a property is reported.
+typedef struct
+{
+    PSVRTrackerID tracker_id;
+    PSVRVideoPropertyType property_type;
+    int value;                              ///< The value that was written to the tracker
+    bool bSuccess;                          ///< False if the tracker rejected the write
+} PSVRVideoPropertyAppliedEvent;
 
 /// A container for all PSVRService events
 typedef struct
 {
     PSVREventType event_type;
+    union
+    {
+        PSVRVideoPropertyAppliedEvent video_property_applied;  ///< Valid for PSVREvent_trackerVideoPropertyApplied
+    } event_payload;
 } PSVREventMessage;
 
 // Service Responses
@@ -402,6 +420,76 @@ typedef struct
     float global_forward_degrees;
 } PSVRTrackingSpace;
 
+// Pipeline Statistics
+//--------------------
+
+/// Latency distribution of one pipeline stage.
+/// Percentiles are accurate to about 3%.
+typedef struct
+{
+	unsigned long long sample_count;
+	float min_ms;
+	float mean_ms;
+	float p50_ms;
+	float p90_ms;
+	float p99_ms;
+	float p999_ms;
+	float max_ms;
+} PSVRLatencyStatistics;
+
+/// The stages of a tracker's video frame pipeline
+typedef enum
+{
+	PSVRTrackerStage_USBPacket,		///< Time between consecutive USB video transfers (USB camera drivers only)
+	PSVRTrackerStage_FrameAssembly,	///< First to last USB packet of a video frame (USB camera drivers only)
+	PSVRTrackerStage_Debayer,		///< Copying (and debayering) the driver's video frame into the pipeline
+	PSVRTrackerStage_Segmentation,	///< Finding the projection of every tracked HMD in the frame
+	PSVRTrackerStage_Solve,			///< Applying the projections to the HMD shape models and pose filters
+	PSVRTrackerStage_Publish,		///< Copying the frame to the shared memory video stream
+
+	PSVRTrackerStage_COUNT
+} PSVRTrackerStage;
+
+/// Per stage latencies and frame counters of a tracker
+typedef struct
+{
+	PSVRLatencyStatistics stage_latency[PSVRTrackerStage_COUNT];
+	unsigned long long device_frame_count;				///< Complete video frames the camera driver received
+	unsigned long long device_dropped_frame_count;		///< Video frames the camera driver dropped before the tracker saw them
+	unsigned long long device_overwritten_frame_count;	///< Of the dropped video frames, the ones a newer frame replaced before the tracker got to them
+	unsigned long long processed_frame_count;			///< Video frames that made it through the whole pipeline
+	unsigned long long pipeline_dropped_frame_count;	///< Video frames the pipeline stages dropped to catch up
+} PSVRTrackerStatistics;
+
+/// The stages of an HMD's pose filter pipeline
+typedef enum
+{
+	PSVRHmdStage_ShapeSolve,	///< Fitting the HMD shape model to one tracker's projection
+	PSVRHmdStage_FilterEnqueue,	///< Time a sensor packet waits in its queue before the pose filter takes it
+	PSVRHmdStage_FilterUpdate,	///< One pose filter update (every queued sensor packet)
+	PSVRHmdStage_Publish,		///< Sending the filtered pose to the client
+
+	PSVRHmdStage_COUNT
+} PSVRHmdStage;
+
+/// Per stage latencies and pose filter counters of an HMD
+typedef struct
+{
+	PSVRLatencyStatistics stage_latency[PSVRHmdStage_COUNT];
+	unsigned long long filter_packet_count;				///< Sensor packets applied to the pose filter
+	unsigned long long trimmed_filter_packet_count;		///< Oldest sensor packets dropped because the pose filter fell behind
+	unsigned long long rewound_filter_packet_count;		///< Late optical packets applied in time order by rewinding the pose filter
+	unsigned long long late_filter_packet_count;		///< Late optical packets applied out of order
+} PSVRHmdStatistics;
+
+/// End-to-end latency of an HMD's published poses.
+/// Measured from the capture of the newest sensor measurement fused into a pose to the pose being published.
+typedef struct
+{
+	PSVRLatencyStatistics imu_to_pose;		///< From the arrival of the IMU report
+	PSVRLatencyStatistics optical_to_pose;	///< From the completion of the video frame
+} PSVRHmdMotionToPoseLatency;
+
 // Interface
 //----------
 
@@ -433,6 +521,7 @@ PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_Shutdown();
 	  - \ref PSVR_GetIsInitialized()
 	  - \ref PSVR_HasTrackerListChanged()
 	  - \ref PSVR_HasHMDListChanged()
+	  - \ref PSVR_PollTrackerVideoPropertyApplied()
 	  - \ref PSVR_WasSystemButtonPressed()
 	  
 	\return PSVRResult_Success if initialize or PSVRResult_Error otherwise
@@ -472,6 +561,17 @@ PSVR_PUBLIC_FUNCTION(bool) PSVR_HasTrackerListChanged();
  */
 PSVR_PUBLIC_FUNCTION(bool) PSVR_HasHMDListChanged();
 
+/** \brief Get the latest \ref PSVREvent_trackerVideoPropertyApplied result for a tracker video property
+	This result is only filled in when \ref PSVR_Update() is called.
+	If you instead call PSVR_UpdateNoPollEvents() you'll need to process the event queue yourself to get
+	video property applied events.
+	\param tracker_id The id of the tracker
+	\param property_type The video property to check
+	\param[out] out_event The latest result, only written if there is a new one
+	\return PSVRResult_Success if a result came in since the last call, PSVRResult_NoData if not or PSVRResult_Error
+ */
+PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_PollTrackerVideoPropertyApplied(PSVRTrackerID tracker_id, PSVRVideoPropertyType property_type, PSVRVideoPropertyAppliedEvent *out_event);
+
 // System Queries
 /** \brief Get the client API version string from PSVRService
 	\param[out] out_version_string The string buffer to write the version into
@@ -628,11 +728,15 @@ PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_GetTrackerMode(PSVRTrackerID tracker_id, c
 PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_SetTrackerMode(PSVRTrackerID tracker_id, const char *new_mode);
 
 /** \brief Set the video property of the target tracker
+	\remark Doesn't wait on the tracker hardware. The change is queued up and a \ref PSVREvent_trackerVideoPropertyApplied
+	event is sent once it lands, so it's fine to call this every frame (ex: while dragging a slider).
+	\ref PSVR_Update() consumes the event, read the result with \ref PSVR_PollTrackerVideoPropertyApplied() after it.
+	With \ref PSVR_UpdateNoPollEvents() the event is read from the queue with \ref PSVR_PollNextMessage().
 	\param tracker_id The id of the tracker
 	\param property_type The video property to adjust
     \param desired_value The desired value of the video property for the tracker
     \param save_setting If true the desired value is saved to the tracker config
-    \param[out] out_value The actual resulting value applied to the property
+    \param[out] out_value The resulting value of the property (may not be on the tracker hardware yet)
  */
 PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_SetTrackerVideoProperty(PSVRTrackerID tracker_id, PSVRVideoPropertyType property_type, int desired_value, bool save_setting, int *out_value);
 
@@ -644,6 +748,14 @@ PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_SetTrackerVideoProperty(PSVRTrackerID trac
  */
 PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_GetTrackerVideoFrameSectionCount(PSVRTrackerID tracker_id, int *out_section_count); 
 
+/** \brief Get the dimensions of one section of the video frames in an opened tracker video stream
+	\remark This is smaller than \ref PSVR_GetTrackerScreenSize() when the service downscales its preview frames.
+	\param tracker_id The tracker with an open video stream
+	\param[out] out_frame_size The width and height of a video frame section in pixels
+	\return PSVRResult_Success if the tracker has an open video stream
+ */
+PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_GetTrackerVideoFrameSize(PSVRTrackerID tracker_id, PSVRVector2f *out_frame_size);
+
 /** \brief Fetch the next video frame buffer from an opened tracker video stream
 	\remark Make sure the video buffer is large enough to hold tracker dimension x 3 bytes.
 	\param tracker_id The tracker to poll the next video frame from
@@ -653,6 +765,16 @@ PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_GetTrackerVideoFrameSectionCount(PSVRTrack
  */
 PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_GetTrackerVideoFrameBuffer(PSVRTrackerID tracker_id, PSVRVideoFrameSection section_index, const unsigned char **out_buffer); 
 
+/** \brief Get the name of the shared memory region the tracker's video frames are published to
+	\remark Other processes can map the frames with SharedVideoFrameBuffer::open() using this name
+	(the region is named "/psvr_<name>" with shm_open on Linux/OSX and "Local\\psvr_<name>" on Windows).
+	\param tracker_id The id of the tracker
+	\param[out] out_stream_name The buffer to write the stream name into
+	\param max_stream_name_length The size of the out_stream_name buffer
+	\return PSVRResult_Success if the tracker has a video frame buffer and the name fit
+ */
+PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_GetTrackerVideoStreamName(PSVRTrackerID tracker_id, char *out_stream_name, size_t max_stream_name_length);
+
 /** \brief Helper function to fetch tracking frustum properties from a tracker
 	\param The id of the tracker we wish to get the tracking frustum properties for
 	\param out_frustum The tracking frustum properties to write the result into
@@ -672,6 +794,14 @@ PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_GetTrackerDebugFlags(PSMTrackerDebugFlags
  */
 PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_SetTrackerDebugFlags(PSMTrackerDebugFlags debug_flags);
 
+/** \brief Get the per stage latencies and frame counters of the given tracker
+	Counts and latencies accumulate for as long as the service runs (including across reconnects).
+	\param tracker_id The id of the tracker
+	\param[out] out_statistics The statistics to write the result into
+	\return PSVRResult_Success if the tracker is open
+ */
+PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_GetTrackerStatistics(PSVRTrackerID tracker_id, PSVRTrackerStatistics *out_statistics);
+
 // HMD Pool
 /** \brief Fetches the \ref PSVRHeadMountedDisplay data for the given HMD
 	The client API maintains a pool of HMD structs. 
@@ -869,6 +999,53 @@ PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_SetHmdPredictionTime(PSVRHmdID hmd_id, flo
  */
 PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_SetHmdTrackingColorID(PSVRHmdID HmdID, PSVRTrackingColorType tracking_color_type);
 
+/** \brief Get the per stage latencies and pose filter counters of the given HMD
+	Counts and latencies accumulate for as long as the service runs (including across reconnects).
+	\param hmd_id The id of the HMD
+	\param[out] out_statistics The statistics to write the result into
+	\return PSVRResult_Success if the HMD is open
+ */
+PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_GetHmdStatistics(PSVRHmdID hmd_id, PSVRHmdStatistics *out_statistics);
+
+/** \brief Get the end-to-end latency of the poses published for the given HMD
+	Each pose is measured from the capture time of the newest IMU report and video frame fused into it.
+	The age of the most recent pose is also available in PSVRHeadMountedDisplay.
+	\param hmd_id The id of the HMD
+	\param[out] out_latency The latency distributions to write the result into
+	\return PSVRResult_Success if the HMD is open
+ */
+PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_GetHmdMotionToPoseLatency(PSVRHmdID hmd_id, PSVRHmdMotionToPoseLatency *out_latency);
+
+// Session Recording Methods
+
+/** \brief Starts recording the raw video frames and IMU packets of the open trackers and HMDs to a file
+	The recording can be played back later by setting "replay_session_path" in DeviceManagerConfig.json.
+	\param path The path of the session recording file to write
+	\return PSVRResult_Success on success or PSVRResult_Error if already recording or the file couldn't be opened
+ */
+PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_StartSessionRecording(const char *path);
+
+/** \brief Stops the current session recording and finishes writing the file
+	\return PSVRResult_Success on success or PSVRResult_Error if there was no recording in progress
+ */
+PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_StopSessionRecording();
+
+// Timeline Trace Methods
+
+/** \brief Starts recording a timeline of the USB, tracker, sensor and filter threads
+	Only available when the service was built with PSVR_ENABLE_TIMELINE_TRACE.
+	Each thread keeps its most recent events, so a long recording holds the last few seconds of every thread.
+	\return PSVRResult_Success on success or PSVRResult_Error if tracing isn't compiled in
+ */
+PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_StartTimelineTrace();
+
+/** \brief Stops the timeline recording and writes it out as Chrome trace event JSON
+	The file can be opened in chrome://tracing or https://ui.perfetto.dev
+	\param path The path of the trace file to write
+	\return PSVRResult_Success on success or PSVRResult_Error if there was no recording in progress or the file couldn't be written
+ */
+PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_StopTimelineTrace(const char *path);
+
 /** 
 @} 
 */ 
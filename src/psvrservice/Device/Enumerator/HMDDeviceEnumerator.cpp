@@ -1,6 +1,7 @@
 // -- includes -----
 #include "HMDDeviceEnumerator.h"
 #include "HidHMDDeviceEnumerator.h"
+#include "ReplayHMDDeviceEnumerator.h"
 #include "VirtualHMDDeviceEnumerator.h"
 #include "assert.h"
 #include "string.h"
@@ -28,11 +29,17 @@ HMDDeviceEnumerator::HMDDeviceEnumerator(
 		enumerators[0] = new VirtualHMDDeviceEnumerator;
 		enumerator_count = 1;
 		break;
+	case eAPIType::CommunicationType_REPLAY:
+		enumerators = new DeviceEnumerator *[1];
+		enumerators[0] = new ReplayHMDDeviceEnumerator;
+		enumerator_count = 1;
+		break;
 	case eAPIType::CommunicationType_ALL:
-		enumerators = new DeviceEnumerator *[2];
+		enumerators = new DeviceEnumerator *[3];
 		enumerators[0] = new HidHMDDeviceEnumerator;
 		enumerators[1] = new VirtualHMDDeviceEnumerator;
-		enumerator_count = 2;
+		enumerators[2] = new ReplayHMDDeviceEnumerator;
+		enumerator_count = 3;
 		break;
 	}
 
@@ -82,6 +89,9 @@ HMDDeviceEnumerator::eAPIType HMDDeviceEnumerator::get_api_type() const
 	case eAPIType::CommunicationType_VIRTUAL:
 		result = (enumerator_index < enumerator_count) ? HMDDeviceEnumerator::CommunicationType_VIRTUAL : HMDDeviceEnumerator::CommunicationType_INVALID;
 		break;
+	case eAPIType::CommunicationType_REPLAY:
+		result = (enumerator_index < enumerator_count) ? HMDDeviceEnumerator::CommunicationType_REPLAY : HMDDeviceEnumerator::CommunicationType_INVALID;
+		break;
 	case eAPIType::CommunicationType_ALL:
 		if (enumerator_index < enumerator_count)
 		{
@@ -93,6 +103,9 @@ HMDDeviceEnumerator::eAPIType HMDDeviceEnumerator::get_api_type() const
 			case 1:
 				result = HMDDeviceEnumerator::CommunicationType_VIRTUAL;
 				break;
+			case 2:
+				result = HMDDeviceEnumerator::CommunicationType_REPLAY;
+				break;
 			default:
 				result = HMDDeviceEnumerator::CommunicationType_INVALID;
 				break;
@@ -118,6 +131,7 @@ const HidHMDDeviceEnumerator *HMDDeviceEnumerator::get_hid_hmd_enumerator() cons
 		enumerator = (enumerator_index < enumerator_count) ? static_cast<HidHMDDeviceEnumerator *>(enumerators[0]) : nullptr;
 		break;
 	case eAPIType::CommunicationType_VIRTUAL:
+	case eAPIType::CommunicationType_REPLAY:
 		enumerator = nullptr;
 		break;
 	case eAPIType::CommunicationType_ALL:
@@ -142,6 +156,7 @@ const VirtualHMDDeviceEnumerator *HMDDeviceEnumerator::get_virtual_hmd_enumerato
 	switch (api_type)
 	{
 	case eAPIType::CommunicationType_HID:
+	case eAPIType::CommunicationType_REPLAY:
 		enumerator = nullptr;
 		break;
 	case eAPIType::CommunicationType_VIRTUAL:
@@ -162,6 +177,34 @@ const VirtualHMDDeviceEnumerator *HMDDeviceEnumerator::get_virtual_hmd_enumerato
 	return enumerator;
 }
 
+const ReplayHMDDeviceEnumerator *HMDDeviceEnumerator::get_replay_hmd_enumerator() const
+{
+	ReplayHMDDeviceEnumerator *enumerator = nullptr;
+
+	switch (api_type)
+	{
+	case eAPIType::CommunicationType_HID:
+	case eAPIType::CommunicationType_VIRTUAL:
+		enumerator = nullptr;
+		break;
+	case eAPIType::CommunicationType_REPLAY:
+		enumerator = (enumerator_index < enumerator_count) ? static_cast<ReplayHMDDeviceEnumerator *>(enumerators[0]) : nullptr;
+		break;
+	case eAPIType::CommunicationType_ALL:
+		if (enumerator_index < enumerator_count)
+		{
+			enumerator = (enumerator_index == 2) ? static_cast<ReplayHMDDeviceEnumerator *>(enumerators[2]) : nullptr;
+		}
+		else
+		{
+			enumerator = nullptr;
+		}
+		break;
+	}
+
+	return enumerator;
+}
+
 bool HMDDeviceEnumerator::is_valid() const
 {
     bool bIsValid = false;
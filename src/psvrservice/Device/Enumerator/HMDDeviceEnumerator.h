@@ -11,6 +11,7 @@ public:
 		CommunicationType_INVALID= -1,
 		CommunicationType_HID,
 		CommunicationType_VIRTUAL,
+		CommunicationType_REPLAY,
 		CommunicationType_ALL
 	};
 
@@ -26,6 +27,7 @@ public:
 	eAPIType get_api_type() const;
 	const class HidHMDDeviceEnumerator *get_hid_hmd_enumerator() const;
 	const class VirtualHMDDeviceEnumerator *get_virtual_hmd_enumerator() const;
+	const class ReplayHMDDeviceEnumerator *get_replay_hmd_enumerator() const;
 
 private:
 	eAPIType api_type;
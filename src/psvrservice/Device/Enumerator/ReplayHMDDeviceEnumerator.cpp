@@ -0,0 +1,72 @@
+// -- includes -----
+#include "ReplayHMDDeviceEnumerator.h"
+#include "DeviceManager.h"
+#include "SessionRecording.h"
+#include "SessionReplay.h"
+#include "Utility.h"
+
+// -- ReplayHMDDeviceEnumerator -----
+ReplayHMDDeviceEnumerator::ReplayHMDDeviceEnumerator()
+    : DeviceEnumerator()
+    , m_current_device_identifier()
+    , m_hmd_index(0)
+    , m_hmd_count(0)
+{
+    const DeviceManager *device_manager= DeviceManager::getInstance();
+    const SessionReplay *replay= (device_manager != nullptr) ? device_manager->getSessionReplay() : nullptr;
+
+    if (replay != nullptr && replay->getIsOpen())
+    {
+        m_hmd_count= replay->getHMDCount();
+    }
+
+    update_current_device();
+}
+
+const char *ReplayHMDDeviceEnumerator::get_path() const
+{
+	return is_valid() ? m_current_device_identifier.c_str() : nullptr;
+}
+
+int ReplayHMDDeviceEnumerator::get_vendor_id() const
+{
+	return is_valid() ? 0x0000 : -1;
+}
+
+int ReplayHMDDeviceEnumerator::get_product_id() const
+{
+	return is_valid() ? 0x0000 : -1;
+}
+
+bool ReplayHMDDeviceEnumerator::is_valid() const
+{
+	return m_hmd_index < m_hmd_count;
+}
+
+bool ReplayHMDDeviceEnumerator::next()
+{
+	++m_hmd_index;
+    update_current_device();
+
+	return is_valid();
+}
+
+void ReplayHMDDeviceEnumerator::update_current_device()
+{
+    if (is_valid())
+    {
+        const SessionRecordingHMDDesc *desc=
+            DeviceManager::getInstance()->getSessionReplay()->getHMDDesc(m_hmd_index);
+        char device_path[32];
+
+        Utility::format_string(device_path, sizeof(device_path), "ReplayHMD_%d", m_hmd_index);
+
+        m_current_device_identifier= device_path;
+        m_deviceType= (CommonSensorState::eDeviceType)desc->device_type;
+    }
+    else
+    {
+        m_current_device_identifier= "";
+        m_deviceType= CommonSensorState::INVALID_DEVICE_TYPE;
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef REPLAY_HMD_DEVICE_ENUMERATOR_H
+#define REPLAY_HMD_DEVICE_ENUMERATOR_H
+
+// -- includes -----
+#include "DeviceEnumerator.h"
+#include <string>
+
+// -- definitions -----
+/// Enumerates the HMDs in the session recording the DeviceManager is replaying
+class ReplayHMDDeviceEnumerator : public DeviceEnumerator
+{
+public:
+    ReplayHMDDeviceEnumerator();
+
+    bool is_valid() const override;
+    bool next() override;
+	int get_vendor_id() const override;
+	int get_product_id() const override;
+    const char *get_path() const override;
+
+    inline int get_hmd_index() const { return m_hmd_index; }
+
+private:
+    void update_current_device();
+
+	std::string m_current_device_identifier;
+    int m_hmd_index;
+    int m_hmd_count;
+};
+
+#endif // REPLAY_HMD_DEVICE_ENUMERATOR_H
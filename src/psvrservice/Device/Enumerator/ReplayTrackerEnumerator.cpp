@@ -0,0 +1,72 @@
+// -- includes -----
+#include "ReplayTrackerEnumerator.h"
+#include "DeviceManager.h"
+#include "SessionRecording.h"
+#include "SessionReplay.h"
+#include "Utility.h"
+
+// -- ReplayTrackerEnumerator -----
+ReplayTrackerEnumerator::ReplayTrackerEnumerator()
+    : DeviceEnumerator()
+    , m_current_device_identifier()
+    , m_tracker_index(0)
+    , m_tracker_count(0)
+{
+    const DeviceManager *device_manager= DeviceManager::getInstance();
+    const SessionReplay *replay= (device_manager != nullptr) ? device_manager->getSessionReplay() : nullptr;
+
+    if (replay != nullptr && replay->getIsOpen())
+    {
+        m_tracker_count= replay->getTrackerCount();
+    }
+
+    update_current_device();
+}
+
+const char *ReplayTrackerEnumerator::get_path() const
+{
+	return is_valid() ? m_current_device_identifier.c_str() : nullptr;
+}
+
+int ReplayTrackerEnumerator::get_vendor_id() const
+{
+	return is_valid() ? 0x0000 : -1;
+}
+
+int ReplayTrackerEnumerator::get_product_id() const
+{
+	return is_valid() ? 0x0000 : -1;
+}
+
+bool ReplayTrackerEnumerator::is_valid() const
+{
+	return m_tracker_index < m_tracker_count;
+}
+
+bool ReplayTrackerEnumerator::next()
+{
+	++m_tracker_index;
+    update_current_device();
+
+	return is_valid();
+}
+
+void ReplayTrackerEnumerator::update_current_device()
+{
+    if (is_valid())
+    {
+        const SessionRecordingTrackerDesc *desc=
+            DeviceManager::getInstance()->getSessionReplay()->getTrackerDesc(m_tracker_index);
+        char device_path[32];
+
+        Utility::format_string(device_path, sizeof(device_path), "ReplayTracker_%d", m_tracker_index);
+
+        m_current_device_identifier= device_path;
+        m_deviceType= (CommonSensorState::eDeviceType)desc->device_type;
+    }
+    else
+    {
+        m_current_device_identifier= "";
+        m_deviceType= CommonSensorState::INVALID_DEVICE_TYPE;
+    }
+}
@@ -0,0 +1,69 @@
+// -- includes -----
+#include "SyntheticTrackerEnumerator.h"
+#include "DeviceManager.h"
+#include "SyntheticScene.h"
+#include "Utility.h"
+
+// -- SyntheticTrackerEnumerator -----
+SyntheticTrackerEnumerator::SyntheticTrackerEnumerator()
+    : DeviceEnumerator()
+    , m_current_device_identifier()
+    , m_tracker_index(0)
+    , m_tracker_count(0)
+{
+    const DeviceManager *device_manager= DeviceManager::getInstance();
+    const SyntheticScene *scene= (device_manager != nullptr) ? device_manager->getSyntheticScene() : nullptr;
+
+    if (scene != nullptr)
+    {
+        m_tracker_count= scene->getTrackerCount();
+    }
+
+    update_current_device();
+}
+
+const char *SyntheticTrackerEnumerator::get_path() const
+{
+	return is_valid() ? m_current_device_identifier.c_str() : nullptr;
+}
+
+int SyntheticTrackerEnumerator::get_vendor_id() const
+{
+	return is_valid() ? 0x0000 : -1;
+}
+
+int SyntheticTrackerEnumerator::get_product_id() const
+{
+	return is_valid() ? 0x0000 : -1;
+}
+
+bool SyntheticTrackerEnumerator::is_valid() const
+{
+	return m_tracker_index < m_tracker_count;
+}
+
+bool SyntheticTrackerEnumerator::next()
+{
+	++m_tracker_index;
+    update_current_device();
+
+	return is_valid();
+}
+
+void SyntheticTrackerEnumerator::update_current_device()
+{
+    if (is_valid())
+    {
+        char device_path[32];
+
+        Utility::format_string(device_path, sizeof(device_path), "SyntheticTracker_%d", m_tracker_index);
+
+        m_current_device_identifier= device_path;
+        m_deviceType= CommonSensorState::WMFMonoCamera; // Reported as a generic mono camera
+    }
+    else
+    {
+        m_current_device_identifier= "";
+        m_deviceType= CommonSensorState::INVALID_DEVICE_TYPE;
+    }
+}
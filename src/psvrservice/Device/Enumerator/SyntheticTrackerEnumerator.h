@@ -0,0 +1,31 @@
+#ifndef SYNTHETIC_TRACKER_ENUMERATOR_H
+#define SYNTHETIC_TRACKER_ENUMERATOR_H
+
+// -- includes -----
+#include "DeviceEnumerator.h"
+#include <string>
+
+// -- definitions -----
+/// Enumerates the synthetic trackers in the DeviceManager's synthetic scene
+class SyntheticTrackerEnumerator : public DeviceEnumerator
+{
+public:
+    SyntheticTrackerEnumerator();
+
+    bool is_valid() const override;
+    bool next() override;
+	int get_vendor_id() const override;
+	int get_product_id() const override;
+    const char *get_path() const override;
+
+    inline int get_tracker_index() const { return m_tracker_index; }
+
+private:
+    void update_current_device();
+
+	std::string m_current_device_identifier;
+    int m_tracker_index;
+    int m_tracker_count;
+};
+
+#endif // SYNTHETIC_TRACKER_ENUMERATOR_H
@@ -1,5 +1,7 @@
 // -- includes -----
 #include "TrackerDeviceEnumerator.h"
+#include "ReplayTrackerEnumerator.h"
+#include "SyntheticTrackerEnumerator.h"
 #include "TrackerUSBDeviceEnumerator.h"
 #include "WMFCameraEnumerator.h"
 #include "assert.h"
@@ -21,15 +23,19 @@ TrackerDeviceEnumerator::TrackerDeviceEnumerator(
 	{
 	case eAPIType::CommunicationType_USB:
 	case eAPIType::CommunicationType_WMF:
+	case eAPIType::CommunicationType_REPLAY:
+	case eAPIType::CommunicationType_SYNTHETIC:
 		enumerators = new DeviceEnumerator *[1];
 		enumerators[0] = nullptr;
 		enumerator_count = 1;
 		break;
 	case eAPIType::CommunicationType_ALL:
-		enumerators = new DeviceEnumerator *[2];
+		enumerators = new DeviceEnumerator *[4];
         enumerators[0] = nullptr;
 		enumerators[1] = nullptr;
-		enumerator_count = 2;
+		enumerators[2] = nullptr;
+		enumerators[3] = nullptr;
+		enumerator_count = 4;
 		break;
 	}
 
@@ -60,15 +66,19 @@ TrackerDeviceEnumerator::TrackerDeviceEnumerator(
 	{
 	case eAPIType::CommunicationType_USB:
 	case eAPIType::CommunicationType_WMF:
+	case eAPIType::CommunicationType_REPLAY:
+	case eAPIType::CommunicationType_SYNTHETIC:
 		enumerators = new DeviceEnumerator *[1];
 		enumerators[0] = nullptr;
 		enumerator_count = 1;
 		break;
 	case eAPIType::CommunicationType_ALL:
-		enumerators = new DeviceEnumerator *[2];
+		enumerators = new DeviceEnumerator *[4];
 		enumerators[0] = nullptr;
         enumerators[1] = nullptr;
-		enumerator_count = 2;
+		enumerators[2] = nullptr;
+		enumerators[3] = nullptr;
+		enumerator_count = 4;
 		break;
 	}
 
@@ -144,6 +154,12 @@ TrackerDeviceEnumerator::eAPIType TrackerDeviceEnumerator::get_api_type() const
 	case eAPIType::CommunicationType_WMF:
 		result = (enumerator_index < enumerator_count) ? TrackerDeviceEnumerator::CommunicationType_WMF : TrackerDeviceEnumerator::CommunicationType_INVALID;
 		break;
+	case eAPIType::CommunicationType_REPLAY:
+		result = (enumerator_index < enumerator_count) ? TrackerDeviceEnumerator::CommunicationType_REPLAY : TrackerDeviceEnumerator::CommunicationType_INVALID;
+		break;
+	case eAPIType::CommunicationType_SYNTHETIC:
+		result = (enumerator_index < enumerator_count) ? TrackerDeviceEnumerator::CommunicationType_SYNTHETIC : TrackerDeviceEnumerator::CommunicationType_INVALID;
+		break;
 	case eAPIType::CommunicationType_ALL:
 		if (enumerator_index < enumerator_count)
 		{
@@ -155,6 +171,12 @@ TrackerDeviceEnumerator::eAPIType TrackerDeviceEnumerator::get_api_type() const
             case 1:
 				result = TrackerDeviceEnumerator::CommunicationType_WMF;
 				break;
+            case 2:
+				result = TrackerDeviceEnumerator::CommunicationType_REPLAY;
+				break;
+            case 3:
+				result = TrackerDeviceEnumerator::CommunicationType_SYNTHETIC;
+				break;
 			default:
 				result = TrackerDeviceEnumerator::CommunicationType_INVALID;
 				break;
@@ -180,6 +202,8 @@ const TrackerUSBDeviceEnumerator *TrackerDeviceEnumerator::get_usb_tracker_enume
 		enumerator = (enumerator_index < enumerator_count) ? static_cast<TrackerUSBDeviceEnumerator *>(enumerators[0]) : nullptr;
 		break;
 	case eAPIType::CommunicationType_WMF:
+	case eAPIType::CommunicationType_REPLAY:
+	case eAPIType::CommunicationType_SYNTHETIC:
 		enumerator = nullptr;
 		break;
 	case eAPIType::CommunicationType_ALL:
@@ -204,6 +228,8 @@ const WMFCameraEnumerator *TrackerDeviceEnumerator::get_windows_media_foundation
 	switch (api_type)
 	{
 	case eAPIType::CommunicationType_USB:
+	case eAPIType::CommunicationType_REPLAY:
+	case eAPIType::CommunicationType_SYNTHETIC:
 		enumerator = nullptr;
 		break;
 	case eAPIType::CommunicationType_WMF:
@@ -224,6 +250,64 @@ const WMFCameraEnumerator *TrackerDeviceEnumerator::get_windows_media_foundation
 	return enumerator;
 }
 
+const ReplayTrackerEnumerator *TrackerDeviceEnumerator::get_replay_tracker_enumerator() const
+{
+	ReplayTrackerEnumerator *enumerator = nullptr;
+
+	switch (api_type)
+	{
+	case eAPIType::CommunicationType_USB:
+	case eAPIType::CommunicationType_WMF:
+	case eAPIType::CommunicationType_SYNTHETIC:
+		enumerator = nullptr;
+		break;
+	case eAPIType::CommunicationType_REPLAY:
+		enumerator = (enumerator_index < enumerator_count) ? static_cast<ReplayTrackerEnumerator *>(enumerators[0]) : nullptr;
+		break;
+	case eAPIType::CommunicationType_ALL:
+		if (enumerator_index < enumerator_count)
+		{
+			enumerator = (enumerator_index == 2) ? static_cast<ReplayTrackerEnumerator *>(enumerators[2]) : nullptr;
+		}
+		else
+		{
+			enumerator = nullptr;
+		}
+		break;
+	}
+
+	return enumerator;
+}
+
+const SyntheticTrackerEnumerator *TrackerDeviceEnumerator::get_synthetic_tracker_enumerator() const
+{
+	SyntheticTrackerEnumerator *enumerator = nullptr;
+
+	switch (api_type)
+	{
+	case eAPIType::CommunicationType_USB:
+	case eAPIType::CommunicationType_WMF:
+	case eAPIType::CommunicationType_REPLAY:
+		enumerator = nullptr;
+		break;
+	case eAPIType::CommunicationType_SYNTHETIC:
+		enumerator = (enumerator_index < enumerator_count) ? static_cast<SyntheticTrackerEnumerator *>(enumerators[0]) : nullptr;
+		break;
+	case eAPIType::CommunicationType_ALL:
+		if (enumerator_index < enumerator_count)
+		{
+			enumerator = (enumerator_index == 3) ? static_cast<SyntheticTrackerEnumerator *>(enumerators[3]) : nullptr;
+		}
+		else
+		{
+			enumerator = nullptr;
+		}
+		break;
+	}
+
+	return enumerator;
+}
+
 bool TrackerDeviceEnumerator::is_valid() const
 {
     bool bIsValid = false;
@@ -292,6 +376,20 @@ void TrackerDeviceEnumerator::allocate_child_enumerator(int enumerator_index)
 		    enumerators[0] = new WMFCameraEnumerator;
         }
 		break;
+	case eAPIType::CommunicationType_REPLAY:
+        assert(enumerator_index == 0);
+        if (enumerators[0] == nullptr)
+        {
+		    enumerators[0] = new ReplayTrackerEnumerator;
+        }
+		break;
+	case eAPIType::CommunicationType_SYNTHETIC:
+        assert(enumerator_index == 0);
+        if (enumerators[0] == nullptr)
+        {
+		    enumerators[0] = new SyntheticTrackerEnumerator;
+        }
+		break;
 	case eAPIType::CommunicationType_ALL:
 		if (enumerator_index == 0)
         {
@@ -306,6 +404,20 @@ void TrackerDeviceEnumerator::allocate_child_enumerator(int enumerator_index)
             {
     		    enumerators[1] = new WMFCameraEnumerator;
             }
+        }
+        else if (enumerator_index == 2)
+        {
+            if (enumerators[2] == nullptr)
+            {
+    		    enumerators[2] = new ReplayTrackerEnumerator;
+            }
+        }
+        else if (enumerator_index == 3)
+        {
+            if (enumerators[3] == nullptr)
+            {
+    		    enumerators[3] = new SyntheticTrackerEnumerator;
+            }
         }
 		break;
 	}
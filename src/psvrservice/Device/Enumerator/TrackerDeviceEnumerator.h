@@ -15,6 +15,8 @@ public:
 		CommunicationType_INVALID= -1,
 		CommunicationType_USB,
 		CommunicationType_WMF,
+		CommunicationType_REPLAY,
+		CommunicationType_SYNTHETIC,
 		CommunicationType_ALL
 	};
 
@@ -33,6 +35,8 @@ public:
     eAPIType get_api_type() const;
 	const class WMFCameraEnumerator *get_windows_media_foundation_camera_enumerator() const;
 	const class TrackerUSBDeviceEnumerator *get_usb_tracker_enumerator() const;
+	const class ReplayTrackerEnumerator *get_replay_tracker_enumerator() const;
+	const class SyntheticTrackerEnumerator *get_synthetic_tracker_enumerator() const;
 
 protected:
     void allocate_child_enumerator(int enumerator_index);
@@ -41,16 +41,14 @@ bool VirtualHMDDeviceEnumerator::is_valid() const
 
 bool VirtualHMDDeviceEnumerator::next()
 {
-	bool foundValid = false;
-
 	++m_device_index;
     if (m_device_index < m_device_count)
     {
         char device_path[32];
-        Utility::format_string(device_path, sizeof(device_path), "VirtualHMD__%s", m_device_index);
+        Utility::format_string(device_path, sizeof(device_path), "VirtualHMD__%d", m_device_index);
 
         m_current_device_identifier= device_path;
     }
 
-	return foundValid;
+	return is_valid();
 }
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "PSVRClient_CAPI.h"
+#include "ServiceClock.h"
 
 // -- pre-declarations ----
 namespace PSVRProtocol
@@ -109,8 +110,15 @@ public:
 class ITrackerListener
 {
 public:
-	// Called when new video frame has been received from the tracker device
-	virtual void notifyVideoFrameReceived(const unsigned char *raw_video_frame) = 0;
+	// Called when new video frame has been received from the tracker device.
+	// The capture timestamp is the service clock time the device finished delivering the frame
+	// (e.g. when the last USB packet of the frame arrived), not when the frame reached the listener.
+	virtual void notifyVideoFrameReceived(const unsigned char *raw_video_frame, const t_service_timepoint &capture_timestamp) = 0;
+
+	// Called on the main thread once a video property change has been applied to the tracker device
+	// (or failed to apply). Devices that apply properties asynchronously only report the latest value
+	// of a property that changed several times while a change was already in flight.
+	virtual void notifyVideoPropertyApplied(PSVRVideoPropertyType property_type, int value, bool bSuccess) = 0;
 };
 
 /// Interface class for Tracker interface. Implemented Tracker classes
@@ -122,6 +130,8 @@ public:
         Libusb,
 		Winusb,
         WindowsMediaFramework,
+        Replay,
+        Synthetic,
 
         SUPPORTED_DRIVER_TYPE_COUNT,
     };
@@ -158,6 +168,12 @@ public:
         case WindowsMediaFramework:
             result = "Windows Media Framework";
             break;
+        case Replay:
+            result = "Replay";
+            break;
+        case Synthetic:
+            result = "Synthetic";
+            break;
         default:
             result = "UNKNOWN";
         }
@@ -196,14 +212,19 @@ public:
 
 	// Assign a Tracker listener to send Tracker events to
 	virtual void setTrackerListener(ITrackerListener *listener) = 0;
+
+	// Fill in the driver's share of the tracker statistics (USB transfer timings, frames dropped in the driver).
+	// Drivers that don't keep any leave the statistics untouched.
+	virtual void getDeviceStatistics(PSVRTrackerStatistics &out_statistics) const = 0;
 };
 
 /// Interface class for HMD events. Implemented HMD Server View
 class IHMDListener
 {
 public:
-	// Called when new sensor state has been read from the HMD
-	virtual void notifySensorDataReceived(const CommonSensorState *sensor_state) = 0;
+	// Called when new sensor state has been read from the HMD.
+	// The capture timestamp is the service clock time the sensor report arrived from the device.
+	virtual void notifySensorDataReceived(const CommonSensorState *sensor_state, const t_service_timepoint &capture_timestamp) = 0;
 };
 
 /// Interface class for HMD interface. Implemented by HMD classes
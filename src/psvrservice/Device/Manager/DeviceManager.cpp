@@ -10,6 +10,9 @@
 #include "ServerHMDView.h"
 #include "ServerTrackerView.h"
 #include "ServiceRequestHandler.h"
+#include "SessionRecorder.h"
+#include "SessionReplay.h"
+#include "SyntheticScene.h"
 #include "Logger.h"
 #include "ServerDeviceView.h"
 #include "Utility.h"
@@ -37,6 +40,8 @@ public:
         , hmd_poll_interval(k_default_hmd_poll_interval)
 		, gamepad_api_enabled(true)
 		, platform_api_enabled(true)
+		, replay_session_path("")
+		, replay_speed(1.f)
     {};
 
     const configuru::Config
@@ -49,7 +54,9 @@ public:
             {"hmd_reconnect_interval", hmd_reconnect_interval},
             {"hmd_poll_interval", hmd_poll_interval},
 		    {"gamepad_api_enabled", gamepad_api_enabled},
-		    {"platform_api_enabled", platform_api_enabled}
+		    {"platform_api_enabled", platform_api_enabled},
+		    {"replay_session_path", replay_session_path},
+		    {"replay_speed", replay_speed}
         };
     
         return pt;
@@ -68,6 +75,8 @@ public:
             hmd_poll_interval = pt.get_or<int>("hmd_poll_interval", k_default_hmd_poll_interval);
 		    gamepad_api_enabled = pt.get_or<bool>("gamepad_api_enabled", gamepad_api_enabled);
 		    platform_api_enabled = pt.get_or<bool>("platform_api_enabled", platform_api_enabled);
+		    replay_session_path = pt.get_or<std::string>("replay_session_path", replay_session_path);
+		    replay_speed = pt.get_or<float>("replay_speed", replay_speed);
         }
         else
         {
@@ -86,6 +95,11 @@ public:
     int hmd_poll_interval;    
 	bool gamepad_api_enabled;
 	bool platform_api_enabled;
+
+	// When set, the trackers and HMDs in this session recording are replayed as devices
+	std::string replay_session_path;
+	// Replay speed relative to the recorded pace (0 = as fast as possible)
+	float replay_speed;
 };
 
 // DeviceManager - This is the interface used by PSVRSERVICE
@@ -97,11 +111,17 @@ DeviceManager::DeviceManager()
 	, m_platform_api(nullptr)
     , m_tracker_manager(new TrackerManager())
     , m_hmd_manager(new HMDManager())
+    , m_session_recorder(new SessionRecorder())
+    , m_session_replay(nullptr)
+    , m_synthetic_scene(new SyntheticScene())
 {
 }
 
 DeviceManager::~DeviceManager()
 {
+    delete m_synthetic_scene;
+    delete m_session_replay;
+    delete m_session_recorder;
     delete m_tracker_manager;
     delete m_hmd_manager;
 
@@ -143,6 +163,21 @@ DeviceManager::startup()
 		success &= m_platform_api->startup(this);
 	}
 
+	// Optionally map the session recording that the replay devices play back
+	if (m_config->replay_session_path.length() > 0)
+	{
+		m_session_replay = new SessionReplay;
+
+		if (!m_session_replay->openRecording(m_config->replay_session_path, m_config->replay_speed))
+		{
+			delete m_session_replay;
+			m_session_replay = nullptr;
+		}
+	}
+
+	// Synthetic trackers get enumerated if the scene config asks for any
+	m_synthetic_scene->startup();
+
 	// Register for hotplug events if this platform supports them
 	int tracker_reconnect_interval = m_config->tracker_reconnect_interval;
 	int hmd_reconnect_interval = m_config->hmd_reconnect_interval;
@@ -179,8 +214,11 @@ DeviceManager::update()
     m_tracker_manager->pollConnectedDevices(); // Update tracker count
     m_hmd_manager->pollConnectedDevices(); // Update HMD count
 
+	m_tracker_manager->pollOpeningTrackers(); // Move along cameras that are still setting up
+
 	m_tracker_manager->pollUpdatedVideoFrames(); // Check for updated video frames
 	m_hmd_manager->updatePoseFilters(); // Process pose filter packets from the tracker and IMU threads
+	m_synthetic_scene->update(); // Show the synthetic trackers the open HMDs and check their tracking error
 
     m_tracker_manager->publish(); // publish tracker state to any listening clients (probably only used by ConfigTool)
     m_hmd_manager->publish(); // publish hmd state to any listening clients (common case)
@@ -194,6 +232,11 @@ DeviceManager::shutdown()
 		m_config->save();
 	}
 
+	// Finish writing any session recording before the devices go away
+	m_session_recorder->stopRecording();
+
+	m_synthetic_scene->shutdown();
+
 	if (m_tracker_manager != nullptr)
 	{
 	    m_tracker_manager->shutdown();
@@ -209,6 +252,13 @@ DeviceManager::shutdown()
 		m_platform_api->shutdown();
 	}
 
+	if (m_session_replay != nullptr)
+	{
+		m_session_replay->closeRecording();
+		delete m_session_replay;
+		m_session_replay = nullptr;
+	}
+
     m_instance= nullptr;
 }
 
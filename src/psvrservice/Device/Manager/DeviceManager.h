@@ -57,6 +57,11 @@ public:
 	class HMDManager *getHMDManager() { return m_hmd_manager; }
 	ServerHMDViewPtr getHMDViewPtr(int hmd_id);
 
+	class SessionRecorder *getSessionRecorder() { return m_session_recorder; }
+	class SessionReplay *getSessionReplay() const { return m_session_replay; }
+
+	class SyntheticScene *getSyntheticScene() const { return m_synthetic_scene; }
+
 	// -- Queries ---
 	inline eDevicePlatformApiType get_api_type() const { return m_platform_api_type; }
 	bool get_device_property(
@@ -92,6 +97,9 @@ private:
 public:
     class TrackerManager *m_tracker_manager;
     class HMDManager *m_hmd_manager;
+    class SessionRecorder *m_session_recorder;
+    class SessionReplay *m_session_replay; // null unless replaying a session recording
+    class SyntheticScene *m_synthetic_scene;
 };
 
 #endif  // DEVICE_MANAGER_H
\ No newline at end of file
@@ -107,12 +107,14 @@ DeviceTypeManager::update_connected_devices()
     {
         const int maxDeviceCount = getMaxDevices();
         bool exists_in_enumerator[64];
+        bool opened_from_enumerator[64];
         bool bSendControllerUpdatedNotification = false;
 
-        // Initialize temp table used to keep track of open devices
-        // still found in the enumerator
+        // Initialize temp tables used to keep track of open devices
+        // still found in the enumerator and the ones opened just now
         assert(maxDeviceCount <= 64);
         memset(exists_in_enumerator, 0, sizeof(exists_in_enumerator));
+        memset(opened_from_enumerator, 0, sizeof(opened_from_enumerator));
 
         // Step 1
         // Mark any open devices that still show up in the enumerator.
@@ -152,6 +154,7 @@ DeviceTypeManager::update_connected_devices()
 
                             // Mark the device as having showed up in the enumerator
                             exists_in_enumerator[device_id_] = true;
+                            opened_from_enumerator[device_id_] = true;
 
                             // Send notification to clients that a new device was added
                             bSendControllerUpdatedNotification = true;
@@ -176,6 +179,27 @@ DeviceTypeManager::update_connected_devices()
             free_device_enumerator(enumerator);
         }
 
+        // Step 1b
+        // Let the devices we just opened finish opening (side by side),
+        // then close the ones that didn't make it.
+        if (bSendControllerUpdatedNotification)
+        {
+            wait_for_opening_devices();
+
+            for (int device_id = 0; device_id < maxDeviceCount; ++device_id)
+            {
+                ServerDeviceViewPtr openedDevice = getDeviceViewPtr(device_id);
+
+                if (opened_from_enumerator[device_id] && !openedDevice->getIsOpen())
+                {
+                    PSVR_LOG_ERROR("DeviceTypeManager::update_connected_devices") << 
+                        "Device device_id " << device_id << " failed to finish opening!";
+                    openedDevice->close();
+                    exists_in_enumerator[device_id] = false;
+                }
+            }
+        }
+
         // Step 2
         // Close any device that is open and wasn't found in the enumerator
         for (int device_id = 0; device_id < maxDeviceCount; ++device_id)
@@ -241,6 +265,11 @@ DeviceTypeManager::can_update_connected_devices()
     return true;
 }
 
+void
+DeviceTypeManager::wait_for_opening_devices()
+{
+}
+
 void
 DeviceTypeManager::poll_devices()
 {
@@ -56,6 +56,9 @@ protected:
 
     virtual bool can_poll_connected_devices();
     virtual bool can_update_connected_devices();
+    // Devices can finish opening in the background (e.g. cameras setting up their registers).
+    // Called once all the newly connected devices got opened, to wait for them to finish together.
+    virtual void wait_for_opening_devices();
     virtual class DeviceEnumerator *allocate_device_enumerator() = 0;
     virtual void free_device_enumerator(class DeviceEnumerator *) = 0;
     virtual ServerDeviceView *allocate_device_view(int device_id) = 0;
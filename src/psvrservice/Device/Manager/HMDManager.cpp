@@ -7,6 +7,8 @@
 #include "ServerDeviceView.h"
 #include "VirtualHMDDeviceEnumerator.h"
 
+#include <algorithm>
+
 //-- methods -----
 //-- Tracker Manager Config -----
 const int HMDManagerConfig::CONFIG_VERSION = 1;
@@ -14,6 +16,9 @@ const int HMDManagerConfig::CONFIG_VERSION = 1;
 HMDManagerConfig::HMDManagerConfig(const std::string &fnamebase)
     : PSVRConfig(fnamebase)
     , virtual_hmd_count(0)
+    , use_filter_thread(false)
+    , filter_thread_cpu(-1)
+    , filter_thread_spin_wait_count(0)
 {
 
 };
@@ -23,7 +28,10 @@ HMDManagerConfig::writeToJSON()
 {
     configuru::Config pt{
         {"version", HMDManagerConfig::CONFIG_VERSION},
-        {"virtual_hmd_count", virtual_hmd_count}
+        {"virtual_hmd_count", virtual_hmd_count},
+        {"use_filter_thread", use_filter_thread},
+        {"filter_thread_cpu", filter_thread_cpu},
+        {"filter_thread_spin_wait_count", filter_thread_spin_wait_count}
     };
 
     return pt;
@@ -37,6 +45,9 @@ HMDManagerConfig::readFromJSON(const configuru::Config &pt)
     if (version == HMDManagerConfig::CONFIG_VERSION)
     {
         virtual_hmd_count = pt.get_or<int>("virtual_hmd_count", 0);
+        use_filter_thread = pt.get_or<bool>("use_filter_thread", use_filter_thread);
+        filter_thread_cpu = pt.get_or<int>("filter_thread_cpu", filter_thread_cpu);
+        filter_thread_spin_wait_count = std::max(pt.get_or<int>("filter_thread_spin_wait_count", filter_thread_spin_wait_count), 0);
     }
     else
     {
@@ -81,20 +92,6 @@ HMDManager::shutdown()
     DeviceTypeManager::shutdown();
 }
 
-void
-HMDManager::notifyVideoFrameReceived(ServerTrackerView* tracker_view)
-{
-	for (int device_id = 0; device_id < getMaxDevices(); ++device_id)
-	{
-		ServerHMDViewPtr hmdView = getHMDViewPtr(device_id);
-
-		if (hmdView->getIsOpen())
-		{
-			hmdView->notifyTrackerDataReceived(tracker_view);
-		}
-	}
-}
-
 void 
 HMDManager::updatePoseFilters()
 {
@@ -27,6 +27,13 @@ public:
 
     int version;
     int virtual_hmd_count;
+    // Run each HMD's pose filter on its own thread as sensor packets arrive,
+    // rather than once per service update
+    bool use_filter_thread;
+    // CPU to pin the filter threads to (-1 = no affinity)
+    int filter_thread_cpu;
+    // Times a filter thread checks for new packets before going to sleep (0 = sleep right away)
+    int filter_thread_spin_wait_count;
 };
 
 class HMDManager : public DeviceTypeManager
@@ -50,9 +57,6 @@ public:
         return cfg;
     }
 
-	// Broadcasts new video frame from a single tracker on tracker thread
-	void notifyVideoFrameReceived(class ServerTrackerView* tracker_view);
-
 	// Update Pose Filter using update packets from the tracker and IMU threads
 	void updatePoseFilters();
 
@@ -9,11 +9,15 @@
 #include "ServerDeviceView.h"
 #include "TrackerCapabilitiesConfig.h"
 #include "MathUtility.h"
+#include "PS3EyeVideo.h"
 #include "TrackerUSBDeviceEnumerator.h"
 #include "WMFCameraEnumerator.h"
+#include "TaskPool.h"
+#include "TimelineTrace.h"
 #include "USBDeviceManager.h"
 #include "Utility.h"
 
+#include <algorithm>
 #include <fstream>
 
 #ifdef _MSC_VER
@@ -34,10 +38,20 @@ TrackerManagerConfig::TrackerManagerConfig(const std::string &fnamebase)
 {
     //optical_tracking_timeout= 100;
     tracker_sleep_ms = 1;
-    use_bgr_to_hsv_lookup_table = true;
     min_valid_projection_area= 16;
     disable_roi = false;
     global_forward_degrees = 0.f;
+    pipeline_frame_count = 4;
+    segmentation_thread_cpu = -1;
+    solve_thread_cpu = -1;
+    publish_thread_cpu = -1;
+    pipeline_spin_wait_count = 0;
+    segmentation_worker_count = 2;
+    reacquisition_worker_count = 3;
+    record_timeline_trace = false;
+    timeline_trace_path = "psvr_timeline_trace.json";
+    preview_max_fps = 0.f;
+    preview_downscale = 1;
 };
 
 const configuru::Config
@@ -45,11 +59,21 @@ TrackerManagerConfig::writeToJSON()
 {
     configuru::Config pt{
         {"version", TrackerManagerConfig::CONFIG_VERSION},
-        {"use_bgr_to_hsv_lookup_table", use_bgr_to_hsv_lookup_table},
         {"tracker_sleep_ms", tracker_sleep_ms},
         {"min_valid_projection_area", min_valid_projection_area},	
         {"disable_roi", disable_roi},
         {"global_forward_degrees", global_forward_degrees},
+        {"pipeline_frame_count", pipeline_frame_count},
+        {"segmentation_thread_cpu", segmentation_thread_cpu},
+        {"solve_thread_cpu", solve_thread_cpu},
+        {"publish_thread_cpu", publish_thread_cpu},
+        {"pipeline_spin_wait_count", pipeline_spin_wait_count},
+        {"segmentation_worker_count", segmentation_worker_count},
+        {"reacquisition_worker_count", reacquisition_worker_count},
+        {"record_timeline_trace", record_timeline_trace},
+        {"timeline_trace_path", timeline_trace_path},
+        {"preview_max_fps", preview_max_fps},
+        {"preview_downscale", preview_downscale},
 		{"debug_show_tracking_model", (TrackerManagerConfig::debug_flags & PSMTrackerDebugFlags_trackingModel) > 0}
     };
 
@@ -64,11 +88,26 @@ TrackerManagerConfig::readFromJSON(const configuru::Config &pt)
     if (version == TrackerManagerConfig::CONFIG_VERSION)
     {
         //optical_tracking_timeout= pt.get_or<int>("optical_tracking_timeout", optical_tracking_timeout);
-        use_bgr_to_hsv_lookup_table = pt.get_or<bool>("use_bgr_to_hsv_lookup_table", use_bgr_to_hsv_lookup_table);
         tracker_sleep_ms = pt.get_or<int>("tracker_sleep_ms", tracker_sleep_ms);
         min_valid_projection_area = pt.get_or<float>("min_valid_projection_area", min_valid_projection_area);	
         disable_roi = pt.get_or<bool>("disable_roi", disable_roi);
         global_forward_degrees= pt.get_or<float>("global_forward_degrees", global_forward_degrees);
+        pipeline_frame_count= std::max(pt.get_or<int>("pipeline_frame_count", pipeline_frame_count), 2);
+        segmentation_thread_cpu= pt.get_or<int>("segmentation_thread_cpu", segmentation_thread_cpu);
+        solve_thread_cpu= pt.get_or<int>("solve_thread_cpu", solve_thread_cpu);
+        publish_thread_cpu= pt.get_or<int>("publish_thread_cpu", publish_thread_cpu);
+        pipeline_spin_wait_count= std::max(pt.get_or<int>("pipeline_spin_wait_count", pipeline_spin_wait_count), 0);
+        segmentation_worker_count= std::max(pt.get_or<int>("segmentation_worker_count", segmentation_worker_count), 0);
+        reacquisition_worker_count= std::max(pt.get_or<int>("reacquisition_worker_count", reacquisition_worker_count), 0);
+        record_timeline_trace= pt.get_or<bool>("record_timeline_trace", record_timeline_trace);
+        timeline_trace_path= pt.get_or<std::string>("timeline_trace_path", timeline_trace_path);
+        preview_max_fps= std::max(pt.get_or<float>("preview_max_fps", preview_max_fps), 0.f);
+        preview_downscale= pt.get_or<int>("preview_downscale", preview_downscale);
+        if (preview_downscale != 1 && preview_downscale != 2 && preview_downscale != 4)
+        {
+            PSVR_LOG_WARNING("TrackerManagerConfig") << "preview_downscale must be 1, 2 or 4 (got " << preview_downscale << "), using 1";
+            preview_downscale= 1;
+        }
 
 		unsigned int debug_flags= PSMTrackerDebugFlags_none;
 		if (pt.get_or<bool>("debug_show_tracking_model", false))
@@ -125,6 +164,8 @@ TrackerManagerConfig::get_global_down_axis() const
 TrackerManager::TrackerManager()
     : DeviceTypeManager(10000, 13)
 	, m_supportedTrackers(new TrackerCapabilitiesSet)
+    , m_segmentationTaskPool(nullptr)
+    , m_reacquisitionTaskPool(nullptr)
     , m_tracker_list_dirty(false)
 {
 	// Share the supported tracker list with the tracker enumerators
@@ -145,6 +186,21 @@ TrackerManager::startup()
         // Save back out the config in case there were updated defaults
         cfg.save();
 
+        if (cfg.record_timeline_trace)
+        {
+            TimelineTrace::startRecording();
+        }
+
+        // Spin up the workers shared by all of the tracker segmentation stages
+        m_segmentationTaskPool= new TaskPool("TrackerSegmentationWorker", cfg.segmentation_worker_count);
+
+        // Kept separate from the segmentation workers so a reacquisition search
+        // doesn't hold up segmentation of the next frame
+        if (cfg.reacquisition_worker_count > 0)
+        {
+            m_reacquisitionTaskPool= new TaskPool("TrackerReacquisitionWorker", cfg.reacquisition_worker_count);
+        }
+
 		// Fetch the config files for all the trackers we support
 		m_supportedTrackers->reloadSupportedTrackerCapabilities();
 
@@ -165,6 +221,39 @@ TrackerManager::startup()
     return bSuccess;
 }
 
+void
+TrackerManager::shutdown()
+{
+    // Closes the trackers, which stops their pipeline threads
+    DeviceTypeManager::shutdown();
+
+    // The threads keep their traced events after they exit, so the whole run is still there
+    if (cfg.record_timeline_trace && TimelineTrace::getIsRecording())
+    {
+        TimelineTrace::stopRecording();
+        TimelineTrace::writeChromeTrace(cfg.timeline_trace_path);
+    }
+
+    if (m_segmentationTaskPool != nullptr)
+    {
+        delete m_segmentationTaskPool;
+        m_segmentationTaskPool= nullptr;
+    }
+
+    if (m_reacquisitionTaskPool != nullptr)
+    {
+        delete m_reacquisitionTaskPool;
+        m_reacquisitionTaskPool= nullptr;
+    }
+}
+
+void 
+TrackerManager::pollOpeningTrackers()
+{
+    // Cameras open (and switch modes) in the background, their video streams start once they're set up
+    PS3EyeVideoDevice::updatePendingOpens();
+}
+
 void 
 TrackerManager::pollUpdatedVideoFrames()
 {
@@ -205,6 +294,12 @@ TrackerManager::can_update_connected_devices()
     return m_tracker_list_dirty && DeviceTypeManager::can_update_connected_devices();
 }
 
+void
+TrackerManager::wait_for_opening_devices()
+{
+    PS3EyeVideoDevice::waitForPendingOpens();
+}
+
 void 
 TrackerManager::mark_tracker_list_dirty()
 {
@@ -32,11 +32,35 @@ public:
 
     long version;
 	int tracker_sleep_ms;
-	bool use_bgr_to_hsv_lookup_table;
 	float min_valid_projection_area;
 	bool disable_roi;
 	float global_forward_degrees;
 
+	// Number of video frames in flight in each tracker's frame pipeline
+	int pipeline_frame_count;
+	// CPU core indices the tracker pipeline stages are pinned to (-1 = no affinity)
+	int segmentation_thread_cpu;
+	int solve_thread_cpu;
+	int publish_thread_cpu;
+	// Times a pipeline stage thread checks for a new frame before going to sleep (0 = sleep right away)
+	int pipeline_spin_wait_count;
+	// Number of worker threads in the task pool that per-HMD segmentation work is shared out on.
+	// The tracker's own segmentation thread always helps out, so 0 means no extra threads.
+	int segmentation_worker_count;
+	// Number of worker threads the brute force shape reacquisition search is split across
+	// (along with the tracker's solve thread). 0 runs the search serially on the solve thread.
+	int reacquisition_worker_count;
+	// Record a timeline trace of the service threads from startup, written to timeline_trace_path at shutdown
+	// (only if the service was built with PSVR_ENABLE_TIMELINE_TRACE)
+	bool record_timeline_trace;
+	std::string timeline_trace_path;
+	// Cap on the rate tracker video frames (with debug overlays) are published to an open video stream.
+	// 0 publishes every tracked frame. Tracking itself always runs at the camera rate.
+	float preview_max_fps;
+	// Divides the width and height of the published video frames (1, 2 or 4).
+	// Calibration needs full size frames, so keep this at 1 when calibrating.
+	int preview_downscale;
+
 	PSVRVector3f get_global_forward_axis() const;
 	PSVRVector3f get_global_backward_axis() const;
 	PSVRVector3f get_global_right_axis() const;
@@ -51,7 +75,9 @@ public:
     TrackerManager();
 
     bool startup() override;
+    void shutdown() override;
 
+	void pollOpeningTrackers();
 	void pollUpdatedVideoFrames();
     void closeAllTrackers();
 
@@ -68,6 +94,19 @@ public:
         return cfg;
     }
 
+    // Task pool shared by all trackers for per-HMD segmentation work
+    inline class TaskPool *getSegmentationTaskPool() const
+    {
+        return m_segmentationTaskPool;
+    }
+
+    // Task pool shared by all trackers for the brute force shape reacquisition search.
+    // nullptr if parallel reacquisition is disabled.
+    inline class TaskPool *getReacquisitionTaskPool() const
+    {
+        return m_reacquisitionTaskPool;
+    }
+
     PSVRTrackingColorType allocateTrackingColorID();
     bool claimTrackingColorID(const class ServerControllerView *controller_view, PSVRTrackingColorType color_id);
     bool claimTrackingColorID(const class ServerHMDView *hmd_view, PSVRTrackingColorType color_id);
@@ -75,6 +114,7 @@ public:
 
 protected:
     bool can_update_connected_devices() override;
+    void wait_for_opening_devices() override;
     void mark_tracker_list_dirty();
 
     DeviceEnumerator *allocate_device_enumerator() override;
@@ -86,6 +126,8 @@ private:
 	class TrackerCapabilitiesSet *m_supportedTrackers;
 	std::deque<PSVRTrackingColorType> m_available_color_ids;
     TrackerManagerConfig cfg;
+    class TaskPool *m_segmentationTaskPool;
+    class TaskPool *m_reacquisitionTaskPool;
     bool m_tracker_list_dirty;
 };
 
@@ -7,12 +7,18 @@
 #include "NullUSBApi.h"
 #include "WinUSBApi.h"
 #include "Logger.h"
+#include "ThreadSignal.h"
+#include "TimelineTrace.h"
 #include "Utility.h"
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <deque>
 #include <thread>
 #include <vector>
 #include <map>
+#include <set>
 
 #include "readerwriterqueue.h" // lockfree queue
 
@@ -26,6 +32,20 @@ const char * k_nullusb_api_name= "nullusb_api";
 const char * k_libusb_api_name= "libusb_api";
 const char * k_winusb_api_name= "winusb_api";
 
+// Submitters wake the worker thread and the worker wakes blocking submitters, these are just backstops
+static const std::chrono::milliseconds k_idle_worker_wait_timeout(100);
+static const std::chrono::milliseconds k_blocking_transfer_wait_timeout(10);
+static const std::chrono::milliseconds k_cancel_bulk_transfer_timeout(500);
+
+//-- private definitions -----
+// A bulk transfer bundle whose transfers were canceled but haven't all come back yet
+struct USBCanceledBulkTransferBundle
+{
+	IUSBBulkTransferBundle *bundle;
+	// When the worker gives up waiting and frees the bundle anyway
+	std::chrono::steady_clock::time_point cleanup_deadline;
+};
+
 //-- private implementation -----
 
 //-- USB Manager Config -----
@@ -82,6 +102,7 @@ public:
 		, m_active_interrupt_transfers(0)
 		, m_transfers_enabled(false)
         , m_thread_started(false)
+		, m_main_thread_id()
 		, m_next_usb_device_handle(0)
     {
 
@@ -97,6 +118,7 @@ public:
         bool bSuccess= false;
 
 		m_transfers_enabled= cfg.enable_usb_transfers;
+		m_main_thread_id= std::this_thread::get_id();
 
 		if (m_usb_api == nullptr)
 		{
@@ -167,6 +189,9 @@ public:
 
     void update()
     {
+		// Results are handed over in a single consumer queue
+		assert(getIsMainThread());
+
         // If the thread terminated, reset the started and exited flags
         if (m_exit_signaled)
         {
@@ -237,6 +262,19 @@ public:
 		{
 			USBDeviceState *usb_device_state= iter->second;
 
+			// A canceled bulk transfer bundle can still hold device memory of this device,
+			// which has to be freed before the device is closed. Cancel requests are only
+			// answered once the worker has freed all of the device's canceled bundles.
+			if (m_transfers_enabled && m_thread_started)
+			{
+				USBTransferRequest request;
+				memset(&request, 0, sizeof(USBTransferRequest));
+				request.request_type= eUSBTransferRequestType::_USBRequestType_CancelBulkTransferBundle;
+				request.payload.cancel_bulk_transfer_bundle.usb_device_handle= handle;
+
+				submitTransferRequestBlocking(request);
+			}
+
 			m_device_state_map.erase(iter);
 			m_usb_api->close_usb_device(usb_device_state);
 		}
@@ -265,8 +303,8 @@ public:
 
 			if (request_queue.enqueue(requestState))
 			{
-				// Give the other thread a chance to process the request
-				Utility::sleep_ms(10);
+				// Wake the worker thread if it's idle
+				m_request_signal.notify();
 				bAddedRequest= true;
 			}
 		}
@@ -302,6 +340,11 @@ public:
 				result.payload.bulk_transfer.result_code= eUSBResultCode::_USBResultCode_SubmitFailed;
 				result.payload.bulk_transfer.usb_device_handle= request.payload.cancel_bulk_transfer_bundle.usb_device_handle;
 				break;
+			case eUSBTransferRequestType::_USBRequestType_ControlTransferBatch:
+				result.result_type= _USBResultType_ControlTransferBatch;
+				result.payload.control_transfer_batch.result_code= eUSBResultCode::_USBResultCode_SubmitFailed;
+				result.payload.control_transfer_batch.usb_device_handle= request.payload.control_transfer_batch.usb_device_handle;
+				break;
 			}
 			
 			callback(result);
@@ -366,11 +409,18 @@ public:
 		USBTransferResultState state = { result, callback };
 
 		// If a control transfer just completed (successfully or unsuccessfully)
-		// decrement the outstanding control transfer count
+		// decrement the outstanding control transfer count and free up the device for the next one
 		if (result.result_type == _USBResultType_ControlTransfer)
 		{
 			assert(m_active_control_transfers > 0);
 			--m_active_control_transfers;
+			m_busy_control_devices.erase(result.payload.control_transfer.usb_device_handle);
+		}
+		else if (result.result_type == _USBResultType_ControlTransferBatch)
+		{
+			assert(m_active_control_transfers > 0);
+			--m_active_control_transfers;
+			m_busy_control_devices.erase(result.payload.control_transfer_batch.usb_device_handle);
 		}
 		// If a interrupt transfer just completed (successfully or unsuccessfully)
 		// decrement the outstanding interrupt transfer count
@@ -388,6 +438,53 @@ public:
 		}
 
 		result_queue.enqueue(state);
+		m_result_signal.notify();
+	}
+
+	// Sends the transfer request to the worker thread and blocks the calling (main) thread until it completes
+	USBTransferResult submitTransferRequestBlocking(const USBTransferRequest &request)
+	{
+		// Only the main thread can wait on and consume transfer results
+		assert(getIsMainThread());
+
+		USBTransferResult result;
+		bool bIsPending = true;
+
+		// Submit the async usb request to the worker thread
+		submitTransferRequest(
+			request,
+			[&result, &bIsPending](USBTransferResult &r)
+			{
+				result = r;
+				bIsPending = false;
+			}
+		);
+
+		// Sleep until the worker thread posts the result
+		while (bIsPending)
+		{
+			waitForTransferResults(k_blocking_transfer_wait_timeout);
+
+			// Poll to see if the transfer completed
+			// (will execute the callback on completion)
+			update();
+		}
+
+		return result;
+	}
+
+	// Blocks the calling (main) thread until the worker thread posts a transfer result or the timeout runs out.
+	// m_result_signal only supports one waiting thread, and only the main thread consumes the results anyway.
+	bool waitForTransferResults(const std::chrono::microseconds &timeout)
+	{
+		assert(getIsMainThread());
+		return m_result_signal.wait(timeout);
+	}
+
+	// The thread that started the manager up, the only one allowed to consume transfer results
+	inline bool getIsMainThread() const
+	{
+		return std::this_thread::get_id() == m_main_thread_id;
 	}
 
 protected:
@@ -401,9 +498,11 @@ protected:
         }
     }
 
+    // Returns false if there was nothing for the worker thread to do
     bool processRequests()
     {
         bool bHadRequests= false;
+        bool bPolledTransfers= false;
 
         // Process incoming USB transfer requests
 		USBTransferRequestState requestState;
@@ -415,7 +514,8 @@ protected:
 				handleInterruptTransferRequest(requestState);
 				break;
             case eUSBTransferRequestType::_USBRequestType_ControlTransfer:
-                handleControlTransferRequest(requestState);
+            case eUSBTransferRequestType::_USBRequestType_ControlTransferBatch:
+                dispatchOrDeferControlRequest(requestState);
                 break;
             case eUSBTransferRequestType::_USBRequestType_BulkTransfer:
                 handleBulkTransferRequest(requestState);
@@ -437,18 +537,106 @@ protected:
             m_active_control_transfers > 0 ||
 			m_active_interrupt_transfers > 0)
         {
-            // If we have a blocking transfer pending keep polling until we get the result back.
-			// Otherwise just poll once.
-            do
-            {
-				m_usb_api->poll();
-            } while (m_active_bulk_transfers > 0 || m_active_control_transfers > 0 || m_active_interrupt_transfers > 0);
+            PSVR_TRACE_ZONE("USB Poll");
+
+            // Poll once and go back around for new requests, even with transfers still pending.
+            // That way a control transfer batch for one device doesn't hold up another device's requests.
+            m_usb_api->poll();
 
             // Cleanup any requests that no longer have any pending cancellations
             cleanupCanceledRequests(false);
+
+            bPolledTransfers= true;
         }
 
-        return bHadRequests;
+        // Start any control requests that were waiting on a device that just freed up
+        if (m_deferred_control_requests.size() > 0)
+        {
+            dispatchDeferredControlRequests();
+        }
+
+        return bHadRequests || bPolledTransfers || m_deferred_control_requests.size() > 0;
+    }
+
+    // Only one control transfer (or batch) runs per device at a time.
+    // Otherwise a single write submitted from one place could land in the middle of
+    // another place's SCCB sequence on the same camera and scramble both.
+    static t_usb_device_handle getControlRequestDeviceHandle(const USBTransferRequest &request)
+    {
+        return (request.request_type == _USBRequestType_ControlTransferBatch)
+            ? request.payload.control_transfer_batch.usb_device_handle
+            : request.payload.control_transfer.usb_device_handle;
+    }
+
+    void dispatchOrDeferControlRequest(const USBTransferRequestState &requestState)
+    {
+        const t_usb_device_handle handle= getControlRequestDeviceHandle(requestState.request);
+
+        // Requests behind a deferred one for the same device have to wait their turn too
+        if (m_busy_control_devices.count(handle) > 0 || isControlRequestDeferred(handle))
+        {
+            m_deferred_control_requests.push_back(requestState);
+        }
+        else
+        {
+            dispatchControlRequest(requestState);
+        }
+    }
+
+    void dispatchControlRequest(const USBTransferRequestState &requestState)
+    {
+        // Mark the device busy first since a backend that completes the transfer
+        // synchronously posts the result (and clears the flag) before returning
+        m_busy_control_devices.insert(getControlRequestDeviceHandle(requestState.request));
+
+        if (requestState.request.request_type == _USBRequestType_ControlTransferBatch)
+        {
+            handleControlTransferBatchRequest(requestState);
+        }
+        else
+        {
+            handleControlTransferRequest(requestState);
+        }
+    }
+
+    bool isControlRequestDeferred(t_usb_device_handle handle) const
+    {
+        for (const USBTransferRequestState &deferred : m_deferred_control_requests)
+        {
+            if (getControlRequestDeviceHandle(deferred.request) == handle)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void dispatchDeferredControlRequests()
+    {
+        // Start the oldest deferred request of every device that isn't busy anymore,
+        // keeping later requests for the same device queued in submission order
+        std::set<t_usb_device_handle> blocked_devices= m_busy_control_devices;
+
+        auto it = m_deferred_control_requests.begin();
+        while (it != m_deferred_control_requests.end())
+        {
+            const t_usb_device_handle handle= getControlRequestDeviceHandle(it->request);
+
+            if (blocked_devices.count(handle) == 0)
+            {
+                const USBTransferRequestState requestState= *it;
+
+                it= m_deferred_control_requests.erase(it);
+                blocked_devices.insert(handle);
+                dispatchControlRequest(requestState);
+            }
+            else
+            {
+                blocked_devices.insert(handle);
+                ++it;
+            }
+        }
     }
 
     void processResults()
@@ -467,6 +655,7 @@ protected:
     {
         // Drain the request queue
         while (request_queue.pop());
+        m_deferred_control_requests.clear();
 
         // Cancel all active transfers
         while (m_active_bulk_transfer_bundles.size() > 0)
@@ -474,7 +663,7 @@ protected:
             IUSBBulkTransferBundle *bundle= m_active_bulk_transfer_bundles.back();
             m_active_bulk_transfer_bundles.pop_back();
             bundle->cancelTransfers();
-            m_canceled_bulk_transfer_bundles.push_back(bundle);
+            addCanceledBulkTransferBundle(bundle);
         }
 
         // Wait for the canceled bulk transfers and control transfers to exit
@@ -500,23 +689,56 @@ protected:
     void workerThreadFunc()
     {
         Utility::set_current_thread_name("USB Async Worker Thread");
+        PSVR_TRACE_THREAD_NAME("USB Async Worker Thread");
 
         // Stay in the message loop until asked to exit by the main thread
         while (!m_exit_signaled)
         {
-            processRequests();
+            if (!processRequests())
+            {
+                // No transfers in flight, so sleep until the next request is submitted
+                m_request_signal.wait(k_idle_worker_wait_timeout);
+            }
         }
     }
 
+    void addCanceledBulkTransferBundle(IUSBBulkTransferBundle *bundle)
+    {
+        USBCanceledBulkTransferBundle canceled_bundle;
+        canceled_bundle.bundle= bundle;
+        canceled_bundle.cleanup_deadline= std::chrono::steady_clock::now() + k_cancel_bulk_transfer_timeout;
+
+        m_canceled_bulk_transfer_bundles.push_back(canceled_bundle);
+    }
+
+    bool hasCanceledBulkTransferBundle(t_usb_device_handle handle) const
+    {
+        return std::any_of(
+            m_canceled_bulk_transfer_bundles.begin(),
+            m_canceled_bulk_transfer_bundles.end(),
+            [handle](const USBCanceledBulkTransferBundle &canceled_bundle) {
+                return canceled_bundle.bundle->getUSBDeviceHandle() == handle;
+            });
+    }
+
     void cleanupCanceledRequests(bool bForceCleanup)
     {
+        const std::chrono::steady_clock::time_point now= std::chrono::steady_clock::now();
+
 		auto it = m_canceled_bulk_transfer_bundles.begin();
         while (it != m_canceled_bulk_transfer_bundles.end())
         {
-            IUSBBulkTransferBundle *bundle = *it;
+            IUSBBulkTransferBundle *bundle = it->bundle;
+            const bool bTimedOut= now >= it->cleanup_deadline;
 
-            if (bundle->getActiveTransferCount() == 0 || bForceCleanup)
+            if (bundle->getActiveTransferCount() == 0 || bTimedOut || bForceCleanup)
             {
+                if (bundle->getActiveTransferCount() > 0 && bTimedOut)
+                {
+                    PSVR_MT_LOG_WARNING("USBAsyncRequestManager::cleanupCanceledRequests")
+                        << "Bulk transfers of device " << bundle->getUSBDeviceHandle() << " didn't cancel in time, freeing them anyway";
+                }
+
                 it= m_canceled_bulk_transfer_bundles.erase(it);
                 delete bundle;
             }
@@ -525,6 +747,23 @@ protected:
 				++it;
 			}
         }
+
+        // Answer the cancel requests whose device no longer has any canceled bundles
+        auto request_it = m_pending_cancel_results.begin();
+        while (request_it != m_pending_cancel_results.end())
+        {
+            if (bForceCleanup || !hasCanceledBulkTransferBundle(request_it->result.payload.bulk_transfer.usb_device_handle))
+            {
+                USBTransferResultState resultState= *request_it;
+
+                request_it= m_pending_cancel_results.erase(request_it);
+                postUSBTransferResult(resultState.result, resultState.callback);
+            }
+            else
+            {
+                ++request_it;
+            }
+        }
     }
 
 	void handleInterruptTransferRequest(const USBTransferRequestState &requestState)
@@ -640,6 +879,48 @@ protected:
         }
     }
 
+    void handleControlTransferBatchRequest(const USBTransferRequestState &requestState)
+    {
+        const USBRequestPayload_ControlTransferBatch &request = requestState.request.payload.control_transfer_batch;
+
+		t_usb_device_map_iterator iter = m_device_state_map.find(request.usb_device_handle);
+		USBDeviceState *state = (iter != m_device_state_map.end()) ? iter->second : nullptr;
+
+        eUSBResultCode result_code;
+        bool bSuccess= true;
+
+        // The whole batch counts as one control transfer, so we keep polling until its last op completes
+        ++m_active_control_transfers;
+
+		if (state != nullptr)
+		{
+			result_code = m_usb_api->submit_control_transfer_batch(state, &requestState);
+			if (result_code != _USBResultCode_Started && result_code != _USBResultCode_Completed)
+			{
+                bSuccess = false;
+			}
+		}
+		else
+		{
+			result_code = _USBResultCode_BadHandle;
+			bSuccess = false;
+		}
+
+        // The API posts the result of any batch it accepted (failed or not),
+        // so we only post one here if the batch was never accepted
+        if (!bSuccess)
+        {
+            USBTransferResult result;
+
+            memset(&result, 0, sizeof(USBTransferResult));
+            result.payload.control_transfer_batch.usb_device_handle= request.usb_device_handle;
+            result.payload.control_transfer_batch.result_code= result_code;
+            result.result_type = _USBResultType_ControlTransferBatch;
+
+            postUSBTransferResult(result, requestState.callback);
+        }
+    }
+
 	void handleBulkTransferRequest(const USBTransferRequestState &requestState)
 	{
 		const USBRequestPayload_BulkTransfer &request = requestState.request.payload.bulk_transfer;
@@ -739,7 +1020,7 @@ protected:
                             // If any transfers started we have to cancel the ones that started
                             // and wait for the cancellation request to complete.
                             bundle->cancelTransfers();
-                            m_canceled_bulk_transfer_bundles.push_back(bundle);
+                            addCanceledBulkTransferBundle(bundle);
                         }
                         else
                         {
@@ -810,8 +1091,8 @@ protected:
                 m_active_bulk_transfer_bundles.erase(it);
 
                 // Put the bundle on the list of canceled transfers.
-                // The bundle will get cleaned up once all active transfers are done.
-                m_canceled_bulk_transfer_bundles.push_back(bundle);
+                // The bundle will get cleaned up once all active transfers are done (or the cancel times out).
+                addCanceledBulkTransferBundle(bundle);
 
                 result_code = _USBResultCode_Canceled;
             }
@@ -833,7 +1114,18 @@ protected:
             result.payload.bulk_transfer.usb_device_handle = request.usb_device_handle;
             result.payload.bulk_transfer.result_code = result_code;
 
-            postUSBTransferResult(result, requestState.callback);
+            if (hasCanceledBulkTransferBundle(request.usb_device_handle))
+            {
+                // The caller usually closes the device next, and the bundle's transfer buffer may be
+                // device memory that has to be freed while the device is still open.
+                // Hold the result back until cleanupCanceledRequests() has freed the device's bundles.
+                USBTransferResultState resultState = { result, requestState.callback };
+                m_pending_cancel_results.push_back(resultState);
+            }
+            else
+            {
+                postUSBTransferResult(result, requestState.callback);
+            }
         }
     }
 
@@ -845,6 +1137,7 @@ protected:
             {
                 PSVR_LOG_INFO("USBAsyncRequestManager::startup") << "Stopping USB event thread...";
                 m_exit_signaled = true;
+                m_request_signal.notify();
                 m_worker_thread.join();
                 PSVR_LOG_INFO("USBAsyncRequestManager::startup") << "USB event thread stopped";
             }
@@ -876,18 +1169,24 @@ private:
     std::atomic_bool m_exit_signaled;
     moodycamel::ReaderWriterQueue<USBTransferRequestState, 128> request_queue;
     moodycamel::ReaderWriterQueue<USBTransferResultState, 128> result_queue;
+    ThreadSignal m_request_signal; // request posted to the worker thread
+    ThreadSignal m_result_signal; // result posted to the main thread
 
     // Worker thread state
     std::vector<IUSBBulkTransferBundle *> m_active_bulk_transfer_bundles;
-    std::vector<IUSBBulkTransferBundle *> m_canceled_bulk_transfer_bundles;
+    std::vector<USBCanceledBulkTransferBundle> m_canceled_bulk_transfer_bundles;
+    std::vector<USBTransferResultState> m_pending_cancel_results; // cancel results waiting on canceled bundles
     int m_active_control_transfers;
 	int m_active_interrupt_transfers;
     int m_active_bulk_transfers;
+    std::set<t_usb_device_handle> m_busy_control_devices;
+    std::deque<USBTransferRequestState> m_deferred_control_requests;
 
     // Main thread state
 	bool m_transfers_enabled;
     bool m_thread_started;
     std::thread m_worker_thread;
+    std::thread::id m_main_thread_id;
     std::vector<USBDeviceFilter> m_device_whitelist;
 	t_usb_device_map m_device_state_map;
 	t_usb_device_handle m_next_usb_device_handle;
@@ -1014,33 +1313,15 @@ bool usb_device_submit_transfer_request_async(
 // Send the transfer request to the worker thread and block until it completes
 USBTransferResult usb_device_submit_transfer_request_blocking(const USBTransferRequest &request)
 {
-	USBDeviceManagerImpl *deviceManagerImpl= USBDeviceManager::getInstance()->getImplementation();
-
-	USBTransferResult result;
-	bool bIsPending = true;
-
-	// Submit the async usb control transfer request to the worker thread
-	deviceManagerImpl->submitTransferRequest(
-		request,
-		[&result, &bIsPending](USBTransferResult &r)
-		{
-			result = r;
-			bIsPending = false;
-		}
-	);
-
-	// Spin until the transfer completes
-	while (bIsPending)
-	{
-		// Give the worker thread a chance to do work
-		Utility::sleep_ms(1);
+	return USBDeviceManager::getInstance()->getImplementation()->submitTransferRequestBlocking(request);
+}
 
-		// Poll to see if the transfer completed
-		// (will execute the callback on completion)
-		deviceManagerImpl->update();
-	}
+void usb_device_wait_for_transfer_results()
+{
+	USBDeviceManagerImpl *deviceManagerImpl= USBDeviceManager::getInstance()->getImplementation();
 
-	return result;
+	deviceManagerImpl->waitForTransferResults(k_blocking_transfer_wait_timeout);
+	deviceManagerImpl->update();
 }
 
 // -- Device Queries ----
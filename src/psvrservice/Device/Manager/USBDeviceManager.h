@@ -90,9 +90,13 @@ bool usb_device_submit_transfer_request_async(
 	const USBTransferRequest &request,
 	std::function<void(USBTransferResult&)> callback = [](USBTransferResult &result) {});
 
-// Send the transfer request to the worker thread and block until it completes
+// Send the transfer request to the worker thread and block until it completes (main thread only)
 USBTransferResult usb_device_submit_transfer_request_blocking(const USBTransferRequest &request);
 
+// Block until the worker thread posts a transfer result (or a short timeout runs out),
+// then fire the callbacks of any async requests that completed (main thread only)
+void usb_device_wait_for_transfer_results();
+
 // -- Device Queries ----
 bool usb_device_can_be_opened(struct USBDeviceEnumerator* enumerator, char *outReason, size_t bufferSize);
 bool usb_device_get_filter(t_usb_device_handle handle, USBDeviceFilter &outDeviceInfo);
@@ -8,9 +8,15 @@
 #include "TrackingModelMath.h"
 #include "TrackerMath.h"
 #include "TrackerManager.h"
+#include "DeviceManager.h"
+#include "FrameArena.h"
+#include "Logger.h"
+#include "TaskPool.h"
 #include "Utility.h"
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <bitset>
 #include <vector>
 
@@ -26,6 +32,29 @@ static const float k_reprojection_correspondance_tolerance_px = 15.0f;
 static const float k_reprojection_correspondance_tolerance_px_sqrd = 
 	k_reprojection_correspondance_tolerance_px*k_reprojection_correspondance_tolerance_px;
 
+// Model triangles whose plane normal is within this angle (as a cosine) of their LED normals
+// always have the same winding in the image when the LEDs are visible
+static const float k_min_winding_normal_cosine= 0.7f;
+
+// Image triangles with a smaller signed area than this (px^2) are too thin to have a reliable winding
+static const float k_min_winding_image_area_px_sqrd= 1.f;
+
+// Slack on the predicted facing test, since the predicted orientation is only an estimate
+static const float k_predicted_visibility_slack= 0.25f;
+
+// Upper bound on the solveP3P calls made by one brute force reacquisition
+static const int k_max_reacquisition_hypotheses= 2048;
+
+// Stop searching once every image point lies within this distance (cm) of its model point ray on average
+static const float k_accepted_ray_distance_cm= 0.5f;
+static const float k_accepted_ray_distance_cm_sqrd= k_accepted_ray_distance_cm*k_accepted_ray_distance_cm;
+
+// Number of consecutive hypotheses a reacquisition worker claims at a time
+static const int k_reacquisition_hypotheses_per_chunk= 16;
+
+// Scratch memory for one tracking frame's worth of correspondence and pose fitting
+static const size_t k_frame_arena_size= 16*1024;
+
 //-- private structures ----
 struct MonoPointCorrespondence
 {
@@ -155,11 +184,128 @@ struct PoseHistory
 	}
 };
 
+// The visible model triangle permutations bucketed by the winding they must have in the image.
+// The winding of a front facing triangle is preserved by any camera pose, unlike its side ratios or angles,
+// so this lets the brute force search skip half of the model triangles for each detected triangle.
+struct ModelTriangleIndex
+{
+	enum eImageWinding
+	{
+		ImageWinding_Negative, // (p1-p0) x (p2-p0) < 0 in pixel space
+		ImageWinding_Positive, // (p1-p0) x (p2-p0) > 0 in pixel space
+		ImageWinding_Ambiguous, // triangle plane isn't aligned with its LEDs, could be seen either way
+
+		ImageWinding_COUNT
+	};
+
+	std::vector<t_tri_index_tuple> triangles[ImageWinding_COUNT];
+	std::vector<cv::Point3f> cvModelPoints; // model vertices in OpenCV object space
+
+	void build(
+		const std::vector<Eigen::Vector3f> &vertices,
+		const std::vector<Eigen::Vector3f> &normals,
+		const std::vector<t_tri_index_tuple> &tri_permutations)
+	{
+		for (int winding = 0; winding < ImageWinding_COUNT; ++winding)
+		{
+			triangles[winding].clear();
+		}
+
+		cvModelPoints.clear();
+		for (const Eigen::Vector3f &vertex : vertices)
+		{
+			cvModelPoints.push_back(eigen_opengl_vector3f_to_cv_point3f(vertex));
+		}
+
+		// Figure out if the LED normals point out of the shape (the expected convention)
+		// by comparing them against the direction from the centroid
+		Eigen::Vector3f centroid= Eigen::Vector3f::Zero();
+		for (const Eigen::Vector3f &vertex : vertices)
+		{
+			centroid+= vertex;
+		}
+		centroid/= static_cast<float>(vertices.size());
+
+		float outward_sum= 0.f;
+		for (size_t vertex_index = 0; vertex_index < vertices.size(); ++vertex_index)
+		{
+			outward_sum+= normals[vertex_index].dot(vertices[vertex_index] - centroid);
+		}
+		const float outward_sign= (outward_sum >= 0.f) ? 1.f : -1.f;
+
+		// The image winding of a triangle is the sign of det(p0, p1, p2) in camera space
+		// (OpenCV's camera frame is right handed and the model to object space mapping is a rotation).
+		// That is negative for a triangle whose vertex order winds counter-clockwise
+		// around the normal facing the camera.
+		for (const t_tri_index_tuple &tri : tri_permutations)
+		{
+			const Eigen::Vector3f &v0= vertices[tri[0]];
+			const Eigen::Vector3f &v1= vertices[tri[1]];
+			const Eigen::Vector3f &v2= vertices[tri[2]];
+			const Eigen::Vector3f led_normal= 
+				(outward_sign*(normals[tri[0]] + normals[tri[1]] + normals[tri[2]])).normalized();
+			const Eigen::Vector3f tri_normal= (v1 - v0).cross(v2 - v0).normalized();
+			const float cosine= tri_normal.dot(led_normal);
+
+			if (cosine >= k_min_winding_normal_cosine)
+			{
+				triangles[ImageWinding_Negative].push_back(tri);
+			}
+			else if (cosine <= -k_min_winding_normal_cosine)
+			{
+				triangles[ImageWinding_Positive].push_back(tri);
+			}
+			else
+			{
+				triangles[ImageWinding_Ambiguous].push_back(tri);
+			}
+		}
+	}
+};
+
+// A (detected triangle, model triangle) pairing the brute force search runs solveP3P on
+struct ReacquisitionHypothesis
+{
+	int proj_tri_index; // index into the detected triangle combinations
+	const t_tri_index_tuple *model_tri;
+};
+
+// Best solution found in one chunk of reacquisition hypotheses
+struct ReacquisitionChunkResult
+{
+	int hypothesis_index; // -1 if no solution in the chunk scored
+	int solution_index;
+	float score;
+	int hypothesis_count; // solveP3P calls made
+};
+
+// Buffers reused by every hypothesis one reacquisition worker evaluates
+struct ReacquisitionScratch
+{
+	std::vector<cv::Mat> cv_model_rvecs;
+	std::vector<cv::Mat> cv_model_tvecs;
+	std::vector<cv::Point2f> cv_image_points;
+	std::vector<cv::Point3f> cv_object_points;
+	std::vector<MonoPointCorrespondence> point_correspondences;
+
+	ReacquisitionScratch()
+	{
+		cv_model_rvecs.reserve(4);
+		cv_model_tvecs.reserve(4);
+		cv_image_points.reserve(3);
+		cv_object_points.reserve(3);
+		point_correspondences.reserve(MAX_POINT_CLOUD_POINT_COUNT);
+	}
+};
+
 struct MonoPointCloudTrackingModelState
 {
     std::vector<Eigen::Vector3f> modelVertices;
 	std::vector<Eigen::Vector3f> modelNormals;
 	std::vector<t_tri_index_tuple> modelTriIndexPermutations;
+	ModelTriangleIndex modelTriangleIndex;
+
+	MonoPointCloudReacquisitionStatistics reacquisitionStats;
 
 	PoseHistory poseHistory;
 
@@ -168,6 +314,17 @@ struct MonoPointCloudTrackingModelState
     bool bIsCurrentOpticalTransformValid;
 
     std::vector<MonoPointCorrespondence> currentPointCorrespondences;
+	std::vector<MonoPointCorrespondence> newPointCorrespondences; // scratch, swapped with the current list
+
+	// Scratch memory for the frame being applied, reset at the start of each frame
+	FrameArena frameArena;
+
+	MonoPointCloudTrackingModelState()
+		: frameArena(k_frame_arena_size)
+	{
+		currentPointCorrespondences.reserve(MAX_POINT_CLOUD_POINT_COUNT);
+		newPointCorrespondences.reserve(MAX_POINT_CLOUD_POINT_COUNT);
+	}
 
 	void clearHistory()
 	{
@@ -184,8 +341,11 @@ static bool compute_transform_using_best_fit_correspondence(
 	const PSVRTrackingProjection &projection,
 	const std::vector<Eigen::Vector3f> &model_vertices,
 	const std::vector<Eigen::Vector3f> &model_normals,
-	const std::vector<t_tri_index_tuple> &model_tri_permutations,
+	const ModelTriangleIndex &model_triangle_index,
 	const Eigen::Affine3d *predicted_model_transform_ptr,
+	class TaskPool *reacquisition_task_pool,
+	FrameArena &frame_arena,
+	MonoPointCloudReacquisitionStatistics &reacquisition_stats,
 	std::vector<MonoPointCorrespondence> &out_point_correspondences,
 	Eigen::Affine3d &out_transform);
 static bool compute_predicted_point_correspondences(
@@ -194,14 +354,17 @@ static bool compute_predicted_point_correspondences(
 	const std::vector<Eigen::Vector3f> &model_vertices,
 	const std::vector<Eigen::Vector3f> &model_normals,
 	const Eigen::Affine3d &predicted_model_transform,
+	FrameArena &frame_arena,
 	std::vector<MonoPointCorrespondence> &out_point_correspondences);
 static bool compute_brute_force_image_ray_correspondences(
 	const ServerTrackerView *tracker_view,
 	const PSVRTrackingProjection &projection,
     const std::vector<Eigen::Vector3f> &model_vertices,
 	const std::vector<Eigen::Vector3f> &model_normals,
-	const std::vector<t_tri_index_tuple> &model_tri_permutations,
+	const ModelTriangleIndex &model_triangle_index,
 	const Eigen::Affine3d *predicted_model_transform,
+	class TaskPool *task_pool,
+	int &out_hypothesis_count,
 	Eigen::Affine3d &out_model_transform,
 	std::vector<MonoPointCorrespondence> &out_point_correspondences);
 
@@ -211,6 +374,7 @@ MonoPointCloudTrackingModel::MonoPointCloudTrackingModel() :
 {
     m_state->currentOpticalTransform= Eigen::Affine3d::Identity();
     m_state->bIsCurrentOpticalTransformValid= false;
+	m_state->reacquisitionStats= MonoPointCloudReacquisitionStatistics();
 }
 
 MonoPointCloudTrackingModel::~MonoPointCloudTrackingModel()
@@ -246,6 +410,12 @@ bool MonoPointCloudTrackingModel::init(PSVRTrackingShape *tracking_shape)
             m_state->modelNormals,
             m_state->modelTriIndexPermutations);
 
+		// Index the triangles by the winding they can appear with in the image
+		m_state->modelTriangleIndex.build(
+			m_state->modelVertices,
+			m_state->modelNormals,
+			m_state->modelTriIndexPermutations);
+
         bSuccess= true;
     }
 
@@ -286,24 +456,32 @@ bool MonoPointCloudTrackingModel::applyShapeProjectionFromTracker(
 		predicted_transform_ptr= &predicted_transform;
 	}
 
-	// Make a local copy of the model vertices and normals
-	std::vector<Eigen::Vector3f> model_vertices= m_state->modelVertices;
-	std::vector<Eigen::Vector3f> model_normals= m_state->modelNormals;
+	// Only this model's solve thread touches the model state, so no need to copy it
+	const std::vector<Eigen::Vector3f> &model_vertices= m_state->modelVertices;
+	const std::vector<Eigen::Vector3f> &model_normals= m_state->modelNormals;
+
+	// Everything the previous frame allocated from the arena is dead by now
+	m_state->frameArena.reset();
+
+	// Reacquisition is split across this pool if parallel reacquisition is enabled
+	TaskPool *reacquisition_task_pool= DeviceManager::getInstance()->getTrackerManager()->getReacquisitionTaskPool();
 
 	// Try to find the optical transform of the lights using best fit correspondence
 	Eigen::Affine3d new_transform;
-	std::vector<MonoPointCorrespondence> new_correspondences;
 	if (compute_transform_using_best_fit_correspondence(
 			tracker_view, projection, 
-			model_vertices, model_normals, m_state->modelTriIndexPermutations,
+			model_vertices, model_normals, m_state->modelTriangleIndex,
 			predicted_transform_ptr,
-			new_correspondences, new_transform))
+			reacquisition_task_pool,
+			m_state->frameArena,
+			m_state->reacquisitionStats,
+			m_state->newPointCorrespondences, new_transform))
 	{
 		m_state->currentOpticalTransform= new_transform;
 		m_state->currentTransformTimestamp= now;
 		m_state->bIsCurrentOpticalTransformValid= true;
 
-		m_state->currentPointCorrespondences= new_correspondences;
+		m_state->currentPointCorrespondences.swap(m_state->newPointCorrespondences);
 		bSuccess= true;
 	}
 	else
@@ -380,6 +558,11 @@ bool MonoPointCloudTrackingModel::getPointCloudProjectionShapeCorrelation(PSVRTr
     return m_state->bIsCurrentOpticalTransformValid;
 }
 
+void MonoPointCloudTrackingModel::getReacquisitionStatistics(MonoPointCloudReacquisitionStatistics &out_stats) const
+{
+	out_stats= m_state->reacquisitionStats;
+}
+
 //-- private implementation -----
 static void compute_image_point_camera_rays(
 	const cv::Matx33f &intrinsic_matrix,
@@ -429,8 +612,11 @@ static bool compute_transform_using_best_fit_correspondence(
 	const PSVRTrackingProjection &projection,
 	const std::vector<Eigen::Vector3f> &model_vertices,
 	const std::vector<Eigen::Vector3f> &model_normals,
-	const std::vector<t_tri_index_tuple> &model_tri_permutations,
+	const ModelTriangleIndex &model_triangle_index,
 	const Eigen::Affine3d *predicted_model_transform_ptr,
+	class TaskPool *reacquisition_task_pool,
+	FrameArena &frame_arena,
+	MonoPointCloudReacquisitionStatistics &reacquisition_stats,
 	std::vector<MonoPointCorrespondence> &out_point_correspondences,
 	Eigen::Affine3d &out_transform)
 {
@@ -443,17 +629,33 @@ static bool compute_transform_using_best_fit_correspondence(
 		bFoundCorrespondences=
 			compute_predicted_point_correspondences(
 					tracker_view, projection, model_vertices, model_normals, *predicted_model_transform_ptr,
-					out_point_correspondences);
+					frame_arena, out_point_correspondences);
 		solvepnp_guess_transform= *predicted_model_transform_ptr;
 	}
 	
 	// expensive
 	if (!bFoundCorrespondences)
 	{
+		const t_high_resolution_timepoint search_start= std::chrono::high_resolution_clock::now();
+		int hypothesis_count= 0;
+
 		bFoundCorrespondences=
 			compute_brute_force_image_ray_correspondences(
-				tracker_view, projection, model_vertices, model_normals, model_tri_permutations,
-				predicted_model_transform_ptr, solvepnp_guess_transform, out_point_correspondences);
+				tracker_view, projection, model_vertices, model_normals, model_triangle_index,
+				predicted_model_transform_ptr, reacquisition_task_pool, hypothesis_count, 
+				solvepnp_guess_transform, out_point_correspondences);
+
+		const double duration_ms= 
+			std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - search_start).count();
+
+		++reacquisition_stats.reacquisition_count;
+		reacquisition_stats.last_hypothesis_count= hypothesis_count;
+		reacquisition_stats.last_duration_ms= duration_ms;
+		reacquisition_stats.max_duration_ms= std::max(reacquisition_stats.max_duration_ms, duration_ms);
+
+		PSVR_MT_LOG_DEBUG("compute_transform_using_best_fit_correspondence") 
+			<< "Brute force search " << (bFoundCorrespondences ? "found" : "missed") << " shape after "
+			<< hypothesis_count << " hypotheses in " << duration_ms << "ms";
 	}
 
 	if (bFoundCorrespondences)
@@ -465,8 +667,10 @@ static bool compute_transform_using_best_fit_correspondence(
 			PSVRVideoFrameSection_Primary, 
 			cameraMatrix, distCoeffs);
 
-		std::vector<cv::Point2f> cvImagePoints;
-		std::vector<cv::Point3f> cvObjectPoints;
+		FrameArenaVector<cv::Point2f> cvImagePoints(FrameArenaAllocator<cv::Point2f>(&frame_arena));
+		FrameArenaVector<cv::Point3f> cvObjectPoints(FrameArenaAllocator<cv::Point3f>(&frame_arena));
+		cvImagePoints.reserve(out_point_correspondences.size());
+		cvObjectPoints.reserve(out_point_correspondences.size());
 
 		for (const MonoPointCorrespondence &correspondence : out_point_correspondences)
 		{
@@ -489,8 +693,10 @@ static bool compute_transform_using_best_fit_correspondence(
 		eigen_affine3d_to_cv_rvec_tvec(solvepnp_guess_transform, cvCameraRVec, cvCameraTVec);
 
 		// Use a full solvePnP on the given point to model correspondences to compute a transform
+		const int correspondence_count= static_cast<int>(cvImagePoints.size());
 		if (cv::solvePnP(
-				cvObjectPoints, cvImagePoints,
+				cv::_InputArray(cvObjectPoints.data(), correspondence_count), 
+				cv::_InputArray(cvImagePoints.data(), correspondence_count),
 				cameraMatrix, distCoeffs,
 				cvCameraRVec, cvCameraTVec,
 				true, cv::SOLVEPNP_ITERATIVE))
@@ -512,6 +718,7 @@ static bool compute_predicted_point_correspondences(
 	const std::vector<Eigen::Vector3f> &model_vertices,
 	const std::vector<Eigen::Vector3f> &model_normals,
 	const Eigen::Affine3d &predicted_model_transform,
+	FrameArena &frame_arena,
 	std::vector<MonoPointCorrespondence> &out_point_correspondences)
 {
 	cv::Mat *drawingBuffer= tracker_view->getDebugDrawingBuffer(PSVRVideoFrameSection_Primary);
@@ -533,33 +740,26 @@ static bool compute_predicted_point_correspondences(
 
 	// Project the source point on to the solved camera plane
 	// model pose = (rvec, tvec)
-	std::vector<cv::Point3f> cv_model_points;
+	const int model_vertex_count= static_cast<int>(model_vertices.size());
+	FrameArenaVector<cv::Point3f> cv_model_points(FrameArenaAllocator<cv::Point3f>(&frame_arena));
+	cv_model_points.reserve(model_vertex_count);
 	for (const Eigen::Vector3f &opengl_vertex : model_vertices)
 	{
 		cv_model_points.push_back(eigen_opengl_vector3f_to_cv_point3f(opengl_vertex));
 	}
 
-	// Apply the model transform to the model normals
-	const Eigen::Affine3f model_pose= predicted_model_transform.cast<float>();
-	std::vector<Eigen::Vector3f> transformed_model_normals;
-	std::for_each(model_normals.begin(), model_normals.end(),
-		[&transformed_model_normals, model_pose](const Eigen::Vector3f& v) {
-			const Eigen::Vector3f transformed_v= model_pose.linear() * v;
-			transformed_model_normals.push_back(transformed_v);
-		});
-
-	std::vector<cv::Point2f> cv_projected_points;
+	FrameArenaVector<cv::Point2f> cv_projected_points(model_vertex_count, cv::Point2f(), FrameArenaAllocator<cv::Point2f>(&frame_arena));
 	cv::projectPoints(
-		cv_model_points, 
+		cv::_InputArray(cv_model_points.data(), model_vertex_count), 
 		cv_model_rvec,
 		cv_model_tvec,
-		intrinsic_matrix, dist_coeffs, cv_projected_points);
+		intrinsic_matrix, dist_coeffs, 
+		cv::_OutputArray(cv_projected_points.data(), model_vertex_count));
 
 	// Find the best correspondences based on the predicted projection
 	const size_t proj_point_count= projection.projections[0].shape.pointcloud.point_count;
-	const size_t model_vertex_count= model_vertices.size();
 
-	std::vector<bool> proj_point_used(proj_point_count, false);
+	std::bitset<MAX_POINT_CLOUD_POINT_COUNT> proj_point_used;
 	out_point_correspondences.clear();
 
 	for (int model_point_index = 0; model_point_index < model_vertex_count; ++model_point_index)
@@ -594,7 +794,7 @@ static bool compute_predicted_point_correspondences(
 				best_correspondence_dist= proj_dist_sqrd;
 			}
 
-			if (TrackerManagerConfig::are_debug_flags_enabled(PSMTrackerDebugFlags_trackingModel))
+			if (drawingBuffer != nullptr && TrackerManagerConfig::are_debug_flags_enabled(PSMTrackerDebugFlags_trackingModel))
 			{
 				cv::drawMarker(
 					*drawingBuffer, 
@@ -617,7 +817,7 @@ static bool compute_predicted_point_correspondences(
 			// Add to the list of valid proj_point -> model_point correspondences
 			out_point_correspondences.push_back(correspondence);
 
-			if (TrackerManagerConfig::are_debug_flags_enabled(PSMTrackerDebugFlags_trackingModel))
+			if (drawingBuffer != nullptr && TrackerManagerConfig::are_debug_flags_enabled(PSMTrackerDebugFlags_trackingModel))
 			{
 				char point_label[32];
 				Utility::format_string(point_label, sizeof(point_label), "%d", model_point_index);
@@ -643,6 +843,7 @@ static bool compute_image_point_ray_correspondences(
 	const std::vector<Eigen::Vector3f> &model_vertices,
 	const std::vector<Eigen::Vector3f> &model_normals,
 	const Eigen::Affine3d &model_transform,
+	const float score_limit,
 	std::vector<MonoPointCorrespondence> &out_point_correspondences,
 	float &out_correspondence_score)
 {
@@ -657,18 +858,19 @@ static bool compute_image_point_ray_correspondences(
 		return false;
 
 	// Apply the model transform to the model vertices
+	const Eigen::Affine3f model_transform_f= model_transform.cast<float>();
 	StackVector<Eigen::Vector3f, MAX_POINT_CLOUD_POINT_COUNT> transformed_model_vertices;
 	std::for_each(model_vertices.begin(), model_vertices.end(),
-		[&transformed_model_vertices, model_transform](const Eigen::Vector3f& v) {
-			const Eigen::Vector3f transformed_v= model_transform.cast<float>() * v;
+		[&transformed_model_vertices, &model_transform_f](const Eigen::Vector3f& v) {
+			const Eigen::Vector3f transformed_v= model_transform_f * v;
 			transformed_model_vertices->push_back(transformed_v);
 		});
 
 	// Apply the model transform to the model normals
 	StackVector<Eigen::Vector3f, MAX_POINT_CLOUD_POINT_COUNT> transformed_model_normals;
 	std::for_each(model_normals.begin(), model_normals.end(),
-		[&transformed_model_normals, model_transform](const Eigen::Vector3f& v) {
-			const Eigen::Vector3f transformed_v= model_transform.linear().cast<float>() * v;
+		[&transformed_model_normals, &model_transform_f](const Eigen::Vector3f& v) {
+			const Eigen::Vector3f transformed_v= model_transform_f.linear() * v;
 			transformed_model_normals->push_back(transformed_v);
 		});
 
@@ -719,6 +921,12 @@ static bool compute_image_point_ray_correspondences(
 
 			// Add the best distance to the correspondence score
 			out_correspondence_score+= best_model_point_distance;
+
+			// The score only goes up from here, so bail once it can't beat the limit
+			if (out_correspondence_score >= score_limit)
+			{
+				return false;
+			}
 		}
 	}
 
@@ -730,8 +938,10 @@ static bool compute_brute_force_image_ray_correspondences(
 	const PSVRTrackingProjection &projection,
     const std::vector<Eigen::Vector3f> &model_vertices,
 	const std::vector<Eigen::Vector3f> &model_normals,
-	const std::vector<t_tri_index_tuple> &model_tri_permutations,
+	const ModelTriangleIndex &model_triangle_index,
 	const Eigen::Affine3d *predicted_model_transform,
+	class TaskPool *task_pool,
+	int &out_hypothesis_count,
 	Eigen::Affine3d &out_model_transform,
 	std::vector<MonoPointCorrespondence> &out_point_correspondences)
 {
@@ -764,62 +974,164 @@ static bool compute_brute_force_image_ray_correspondences(
 	std::vector<t_tri_index_tuple> proj_tri_combinations; // D = Detections
 	compute_all_possible_tri_index_combinations(proj_point_count, proj_tri_combinations);
 
-	// Brute-Force test 3-point correspondences from projections points to model points
-	std::vector<cv::Mat> cv_model_rvecs;
-	std::vector<cv::Mat> cv_model_tvecs;
-	std::vector<cv::Point2f> cv_image_points;
-	std::vector<cv::Point3f> cv_object_points;
-	std::vector<MonoPointCorrespondence> point_correspondences;
-	cv_model_rvecs.reserve(4);
-	cv_model_tvecs.reserve(4);
-	cv_image_points.reserve(MAX_POINT_CLOUD_POINT_COUNT);
-	cv_image_points.reserve(MAX_POINT_CLOUD_POINT_COUNT);
-	point_correspondences.reserve(MAX_POINT_CLOUD_POINT_COUNT);
-
-	float best_correspondence_score= 0.f;
-	for (const t_tri_index_tuple &D : proj_tri_combinations)
+	// Compute the signed area of each detected triangle (twice the area, in pixels)
+	const PSVRVector2f *proj_points= projection.projections[0].shape.pointcloud.points;
+	std::vector<std::pair<float, int>> proj_tri_order; // (-|signed area|, index into proj_tri_combinations)
+	std::vector<float> proj_tri_signed_areas;
+	proj_tri_order.reserve(proj_tri_combinations.size());
+	proj_tri_signed_areas.reserve(proj_tri_combinations.size());
+	for (int tri_index = 0; tri_index < static_cast<int>(proj_tri_combinations.size()); ++tri_index)
+	{
+		const t_tri_index_tuple &D= proj_tri_combinations[tri_index];
+		const PSVRVector2f &p0= proj_points[D[0]];
+		const PSVRVector2f &p1= proj_points[D[1]];
+		const PSVRVector2f &p2= proj_points[D[2]];
+		const float signed_area= (p1.x - p0.x)*(p2.y - p0.y) - (p1.y - p0.y)*(p2.x - p0.x);
+
+		proj_tri_signed_areas.push_back(signed_area);
+		proj_tri_order.push_back(std::make_pair(-fabsf(signed_area), tri_index));
+	}
+
+	// Try the biggest detected triangles first, since P3P is best conditioned on them.
+	// That makes it likely the search can stop early or at least spends its budget well.
+	std::sort(proj_tri_order.begin(), proj_tri_order.end());
+
+	// Use the predicted transform to skip model points that can't be facing the camera
+	std::bitset<MAX_POINT_CLOUD_POINT_COUNT> model_point_maybe_visible;
+	if (predicted_model_transform != nullptr)
 	{
-		for (const t_tri_index_tuple &L : model_tri_permutations)
+		const Eigen::Affine3f predicted_transform_f= predicted_model_transform->cast<float>();
+
+		for (int model_point_index = 0; model_point_index < static_cast<int>(model_vertices.size()); ++model_point_index)
 		{
-			// Use a test projection -> model triangle correspondence 
-			// to compute a possible camera pose from solveP3P (up to 4 solutions)
-			cv_model_rvecs.clear();
-			cv_model_tvecs.clear();
+			const Eigen::Vector3f view_direction= (predicted_transform_f * model_vertices[model_point_index]).normalized();
+			const Eigen::Vector3f normal= predicted_transform_f.linear() * model_normals[model_point_index];
+
+			// Same facing test as compute_image_point_ray_correspondences(), with some slack
+			model_point_maybe_visible.set(model_point_index, normal.dot(view_direction) >= -k_predicted_visibility_slack);
+		}
+	}
+	else
+	{
+		model_point_maybe_visible.set();
+	}
+
+	// Lay out every (D, L) pairing worth running solveP3P on, in the order they'd be tried serially.
+	// Capping the list keeps the cost of reacquisition bounded.
+	std::vector<ReacquisitionHypothesis> hypotheses;
+	hypotheses.reserve(k_max_reacquisition_hypotheses);
+	for (auto proj_tri_it = proj_tri_order.begin(); 
+		proj_tri_it != proj_tri_order.end() && static_cast<int>(hypotheses.size()) < k_max_reacquisition_hypotheses; 
+		++proj_tri_it)
+	{
+		const int proj_tri_index= proj_tri_it->second;
+		const float signed_area= proj_tri_signed_areas[proj_tri_index];
 
-			int solution_count= 0;
+		// Only model triangles that can appear with this winding in the image are worth trying
+		const std::vector<t_tri_index_tuple> *candidate_lists[ModelTriangleIndex::ImageWinding_COUNT];
+		int candidate_list_count= 0;
+		if (signed_area <= -k_min_winding_image_area_px_sqrd)
+		{
+			candidate_lists[candidate_list_count++]= &model_triangle_index.triangles[ModelTriangleIndex::ImageWinding_Negative];
+		}
+		else if (signed_area >= k_min_winding_image_area_px_sqrd)
+		{
+			candidate_lists[candidate_list_count++]= &model_triangle_index.triangles[ModelTriangleIndex::ImageWinding_Positive];
+		}
+		else
+		{
+			candidate_lists[candidate_list_count++]= &model_triangle_index.triangles[ModelTriangleIndex::ImageWinding_Negative];
+			candidate_lists[candidate_list_count++]= &model_triangle_index.triangles[ModelTriangleIndex::ImageWinding_Positive];
+		}
+		candidate_lists[candidate_list_count++]= &model_triangle_index.triangles[ModelTriangleIndex::ImageWinding_Ambiguous];
+
+		for (int list_index = 0; list_index < candidate_list_count; ++list_index)
+		{
+			for (const t_tri_index_tuple &L : *candidate_lists[list_index])
 			{
-				cv_image_points.clear();
-				cv_object_points.clear();
-				for (int tuple_index = 0; tuple_index < 3; ++tuple_index)
-				{
-					const int proj_point_index= D[tuple_index];
-					const PSVRVector2f &proj_point = projection.projections[0].shape.pointcloud.points[proj_point_index];
+				if (static_cast<int>(hypotheses.size()) >= k_max_reacquisition_hypotheses)
+					break;
 
-					const int model_point_index= L[tuple_index];
-					const Eigen::Vector3f &model_point= model_vertices[model_point_index];
+				if (model_point_maybe_visible.test(L[0]) && 
+					model_point_maybe_visible.test(L[1]) && 
+					model_point_maybe_visible.test(L[2]))
+				{
+					ReacquisitionHypothesis hypothesis;
+					hypothesis.proj_tri_index= proj_tri_index;
+					hypothesis.model_tri= &L;
 
-					cv_image_points.push_back(cv::Point2f(proj_point.x, proj_point.y));
-					cv_object_points.push_back(eigen_opengl_vector3f_to_cv_point3f(model_point));
+					hypotheses.push_back(hypothesis);
 				}
-
-				solution_count= 
-					cv::solveP3P(
-						cv_object_points, cv_image_points, 
-						intrinsic_matrix, dist_coeffs, 
-						cv_model_rvecs, cv_model_tvecs, 
-						cv::SOLVEPNP_P3P);
 			}
+		}
+	}
+
+	// Use a test projection -> model triangle correspondence 
+	// to compute a possible camera pose from solveP3P (up to 4 solutions)
+	auto solve_hypothesis= [&](const ReacquisitionHypothesis &hypothesis, ReacquisitionScratch &scratch) -> int {
+		const t_tri_index_tuple &D= proj_tri_combinations[hypothesis.proj_tri_index];
+		const t_tri_index_tuple &L= *hypothesis.model_tri;
+
+		scratch.cv_model_rvecs.clear();
+		scratch.cv_model_tvecs.clear();
+		scratch.cv_image_points.clear();
+		scratch.cv_object_points.clear();
+		for (int tuple_index = 0; tuple_index < 3; ++tuple_index)
+		{
+			const PSVRVector2f &proj_point = proj_points[D[tuple_index]];
+
+			scratch.cv_image_points.push_back(cv::Point2f(proj_point.x, proj_point.y));
+			scratch.cv_object_points.push_back(model_triangle_index.cvModelPoints[L[tuple_index]]);
+		}
+
+		return cv::solveP3P(
+			scratch.cv_object_points, scratch.cv_image_points, 
+			intrinsic_matrix, dist_coeffs, 
+			scratch.cv_model_rvecs, scratch.cv_model_tvecs, 
+			cv::SOLVEPNP_P3P);
+	};
+
+	// The hypotheses are evaluated in fixed size chunks, possibly in parallel.
+	// The search stops at the first chunk holding a solution that lines up every detection with a model point
+	// (chunks after it are abandoned). The result is the lowest scoring solution in that chunk or any chunk before it,
+	// with ties going to the earliest hypothesis. That makes the result independent of the number of workers.
+	const int hypothesis_count= static_cast<int>(hypotheses.size());
+	const int chunk_count= 
+		(hypothesis_count + k_reacquisition_hypotheses_per_chunk - 1) / k_reacquisition_hypotheses_per_chunk;
+	std::vector<ReacquisitionChunkResult> chunk_results(chunk_count);
+	std::vector<ReacquisitionScratch> scratch_buffers(task_pool != nullptr ? task_pool->getSlotCount() : 1);
+	std::atomic_int first_accepted_chunk(chunk_count);
+
+	auto evaluate_chunk= [&](int chunk_index, int worker_slot) {
+		ReacquisitionScratch &scratch= scratch_buffers[worker_slot];
+		ReacquisitionChunkResult &result= chunk_results[chunk_index];
+		const int first_hypothesis_index= chunk_index*k_reacquisition_hypotheses_per_chunk;
+		const int end_hypothesis_index= std::min(first_hypothesis_index + k_reacquisition_hypotheses_per_chunk, hypothesis_count);
+
+		result.hypothesis_index= -1;
+		result.solution_index= -1;
+		result.score= k_real_max;
+		result.hypothesis_count= 0;
+
+		for (int hypothesis_index = first_hypothesis_index; hypothesis_index < end_hypothesis_index; ++hypothesis_index)
+		{
+			// An earlier chunk already found an acceptable solution
+			if (chunk_index > first_accepted_chunk.load())
+				return;
+
+			const int solution_count= solve_hypothesis(hypotheses[hypothesis_index], scratch);
+			++result.hypothesis_count;
 
 			// Using each estimated model transform returned from solveP3P:
 			// * Compute a ray through each projection point
 			// * Find the closest transformed(rvec|tvec) model point to each ray
 			// * Compute a correspondence score (summed squared error)
-			// * Use this correspondence if it's better than any found so far
+			// * Use this correspondence if it's better than any found in the chunk so far
 			for (int solution_index = 0; solution_index < solution_count; ++solution_index)
 			{
 				// Convert the rvec|tvec pose returned from solveP3P to an Eigen::Affine3f
-				const cv::Mat rvec= cv_model_rvecs[solution_index];
-				const cv::Mat tvec= cv_model_tvecs[solution_index];
+				const cv::Mat rvec= scratch.cv_model_rvecs[solution_index];
+				const cv::Mat tvec= scratch.cv_model_tvecs[solution_index];
 				const Eigen::Affine3d model_transform= cv_rvec_tvec_to_eigen_affine3d(rvec, tvec);
 
 				// Use the predicted transform to throw out solutions with the Y-axis pointing the opposite direction.
@@ -837,23 +1149,88 @@ static bool compute_brute_force_image_ray_correspondences(
 					}
 				}
 
+				// Scoring stops as soon as it can't beat the best solution in the chunk so far
 				float correspondence_score;
 				if (compute_image_point_ray_correspondences(
 						projection, image_point_rays, 
 						model_vertices, model_normals, model_transform,
-						point_correspondences, correspondence_score))
+						result.score,
+						scratch.point_correspondences, correspondence_score))
 				{
-					if (out_point_correspondences.size() == 0 || correspondence_score < best_correspondence_score)
+					result.hypothesis_index= hypothesis_index;
+					result.solution_index= solution_index;
+					result.score= correspondence_score;
+
+					// Every detection lines up with a model point, no need to look any further
+					if (scratch.point_correspondences.size() == proj_point_count &&
+						correspondence_score <= k_accepted_ray_distance_cm_sqrd*static_cast<float>(proj_point_count))
 					{
-						out_point_correspondences= point_correspondences;
-						out_model_transform= model_transform;
-						best_correspondence_score= correspondence_score;
+						int accepted_chunk= first_accepted_chunk.load();
+						while (chunk_index < accepted_chunk && 
+								!first_accepted_chunk.compare_exchange_weak(accepted_chunk, chunk_index))
+						{
+						}
+
+						return;
 					}
 				}
 			}
 		}
+	};
+
+	if (task_pool != nullptr)
+	{
+		task_pool->parallelForWithSlots(chunk_count, evaluate_chunk);
+	}
+	else
+	{
+		for (int chunk_index = 0; chunk_index < chunk_count && chunk_index <= first_accepted_chunk.load(); ++chunk_index)
+		{
+			evaluate_chunk(chunk_index, 0);
+		}
+	}
+
+	// Pick the best solution up to the accepting chunk
+	const int last_chunk_index= std::min(first_accepted_chunk.load(), chunk_count - 1);
+	const ReacquisitionChunkResult *best_result= nullptr;
+	out_hypothesis_count= 0;
+	for (int chunk_index = 0; chunk_index < chunk_count; ++chunk_index)
+	{
+		const ReacquisitionChunkResult &result= chunk_results[chunk_index];
+
+		// Includes the work done by abandoned chunks
+		out_hypothesis_count+= result.hypothesis_count;
+
+		if (chunk_index <= last_chunk_index && 
+			result.hypothesis_index != -1 && 
+			(best_result == nullptr || result.score < best_result->score))
+		{
+			best_result= &result;
+		}
+	}
+
+	// Recover the winning transform and its correspondences
+	if (best_result != nullptr)
+	{
+		ReacquisitionScratch &scratch= scratch_buffers[0];
+		const int solution_count= solve_hypothesis(hypotheses[best_result->hypothesis_index], scratch);
+		assert(best_result->solution_index < solution_count);
+
+		const cv::Mat rvec= scratch.cv_model_rvecs[best_result->solution_index];
+		const cv::Mat tvec= scratch.cv_model_tvecs[best_result->solution_index];
+		const Eigen::Affine3d model_transform= cv_rvec_tvec_to_eigen_affine3d(rvec, tvec);
+
+		float correspondence_score;
+		if (compute_image_point_ray_correspondences(
+				projection, image_point_rays, 
+				model_vertices, model_normals, model_transform,
+				k_real_max,
+				out_point_correspondences, correspondence_score))
+		{
+			out_model_transform= model_transform;
+		}
 	}
 
 	// Need at least 4 point correspondences to use SolvePnP in the next step
 	return out_point_correspondences.size() >= 4;
-}
\ No newline at end of file
+}
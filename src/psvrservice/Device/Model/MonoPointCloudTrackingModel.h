@@ -4,6 +4,16 @@
 // -- include -----
 #include "ShapeTrackingModelInterface.h"
 
+// -- definitions -----
+// Cost of the brute force correspondence search run when the shape can't be found near its predicted pose
+struct MonoPointCloudReacquisitionStatistics
+{
+	int reacquisition_count; // number of brute force searches run
+	int last_hypothesis_count; // solveP3P calls made by the last search
+	double last_duration_ms;
+	double max_duration_ms;
+};
+
 // -- public interface -----
 class MonoPointCloudTrackingModel : public IShapeTrackingModel
 {
@@ -21,6 +31,7 @@ public:
     bool getShapePosition(PSVRVector3f &out_position) const override;
     bool getShape(PSVRTrackingShape &out_shape) const override;
 	bool getPointCloudProjectionShapeCorrelation(PSVRTrackingProjection &projection) const;
+	void getReacquisitionStatistics(MonoPointCloudReacquisitionStatistics &out_stats) const;
 
 private:
     struct MonoPointCloudTrackingModelState *m_state;
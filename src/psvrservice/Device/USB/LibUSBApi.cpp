@@ -26,9 +26,26 @@ struct LibUSBDeviceEnumerator : USBDeviceEnumerator
 	libusb_device **device_list;
 };
 
+// A control transfer batch in flight.
+// The one libusb transfer gets refilled and resubmitted for each op from the completion callback.
+struct LibUSBControlTransferBatch
+{
+	USBTransferRequestState requestState;
+	USBResultPayload_ControlTransferBatch result;
+	int op_index;
+	int attempt_count;
+	bool bWriteBack; // writing back the register a set/clear bits op just read
+	unsigned char write_back_value;
+	unsigned char buffer[LIBUSB_CONTROL_SETUP_SIZE + 1];
+};
+
 //-- private methods -----
 static void LIBUSB_CALL interrupt_transfer_cb(struct libusb_transfer *transfer);
 static void LIBUSB_CALL control_transfer_cb(struct libusb_transfer *transfer);
+static void LIBUSB_CALL control_transfer_batch_cb(struct libusb_transfer *transfer);
+static void fill_control_transfer_batch_op(struct libusb_transfer *transfer, LibUSBControlTransferBatch *batch);
+static void finish_control_transfer_batch(struct libusb_transfer *transfer, LibUSBControlTransferBatch *batch, eUSBResultCode result_code);
+static eUSBResultCode libusb_transfer_status_to_result_code(enum libusb_transfer_status status);
 static void LIBUSB_CALL bulk_transfer_cb(struct libusb_transfer *transfer);
 
 static bool libusb_device_get_path(libusb_device *dev, char *outBuffer, size_t bufferSize);
@@ -650,6 +667,184 @@ static void LIBUSB_CALL control_transfer_cb(struct libusb_transfer *transfer)
 	libusb_free_transfer(transfer);
 }
 
+eUSBResultCode LibUSBApi::submit_control_transfer_batch(
+	const USBDeviceState* device_state,
+	const USBTransferRequestState *requestState)
+{
+	const USBRequestPayload_ControlTransferBatch &request = requestState->request.payload.control_transfer_batch;
+	const LibUSBDeviceState *libusb_device_state = static_cast<const LibUSBDeviceState *>(device_state);
+
+	if (request.ops == nullptr || request.op_count <= 0)
+	{
+		return _USBResultCode_GeneralError;
+	}
+
+	struct libusb_transfer *transfer = libusb_alloc_transfer(0);
+	if (transfer == nullptr)
+	{
+		return _USBResultCode_NoMemory;
+	}
+
+	LibUSBControlTransferBatch *batch = new LibUSBControlTransferBatch;
+	batch->requestState.request = requestState->request;
+	batch->requestState.callback = requestState->callback;
+	memset(&batch->result, 0, sizeof(USBResultPayload_ControlTransferBatch));
+	batch->result.usb_device_handle = request.usb_device_handle;
+	batch->op_index = 0;
+	batch->attempt_count = 0;
+	batch->bWriteBack = false;
+	batch->write_back_value = 0;
+	memset(batch->buffer, 0, sizeof(batch->buffer));
+
+	libusb_fill_control_transfer(
+		transfer,
+		libusb_device_state->device_handle,
+		batch->buffer,
+		control_transfer_batch_cb,
+		batch,
+		request.timeout);
+	fill_control_transfer_batch_op(transfer, batch);
+
+	if (libusb_submit_transfer(transfer) != LIBUSB_SUCCESS)
+	{
+		delete batch;
+		libusb_free_transfer(transfer);
+
+		return _USBResultCode_SubmitFailed;
+	}
+
+	return _USBResultCode_Started;
+}
+
+static void fill_control_transfer_batch_op(struct libusb_transfer *transfer, LibUSBControlTransferBatch *batch)
+{
+	const USBRequestPayload_ControlTransferBatch &request = batch->requestState.request.payload.control_transfer_batch;
+	const USBControlTransferBatchOp &op = request.ops[batch->op_index];
+	const unsigned char direction = 
+		(op.op_type == _USBControlTransferBatchOp_Write || batch->bWriteBack) ? LIBUSB_ENDPOINT_OUT : LIBUSB_ENDPOINT_IN;
+
+	libusb_fill_control_setup(
+		batch->buffer,
+		(request.bmRequestType & ~LIBUSB_ENDPOINT_DIR_MASK) | direction,
+		request.bRequest,
+		request.wValue,
+		op.wIndex,
+		1);
+	batch->buffer[LIBUSB_CONTROL_SETUP_SIZE] = 
+		batch->bWriteBack ? batch->write_back_value : ((direction == LIBUSB_ENDPOINT_OUT) ? op.value : 0);
+
+	transfer->length = LIBUSB_CONTROL_SETUP_SIZE + 1;
+}
+
+static void LIBUSB_CALL control_transfer_batch_cb(struct libusb_transfer *transfer)
+{
+	LibUSBControlTransferBatch *batch = reinterpret_cast<LibUSBControlTransferBatch *>(transfer->user_data);
+	const USBRequestPayload_ControlTransferBatch &request = batch->requestState.request.payload.control_transfer_batch;
+	const USBControlTransferBatchOp &op = request.ops[batch->op_index];
+
+	if (transfer->status != LIBUSB_TRANSFER_COMPLETED)
+	{
+		finish_control_transfer_batch(transfer, batch, libusb_transfer_status_to_result_code(transfer->status));
+		return;
+	}
+
+	bool bOpDone = true;
+	if (batch->bWriteBack)
+	{
+		// The write half of a set/clear bits op went out, which finishes it
+		batch->bWriteBack = false;
+	}
+	else if (op.op_type != _USBControlTransferBatchOp_Write && transfer->actual_length > 0)
+	{
+		const unsigned char read_value = libusb_control_transfer_get_data(transfer)[0];
+
+		batch->result.last_read_value = read_value;
+
+		// Write the register back with the op's bits set or cleared on the next transfer
+		if (op.op_type == _USBControlTransferBatchOp_SetBits || op.op_type == _USBControlTransferBatchOp_ClearBits)
+		{
+			batch->write_back_value = 
+				(op.op_type == _USBControlTransferBatchOp_SetBits) ? (read_value | op.value) : (read_value & ~op.value);
+			batch->bWriteBack = true;
+			bOpDone = false;
+		}
+
+		// Keep polling the register until it reads what we're waiting for (or reports a failure)
+		if (op.op_type == _USBControlTransferBatchOp_PollRead && read_value != op.value)
+		{
+			++batch->attempt_count;
+			if (read_value != op.fail_value && batch->attempt_count < op.max_attempts)
+			{
+				bOpDone = false;
+			}
+			else
+			{
+				++batch->result.failed_poll_count;
+			}
+		}
+	}
+
+	if (bOpDone)
+	{
+		++batch->op_index;
+		batch->attempt_count = 0;
+		batch->result.completed_op_count = batch->op_index;
+	}
+
+	if (batch->op_index >= request.op_count)
+	{
+		finish_control_transfer_batch(transfer, batch, _USBResultCode_Completed);
+		return;
+	}
+
+	fill_control_transfer_batch_op(transfer, batch);
+	if (libusb_submit_transfer(transfer) != LIBUSB_SUCCESS)
+	{
+		finish_control_transfer_batch(transfer, batch, _USBResultCode_SubmitFailed);
+	}
+}
+
+static void finish_control_transfer_batch(
+	struct libusb_transfer *transfer, 
+	LibUSBControlTransferBatch *batch, 
+	eUSBResultCode result_code)
+{
+	USBTransferResult result;
+
+	memset(&result, 0, sizeof(USBTransferResult));
+	result.result_type = _USBResultType_ControlTransferBatch;
+	result.payload.control_transfer_batch = batch->result;
+	result.payload.control_transfer_batch.result_code = result_code;
+
+	// Add the result to the outgoing result queue
+	usb_device_post_transfer_result(result, batch->requestState.callback);
+
+	delete batch;
+	libusb_free_transfer(transfer);
+}
+
+static eUSBResultCode libusb_transfer_status_to_result_code(enum libusb_transfer_status status)
+{
+	switch (status)
+	{
+	case LIBUSB_TRANSFER_COMPLETED:
+		return _USBResultCode_Completed;
+	case LIBUSB_TRANSFER_TIMED_OUT:
+		return _USBResultCode_TimedOut;
+	case LIBUSB_TRANSFER_STALL:
+		return _USBResultCode_Pipe;
+	case LIBUSB_TRANSFER_NO_DEVICE:
+		return _USBResultCode_DeviceNotOpen;
+	case LIBUSB_TRANSFER_OVERFLOW:
+		return _USBResultCode_Overflow;
+	case LIBUSB_TRANSFER_CANCELLED:
+		return _USBResultCode_Canceled;
+	case LIBUSB_TRANSFER_ERROR:
+	default:
+		return _USBResultCode_GeneralError;
+	}
+}
+
 eUSBResultCode LibUSBApi::submit_bulk_transfer(const USBDeviceState* device_state, const struct USBTransferRequestState *requestState)
 {
 	USBTransferRequestState *requestStateOnHeap = nullptr;
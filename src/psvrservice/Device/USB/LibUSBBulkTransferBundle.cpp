@@ -14,6 +14,11 @@
 #endif
 #include "libusb.h"
 
+// libusb_dev_mem_alloc() showed up in libusb 1.0.21
+#if defined(LIBUSB_API_VERSION) && (LIBUSB_API_VERSION >= 0x01000105)
+    #define HAS_LIBUSB_DEV_MEM_ALLOC
+#endif
+
 //-- private methods -----
 static void LIBUSB_CALL transfer_callback_function(struct libusb_transfer *bulk_transfer);
 
@@ -28,6 +33,8 @@ LibUSBBulkTransferBundle::LibUSBBulkTransferBundle(
     , m_active_transfer_count(0)
     , m_is_canceled(false)
     , transfer_buffer(nullptr)
+    , m_transfer_buffer_size(0)
+    , m_is_transfer_buffer_device_memory(false)
 {
 	
 }
@@ -68,16 +75,7 @@ bool LibUSBBulkTransferBundle::initialize()
 
         // Allocate the transfer buffer that the requests write data into
         size_t xfer_buffer_size = m_request.in_flight_transfer_packet_count * m_request.transfer_packet_size;
-        transfer_buffer = new uint8_t[xfer_buffer_size];
-
-        if (transfer_buffer != nullptr)
-        {
-            memset(transfer_buffer, 0, xfer_buffer_size);
-        }
-        else
-        {
-            bSuccess = false;
-        }
+        bSuccess = allocateTransferBuffer(xfer_buffer_size);
     }
 
     // Allocate and initialize the transfers
@@ -123,13 +121,61 @@ void LibUSBBulkTransferBundle::dispose()
         }
     }
 
+    freeTransferBuffer();
+
+	bulk_transfer_requests.clear();
+}
+
+bool LibUSBBulkTransferBundle::allocateTransferBuffer(size_t buffer_size)
+{
+    assert(transfer_buffer == nullptr);
+
+#ifdef HAS_LIBUSB_DEV_MEM_ALLOC
+    // On Linux this maps memory the usbfs driver can DMA straight into,
+    // instead of copying every completed transfer out of a kernel buffer.
+    // Everywhere else (or on kernels without usbfs mmap support) it just fails.
+    transfer_buffer = libusb_dev_mem_alloc(m_device_handle, buffer_size);
+
     if (transfer_buffer != nullptr)
     {
-        delete[] transfer_buffer;
-        transfer_buffer = nullptr;
+        m_is_transfer_buffer_device_memory = true;
     }
+#endif
 
-	bulk_transfer_requests.clear();
+    if (transfer_buffer == nullptr)
+    {
+        transfer_buffer = new uint8_t[buffer_size];
+        m_is_transfer_buffer_device_memory = false;
+    }
+
+    if (transfer_buffer != nullptr)
+    {
+        memset(transfer_buffer, 0, buffer_size);
+        m_transfer_buffer_size = buffer_size;
+    }
+
+    return transfer_buffer != nullptr;
+}
+
+void LibUSBBulkTransferBundle::freeTransferBuffer()
+{
+    if (transfer_buffer != nullptr)
+    {
+#ifdef HAS_LIBUSB_DEV_MEM_ALLOC
+        if (m_is_transfer_buffer_device_memory)
+        {
+            libusb_dev_mem_free(m_device_handle, transfer_buffer, m_transfer_buffer_size);
+        }
+        else
+#endif
+        {
+            delete[] transfer_buffer;
+        }
+
+        transfer_buffer = nullptr;
+        m_transfer_buffer_size = 0;
+        m_is_transfer_buffer_device_memory = false;
+    }
 }
 
 bool LibUSBBulkTransferBundle::startTransfers()
@@ -37,6 +37,8 @@ public:
 
 protected:
     void dispose();
+    bool allocateTransferBuffer(size_t buffer_size);
+    void freeTransferBuffer();
 
 private:
     USBRequestPayload_BulkTransferBundle m_request;
@@ -47,6 +49,8 @@ private:
     bool m_is_canceled;
     std::vector<struct libusb_transfer*> bulk_transfer_requests;
     unsigned char* transfer_buffer;
+    size_t m_transfer_buffer_size;
+    bool m_is_transfer_buffer_device_memory; // usbfs mapped, so the kernel doesn't copy each transfer again
 };
 
 #endif // USB_BULK_TRANSFER_BUNDLE_H
\ No newline at end of file
@@ -98,6 +98,13 @@ eUSBResultCode NullUSBApi::submit_control_transfer(
 	return _USBResultCode_InvalidAPI;
 }
 
+eUSBResultCode NullUSBApi::submit_control_transfer_batch(
+	const USBDeviceState* device_state,
+	const USBTransferRequestState *requestState)
+{
+	return _USBResultCode_InvalidAPI;
+}
+
 eUSBResultCode NullUSBApi::submit_bulk_transfer(
     const USBDeviceState* device_state,
     const struct USBTransferRequestState *requestState)
@@ -94,6 +94,9 @@ public:
 
 	virtual eUSBResultCode submit_interrupt_transfer(const USBDeviceState* device_state, const struct USBTransferRequestState *requestStateOnHeap) = 0;
 	virtual eUSBResultCode submit_control_transfer(const USBDeviceState* device_state, const struct USBTransferRequestState *requestStateOnHeap) = 0;
+	// Once a batch is accepted (returns Started or Completed) the API posts its one result, whatever the outcome.
+	// Any other return code means the batch was rejected up front and nothing gets posted for it.
+	virtual eUSBResultCode submit_control_transfer_batch(const USBDeviceState* device_state, const struct USBTransferRequestState *requestStateOnHeap) = 0;
     virtual eUSBResultCode submit_bulk_transfer(const USBDeviceState* device_state, const struct USBTransferRequestState *requestStateOnHeap) = 0;
 	virtual class IUSBBulkTransferBundle *allocate_bulk_transfer_bundle(const USBDeviceState *device_state, const struct USBRequestPayload_BulkTransferBundle *request) = 0;
 
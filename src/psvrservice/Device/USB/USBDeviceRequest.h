@@ -113,6 +113,7 @@ enum eUSBTransferRequestType
     _USBRequestType_BulkTransfer,
     _USBRequestType_StartBulkTransferBundle,
     _USBRequestType_CancelBulkTransferBundle,
+    _USBRequestType_ControlTransferBatch,
 };
 
 enum eUSBTransferResultType
@@ -120,13 +121,24 @@ enum eUSBTransferResultType
 	_USBResultType_InterruptTransfer,
     _USBResultType_ControlTransfer,
     _USBResultType_BulkTransfer,
-    _USBResultType_BulkTransferBundle
+    _USBResultType_BulkTransferBundle,
+    _USBResultType_ControlTransferBatch
 };
 
 #define MAX_INTERRUPT_TRANSFER_PAYLOAD  512
 #define MAX_CONTROL_TRANSFER_PAYLOAD    512
 #define MAX_BULK_TRANSFER_PAYLOAD       512
 
+// Single byte register operations a control transfer batch can run
+enum eUSBControlTransferBatchOpType
+{
+    _USBControlTransferBatchOp_Write,    // Write value to the register
+    _USBControlTransferBatchOp_Read,     // Read the register (the last read value is returned in the result)
+    _USBControlTransferBatchOp_PollRead, // Read the register until it reads value (or fail_value), up to max_attempts times
+    _USBControlTransferBatchOp_SetBits,  // Read the register and write it back with the bits in value set
+    _USBControlTransferBatchOp_ClearBits, // Read the register and write it back with the bits in value cleared
+};
+
 //-- typedefs -----
 typedef void(*usb_bulk_transfer_cb_fn)(unsigned char *packet_data, int packet_length, void *userdata);
 
@@ -178,6 +190,29 @@ struct USBRequestPayload_CancelBulkTransferBundle
     t_usb_device_handle usb_device_handle;
 };
 
+struct USBControlTransferBatchOp
+{
+    unsigned short wIndex;
+    unsigned char value;
+    unsigned char fail_value; // poll read gives up as soon as it reads this, set it to value to never give up early
+    unsigned char op_type; // eUSBControlTransferBatchOpType
+    unsigned char max_attempts;
+};
+
+// A sequence of single byte register control transfers that the worker thread runs back to back,
+// posting a single result once the last one completes (or the first one fails).
+// A poll op that reads its fail value or never reads the value it wants is counted in the result but doesn't stop the batch.
+struct USBRequestPayload_ControlTransferBatch
+{
+    t_usb_device_handle usb_device_handle;
+    unsigned int timeout; // per transfer
+    const USBControlTransferBatchOp *ops; // must stay valid until the result is posted
+    int op_count;
+    unsigned short wValue;
+    unsigned char bmRequestType; // type and recipient bits, the direction comes from each op
+    unsigned char bRequest;
+};
+
 struct USBTransferRequest
 {
     union
@@ -187,6 +222,7 @@ struct USBTransferRequest
         USBRequestPayload_BulkTransfer bulk_transfer;
         USBRequestPayload_BulkTransferBundle start_bulk_transfer_bundle;
         USBRequestPayload_CancelBulkTransferBundle cancel_bulk_transfer_bundle;
+        USBRequestPayload_ControlTransferBatch control_transfer_batch;
     } payload;
     eUSBTransferRequestType request_type;
 };
@@ -214,6 +250,15 @@ struct USBResultPayload_ControlTransfer
     int dataLength;
 };
 
+struct USBResultPayload_ControlTransferBatch
+{
+    t_usb_device_handle usb_device_handle;
+    eUSBResultCode result_code;
+    int completed_op_count;
+    int failed_poll_count;
+    unsigned char last_read_value;
+};
+
 struct USBResultPayload_InterruptTransfer
 {
 	t_usb_device_handle usb_device_handle;
@@ -230,6 +275,7 @@ struct USBTransferResult
         USBResultPayload_ControlTransfer control_transfer;
         USBResultPayload_BulkTransfer bulk_transfer;
         USBResultPayload_BulkTransferBundle bulk_transfer_bundle;
+        USBResultPayload_ControlTransferBatch control_transfer_batch;
     } payload;
     eUSBTransferResultType result_type;
 };
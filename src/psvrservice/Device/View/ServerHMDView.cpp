@@ -5,26 +5,81 @@
 #include "MathTypeConversion.h"
 #include "MathAlignment.h"
 #include "MorpheusHMD.h"
+#include "HMDDeviceEnumerator.h"
+#include "ReplayHMD.h"
+#include "SessionRecorder.h"
 #include "VirtualHMD.h"
 #include "CompoundPoseFilter.h"
 #include "KalmanPoseFilter.h"
+#include "PoseFilterHistory.h"
 #include "PoseFilterInterface.h"
 #include "Logger.h"
+#include "HMDManager.h"
 #include "PointCloudTrackingModel.h"
 #include "SphereTrackingModel.h"
+#include "ServiceClock.h"
+#include "TimelineTrace.h"
 #include "ServiceRequestHandler.h"
 #include "ServerTrackerView.h"
 #include "TrackerManager.h"
+#include "Utility.h"
+#include "WorkerThread.h"
 
 //-- typedefs ----
 using t_high_resolution_timepoint= std::chrono::time_point<std::chrono::high_resolution_clock>;
 using t_high_resolution_duration= t_high_resolution_timepoint::duration;
 
 //-- constants -----
-static const float k_min_time_delta_seconds = 1 / 2500.f;
-static const float k_max_time_delta_seconds = 1 / 30.f;
+// Most sensor packets one pose filter update will process.
+// Anything beyond this is dropped, oldest first.
+static const size_t k_max_filter_packets_per_update= 100;
+
+// Number of applied sensor packets (and filter states) kept for rewinding the filter.
+// Needs to cover the optical latency at the IMU packet rate.
+static const int k_pose_filter_history_size= 128;
+
+// Most history packets one pose filter update will replay after rewinding for late optical packets.
+// A late packet that would need more than what's left is applied out of order instead.
+static const int k_max_filter_replay_packets_per_update= 100;
+
+// Pose sensor packet sources: the IMU then one optical source per tracker
+static const int k_imu_packet_source= 0;
+static const int k_pose_packet_source_count= 1 + TrackerManager::k_max_devices;
+
+// The IMU and tracker threads wake the filter thread as they post packets, this is just a backstop
+static const std::chrono::milliseconds k_filter_thread_wait_timeout(100);
+
+//-- private definitions -----
+// Worker thread that runs an HMD's pose filter as sensor packets arrive,
+// rather than once per PSVR_Update()
+class HMDFilterThread : public WorkerThread
+{
+public:
+    HMDFilterThread(const std::string &thread_name, ServerHMDView *hmd_view)
+        : WorkerThread(thread_name)
+        , m_hmdView(hmd_view)
+    {
+    }
+
+protected:
+    // Called in a loop by the parent WorkerThread class
+    virtual bool doWork() override
+    {
+        if (!m_hmdView->processPoseSensorPackets())
+        {
+            // Wait for the IMU or tracker threads to post more packets
+            waitForWork(k_filter_thread_wait_timeout);
+        }
+
+        return true;
+    }
+
+    ServerHMDView *m_hmdView;
+};
 
 //-- private methods -----
+static PSVRPosef compute_filtered_pose(const IPoseFilter *pose_filter);
+static PSVRPhysicsData compute_filtered_physics(const IPoseFilter *pose_filter);
 static void init_filters_for_morpheus_hmd(
     const MorpheusHMD *morpheusHMD, PoseFilterSpace **out_pose_filter_space, IPoseFilter **out_pose_filter);
 static void init_filters_for_virtual_hmd(
@@ -67,19 +122,39 @@ ServerHMDView::ServerHMDView(const int device_id)
     , m_shape_tracking_models(nullptr)
     , m_optical_pose_estimations(nullptr)
 	, m_sharedFilteredPose(nullptr)
+	, m_sharedTrackerProjections(nullptr)
 	, m_currentlyTrackingBitmask({0})
-	, m_lastIMUSensorPacket(nullptr)
-	, m_lastOpticalSensorPacket(nullptr)
+	, m_bUseFilterThread({false})
+	, m_bHasUnpublishedFilterState({false})
+	, m_unpublishedSensorPacketBitmask({0})
+	, m_sharedFilteredState(nullptr)
+	, m_sharedClientFilteredState(nullptr)
+	, m_sharedLastIMUSensorPacket(nullptr)
+	, m_sharedLastOpticalSensorPackets(nullptr)
+	, m_filterThread(nullptr)
     , m_pose_filter(nullptr)
     , m_pose_filter_space(nullptr)
+    , m_pose_filter_history(nullptr)
+    , m_appliedFilterPacketCount(0)
+    , m_droppedFilterPacketCount(0)
+    , m_rewoundFilterPacketCount(0)
+    , m_lateFilterPacketCount(0)
+    , m_shapeSolveLatency(nullptr)
+	, m_imuSensorAgeMs(-1.f)
+	, m_opticalSensorAgeMs(-1.f)
+	, m_lastIMUSensorPacket(nullptr)
+	, m_lastOpticalSensorPacket(nullptr)
     , m_lastPollSeqNumProcessed(-1)
-    , m_lastFilterUpdateTimestamp()
-    , m_bIsLastFilterUpdateTimestampValid(false)
 {
+	m_PoseSensorOpticalPacketQueues= new t_hmd_pose_sensor_queue[TrackerManager::k_max_devices];
+	m_shapeSolveLatency= new LatencyHistogram[TrackerManager::k_max_devices];
+	m_filteredState.clear();
 }
 
 ServerHMDView::~ServerHMDView()
 {
+	delete[] m_PoseSensorOpticalPacketQueues;
+	delete[] m_shapeSolveLatency;
 }
 
 bool ServerHMDView::allocate_device_interface(const class DeviceEnumerator *enumerator)
@@ -88,7 +163,17 @@ bool ServerHMDView::allocate_device_interface(const class DeviceEnumerator *enum
     {
     case CommonSensorState::Morpheus:
         {
-            m_device = new MorpheusHMD();
+            const HMDDeviceEnumerator *hmd_enumerator= static_cast<const HMDDeviceEnumerator *>(enumerator);
+
+            // Replayed Morpheus HMDs read their IMU packets from the session recording
+            if (hmd_enumerator->get_api_type() == HMDDeviceEnumerator::CommunicationType_REPLAY)
+            {
+                m_device = new ReplayHMD();
+            }
+            else
+            {
+                m_device = new MorpheusHMD();
+            }
 			m_device->setHMDListener(this);
 
             m_pose_filter = nullptr; // no pose filter until the device is opened
@@ -99,8 +184,13 @@ bool ServerHMDView::allocate_device_interface(const class DeviceEnumerator *enum
 
 			m_lastIMUSensorPacket = new PoseSensorPacket;
 			m_lastIMUSensorPacket->clear();
+			m_sharedLastIMUSensorPacket= new AtomicObject<PoseSensorPacket>;
 
 			m_sharedFilteredPose= new AtomicObject<ShapeTimestampedPose>;
+			m_sharedFilteredState= new AtomicObject<HMDFilteredState>;
+			m_sharedClientFilteredState= new AtomicObject<HMDFilteredState>;
+			m_sharedLastOpticalSensorPackets= new AtomicObject<PoseSensorPacket>[TrackerManager::k_max_devices];
+			m_sharedTrackerProjections= new AtomicObject<PSVRTrackingProjection>[TrackerManager::k_max_devices];
             m_shape_tracking_models = new IShapeTrackingModel *[TrackerManager::k_max_devices]; 
             m_optical_pose_estimations = new HMDOpticalPoseEstimation[TrackerManager::k_max_devices];
 			m_lastOpticalSensorPacket = new PoseSensorPacket[TrackerManager::k_max_devices];
@@ -108,6 +198,7 @@ bool ServerHMDView::allocate_device_interface(const class DeviceEnumerator *enum
             {
                 m_optical_pose_estimations[tracker_index].clear();
 				m_lastOpticalSensorPacket[tracker_index].clear();
+				m_sharedTrackerProjections[tracker_index].storeValue(m_optical_pose_estimations[tracker_index].projection);
 
                 m_shape_tracking_models[tracker_index] = new PointCloudTrackingModel();            
                 m_shape_tracking_models[tracker_index]->init(&tracking_shape);
@@ -125,8 +216,13 @@ bool ServerHMDView::allocate_device_interface(const class DeviceEnumerator *enum
             m_device->getTrackingShape(tracking_shape);
 
 			m_lastIMUSensorPacket= nullptr;
+			m_sharedLastIMUSensorPacket= nullptr;
 
 			m_sharedFilteredPose= new AtomicObject<ShapeTimestampedPose>;
+			m_sharedFilteredState= new AtomicObject<HMDFilteredState>;
+			m_sharedClientFilteredState= new AtomicObject<HMDFilteredState>;
+			m_sharedLastOpticalSensorPackets= new AtomicObject<PoseSensorPacket>[TrackerManager::k_max_devices];
+			m_sharedTrackerProjections= new AtomicObject<PSVRTrackingProjection>[TrackerManager::k_max_devices];
             m_shape_tracking_models = new IShapeTrackingModel *[TrackerManager::k_max_devices]; 
             m_optical_pose_estimations = new HMDOpticalPoseEstimation[TrackerManager::k_max_devices];
 			m_lastOpticalSensorPacket = new PoseSensorPacket[TrackerManager::k_max_devices];
@@ -134,6 +230,7 @@ bool ServerHMDView::allocate_device_interface(const class DeviceEnumerator *enum
             {
                 m_optical_pose_estimations[tracker_index].clear();
 				m_lastOpticalSensorPacket[tracker_index].clear();
+				m_sharedTrackerProjections[tracker_index].storeValue(m_optical_pose_estimations[tracker_index].projection);
 
                 switch (tracking_shape.shape_type)
                 {
@@ -159,12 +256,45 @@ bool ServerHMDView::allocate_device_interface(const class DeviceEnumerator *enum
 
 void ServerHMDView::free_device_interface()
 {
+	// The filter thread uses everything below
+	stop_filter_thread();
+
 	if (m_sharedFilteredPose)
 	{
 		delete m_sharedFilteredPose;
 		m_sharedFilteredPose= nullptr;
 	}
 
+	if (m_sharedFilteredState != nullptr)
+	{
+		delete m_sharedFilteredState;
+		m_sharedFilteredState= nullptr;
+	}
+
+	if (m_sharedClientFilteredState != nullptr)
+	{
+		delete m_sharedClientFilteredState;
+		m_sharedClientFilteredState= nullptr;
+	}
+
+	if (m_sharedLastIMUSensorPacket != nullptr)
+	{
+		delete m_sharedLastIMUSensorPacket;
+		m_sharedLastIMUSensorPacket= nullptr;
+	}
+
+	if (m_sharedLastOpticalSensorPackets != nullptr)
+	{
+		delete[] m_sharedLastOpticalSensorPackets;
+		m_sharedLastOpticalSensorPackets= nullptr;
+	}
+
+	if (m_sharedTrackerProjections != nullptr)
+	{
+		delete[] m_sharedTrackerProjections;
+		m_sharedTrackerProjections= nullptr;
+	}
+
     if (m_optical_pose_estimations != nullptr)
     {
         delete[] m_optical_pose_estimations;
@@ -183,6 +313,12 @@ void ServerHMDView::free_device_interface()
 		m_lastOpticalSensorPacket= nullptr;
 	}
 
+    if (m_pose_filter_history != nullptr)
+    {
+        delete m_pose_filter_history;
+        m_pose_filter_history = nullptr;
+    }
+
     if (m_pose_filter_space != nullptr)
     {
         delete m_pose_filter_space;
@@ -279,6 +415,15 @@ void ServerHMDView::resetPoseFilter()
 {
     assert(m_device != nullptr);
 
+	// The filter thread can't run while the filter is replaced
+	stop_filter_thread();
+
+    if (m_pose_filter_history != nullptr)
+    {
+        delete m_pose_filter_history;
+        m_pose_filter_history = nullptr;
+    }
+
     if (m_pose_filter != nullptr)
     {
         delete m_pose_filter;
@@ -309,13 +454,73 @@ void ServerHMDView::resetPoseFilter()
         break;
     }
 
-	m_bIsLastFilterUpdateTimestampValid= false;
+	if (m_pose_filter != nullptr)
+	{
+		m_pose_filter_history= new PoseFilterHistory(m_pose_filter, m_pose_filter_space, k_pose_filter_history_size);
+	}
+
 	m_bIsLastSensorDataTimestampValid= false;
+
+	start_filter_thread();
+}
+
+void ServerHMDView::resetPoseFilterState()
+{
+	stop_filter_thread();
+
+	if (m_pose_filter != nullptr)
+	{
+		m_pose_filter->resetState();
+
+		// The recorded filter states predate the reset
+		m_pose_filter_history->clear();
+	}
+
+	start_filter_thread();
+}
+
+void ServerHMDView::start_filter_thread()
+{
+	const HMDManagerConfig &hmdMgrConfig= DeviceManager::getInstance()->getHMDManager()->getConfig();
+
+	if (hmdMgrConfig.use_filter_thread && m_pose_filter != nullptr && m_filterThread == nullptr)
+	{
+		char thread_name[32];
+		Utility::format_string(thread_name, sizeof(thread_name), "HMDFilter%d", getDeviceID());
+
+		m_filterThread= new HMDFilterThread(thread_name, this);
+		m_filterThread->setThreadAffinity(hmdMgrConfig.filter_thread_cpu);
+		m_filterThread->setSpinWaitCount(hmdMgrConfig.filter_thread_spin_wait_count);
+		m_filterThread->startThread();
+		m_bUseFilterThread= true;
+	}
+}
+
+void ServerHMDView::stop_filter_thread()
+{
+	if (m_filterThread != nullptr)
+	{
+		m_bUseFilterThread= false;
+		m_filterThread->stopThread();
+		delete m_filterThread;
+		m_filterThread= nullptr;
+	}
 }
 
-void ServerHMDView::notifyTrackerDataReceived(ServerTrackerView* tracker)
+void ServerHMDView::wake_filter_thread()
 {
-    const t_high_resolution_timepoint now= std::chrono::high_resolution_clock::now();
+	if (m_bUseFilterThread)
+	{
+		m_filterThread->signalWork();
+	}
+}
+
+void ServerHMDView::notifyTrackerDataReceived(
+	ServerTrackerView* tracker,
+	const t_service_timepoint &frame_timestamp,
+	const PSVRTrackingProjection *projection)
+{
+    const t_high_resolution_timepoint now= frame_timestamp;
 
 	int tracker_id= tracker->getDeviceID();
 	HMDOpticalPoseEstimation &tracker_pose_estimate_ref = m_optical_pose_estimations[tracker_id];
@@ -328,17 +533,14 @@ void ServerHMDView::notifyTrackerDataReceived(ServerTrackerView* tracker)
         m_device->getTrackingShape(trackingShape);
         assert(trackingShape.shape_type != PSVRTrackingShape_INVALID);
 
-        // Create a copy of the pose estimate state so that in event of a 
-        // failure part way through computing the projection we don't
-        // set partially valid state
-        PSVRTrackingProjection newTrackerProjection;
-
-        // Compute the projection of the shape on the tracker
-        if (tracker->computeProjectionForHMD(
-                this, 
-                &trackingShape,
-                &newTrackerProjection))
+        // The projection of the shape on the tracker was computed by the tracker's segmentation stage.
+        // Work on a copy so that in event of a failure part way through
+        // applying the projection we don't set partially valid state
+        if (projection != nullptr)
         {
+			const std::chrono::high_resolution_clock::time_point solve_start_time= std::chrono::high_resolution_clock::now();
+			PSVRTrackingProjection newTrackerProjection= *projection;
+
 			// Get the last filtered pose from the main thread
 			ShapeTimestampedPose filteredPose;
 			m_sharedFilteredPose->fetchValue(filteredPose);
@@ -412,6 +614,8 @@ void ServerHMDView::notifyTrackerDataReceived(ServerTrackerView* tracker)
                 tracker_pose_estimate_ref.last_visible_timestamp = now;
             }
 
+			m_shapeSolveLatency[tracker_id].recordDuration(std::chrono::high_resolution_clock::now() - solve_start_time);
+
 			// Draw projection debugging now that shape tracking model has been applied
 			tracker->drawPoseProjection(&newTrackerProjection);
         }
@@ -440,7 +644,7 @@ void ServerHMDView::notifyTrackerDataReceived(ServerTrackerView* tracker)
 					tracker_id,
 					now,
 					&tracker_pose_estimate_ref,
-					&m_PoseSensorOpticalPacketQueue);
+					&m_PoseSensorOpticalPacketQueues[tracker_id]);
 			} break;
 		case CommonSensorState::VirtualHMD:
 			{
@@ -452,7 +656,7 @@ void ServerHMDView::notifyTrackerDataReceived(ServerTrackerView* tracker)
 					tracker_id,
 					now,
 					&tracker_pose_estimate_ref,
-					&m_PoseSensorOpticalPacketQueue);
+					&m_PoseSensorOpticalPacketQueues[tracker_id]);
 			} break;
 		default:
 			assert(0 && "Unhandled HMD type");
@@ -461,6 +665,8 @@ void ServerHMDView::notifyTrackerDataReceived(ServerTrackerView* tracker)
 		// Set the flag corresponding to this tracker index to 1
 		unsigned long tracker_bitmask= (1 << tracker_id);
 		m_currentlyTrackingBitmask|= tracker_bitmask;
+
+		wake_filter_thread();
 	}
 	else
 	{
@@ -468,13 +674,80 @@ void ServerHMDView::notifyTrackerDataReceived(ServerTrackerView* tracker)
 		unsigned long tracker_bitmask= ~(1 << tracker_id);
 		m_currentlyTrackingBitmask&= tracker_bitmask;
 	}
+
+	// Hand the latest projection to the tracker's segmentation stage so it can compute the next ROI
+	{
+		PSVRTrackingProjection roiProjection= tracker_pose_estimate_ref.projection;
+
+		if (!tracker_pose_estimate_ref.bCurrentlyTracking)
+		{
+			roiProjection.shape_type= PSVRShape_INVALID_PROJECTION;
+		}
+
+		m_sharedTrackerProjections[tracker_id].storeValue(roiProjection);
+	}
+}
+
+bool ServerHMDView::getLatestTrackerProjection(int tracker_id, PSVRTrackingProjection &out_projection) const
+{
+	if (m_sharedTrackerProjections == nullptr)
+	{
+		return false;
+	}
+
+	m_sharedTrackerProjections[tracker_id].fetchValue(out_projection);
+
+	return out_projection.shape_type != PSVRShape_INVALID_PROJECTION;
+}
+
+void ServerHMDView::getStatistics(PSVRHmdStatistics &out_statistics) const
+{
+	memset(&out_statistics, 0, sizeof(PSVRHmdStatistics));
+
+	// Every tracker's solve thread records into its own histogram
+	LatencyHistogramSnapshot shape_solve_snapshot;
+	for (int tracker_id = 0; tracker_id < TrackerManager::k_max_devices; ++tracker_id)
+	{
+		shape_solve_snapshot.add(m_shapeSolveLatency[tracker_id]);
+	}
+	shape_solve_snapshot.getStatistics(out_statistics.stage_latency[PSVRHmdStage_ShapeSolve]);
+
+	LatencyHistogramSnapshot filter_enqueue_snapshot;
+	filter_enqueue_snapshot.add(m_filterEnqueueLatency);
+	filter_enqueue_snapshot.getStatistics(out_statistics.stage_latency[PSVRHmdStage_FilterEnqueue]);
+
+	LatencyHistogramSnapshot filter_update_snapshot;
+	filter_update_snapshot.add(m_filterUpdateLatency);
+	filter_update_snapshot.getStatistics(out_statistics.stage_latency[PSVRHmdStage_FilterUpdate]);
+
+	LatencyHistogramSnapshot publish_snapshot;
+	publish_snapshot.add(m_publishLatency);
+	publish_snapshot.getStatistics(out_statistics.stage_latency[PSVRHmdStage_Publish]);
+
+	out_statistics.filter_packet_count= m_appliedFilterPacketCount.load();
+	out_statistics.trimmed_filter_packet_count= m_droppedFilterPacketCount.load();
+	out_statistics.rewound_filter_packet_count= m_rewoundFilterPacketCount.load();
+	out_statistics.late_filter_packet_count= m_lateFilterPacketCount.load();
+}
+
+void ServerHMDView::getMotionToPoseLatency(PSVRHmdMotionToPoseLatency &out_latency) const
+{
+	LatencyHistogramSnapshot imu_snapshot;
+	imu_snapshot.add(m_imuToPoseLatency);
+	imu_snapshot.getStatistics(out_latency.imu_to_pose);
+
+	LatencyHistogramSnapshot optical_snapshot;
+	optical_snapshot.add(m_opticalToPoseLatency);
+	optical_snapshot.getStatistics(out_latency.optical_to_pose);
 }
 
 void 
-ServerHMDView::notifySensorDataReceived(const CommonSensorState *sensor_state)
+ServerHMDView::notifySensorDataReceived(
+	const CommonSensorState *sensor_state,
+	const t_service_timepoint &capture_timestamp)
 {
     // Compute the time in seconds since the last update
-    const t_high_resolution_timepoint now = std::chrono::high_resolution_clock::now();
+    const t_high_resolution_timepoint now = capture_timestamp;
 	t_high_resolution_duration durationSinceLastUpdate= t_high_resolution_duration::zero();
 
 	if (m_bIsLastSensorDataTimestampValid)
@@ -492,11 +765,20 @@ ServerHMDView::notifySensorDataReceived(const CommonSensorState *sensor_state)
             const MorpheusHMD *morpheusHMD = this->castCheckedConst<MorpheusHMD>();
             const MorpheusHMDSensorState *morpheusHMDState = static_cast<const MorpheusHMDSensorState *>(sensor_state);
 
+            // Record the sensor state as the device delivered it
+            SessionRecorder *recorder= DeviceManager::getInstance()->getSessionRecorder();
+            if (recorder->getIsRecording())
+            {
+                recorder->recordHMDSensorState(getDeviceID(), morpheusHMDState, capture_timestamp);
+            }
+
             // Only update the position filter when tracking is enabled
             post_imu_filter_packets_for_morpheus_hmd(
                 morpheusHMD, morpheusHMDState,
                 now, durationSinceLastUpdate,
 				&m_PoseSensorIMUPacketQueue);
+
+            wake_filter_thread();
         } break;
     default:
         assert(0 && "Unhandled HMD type");
@@ -509,144 +791,237 @@ ServerHMDView::notifySensorDataReceived(const CommonSensorState *sensor_state)
 // Update Pose Filter using update packets from the tracker and IMU threads
 void ServerHMDView::updatePoseFilter()
 {
-	std::vector<PoseSensorPacket> timeSortedPackets;
-
-	// Drain the packet queues filled by the threads
-	PoseSensorPacket packet;
-	while (m_PoseSensorIMUPacketQueue.try_dequeue(packet))
+	// Without a filter thread the main thread runs the filter
+	if (m_filterThread == nullptr)
 	{
-		timeSortedPackets.push_back(packet);
+		processPoseSensorPackets();
 	}
-	while (m_PoseSensorOpticalPacketQueue.try_dequeue(packet))
+
+	fetch_filtered_state();
+}
+
+bool ServerHMDView::processPoseSensorPackets()
+{
+	const std::chrono::high_resolution_clock::time_point update_start_time= std::chrono::high_resolution_clock::now();
+
+	// Every source queue is already in time order (one producer each),
+	// so the packets can be fed to the filter in time order with a k-way merge of the queue heads.
+	// Only the packets queued as of now are processed, so a busy producer can't keep us here.
+	t_hmd_pose_sensor_queue *sources[k_pose_packet_source_count];
+	size_t source_pending_count[k_pose_packet_source_count];
+	size_t total_pending_count= 0;
+	for (int source_index = 0; source_index < k_pose_packet_source_count; ++source_index)
 	{
-		timeSortedPackets.push_back(packet);
+		sources[source_index]= 
+			(source_index == k_imu_packet_source) 
+			? &m_PoseSensorIMUPacketQueue 
+			: &m_PoseSensorOpticalPacketQueues[source_index - 1];
+		source_pending_count[source_index]= sources[source_index]->size_approx();
+		total_pending_count+= source_pending_count[source_index];
 	}
 
-	// Sort the packets in order of ascending time
-	if (timeSortedPackets.size() > 1)
+	if (total_pending_count == 0)
 	{
-		std::sort(
-			timeSortedPackets.begin(), timeSortedPackets.end(), 
-			[](const PoseSensorPacket & a, const PoseSensorPacket & b) -> bool
-			{
-				return a.timestamp < b.timestamp; 
-			});
+		return false;
+	}
 
-		t_high_resolution_duration duration= 
-			timeSortedPackets[timeSortedPackets.size()-1].timestamp - timeSortedPackets[0].timestamp;
-		std::chrono::duration<float, std::milli> milli_duration= duration;
+	PSVR_TRACE_ZONE("HMD Filter Update");
 
-		const size_t k_max_process_count= 100;
-		if (timeSortedPackets.size() > k_max_process_count)
+	// Returns the source with the oldest packet at its head (-1 if all are empty)
+	auto find_oldest_source= [&sources, &source_pending_count]() -> int {
+		int oldest_source_index= -1;
+		const PoseSensorPacket *oldest_packet= nullptr;
+
+		for (int source_index = 0; source_index < k_pose_packet_source_count; ++source_index)
 		{
-			const size_t excess= timeSortedPackets.size() - k_max_process_count;
+			if (source_pending_count[source_index] == 0)
+				continue;
+
+			const PoseSensorPacket *packet= sources[source_index]->peek();
+			if (packet == nullptr)
+			{
+				source_pending_count[source_index]= 0;
+				continue;
+			}
 
-			//PSVR_LOG_WARNING("updatePoseFilter()") << "Incoming packet count: " << timeSortedPackets.size() << " (" << milli_duration.count() << "ms)" << ", trimming: " << excess;
-			timeSortedPackets.erase(timeSortedPackets.begin(), timeSortedPackets.begin()+excess);
+			if (oldest_packet == nullptr || packet->timestamp < oldest_packet->timestamp)
+			{
+				oldest_packet= packet;
+				oldest_source_index= source_index;
+			}
 		}
-		else
+
+		return oldest_source_index;
+	};
+
+	// If we've fallen behind, drop the oldest packets across all sources so that
+	// the filter catches up on the newest data rather than lagging further behind
+	if (total_pending_count > k_max_filter_packets_per_update)
+	{
+		const size_t drop_count= total_pending_count - k_max_filter_packets_per_update;
+
+		for (size_t drop_index = 0; drop_index < drop_count; ++drop_index)
 		{
-			//PSVR_LOG_INFO("updatePoseFilter()") << "Incoming packet count: " << timeSortedPackets.size() << " (" << milli_duration.count() << "ms)";
+			const int source_index= find_oldest_source();
+			if (source_index == -1)
+				break;
+
+			sources[source_index]->pop();
+			--source_pending_count[source_index];
 		}
-	}
 
-	const PoseSensorPacket *lastIMUPacket= nullptr;
-	const PoseSensorPacket *lastOpticalPacket[TrackerManager::k_max_devices];
-	memset(lastOpticalPacket, 0, sizeof(lastOpticalPacket));
+		m_droppedFilterPacketCount+= drop_count;
+		PSVR_MT_LOG_WARNING("ServerHMDView::processPoseSensorPackets()") << 
+			"HMD " << getDeviceID() << " fell behind, dropped the " << drop_count << " oldest of " << total_pending_count << 
+			" sensor packets (" << m_droppedFilterPacketCount.load() << " total)";
+	}
 
 	// Process the sensor packets from oldest to newest
-	for (const PoseSensorPacket &sensorPacket : timeSortedPackets)
+	bool bProcessedPackets= false;
+	int replay_budget= k_max_filter_replay_packets_per_update;
+	for (int source_index = find_oldest_source(); source_index != -1; source_index = find_oldest_source())
     {
-		// Compute the time since the last packet
-		float time_delta_seconds;
-		if (m_bIsLastFilterUpdateTimestampValid)
+		const PoseSensorPacket &sensorPacket= *sources[source_index]->peek();
+
+		m_filterEnqueueLatency.recordDuration(std::chrono::high_resolution_clock::now() - sensorPacket.queued_time);
+
+		// An optical packet can be older than IMU packets applied on an earlier update.
+		// Rewind the filter to apply it in time order, if the replay fits in this update's budget.
+		if (m_pose_filter_history->getIsLateSensorPacket(sensorPacket))
 		{
-			const std::chrono::duration<float, std::milli> time_delta = sensorPacket.timestamp - m_lastFilterUpdateTimestamp;
-			const float time_delta_milli = time_delta.count();
+			const int replay_count= m_pose_filter_history->computeReplayCount(sensorPacket);
+
+			if (replay_count >= 0 && replay_count <= replay_budget)
+			{
+				m_pose_filter_history->rewindAndApplySensorPacket(sensorPacket, replay_count);
+				replay_budget-= replay_count;
+				++m_rewoundFilterPacketCount;
+			}
+			else
+			{
+				m_pose_filter_history->applySensorPacket(sensorPacket);
+				++m_lateFilterPacketCount;
 
-			// convert delta to seconds clamp time delta between 2500hz and 30hz
-			time_delta_seconds = clampf(time_delta_milli / 1000.f, k_min_time_delta_seconds, k_max_time_delta_seconds);
+				if (m_pose_filter_history->getIsRewindSupported())
+				{
+					PSVR_MT_LOG_DEBUG("ServerHMDView::processPoseSensorPackets()") <<
+						"HMD " << getDeviceID() << " applied a late sensor packet out of order (" << 
+						m_lateFilterPacketCount.load() << " out of order, " << m_rewoundFilterPacketCount.load() << " rewound total)";
+				}
+			}
 		}
 		else
 		{
-			time_delta_seconds = k_max_time_delta_seconds;
+			m_pose_filter_history->applySensorPacket(sensorPacket);
 		}
-		m_lastFilterUpdateTimestamp = sensorPacket.timestamp;
-		m_bIsLastFilterUpdateTimestampValid = true;
 
-		// Store a pointer to the last imu sensor packet we saw
-		if (sensorPacket.has_imu_measurements())
+		// Keep track of how fresh the measurements in the filtered pose are
+		if (sensorPacket.has_imu_measurements() && sensorPacket.timestamp > m_newestIMUSensorTimestamp)
 		{
-			lastIMUPacket= &sensorPacket;
+			m_newestIMUSensorTimestamp= sensorPacket.timestamp;
 		}
-
-		// Store a pointer to the last optical sensor packet we saw
-		if (sensorPacket.has_optical_measurement())
+		if (sensorPacket.has_optical_measurement() && sensorPacket.timestamp > m_newestOpticalSensorTimestamp)
 		{
-			lastOpticalPacket[sensorPacket.tracker_id]=  &sensorPacket;
+			m_newestOpticalSensorTimestamp= sensorPacket.timestamp;
 		}
 
+		// Publish the last IMU packet and the last optical packet for each tracker
+		if (source_pending_count[source_index] == 1)
 		{
-			PoseFilterPacket filter_packet;
-			filter_packet.clear();
-
-			// Create a filter input packet from the sensor data 
-			// and the filter's previous orientation and position
-			m_pose_filter_space->createFilterPacket(
-				sensorPacket,
-				m_pose_filter,
-				filter_packet);
-
-			// Process the filter packet
-			m_pose_filter->update(time_delta_seconds, filter_packet);
+			if (sensorPacket.has_imu_measurements() && m_sharedLastIMUSensorPacket != nullptr)
+			{
+				m_sharedLastIMUSensorPacket->storeValue(sensorPacket);
+				m_unpublishedSensorPacketBitmask|= 1;
+			}
+
+			if (sensorPacket.has_optical_measurement())
+			{
+				m_sharedLastOpticalSensorPackets[sensorPacket.tracker_id].storeValue(sensorPacket);
+				m_unpublishedSensorPacketBitmask|= (1 << (sensorPacket.tracker_id + 1));
+			}
 		}
 
-		// Flag the state as unpublished, which will trigger an update to the client
-		markStateAsUnpublished();
+		sources[source_index]->pop();
+		--source_pending_count[source_index];
+
+		++m_appliedFilterPacketCount;
+		bProcessedPackets= true;
 	}
 
-	// Publish the filtered state to the shared filtered pose.
-	// This lets the optical pose processing threads use the the most recent filter out
-	// as a guess for the next optical tracking estimate.
-	if (m_bHasUnpublishedState)
+	if (bProcessedPackets)
 	{
-		if (m_pose_filter->getIsOrientationStateValid())
+		HMDFilteredState filtered_state;
+		filtered_state.pose_cm= compute_filtered_pose(m_pose_filter);
+		filtered_state.physics= compute_filtered_physics(m_pose_filter);
+		filtered_state.bIsValid= m_pose_filter->getIsStateValid();
+		filtered_state.bIsOrientationValid= m_pose_filter->getIsOrientationStateValid();
+		filtered_state.newest_imu_timestamp= m_newestIMUSensorTimestamp;
+		filtered_state.newest_optical_timestamp= m_newestOpticalSensorTimestamp;
+
+		// Publish the filtered state to the main thread and the client API
+		m_sharedFilteredState->storeValue(filtered_state);
+		m_sharedClientFilteredState->storeValue(filtered_state);
+		m_bHasUnpublishedFilterState= true;
+
+		// Publish the filtered state to the shared filtered pose.
+		// This lets the optical pose processing threads use the the most recent filter out
+		// as a guess for the next optical tracking estimate.
+		if (filtered_state.bIsOrientationValid)
 		{
 			ShapeTimestampedPose filtered_pose;
-			filtered_pose.timestamp= std::chrono::high_resolution_clock::now();
-			filtered_pose.pose_cm= getFilteredPose();
+			filtered_pose.timestamp= ServiceClock::now();
+			filtered_pose.pose_cm= filtered_state.pose_cm;
 			filtered_pose.bIsValid= true;
 
 			m_sharedFilteredPose->storeValue(filtered_pose);
 		}
-	}
 
-	// Copy off the last IMU packet
-	if (lastIMUPacket != nullptr)
-	{
-		*m_lastIMUSensorPacket= *lastIMUPacket;
+		m_filterUpdateLatency.recordDuration(std::chrono::high_resolution_clock::now() - update_start_time);
 	}
 
-	// Copy off the last optical packet for each tracker
-	for (int tracker_id = 0; tracker_id < TrackerManager::k_max_devices; ++tracker_id)
+	return bProcessedPackets;
+}
+
+void ServerHMDView::fetch_filtered_state()
+{
+	if (m_bHasUnpublishedFilterState.exchange(false))
 	{
-		if (lastOpticalPacket[tracker_id] != nullptr)
+		m_sharedFilteredState->fetchValue(m_filteredState);
+
+		const unsigned long sensor_packet_bitmask= m_unpublishedSensorPacketBitmask.exchange(0);
+
+		if ((sensor_packet_bitmask & 1) != 0 && m_lastIMUSensorPacket != nullptr)
+		{
+			m_sharedLastIMUSensorPacket->fetchValue(*m_lastIMUSensorPacket);
+		}
+
+		for (int tracker_id = 0; tracker_id < TrackerManager::k_max_devices; ++tracker_id)
 		{
-			m_lastOpticalSensorPacket[tracker_id]= *lastOpticalPacket[tracker_id];
+			if ((sensor_packet_bitmask & (1 << (tracker_id + 1))) != 0)
+			{
+				m_sharedLastOpticalSensorPackets[tracker_id].fetchValue(m_lastOpticalSensorPacket[tracker_id]);
+			}
 		}
+
+		// Flag the state as unpublished, which will trigger an update to the client
+		markStateAsUnpublished();
 	}
 }
 
-PSVRPosef
-ServerHMDView::getFilteredPose(float time) const
+void ServerHMDView::fetchClientFilteredState(HMDFilteredState &out_state) const
 {
-    PSVRPosef pose= *k_PSVR_pose_identity;
+	m_sharedClientFilteredState->fetchValue(out_state);
+}
 
+static PSVRPosef
+compute_filtered_pose(const IPoseFilter *pose_filter)
+{
+    PSVRPosef pose= *k_PSVR_pose_identity;
 
-    if (m_pose_filter != nullptr)
+    if (pose_filter != nullptr)
     {
-        const Eigen::Quaternionf orientation = m_pose_filter->getOrientation(time);
-        const Eigen::Vector3f position_cm = m_pose_filter->getPositionCm(time);
+        const Eigen::Quaternionf orientation = pose_filter->getOrientation();
+        const Eigen::Vector3f position_cm = pose_filter->getPositionCm();
 
         pose.Orientation.w = orientation.w();
         pose.Orientation.x = orientation.x();
@@ -661,17 +1036,18 @@ ServerHMDView::getFilteredPose(float time) const
     return pose;
 }
 
-PSVRPhysicsData
-ServerHMDView::getFilteredPhysics() const
+static PSVRPhysicsData
+compute_filtered_physics(const IPoseFilter *pose_filter)
 {
     PSVRPhysicsData physics;
+    memset(&physics, 0, sizeof(PSVRPhysicsData));
 
-    if (m_pose_filter != nullptr)
+    if (pose_filter != nullptr)
     {
-        const Eigen::Vector3f first_derivative = m_pose_filter->getAngularVelocityRadPerSec();
-        const Eigen::Vector3f second_derivative = m_pose_filter->getAngularAccelerationRadPerSecSqr();
-        const Eigen::Vector3f velocity(m_pose_filter->getVelocityCmPerSec());
-        const Eigen::Vector3f acceleration(m_pose_filter->getAccelerationCmPerSecSqr());
+        const Eigen::Vector3f first_derivative = pose_filter->getAngularVelocityRadPerSec();
+        const Eigen::Vector3f second_derivative = pose_filter->getAngularAccelerationRadPerSecSqr();
+        const Eigen::Vector3f velocity(pose_filter->getVelocityCmPerSec());
+        const Eigen::Vector3f acceleration(pose_filter->getAccelerationCmPerSecSqr());
 
         physics.AngularVelocityRadPerSec.x = first_derivative.x();
         physics.AngularVelocityRadPerSec.y = first_derivative.y();
@@ -689,7 +1065,7 @@ ServerHMDView::getFilteredPhysics() const
         physics.LinearAccelerationCmPerSecSqr.y = acceleration.y();
         physics.LinearAccelerationCmPerSecSqr.z = acceleration.z();
 
-        physics.TimeInSeconds= m_pose_filter->getTimeInSeconds();
+        physics.TimeInSeconds= pose_filter->getTimeInSeconds();
     }
 
     return physics;
@@ -839,6 +1215,30 @@ float ServerHMDView::getROIPredictionTime() const
 
 void ServerHMDView::publish_device_data_frame()
 {
+	LatencyScope latency_scope(m_publishLatency);
+
+	// Work out how old the measurements behind the published pose are
+	const t_service_timepoint now= ServiceClock::now();
+	const t_service_timepoint no_timestamp= t_service_timepoint();
+
+	m_imuSensorAgeMs= -1.f;
+	if (m_filteredState.newest_imu_timestamp != no_timestamp)
+	{
+		const t_service_duration imu_sensor_age= now - m_filteredState.newest_imu_timestamp;
+
+		m_imuSensorAgeMs= std::chrono::duration<float, std::milli>(imu_sensor_age).count();
+		m_imuToPoseLatency.recordDuration(imu_sensor_age);
+	}
+
+	m_opticalSensorAgeMs= -1.f;
+	if (m_filteredState.newest_optical_timestamp != no_timestamp)
+	{
+		const t_service_duration optical_sensor_age= now - m_filteredState.newest_optical_timestamp;
+
+		m_opticalSensorAgeMs= std::chrono::duration<float, std::milli>(optical_sensor_age).count();
+		m_opticalToPoseLatency.recordDuration(optical_sensor_age);
+	}
+
     // Tell the server request handler we want to send out HMD updates.
     // This will call generate_hmd_data_frame_for_stream for each listening connection.
     ServiceRequestHandler::get_instance()->publish_hmd_data_frame(
@@ -855,6 +1255,8 @@ void ServerHMDView::generate_hmd_data_frame_for_stream(
     hmd_data_frame->hmd_id= hmd_view->getDeviceID();
     hmd_data_frame->output_sequence_num= hmd_view->m_sequence_number;
     hmd_data_frame->is_connected= hmd_view->getDevice()->getIsOpen();
+    hmd_data_frame->imu_sensor_age_ms= hmd_view->m_imuSensorAgeMs;
+    hmd_data_frame->optical_sensor_age_ms= hmd_view->m_opticalSensorAgeMs;
 
     switch (hmd_view->getHMDDeviceType())
     {
@@ -1140,6 +1542,7 @@ post_imu_filter_packets_for_morpheus_hmd(
         sensor_packet.imu_magnetometer_unit = Eigen::Vector3f::Zero();
 		sensor_packet.has_magnetometer_measurement= false;
 
+        sensor_packet.queued_time= std::chrono::high_resolution_clock::now();
         pose_filter_queue->enqueue(sensor_packet);
     }
 }
@@ -1178,6 +1581,7 @@ post_optical_filter_packet_for_morpheus_hmd(
 		sensor_packet.optical_tracking_projection= pose_estimation->projection;
     }
 
+	sensor_packet.queued_time= std::chrono::high_resolution_clock::now();
 	pose_sensor_queue->enqueue(sensor_packet);
 }
 
@@ -1215,6 +1619,7 @@ post_optical_filter_packet_for_virtual_hmd(
         sensor_packet.optical_tracking_projection= pose_estimation->projection;
     }
 
+    sensor_packet.queued_time= std::chrono::high_resolution_clock::now();
     pose_sensor_queue->enqueue(sensor_packet);
 }
 
@@ -1225,7 +1630,6 @@ static void generate_morpheus_hmd_data_frame_for_stream(
 {
     const MorpheusHMD *morpheus_hmd = hmd_view->castCheckedConst<MorpheusHMD>();
     const MorpheusHMDConfig *morpheus_config = morpheus_hmd->getConfig();
-    const IPoseFilter *pose_filter = hmd_view->getPoseFilter();
     const PoseSensorPacket *imu_sensor_packet = hmd_view->getLastIMUSensorPacket();
     const PSVRPosef hmd_pose = hmd_view->getFilteredPose();
 
@@ -1237,8 +1641,8 @@ static void generate_morpheus_hmd_data_frame_for_stream(
 
         morpheus_data_frame->bIsCurrentlyTracking= hmd_view->getIsCurrentlyTracking();
         morpheus_data_frame->bIsTrackingEnabled= hmd_view->getIsTrackingEnabled();
-        morpheus_data_frame->bIsOrientationValid= pose_filter->getIsStateValid();
-        morpheus_data_frame->bIsPositionValid= pose_filter->getIsStateValid();
+        morpheus_data_frame->bIsOrientationValid= hmd_view->getIsFilteredStateValid();
+        morpheus_data_frame->bIsPositionValid= hmd_view->getIsFilteredStateValid();
 
         morpheus_data_frame->Pose.Orientation= hmd_pose.Orientation;
 
@@ -1328,7 +1732,6 @@ static void generate_virtual_hmd_data_frame_for_stream(
 {
     const VirtualHMD *virtual_hmd = hmd_view->castCheckedConst<VirtualHMD>();
     const VirtualHMDConfig *virtual_hmd_config = virtual_hmd->getConfig();
-    const IPoseFilter *pose_filter = hmd_view->getPoseFilter();
     const PSVRPosef hmd_pose = hmd_view->getFilteredPose();
 
     HMDDataPacket *hmd_data_frame = &data_frame.device.hmd_data_packet;
@@ -1336,8 +1739,8 @@ static void generate_virtual_hmd_data_frame_for_stream(
 
     virtual_hmd_data_frame->bIsCurrentlyTracking= hmd_view->getIsCurrentlyTracking();
     virtual_hmd_data_frame->bIsTrackingEnabled= hmd_view->getIsTrackingEnabled();
-    virtual_hmd_data_frame->bIsOrientationValid= pose_filter->getIsStateValid();
-    virtual_hmd_data_frame->bIsPositionValid= pose_filter->getIsStateValid();
+    virtual_hmd_data_frame->bIsOrientationValid= hmd_view->getIsFilteredStateValid();
+    virtual_hmd_data_frame->bIsPositionValid= hmd_view->getIsFilteredStateValid();
 
     virtual_hmd_data_frame->Pose.Orientation= hmd_pose.Orientation;
 
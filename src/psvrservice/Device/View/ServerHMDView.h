@@ -4,6 +4,8 @@
 //-- includes -----
 #include "ServerDeviceView.h"
 #include "PSVRServiceInterface.h"
+#include "LatencyHistogram.h"
+#include "ServiceClock.h"
 
 #include <cstring>
 #include <mutex>
@@ -25,8 +27,8 @@ struct ShapeTimestampedPose;
 // -- declarations -----
 struct HMDOpticalPoseEstimation
 {
-	std::chrono::time_point<std::chrono::high_resolution_clock> last_update_timestamp;
-	std::chrono::time_point<std::chrono::high_resolution_clock> last_visible_timestamp;
+	t_service_timepoint last_update_timestamp;
+	t_service_timepoint last_visible_timestamp;
 	bool bValidTimestamps;
 
 	PSVRVector3f tracker_relative_position_cm;
@@ -42,8 +44,8 @@ struct HMDOpticalPoseEstimation
 
 	inline void clear()
 	{
-		last_update_timestamp = std::chrono::time_point<std::chrono::high_resolution_clock>();
-		last_visible_timestamp = std::chrono::time_point<std::chrono::high_resolution_clock>();
+		last_update_timestamp = t_service_timepoint();
+		last_visible_timestamp = t_service_timepoint();
 		bValidTimestamps = false;
 
 		tracker_relative_position_cm= *k_PSVR_float_vector3_zero;
@@ -61,6 +63,29 @@ struct HMDOpticalPoseEstimation
 	}
 };
 
+// The output of the HMD pose filter after its last update
+struct HMDFilteredState
+{
+	PSVRPosef pose_cm;
+	PSVRPhysicsData physics;
+	bool bIsValid;
+	bool bIsOrientationValid;
+
+	// Capture times of the newest IMU and optical measurements fused into the pose (the epoch if none yet)
+	t_service_timepoint newest_imu_timestamp;
+	t_service_timepoint newest_optical_timestamp;
+
+	inline void clear()
+	{
+		pose_cm= *k_PSVR_pose_identity;
+		memset(&physics, 0, sizeof(PSVRPhysicsData));
+		bIsValid= false;
+		bIsOrientationValid= false;
+		newest_imu_timestamp= t_service_timepoint();
+		newest_optical_timestamp= t_service_timepoint();
+	}
+};
+
 class ServerHMDView : public ServerDeviceView, public IHMDListener
 {
 public:
@@ -70,21 +95,38 @@ public:
     bool open(const class DeviceEnumerator *enumerator) override;
     void close() override;
 
-	// Update Pose Filter using update packets from the tracker and IMU threads
+	// Update Pose Filter using update packets from the tracker and IMU threads.
+	// When the HMD has a filter thread this only picks up the state the filter thread last published.
 	void updatePoseFilter();
 
+	// Feed the queued sensor packets from the tracker and IMU threads to the pose filter
+	// and publish the result. Called by the filter thread, or by updatePoseFilter() when there is none.
+	// Returns false if there were no packets to process.
+	bool processPoseSensorPackets();
+
 	// Recreate and initialize the pose filter for the HMD
 	void resetPoseFilter();
 
+	// Clear the state of the existing pose filter, i.e. after a calibration change
+	void resetPoseFilterState();
+
+	// True if a service owned thread runs the pose filter rather than PSVR_Update()
+	inline bool getHasFilterThread() const { return m_bUseFilterThread.load(); }
+
+	// Lock free read of the freshest pose filter output, for the client API (one reader thread).
+	// Only valid when the HMD has a filter thread.
+	void fetchClientFilteredState(HMDFilteredState &out_state) const;
+
     IDeviceInterface* getDevice() const override { return m_device; }
-	inline class IPoseFilter * getPoseFilterMutable() { return m_pose_filter; }
-	inline const class IPoseFilter * getPoseFilter() const { return m_pose_filter; }
 
-	// Estimate the given pose if the controller at some point into the future
-	PSVRPosef getFilteredPose(float time = 0.f) const;
+	// Get the filtered pose as of the last updatePoseFilter()
+	inline PSVRPosef getFilteredPose() const { return m_filteredState.pose_cm; }
+
+	// Get the filtered physics as of the last updatePoseFilter()
+	inline PSVRPhysicsData getFilteredPhysics() const { return m_filteredState.physics; }
 
-	// Get the current physics from the filter position and orientation
-	PSVRPhysicsData getFilteredPhysics() const;
+	// True if the pose filter had a valid state as of the last updatePoseFilter()
+	inline bool getIsFilteredStateValid() const { return m_filteredState.bIsValid; }
 
     // Returns the full usb device path for the controller
     std::string getUSBDevicePath() const;
@@ -149,12 +191,30 @@ public:
 		return getIsTrackingEnabled() ? (m_currentlyTrackingBitmask.load() & tracker_bitmask) > 0 : false;
 	}
 
+	// Get the last projection the given tracker's solve stage found this HMD at.
+	// Safe to call from the tracker's segmentation stage. Returns false if the HMD wasn't tracked.
+	bool getLatestTrackerProjection(int tracker_id, PSVRTrackingProjection &out_projection) const;
+
+	// Get the latency of every stage from shape solve to publish, along with the pose filter counters
+	void getStatistics(PSVRHmdStatistics &out_statistics) const;
+
+	// Get the time from sensor capture to publishing for the poses published so far
+	void getMotionToPoseLatency(PSVRHmdMotionToPoseLatency &out_latency) const;
+
 	// Incoming device data callbacks
-	void notifyTrackerDataReceived(class ServerTrackerView* tracker);
-	void notifySensorDataReceived(const CommonSensorState *sensor_state) override;
+	// Called from the tracker's solve stage with the projection found in a video frame (null if none was found)
+	void notifyTrackerDataReceived(
+		class ServerTrackerView* tracker,
+		const t_service_timepoint &frame_timestamp,
+		const PSVRTrackingProjection *projection);
+	void notifySensorDataReceived(const CommonSensorState *sensor_state, const t_service_timepoint &capture_timestamp) override;
 
 protected:
 	void set_tracking_enabled_internal(bool bEnabled);
+	void start_filter_thread();
+	void stop_filter_thread();
+	void wake_filter_thread();
+	void fetch_filtered_state();
     bool allocate_device_interface(const class DeviceEnumerator *enumerator) override;
     void free_device_interface() override;
     void publish_device_data_frame() override;
@@ -179,23 +239,55 @@ private:
 	struct HMDOpticalPoseEstimation *m_optical_pose_estimations; // array of size TrackerManager::k_max_devices
 
 	// Filter State (IMU Thread)
-	std::chrono::time_point<std::chrono::high_resolution_clock> m_lastSensorDataTimestamp;
+	t_service_timepoint m_lastSensorDataTimestamp;
 	bool m_bIsLastSensorDataTimestampValid;
 
 	// Filter State (Shared)
+	// Each queue has a single producer and is time ordered
 	t_hmd_pose_sensor_queue m_PoseSensorIMUPacketQueue;
-	t_hmd_pose_sensor_queue m_PoseSensorOpticalPacketQueue;
+	t_hmd_pose_sensor_queue *m_PoseSensorOpticalPacketQueues; // array of size TrackerManager::k_max_devices
 	AtomicObject<ShapeTimestampedPose> *m_sharedFilteredPose;
+	AtomicObject<PSVRTrackingProjection> *m_sharedTrackerProjections; // array of size TrackerManager::k_max_devices
 	std::atomic_ulong m_currentlyTrackingBitmask;
 
-	// Filter State (Main Thread)
-	struct PoseSensorPacket *m_lastIMUSensorPacket;
-	struct PoseSensorPacket *m_lastOpticalSensorPacket; // array of size TrackerManager::k_max_devices
+	// Filter Output (Shared)
+	// Written by whichever thread runs the pose filter
+	std::atomic_bool m_bUseFilterThread;
+	std::atomic_bool m_bHasUnpublishedFilterState;
+	std::atomic_ulong m_unpublishedSensorPacketBitmask; // bit 0 = IMU, bit 1+tracker_id = optical
+	AtomicObject<HMDFilteredState> *m_sharedFilteredState; // read by the main thread
+	AtomicObject<HMDFilteredState> *m_sharedClientFilteredState; // read by the client API
+	AtomicObject<PoseSensorPacket> *m_sharedLastIMUSensorPacket;
+	AtomicObject<PoseSensorPacket> *m_sharedLastOpticalSensorPackets; // array of size TrackerManager::k_max_devices
+
+	// Filter State (Filter Thread, or the Main Thread if there is no filter thread)
+	class HMDFilterThread *m_filterThread;
 	class IPoseFilter *m_pose_filter;
 	class PoseFilterSpace *m_pose_filter_space;
+	class PoseFilterHistory *m_pose_filter_history;
+	t_service_timepoint m_newestIMUSensorTimestamp;
+	t_service_timepoint m_newestOpticalSensorTimestamp;
+	std::atomic<uint64_t> m_appliedFilterPacketCount;
+	std::atomic<uint64_t> m_droppedFilterPacketCount; // oldest packets trimmed because the filter fell behind
+	std::atomic<uint64_t> m_rewoundFilterPacketCount; // late packets applied in time order by rewinding the filter
+	std::atomic<uint64_t> m_lateFilterPacketCount; // late packets applied out of order (no history or over the replay budget)
+
+	// Latency statistics. Each histogram has a single writer: shape solves come from each tracker's
+	// solve thread, the filter stages from whichever thread runs the filter, publishing from the main thread.
+	LatencyHistogram *m_shapeSolveLatency; // array of size TrackerManager::k_max_devices
+	LatencyHistogram m_filterEnqueueLatency;
+	LatencyHistogram m_filterUpdateLatency;
+	LatencyHistogram m_publishLatency;
+	LatencyHistogram m_imuToPoseLatency; // main thread
+	LatencyHistogram m_opticalToPoseLatency; // main thread
+
+	// Filter Output (Main Thread)
+	HMDFilteredState m_filteredState;
+	float m_imuSensorAgeMs; // age of the newest IMU measurement in the last published pose (-1 if none)
+	float m_opticalSensorAgeMs; // age of the newest optical measurement in the last published pose (-1 if none)
+	struct PoseSensorPacket *m_lastIMUSensorPacket;
+	struct PoseSensorPacket *m_lastOpticalSensorPacket; // array of size TrackerManager::k_max_devices
     int m_lastPollSeqNumProcessed;
-	std::chrono::time_point<std::chrono::high_resolution_clock> m_lastFilterUpdateTimestamp;
-	bool m_bIsLastFilterUpdateTimestampValid;
 };
 
 #endif // SERVER_HMD_VIEW_H
\ No newline at end of file
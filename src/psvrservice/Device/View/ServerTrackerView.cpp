@@ -1,6 +1,8 @@
 //-- includes -----
 #include "DeviceEnumerator.h"
 #include "DeviceManager.h"
+#include "FrameArena.h"
+#include "HeapAllocationCounter.h"
 #include "HMDManager.h"
 #include "ServerTrackerView.h"
 #include "ServerHMDView.h"
@@ -9,29 +11,48 @@
 #include "MathGLM.h"
 #include "MathAlignment.h"
 #include "PS3EyeTracker.h"
+#include "ReplayTracker.h"
 #include "Utility.h"
 #include "Logger.h"
 #include "MathTypeConversion.h"
+#include "ServiceClock.h"
 #include "ServiceRequestHandler.h"
+#include "SessionRecorder.h"
+#include "SyntheticTracker.h"
+#include "TaskPool.h"
+#include "TimelineTrace.h"
 #include "TrackerManager.h"
 #include "TrackerCapabilitiesConfig.h"
+#include "TrackerDeviceEnumerator.h"
 #include "TrackerMath.h"
+#include "TrackerImageProcessing.h"
+#include "TrackerBlobExtractor.h"
 #include "PoseFilterInterface.h"
+#include "PSVRService.h"
 #include "WMFMonoTracker.h"
 #include "WMFStereoTracker.h"
+#include "WorkerThread.h"
 
+#include <chrono>
 #include <memory>
 
 #include "opencv2/opencv.hpp"
 #include "opencv2/calib3d/calib3d.hpp"
 
 #include <algorithm>
+#include <cstring>
 
 #define USE_OPEN_CV_ELLIPSE_FIT
 
 //-- constants ----
 static const int k_min_roi_size= 32;
 
+// Per-HMD scratch memory for one frame of segmentation
+static const size_t k_segmentation_arena_size= 32*1024;
+
+// Stage threads are woken as soon as the previous stage posts a frame, this is just a backstop
+static const std::chrono::milliseconds k_pipeline_stage_wait_timeout(100);
+
 //-- typedefs ----
 typedef std::vector<cv::Point> t_opencv_int_contour;
 typedef std::vector<t_opencv_int_contour> t_opencv_int_contour_list;
@@ -128,169 +149,139 @@ struct OpenCVPlane2D
     }
 };
 
-class OpenCVBGRToHSVMapper
-{
-public:
-    typedef cv::Point3_<uint8_t> ColorTuple;
-
-    static OpenCVBGRToHSVMapper *allocate()
-    {
-        if (m_refCount == 0)
-        {
-            assert(m_instance == nullptr);
-            m_instance = new OpenCVBGRToHSVMapper();
-        }
-        assert(m_instance != nullptr);
-
-        ++m_refCount;
-        return m_instance;
-    }
-
-    static void dispose(OpenCVBGRToHSVMapper *instance)
-    {
-        assert(m_instance != nullptr);
-        assert(m_instance == instance);
-        assert(m_refCount > 0);
-
-        --m_refCount;
-        if (m_refCount <= 0)
-        {
-            delete m_instance;
-            m_instance = nullptr;
-        }
-    }
-
-    void cvtColor(const cv::Mat &bgrBuffer, cv::Mat &hsvBuffer)
-    {
-        hsvBuffer.forEach<ColorTuple>([&bgrBuffer, this](ColorTuple &hsvColor, const int position[]) -> void {
-            const ColorTuple &bgrColor = bgrBuffer.at<ColorTuple>(position[0], position[1]);
-            const int b = bgrColor.x;
-            const int g = bgrColor.y;
-            const int r = bgrColor.z;
-            const int LUTIndex = OpenCVBGRToHSVMapper::getLUTIndex(r, g, b);
-
-            hsvColor = bgr2hsv->at<ColorTuple>(LUTIndex, 0);
-        });
-    }
-
-private:
-    static OpenCVBGRToHSVMapper *m_instance;
-    static int m_refCount;
-
-    OpenCVBGRToHSVMapper()
-    {
-        bgr2hsv = new cv::Mat(256*256*256, 1, CV_8UC3);
-
-        int LUTIndex = 0;
-        for (int r = 0; r < 256; ++r)
-        {
-            for (int g = 0; g < 256; ++g)
-            {
-                for (int b = 0; b < 256; ++b)
-                {
-                    bgr2hsv->at<ColorTuple>(LUTIndex, 0) = ColorTuple(b, g, r);
-                    ++LUTIndex;
-                }
-            }
-        }
-
-        cv::cvtColor(*bgr2hsv, *bgr2hsv, cv::COLOR_BGR2HSV);
-    }
-
-    ~OpenCVBGRToHSVMapper()
-    {
-        delete bgr2hsv;
-    }
-
-    static int getLUTIndex(int r, int g, int b)
-    {
-        return (256 * 256)*r + 256*g + b;
-    }
-
-    cv::Mat *bgr2hsv;
-};
-OpenCVBGRToHSVMapper *OpenCVBGRToHSVMapper::m_instance = nullptr;
-int OpenCVBGRToHSVMapper::m_refCount= 0;
-
 class OpenCVBufferState
 {
 public:
-    OpenCVBufferState(ITrackerInterface *device, PSVRVideoFrameSection _section)
+    OpenCVBufferState(ITrackerInterface *device, PSVRVideoFrameSection _section, int _previewDownscale)
         : section(_section)
+        , previewDownscale(_previewDownscale)
         , bgrBuffer(nullptr)
         , bgrShmemBuffer(nullptr)
-        , hsvBuffer(nullptr)
-        , gsLowerBuffer(nullptr)
-        , gsUpperBuffer(nullptr)
-        , maskedBuffer(nullptr)
+        , previewBuffer(nullptr)
+        , bayerBuffer(nullptr)
+        , bayerFrame(nullptr)
+        , bgrRowScratch(nullptr)
     {
 		const TrackerModeConfig *mode= device->getTrackerMode();
 
 		srcBufferWidth= mode->bufferPixelWidth;
 		srcBufferHeight= mode->bufferPixelHeight;
+		bIsBayerSource= mode->bufferFormat == CAMERA_BUFFER_FORMAT_BEYER;
         device->getVideoFrameDimensions(&frameWidth, &frameHeight, nullptr);
 
         bgrBuffer = new cv::Mat(frameHeight, frameWidth, CV_8UC3);
-        bgrShmemBuffer = new cv::Mat(frameHeight, frameWidth, CV_8UC3);
-        hsvBuffer = new cv::Mat(frameHeight, frameWidth, CV_8UC3);
-        gsLowerBuffer = new cv::Mat(frameHeight, frameWidth, CV_8UC1);
-        gsUpperBuffer = new cv::Mat(frameHeight, frameWidth, CV_8UC1);
-        maskedBuffer = new cv::Mat(frameHeight, frameWidth, CV_8UC3);
-        
-        const TrackerManagerConfig &cfg= DeviceManager::getInstance()->m_tracker_manager->getConfig();
-        if (cfg.use_bgr_to_hsv_lookup_table)
+        bgrRowScratch = new uint8_t[3*frameWidth];
+
+        // Mask buffers are allocated as more colors are tracked
+        for (int mask_index = 0; mask_index < HSV_MASK_MAX_COUNT; ++mask_index)
         {
-            bgr2hsv = OpenCVBGRToHSVMapper::allocate();
+            gsMaskBuffers[mask_index] = nullptr;
         }
-        else
+
+        if (bIsBayerSource)
         {
-            bgr2hsv = nullptr;
+            bayerBuffer = new uint8_t[frameWidth*frameHeight];
         }
-        
-        //Apply default ROI (full frame).
-        applyROI(cv::Rect2i(cv::Point(0,0), cv::Size(frameWidth, frameHeight)));
     }
 
     virtual ~OpenCVBufferState()
     {
-        if (maskedBuffer != nullptr)
+        releasePreviewBuffers();
+
+        if (bayerBuffer != nullptr)
         {
-            delete maskedBuffer;
+            delete[] bayerBuffer;
         }
-        
-        if (gsLowerBuffer != nullptr)
+
+        if (bgrRowScratch != nullptr)
         {
-            delete gsLowerBuffer;
+            delete[] bgrRowScratch;
         }
-        
-        if (gsUpperBuffer != nullptr)
+
+        for (int mask_index = 0; mask_index < HSV_MASK_MAX_COUNT; ++mask_index)
         {
-            delete gsUpperBuffer;
+            if (gsMaskBuffers[mask_index] != nullptr)
+            {
+                delete gsMaskBuffers[mask_index];
+            }
         }
         
-        if (hsvBuffer != nullptr)
+        if (bgrBuffer != nullptr)
         {
-            delete hsvBuffer;
+            delete bgrBuffer;
         }
-        
-        if (bgrShmemBuffer != nullptr)
+    }
+
+    // The preview buffers only exist while a video stream is open
+    void allocatePreviewBuffers()
+    {
+        if (bgrShmemBuffer == nullptr)
         {
-            delete bgrShmemBuffer;
+            bgrShmemBuffer = new cv::Mat(frameHeight, frameWidth, CV_8UC3);
         }
-        
-        if (bgrBuffer != nullptr)
+
+        if (previewDownscale > 1 && previewBuffer == nullptr)
         {
-            delete bgrBuffer;
+            previewBuffer = new cv::Mat(frameHeight / previewDownscale, frameWidth / previewDownscale, CV_8UC3);
         }
-        
-        if (bgr2hsv != nullptr)
+    }
+
+    void releasePreviewBuffers()
+    {
+        if (previewBuffer != nullptr)
+        {
+            delete previewBuffer;
+            previewBuffer = nullptr;
+        }
+
+        if (bgrShmemBuffer != nullptr)
         {
-            OpenCVBGRToHSVMapper::dispose(bgr2hsv);
+            delete bgrShmemBuffer;
+            bgrShmemBuffer = nullptr;
         }
     }
 
-    void writeVideoFrame(const unsigned char *video_buffer, bool bIsFlipped)
+    // Copy the video frame into the segmentation buffers,
+    // and into the debug overlay buffer too if this frame gets previewed
+    void writeVideoFrame(const unsigned char *video_buffer, bool bIsFlipped, bool bWritePreview)
     {
+        if (bIsBayerSource)
+        {
+            // Segmentation runs on another thread after the driver has recycled its buffer,
+            // so keep our own copy of the bayer frame
+            memcpy(bayerBuffer, video_buffer, frameWidth*frameHeight);
+
+            if (bIsFlipped)
+            {
+                // The fused bayer kernel doesn't handle mirroring, so segment from a flipped BGR copy
+                cv::Mat *debayerTarget= bWritePreview ? bgrShmemBuffer : bgrBuffer;
+
+                debayerGRBGToBGR(frameWidth, frameHeight, video_buffer, debayerTarget->data, true);
+                if (bWritePreview)
+                {
+                    cv::flip(*bgrShmemBuffer, *bgrBuffer, +1);
+                    bgrBuffer->copyTo(*bgrShmemBuffer);
+                }
+                else
+                {
+                    cv::flip(*bgrBuffer, *bgrBuffer, +1);
+                }
+                bayerFrame= nullptr;
+            }
+            else
+            {
+                // The debayered frame is only needed for the debug video stream.
+                // Segmentation reads the bayer frame directly (see computeBiggestNContours).
+                if (bWritePreview)
+                {
+                    debayerGRBGToBGR(frameWidth, frameHeight, video_buffer, bgrShmemBuffer->data, true);
+                }
+                bayerFrame= bayerBuffer;
+            }
+
+            return;
+        }
+
         const cv::Mat videoBufferMat(srcBufferHeight, srcBufferWidth, CV_8UC3, const_cast<unsigned char *>(video_buffer));
 
 		if (bIsFlipped)
@@ -302,10 +293,13 @@ public:
 	        videoBufferMat.copyTo(*bgrBuffer);
 		}
 
-        bgrBuffer->copyTo(*bgrShmemBuffer);
+        if (bWritePreview)
+        {
+            bgrBuffer->copyTo(*bgrShmemBuffer);
+        }
     }
 
-    void writeStereoVideoFrameSection(const unsigned char *video_buffer, const cv::Rect &buffer_bounds, bool bIsFlipped)
+    void writeStereoVideoFrameSection(const unsigned char *video_buffer, const cv::Rect &buffer_bounds, bool bIsFlipped, bool bWritePreview)
     {
         const cv::Mat videoBufferMat(srcBufferHeight, srcBufferWidth, CV_8UC3, const_cast<unsigned char *>(video_buffer));
 
@@ -318,23 +312,26 @@ public:
 	        videoBufferMat(buffer_bounds).copyTo(*bgrBuffer);
 		}
 
-        bgrBuffer->copyTo(*bgrShmemBuffer);
-    }
-    
-    void updateHsvBuffer()
-    {
-        // Convert the video buffer to the HSV color space
-        if (bgr2hsv != nullptr)
+        if (bWritePreview)
         {
-            bgr2hsv->cvtColor(bgrROI, hsvROI);
+            bgrBuffer->copyTo(*bgrShmemBuffer);
         }
-        else
+    }
+
+    // The overlay buffer scaled down to the size of the shared memory video frame
+    const unsigned char *getPreviewFrame()
+    {
+        if (previewBuffer == nullptr)
         {
-            cv::cvtColor(bgrROI, hsvROI, cv::COLOR_BGR2HSV);
+            return bgrShmemBuffer->data;
         }
+
+        cv::resize(*bgrShmemBuffer, *previewBuffer, previewBuffer->size(), 0, 0, cv::INTER_AREA);
+
+        return previewBuffer->data;
     }
     
-    void applyROI(cv::Rect2i ROI)
+    cv::Rect2i clampROI(cv::Rect2i ROI) const
     {
         // Make sure the ROI box is always clamped in bounds of the frame buffer
         int x0= std::min(std::max(ROI.tl().x, 0), frameWidth-1);
@@ -360,81 +357,94 @@ public:
             ROI.width = frameWidth;
             ROI.height = frameHeight;
         }
-       
-        //Create the ROI matrices.
-        //It's not a full copy, so this isn't too slow.
-        //adjustROI is probably slightly faster but I ran into trouble with it.
-        bgrROI = cv::Mat(*bgrBuffer, ROI);
-        hsvROI = cv::Mat(*hsvBuffer, ROI);
-        gsLowerROI = cv::Mat(*gsLowerBuffer, ROI);
-        gsUpperROI = cv::Mat(*gsUpperBuffer, ROI);
-        
-        updateHsvBuffer();
-        
-        //Draw ROI.
-        cv::rectangle(*bgrShmemBuffer, ROI, cv::Scalar(255, 0, 0));
+
+        return ROI;
+    }
+
+    // Fill the ROI of the first mask_count mask buffers with the pixels that fall in the matching color thresholds.
+    // Every pixel in the ROI is only read and converted to HSV once, no matter how many masks are computed.
+    void computeHSVMasks(const cv::Rect2i &ROI, const HSVColorThresholds *thresholds, const int mask_count)
+    {
+        assert(mask_count <= HSV_MASK_MAX_COUNT);
+        uint8_t *mask_origins[HSV_MASK_MAX_COUNT];
+
+        for (int mask_index = 0; mask_index < mask_count; ++mask_index)
+        {
+            if (gsMaskBuffers[mask_index] == nullptr)
+            {
+                gsMaskBuffers[mask_index] = new cv::Mat(frameHeight, frameWidth, CV_8UC1);
+            }
+
+            mask_origins[mask_index]= gsMaskBuffers[mask_index]->ptr<uint8_t>(ROI.y) + ROI.x;
+        }
+
+        // All mask buffers have the same dimensions
+        const int mask_stride= frameWidth;
+
+        if (bayerFrame != nullptr)
+        {
+            computeHSVMasksFromBayerGRBG(
+                bayerFrame, frameWidth, frameHeight,
+                ROI.x, ROI.y, ROI.width, ROI.height,
+                thresholds, mask_count,
+                bgrRowScratch,
+                mask_origins, mask_stride);
+        }
+        else
+        {
+            const cv::Mat bgrROI(*bgrBuffer, ROI);
+
+            computeHSVMasksFromBGR(
+                bgrROI.data, static_cast<int>(bgrROI.step),
+                bgrROI.cols, bgrROI.rows,
+                thresholds, mask_count,
+                mask_origins, mask_stride);
+        }
+    }
+
+    // Return blobs in raw image space:
+    // i.e. [0, 0] at lower left  to [frameWidth-1, frameHeight-1] at lower right
+    // The ROI must be contained in the ROI last passed to computeHSVMasks().
+    // min_blob_area is a pixel count (see TrackerBlobExtractor::extractBiggestNBlobs),
+    // not the contour vertex count computeBiggestNContours filters on.
+    int computeBiggestNBlobs(
+        const int mask_index,
+        const cv::Rect2i &ROI,
+        TrackerBlobExtractor &blobExtractor,
+        TrackerBlob *out_biggest_N_blobs,
+        const int max_blob_count,
+        const int min_blob_area = 6) const
+    {
+        const cv::Mat gsMaskROI(*gsMaskBuffers[mask_index], ROI);
+
+        return blobExtractor.extractBiggestNBlobs(
+            gsMaskROI.data, static_cast<int>(gsMaskROI.step),
+            ROI.width, ROI.height,
+            ROI.x, ROI.y,
+            min_blob_area,
+            out_biggest_N_blobs,
+            max_blob_count);
     }
 
     // Return points in raw image space:
     // i.e. [0, 0] at lower left  to [frameWidth-1, frameHeight-1] at lower right
+    // The ROI must be contained in the ROI last passed to computeHSVMasks().
     bool computeBiggestNContours(
-        const PSVR_HSVColorRange &hsvColorRange,
+        const int mask_index,
+        const cv::Rect2i &ROI,
         t_opencv_int_contour_list &out_biggest_N_contours,
         std::vector<double> &out_contour_areas,
         const int max_contour_count,
-        const int min_points_in_contour = 6)
+        const int min_points_in_contour = 6) const
     {
+        // Note: findContours doesn't modify its source image (OpenCV >= 3.2),
+        // so HMDs sharing a mask can safely run this at the same time
+        cv::Mat gsMaskROI(*gsMaskBuffers[mask_index], ROI);
+
         out_biggest_N_contours.clear();
         out_contour_areas.clear();
         
-        // Clamp the HSV image, taking into account wrapping the hue angle
-        {
-            const float hue_min = hsvColorRange.hue_range.center - hsvColorRange.hue_range.range;
-            const float hue_max = hsvColorRange.hue_range.center + hsvColorRange.hue_range.range;
-            const float saturation_min = clampf(hsvColorRange.saturation_range.center - hsvColorRange.saturation_range.range, 0, 255);
-            const float saturation_max = clampf(hsvColorRange.saturation_range.center + hsvColorRange.saturation_range.range, 0, 255);
-            const float value_min = clampf(hsvColorRange.value_range.center - hsvColorRange.value_range.range, 0, 255);
-            const float value_max = clampf(hsvColorRange.value_range.center + hsvColorRange.value_range.range, 0, 255);
-
-            if (hue_min < 0)
-            {
-                cv::inRange(
-                    hsvROI,
-                    cv::Scalar(0, saturation_min, value_min),
-                    cv::Scalar(clampf(hue_max, 0, 180), saturation_max, value_max),
-                    gsLowerROI);
-                cv::inRange(
-                    hsvROI,
-                    cv::Scalar(clampf(180 + hue_min, 0, 180), saturation_min, value_min),
-                    cv::Scalar(180, saturation_max, value_max),
-                    gsUpperROI);
-                cv::bitwise_or(gsLowerROI, gsUpperROI, gsLowerROI);
-            }
-            else if (hue_max > 180)
-            {
-                cv::inRange(
-                    hsvROI,
-                    cv::Scalar(0, saturation_min, value_min),
-                    cv::Scalar(clampf(hue_max - 180, 0, 180), saturation_max, value_max),
-                    gsLowerROI);
-                cv::inRange(
-                    hsvROI,
-                    cv::Scalar(clampf(hue_min, 0, 180), saturation_min, value_min),
-                    cv::Scalar(180, saturation_max, value_max),
-                    gsUpperROI);
-                cv::bitwise_or(gsLowerROI, gsUpperROI, gsLowerROI);
-            }
-            else
-            {
-                cv::inRange(
-                    hsvROI,
-                    cv::Scalar(hue_min, saturation_min, value_min),
-                    cv::Scalar(hue_max, saturation_max, value_max),
-                    gsLowerROI);
-            }
-        }
-        
-        //TODO: Why no blurring of the gsLowerBuffer?
+        //TODO: Why no blurring of the mask?
 
         // Find the largest convex blob in the filtered grayscale buffer
         {
@@ -447,9 +457,9 @@ public:
 
             // Find all counters in the image buffer
             cv::Size size; cv::Point ofs;
-            gsLowerROI.locateROI(size, ofs);
+            gsMaskROI.locateROI(size, ofs);
             t_opencv_int_contour_list contours;
-            cv::findContours(gsLowerROI,
+            cv::findContours(gsMaskROI,
                              contours,
                              CV_RETR_EXTERNAL,
                              CV_CHAIN_APPROX_SIMPLE,  //CV_CHAIN_APPROX_NONE?
@@ -513,6 +523,23 @@ public:
         return (out_biggest_N_contours.size() > 0);
     }
     
+    void
+    draw_roi(const cv::Rect2i &ROI)
+    {
+        cv::rectangle(*bgrShmemBuffer, ROI, cv::Scalar(255, 0, 0));
+    }
+
+    void
+    draw_blob(const TrackerBlob &blob)
+    {
+        // Draws the blob bounds and center directly onto the shared mem buffer.
+        // This is useful for debugging
+        const cv::Rect bounds(blob.min_x, blob.min_y, blob.max_x - blob.min_x + 1, blob.max_y - blob.min_y + 1);
+        cv::rectangle(*bgrShmemBuffer, bounds, cv::Scalar(255, 255, 255));
+        cv::drawMarker(*bgrShmemBuffer, cv::Point2f(blob.center_x, blob.center_y), cv::Scalar(255, 255, 255), 0,
+            std::min(bounds.width, bounds.height));
+    }
+
     void
     draw_contour(const t_opencv_int_contour &contour)
     {
@@ -637,23 +664,144 @@ public:
     }
 
     PSVRVideoFrameSection section;
+    int previewDownscale; // 1, 2 or 4
 
 	int srcBufferWidth;
 	int srcBufferHeight;
     int frameWidth;
     int frameHeight;
 
+    bool bIsBayerSource; // source video frames are raw GRBG bayer frames
+
     cv::Mat *bgrBuffer; // source video frame
-    cv::Mat *bgrShmemBuffer; //Frame onto which we draw debug lines, and transmit via shared mem.
-    cv::Mat bgrROI;
-    cv::Mat *hsvBuffer; // source frame converted to HSV color space
-    cv::Mat hsvROI;
-    cv::Mat *gsLowerBuffer; // HSV image clamped by HSV range into grayscale mask
-    cv::Mat gsLowerROI;
-    cv::Mat *gsUpperBuffer; // HSV image clamped by HSV range into grayscale mask
-    cv::Mat gsUpperROI;
-    cv::Mat *maskedBuffer; // bgr image ANDed together with grayscale mask
-    OpenCVBGRToHSVMapper *bgr2hsv; // Used to convert an rgb image to an hsv image
+    cv::Mat *bgrShmemBuffer; //Frame onto which we draw debug lines, and transmit via shared mem (null when not previewing).
+    cv::Mat *previewBuffer; // downscaled copy of bgrShmemBuffer (only when previewDownscale > 1)
+    cv::Mat *gsMaskBuffers[HSV_MASK_MAX_COUNT]; // HSV image clamped by each HSV range into grayscale masks
+    uint8_t *bayerBuffer; // copy of the raw bayer source frame (bayer sources only)
+    const unsigned char *bayerFrame; // unflipped bayer source frame, or null when segmenting from bgrBuffer
+    uint8_t *bgrRowScratch; // one debayered row of the ROI
+};
+
+// Per-HMD segmentation work for one tracker frame.
+// Tasks run in parallel on the segmentation task pool, so each one owns its scratch state.
+struct TrackerSegmentationTask
+{
+    int hmd_id;
+    const ServerHMDView *hmd_view;
+    PSVRTrackingShape tracking_shape;
+    int mask_index; // HMDs with matching color thresholds share a mask
+    cv::Rect2i roi[MAX_PROJECTION_COUNT];
+    TrackerBlobExtractor blob_extractor;
+
+    // Debug drawing is deferred until every task has finished with the frame
+    t_opencv_int_contour convex_contour[MAX_PROJECTION_COUNT];
+    TrackerBlob blobs[MAX_PROJECTION_COUNT][MAX_POINT_CLOUD_POINT_COUNT];
+    int blob_count[MAX_PROJECTION_COUNT];
+
+    // Scratch state reused from frame to frame.
+    // The arena is reset at the start of each frame.
+    FrameArena frame_arena;
+    t_opencv_int_contour_list biggest_contours;
+    std::vector<double> contour_areas;
+
+    TrackerSegmentationTask()
+        : frame_arena(k_segmentation_arena_size)
+    {
+    }
+};
+
+// A video frame moving through the tracker frame pipeline along with everything computed from it
+struct TrackerPipelineFrame
+{
+    OpenCVBufferState *buffer_state[MAX_PROJECTION_COUNT];
+    t_service_timepoint capture_timestamp;
+    uint64_t sequence_number;
+    bool bDropped; // skipped by a stage because a newer frame was waiting
+    bool bWantsPreview; // overlays get drawn and the frame published to the video stream
+
+    // Segmentation stage results, indexed by HMD id
+    bool bHasProjection[HMDManager::k_max_devices];
+    PSVRTrackingProjection projections[HMDManager::k_max_devices];
+    TrackerSegmentationTask segmentation_tasks[HMDManager::k_max_devices];
+    int segmentation_task_count;
+
+    TrackerPipelineFrame(ITrackerInterface *device, int preview_downscale)
+        : sequence_number(0)
+        , bDropped(false)
+        , bWantsPreview(false)
+        , segmentation_task_count(0)
+    {
+        for (int i = 0; i < MAX_PROJECTION_COUNT; ++i)
+        {
+            buffer_state[i]= nullptr;
+        }
+
+        if (device->getIsStereoCamera())
+        {
+            buffer_state[PSVRVideoFrameSection_Left]= new OpenCVBufferState(device, PSVRVideoFrameSection_Left, preview_downscale);
+            buffer_state[PSVRVideoFrameSection_Right]= new OpenCVBufferState(device, PSVRVideoFrameSection_Right, preview_downscale);
+        }
+        else
+        {
+            buffer_state[PSVRVideoFrameSection_Primary]= new OpenCVBufferState(device, PSVRVideoFrameSection_Primary, preview_downscale);
+        }
+
+        reset();
+    }
+
+    ~TrackerPipelineFrame()
+    {
+        for (int i = 0; i < MAX_PROJECTION_COUNT; ++i)
+        {
+            if (buffer_state[i] != nullptr)
+            {
+                delete buffer_state[i];
+            }
+        }
+    }
+
+    void reset()
+    {
+        bDropped= false;
+        bWantsPreview= false;
+        segmentation_task_count= 0;
+
+        for (int hmd_id = 0; hmd_id < HMDManager::k_max_devices; ++hmd_id)
+        {
+            bHasProjection[hmd_id]= false;
+        }
+    }
+};
+
+// Worker thread that runs one stage of a tracker's frame pipeline
+class TrackerPipelineStageThread : public WorkerThread
+{
+public:
+    TrackerPipelineStageThread(
+        const std::string &thread_name,
+        ServerTrackerView *tracker_view,
+        eTrackerPipelineStage stage)
+        : WorkerThread(thread_name)
+        , m_trackerView(tracker_view)
+        , m_stage(stage)
+    {
+    }
+
+protected:
+    // Called in a loop by the parent WorkerThread class
+    virtual bool doWork() override
+    {
+        if (!m_trackerView->runPipelineStage(m_stage))
+        {
+            // Wait for the previous stage to post a frame
+            waitForWork(k_pipeline_stage_wait_timeout);
+        }
+
+        return true;
+    }
+
+    ServerTrackerView *m_trackerView;
+    eTrackerPipelineStage m_stage;
 };
 
 // -- Utility Methods -----
@@ -683,29 +831,34 @@ ServerTrackerView::ServerTrackerView(const int device_id)
 	, m_shared_memory_video_stream_count({0})
 	, m_lastVideoFrameIndexPolled(-1)
     , m_device(nullptr)
+	, m_pendingSegmentationFrame(nullptr)
+	, m_reclaimedCaptureFrame(nullptr)
+	, m_solveStageFrame(nullptr)
+	, m_pipelineFrameSequence(0)
+	, m_nextPreviewTimestamp()
 {
     Utility::format_string(m_shared_memory_name, sizeof(m_shared_memory_name), "tracker_view_%d", device_id);
-    for (int i = 0; i < MAX_PROJECTION_COUNT; ++i)
+    for (int stage = 0; stage < TrackerPipelineStage_COUNT; ++stage)
     {
-        m_opencv_buffer_state[i]= nullptr;
+        m_pipelineQueues[stage]= nullptr;
+        m_pipelineThreads[stage]= nullptr;
+        m_pipelineProcessedFrameCount[stage]= 0;
+        m_pipelineDroppedFrameCount[stage]= 0;
+        m_pipelineHeapAllocationCount[stage]= 0;
+        m_pipelineHeapAllocatingFrameCount[stage]= 0;
     }
 }
 
 ServerTrackerView::~ServerTrackerView()
 {
+    stop_pipeline_threads();
+    free_pipeline();
+
     if (m_shared_memory_accesor != nullptr)
     {
         delete m_shared_memory_accesor;
     }
 
-    for (int i = 0; i < MAX_PROJECTION_COUNT; ++i)
-    {
-        if (m_opencv_buffer_state[i] != nullptr)
-        {
-            delete m_opencv_buffer_state[i];
-        }
-    }
-
     if (m_device != nullptr)
     {
         delete m_device;
@@ -754,6 +907,9 @@ bool ServerTrackerView::open(const class DeviceEnumerator *enumerator)
 
     if (bSuccess)
     {
+        // The device is already streaming, so keep the capture stage out until the pipeline exists
+        std::lock_guard<std::mutex> rebuild_lock(m_pipelineRebuildMutex);
+
         // Allocate the shared 
         reallocate_shared_memory();
 
@@ -766,6 +922,9 @@ bool ServerTrackerView::open(const class DeviceEnumerator *enumerator)
 
 void ServerTrackerView::close()
 {
+    // Make sure no stage is still working on a frame before the device goes away
+    stop_pipeline_threads();
+
     ServerDeviceView::close();
 
     if (m_shared_memory_accesor != nullptr)
@@ -774,14 +933,7 @@ void ServerTrackerView::close()
         m_shared_memory_accesor = nullptr;
     }
 
-    for (int i = 0; i < MAX_PROJECTION_COUNT; ++i)
-    {
-        if (m_opencv_buffer_state[i] != nullptr)
-        {
-            delete m_opencv_buffer_state[i];
-            m_opencv_buffer_state[i]= nullptr;
-        }
-    }
+    free_pipeline();
 }
 
 void ServerTrackerView::startSharedMemoryVideoStream()
@@ -795,17 +947,79 @@ void ServerTrackerView::stopSharedMemoryVideoStream()
     --m_shared_memory_video_stream_count;
 }
 
-void ServerTrackerView::notifyVideoFrameReceived(const unsigned char *raw_video_frame_buffer)
+void ServerTrackerView::notifyVideoPropertyApplied(
+	PSVRVideoPropertyType property_type,
+	int value,
+	bool bSuccess)
+{
+	PSVRVideoPropertyAppliedEvent applied_property;
+	applied_property.tracker_id= getDeviceID();
+	applied_property.property_type= property_type;
+	applied_property.value= value;
+	applied_property.bSuccess= bSuccess;
+
+	m_appliedVideoProperties.push_back(applied_property);
+}
+
+void ServerTrackerView::notifyVideoFrameReceived(
+	const unsigned char *raw_video_frame_buffer,
+	const t_service_timepoint &capture_timestamp)
 {
+	// The main thread is switching modes or rebuilding the pipeline, so the frame has nowhere to go
+	std::unique_lock<std::mutex> rebuild_lock(m_pipelineRebuildMutex, std::try_to_lock);
+	if (!rebuild_lock.owns_lock())
+	{
+		++m_pipelineDroppedFrameCount[TrackerPipelineStage_Capture];
+		return;
+	}
+
+	if (m_device == nullptr || m_pipelineQueues[TrackerPipelineStage_Capture] == nullptr)
+	{
+		return;
+	}
+
+	// Record the frame as the device delivered it
+	SessionRecorder *recorder= DeviceManager::getInstance()->getSessionRecorder();
+	if (recorder->getIsRecording())
+	{
+		recorder->recordTrackerFrame(getDeviceID(), raw_video_frame_buffer, capture_timestamp);
+	}
+
 	const bool is_frame_flipped= m_device->getIsFrameMirrored();
 	const bool is_buffer_flipped= m_device->getIsBufferMirrored();
 
-	if (m_device == nullptr)
+	// Reuse the frame segmentation skipped last time, or grab a free pipeline frame.
+	// If every frame is being worked on by a later stage, drop this video frame.
+	TrackerPipelineFrame *frame= m_reclaimedCaptureFrame;
+	m_reclaimedCaptureFrame= nullptr;
+	if (frame == nullptr && !m_pipelineQueues[TrackerPipelineStage_Capture]->try_dequeue(frame))
 	{
+		++m_pipelineDroppedFrameCount[TrackerPipelineStage_Capture];
 		return;
 	}
 
-	// Fetch the latest video buffer frame from the device
+	frame->reset();
+	frame->capture_timestamp= capture_timestamp;
+	frame->sequence_number= m_pipelineFrameSequence++;
+	frame->bWantsPreview= shouldPreviewFrame(capture_timestamp);
+
+	// Nothing preview related is kept around while nobody is watching
+	for (int section = 0; section < MAX_PROJECTION_COUNT; ++section)
+	{
+		OpenCVBufferState *buffer_state= frame->buffer_state[section];
+
+		if (buffer_state != nullptr)
+		{
+			if (frame->bWantsPreview)
+				buffer_state->allocatePreviewBuffers();
+			else if (m_shared_memory_video_stream_count == 0)
+				buffer_state->releasePreviewBuffers();
+		}
+	}
+
+	const std::chrono::high_resolution_clock::time_point copy_start_time= std::chrono::high_resolution_clock::now();
+
+	// Copy the latest video buffer frame from the device into the pipeline frame
     if (m_device->getIsStereoCamera())
     {
 		const TrackerModeConfig *mode_config= m_device->getTrackerMode();
@@ -830,72 +1044,412 @@ void ServerTrackerView::notifyVideoFrameReceived(const unsigned char *raw_video_
 		}
 
         // Cache the left raw video frame
-        if (m_opencv_buffer_state[PSVRVideoFrameSection_Left] != nullptr)
-        {
-            m_opencv_buffer_state[PSVRVideoFrameSection_Left]->writeStereoVideoFrameSection(
-				raw_video_frame_buffer, 
-				is_buffer_flipped ? right_bounds : left_bounds, 
-				is_frame_flipped);
-        }
+        frame->buffer_state[PSVRVideoFrameSection_Left]->writeStereoVideoFrameSection(
+			raw_video_frame_buffer, 
+			is_buffer_flipped ? right_bounds : left_bounds, 
+			is_frame_flipped,
+			frame->bWantsPreview);
 
         // Cache the right raw video frame
-        if (m_opencv_buffer_state[PSVRVideoFrameSection_Right] != nullptr)
-        {
-            m_opencv_buffer_state[PSVRVideoFrameSection_Right]->writeStereoVideoFrameSection(
-				raw_video_frame_buffer,
-				is_buffer_flipped ? left_bounds : right_bounds, 
-				is_frame_flipped);
-        }
+        frame->buffer_state[PSVRVideoFrameSection_Right]->writeStereoVideoFrameSection(
+			raw_video_frame_buffer,
+			is_buffer_flipped ? left_bounds : right_bounds, 
+			is_frame_flipped,
+			frame->bWantsPreview);
     }
     else
     {
         // Cache the raw video frame
-        if (m_opencv_buffer_state[PSVRVideoFrameSection_Primary] != nullptr)
-        {
-            m_opencv_buffer_state[PSVRVideoFrameSection_Primary]->writeVideoFrame(
-				raw_video_frame_buffer, is_frame_flipped);
-        }
+        frame->buffer_state[PSVRVideoFrameSection_Primary]->writeVideoFrame(
+			raw_video_frame_buffer, is_frame_flipped, frame->bWantsPreview);
     }
 
-	// Broadcast new tracking frame to all devices that are optically tracked
+	m_pipelineStageLatency[TrackerPipelineStage_Capture].recordDuration(
+		std::chrono::high_resolution_clock::now() - copy_start_time);
+
+	// Hand the frame off to the segmentation stage.
+	// A frame still waiting there is older than this one, so take it back for the next capture.
+	++m_pipelineProcessedFrameCount[TrackerPipelineStage_Capture];
+	m_reclaimedCaptureFrame= m_pendingSegmentationFrame.exchange(frame);
+	if (m_reclaimedCaptureFrame != nullptr)
 	{
-		DeviceManager *device_manager= DeviceManager::getInstance();
-		HMDManager *hmd_manager= device_manager->getHMDManager();
+		++m_pipelineDroppedFrameCount[TrackerPipelineStage_Segmentation];
+	}
+	wakePipelineStage(TrackerPipelineStage_Segmentation);
+}
 
-		hmd_manager->notifyVideoFrameReceived(this);
+bool ServerTrackerView::shouldPreviewFrame(const t_service_timepoint &capture_timestamp)
+{
+	if (m_shared_memory_accesor == nullptr || m_shared_memory_video_stream_count == 0)
+	{
+		return false;
 	}
 
-	// Copy the final opencv RGB buffer (annotated with debug info by he HMD) to the client API
-	if (m_shared_memory_accesor != nullptr && m_shared_memory_video_stream_count > 0)
+	const TrackerManagerConfig &trackerMgrConfig= DeviceManager::getInstance()->m_tracker_manager->getConfig();
+	if (trackerMgrConfig.preview_max_fps <= 0.f)
 	{
-		if (m_device->getIsStereoCamera())
+		return true;
+	}
+
+	const t_service_duration preview_interval=
+		std::chrono::duration_cast<t_service_duration>(
+			std::chrono::duration<float>(1.f / trackerMgrConfig.preview_max_fps));
+
+	// Allow some capture jitter so that e.g. a 30fps cap on a 60fps camera previews every other frame
+	if (capture_timestamp + preview_interval / 4 < m_nextPreviewTimestamp)
+	{
+		return false;
+	}
+
+	// Schedule off of the ideal time so the preview rate doesn't drift,
+	// unless the stream just started or fell way behind
+	m_nextPreviewTimestamp+= preview_interval;
+	if (m_nextPreviewTimestamp < capture_timestamp)
+	{
+		m_nextPreviewTimestamp= capture_timestamp + preview_interval;
+	}
+
+	return true;
+}
+
+bool ServerTrackerView::runPipelineStage(eTrackerPipelineStage stage)
+{
+	t_tracker_pipeline_frame_queue *input_queue= m_pipelineQueues[stage];
+	t_tracker_pipeline_frame_queue *output_queue= 
+		m_pipelineQueues[(stage + 1) % TrackerPipelineStage_COUNT];
+
+	// Only the newest waiting frame is worth processing.
+	// Older frames (and frames an earlier stage dropped) are passed along untouched
+	// so that they make their way back to the capture stage.
+	// Segmentation only ever has one waiting frame, capture keeps the older ones.
+	TrackerPipelineFrame *frame= nullptr;
+	bool bAnyFrameWaiting= false;
+	if (stage == TrackerPipelineStage_Segmentation)
+	{
+		frame= m_pendingSegmentationFrame.exchange(nullptr);
+		bAnyFrameWaiting= frame != nullptr;
+	}
+	else
+	{
+		TrackerPipelineFrame *waiting_frame= nullptr;
+		while (input_queue->try_dequeue(waiting_frame))
 		{
-			if (m_opencv_buffer_state[PSVRVideoFrameSection_Left] != nullptr &&
-				m_opencv_buffer_state[PSVRVideoFrameSection_Right] != nullptr)
+			bAnyFrameWaiting= true;
+
+			if (waiting_frame->bDropped)
+			{
+				output_queue->try_enqueue(waiting_frame);
+				continue;
+			}
+
+			if (frame != nullptr)
 			{
-				// Copy the video frame to shared memory (if requested)
-				m_shared_memory_accesor->writeVideoFrame(
-					PSVRVideoFrameSection_Left, 
-					m_opencv_buffer_state[PSVRVideoFrameSection_Left]->bgrShmemBuffer->data);
-				m_shared_memory_accesor->writeVideoFrame(
-					PSVRVideoFrameSection_Right, 
-					m_opencv_buffer_state[PSVRVideoFrameSection_Right]->bgrShmemBuffer->data);
-				m_shared_memory_accesor->finalizeVideoFrameWrite();
+				frame->bDropped= true;
+				++m_pipelineDroppedFrameCount[stage];
+				output_queue->try_enqueue(frame);
 			}
+
+			frame= waiting_frame;
 		}
-		else
+	}
+
+	if (frame == nullptr)
+	{
+		if (bAnyFrameWaiting)
+		{
+			wakePipelineStage(static_cast<eTrackerPipelineStage>((stage + 1) % TrackerPipelineStage_COUNT));
+		}
+
+		return bAnyFrameWaiting;
+	}
+
+	// Only counts the stage thread itself (see HeapAllocationCounter.h)
+	HeapAllocationScope heap_allocation_scope;
+
+	{
+		LatencyScope latency_scope(m_pipelineStageLatency[stage]);
+
+		switch (stage)
+		{
+		case TrackerPipelineStage_Segmentation:
+			segmentFrame(frame);
+			break;
+		case TrackerPipelineStage_Solve:
+			solveFrame(frame);
+			break;
+		case TrackerPipelineStage_Publish:
+			publishFrame(frame);
+			break;
+		default:
+			assert(0 && "unreachable");
+			break;
+		}
+	}
+
+	m_pipelineHeapAllocationCount[stage]= heap_allocation_scope.getAllocationCount();
+	if (m_pipelineHeapAllocationCount[stage] > 0)
+	{
+		++m_pipelineHeapAllocatingFrameCount[stage];
+	}
+	++m_pipelineProcessedFrameCount[stage];
+	output_queue->try_enqueue(frame);
+	wakePipelineStage(static_cast<eTrackerPipelineStage>((stage + 1) % TrackerPipelineStage_COUNT));
+
+	return true;
+}
+
+void ServerTrackerView::wakePipelineStage(eTrackerPipelineStage stage)
+{
+	// The capture stage has no thread, it runs whenever the device delivers a frame
+	TrackerPipelineStageThread *stage_thread= m_pipelineThreads[stage];
+
+	if (stage_thread != nullptr)
+	{
+		stage_thread->signalWork();
+	}
+}
+
+void ServerTrackerView::segmentFrame(TrackerPipelineFrame *frame)
+{
+	PSVR_TRACE_ZONE("Tracker Segmentation");
+
+	DeviceManager *device_manager= DeviceManager::getInstance();
+	HMDManager *hmd_manager= device_manager->getHMDManager();
+	TrackerManager *tracker_manager= device_manager->getTrackerManager();
+	const TrackerManagerConfig &trackerMgrConfig= tracker_manager->getConfig();
+
+	PSVRVideoFrameSection sections[MAX_PROJECTION_COUNT];
+	int section_count= 0;
+	if (m_device->getIsStereoCamera())
+	{
+		sections[section_count++]= PSVRVideoFrameSection_Left;
+		sections[section_count++]= PSVRVideoFrameSection_Right;
+	}
+	else
+	{
+		sections[section_count++]= PSVRVideoFrameSection_Primary;
+	}
+
+	// Gather every optically tracked HMD along with its color mask and region of interest
+	HSVColorThresholds mask_thresholds[HSV_MASK_MAX_COUNT];
+	int mask_count= 0;
+	cv::Rect2i mask_roi[MAX_PROJECTION_COUNT];
+	frame->segmentation_task_count= 0;
+	for (int hmd_id = 0; hmd_id < HMDManager::k_max_devices; ++hmd_id)
+	{
+		ServerHMDViewPtr hmd_view= hmd_manager->getHMDViewPtr(hmd_id);
+		TrackerSegmentationTask &task= frame->segmentation_tasks[frame->segmentation_task_count];
+
+		if (!hmd_view->getIsOpen() || 
+			!hmd_view->getIsTrackingEnabled() ||
+			hmd_view->getTrackingColorID() == PSVRTrackingColorType_INVALID ||
+			!hmd_view->getTrackingShape(task.tracking_shape))
+		{
+			continue;
+		}
+
+		task.hmd_id= hmd_id;
+		task.hmd_view= hmd_view.get();
+
+		// HMDs tracked with the same color thresholds share a mask
+		PSVR_HSVColorRange hsvColorRange;
+		getHMDTrackingColorPreset(hmd_view.get(), hmd_view->getTrackingColorID(), &hsvColorRange);
+		const HSVColorThresholds thresholds= HSVColorThresholds::fromColorRange(hsvColorRange);
+
+		task.mask_index= 0;
+		while (task.mask_index < mask_count && 
+			   memcmp(&mask_thresholds[task.mask_index], &thresholds, sizeof(HSVColorThresholds)) != 0)
+		{
+			++task.mask_index;
+		}
+
+		if (task.mask_index == mask_count)
+		{
+			assert(mask_count < HSV_MASK_MAX_COUNT);
+			mask_thresholds[mask_count++]= thresholds;
+		}
+
+		// Compute a region of interest in the tracker buffer around where we expect to find the tracking shape.
+		// The prior projection comes from the solve stage, which may be a frame or two behind.
+		const bool bRoiDisabled = hmd_view->getIsROIDisabled() || trackerMgrConfig.disable_roi;
+		PSVRTrackingProjection priorProjection;
+		const bool bIsTracking = hmd_view->getLatestTrackerProjection(this->getDeviceID(), priorProjection);
+
+		for (int section_index = 0; section_index < section_count; ++section_index)
+		{
+			const PSVRVideoFrameSection section= sections[section_index];
+			const cv::Rect2i ROI = computeTrackerROIForPoseProjection(
+				bRoiDisabled,
+				this,
+				section,
+				bIsTracking ? &priorProjection : nullptr);
+
+			task.roi[section]= frame->buffer_state[section]->clampROI(ROI);
+			mask_roi[section]= 
+				(frame->segmentation_task_count > 0) 
+				? (mask_roi[section] | task.roi[section]) 
+				: task.roi[section];
+		}
+
+		++frame->segmentation_task_count;
+	}
+
+	if (frame->segmentation_task_count == 0)
+	{
+		return;
+	}
+
+	// Compute the masks for every color in use in a single pass over the combined ROI
+	for (int section_index = 0; section_index < section_count; ++section_index)
+	{
+		const PSVRVideoFrameSection section= sections[section_index];
+
+		frame->buffer_state[section]->computeHSVMasks(mask_roi[section], mask_thresholds, mask_count);
+	}
+
+	// Fan the per-HMD blob extraction and shape fitting out onto the shared task pool.
+	// Each task only reads the frame and writes its own projection.
+	auto segment_hmd= [this, frame](int task_index) {
+		TrackerSegmentationTask &task= frame->segmentation_tasks[task_index];
+
+		frame->bHasProjection[task.hmd_id]= 
+			computeProjectionForHMD(frame, &task, &frame->projections[task.hmd_id]);
+	};
+
+	TaskPool *task_pool= tracker_manager->getSegmentationTaskPool();
+	if (task_pool != nullptr)
+	{
+		task_pool->parallelFor(frame->segmentation_task_count, segment_hmd);
+	}
+	else
+	{
+		for (int task_index = 0; task_index < frame->segmentation_task_count; ++task_index)
+		{
+			segment_hmd(task_index);
+		}
+	}
+
+	// Draw the debug overlays now that all the tasks have joined
+	const int overlay_task_count= frame->bWantsPreview ? frame->segmentation_task_count : 0;
+	for (int task_index = 0; task_index < overlay_task_count; ++task_index)
+	{
+		const TrackerSegmentationTask &task= frame->segmentation_tasks[task_index];
+
+		for (int section_index = 0; section_index < section_count; ++section_index)
 		{
-			if (m_opencv_buffer_state[PSVRVideoFrameSection_Primary] != nullptr)
+			const PSVRVideoFrameSection section= sections[section_index];
+			OpenCVBufferState *buffer_state= frame->buffer_state[section];
+
+			buffer_state->draw_roi(task.roi[section]);
+
+			if (!task.convex_contour[section].empty())
+			{
+				buffer_state->draw_contour(task.convex_contour[section]);
+			}
+
+			for (int blob_index = 0; blob_index < task.blob_count[section]; ++blob_index)
 			{
-				m_shared_memory_accesor->writeVideoFrame(
-					PSVRVideoFrameSection_Primary,
-					m_opencv_buffer_state[PSVRVideoFrameSection_Primary]->bgrShmemBuffer->data);
-				m_shared_memory_accesor->finalizeVideoFrameWrite();
+				buffer_state->draw_blob(task.blobs[section][blob_index]);
 			}
 		}
 	}
 }
 
+void ServerTrackerView::solveFrame(TrackerPipelineFrame *frame)
+{
+	PSVR_TRACE_ZONE("Tracker Solve");
+
+	HMDManager *hmd_manager= DeviceManager::getInstance()->getHMDManager();
+
+	// Debug drawing done by the HMDs goes into this frame
+	m_solveStageFrame= frame;
+
+	// Broadcast the projections to all devices that are optically tracked
+	for (int hmd_id = 0; hmd_id < HMDManager::k_max_devices; ++hmd_id)
+	{
+		ServerHMDViewPtr hmd_view= hmd_manager->getHMDViewPtr(hmd_id);
+
+		if (hmd_view->getIsOpen())
+		{
+			hmd_view->notifyTrackerDataReceived(
+				this, 
+				frame->capture_timestamp, 
+				frame->bHasProjection[hmd_id] ? &frame->projections[hmd_id] : nullptr);
+		}
+	}
+
+	m_solveStageFrame= nullptr;
+}
+
+void ServerTrackerView::publishFrame(TrackerPipelineFrame *frame)
+{
+	PSVR_TRACE_ZONE("Tracker Publish");
+
+	// Copy the final opencv RGB buffer (annotated with debug info by he HMD) to the client API
+	if (frame->bWantsPreview && m_shared_memory_accesor != nullptr)
+	{
+		const std::chrono::nanoseconds capture_time=
+			std::chrono::duration_cast<std::chrono::nanoseconds>(frame->capture_timestamp.time_since_epoch());
+
+		if (m_device->getIsStereoCamera())
+		{
+			// Copy the video frame to shared memory (if requested)
+			m_shared_memory_accesor->writeVideoFrame(
+				PSVRVideoFrameSection_Left, 
+				frame->buffer_state[PSVRVideoFrameSection_Left]->getPreviewFrame());
+			m_shared_memory_accesor->writeVideoFrame(
+				PSVRVideoFrameSection_Right, 
+				frame->buffer_state[PSVRVideoFrameSection_Right]->getPreviewFrame());
+			m_shared_memory_accesor->finalizeVideoFrameWrite(capture_time);
+		}
+		else
+		{
+			m_shared_memory_accesor->writeVideoFrame(
+				PSVRVideoFrameSection_Primary,
+				frame->buffer_state[PSVRVideoFrameSection_Primary]->getPreviewFrame());
+			m_shared_memory_accesor->finalizeVideoFrameWrite(capture_time);
+		}
+	}
+}
+
+void ServerTrackerView::getPipelineStatistics(TrackerPipelineStatistics &out_stats) const
+{
+	for (int stage = 0; stage < TrackerPipelineStage_COUNT; ++stage)
+	{
+		out_stats.processed_frame_count[stage]= m_pipelineProcessedFrameCount[stage].load();
+		out_stats.dropped_frame_count[stage]= m_pipelineDroppedFrameCount[stage].load();
+		out_stats.last_frame_heap_allocation_count[stage]= m_pipelineHeapAllocationCount[stage].load();
+		out_stats.heap_allocating_frame_count[stage]= m_pipelineHeapAllocatingFrameCount[stage].load();
+	}
+}
+
+void ServerTrackerView::getStatistics(PSVRTrackerStatistics &out_statistics) const
+{
+	// The capture stage's work is copying (and debayering) the driver's frame
+	static const PSVRTrackerStage k_pipeline_stage_latency_stages[TrackerPipelineStage_COUNT]= {
+		PSVRTrackerStage_Debayer,
+		PSVRTrackerStage_Segmentation,
+		PSVRTrackerStage_Solve,
+		PSVRTrackerStage_Publish
+	};
+
+	memset(&out_statistics, 0, sizeof(PSVRTrackerStatistics));
+
+	// USB transfer timings and frames dropped in the driver
+	m_device->getDeviceStatistics(out_statistics);
+
+	for (int stage = 0; stage < TrackerPipelineStage_COUNT; ++stage)
+	{
+		LatencyHistogramSnapshot snapshot;
+		snapshot.add(m_pipelineStageLatency[stage]);
+		snapshot.getStatistics(out_statistics.stage_latency[k_pipeline_stage_latency_stages[stage]]);
+
+		out_statistics.pipeline_dropped_frame_count+= m_pipelineDroppedFrameCount[stage].load();
+	}
+
+	out_statistics.processed_frame_count= m_pipelineProcessedFrameCount[TrackerPipelineStage_Publish].load();
+}
+
 void ServerTrackerView::pollUpdatedVideoFrame()
 {
 	if (m_shared_memory_accesor != nullptr && m_shared_memory_video_stream_count > 0)
@@ -912,6 +1466,25 @@ void ServerTrackerView::pollUpdatedVideoFrame()
 	}
 }
 
+void ServerTrackerView::publish()
+{
+	ServerDeviceView::publish();
+
+	// Published from here rather than straight from the device callback,
+	// so that changes applied synchronously within a client request still go out during the service update
+	for (const PSVRVideoPropertyAppliedEvent &applied_property : m_appliedVideoProperties)
+	{
+		PSVREventMessage message;
+		memset(&message, 0, sizeof(PSVREventMessage));
+		message.event_type= PSVREvent_trackerVideoPropertyApplied;
+		message.event_payload.video_property_applied= applied_property;
+
+		PSVRService::getInstance()->getRequestHandler()->publish_notification(message);
+	}
+
+	m_appliedVideoProperties.clear();
+}
+
 void ServerTrackerView::reallocate_shared_memory()
 {
     int width, height, stride;
@@ -928,6 +1501,15 @@ void ServerTrackerView::reallocate_shared_memory()
     {
         int section_count= m_device->getIsStereoCamera() ? 2 : 1;
 
+        // The video stream carries the (possibly downscaled) preview rather than the full frame
+        const TrackerManagerConfig &trackerMgrConfig= DeviceManager::getInstance()->m_tracker_manager->getConfig();
+        if (trackerMgrConfig.preview_downscale > 1)
+        {
+            width/= trackerMgrConfig.preview_downscale;
+            height/= trackerMgrConfig.preview_downscale;
+            stride= width*3;
+        }
+
         assert(m_shared_memory_accesor == nullptr);
         m_shared_memory_accesor = new SharedVideoFrameBuffer();
 
@@ -943,28 +1525,95 @@ void ServerTrackerView::reallocate_shared_memory()
 
 void ServerTrackerView::reallocate_opencv_buffer_state()
 {
-    // Delete any existing opencv buffers
-    for (int i = 0; i < MAX_PROJECTION_COUNT; ++i)
+    // The frame buffers can't change size while the pipeline is running
+    stop_pipeline_threads();
+    free_pipeline();
+
+    const TrackerManagerConfig &trackerMgrConfig= DeviceManager::getInstance()->m_tracker_manager->getConfig();
+    const int frame_count= trackerMgrConfig.pipeline_frame_count;
+
+    // Every frame can be waiting in any one queue, so enqueues never need to allocate
+    for (int stage = 0; stage < TrackerPipelineStage_COUNT; ++stage)
     {
-        if (m_opencv_buffer_state[i] != nullptr)
+        if (stage != TrackerPipelineStage_Segmentation)
         {
-            delete m_opencv_buffer_state[i];
-            m_opencv_buffer_state[i]= nullptr;
+            m_pipelineQueues[stage]= new t_tracker_pipeline_frame_queue(frame_count);
         }
     }
 
-    // Allocate the OpenCV scratch buffers used for finding tracking blobs
-    if (m_device->getIsStereoCamera())
+    // Allocate the OpenCV scratch buffers used for finding tracking blobs.
+    // All frames start out free, i.e. waiting in the capture queue.
+    for (int frame_index = 0; frame_index < frame_count; ++frame_index)
     {
-        m_opencv_buffer_state[PSVRVideoFrameSection_Left] = 
-            new OpenCVBufferState(m_device, PSVRVideoFrameSection_Left);
-        m_opencv_buffer_state[PSVRVideoFrameSection_Right] = 
-            new OpenCVBufferState(m_device, PSVRVideoFrameSection_Right);
+        TrackerPipelineFrame *frame= new TrackerPipelineFrame(m_device, trackerMgrConfig.preview_downscale);
+
+        m_pipelineFrames.push_back(frame);
+        m_pipelineQueues[TrackerPipelineStage_Capture]->try_enqueue(frame);
     }
-    else
+
+    start_pipeline_threads();
+}
+
+void ServerTrackerView::start_pipeline_threads()
+{
+    const TrackerManagerConfig &trackerMgrConfig= DeviceManager::getInstance()->m_tracker_manager->getConfig();
+    char thread_name[32];
+
+    Utility::format_string(thread_name, sizeof(thread_name), "TrackerSegmentation%d", getDeviceID());
+    m_pipelineThreads[TrackerPipelineStage_Segmentation]= 
+        new TrackerPipelineStageThread(thread_name, this, TrackerPipelineStage_Segmentation);
+    m_pipelineThreads[TrackerPipelineStage_Segmentation]->setThreadAffinity(trackerMgrConfig.segmentation_thread_cpu);
+
+    Utility::format_string(thread_name, sizeof(thread_name), "TrackerSolve%d", getDeviceID());
+    m_pipelineThreads[TrackerPipelineStage_Solve]= 
+        new TrackerPipelineStageThread(thread_name, this, TrackerPipelineStage_Solve);
+    m_pipelineThreads[TrackerPipelineStage_Solve]->setThreadAffinity(trackerMgrConfig.solve_thread_cpu);
+
+    Utility::format_string(thread_name, sizeof(thread_name), "TrackerPublish%d", getDeviceID());
+    m_pipelineThreads[TrackerPipelineStage_Publish]= 
+        new TrackerPipelineStageThread(thread_name, this, TrackerPipelineStage_Publish);
+    m_pipelineThreads[TrackerPipelineStage_Publish]->setThreadAffinity(trackerMgrConfig.publish_thread_cpu);
+
+    for (int stage = 0; stage < TrackerPipelineStage_COUNT; ++stage)
+    {
+        if (m_pipelineThreads[stage] != nullptr)
+        {
+            m_pipelineThreads[stage]->setSpinWaitCount(trackerMgrConfig.pipeline_spin_wait_count);
+            m_pipelineThreads[stage]->startThread();
+        }
+    }
+}
+
+void ServerTrackerView::stop_pipeline_threads()
+{
+    for (int stage = 0; stage < TrackerPipelineStage_COUNT; ++stage)
     {
-        m_opencv_buffer_state[PSVRVideoFrameSection_Primary] =
-            new OpenCVBufferState(m_device, PSVRVideoFrameSection_Primary);
+        if (m_pipelineThreads[stage] != nullptr)
+        {
+            m_pipelineThreads[stage]->stopThread();
+            delete m_pipelineThreads[stage];
+            m_pipelineThreads[stage]= nullptr;
+        }
+    }
+}
+
+void ServerTrackerView::free_pipeline()
+{
+    for (TrackerPipelineFrame *frame : m_pipelineFrames)
+    {
+        delete frame;
+    }
+    m_pipelineFrames.clear();
+    m_pendingSegmentationFrame= nullptr;
+    m_reclaimedCaptureFrame= nullptr;
+
+    for (int stage = 0; stage < TrackerPipelineStage_COUNT; ++stage)
+    {
+        if (m_pipelineQueues[stage] != nullptr)
+        {
+            delete m_pipelineQueues[stage];
+            m_pipelineQueues[stage]= nullptr;
+        }
     }
 }
 
@@ -982,24 +1631,37 @@ bool ServerTrackerView::allocate_device_interface(const class DeviceEnumerator *
 
 ITrackerInterface *ServerTrackerView::allocate_tracker_interface(const class DeviceEnumerator *enumerator)
 {
+    const TrackerDeviceEnumerator *tracker_enumerator= static_cast<const TrackerDeviceEnumerator *>(enumerator);
     ITrackerInterface *tracker_interface= nullptr;
 
-    switch (enumerator->get_device_type())
+    // Replayed trackers report the device type they were recorded with
+    if (tracker_enumerator->get_api_type() == TrackerDeviceEnumerator::CommunicationType_REPLAY)
     {
-    case CommonSensorState::PS3EYE:
-        {
-            tracker_interface = new PS3EyeTracker();
-        } break;
-    case CommonSensorState::WMFMonoCamera:
-        {
-            tracker_interface = new WMFMonoTracker();
-        } break;
-    case CommonSensorState::WMFStereoCamera:
+        tracker_interface = new ReplayTracker();
+    }
+    else if (tracker_enumerator->get_api_type() == TrackerDeviceEnumerator::CommunicationType_SYNTHETIC)
+    {
+        tracker_interface = new SyntheticTracker();
+    }
+    else
+    {
+        switch (enumerator->get_device_type())
         {
-            tracker_interface = new WMFStereoTracker();
-        } break;
-    default:
-        break;
+        case CommonSensorState::PS3EYE:
+            {
+                tracker_interface = new PS3EyeTracker();
+            } break;
+        case CommonSensorState::WMFMonoCamera:
+            {
+                tracker_interface = new WMFMonoTracker();
+            } break;
+        case CommonSensorState::WMFStereoCamera:
+            {
+                tracker_interface = new WMFStereoTracker();
+            } break;
+        default:
+            break;
+        }
     }
 
     return tracker_interface;
@@ -1061,16 +1723,24 @@ const TrackerModeConfig *ServerTrackerView::getTrackerMode() const
 
 bool ServerTrackerView::setTrackerMode(const std::string &new_mode)
 {
-	if (m_device->setTrackerMode(new_mode))
+	// Frames the device delivers while it changes mode are dropped at capture,
+	// and no stage can be touching the frames or the shared memory while they get reallocated
+	std::lock_guard<std::mutex> rebuild_lock(m_pipelineRebuildMutex);
+	stop_pipeline_threads();
+
+	bool bSuccess= m_device->setTrackerMode(new_mode);
+	if (bSuccess)
 	{
 	    // Resize the shared memory and opencv buffers
 		reallocate_shared_memory();
 		reallocate_opencv_buffer_state();
-
-		return true;
+	}
+	else
+	{
+		start_pipeline_threads();
 	}
 
-	return false;
+	return bSuccess;
 }
 
 double ServerTrackerView::getFrameWidth() const
@@ -1176,24 +1846,27 @@ void ServerTrackerView::getHMDTrackingColorPreset(
 }
 
 bool ServerTrackerView::computeProjectionForHMD(
-    const class ServerHMDView* tracked_hmd,
-    const PSVRTrackingShape *tracking_shape,
+    TrackerPipelineFrame *frame,
+    TrackerSegmentationTask *task,
     PSVRTrackingProjection *out_projection)
 {
     bool bSuccess= false;
 
+    // Everything the previous frame allocated from the arena is dead by now
+    task->frame_arena.reset();
+
     if (m_device->getIsStereoCamera())
     {
         bool bLeftSuccess=
             computeProjectionForHmdInSection(
-                tracked_hmd,
-                tracking_shape,
+                frame,
+                task,
                 PSVRVideoFrameSection_Left,
                 out_projection);
         bool bRightSuccess= true;
             computeProjectionForHmdInSection(
-                tracked_hmd,
-                tracking_shape,
+                frame,
+                task,
                 PSVRVideoFrameSection_Right,
                 out_projection);
 
@@ -1209,8 +1882,8 @@ bool ServerTrackerView::computeProjectionForHMD(
 
         bSuccess=
             computeProjectionForHmdInSection(
-                tracked_hmd,
-                tracking_shape,
+                frame,
+                task,
                 PSVRVideoFrameSection_Primary,
                 out_projection);
     }
@@ -1222,20 +1895,23 @@ cv::Mat *ServerTrackerView::getDebugDrawingBuffer(PSVRVideoFrameSection section)
 {
 	cv::Mat *shmemBuffer= nullptr;
 
+	if (m_solveStageFrame == nullptr || !m_solveStageFrame->bWantsPreview)
+	{
+		return nullptr;
+	}
+
     if (m_device->getIsStereoCamera())
     {		
-        if ((section == PSVRVideoFrameSection_Left || section == PSVRVideoFrameSection_Right) &&
-			m_opencv_buffer_state[section] != nullptr)
+        if (section == PSVRVideoFrameSection_Left || section == PSVRVideoFrameSection_Right)
         {
-            shmemBuffer= m_opencv_buffer_state[section]->bgrShmemBuffer;
+            shmemBuffer= m_solveStageFrame->buffer_state[section]->bgrShmemBuffer;
         }
     }
     else
     {
-        if (section == PSVRVideoFrameSection_Primary &&
-			m_opencv_buffer_state[PSVRVideoFrameSection_Primary] != nullptr)
+        if (section == PSVRVideoFrameSection_Primary)
         {
-            shmemBuffer= m_opencv_buffer_state[PSVRVideoFrameSection_Primary]->bgrShmemBuffer;
+            shmemBuffer= m_solveStageFrame->buffer_state[PSVRVideoFrameSection_Primary]->bgrShmemBuffer;
         }
     }
 
@@ -1246,92 +1922,92 @@ void
 ServerTrackerView::drawPoseProjection(
 	const PSVRTrackingProjection *projection) const
 {
+	if (m_solveStageFrame == nullptr || !m_solveStageFrame->bWantsPreview)
+	{
+		return;
+	}
+
 	if (m_device->getIsStereoCamera())
 	{
-		m_opencv_buffer_state[PSVRVideoFrameSection_Left]->draw_pose_projection(*projection);
-		m_opencv_buffer_state[PSVRVideoFrameSection_Right]->draw_pose_projection(*projection);
+		m_solveStageFrame->buffer_state[PSVRVideoFrameSection_Left]->draw_pose_projection(*projection);
+		m_solveStageFrame->buffer_state[PSVRVideoFrameSection_Right]->draw_pose_projection(*projection);
 	}
 	else
 	{
-		m_opencv_buffer_state[PSVRVideoFrameSection_Primary]->draw_pose_projection(*projection);
+		m_solveStageFrame->buffer_state[PSVRVideoFrameSection_Primary]->draw_pose_projection(*projection);
 	}
 }
 
 bool
 ServerTrackerView::computeProjectionForHmdInSection(
-    const ServerHMDView* tracked_hmd,
-    const PSVRTrackingShape *tracking_shape,
+    TrackerPipelineFrame *frame,
+    TrackerSegmentationTask *task,
     const PSVRVideoFrameSection section,
     PSVRTrackingProjection *out_projection)
 {
     bool bSuccess = true;
 
-    // Get the HSV filter used to find the tracking blob
-    PSVR_HSVColorRange hsvColorRange;
+    OpenCVBufferState *buffer_state= frame->buffer_state[section];
+    const PSVRTrackingShape *tracking_shape= &task->tracking_shape;
+    const cv::Rect2i &ROI= task->roi[section];
+
+    task->convex_contour[section].clear();
+    task->blob_count[section]= 0;
+
+    // Find the N best blobs (or the best contour for a sphere) in the HMD's color mask
+    const bool bIsSphere= tracking_shape->shape_type == PSVRTrackingShape_Sphere;
+    t_opencv_int_contour_list &biggest_contours= task->biggest_contours;
+    std::vector<double> &contour_areas= task->contour_areas;
+    TrackerBlob *biggest_blobs= task->blobs[section];
+    int blob_count= 0;
     if (bSuccess)
     {
-        PSVRTrackingColorType tracked_color_id = tracked_hmd->getTrackingColorID();
-
-        if (tracked_color_id != PSVRTrackingColorType_INVALID)
+        if (bIsSphere)
         {
-            getHMDTrackingColorPreset(tracked_hmd, tracked_color_id, &hsvColorRange);
+            bSuccess = 
+                buffer_state->computeBiggestNContours(
+                    task->mask_index, ROI, biggest_contours, contour_areas, 1);
         }
         else
         {
-            bSuccess = false;
+            blob_count=
+                buffer_state->computeBiggestNBlobs(
+                    task->mask_index, ROI, task->blob_extractor, biggest_blobs, MAX_POINT_CLOUD_POINT_COUNT);
+            task->blob_count[section]= blob_count;
+            bSuccess = blob_count > 0;
         }
     }
-    
-    // Compute a region of interest in the tracker buffer around where we expect to find the tracking shape
-    const TrackerManagerConfig &trackerMgrConfig= DeviceManager::getInstance()->m_tracker_manager->getConfig();
-    const bool bRoiDisabled = tracked_hmd->getIsROIDisabled() || trackerMgrConfig.disable_roi;
-
-    const HMDOpticalPoseEstimation *priorPoseEst= 
-        tracked_hmd->getOpticalPoseEstimateOnTrackerThread(this->getDeviceID());
-    const bool bIsTracking = priorPoseEst->bCurrentlyTracking;
-
-    cv::Rect2i ROI = computeTrackerROIForPoseProjection(
-        bRoiDisabled,
-        this,
-        section,
-        bIsTracking ? &priorPoseEst->projection : nullptr);
-    m_opencv_buffer_state[section]->applyROI(ROI);
-
-    // Find the N best contours associated with the HMD
-    t_opencv_int_contour_list biggest_contours;
-    std::vector<double> contour_areas;
-    if (bSuccess)
-    {
-        bSuccess = 
-            m_opencv_buffer_state[section]->computeBiggestNContours(
-                hsvColorRange, biggest_contours, contour_areas, MAX_POINT_CLOUD_POINT_COUNT);
-    }
 
     // Compute the bounding box of the projection contours this frame
     if (bSuccess)
     {
-        if (biggest_contours.size() > 0)
+        cv::Rect bbox;
+        if (bIsSphere)
         {
-            cv::Rect bbox;
             for (auto it = biggest_contours.begin(); it != biggest_contours.end(); ++it)
             {
                 cv::Rect contour_bounds= cv::boundingRect(*it);
 
                 bbox= bbox | contour_bounds;
             }
-
-            out_projection->projections[section].screen_bbox_center= 
-                {static_cast<float>(bbox.x + bbox.width/2), 
-                static_cast<float>(bbox.y + bbox.height/2)};
-            out_projection->projections[section].screen_bbox_half_extents= 
-                {static_cast<float>(bbox.width/2), 
-                static_cast<float>(bbox.height/2)};
         }
         else
         {
-            out_projection->projections[section].screen_bbox_center= {0, 0};
-            out_projection->projections[section].screen_bbox_half_extents= {0, 0};
+            for (int blob_index = 0; blob_index < blob_count; ++blob_index)
+            {
+                const TrackerBlob &blob= biggest_blobs[blob_index];
+                cv::Rect blob_bounds(blob.min_x, blob.min_y, blob.max_x - blob.min_x + 1, blob.max_y - blob.min_y + 1);
+
+                bbox= bbox | blob_bounds;
+            }
         }
+
+        out_projection->projections[section].screen_bbox_center= 
+            {static_cast<float>(bbox.x + bbox.width/2), 
+            static_cast<float>(bbox.y + bbox.height/2)};
+        out_projection->projections[section].screen_bbox_half_extents= 
+            {static_cast<float>(bbox.width/2), 
+            static_cast<float>(bbox.height/2)};
     }
 
     // Compute the tracker relative 3d position of the controller from the contour
@@ -1350,31 +2026,39 @@ ServerTrackerView::computeProjectionForHmdInSection(
         case PSVRTrackingShape_Sphere:
             {
                 // Compute the convex hull of the contour
-                t_opencv_int_contour convex_contour;
+                t_opencv_int_contour &convex_contour= task->convex_contour[section];
                 cv::convexHull(biggest_contours[0], convex_contour);
-                m_opencv_buffer_state[section]->draw_contour(convex_contour);
 
                 // Convert integer to float
-                t_opencv_float_contour convex_contour_f;
-                cv::Mat(convex_contour).convertTo(convex_contour_f, cv::Mat(convex_contour_f).type());
+                const int convex_point_count= static_cast<int>(convex_contour.size());
+                FrameArenaVector<cv::Point2f> convex_contour_f(FrameArenaAllocator<cv::Point2f>(&task->frame_arena));
+                convex_contour_f.reserve(convex_point_count);
+                for (const cv::Point &point : convex_contour)
+                {
+                    convex_contour_f.push_back(cv::Point2f(static_cast<float>(point.x), static_cast<float>(point.y)));
+                }
 
                 // Undistort points
-                t_opencv_float_contour undistorted_contour;  //destination for undistorted contour
+                FrameArenaVector<cv::Point2f> undistorted_contour(convex_point_count, cv::Point2f(), FrameArenaAllocator<cv::Point2f>(&task->frame_arena));
                 if (valid_rectification)
                 {
-                    cv::undistortPoints(convex_contour_f, undistorted_contour,
-                                        camera_matrix,
-                                        distortions,
-                                        rectification_rotation,
-                                        rectification_projection);
+                    cv::undistortPoints(
+                        cv::_InputArray(convex_contour_f.data(), convex_point_count), 
+                        cv::_OutputArray(undistorted_contour.data(), convex_point_count),
+                        camera_matrix,
+                        distortions,
+                        rectification_rotation,
+                        rectification_projection);
                 }
                 else 
                 {
-                    cv::undistortPoints(convex_contour_f, undistorted_contour,
-                                        camera_matrix,
-                                        distortions,
-                                        cv::noArray(),
-                                        camera_matrix);
+                    cv::undistortPoints(
+                        cv::_InputArray(convex_contour_f.data(), convex_point_count), 
+                        cv::_OutputArray(undistorted_contour.data(), convex_point_count),
+                        camera_matrix,
+                        distortions,
+                        cv::noArray(),
+                        camera_matrix);
                 }
                 // Note: if we omit the last two arguments, then
                 // undistort_contour points are in 'normalized' space.
@@ -1384,7 +2068,8 @@ ServerTrackerView::computeProjectionForHmdInSection(
                 Eigen::Vector3f sphere_center;
                 EigenFitEllipse ellipse_projection;
 
-                std::vector<Eigen::Vector2f> eigen_contour;
+                FrameArenaVector<Eigen::Vector2f> eigen_contour(FrameArenaAllocator<Eigen::Vector2f>(&task->frame_arena));
+                eigen_contour.reserve(convex_point_count);
                 std::for_each(undistorted_contour.begin(),
                               undistorted_contour.end(),
                               [&eigen_contour](const cv::Point2f& p) {
@@ -1427,50 +2112,43 @@ ServerTrackerView::computeProjectionForHmdInSection(
             } break;
         case PSVRTrackingShape_PointCloud:
             {
-                const HMDOpticalPoseEstimation *prior_post_est= tracked_hmd->getOpticalPoseEstimateOnTrackerThread(getDeviceID());
-                PSVRPosef tracker_pose_guess= {prior_post_est->tracker_relative_position_cm, prior_post_est->tracker_relative_orientation};
-
-                // Undistort the source contours
-                t_opencv_float_contour_list undistorted_contours;
-                for (auto it = biggest_contours.begin(); it != biggest_contours.end(); ++it)
+                // Undistort the blob centers
+                cv::Point2f blob_centers[MAX_POINT_CLOUD_POINT_COUNT];
+                for (int blob_index = 0; blob_index < blob_count; ++blob_index)
                 {
-                    // Draw the source contour
-                    m_opencv_buffer_state[section]->draw_contour(*it);
-
-                    // Convert integer contour to float
-                    t_opencv_float_contour biggest_contour_f;
-                    cv::Mat(*it).convertTo(biggest_contour_f, cv::Mat(biggest_contour_f).type());
-
-                    // Compute an undistorted version of the contour
-                    t_opencv_float_contour undistorted_contour;
-                    if (valid_rectification)
-                    {
-                        cv::undistortPoints(biggest_contour_f, undistorted_contour,
-                                            camera_matrix,
-                                            distortions,
-                                            rectification_rotation,
-                                            rectification_projection);
-                    }
-                    else 
-                    {
-                        cv::undistortPoints(biggest_contour_f, undistorted_contour,
-                                            camera_matrix,
-                                            distortions,
-                                            cv::noArray(),
-                                            camera_matrix);
-                    }
+                    blob_centers[blob_index]= cv::Point2f(biggest_blobs[blob_index].center_x, biggest_blobs[blob_index].center_y);
+                }
 
-                    undistorted_contours.push_back(undistorted_contour);
+                cv::Point2f undistorted_blob_centers[MAX_POINT_CLOUD_POINT_COUNT];
+                if (valid_rectification)
+                {
+                    cv::undistortPoints(
+                        cv::_InputArray(blob_centers, blob_count), 
+                        cv::_OutputArray(undistorted_blob_centers, blob_count),
+                        camera_matrix,
+                        distortions,
+                        rectification_rotation,
+                        rectification_projection);
+                }
+                else 
+                {
+                    cv::undistortPoints(
+                        cv::_InputArray(blob_centers, blob_count), 
+                        cv::_OutputArray(undistorted_blob_centers, blob_count),
+                        camera_matrix,
+                        distortions,
+                        cv::noArray(),
+                        camera_matrix);
                 }
 
-                // Compute centers of mass for the contours
-				t_opencv_float_list cvProjectionAreas;
+                // Use the blob pixel counts as the projection areas.
+                // Lens distortion barely changes the area of an LED sized blob.
 				int cvImagePointCount= 0;
                 float totalProjectionArea = 0.f;
-                for (auto it = undistorted_contours.begin(); it != undistorted_contours.end(); ++it)
+                for (int blob_index = 0; blob_index < blob_count; ++blob_index)
                 {
-                    cv::Point2f massCenter= computeSafeCenterOfMassForContour<t_opencv_float_contour>(*it);
-					float projectionArea= (float)cv::contourArea(*it);
+                    const cv::Point2f &massCenter= undistorted_blob_centers[blob_index];
+					const float projectionArea= static_cast<float>(biggest_blobs[blob_index].area);
 
 					out_projection->projections[section].shape.pointcloud.points[cvImagePointCount] = {massCenter.x, massCenter.y};
 					out_projection->projections[section].shape.pointcloud.screen_area[cvImagePointCount]= projectionArea;
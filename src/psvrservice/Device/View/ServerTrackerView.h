@@ -4,9 +4,25 @@
 //-- includes -----
 #include "ServerDeviceView.h"
 #include "PSVRServiceInterface.h"
+#include "LatencyHistogram.h"
+#include <atomic>
+#include <mutex>
 #include <vector>
 
+#include "readerwriterqueue.h" // lockfree queue
+
 // -- constants -----
+// Stages of the per-tracker video frame pipeline.
+// Capture runs on the tracker driver's thread, every other stage has its own worker thread.
+enum eTrackerPipelineStage
+{
+	TrackerPipelineStage_Capture,		// copy the raw video frame into a pipeline frame
+	TrackerPipelineStage_Segmentation,	// find the projection of every tracked HMD in the frame
+	TrackerPipelineStage_Solve,			// apply the projections to the HMD shape models and pose filters
+	TrackerPipelineStage_Publish,		// copy the annotated frame to the shared memory video stream
+
+	TrackerPipelineStage_COUNT
+};
 
 // -- pre-declarations -----
 namespace PSVRProtocol
@@ -20,7 +36,26 @@ namespace cv
 	class Mat;
 }
 
+struct TrackerPipelineFrame;
+struct TrackerSegmentationTask;
+using t_tracker_pipeline_frame_queue= moodycamel::ReaderWriterQueue<TrackerPipelineFrame *>;
+
 // -- declarations -----
+struct TrackerPipelineStatistics
+{
+	// Frames that made it through the given stage
+	uint64_t processed_frame_count[TrackerPipelineStage_COUNT];
+	// Frames dropped at the given stage because a newer frame was already waiting behind them
+	// (or, for the capture stage, because every pipeline frame was in use or the pipeline was being rebuilt)
+	uint64_t dropped_frame_count[TrackerPipelineStage_COUNT];
+	// Heap allocations the stage thread made while processing its last frame.
+	// Always 0 unless the service is built with PSVR_COUNT_HEAP_ALLOCATIONS.
+	uint64_t last_frame_heap_allocation_count[TrackerPipelineStage_COUNT];
+	// Frames on which the stage thread made at least one heap allocation.
+	// Should stop growing once the pipeline reaches steady state (checked by psvr_bench).
+	uint64_t heap_allocating_frame_count[TrackerPipelineStage_COUNT];
+};
+
 class ServerTrackerView : public ServerDeviceView, public ITrackerListener
 {
 public:
@@ -34,6 +69,9 @@ public:
     void close() override;
 	void pollUpdatedVideoFrame();
 
+	// Also sends out the video property changes the device applied since the last publish
+	void publish() override;
+
     // Starts or stops streaming of the video feed to the shared memory buffer.
     // Keep a ref count of how many clients are following the stream.
     void startSharedMemoryVideoStream();
@@ -76,13 +114,21 @@ public:
 	int getVideoProperty(const PSVRVideoPropertyType property_type) const;
 	void setVideoProperty(const PSVRVideoPropertyType property_type, int desired_value, bool save_setting);
 
-    bool computeProjectionForHMD(
-		const class ServerHMDView* tracked_hmd,
-		const PSVRTrackingShape *tracking_shape,
-		PSVRTrackingProjection *out_projection);
-
+	// Debug drawing targets the frame currently being solved.
+	// Only valid when called from the solve stage (i.e. from ServerHMDView::notifyTrackerDataReceived).
+	// The drawing buffer is null when the frame isn't going out on the video stream.
 	cv::Mat *getDebugDrawingBuffer(PSVRVideoFrameSection section) const;
 	void drawPoseProjection(const PSVRTrackingProjection *projection) const;
+
+	// Get the processed and dropped frame counters for each stage of the frame pipeline
+	void getPipelineStatistics(TrackerPipelineStatistics &out_stats) const;
+
+	// Get the latency of every stage from USB transfer to publish, along with the frame counters
+	void getStatistics(PSVRTrackerStatistics &out_statistics) const;
+
+	// Runs the given pipeline stage on the newest frame waiting for it (older waiting frames are dropped).
+	// Called by the pipeline stage worker threads. Returns false if no frame was waiting.
+	bool runPipelineStage(eTrackerPipelineStage stage);
     
     std::vector<PSVRVector2f> projectTrackerRelativePositions(
 		const PSVRVideoFrameSection section,
@@ -114,11 +160,15 @@ public:
 	void getHMDTrackingColorPreset(const class ServerHMDView *controller, PSVRTrackingColorType color, PSVR_HSVColorRange *out_preset) const;
 
 	//-- ITrackerListener
-	virtual void notifyVideoFrameReceived(const unsigned char *raw_video_frame_buffer) override;
+	virtual void notifyVideoFrameReceived(const unsigned char *raw_video_frame_buffer, const t_service_timepoint &capture_timestamp) override;
+	virtual void notifyVideoPropertyApplied(PSVRVideoPropertyType property_type, int value, bool bSuccess) override;
 
 protected:
     void reallocate_shared_memory();
     void reallocate_opencv_buffer_state();
+	void start_pipeline_threads();
+	void stop_pipeline_threads();
+	void free_pipeline();
     bool allocate_device_interface(const class DeviceEnumerator *enumerator) override;
     void free_device_interface() override;
     void publish_device_data_frame() override;
@@ -126,9 +176,20 @@ protected:
         const ServerTrackerView *tracker_view, const struct TrackerStreamInfo *stream_info,
         DeviceOutputDataFrame &data_frame);
 
+	bool shouldPreviewFrame(const t_service_timepoint &capture_timestamp);
+	void wakePipelineStage(eTrackerPipelineStage stage);
+	void segmentFrame(TrackerPipelineFrame *frame);
+	void solveFrame(TrackerPipelineFrame *frame);
+	void publishFrame(TrackerPipelineFrame *frame);
+
+    bool computeProjectionForHMD(
+		TrackerPipelineFrame *frame,
+		TrackerSegmentationTask *task,
+		PSVRTrackingProjection *out_projection);
+
     bool computeProjectionForHmdInSection(
-        const ServerHMDView* tracked_controller,
-        const PSVRTrackingShape *tracking_shape,
+		TrackerPipelineFrame *frame,
+		TrackerSegmentationTask *task,
         const PSVRVideoFrameSection section,
         PSVRTrackingProjection *out_projection);
 
@@ -137,9 +198,37 @@ private:
     class SharedVideoFrameBuffer *m_shared_memory_accesor;
     std::atomic_int m_shared_memory_video_stream_count;
 	int m_lastVideoFrameIndexPolled;
-    class OpenCVBufferState *m_opencv_buffer_state[MAX_PROJECTION_COUNT];
     ITrackerInterface *m_device;
 
+	// Video property changes the device finished applying, waiting for the next publish.
+	// Only touched on the main thread.
+	std::vector<PSVRVideoPropertyAppliedEvent> m_appliedVideoProperties;
+
+	// Frame pipeline
+	// Frames circulate capture -> segmentation -> solve -> publish -> capture.
+	// m_pipelineQueues[stage] is the input queue of that stage, except for segmentation
+	// which takes its input from m_pendingSegmentationFrame.
+	std::vector<TrackerPipelineFrame *> m_pipelineFrames;
+	t_tracker_pipeline_frame_queue *m_pipelineQueues[TrackerPipelineStage_COUNT];
+	// Newest captured frame segmentation hasn't picked up yet.
+	// Capture swaps each new frame in and reuses the frame it replaces,
+	// so a slow segmentation stage drops the oldest frame rather than the newest.
+	std::atomic<TrackerPipelineFrame *> m_pendingSegmentationFrame;
+	TrackerPipelineFrame *m_reclaimedCaptureFrame; // capture stage only
+	// Held by the capture stage while it fills a frame and by the main thread while
+	// the device mode or pipeline changes. Capture only try_locks it, so the
+	// driver thread drops frames during a rebuild instead of blocking on it.
+	std::mutex m_pipelineRebuildMutex;
+	class TrackerPipelineStageThread *m_pipelineThreads[TrackerPipelineStage_COUNT]; // no thread for capture
+	TrackerPipelineFrame *m_solveStageFrame; // frame being solved (solve stage only)
+	uint64_t m_pipelineFrameSequence; // capture stage only
+	t_service_timepoint m_nextPreviewTimestamp; // capture stage only
+	std::atomic<uint64_t> m_pipelineProcessedFrameCount[TrackerPipelineStage_COUNT];
+	std::atomic<uint64_t> m_pipelineDroppedFrameCount[TrackerPipelineStage_COUNT];
+	std::atomic<uint64_t> m_pipelineHeapAllocationCount[TrackerPipelineStage_COUNT];
+	std::atomic<uint64_t> m_pipelineHeapAllocatingFrameCount[TrackerPipelineStage_COUNT];
+	LatencyHistogram m_pipelineStageLatency[TrackerPipelineStage_COUNT]; // written by each stage's own thread
+
 };
 
 #endif // SERVER_TRACKER_VIEW_H
@@ -5,6 +5,26 @@
 #include "KalmanPositionFilter.h"
 #include "KalmanOrientationFilter.h"
 
+// -- private definitions --
+struct CompoundPoseFilterSnapshot : public IStateFilterSnapshot
+{
+	IStateFilterSnapshot *orientation_state;
+	IStateFilterSnapshot *position_state;
+	double time;
+
+	CompoundPoseFilterSnapshot(IStateFilterSnapshot *orientation_snapshot, IStateFilterSnapshot *position_snapshot)
+		: orientation_state(orientation_snapshot)
+		, position_state(position_snapshot)
+		, time(0.0)
+	{}
+
+	virtual ~CompoundPoseFilterSnapshot()
+	{
+		delete orientation_state;
+		delete position_state;
+	}
+};
+
 // -- public interface --
 bool CompoundPoseFilter::init(
 	const CommonSensorState::eDeviceType deviceType,
@@ -173,6 +193,66 @@ void CompoundPoseFilter::recenterOrientation(const Eigen::Quaternionf& q_pose)
 	}
 }
 
+IStateFilterSnapshot *CompoundPoseFilter::allocateStateSnapshot() const
+{
+	// Can only rewind if every sub filter can
+	IStateFilterSnapshot *orientation_state= nullptr;
+	if (m_orientation_filter != nullptr)
+	{
+		orientation_state= m_orientation_filter->allocateStateSnapshot();
+		if (orientation_state == nullptr)
+			return nullptr;
+	}
+
+	IStateFilterSnapshot *position_state= nullptr;
+	if (m_position_filter != nullptr)
+	{
+		position_state= m_position_filter->allocateStateSnapshot();
+		if (position_state == nullptr)
+		{
+			delete orientation_state;
+			return nullptr;
+		}
+	}
+
+	return new CompoundPoseFilterSnapshot(orientation_state, position_state);
+}
+
+void CompoundPoseFilter::saveStateSnapshot(IStateFilterSnapshot *snapshot) const
+{
+	CompoundPoseFilterSnapshot *compound_snapshot= static_cast<CompoundPoseFilterSnapshot *>(snapshot);
+
+	if (m_orientation_filter != nullptr)
+	{
+		m_orientation_filter->saveStateSnapshot(compound_snapshot->orientation_state);
+	}
+
+	if (m_position_filter != nullptr)
+	{
+		m_position_filter->saveStateSnapshot(compound_snapshot->position_state);
+	}
+
+	compound_snapshot->time= m_time;
+}
+
+void CompoundPoseFilter::restoreStateSnapshot(const IStateFilterSnapshot *snapshot)
+{
+	const CompoundPoseFilterSnapshot *compound_snapshot= static_cast<const CompoundPoseFilterSnapshot *>(snapshot);
+
+	if (m_orientation_filter != nullptr)
+	{
+		m_orientation_filter->restoreStateSnapshot(compound_snapshot->orientation_state);
+	}
+
+	if (m_position_filter != nullptr)
+	{
+		m_position_filter->restoreStateSnapshot(compound_snapshot->position_state);
+	}
+
+	m_time= compound_snapshot->time;
+}
+
+// -- IPoseFilter --
 bool CompoundPoseFilter::getIsPositionStateValid() const
 {
 	return m_position_filter != nullptr && m_position_filter->getIsStateValid();
@@ -33,6 +33,7 @@ public:
     CompoundPoseFilter() 
         : m_position_filter(nullptr)
         , m_orientation_filter(nullptr)
+        , m_time(0.0)
     {}
     virtual ~CompoundPoseFilter()
     { dispose_filters(); }
@@ -56,6 +57,9 @@ public:
     void update(const float delta_time, const PoseFilterPacket &packet) override;
     void resetState() override;
 	void recenterOrientation(const Eigen::Quaternionf& q_pose) override;
+    IStateFilterSnapshot *allocateStateSnapshot() const override;
+    void saveStateSnapshot(IStateFilterSnapshot *snapshot) const override;
+    void restoreStateSnapshot(const IStateFilterSnapshot *snapshot) override;
 
     // -- IPoseFilter ---
     bool getIsPositionStateValid() const override;
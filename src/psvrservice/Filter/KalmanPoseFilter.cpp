@@ -325,6 +325,13 @@ public:
     {
         return x;
     }
+
+    // Copy the state estimate and covariance, but not the (constant) sigma point parameters
+    void copyStateFrom(const PoseSRUKF &other)
+    {
+        x= other.x;
+        S= other.S;
+    }
 };
 
 template<typename T>
@@ -726,6 +733,8 @@ public:
 };
 
 
+struct KalmanPoseFilterSnapshot;
+
 class KalmanPoseFilterImpl
 {
 public:
@@ -818,8 +827,55 @@ public:
     {
         set_world_quaternion(compute_net_world_quaternion());
     }
+
+    // The measurement models only reference the world orientation, so they don't need to be saved
+    void save_state(KalmanPoseFilterSnapshot *snapshot) const;
+    void restore_state(const KalmanPoseFilterSnapshot *snapshot);
+};
+
+struct KalmanPoseFilterSnapshot : public IStateFilterSnapshot
+{
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    bool bIsValid;
+    bool bSeenPositionMeasurement;
+    bool bSeenOrientationMeasurement;
+    Eigen::Vector3f origin_position_meters;
+    PoseSystemModel system_model;
+    PoseSRUKF ukf;
+    double time;
+    Eigen::Quaterniond world_orientation;
+
+    KalmanPoseFilterSnapshot()
+        : ukf(k_ukf_alpha, k_ukf_beta, k_ukf_kappa)
+    {
+    }
 };
 
+void KalmanPoseFilterImpl::save_state(KalmanPoseFilterSnapshot *snapshot) const
+{
+    snapshot->bIsValid= bIsValid;
+    snapshot->bSeenPositionMeasurement= bSeenPositionMeasurement;
+    snapshot->bSeenOrientationMeasurement= bSeenOrientationMeasurement;
+    snapshot->origin_position_meters= origin_position_meters;
+    snapshot->system_model= system_model;
+    snapshot->ukf.copyStateFrom(ukf);
+    snapshot->time= time;
+    snapshot->world_orientation= world_orientation;
+}
+
+void KalmanPoseFilterImpl::restore_state(const KalmanPoseFilterSnapshot *snapshot)
+{
+    bIsValid= snapshot->bIsValid;
+    bSeenPositionMeasurement= snapshot->bSeenPositionMeasurement;
+    bSeenOrientationMeasurement= snapshot->bSeenOrientationMeasurement;
+    origin_position_meters= snapshot->origin_position_meters;
+    system_model= snapshot->system_model;
+    ukf.copyStateFrom(snapshot->ukf);
+    time= snapshot->time;
+    world_orientation= snapshot->world_orientation;
+}
+
 class PointCloudKalmanPoseFilterImpl : public KalmanPoseFilterImpl
 {
 public:
@@ -1016,6 +1072,21 @@ void KalmanPoseFilter::recenterOrientation(const Eigen::Quaternionf& q_pose)
     m_filter->ukf.init(PoseStateVectord::Identity());
 }
 
+IStateFilterSnapshot *KalmanPoseFilter::allocateStateSnapshot() const
+{
+    return new KalmanPoseFilterSnapshot;
+}
+
+void KalmanPoseFilter::saveStateSnapshot(IStateFilterSnapshot *snapshot) const
+{
+    m_filter->save_state(static_cast<KalmanPoseFilterSnapshot *>(snapshot));
+}
+
+void KalmanPoseFilter::restoreStateSnapshot(const IStateFilterSnapshot *snapshot)
+{
+    m_filter->restore_state(static_cast<const KalmanPoseFilterSnapshot *>(snapshot));
+}
+
 Eigen::Quaternionf KalmanPoseFilter::getOrientation(float time) const
 {
     Eigen::Quaternionf result = Eigen::Quaternionf::Identity();
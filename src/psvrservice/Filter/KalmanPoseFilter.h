@@ -20,6 +20,9 @@ public:
     double getTimeInSeconds() const override;
 	void resetState() override;
 	void recenterOrientation(const Eigen::Quaternionf& q_pose) override;
+	IStateFilterSnapshot *allocateStateSnapshot() const override;
+	void saveStateSnapshot(IStateFilterSnapshot *snapshot) const override;
+	void restoreStateSnapshot(const IStateFilterSnapshot *snapshot) override;
 
 	// -- IPoseFilter ---
     /// Not true until the filter has updated at least once
@@ -148,6 +148,13 @@ struct OrientationFilterState
 	}
 };
 
+struct OrientationFilterSnapshot : public IStateFilterSnapshot
+{
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    OrientationFilterState state;
+};
+
 // -- public interface -----
 //-- Orientation Filter --
 OrientationFilter::OrientationFilter() :
@@ -185,6 +192,21 @@ void OrientationFilter::recenterOrientation(const Eigen::Quaternionf& q_pose)
     m_state->reset_orientation= q_pose*q_inverse;
 }
 
+IStateFilterSnapshot *OrientationFilter::allocateStateSnapshot() const
+{
+    return new OrientationFilterSnapshot;
+}
+
+void OrientationFilter::saveStateSnapshot(IStateFilterSnapshot *snapshot) const
+{
+    static_cast<OrientationFilterSnapshot *>(snapshot)->state= *m_state;
+}
+
+void OrientationFilter::restoreStateSnapshot(const IStateFilterSnapshot *snapshot)
+{
+    *m_state= static_cast<const OrientationFilterSnapshot *>(snapshot)->state;
+}
+
 bool OrientationFilter::init(const OrientationFilterConstants &constants)
 {
     resetState();
@@ -17,6 +17,9 @@ public:
     double getTimeInSeconds() const override;
     void resetState() override;
     void recenterOrientation(const Eigen::Quaternionf& q_pose) override;
+    IStateFilterSnapshot *allocateStateSnapshot() const override;
+    void saveStateSnapshot(IStateFilterSnapshot *snapshot) const override;
+    void restoreStateSnapshot(const IStateFilterSnapshot *snapshot) override;
 
     // -- IOrientationFilter --
     bool init(const OrientationFilterConstants &constant) override;
@@ -58,6 +61,9 @@ public:
     void resetState() override;
     void update(const float delta_time, const PoseFilterPacket &packet) override;
 
+    // The gyro bias isn't part of the snapshot state
+    IStateFilterSnapshot *allocateStateSnapshot() const override { return nullptr; }
+
 protected:
     float m_omega_bias_x;
     float m_omega_bias_y;
@@ -85,6 +91,9 @@ public:
     void resetState() override;
     void update(const float delta_time, const PoseFilterPacket &packet) override;
 
+    // The mag-grav blend weight isn't part of the snapshot state
+    IStateFilterSnapshot *allocateStateSnapshot() const override { return nullptr; }
+
 protected:
     float mg_weight;
 };
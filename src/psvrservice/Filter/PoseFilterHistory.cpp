@@ -0,0 +1,206 @@
+// -- includes -----
+#include "PoseFilterHistory.h"
+#include "MathUtility.h"
+
+#include <assert.h>
+
+//-- constants -----
+static const float k_min_time_delta_seconds = 1 / 2500.f;
+static const float k_max_time_delta_seconds = 1 / 30.f;
+
+// -- private definitions -----
+struct PoseFilterHistoryEntry
+{
+	PoseSensorPacket sensor_packet;
+
+	/// When the packet was applied to the filter (never earlier than the packet before it)
+	std::chrono::time_point<std::chrono::high_resolution_clock> filter_timestamp;
+
+	/// The filter state and last update time from just before the packet was applied
+	IStateFilterSnapshot *prior_filter_state;
+	std::chrono::time_point<std::chrono::high_resolution_clock> prior_filter_timestamp;
+	bool bIsPriorFilterTimestampValid;
+
+	PoseFilterHistoryEntry()
+		: prior_filter_state(nullptr)
+		, bIsPriorFilterTimestampValid(false)
+	{}
+};
+
+// -- public interface -----
+PoseFilterHistory::PoseFilterHistory(
+	IPoseFilter *pose_filter,
+	const PoseFilterSpace *pose_filter_space,
+	const int capacity)
+	: m_poseFilter(pose_filter)
+	, m_poseFilterSpace(pose_filter_space)
+	, m_entries(nullptr)
+	, m_replayPackets(nullptr)
+	, m_capacity(0)
+	, m_oldestEntryIndex(0)
+	, m_entryCount(0)
+	, m_lastFilterUpdateTimestamp()
+	, m_bIsLastFilterUpdateTimestampValid(false)
+{
+	IStateFilterSnapshot *first_snapshot= (capacity > 0) ? m_poseFilter->allocateStateSnapshot() : nullptr;
+
+	// Allocate all of the snapshots up front so that recording the history doesn't allocate
+	if (first_snapshot != nullptr)
+	{
+		m_capacity= capacity;
+		m_entries= new PoseFilterHistoryEntry[capacity];
+		m_replayPackets= new PoseSensorPacket[capacity];
+
+		m_entries[0].prior_filter_state= first_snapshot;
+		for (int entry_index = 1; entry_index < capacity; ++entry_index)
+		{
+			m_entries[entry_index].prior_filter_state= m_poseFilter->allocateStateSnapshot();
+		}
+	}
+}
+
+PoseFilterHistory::~PoseFilterHistory()
+{
+	if (m_entries != nullptr)
+	{
+		for (int entry_index = 0; entry_index < m_capacity; ++entry_index)
+		{
+			delete m_entries[entry_index].prior_filter_state;
+		}
+
+		delete[] m_entries;
+		delete[] m_replayPackets;
+	}
+}
+
+void PoseFilterHistory::clear()
+{
+	m_oldestEntryIndex= 0;
+	m_entryCount= 0;
+}
+
+bool PoseFilterHistory::getIsLateSensorPacket(const PoseSensorPacket &sensor_packet) const
+{
+	return m_bIsLastFilterUpdateTimestampValid && sensor_packet.timestamp < m_lastFilterUpdateTimestamp;
+}
+
+int PoseFilterHistory::computeReplayCount(const PoseSensorPacket &sensor_packet) const
+{
+	if (m_entryCount == 0)
+		return -1;
+
+	// Walk back from the newest packet to the first one applied no later than the given packet
+	int replay_count= 0;
+	while (replay_count < m_entryCount &&
+			get_entry(m_entryCount - replay_count - 1).filter_timestamp > sensor_packet.timestamp)
+	{
+		++replay_count;
+	}
+
+	// Rewinding past the oldest packet is only ok if the state before it is also older than the given packet
+	if (replay_count == m_entryCount)
+	{
+		const PoseFilterHistoryEntry &oldest_entry= get_entry(0);
+
+		if (oldest_entry.bIsPriorFilterTimestampValid &&
+			oldest_entry.prior_filter_timestamp > sensor_packet.timestamp)
+		{
+			return -1;
+		}
+	}
+
+	return replay_count;
+}
+
+void PoseFilterHistory::applySensorPacket(const PoseSensorPacket &sensor_packet)
+{
+	// Never step the filter backwards in time
+	const std::chrono::time_point<std::chrono::high_resolution_clock> filter_timestamp=
+		getIsLateSensorPacket(sensor_packet) ? m_lastFilterUpdateTimestamp : sensor_packet.timestamp;
+
+	// Compute the time since the last packet
+	float time_delta_seconds;
+	if (m_bIsLastFilterUpdateTimestampValid)
+	{
+		const std::chrono::duration<float, std::milli> time_delta = filter_timestamp - m_lastFilterUpdateTimestamp;
+		const float time_delta_milli = time_delta.count();
+
+		// convert delta to seconds clamp time delta between 2500hz and 30hz
+		time_delta_seconds = clampf(time_delta_milli / 1000.f, k_min_time_delta_seconds, k_max_time_delta_seconds);
+	}
+	else
+	{
+		time_delta_seconds = k_max_time_delta_seconds;
+	}
+
+	// Record the packet along with the filter state it's about to be applied to
+	if (m_entries != nullptr)
+	{
+		if (m_entryCount == m_capacity)
+		{
+			// Forget the oldest packet
+			m_oldestEntryIndex= (m_oldestEntryIndex + 1) % m_capacity;
+			--m_entryCount;
+		}
+
+		PoseFilterHistoryEntry &entry= get_entry(m_entryCount);
+		entry.sensor_packet= sensor_packet;
+		entry.filter_timestamp= filter_timestamp;
+		entry.prior_filter_timestamp= m_lastFilterUpdateTimestamp;
+		entry.bIsPriorFilterTimestampValid= m_bIsLastFilterUpdateTimestampValid;
+		m_poseFilter->saveStateSnapshot(entry.prior_filter_state);
+		++m_entryCount;
+	}
+
+	m_lastFilterUpdateTimestamp = filter_timestamp;
+	m_bIsLastFilterUpdateTimestampValid = true;
+
+	PoseFilterPacket filter_packet;
+	filter_packet.clear();
+
+	// Create a filter input packet from the sensor data
+	// and the filter's previous orientation and position
+	m_poseFilterSpace->createFilterPacket(
+		sensor_packet,
+		m_poseFilter,
+		filter_packet);
+
+	// Process the filter packet
+	m_poseFilter->update(time_delta_seconds, filter_packet);
+}
+
+PoseFilterHistoryEntry &PoseFilterHistory::get_entry(const int entry_index) const
+{
+	// Entry 0 is the oldest packet
+	return m_entries[(m_oldestEntryIndex + entry_index) % m_capacity];
+}
+
+void PoseFilterHistory::rewindAndApplySensorPacket(const PoseSensorPacket &sensor_packet, const int replay_count)
+{
+	assert(replay_count >= 0 && replay_count <= m_entryCount);
+
+	if (replay_count > 0)
+	{
+		const int first_replay_index= m_entryCount - replay_count;
+
+		// Pull the packets to replay out of the history
+		for (int replay_index = 0; replay_index < replay_count; ++replay_index)
+		{
+			m_replayPackets[replay_index]= get_entry(first_replay_index + replay_index).sensor_packet;
+		}
+
+		// Rewind the filter to just before the first of them
+		const PoseFilterHistoryEntry &rewind_entry= get_entry(first_replay_index);
+		m_poseFilter->restoreStateSnapshot(rewind_entry.prior_filter_state);
+		m_lastFilterUpdateTimestamp= rewind_entry.prior_filter_timestamp;
+		m_bIsLastFilterUpdateTimestampValid= rewind_entry.bIsPriorFilterTimestampValid;
+		m_entryCount= first_replay_index;
+	}
+
+	applySensorPacket(sensor_packet);
+
+	for (int replay_index = 0; replay_index < replay_count; ++replay_index)
+	{
+		applySensorPacket(m_replayPackets[replay_index]);
+	}
+}
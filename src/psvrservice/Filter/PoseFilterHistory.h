@@ -0,0 +1,63 @@
+#ifndef POSE_FILTER_HISTORY_H
+#define POSE_FILTER_HISTORY_H
+
+//-- includes -----
+#include "PoseFilterInterface.h"
+#include <chrono>
+
+//-- definitions -----
+/// Feeds sensor packets to a pose filter while keeping a fixed size ring of the packets applied
+/// and the filter state from just before each one.
+/// When a packet shows up older than packets already applied (optical packets lag the IMU packets),
+/// the filter can be rewound to the packet's timestamp, the packet applied,
+/// and the newer packets replayed on top of it.
+/// If the filter can't snapshot its state there is no history and late packets are applied as they arrive.
+class PoseFilterHistory
+{
+public:
+	PoseFilterHistory(IPoseFilter *pose_filter, const PoseFilterSpace *pose_filter_space, const int capacity);
+	~PoseFilterHistory();
+
+	inline bool getIsRewindSupported() const { return m_entries != nullptr; }
+	inline bool getIsLastFilterUpdateTimestampValid() const { return m_bIsLastFilterUpdateTimestampValid; }
+	inline const std::chrono::time_point<std::chrono::high_resolution_clock> &getLastFilterUpdateTimestamp() const
+	{ return m_lastFilterUpdateTimestamp; }
+
+	/// Forget the applied packets, i.e. after the filter state was changed outside of the history
+	void clear();
+
+	/// True if the packet is older than the last packet applied to the filter
+	bool getIsLateSensorPacket(const PoseSensorPacket &sensor_packet) const;
+
+	/// The number of applied packets that would have to be replayed to apply the given packet in time order.
+	/// Returns -1 if the history doesn't reach back far enough.
+	int computeReplayCount(const PoseSensorPacket &sensor_packet) const;
+
+	/// Apply a packet on top of the current filter state.
+	/// A late packet is treated as if it arrived at the time of the last update.
+	void applySensorPacket(const PoseSensorPacket &sensor_packet);
+
+	/// Rewind the filter past the newest replay_count packets (from computeReplayCount()),
+	/// apply the given packet and then replay those packets.
+	void rewindAndApplySensorPacket(const PoseSensorPacket &sensor_packet, const int replay_count);
+
+private:
+	struct PoseFilterHistoryEntry &get_entry(const int entry_index) const;
+
+	IPoseFilter *m_poseFilter;
+	const PoseFilterSpace *m_poseFilterSpace;
+
+	struct PoseFilterHistoryEntry *m_entries; // ring of size m_capacity, null if the filter can't be rewound
+	PoseSensorPacket *m_replayPackets; // array of size m_capacity
+	int m_capacity;
+	int m_oldestEntryIndex;
+	int m_entryCount;
+
+	std::chrono::time_point<std::chrono::high_resolution_clock> m_lastFilterUpdateTimestamp;
+	bool m_bIsLastFilterUpdateTimestampValid;
+
+	PoseFilterHistory(const PoseFilterHistory&);
+	void operator=(const PoseFilterHistory&);
+};
+
+#endif // POSE_FILTER_HISTORY_H
@@ -48,6 +48,8 @@ struct ExponentialCurve
 struct PoseSensorPacket
 {
 	std::chrono::time_point<std::chrono::high_resolution_clock> timestamp;
+	// Wall clock time the packet was queued for the pose filter (only used for latency statistics)
+	std::chrono::time_point<std::chrono::high_resolution_clock> queued_time;
 
     // Optical readings in the world reference frame
 	int tracker_id;
@@ -72,6 +74,7 @@ struct PoseSensorPacket
 	inline void clear()
 	{
 		timestamp= std::chrono::time_point<std::chrono::high_resolution_clock>();
+		queued_time= std::chrono::time_point<std::chrono::high_resolution_clock>();
 		tracker_id= -1;
 		memset(&optical_tracking_shape_cm, 0, sizeof(PSVRTrackingShape));
 		memset(&optical_tracking_projection, 0, sizeof(PSVRTrackingProjection));
@@ -292,6 +295,14 @@ struct PoseFilterConstants
 	}
 };
 
+/// An opaque copy of a state filter's internal state.
+/// Lets a filter be rewound to an earlier point in time so that late measurements can be applied in order.
+class IStateFilterSnapshot
+{
+public:
+    virtual ~IStateFilterSnapshot() {}
+};
+
 /// Common interface to all state filters
 class IStateFilter
 {
@@ -310,6 +321,15 @@ public:
 
     /// The current state becomes the identity pose
     virtual void recenterOrientation(const Eigen::Quaternionf& q_pose) = 0;
+
+    /// Allocate storage for a copy of the filter state (nullptr if the filter can't be rewound)
+    virtual IStateFilterSnapshot *allocateStateSnapshot() const { return nullptr; }
+
+    /// Copy the current filter state into a snapshot from allocateStateSnapshot()
+    virtual void saveStateSnapshot(IStateFilterSnapshot *snapshot) const {}
+
+    /// Rewind the filter to the state saved in the given snapshot
+    virtual void restoreStateSnapshot(const IStateFilterSnapshot *snapshot) {}
 };
 
 /// Common interface to all orientation filters
@@ -205,6 +205,13 @@ struct PositionFilterState
 	}
 };
 
+struct PositionFilterSnapshot : public IStateFilterSnapshot
+{
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    PositionFilterState state;
+};
+
 // -- private methods -----
 static Eigen::Vector3f threshold_vector3f(const Eigen::Vector3f &vector, const float min_length);
 static Eigen::Vector3f clamp_vector3f(const Eigen::Vector3f &vector, const float max_length);
@@ -264,6 +271,21 @@ void PositionFilter::recenterOrientation(const Eigen::Quaternionf& q_pose)
 {
 }
 
+IStateFilterSnapshot *PositionFilter::allocateStateSnapshot() const
+{
+    return new PositionFilterSnapshot;
+}
+
+void PositionFilter::saveStateSnapshot(IStateFilterSnapshot *snapshot) const
+{
+    static_cast<PositionFilterSnapshot *>(snapshot)->state= *m_state;
+}
+
+void PositionFilter::restoreStateSnapshot(const IStateFilterSnapshot *snapshot)
+{
+    *m_state= static_cast<const PositionFilterSnapshot *>(snapshot)->state;
+}
+
 bool PositionFilter::init(const PositionFilterConstants &constants)
 {
     resetState();
@@ -19,6 +19,9 @@ public:
     double getTimeInSeconds() const override;
     void resetState() override;
     void recenterOrientation(const Eigen::Quaternionf& q_pose) override;
+    IStateFilterSnapshot *allocateStateSnapshot() const override;
+    void saveStateSnapshot(IStateFilterSnapshot *snapshot) const override;
+    void restoreStateSnapshot(const IStateFilterSnapshot *snapshot) override;
 
     // -- IOrientationFilter --
     bool init(const PositionFilterConstants &constant) override;
@@ -55,6 +58,10 @@ class PositionFilterLowPassExponential : public PositionFilter
 {
 public:
 	void update(const float delta_time, const PoseFilterPacket &packet) override;
+
+	// The blend history isn't part of the snapshot state
+	IStateFilterSnapshot *allocateStateSnapshot() const override { return nullptr; }
+
 	std::list<float> deltaTimeHistory;
 	std::list<Eigen::Vector3f> blendedPositionHistory;
 };
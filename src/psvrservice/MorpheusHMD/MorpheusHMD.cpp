@@ -6,6 +6,7 @@
 #include "HidHMDDeviceEnumerator.h"
 #include "MathUtility.h"
 #include "Logger.h"
+#include "TimelineTrace.h"
 #include "Utility.h"
 #include "USBDeviceManager.h"
 #include "WorkerThread.h"
@@ -222,6 +223,11 @@ protected:
 
 		if (res > 0)
 		{
+			// Stamp the report as soon as it arrives, before spending any time on it
+			const t_service_timepoint capture_timestamp= ServiceClock::now();
+
+			PSVR_TRACE_ZONE("Morpheus Sensor Report");
+
 			// https://github.com/hrl7/node-psvr/blob/master/lib/psvr.js
 			MorpheusHMDSensorState newState;
 
@@ -232,7 +238,7 @@ protected:
 			// Processes the IMU data
 			newState.parse_data_input(&m_cfg, m_rawHIDPacket);
 
-			m_hmdListener->notifySensorDataReceived(&newState);
+			m_hmdListener->notifySensorDataReceived(&newState, capture_timestamp);
 		}
 		else if (res < 0)
 		{
@@ -32,6 +32,9 @@ const PSVR_HSVColorRange g_default_color_presets[] = {
 };
 const PSVR_HSVColorRange *k_default_color_presets = g_default_color_presets;
 
+//-- statics -----
+static std::string g_config_directory_override;
+
 PSVRConfig::PSVRConfig(const std::string &fnamebase)
 : ConfigFileBase(fnamebase)
 {
@@ -40,8 +43,17 @@ PSVRConfig::PSVRConfig(const std::string &fnamebase)
 const std::string
 PSVRConfig::getConfigPath()
 {
-    std::string home_dir= Utility::get_home_directory();  
-    std::string config_path = home_dir + "/PSVRSERVICE";
+    std::string config_path;
+
+    if (g_config_directory_override.empty())
+    {
+        std::string home_dir= Utility::get_home_directory();  
+        config_path = home_dir + "/PSVRSERVICE";
+    }
+    else
+    {
+        config_path = g_config_directory_override;
+    }
     
     if (!Utility::create_directory(config_path))
     {
@@ -53,6 +65,12 @@ PSVRConfig::getConfigPath()
     return config_filepath;
 }
 
+void
+PSVRConfig::setConfigDirectoryOverride(const std::string &directory)
+{
+    g_config_directory_override= directory;
+}
+
 void
 PSVRConfig::save()
 {
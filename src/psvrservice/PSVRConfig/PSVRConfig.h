@@ -35,6 +35,10 @@ public:
 	void save(const std::string &path);
     bool load();
 	bool load(const std::string &path);
+
+	// Redirect every config to the given directory instead of <home>/PSVRSERVICE
+	// (e.g. so a benchmark run doesn't touch the user's settings). Empty restores the default.
+	static void setConfigDirectoryOverride(const std::string &directory);
     
     std::string ConfigFileBase;
 
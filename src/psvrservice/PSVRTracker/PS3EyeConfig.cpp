@@ -6,6 +6,8 @@ PS3EyeTrackerConfig::PS3EyeTrackerConfig(const std::string &fnamebase)
     : CommonTrackerConfig(fnamebase)
 	, ps3eye_video_mode_index(-1)
     , fovSetting(BlueDot)
+	, frame_queue_depth(3)
+	, process_every_frame(false)
 {
 	CommonTrackerConfig::current_mode= "640x480(60FPS)";
 
@@ -36,6 +38,8 @@ PS3EyeTrackerConfig::writeToJSON()
 
 	pt["fovSetting"]= static_cast<int>(fovSetting);
 	pt["ps3eye_video_mode_index"]= ps3eye_video_mode_index;
+	pt["frame_queue_depth"]= frame_queue_depth;
+	pt["process_every_frame"]= process_every_frame;
 
     writeMatrix3d(pt, "camera_matrix", trackerIntrinsics.camera_matrix);
     writeDistortionCoefficients(pt, "distortion", &trackerIntrinsics.distortion_coefficients);
@@ -64,4 +68,6 @@ PS3EyeTrackerConfig::readFromJSON(const configuru::Config &pt)
 	fovSetting = 
 		static_cast<PS3EyeTrackerConfig::eFOVSetting>(
 			pt.get_or<int>("fovSetting", PS3EyeTrackerConfig::eFOVSetting::BlueDot));
+	frame_queue_depth= pt.get_or<int>("frame_queue_depth", frame_queue_depth);
+	process_every_frame= pt.get_or<bool>("process_every_frame", process_every_frame);
 }
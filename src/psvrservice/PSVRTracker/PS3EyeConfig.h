@@ -30,6 +30,8 @@ public:
 
 	int ps3eye_video_mode_index;
     eFOVSetting fovSetting;    
+	int frame_queue_depth; // Video frames buffered between the USB thread and the tracker
+	bool process_every_frame; // Hand every video frame to the tracker instead of only the latest one (for recording)
     PSVRMonoTrackerIntrinsics trackerIntrinsics;
 };
 
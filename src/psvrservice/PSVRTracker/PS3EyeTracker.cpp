@@ -26,6 +26,7 @@ PS3EyeTracker::PS3EyeTracker()
     , m_deviceIdentifier()
     , m_videoDevice(nullptr)
     , m_DriverType(PS3EyeTracker::Winusb)
+	, m_listener(nullptr)
 {
 }
 
@@ -168,7 +169,8 @@ bool PS3EyeTracker::open(const DeviceEnumerator *enumerator)
 
 bool PS3EyeTracker::getIsOpen() const
 {
-    return m_videoDevice != nullptr && m_videoDevice->isStreaming();
+    // A camera that's still being set up counts as open, its video stream is on the way
+    return m_videoDevice != nullptr && (m_videoDevice->isStreaming() || m_videoDevice->isOpening());
 }
 
 void PS3EyeTracker::close()
@@ -287,15 +289,18 @@ bool PS3EyeTracker::setTrackerMode(const std::string mode_name)
 	{		
 		ePS3EyeVideoMode desiredVideoMode= 
 			PS3EyeVideoDevice::findBestVideoMode(
-				(unsigned int)m_currentMode->bufferPixelWidth,
-				(unsigned int)m_currentMode->bufferPixelHeight,
-				(unsigned int)m_currentMode->frameRate);
+				(unsigned int)new_mode->bufferPixelWidth,
+				(unsigned int)new_mode->bufferPixelHeight,
+				(unsigned int)new_mode->frameRate);
 
 		m_cfg.trackerIntrinsics= new_mode->intrinsics.intrinsics.mono;
 		m_currentMode= new_mode;
 
+		// Restart the camera in the new mode.
+		// This doesn't wait on the camera, the stream comes back once it's set up.
 		if (desiredVideoMode != PS3EyeVideoMode_INVALID)
 		{
+			m_videoDevice->close();
 			m_videoDevice->open(desiredVideoMode, m_cfg, m_listener);
 		}
 
@@ -412,4 +417,12 @@ void PS3EyeTracker::getTrackingColorPreset(
 void PS3EyeTracker::setTrackerListener(ITrackerListener *listener)
 {
 	m_listener= listener;
+}
+
+void PS3EyeTracker::getDeviceStatistics(PSVRTrackerStatistics &out_statistics) const
+{
+	if (m_videoDevice != nullptr)
+	{
+		m_videoDevice->getStatistics(out_statistics);
+	}
 }
\ No newline at end of file
@@ -53,15 +53,22 @@
 //-- includes -----
 #include "PS3EyeVideo.h"
 #include "DeviceInterface.h"
+#include "LatencyHistogram.h"
 #include "Logger.h"
+#include "ServiceClock.h"
+#include "TimelineTrace.h"
 #include "Utility.h"
 #include "USBDeviceManager.h"
 #include "WorkerThread.h"
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <functional>
 #include <iomanip>
+#include <memory>
 #include <string>
+#include <vector>
 
 
 //-- constants -----
@@ -80,6 +87,16 @@
 #define OV534_OP_READ_2		0xf9
 
 #define CTRL_TIMEOUT 500
+// How many times to read the SCCB status register before giving up on an SCCB operation
+#define SCCB_STATUS_POLL_ATTEMPTS 5
+// How long the bridge and the sensor need to come back after being reset
+#define BRIDGE_RESET_SETTLE_MS 100
+#define SENSOR_RESET_SETTLE_MS 10
+// The USB thread wakes the frame processor as each frame completes, this is just a backstop
+#define FRAME_WAIT_TIMEOUT_MS 100
+// One slot for the USB thread to assemble into, one for the processor thread to read from, one to publish into
+#define MIN_FRAME_QUEUE_DEPTH 3
+#define MAX_FRAME_QUEUE_DEPTH 16
 #define VGA	 0
 #define QVGA 1
 
@@ -310,58 +327,570 @@ static const uint8_t sensor_start_qvga[][2] = {
 };
 
 //-- private methods -----
-static void init_camera(t_usb_device_handle device_handle, const PS3EyeVideoModeInfo &video_mode);
+class OV534RegisterBatch;
+class PS3EyeOpenSequence;
+
+static void add_open_sequence_steps(PS3EyeOpenSequence &sequence, const PS3EyeVideoModeInfo &video_mode);
 
 static void set_autogain(t_usb_device_handle device_handle, bool bAutoGain, uint8_t gain, uint8_t exposure);
-static void set_auto_white_balance(t_usb_device_handle device_handle, bool bAutoWhiteBalance);
-static void set_gain(t_usb_device_handle handle, unsigned char val);
-static void set_exposure(t_usb_device_handle handle, unsigned char val);
-static void set_sharpness(t_usb_device_handle device_handle,unsigned char val);
-static void set_contrast(t_usb_device_handle device_handle, unsigned char val);
-static void set_brightness(t_usb_device_handle device_handle, unsigned char val);
-static void set_hue(t_usb_device_handle device_handle, unsigned char val);
-static void set_red_balance(t_usb_device_handle device_handle, unsigned char val);
-static void set_green_balance(t_usb_device_handle device_handle, unsigned char val);
-static void set_blue_balance(t_usb_device_handle device_handle, unsigned char val);
+static void set_auto_white_balance(OV534RegisterBatch &batch, bool bAutoWhiteBalance);
+static void set_gain(OV534RegisterBatch &batch, unsigned char val);
+static void set_exposure(OV534RegisterBatch &batch, unsigned char val);
+static void set_sharpness(OV534RegisterBatch &batch, unsigned char val);
+static void set_contrast(OV534RegisterBatch &batch, unsigned char val);
+static void set_brightness(OV534RegisterBatch &batch, unsigned char val);
+static void set_hue(OV534RegisterBatch &batch, unsigned char val);
+static void set_red_balance(OV534RegisterBatch &batch, unsigned char val);
+static void set_green_balance(OV534RegisterBatch &batch, unsigned char val);
+static void set_blue_balance(OV534RegisterBatch &batch, unsigned char val);
+static bool set_video_property(OV534RegisterBatch &batch, PSVRVideoPropertyType property_type, int value);
 static void set_flip(t_usb_device_handle device_handle, bool horizontal, bool vertical);
-static void set_frame_rate(t_usb_device_handle device_handle, const PS3EyeVideoModeInfo &video_mode);
+static uint8_t get_flip_register_value(uint8_t reg_0x0C, bool horizontal, bool vertical);
+static void set_frame_rate(OV534RegisterBatch &batch, const PS3EyeVideoModeInfo &video_mode);
 
 static void sccb_reg_write(t_usb_device_handle device_handle, uint8_t reg, uint8_t val);
-static void sccb_reg_write_array(t_usb_device_handle device_handle, const uint8_t (*sequence)[2], int sequenceLength);
 static uint8_t sccb_reg_read(t_usb_device_handle device_handle, uint16_t reg);
-static bool sccb_check_status(t_usb_device_handle device_handle);
-
-static void ov534_reg_write(t_usb_device_handle device_handle, uint16_t reg, uint8_t val);
-static void ov534_reg_write_array(t_usb_device_handle device_handle, const uint8_t (*sequence)[2], int sequenceLength);
-static uint8_t ov534_reg_read(t_usb_device_handle device_handle, uint16_t reg);
-static void ov534_set_led(t_usb_device_handle device_handle, bool bLedOn);
 
 static void log_usb_result_code(const char *function_name, eUSBResultCode result_code);
 
+//-- OV534RegisterBatch -----
+// Builds up a sequence of OV534 bridge and SCCB sensor register accesses
+// that the USB worker thread runs back to back as a single request,
+// instead of the main thread waiting on every control transfer (and SCCB status check) in turn.
+class OV534RegisterBatch
+{
+public:
+	void ov534RegWrite(uint16_t reg, uint8_t val)
+	{
+		addOp(reg, val, val, _USBControlTransferBatchOp_Write, 1);
+	}
+
+	void ov534RegRead(uint16_t reg)
+	{
+		addOp(reg, 0, 0, _USBControlTransferBatchOp_Read, 1);
+	}
+
+	void sccbRegWrite(uint8_t reg, uint8_t val)
+	{
+		ov534RegWrite(OV534_REG_SUBADDR, reg);
+		ov534RegWrite(OV534_REG_WRITE, val);
+		ov534RegWrite(OV534_REG_OPERATION, OV534_OP_WRITE_3);
+		sccbWaitForStatus();
+	}
+
+	void sccbRegRead(uint16_t reg)
+	{
+		ov534RegWrite(OV534_REG_SUBADDR, (uint8_t)reg);
+		ov534RegWrite(OV534_REG_OPERATION, OV534_OP_WRITE_2);
+		sccbWaitForStatus();
+		ov534RegWrite(OV534_REG_OPERATION, OV534_OP_READ_2);
+		sccbWaitForStatus();
+		ov534RegRead(OV534_REG_READ);
+	}
+
+	void ov534RegWriteArray(const uint8_t (*sequence)[2], int sequenceLength)
+	{
+		for (int index = 0; index < sequenceLength; ++index)
+		{
+			ov534RegWrite(sequence[index][0], sequence[index][1]);
+		}
+	}
+
+	void sccbRegWriteArray(const uint8_t (*sequence)[2], int sequenceLength)
+	{
+		for (int index = 0; index < sequenceLength; ++index)
+		{
+			if (sequence[index][0] != 0xff) 
+			{
+				sccbRegWrite(sequence[index][0], sequence[index][1]);
+			}
+			else 
+			{
+				sccbRegRead(sequence[index][1]);
+				sccbRegWrite(0xff, 0x00);
+			}
+		}
+	}
+
+	/* Two bits control LED: 0x21 bit 7 and 0x23 bit 7.
+	 * (direction and output)? */
+	void ov534SetLed(bool bLedOn)
+	{
+		addOp(0x21, 0x80, 0x80, _USBControlTransferBatchOp_SetBits, 1);
+
+		if (bLedOn)
+			addOp(0x23, 0x80, 0x80, _USBControlTransferBatchOp_SetBits, 1);
+		else
+			addOp(0x23, 0x80, 0x80, _USBControlTransferBatchOp_ClearBits, 1);
+
+		if (!bLedOn)
+		{
+			addOp(0x21, 0x80, 0x80, _USBControlTransferBatchOp_ClearBits, 1);
+		}
+	}
+
+	inline bool isEmpty() const { return m_ops.empty(); }
+
+	// Runs the batch on the USB worker thread and blocks until it's done.
+	// Returns the value of the last register read (0 if the batch failed).
+	uint8_t submit(t_usb_device_handle device_handle, const char *function_name)
+	{
+		if (m_ops.empty())
+			return 0;
+
+		USBTransferRequest request;
+		initRequest(request, device_handle, m_ops);
+
+		USBTransferResult result= usb_device_submit_transfer_request_blocking(request);
+		m_ops.clear();
+
+		return getBatchSucceeded(result, function_name) ? result.payload.control_transfer_batch.last_read_value : 0;
+	}
+
+	// Hands the batch to the USB worker thread and returns right away.
+	// The callback fires from the USB device manager update (on the main thread) once the whole batch is done.
+	// Returns false if the request wasn't queued, in which case the callback may or may not have fired already
+	// (it does when USB transfers are shut off, it doesn't when the request queue is full).
+	// The callback gets the value of the last register read (0 if the batch failed).
+	bool submitAsync(
+		t_usb_device_handle device_handle, 
+		const char *function_name, 
+		std::function<void(bool bSuccess, uint8_t last_read_value)> callback)
+	{
+		if (m_ops.empty())
+			return false;
+
+		// The worker thread reads the ops until the batch completes, so the result callback owns them
+		std::shared_ptr<std::vector<USBControlTransferBatchOp>> ops= 
+			std::make_shared<std::vector<USBControlTransferBatchOp>>();
+		ops->swap(m_ops);
+
+		USBTransferRequest request;
+		initRequest(request, device_handle, *ops);
+
+		return usb_device_submit_transfer_request_async(
+			request,
+			[ops, function_name, callback](USBTransferResult &result) {
+				const bool bSuccess= getBatchSucceeded(result, function_name);
+
+				callback(bSuccess, bSuccess ? result.payload.control_transfer_batch.last_read_value : 0);
+			});
+	}
+
+private:
+	static void initRequest(
+		USBTransferRequest &request, 
+		t_usb_device_handle device_handle, 
+		const std::vector<USBControlTransferBatchOp> &ops)
+	{
+		memset(&request, 0, sizeof(USBTransferRequest));
+		request.request_type= eUSBTransferRequestType::_USBRequestType_ControlTransferBatch;
+		request.payload.control_transfer_batch.usb_device_handle= device_handle;
+		request.payload.control_transfer_batch.bmRequestType= USB_REQUEST_TYPE_VENDOR | USB_RECIPIENT_DEVICE;
+		request.payload.control_transfer_batch.bRequest= 0x01;
+		request.payload.control_transfer_batch.wValue= 0x00;
+		request.payload.control_transfer_batch.timeout= CTRL_TIMEOUT;
+		request.payload.control_transfer_batch.ops= ops.data();
+		request.payload.control_transfer_batch.op_count= static_cast<int>(ops.size());
+	}
+
+	static bool getBatchSucceeded(const USBTransferResult &result, const char *function_name)
+	{
+		assert(result.result_type == eUSBTransferResultType::_USBResultType_ControlTransferBatch);
+		const USBResultPayload_ControlTransferBatch &batch_result= result.payload.control_transfer_batch;
+
+		if (batch_result.result_code != eUSBResultCode::_USBResultCode_Completed)
+		{
+			log_usb_result_code(function_name, batch_result.result_code);
+			return false;
+		}
+
+		if (batch_result.failed_poll_count > 0)
+		{
+			PSVR_LOG_WARNING(function_name) << batch_result.failed_poll_count << " sccb operation(s) failed";
+			return false;
+		}
+
+		return true;
+	}
+
+	void addOp(uint16_t reg, uint8_t val, uint8_t fail_val, eUSBControlTransferBatchOpType op_type, uint8_t max_attempts)
+	{
+		USBControlTransferBatchOp op;
+		op.wIndex= reg;
+		op.value= val;
+		op.fail_value= fail_val;
+		op.op_type= static_cast<unsigned char>(op_type);
+		op.max_attempts= max_attempts;
+
+		m_ops.push_back(op);
+	}
+
+	// The SCCB status register reads 0x00 once the sensor finished the operation,
+	// 0x03 while it's still busy and 0x04 if the operation failed (no point in polling any longer)
+	void sccbWaitForStatus()
+	{
+		addOp(OV534_REG_STATUS, 0x00, 0x04, _USBControlTransferBatchOp_PollRead, SCCB_STATUS_POLL_ATTEMPTS);
+	}
+
+	std::vector<USBControlTransferBatchOp> m_ops;
+};
+
+//-- PS3EyeVideoPropertyQueue -----
+// Applies video property changes to the camera without making the caller wait on the SCCB bus.
+// Only one register batch is in flight at a time; changes that come in meanwhile (e.g. a slider drag)
+// collapse to the latest value per property and go out together in the next batch.
+// Only touched on the main thread: changes come from the service request handler
+// and batch completions from the USB device manager update.
+class PS3EyeVideoPropertyQueue : public std::enable_shared_from_this<PS3EyeVideoPropertyQueue>
+{
+public:
+	PS3EyeVideoPropertyQueue(t_usb_device_handle device_handle)
+		: m_usbDeviceHandle(device_handle)
+		, m_trackerListener(nullptr)
+		, m_pendingPropertyMask(0)
+		, m_bIsBatchInFlight(false)
+		, m_bIsHeld(false)
+	{
+		memset(m_pendingValues, 0, sizeof(m_pendingValues));
+	}
+
+	inline void setTrackerListener(ITrackerListener *listener) { m_trackerListener= listener; }
+	inline bool getIsBatchInFlight() const { return m_bIsBatchInFlight; }
+
+	// Keeps changes from going out while the camera gets set up (they collect until release())
+	inline void hold() { m_bIsHeld= true; }
+
+	void release()
+	{
+		m_bIsHeld= false;
+
+		if (m_pendingPropertyMask != 0 && !m_bIsBatchInFlight && m_usbDeviceHandle != k_invalid_usb_device_handle)
+		{
+			submitPendingProperties();
+		}
+	}
+
+	void enqueue(PSVRVideoPropertyType property_type, int value)
+	{
+		if (m_usbDeviceHandle == k_invalid_usb_device_handle)
+			return;
+
+		m_pendingValues[property_type]= value;
+		m_pendingPropertyMask|= (1u << property_type);
+
+		if (!m_bIsBatchInFlight && !m_bIsHeld)
+		{
+			submitPendingProperties();
+		}
+	}
+
+	// Blocks until the batch in flight (if any) is done, then drops anything still pending.
+	// Called before the USB device gets closed.
+	void disconnect()
+	{
+		m_pendingPropertyMask= 0;
+
+		while (m_bIsBatchInFlight)
+		{
+			usb_device_wait_for_transfer_results();
+		}
+
+		m_usbDeviceHandle= k_invalid_usb_device_handle;
+		m_trackerListener= nullptr;
+	}
+
+private:
+	struct PropertyValue
+	{
+		PSVRVideoPropertyType property_type;
+		int value;
+	};
+
+	void submitPendingProperties()
+	{
+		OV534RegisterBatch batch;
+		std::vector<PropertyValue> properties;
+
+		for (int prop_index = 0; prop_index < PSVRVideoProperty_COUNT; ++prop_index)
+		{
+			if ((m_pendingPropertyMask & (1u << prop_index)) != 0)
+			{
+				const PropertyValue property= {(PSVRVideoPropertyType)prop_index, m_pendingValues[prop_index]};
+
+				if (set_video_property(batch, property.property_type, property.value))
+				{
+					properties.push_back(property);
+				}
+			}
+		}
+
+		m_pendingPropertyMask= 0;
+
+		if (batch.isEmpty())
+			return;
+
+		// The callback keeps the queue alive in case the device goes away first
+		std::shared_ptr<PS3EyeVideoPropertyQueue> self= shared_from_this();
+
+		m_bIsBatchInFlight= true;
+		if (!batch.submitAsync(
+				m_usbDeviceHandle,
+				"PS3EyeVideoPropertyQueue",
+				[self, properties](bool bSuccess, uint8_t last_read_value) {
+					self->onBatchCompleted(properties, bSuccess);
+				}) &&
+			m_bIsBatchInFlight)
+		{
+			// The batch never got queued and nobody heard about it yet,
+			// so report the properties as failed rather than silently dropping them
+			onBatchCompleted(properties, false);
+		}
+	}
+
+	void onBatchCompleted(const std::vector<PropertyValue> &properties, bool bSuccess)
+	{
+		m_bIsBatchInFlight= false;
+
+		if (m_trackerListener != nullptr)
+		{
+			for (const PropertyValue &property : properties)
+			{
+				m_trackerListener->notifyVideoPropertyApplied(property.property_type, property.value, bSuccess);
+			}
+		}
+
+		// Send whatever piled up while this batch was out
+		if (m_pendingPropertyMask != 0 && !m_bIsHeld && m_usbDeviceHandle != k_invalid_usb_device_handle)
+		{
+			submitPendingProperties();
+		}
+	}
+
+	t_usb_device_handle m_usbDeviceHandle;
+	ITrackerListener *m_trackerListener;
+	int m_pendingValues[PSVRVideoProperty_COUNT];
+	unsigned int m_pendingPropertyMask;
+	bool m_bIsBatchInFlight;
+	bool m_bIsHeld;
+};
+
+//-- PS3EyeOpenSequence -----
+// Brings a camera up to streaming as a short chain of register batches on the USB worker thread.
+// Each step goes out once the previous one is done (and the camera had time to settle after a reset),
+// so cameras opening or switching modes at the same time wait on their steps side by side instead of in turn.
+// Only touched on the main thread: steps get sent from PS3EyeVideoDevice::updatePendingOpens()
+// and completions come in from the USB device manager update.
+class PS3EyeOpenSequence : public std::enable_shared_from_this<PS3EyeOpenSequence>
+{
+public:
+	// Fills in the batch for a step given the last register value the previous step read
+	typedef std::function<void(OV534RegisterBatch &batch, uint8_t last_read_value)> t_build_step;
+
+	PS3EyeOpenSequence(
+		t_usb_device_handle device_handle, 
+		std::shared_ptr<PS3EyeVideoPropertyQueue> property_queue)
+		: m_usbDeviceHandle(device_handle)
+		, m_propertyQueue(property_queue)
+		, m_stepIndex(0)
+		, m_lastReadValue(0)
+		, m_nextStepTime()
+		, m_bIsStepInFlight(false)
+		, m_bIsRunning(false)
+	{
+	}
+
+	void addStep(const char *step_name, t_build_step build_step, int settle_time_ms= 0)
+	{
+		const Step step= {step_name, build_step, settle_time_ms};
+
+		m_steps.push_back(step);
+	}
+
+	// The callback fires once the last step is done, unless the sequence gets canceled first
+	void start(std::function<void()> on_finished)
+	{
+		m_onFinished= on_finished;
+		m_stepIndex= 0;
+		m_lastReadValue= 0;
+		m_nextStepTime= std::chrono::high_resolution_clock::now();
+		m_bIsRunning= true;
+
+		s_runningSequences.push_back(shared_from_this());
+		update();
+	}
+
+	// Blocks until the step in flight (if any) is done and drops the rest
+	void cancel()
+	{
+		m_onFinished= nullptr;
+
+		while (m_bIsStepInFlight)
+		{
+			usb_device_wait_for_transfer_results();
+		}
+
+		m_bIsRunning= false;
+	}
+
+	inline bool getIsRunning() const { return m_bIsRunning; }
+
+	static void updateAll()
+	{
+		// Steps can finish a sequence (and start a new one) from in here
+		std::vector<std::shared_ptr<PS3EyeOpenSequence>> sequences= s_runningSequences;
+
+		for (std::shared_ptr<PS3EyeOpenSequence> &sequence : sequences)
+		{
+			sequence->update();
+		}
+
+		s_runningSequences.erase(
+			std::remove_if(
+				s_runningSequences.begin(), s_runningSequences.end(),
+				[](const std::shared_ptr<PS3EyeOpenSequence> &sequence) { return !sequence->getIsRunning(); }),
+			s_runningSequences.end());
+	}
+
+	static void waitForAll()
+	{
+		updateAll();
+
+		while (!s_runningSequences.empty())
+		{
+			usb_device_wait_for_transfer_results();
+			updateAll();
+		}
+	}
+
+private:
+	struct Step
+	{
+		const char *step_name;
+		t_build_step build_step;
+		int settle_time_ms;
+	};
+
+	void update()
+	{
+		if (!m_bIsRunning || m_bIsStepInFlight)
+			return;
+
+		// Give the camera time to settle after the previous step,
+		// and let a property change already on its way to the camera land first
+		if (std::chrono::high_resolution_clock::now() < m_nextStepTime || m_propertyQueue->getIsBatchInFlight())
+			return;
+
+		const Step &step= m_steps[m_stepIndex];
+
+		OV534RegisterBatch batch;
+		step.build_step(batch, m_lastReadValue);
+
+		// The callback keeps the sequence alive in case the device goes away first
+		std::shared_ptr<PS3EyeOpenSequence> self= shared_from_this();
+
+		m_bIsStepInFlight= true;
+		if (!batch.submitAsync(
+				m_usbDeviceHandle,
+				step.step_name,
+				[self](bool bSuccess, uint8_t last_read_value) {
+					self->onStepCompleted(last_read_value);
+				}) &&
+			m_bIsStepInFlight)
+		{
+			// The step never got queued and its callback didn't fire, carry on as if it failed
+			onStepCompleted(0);
+		}
+	}
+
+	void onStepCompleted(uint8_t last_read_value)
+	{
+		m_bIsStepInFlight= false;
+
+		if (!m_bIsRunning || !m_onFinished)
+			return;
+
+		// A failed step has already been logged by the batch.
+		// Just like the blocking register writes this replaced, the rest of the steps still go out.
+		m_lastReadValue= last_read_value;
+		m_nextStepTime= 
+			std::chrono::high_resolution_clock::now() + 
+			std::chrono::milliseconds(m_steps[m_stepIndex].settle_time_ms);
+		++m_stepIndex;
+
+		if (m_stepIndex >= static_cast<int>(m_steps.size()))
+		{
+			std::function<void()> on_finished= m_onFinished;
+
+			m_onFinished= nullptr;
+			m_bIsRunning= false;
+			on_finished();
+		}
+		else
+		{
+			// Send the next step right away unless the camera needs time to settle
+			update();
+		}
+	}
+
+	static std::vector<std::shared_ptr<PS3EyeOpenSequence>> s_runningSequences;
+
+	t_usb_device_handle m_usbDeviceHandle;
+	std::shared_ptr<PS3EyeVideoPropertyQueue> m_propertyQueue;
+	std::vector<Step> m_steps;
+	std::function<void()> m_onFinished;
+	int m_stepIndex;
+	uint8_t m_lastReadValue;
+	std::chrono::time_point<std::chrono::high_resolution_clock> m_nextStepTime;
+	bool m_bIsStepInFlight;
+	bool m_bIsRunning;
+};
+std::vector<std::shared_ptr<PS3EyeOpenSequence>> PS3EyeOpenSequence::s_runningSequences;
+
 //-- PS3EyeVideoFrameProcessor -----
+// Single producer (USB thread), single consumer (frame processor thread) ring of bayer frames.
+// The USB thread always owns exactly one slot that it's assembling the next frame in,
+// and the processor thread claims a slot before handing it to the tracker,
+// so neither side can ever touch a buffer the other one is using.
+// Each slot is stamped with the sequence number of the frame it holds (0 = nothing to deliver).
 class PS3EyeFrameProcessorThread : public WorkerThread
 {
 public:
-	PS3EyeFrameProcessorThread(const PS3EyeVideoModeInfo &video_mode, ITrackerListener *trackerListener)
+	PS3EyeFrameProcessorThread(
+		const PS3EyeVideoModeInfo &video_mode,
+		int frame_queue_depth,
+		bool bProcessEveryFrame,
+		ITrackerListener *trackerListener)
 		: WorkerThread(std::string("PS3EyeVideoFrameProcessor"))
-		, m_maxCompressedFrameCount(3)
-		, m_compressedFrameWriteIndex({0})
-		, m_compressedFrameReadIndex({0})
+		, m_maxCompressedFrameCount(std::min(std::max(frame_queue_depth, MIN_FRAME_QUEUE_DEPTH), MAX_FRAME_QUEUE_DEPTH))
+		, m_bProcessEveryFrame(bProcessEveryFrame)
+		, m_compressedFrameWriteIndex(0)
+		, m_compressedFrameReadIndex({-1})
 		, m_frameWidth(video_mode.width)
 		, m_frameHeight(video_mode.height)
 		, m_compressedFramesBuffer(nullptr)
-		, m_uncompressedFrameBuffer(nullptr)
 		, m_compressedFrameSizeBytes(video_mode.width*video_mode.height) // Bayer Buffer = 1 byte per pixel
-		, m_uncompressedFrameSizeBytes(3*video_mode.width*video_mode.height) // RBG Buffer = 3 bytes per pixel
+		, m_compressedFrameSequenceNumbers(nullptr)
+		, m_compressedFrameCaptureTimes(nullptr)
+		, m_lastDeliveredSequenceNumber({0})
+		, m_completeFrameCount({0})
+		, m_droppedFrameCount({0})
+		, m_overwrittenFrameCount({0})
 		, m_trackerListener(trackerListener)
 	{
         if (m_compressedFrameSizeBytes > 0)
         {
             m_compressedFramesBuffer = new uint8_t[m_compressedFrameSizeBytes*m_maxCompressedFrameCount];
-            m_uncompressedFrameBuffer = new uint8_t[m_uncompressedFrameSizeBytes];
             memset(m_compressedFramesBuffer, 0, m_compressedFrameSizeBytes);
-            memset(m_uncompressedFrameBuffer, 0, m_uncompressedFrameSizeBytes);
         }
+
+		m_compressedFrameSequenceNumbers= new std::atomic<uint64_t>[m_maxCompressedFrameCount];
+		for (int slot_index = 0; slot_index < m_maxCompressedFrameCount; ++slot_index)
+		{
+			m_compressedFrameSequenceNumbers[slot_index]= 0;
+		}
+
+		m_compressedFrameCaptureTimes= new t_service_timepoint[m_maxCompressedFrameCount];
 	}
 
     virtual ~PS3EyeFrameProcessorThread()
@@ -372,11 +901,8 @@ public:
             m_compressedFramesBuffer= nullptr;
         } 
 
-        if (m_uncompressedFrameBuffer != nullptr)
-        {
-            delete[] m_uncompressedFrameBuffer;
-            m_uncompressedFrameBuffer= nullptr;
-        } 
+		delete[] m_compressedFrameSequenceNumbers;
+		delete[] m_compressedFrameCaptureTimes;
     }
 
 	uint32_t getCompressedFrameSizeBytes() const 
@@ -386,174 +912,209 @@ public:
 
 	uint8_t* getCompressedFrameBufferStart()
 	{
-		return m_compressedFramesBuffer;
+		return getSlotBuffer(m_compressedFrameWriteIndex);
 	}
 
-	uint8_t* enqueueCompressedFrame()
-	{
-		uint8_t* new_frame = nullptr;
+	// Frames the USB thread completed, and how many of those never made it to the tracker
+	inline uint64_t getCompleteFrameCount() const { return m_completeFrameCount.load(); }
+	inline uint64_t getDroppedFrameCount() const { return m_droppedFrameCount.load(); }
+	// Of the dropped frames, the ones a newer frame replaced before the tracker got to them
+	inline uint64_t getOverwrittenFrameCount() const { return m_overwrittenFrameCount.load(); }
 
+	uint8_t* enqueueCompressedFrame(const t_service_timepoint &capture_timestamp)
+	{
 		// Note: we don't need to copy any data to the buffer since the USB packets are directly written to the frame buffer.
-		// We just need to update head and available count to signal to the consumer that a new frame is available
-		m_compressedFrameWriteIndex = (m_compressedFrameWriteIndex + 1) % m_maxCompressedFrameCount;
+		// Every complete frame gets a sequence number, even the ones we end up dropping,
+		// so the consumer can tell which frames it never got.
+		const uint64_t sequence_number= m_completeFrameCount.load() + 1;
+		m_completeFrameCount= sequence_number;
+
+		// Claim the slot the next frame gets assembled in before giving up this one
+		const int next_write_index= claimNextWriteSlot();
+		if (next_write_index == -1)
+		{
+			// Every other slot is waiting on the processor thread and we aren't allowed to overwrite them.
+			// Drop this frame by assembling the next one on top of it.
+			return getSlotBuffer(m_compressedFrameWriteIndex);
+		}
+
+		// Publish the finished frame. The sequence number goes in last so the frame data is visible with it.
+		m_compressedFrameCaptureTimes[m_compressedFrameWriteIndex]= capture_timestamp;
+		m_compressedFrameSequenceNumbers[m_compressedFrameWriteIndex]= sequence_number;
+		m_compressedFrameWriteIndex= next_write_index;
 
-		// Determine the next frame pointer that the producer should write to
-		new_frame = m_compressedFramesBuffer + m_compressedFrameWriteIndex*m_compressedFrameSizeBytes;
+		// Hand the frame straight to the processor thread
+		signalWork();
 
-		return new_frame;
+		// The next frame pointer that the producer should write to
+		return getSlotBuffer(m_compressedFrameWriteIndex);
 	}
 
 protected:
-	// Called in a loop by the parent WorkerThread class
-	virtual bool doWork() override
+	inline uint8_t* getSlotBuffer(int slot_index)
 	{
-		bool bKeepGoing= false;
+		return m_compressedFramesBuffer + slot_index*m_compressedFrameSizeBytes;
+	}
 
-		if (!m_exitSignaled)
+	// USB thread only. Finds a slot other than the one just filled that is safe to assemble the next frame in.
+	// Returns -1 if there isn't one (only possible when every frame has to be processed).
+	int claimNextWriteSlot()
+	{
+		const uint64_t last_delivered_sequence_number= m_lastDeliveredSequenceNumber.load();
+		uint32_t rejected_slots= 0;
+
+		for (int attempt = 0; attempt < m_maxCompressedFrameCount; ++attempt)
 		{
-			// Send the uncompressed frame off to the tracker for processing
-			if (m_compressedFrameReadIndex != m_compressedFrameWriteIndex)
+			// Prefer a slot with nothing left to deliver, otherwise the oldest undelivered frame
+			int candidate_index= -1;
+			uint64_t candidate_sequence_number= 0;
+			for (int slot_index = 0; slot_index < m_maxCompressedFrameCount; ++slot_index)
 			{
-				// Get the current frame buffer
-				uint8_t* source = m_compressedFramesBuffer + m_compressedFrameReadIndex*m_compressedFrameSizeBytes;
+				if (slot_index == m_compressedFrameWriteIndex || (rejected_slots & (1 << slot_index)) != 0)
+					continue;
 
-				// Convert the bayer encoded frame to BGR
-				debayer(m_frameWidth, m_frameHeight, source, m_uncompressedFrameBuffer, true);
+				uint64_t slot_sequence_number= m_compressedFrameSequenceNumbers[slot_index].load();
+				if (slot_sequence_number <= last_delivered_sequence_number)
+				{
+					slot_sequence_number= 0;
+				}
 
-				// Notify the client
-				m_trackerListener->notifyVideoFrameReceived(m_uncompressedFrameBuffer);
+				if (candidate_index == -1 || slot_sequence_number < candidate_sequence_number)
+				{
+					candidate_index= slot_index;
+					candidate_sequence_number= slot_sequence_number;
+				}
+			}
 
-				// Advance to the next read buffer slot
-				m_compressedFrameReadIndex= (m_compressedFrameWriteIndex + 1) % m_maxCompressedFrameCount;
+			if (candidate_index == -1 || (m_bProcessEveryFrame && candidate_sequence_number != 0))
+			{
+				return -1;
 			}
-			else
+
+			// Pull the frame out from under the consumer, then make sure the consumer didn't just claim it.
+			// The consumer does the mirror image of this, so at most one of us gets the slot.
+			const uint64_t old_sequence_number= m_compressedFrameSequenceNumbers[candidate_index].exchange(0);
+			if (m_compressedFrameReadIndex.load() != candidate_index)
 			{
-				// Wait for the USB thread to post more data
-				Utility::sleep_ms(1);
+				if (candidate_sequence_number != 0)
+				{
+					// Latest frame wins: the tracker never sees this one
+					++m_overwrittenFrameCount;
+				}
+
+				return candidate_index;
 			}
 
-			bKeepGoing= true;
+			// The processor thread is reading it, leave it alone
+			m_compressedFrameSequenceNumbers[candidate_index]= old_sequence_number;
+			rejected_slots|= (1 << candidate_index);
 		}
 
-		return bKeepGoing;
+		return -1;
 	}
 
-	void debayer(int frame_width, int frame_height, const uint8_t* inBayer, uint8_t* outBuffer, bool inBGR)
+	// Processor thread only. Claims the next frame to deliver, or returns -1 if there isn't one.
+	int claimNextReadSlot(uint64_t &out_sequence_number)
 	{
-		// PSMove output is in the following Bayer format (GRBG):
-		//
-		// G R G R G R
-		// B G B G B G
-		// G R G R G R
-		// B G B G B G
-		//
-		// This is the normal Bayer pattern shifted left one place.
-
-		int				num_output_channels	    = 3;
-		int				source_stride			= frame_width;
-		const uint8_t*	source_row				= inBayer;												// Start at first bayer pixel
-		int				dest_stride				= frame_width * num_output_channels;
-		uint8_t*		dest_row				= outBuffer + dest_stride + num_output_channels + 1; 	// We start outputting at the second pixel of the second row's G component
-		int				swap_br					= inBGR ? 1 : -1;
-
-		// Fill rows 1 to height-1 of the destination buffer. First and last row are filled separately (they are copied from the second row and second-to-last rows respectively)
-		for (int y = 0; y < frame_height-1; source_row += source_stride, dest_row += dest_stride, ++y)
-		{
-			const uint8_t* source		= source_row;
-			const uint8_t* source_end	= source + (source_stride-2);								// -2 to deal with the fact that we're starting at the second pixel of the row and should end at the second-to-last pixel of the row (first and last are filled separately)
-			uint8_t* dest				= dest_row;		
+		const uint64_t last_delivered_sequence_number= m_lastDeliveredSequenceNumber.load();
 
-			// Row starting with Green
-			if (y % 2 == 0)
+		for (;;)
+		{
+			// Oldest undelivered frame when processing every frame, newest otherwise
+			int candidate_index= -1;
+			uint64_t candidate_sequence_number= 0;
+			for (int slot_index = 0; slot_index < m_maxCompressedFrameCount; ++slot_index)
 			{
-				// Fill first pixel (green)
-				dest[-1*swap_br]	= (source[source_stride] + source[source_stride + 2] + 1) >> 1;
-				dest[0]				= source[source_stride + 1];
-				dest[1*swap_br]		= (source[1] + source[source_stride * 2 + 1] + 1) >> 1;		
-
-				source++;
-				dest += num_output_channels;
-
-				// Fill remaining pixel
-				for (; source <= source_end - 2; source += 2, dest += num_output_channels * 2)
+				const uint64_t slot_sequence_number= m_compressedFrameSequenceNumbers[slot_index].load();
+				if (slot_sequence_number <= last_delivered_sequence_number)
+					continue;
+
+				if (candidate_index == -1 ||
+					(m_bProcessEveryFrame 
+						? slot_sequence_number < candidate_sequence_number
+						: slot_sequence_number > candidate_sequence_number))
 				{
-					// Blue pixel
-					uint8_t* cur_pixel	= dest;
-					cur_pixel[-1*swap_br]	= source[source_stride + 1];
-					cur_pixel[0]			= (source[1] + source[source_stride] + source[source_stride + 2] + source[source_stride * 2 + 1] + 2) >> 2;
-					cur_pixel[1*swap_br]	= (source[0] + source[2] + source[source_stride * 2] + source[source_stride * 2 + 2] + 2) >> 2;				
-
-					//  Green pixel
-					uint8_t* next_pixel		= cur_pixel+num_output_channels;
-					next_pixel[-1*swap_br]	= (source[source_stride + 1] + source[source_stride + 3] + 1) >> 1;					
-					next_pixel[0]			= source[source_stride + 2];
-					next_pixel[1*swap_br]	= (source[2] + source[source_stride * 2 + 2] + 1) >> 1;
+					candidate_index= slot_index;
+					candidate_sequence_number= slot_sequence_number;
 				}
 			}
-			else
+
+			if (candidate_index == -1)
 			{
-				for (; source <= source_end - 2; source += 2, dest += num_output_channels * 2)
-				{
-					// Red pixel
-					uint8_t* cur_pixel	= dest;
-					cur_pixel[-1*swap_br]	= (source[0] + source[2] + source[source_stride * 2] + source[source_stride * 2 + 2] + 2) >> 2;;
-					cur_pixel[0]			= (source[1] + source[source_stride] + source[source_stride + 2] + source[source_stride * 2 + 1] + 2) >> 2;;
-					cur_pixel[1*swap_br]	= source[source_stride + 1];
-
-					// Green pixel
-					uint8_t* next_pixel		= cur_pixel+num_output_channels;
-					next_pixel[-1*swap_br]	= (source[2] + source[source_stride * 2 + 2] + 1) >> 1;
-					next_pixel[0]			= source[source_stride + 2];
-					next_pixel[1*swap_br]	= (source[source_stride + 1] + source[source_stride + 3] + 1) >> 1;
-				}
+				return -1;
 			}
 
-			if (source < source_end)
+			// Claim the slot, then make sure the USB thread didn't just take it back
+			m_compressedFrameReadIndex= candidate_index;
+			if (m_compressedFrameSequenceNumbers[candidate_index].load() == candidate_sequence_number)
 			{
-				dest[-1*swap_br]	= source[source_stride + 1];
-				dest[0]				= (source[1] + source[source_stride] + source[source_stride + 2] + source[source_stride * 2 + 1] + 2) >> 2;			
-				dest[1*swap_br]		= (source[0] + source[2] + source[source_stride * 2] + source[source_stride * 2 + 2] + 2) >> 2;;			
-
-				source++;
-				dest += num_output_channels;
+				out_sequence_number= candidate_sequence_number;
+				return candidate_index;
 			}
 
-			// Fill first pixel of row (copy second pixel)
-			uint8_t* first_pixel		= dest_row-num_output_channels;
-			first_pixel[-1*swap_br]		= dest_row[-1*swap_br];
-			first_pixel[0]				= dest_row[0];
-			first_pixel[1*swap_br]		= dest_row[1*swap_br];
-		
- 			// Fill last pixel of row (copy second-to-last pixel). Note: dest row starts at the *second* pixel of the row, so dest_row + (width-2) * num_output_channels puts us at the last pixel of the row
-			uint8_t* last_pixel				= dest_row + (frame_width - 2)*num_output_channels;
-			uint8_t* second_to_last_pixel	= last_pixel - num_output_channels;
-			
-			last_pixel[-1*swap_br]			= second_to_last_pixel[-1*swap_br];
-			last_pixel[0]					= second_to_last_pixel[0];
-			last_pixel[1*swap_br]			= second_to_last_pixel[1*swap_br];
+			m_compressedFrameReadIndex= -1;
 		}
+	}
 
-		// Fill first & last row
-		for (int i = 0; i < dest_stride; i++)
+	// Called in a loop by the parent WorkerThread class
+	virtual bool doWork() override
+	{
+		bool bKeepGoing= false;
+
+		if (!m_exitSignaled)
 		{
-			outBuffer[i]									= outBuffer[i + dest_stride];
-			outBuffer[i + (frame_height - 1)*dest_stride]	= outBuffer[i + (frame_height - 2)*dest_stride];
+			// Send the raw bayer frame off to the tracker for processing.
+			// Demosaicing is deferred to the tracker so that it can be fused with color segmentation.
+			uint64_t sequence_number= 0;
+			const int read_index= claimNextReadSlot(sequence_number);
+
+			if (read_index != -1)
+			{
+				PSVR_TRACE_ZONE("PS3Eye Deliver Frame");
+
+				// Count the frames the USB thread finished since the last one we delivered, but that we never got
+				// (dropped or overwritten by the USB thread, or skipped over to get to the newest one)
+				m_droppedFrameCount+= sequence_number - m_lastDeliveredSequenceNumber.load() - 1;
+
+				// Notify the client
+				m_trackerListener->notifyVideoFrameReceived(getSlotBuffer(read_index), m_compressedFrameCaptureTimes[read_index]);
+
+				// Release the slot back to the USB thread
+				m_lastDeliveredSequenceNumber= sequence_number;
+				m_compressedFrameReadIndex= -1;
+			}
+			else
+			{
+				// Wait for the USB thread to post more data
+				waitForWork(std::chrono::milliseconds(FRAME_WAIT_TIMEOUT_MS));
+			}
+
+			bKeepGoing= true;
 		}
+
+		return bKeepGoing;
 	}
 
 protected:
 	// Queue State
-	uint32_t m_maxCompressedFrameCount;
-	std::atomic_uint32_t m_compressedFrameWriteIndex;
-	std::atomic_uint32_t m_compressedFrameReadIndex;
+	const int m_maxCompressedFrameCount;
+	const bool m_bProcessEveryFrame; // Queue every frame (recording) instead of only keeping the latest one (tracking)
+	int m_compressedFrameWriteIndex; // USB thread only
+	std::atomic_int m_compressedFrameReadIndex; // -1 when the processor thread isn't reading a slot
 
 	// Buffer State
 	int m_frameWidth;
 	int m_frameHeight;
 	uint8_t *m_compressedFramesBuffer;
-	uint8_t *m_uncompressedFrameBuffer;
     uint32_t m_compressedFrameSizeBytes;
-	uint32_t m_uncompressedFrameSizeBytes;
+
+	// Statistics
+	std::atomic<uint64_t> *m_compressedFrameSequenceNumbers; // sequence number of the frame in each buffer slot
+	t_service_timepoint *m_compressedFrameCaptureTimes; // time the last USB packet of the frame in each buffer slot arrived
+	std::atomic<uint64_t> m_lastDeliveredSequenceNumber; // written by the frame processor thread only
+	std::atomic<uint64_t> m_completeFrameCount;
+	std::atomic<uint64_t> m_droppedFrameCount;
+	std::atomic<uint64_t> m_overwrittenFrameCount;
 
 	// External Processing
 	ITrackerListener *m_trackerListener;
@@ -566,13 +1127,15 @@ class PS3EyeUSBPacketProcessor
 public:
     PS3EyeUSBPacketProcessor(
 		const PS3EyeVideoModeInfo &video_mode,
+		const PS3EyeTrackerConfig &cfg,
 		ITrackerListener *tracker_listener)
         : m_last_packet_type(DISCARD_PACKET)
         , m_lastPresentationTimestamp(0)
         , m_lastFieldID(0)
         , m_currentFrameStart(nullptr)
         , m_currentFrameBytesWritten(0)
-		, m_frameProcessorThread(new PS3EyeFrameProcessorThread(video_mode, tracker_listener))
+		, m_bIsLastTransferTimeValid(false)
+		, m_frameProcessorThread(new PS3EyeFrameProcessorThread(video_mode, cfg.frame_queue_depth, cfg.process_every_frame, tracker_listener))
     {	
         // Point the write pointer at the start of the bayer buffer
         m_currentFrameStart= m_frameProcessorThread->getCompressedFrameBufferStart();
@@ -629,9 +1192,35 @@ public:
 		delete m_frameProcessorThread;
     }
 
+	void getStatistics(PSVRTrackerStatistics &out_statistics) const
+	{
+		LatencyHistogramSnapshot transfer_interval_snapshot;
+		transfer_interval_snapshot.add(m_transferIntervalLatency);
+		transfer_interval_snapshot.getStatistics(out_statistics.stage_latency[PSVRTrackerStage_USBPacket]);
+
+		LatencyHistogramSnapshot frame_assembly_snapshot;
+		frame_assembly_snapshot.add(m_frameAssemblyLatency);
+		frame_assembly_snapshot.getStatistics(out_statistics.stage_latency[PSVRTrackerStage_FrameAssembly]);
+
+		out_statistics.device_frame_count= m_frameProcessorThread->getCompleteFrameCount();
+		out_statistics.device_dropped_frame_count= m_frameProcessorThread->getDroppedFrameCount();
+		out_statistics.device_overwritten_frame_count= m_frameProcessorThread->getOverwrittenFrameCount();
+	}
+
     static void usbBulkTransferCallback_usbThread(unsigned char *packet_data, int packet_length, void *userdata)
     {
+        PSVR_TRACE_ZONE("PS3Eye USB Transfer");
+
         PS3EyeUSBPacketProcessor *processor= reinterpret_cast<PS3EyeUSBPacketProcessor *>(userdata);
+		const std::chrono::high_resolution_clock::time_point now= std::chrono::high_resolution_clock::now();
+
+		// Gaps between transfers show up as frame assembly stalls further down
+		if (processor->m_bIsLastTransferTimeValid)
+		{
+			processor->m_transferIntervalLatency.recordDuration(now - processor->m_lastTransferTime);
+		}
+		processor->m_lastTransferTime= now;
+		processor->m_bIsLastTransferTimeValid= true;
 
         processor->packetScan_usbThread(packet_data, packet_length);
     }
@@ -727,6 +1316,7 @@ protected:
         if (packet_type == FIRST_PACKET) 
         {
             m_currentFrameBytesWritten = 0;
+            m_currentFrameStartTime= std::chrono::high_resolution_clock::now();
         } 
         else
         {
@@ -765,8 +1355,14 @@ protected:
 
         if (packet_type == LAST_PACKET)
         {
+            m_frameAssemblyLatency.recordDuration(std::chrono::high_resolution_clock::now() - m_currentFrameStartTime);
+            PSVR_TRACE_INSTANT("PS3Eye Frame Complete");
+
+            // The frame is as captured as it's going to get, so this is the time the tracking pipeline uses for it
+            const t_service_timepoint capture_timestamp= ServiceClock::now();
+
             m_currentFrameBytesWritten = 0;
-            m_currentFrameStart = m_frameProcessorThread->enqueueCompressedFrame();
+            m_currentFrameStart = m_frameProcessorThread->enqueueCompressedFrame(capture_timestamp);
         }
     }
 
@@ -777,6 +1373,13 @@ private:
     uint16_t m_lastFieldID;
     uint8_t* m_currentFrameStart;
     uint32_t m_currentFrameBytesWritten;
+    std::chrono::high_resolution_clock::time_point m_currentFrameStartTime;
+
+	// USB Packet Timing (written by the USB thread)
+	std::chrono::high_resolution_clock::time_point m_lastTransferTime;
+	bool m_bIsLastTransferTimeValid;
+	LatencyHistogram m_transferIntervalLatency;
+	LatencyHistogram m_frameAssemblyLatency;
     
 	// Frame Decompression Thread
 	PS3EyeFrameProcessorThread *m_frameProcessorThread;
@@ -811,12 +1414,23 @@ PS3EyeVideoDevice::PS3EyeVideoDevice(USBDeviceEnumerator* enumerator)
     , m_video_packet_processor(nullptr)
 {
 	memset(&m_properties, 0, sizeof(PS3EyeProperties));
+
+	if (m_usb_device_handle != k_invalid_usb_device_handle)
+	{
+		m_property_queue= std::make_shared<PS3EyeVideoPropertyQueue>(m_usb_device_handle);
+	}
 }
 
 PS3EyeVideoDevice::~PS3EyeVideoDevice()
 {
     close();
 
+	if (m_property_queue)
+	{
+		m_property_queue->disconnect();
+		m_property_queue.reset();
+	}
+
     if(m_usb_device_handle != k_invalid_usb_device_handle)
     {
 		usb_device_close(m_usb_device_handle);
@@ -869,28 +1483,17 @@ bool PS3EyeVideoDevice::open(
     if (m_usb_device_handle == k_invalid_usb_device_handle)
         return false;
 
-	// Bailed if the camera stream is already started
-    if (m_is_streaming)
+	// Bailed if the camera stream is already started (or on its way)
+    if (m_is_streaming || isOpening())
 		return true;
 
 	assert(desired_video_mode >= 0 && desired_video_mode < PS3EyeVideoMode_COUNT);
 	const PS3EyeVideoModeInfo &video_mode= k_supported_video_modes[desired_video_mode];
 
-    // Initialize the camera
-	init_camera(m_usb_device_handle, video_mode);
-   
-    if (video_mode.width == 320) // 320x240
-        ov534_reg_write_array(m_usb_device_handle, bridge_start_qvga, ARRAY_SIZE(bridge_start_qvga));
-    else // 640x480 
-        ov534_reg_write_array(m_usb_device_handle, bridge_start_vga, ARRAY_SIZE(bridge_start_vga));
-
-    if (video_mode.width == 320) // 320x240
-        sccb_reg_write_array(m_usb_device_handle, sensor_start_qvga, ARRAY_SIZE(sensor_start_qvga));
-    else // 640x480
-        sccb_reg_write_array(m_usb_device_handle, sensor_start_vga, ARRAY_SIZE(sensor_start_vga));
-
-	// Set the desired frame rate
-    set_frame_rate(m_usb_device_handle, video_mode);
+	// Property changes get reported back to the tracker once they land on the camera,
+	// but they can't go out before the camera is set up
+	m_property_queue->setTrackerListener(tracker_listener);
+	m_property_queue->hold();
 
 	// Remember the video frame properties
     m_properties.frame_width = video_mode.width;
@@ -957,34 +1560,77 @@ bool PS3EyeVideoDevice::open(
 	// Remember which video mode was last successfully opened
 	cfg.ps3eye_video_mode_index= desired_video_mode;
 
-	// Flip the image horizontally
-	set_flip(m_usb_device_handle, true, false);
+    // Initialize the camera and start the video stream on the USB worker thread.
+	// The USB video packet bulk transfers and the frame processor thread start once that's done.
+    m_video_packet_processor= new PS3EyeUSBPacketProcessor(video_mode, cfg, tracker_listener);
+	m_open_sequence= std::make_shared<PS3EyeOpenSequence>(m_usb_device_handle, m_property_queue);
+	add_open_sequence_steps(*m_open_sequence, video_mode);
+	m_open_sequence->start([this]() {
+		onOpenSequenceFinished();
+	});
 
-	// Turn on the "recording" LED
-    ov534_set_led(m_usb_device_handle, true);
+	return true;
+}
 
-	// Tell the camera to start the video stream
-    ov534_reg_write(m_usb_device_handle, 0xe0, 0x00);
+void PS3EyeVideoDevice::onOpenSequenceFinished()
+{
+	m_open_sequence.reset();
 
-    // Start the USB video packet bulk transfers and the frame processor thread
-    m_video_packet_processor= new PS3EyeUSBPacketProcessor(video_mode, tracker_listener);
 	m_is_streaming= m_video_packet_processor->startUSBBulkTransfer(m_usb_device_handle);
+	if (!m_is_streaming)
+	{
+		PSVR_LOG_ERROR("PS3EyeVideoDevice::open") << "Failed to start the video stream";
+		delete m_video_packet_processor;
+		m_video_packet_processor= nullptr;
+	}
+
+	// Send the property changes that came in while the camera was being set up
+	m_property_queue->release();
+}
 
-	return m_is_streaming;	
+void PS3EyeVideoDevice::updatePendingOpens()
+{
+	PS3EyeOpenSequence::updateAll();
+}
+
+void PS3EyeVideoDevice::waitForPendingOpens()
+{
+	PS3EyeOpenSequence::waitForAll();
+}
+
+bool PS3EyeVideoDevice::isOpening() const
+{
+	return m_open_sequence && m_open_sequence->getIsRunning();
 }
 
 void PS3EyeVideoDevice::close()
 {
+	// Give up on setting the camera up if it's still in progress
+	if (m_open_sequence)
+	{
+		m_open_sequence->cancel();
+		m_open_sequence.reset();
+
+		delete m_video_packet_processor;
+		m_video_packet_processor= nullptr;
+
+		m_property_queue->release();
+	}
+
     if(!m_is_streaming) 
 		return;
 
 	if (m_usb_device_handle != k_invalid_usb_device_handle)
 	{
+		OV534RegisterBatch batch;
+
 		// Tell the camera to stop the video stream
-		ov534_reg_write(m_usb_device_handle, 0xe0, 0x09); 
+		batch.ov534RegWrite(0xe0, 0x09); 
 
 		// Turn off the "recording" LED light
-		ov534_set_led(m_usb_device_handle, false);
+		batch.ov534SetLed(false);
+
+		batch.submit(m_usb_device_handle, "PS3EyeVideoDevice::close");
 	}
 
 	// Stop the USB video packet bulk transfers and the frame processor thread
@@ -998,6 +1644,14 @@ void PS3EyeVideoDevice::close()
     m_is_streaming = false;
 }
 
+void PS3EyeVideoDevice::getStatistics(PSVRTrackerStatistics &out_statistics) const
+{
+	if (m_video_packet_processor != nullptr)
+	{
+		m_video_packet_processor->getStatistics(out_statistics);
+	}
+}
+
 inline PSVRVideoPropertyConstraint create_property_constraint(
 	int min_value,
 	int max_value,
@@ -1203,7 +1857,7 @@ void PS3EyeVideoDevice::setAutoWhiteBalance(bool val)
     m_properties.awb = val;
 
     // Add an async task to set the awb on the camera
-    set_auto_white_balance(m_usb_device_handle, val);
+    queueVideoProperty(PSVRVideoProperty_WhiteBalance, val ? 1 : 0);
 }
 
 void PS3EyeVideoDevice::setGain(unsigned char val)
@@ -1212,7 +1866,7 @@ void PS3EyeVideoDevice::setGain(unsigned char val)
     m_properties.gain = val;
 
     // Add an async task to set the gain on the camera
-    set_gain(m_usb_device_handle, val);
+    queueVideoProperty(PSVRVideoProperty_Gain, val);
 }
 
 void PS3EyeVideoDevice::setExposure(unsigned char val)
@@ -1221,7 +1875,7 @@ void PS3EyeVideoDevice::setExposure(unsigned char val)
     m_properties.exposure = val;
 
     // Add an async task to set the exposure on the camera
-    set_exposure(m_usb_device_handle, val);
+    queueVideoProperty(PSVRVideoProperty_Exposure, val);
 }
 
 
@@ -1231,7 +1885,7 @@ void PS3EyeVideoDevice::setSharpness(unsigned char val)
     m_properties.sharpness = val;
 
     // Add an async task to set the sharpness on the camera
-    set_sharpness(m_usb_device_handle, val);
+    queueVideoProperty(PSVRVideoProperty_Sharpness, val);
 }
 
 void PS3EyeVideoDevice::setContrast(unsigned char val)
@@ -1240,7 +1894,7 @@ void PS3EyeVideoDevice::setContrast(unsigned char val)
     m_properties.contrast = val;
 
     // Add an async task to set the sharpness on the camera
-    set_contrast(m_usb_device_handle, val);
+    queueVideoProperty(PSVRVideoProperty_Contrast, val);
 }
 
 void PS3EyeVideoDevice::setBrightness(unsigned char val)
@@ -1249,7 +1903,7 @@ void PS3EyeVideoDevice::setBrightness(unsigned char val)
     m_properties.brightness = val;
 
     // Add an async task to set the sharpness on the camera
-    set_brightness(m_usb_device_handle, val);
+    queueVideoProperty(PSVRVideoProperty_Brightness, val);
 }
 
 void PS3EyeVideoDevice::setHue(unsigned char val)
@@ -1258,7 +1912,7 @@ void PS3EyeVideoDevice::setHue(unsigned char val)
     m_properties.hue = val;
 
     // Add an async task to set the sharpness on the camera
-    set_hue(m_usb_device_handle, val);
+    queueVideoProperty(PSVRVideoProperty_Hue, val);
 }
 
 void PS3EyeVideoDevice::setRedBalance(unsigned char val)
@@ -1267,7 +1921,7 @@ void PS3EyeVideoDevice::setRedBalance(unsigned char val)
     m_properties.redBalance = val;
 
     // Add an async task to set the red balance on the camera
-    set_red_balance(m_usb_device_handle, val);
+    queueVideoProperty(PSVRVideoProperty_RedBalance, val);
 }
 
 void PS3EyeVideoDevice::setGreenBalance(unsigned char val)
@@ -1276,7 +1930,7 @@ void PS3EyeVideoDevice::setGreenBalance(unsigned char val)
     m_properties.greenBalance = val;
 
     // Add an async task to set the green balance on the camera
-    set_green_balance(m_usb_device_handle, val);
+    queueVideoProperty(PSVRVideoProperty_GreenBalance, val);
 }
 
 void PS3EyeVideoDevice::setBlueBalance(unsigned char val)
@@ -1285,7 +1939,7 @@ void PS3EyeVideoDevice::setBlueBalance(unsigned char val)
     m_properties.blueBalance = val;
 
     // Add an async task to set the red balance on the camera
-    set_blue_balance(m_usb_device_handle, val);
+    queueVideoProperty(PSVRVideoProperty_BlueBalance, val);
 }
 
 void PS3EyeVideoDevice::setFlip(bool horizontal, bool vertical)
@@ -1298,47 +1952,81 @@ void PS3EyeVideoDevice::setFlip(bool horizontal, bool vertical)
     set_flip(m_usb_device_handle, horizontal, vertical);
 }
 
+void PS3EyeVideoDevice::queueVideoProperty(PSVRVideoPropertyType property_type, int value)
+{
+	if (m_property_queue)
+	{
+		m_property_queue->enqueue(property_type, value);
+	}
+}
+
 bool PS3EyeVideoDevice::getUSBPortPath(char *out_identifier, size_t max_identifier_length) const
 {
 	return usb_device_get_port_path(m_usb_device_handle, out_identifier, max_identifier_length);
 }
 
 //-- private helpers ----
-static void init_camera(
-    t_usb_device_handle device_handle,
+// The register setup the PS3EYEDriver runs to initialize the camera and start the video stream,
+// cut into steps wherever it has to give the camera time or needs a value read back from it
+static void add_open_sequence_steps(
+    PS3EyeOpenSequence &sequence,
     const PS3EyeVideoModeInfo &video_mode)
 {
-    uint8_t sensor_id= 0;
-
-	// Set the desired frame rate
-	set_frame_rate(device_handle, video_mode);
+    // set the desired frame rate and reset the bridge
+    sequence.addStep("reset_bridge", [video_mode](OV534RegisterBatch &batch, uint8_t last_read_value) {
+        set_frame_rate(batch, video_mode);
+        batch.ov534RegWrite(0xe7, 0x3a);
+        batch.ov534RegWrite(0xe0, 0x08);
+    }, BRIDGE_RESET_SETTLE_MS);
+
+    // initialize the sensor address and reset the sensor
+    sequence.addStep("reset_sensor", [](OV534RegisterBatch &batch, uint8_t last_read_value) {
+        batch.ov534RegWrite(OV534_REG_ADDRESS, 0x42);
+        batch.sccbRegWrite(0x12, 0x80);
+    }, SENSOR_RESET_SETTLE_MS);
 
-    // reset bridge
-    ov534_reg_write(device_handle, 0xe7, 0x3a);
-    ov534_reg_write(device_handle, 0xe0, 0x08);
-    Utility::sleep_ms(100);
+    // probe the sensor
+    sequence.addStep("probe_sensor", [](OV534RegisterBatch &batch, uint8_t last_read_value) {
+        batch.sccbRegRead(0x0a);
+        batch.sccbRegRead(0x0a);
+        batch.sccbRegRead(0x0b);
+        batch.sccbRegRead(0x0b);
+    });
+
+    // initialize, then set up the video mode
+    sequence.addStep("init_camera", [video_mode](OV534RegisterBatch &batch, uint8_t sensor_id) {
+        PSVR_LOG_INFO("init_camera") <<  "PS3EYE Sensor ID: "
+            << std::hex << std::setfill('0') << std::setw(2) << static_cast<int>(sensor_id);
+
+        batch.ov534RegWriteArray(ov534_reg_initdata, ARRAY_SIZE(ov534_reg_initdata));
+        batch.ov534SetLed(true);
+        batch.sccbRegWriteArray(ov772x_reg_initdata, ARRAY_SIZE(ov772x_reg_initdata));
+        batch.ov534RegWrite(0xe0, 0x09);
+        batch.ov534SetLed(false);
+
+        if (video_mode.width == 320) // 320x240
+        {
+            batch.ov534RegWriteArray(bridge_start_qvga, ARRAY_SIZE(bridge_start_qvga));
+            batch.sccbRegWriteArray(sensor_start_qvga, ARRAY_SIZE(sensor_start_qvga));
+        }
+        else // 640x480
+        {
+            batch.ov534RegWriteArray(bridge_start_vga, ARRAY_SIZE(bridge_start_vga));
+            batch.sccbRegWriteArray(sensor_start_vga, ARRAY_SIZE(sensor_start_vga));
+        }
 
-    // initialize the sensor address
-    ov534_reg_write(device_handle, OV534_REG_ADDRESS, 0x42);
+        set_frame_rate(batch, video_mode);
 
-	// reset sensor
-    sccb_reg_write(device_handle, 0x12, 0x80);
-    Utility::sleep_ms(10);
+        // the flip register gets updated in place
+        batch.sccbRegRead(0x0C);
+    });
 
-    // probe the sensor
-	sccb_reg_read(device_handle, 0x0a);
-	sensor_id = sccb_reg_read(device_handle, 0x0a) << 8;
-	sccb_reg_read(device_handle, 0x0b);
-	sensor_id |= sccb_reg_read(device_handle, 0x0b);
-	PSVR_LOG_INFO("init_camera") <<  "PS3EYE Sensor ID: "
-		<< std::hex << std::setfill('0') << std::setw(2) << sensor_id;
-
-    // initialize 
-    ov534_reg_write_array(device_handle, ov534_reg_initdata, ARRAY_SIZE(ov534_reg_initdata));
-    ov534_set_led(device_handle, true);
-    sccb_reg_write_array(device_handle, ov772x_reg_initdata, ARRAY_SIZE(ov772x_reg_initdata));
-    ov534_reg_write(device_handle, 0xe0, 0x09);
-    ov534_set_led(device_handle, false);
+    // flip the image horizontally, turn on the "recording" LED and start the video stream
+    sequence.addStep("start_stream", [](OV534RegisterBatch &batch, uint8_t read_reg_0x0C_result) {
+        batch.sccbRegWrite(0x0C, get_flip_register_value(read_reg_0x0C_result, true, false));
+        batch.ov534SetLed(true);
+        batch.ov534RegWrite(0xe0, 0x00);
+    });
 }
 
 static void set_autogain(
@@ -1358,27 +2046,30 @@ static void set_autogain(
         sccb_reg_write(device_handle, 0x13, 0xf0); //AGC,AEC,AWB OFF
         uint8_t read_reg_0x64_result= sccb_reg_read(device_handle, 0x64);
         sccb_reg_write(device_handle, 0x64, read_reg_0x64_result & 0xFC);
-        set_gain(device_handle, gain);
-        set_exposure(device_handle, exposure);
+
+        OV534RegisterBatch batch;
+        set_gain(batch, gain);
+        set_exposure(batch, exposure);
+        batch.submit(device_handle, "set_autogain");
     }
 }
 
 static void set_auto_white_balance(
-    t_usb_device_handle device_handle, 
+    OV534RegisterBatch &batch, 
     bool bAutoWhiteBalance)
 {
     if (bAutoWhiteBalance)
     {
-        sccb_reg_write(device_handle, 0x63, 0xe0); //AWB ON
+        batch.sccbRegWrite(0x63, 0xe0); //AWB ON
     }
     else
     {
-        sccb_reg_write(device_handle, 0x63, 0xAA); //AWB OFF
+        batch.sccbRegWrite(0x63, 0xAA); //AWB OFF
     }
 }
 
 static void set_gain(
-    t_usb_device_handle device_handle, 
+    OV534RegisterBatch &batch, 
     unsigned char val)
 {
     switch (val & 0x30)
@@ -1400,65 +2091,113 @@ static void set_gain(
         break;
     }
 
-    sccb_reg_write(device_handle, 0x00, val);
+    batch.sccbRegWrite(0x00, val);
 }
 
 static void set_exposure(
-    t_usb_device_handle device_handle, 
+    OV534RegisterBatch &batch, 
     unsigned char val)
 {
-    sccb_reg_write(device_handle, 0x08, val >> 7);
-    sccb_reg_write(device_handle, 0x10, val << 1);
+    batch.sccbRegWrite(0x08, val >> 7);
+    batch.sccbRegWrite(0x10, val << 1);
 }
 
 static void set_sharpness(
-    t_usb_device_handle device_handle,
+    OV534RegisterBatch &batch,
     unsigned char val)
 {
-    sccb_reg_write(device_handle, 0x91, val);
-    sccb_reg_write(device_handle, 0x8E, val);
+    batch.sccbRegWrite(0x91, val);
+    batch.sccbRegWrite(0x8E, val);
 }
 
 static void set_contrast(
-    t_usb_device_handle device_handle, 
+    OV534RegisterBatch &batch, 
     unsigned char val)
 {
-    sccb_reg_write(device_handle, 0x9C, val);
+    batch.sccbRegWrite(0x9C, val);
 }
 
 static void set_brightness(
-    t_usb_device_handle device_handle, 
+    OV534RegisterBatch &batch, 
     unsigned char val)
 {
-    sccb_reg_write(device_handle, 0x9B, val);
+    batch.sccbRegWrite(0x9B, val);
 }
 
 static void set_hue(
-    t_usb_device_handle device_handle,
+    OV534RegisterBatch &batch,
     unsigned char val)
 {
-    sccb_reg_write(device_handle, 0x01, val);
+    batch.sccbRegWrite(0x01, val);
 }
 
 static void set_red_balance(
-    t_usb_device_handle device_handle,
+    OV534RegisterBatch &batch,
     unsigned char val)
 {
-    sccb_reg_write(device_handle, 0x43, val);
+    batch.sccbRegWrite(0x43, val);
 }
 
 static void set_green_balance(
-    t_usb_device_handle device_handle,
+    OV534RegisterBatch &batch,
     unsigned char val)
 {
-    sccb_reg_write(device_handle, 0x44, val);
+    batch.sccbRegWrite(0x44, val);
 }
 
 static void set_blue_balance(
-    t_usb_device_handle device_handle,
+    OV534RegisterBatch &batch,
     unsigned char val)
 {
-    sccb_reg_write(device_handle, 0x42, val);
+    batch.sccbRegWrite(0x42, val);
+}
+
+// Returns false for properties the sensor doesn't have registers for
+static bool set_video_property(
+    OV534RegisterBatch &batch,
+    PSVRVideoPropertyType property_type,
+    int value)
+{
+    bool bSupported= true;
+
+    switch (property_type)
+    {
+    case PSVRVideoProperty_Brightness:
+        set_brightness(batch, (unsigned char)value);
+        break;
+    case PSVRVideoProperty_Contrast:
+        set_contrast(batch, (unsigned char)value);
+        break;
+    case PSVRVideoProperty_Hue:
+        set_hue(batch, (unsigned char)value);
+        break;
+    case PSVRVideoProperty_Sharpness:
+        set_sharpness(batch, (unsigned char)value);
+        break;
+    case PSVRVideoProperty_WhiteBalance:
+        set_auto_white_balance(batch, value == 1);
+        break;
+    case PSVRVideoProperty_RedBalance:
+        set_red_balance(batch, (unsigned char)value);
+        break;
+    case PSVRVideoProperty_GreenBalance:
+        set_green_balance(batch, (unsigned char)value);
+        break;
+    case PSVRVideoProperty_BlueBalance:
+        set_blue_balance(batch, (unsigned char)value);
+        break;
+    case PSVRVideoProperty_Gain:
+        set_gain(batch, (unsigned char)value);
+        break;
+    case PSVRVideoProperty_Exposure:
+        set_exposure(batch, (unsigned char)value);
+        break;
+    default:
+        bSupported= false;
+        break;
+    }
+
+    return bSupported;
 }
 
 static void set_flip(
@@ -1466,22 +2205,31 @@ static void set_flip(
     bool horizontal, 
     bool vertical)
 {
-	uint8_t read_reg_0x0C_result= sccb_reg_read(device_handle, 0x0C) & ~0xC0;
-    uint8_t val= read_reg_0x0C_result;
+	uint8_t read_reg_0x0C_result= sccb_reg_read(device_handle, 0x0C);
+
+    sccb_reg_write(device_handle, 0x0C, get_flip_register_value(read_reg_0x0C_result, horizontal, vertical));
+}
+
+static uint8_t get_flip_register_value(
+    uint8_t reg_0x0C,
+    bool horizontal, 
+    bool vertical)
+{
+    uint8_t val= reg_0x0C & ~0xC0;
     
 	if (!horizontal) val |= 0x40;
     if (!vertical) val |= 0x80;
 
-    sccb_reg_write(device_handle, 0x0C, val);
+    return val;
 }
 
 static void set_frame_rate(
-    t_usb_device_handle device_handle, 
+    OV534RegisterBatch &batch, 
     const PS3EyeVideoModeInfo &video_mode)
 {
-    sccb_reg_write(device_handle, 0x11, video_mode.r11);
-    sccb_reg_write(device_handle, 0x0d, video_mode.r0d);
-    ov534_reg_write(device_handle, 0xe5, video_mode.re5);
+    batch.sccbRegWrite(0x11, video_mode.r11);
+    batch.sccbRegWrite(0x0d, video_mode.r0d);
+    batch.ov534RegWrite(0xe5, video_mode.re5);
 }
 
 static void sccb_reg_write(
@@ -1489,196 +2237,21 @@ static void sccb_reg_write(
     uint8_t reg, 
     uint8_t val)
 {
-	ov534_reg_write(device_handle, OV534_REG_SUBADDR, reg);
-	ov534_reg_write(device_handle, OV534_REG_WRITE, val);
-	ov534_reg_write(device_handle, OV534_REG_OPERATION, OV534_OP_WRITE_3);
-	
-	if (!sccb_check_status(device_handle))
-	{
-		PSVR_LOG_WARNING("sccb_reg_write") << "failed";
-	}
-}
-
-static void sccb_reg_write_array(
-    t_usb_device_handle device_handle, 
-    const uint8_t (*sequence)[2], 
-    int sequenceLength)
-{
-    const uint8_t (*data)[2]= sequence;
-    int len= sequenceLength;
-
-	while (--len >= 0) 
-	{
-		if ((*data)[0] != 0xff) 
-		{
-			sccb_reg_write(device_handle, (*data)[0], (*data)[1]);
-		}
-		else 
-		{
-			sccb_reg_read(device_handle, (*data)[1]);
-			sccb_reg_write(device_handle, 0xff, 0x00);
-		}
+	OV534RegisterBatch batch;
 
-		data++;
-	}
+	batch.sccbRegWrite(reg, val);
+	batch.submit(device_handle, "sccb_reg_write");
 }
 
 static uint8_t sccb_reg_read(
     t_usb_device_handle device_handle, 
     uint16_t reg)
 {
-    ov534_reg_write(device_handle, OV534_REG_SUBADDR, (uint8_t)reg);
-    ov534_reg_write(device_handle, OV534_REG_OPERATION, OV534_OP_WRITE_2);
-    if (!sccb_check_status(device_handle))
-    {
-		PSVR_LOG_WARNING("sccb_reg_read") << "failed 1st write";
-        return 0;
-    }
-
-    ov534_reg_write(device_handle, OV534_REG_OPERATION, OV534_OP_READ_2);
-    if (!sccb_check_status(device_handle))
-    {
-		PSVR_LOG_WARNING("sccb_reg_read") << "failed 2nd write";
-        return 0;
-    }
-
-    return ov534_reg_read(device_handle, OV534_REG_READ);
-}
-
-static bool sccb_check_status(t_usb_device_handle device_handle)
-{
-	for (int i = 0; i < 5; i++) 
-	{
-		uint8_t data = ov534_reg_read(device_handle, OV534_REG_STATUS);
-
-		switch (data) 
-		{
-		case 0x00:
-			return true;
-		case 0x04:
-			return false;
-		case 0x03:
-			break;
-		default:
-            PSVR_LOG_WARNING("sccb_check_status") << "unknown sccb status 0x"
-                << std::hex << std::setfill('0') << std::setw(2) << data;
-		}
-	}
-
-	return false;
-}
-
-static void ov534_reg_write(
-    t_usb_device_handle device_handle, 
-    uint16_t reg, 
-    uint8_t val)
-{
-    USBTransferRequest request;
-    memset(&request, 0, sizeof(USBTransferRequest));
-    request.request_type= eUSBTransferRequestType::_USBRequestType_ControlTransfer;
-    request.payload.control_transfer.usb_device_handle= device_handle;
-    request.payload.control_transfer.bmRequestType = 
-        USB_ENDPOINT_OUT | USB_REQUEST_TYPE_VENDOR | USB_RECIPIENT_DEVICE;
-    request.payload.control_transfer.bRequest= 0x01;
-    request.payload.control_transfer.wValue= 0x00;
-    request.payload.control_transfer.wIndex = reg;
-    request.payload.control_transfer.data[0]= val;
-    request.payload.control_transfer.wLength= 1;
-    request.payload.control_transfer.timeout= 500;
-
-    // Submit the async USB control transfer request...
-	USBTransferResult result= usb_device_submit_transfer_request_blocking(request);
-    assert(result.result_type == eUSBTransferResultType::_USBResultType_ControlTransfer);
-
-    //... whose result we get notified of here
-    if (result.payload.control_transfer.result_code != eUSBResultCode::_USBResultCode_Completed)
-    {
-        // Tell the callback the transfer failed :(
-        // The callback parameter value will be the error code
-        log_usb_result_code("ov534_reg_write", result.payload.control_transfer.result_code);
-    }
-}
-
-static void ov534_reg_write_array(
-    t_usb_device_handle device_handle,
-    const uint8_t (*sequence)[2], 
-    int sequenceLength)
-{
-    const uint8_t (*data)[2]= sequence;
-    int len= sequenceLength;
-
-	while (--len >= 0) 
-	{
-		ov534_reg_write(device_handle, (*data)[0], (*data)[1]);
-		data++;
-	}
-}
-
-static uint8_t ov534_reg_read(
-    t_usb_device_handle device_handle, 
-    uint16_t reg)
-{
-    USBTransferRequest request;
-    memset(&request, 0, sizeof(USBTransferRequest));
-    request.request_type = eUSBTransferRequestType::_USBRequestType_ControlTransfer;
-    request.payload.control_transfer.usb_device_handle= device_handle;
-    request.payload.control_transfer.bmRequestType =
-        USB_ENDPOINT_IN | USB_REQUEST_TYPE_VENDOR | USB_RECIPIENT_DEVICE;
-    request.payload.control_transfer.bRequest = 0x01;
-    request.payload.control_transfer.wValue = 0x00;
-    request.payload.control_transfer.wIndex = reg;
-    request.payload.control_transfer.wLength = 1;
-    request.payload.control_transfer.timeout = 500;
-
-    // Submit the async USB control transfer request...
-	USBTransferResult result= usb_device_submit_transfer_request_blocking(request);
-    assert(result.result_type == eUSBTransferResultType::_USBResultType_ControlTransfer);
-
-    //... whose result we get notified of here
-    if (result.payload.control_transfer.result_code == eUSBResultCode::_USBResultCode_Completed)
-    {
-        assert(result.payload.control_transfer.dataLength == 1);
-
-        // Tell the callback the transfer completed ok :)
-        // The callback parameter value will value we read from the camera register.
-        return static_cast<uint8_t>(result.payload.control_transfer.data[0]);
-    }
-    else
-    {
-        log_usb_result_code("ov534_reg_read", result.payload.control_transfer.result_code);
-
-        return 0;
-    }
-}
-
-/* Two bits control LED: 0x21 bit 7 and 0x23 bit 7.
- * (direction and output)? */
-static void ov534_set_led(
-    t_usb_device_handle device_handle,
-    bool bLedOn)
-{
-	uint8_t read_reg_result;
-
-    // Change register value 0x21
-	read_reg_result= ov534_reg_read(device_handle, 0x21); 
-	read_reg_result|= 0x80;
-    ov534_reg_write(device_handle, 0x21, read_reg_result);
-
-    // Change register value 0x23
-    read_reg_result= ov534_reg_read(device_handle, 0x23);
-    if (bLedOn)
-        read_reg_result|= 0x80;
-    else
-        read_reg_result&= ~0x80;
+	OV534RegisterBatch batch;
 
-    ov534_reg_write(device_handle, 0x23, read_reg_result);
+	batch.sccbRegRead(reg);
 
-    if (!bLedOn)
-    {
-        read_reg_result= ov534_reg_read(device_handle, 0x21);
-		read_reg_result&= ~0x80;
-        ov534_reg_write(device_handle, 0x21, read_reg_result);
-    }
+    return batch.submit(device_handle, "sccb_reg_read");
 }
 
 static void log_usb_result_code(const char *function_name, eUSBResultCode result_code)
@@ -57,6 +57,8 @@
 #include "USBApiInterface.h"
 #include "PS3EyeConfig.h"
 
+#include <memory>
+
 //-- constants -----
 #define INVALID_DEVICE_FORMAT_INDEX			-1
 #define UNSPECIFIED_CAMERA_WIDTH			0xFFFFFFFF
@@ -139,9 +141,19 @@ public:
 
 	static ePS3EyeVideoMode findBestVideoMode(unsigned int w, unsigned int h, unsigned int frameRate);
 
+    // Kicks off the camera setup on the USB worker thread and returns right away,
+    // the video stream starts once the setup is done
     bool open(ePS3EyeVideoMode desiredVideoMode, PS3EyeTrackerConfig &cfg, class ITrackerListener *trackerListener);
     void close();
 
+    // Moves along the setup of every camera still opening (main thread, once per service update)
+    static void updatePendingOpens();
+    // Blocks until every camera still opening is either streaming or failed to start
+    static void waitForPendingOpens();
+
+	// Fill in the USB transfer and frame assembly latencies, and the frames dropped before the tracker saw them
+	void getStatistics(PSVRTrackerStatistics &out_statistics) const;
+
 	inline const PSVRVideoPropertyConstraint *getVideoPropertyConstraints() const { return m_videoPropertyConstraints; }
 
 	bool getVideoPropertyConstraint(const PSVRVideoPropertyType property_type, PSVRVideoPropertyConstraint &outConstraint) const;
@@ -150,6 +162,7 @@ public:
 
     // Camera Control Setters
     // Used in when we don't care about an async task result
+    // (everything but autogain and flip is queued up and applied on the USB worker thread)
     void setAutogain(bool val);
     void setAutoWhiteBalance(bool val);
     void setGain(unsigned char val);
@@ -180,6 +193,7 @@ public:
 
     // Camera Property Accessors
     inline bool isStreaming() const { return m_is_streaming; }
+    bool isOpening() const;
     inline unsigned int getWidth() const { return m_properties.frame_width; }
     inline unsigned int getHeight() const { return m_properties.frame_height; }
     inline unsigned short getFrameRate() const { return m_properties.frame_rate; }
@@ -192,6 +206,9 @@ private:
     PS3EyeVideoDevice(const PS3EyeVideoDevice&);
     void operator=(const PS3EyeVideoDevice&);
 
+	void queueVideoProperty(PSVRVideoPropertyType property_type, int value);
+	void onOpenSequenceFinished();
+
     PS3EyeProperties m_properties;
 	PSVRVideoPropertyConstraint m_videoPropertyConstraints[PSVRVideoProperty_COUNT];
 
@@ -201,6 +218,8 @@ private:
     // usb stuff
     t_usb_device_handle m_usb_device_handle;
     class PS3EyeUSBPacketProcessor *m_video_packet_processor;
+	std::shared_ptr<class PS3EyeVideoPropertyQueue> m_property_queue;
+	std::shared_ptr<class PS3EyeOpenSequence> m_open_sequence;
 };
 
 #endif
\ No newline at end of file
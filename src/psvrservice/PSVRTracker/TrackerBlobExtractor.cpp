@@ -0,0 +1,240 @@
+//-- includes -----
+#include "TrackerBlobExtractor.h"
+
+#include <algorithm>
+#include <cstring>
+
+//-- private methods -----
+// Sum of x^2 for x in [0, n]
+static inline int64_t sum_of_squares(int64_t n)
+{
+	return (n * (n + 1) * (2*n + 1)) / 6;
+}
+
+// Skips over zero mask bytes, 8 at a time while possible
+static inline int find_next_set_pixel(const uint8_t *row, int x, const int width)
+{
+	while (x + 8 <= width)
+	{
+		uint64_t block;
+		memcpy(&block, row + x, sizeof(block));
+
+		if (block != 0)
+			break;
+
+		x+= 8;
+	}
+
+	while (x < width && row[x] == 0)
+	{
+		++x;
+	}
+
+	return x;
+}
+
+static inline int find_next_clear_pixel(const uint8_t *row, int x, const int width)
+{
+	while (x < width && row[x] != 0)
+	{
+		++x;
+	}
+
+	return x;
+}
+
+//-- public interface -----
+TrackerBlobExtractor::TrackerBlobExtractor()
+{
+}
+
+int TrackerBlobExtractor::extractBiggestNBlobs(
+	const uint8_t *mask, int mask_stride,
+	int width, int height,
+	int origin_x, int origin_y,
+	int min_blob_area,
+	TrackerBlob *out_blobs,
+	int max_blob_count)
+{
+	m_runs.clear();
+	m_labelParents.clear();
+
+	// Pass 1: Extract runs and link them to the 8-connected runs on the previous row
+	size_t prev_row_begin= 0;
+	size_t prev_row_end= 0;
+	for (int y= 0; y < height; ++y)
+	{
+		const uint8_t *row= mask + y*mask_stride;
+		const size_t row_begin= m_runs.size();
+		size_t prev_run= prev_row_begin;
+		int x= 0;
+
+		while (true)
+		{
+			x= find_next_set_pixel(row, x, width);
+			if (x >= width)
+				break;
+
+			const int start_x= x;
+			x= find_next_clear_pixel(row, x, width);
+			const int end_x= x - 1;
+
+			Run run;
+			run.start_x= static_cast<int16_t>(start_x);
+			run.end_x= static_cast<int16_t>(end_x);
+			run.y= static_cast<int16_t>(y);
+			run.label= -1;
+
+			// Skip previous row runs that end before this run can touch them.
+			// Runs are sorted by x so this never needs to back up.
+			while (prev_run < prev_row_end && m_runs[prev_run].end_x < start_x - 1)
+			{
+				++prev_run;
+			}
+
+			for (size_t overlap= prev_run;
+				overlap < prev_row_end && m_runs[overlap].start_x <= end_x + 1;
+				++overlap)
+			{
+				if (run.label == -1)
+				{
+					run.label= m_runs[overlap].label;
+				}
+				else
+				{
+					mergeLabels(run.label, m_runs[overlap].label);
+				}
+			}
+
+			if (run.label == -1)
+			{
+				run.label= allocateLabel();
+			}
+
+			m_runs.push_back(run);
+		}
+
+		prev_row_begin= row_begin;
+		prev_row_end= m_runs.size();
+	}
+
+	// Pass 2: Accumulate the moments of every run into its root blob
+	m_labelToBlob.assign(m_labelParents.size(), -1);
+	m_blobAccumulators.clear();
+	for (const Run &run : m_runs)
+	{
+		const int root= findRootLabel(run.label);
+		int blob_index= m_labelToBlob[root];
+
+		if (blob_index == -1)
+		{
+			BlobAccumulator accumulator;
+			memset(&accumulator, 0, sizeof(accumulator));
+			accumulator.min_x= run.start_x;
+			accumulator.min_y= run.y;
+			accumulator.max_x= run.end_x;
+			accumulator.max_y= run.y;
+
+			blob_index= static_cast<int>(m_blobAccumulators.size());
+			m_labelToBlob[root]= blob_index;
+			m_blobAccumulators.push_back(accumulator);
+		}
+
+		BlobAccumulator &accumulator= m_blobAccumulators[blob_index];
+		const int64_t x0= run.start_x;
+		const int64_t x1= run.end_x;
+		const int64_t y= run.y;
+		const int64_t n= x1 - x0 + 1;
+		const int64_t run_sum_x= (x0 + x1) * n / 2;
+
+		accumulator.area+= n;
+		accumulator.sum_x+= run_sum_x;
+		accumulator.sum_y+= n * y;
+		accumulator.sum_xx+= sum_of_squares(x1) - (x0 > 0 ? sum_of_squares(x0 - 1) : 0);
+		accumulator.sum_yy+= n * y * y;
+		accumulator.sum_xy+= run_sum_x * y;
+		accumulator.min_x= std::min(accumulator.min_x, static_cast<int>(x0));
+		accumulator.max_x= std::max(accumulator.max_x, static_cast<int>(x1));
+		accumulator.max_y= static_cast<int>(y); // runs are visited in row order
+	}
+
+	// Select the N biggest blobs
+	m_sortedBlobs.clear();
+	for (int blob_index= 0; blob_index < static_cast<int>(m_blobAccumulators.size()); ++blob_index)
+	{
+		if (m_blobAccumulators[blob_index].area >= min_blob_area)
+		{
+			m_sortedBlobs.push_back(blob_index);
+		}
+	}
+
+	const int blob_count= std::min(max_blob_count, static_cast<int>(m_sortedBlobs.size()));
+	std::partial_sort(
+		m_sortedBlobs.begin(), m_sortedBlobs.begin() + blob_count, m_sortedBlobs.end(),
+		[this](int a, int b) {
+			// Ties are broken by scan order so the output is deterministic
+			const int64_t area_a= m_blobAccumulators[a].area;
+			const int64_t area_b= m_blobAccumulators[b].area;
+			return area_a > area_b || (area_a == area_b && a < b);
+		});
+
+	for (int output_index= 0; output_index < blob_count; ++output_index)
+	{
+		const BlobAccumulator &accumulator= m_blobAccumulators[m_sortedBlobs[output_index]];
+		const double area= static_cast<double>(accumulator.area);
+		const double mean_x= static_cast<double>(accumulator.sum_x) / area;
+		const double mean_y= static_cast<double>(accumulator.sum_y) / area;
+		TrackerBlob &blob= out_blobs[output_index];
+
+		blob.area= static_cast<int>(accumulator.area);
+		blob.center_x= static_cast<float>(mean_x + origin_x);
+		blob.center_y= static_cast<float>(mean_y + origin_y);
+		blob.min_x= accumulator.min_x + origin_x;
+		blob.min_y= accumulator.min_y + origin_y;
+		blob.max_x= accumulator.max_x + origin_x;
+		blob.max_y= accumulator.max_y + origin_y;
+		blob.mu20= static_cast<float>(static_cast<double>(accumulator.sum_xx) / area - mean_x*mean_x);
+		blob.mu11= static_cast<float>(static_cast<double>(accumulator.sum_xy) / area - mean_x*mean_y);
+		blob.mu02= static_cast<float>(static_cast<double>(accumulator.sum_yy) / area - mean_y*mean_y);
+	}
+
+	return blob_count;
+}
+
+//-- private methods -----
+int TrackerBlobExtractor::allocateLabel()
+{
+	const int label= static_cast<int>(m_labelParents.size());
+
+	m_labelParents.push_back(label);
+
+	return label;
+}
+
+int TrackerBlobExtractor::findRootLabel(int label)
+{
+	while (m_labelParents[label] != label)
+	{
+		// Path halving
+		m_labelParents[label]= m_labelParents[m_labelParents[label]];
+		label= m_labelParents[label];
+	}
+
+	return label;
+}
+
+void TrackerBlobExtractor::mergeLabels(int label_a, int label_b)
+{
+	const int root_a= findRootLabel(label_a);
+	const int root_b= findRootLabel(label_b);
+
+	// Keep the oldest label as the root so blobs stay in scan order
+	if (root_a < root_b)
+	{
+		m_labelParents[root_b]= root_a;
+	}
+	else if (root_b < root_a)
+	{
+		m_labelParents[root_a]= root_b;
+	}
+}
@@ -0,0 +1,72 @@
+#ifndef TRACKER_BLOB_EXTRACTOR_H
+#define TRACKER_BLOB_EXTRACTOR_H
+
+// -- includes -----
+#include <stdint.h>
+#include <vector>
+
+// -- definitions -----
+// An 8-connected group of set pixels in a binary mask.
+// Positions are in the mask's parent image space (see TrackerBlobExtractor::extractBiggestNBlobs).
+struct TrackerBlob
+{
+	int area; // pixel count
+	float center_x, center_y; // center of mass
+	int min_x, min_y, max_x, max_y; // inclusive bounding box
+	float mu20, mu11, mu02; // central second moments divided by area (i.e. the covariance of the blob)
+};
+
+// Single pass run-length connected component labeler.
+// Runs of set pixels are linked to overlapping runs on the previous row with a union-find,
+// then area, centroid, bounds and second moments are accumulated per run (not per pixel).
+// All working storage is kept between calls, so steady state extraction does no heap allocations.
+class TrackerBlobExtractor
+{
+public:
+	TrackerBlobExtractor();
+
+	/// Finds the blobs in the given mask (any non-zero byte is a set pixel) and writes
+	/// up to max_blob_count of the biggest ones, largest first, into out_blobs.
+	/// Blobs with fewer than min_blob_area pixels are ignored.
+	/// Note that this is a pixel count: the contour path it replaced rejected contours with
+	/// 6 or fewer CV_CHAIN_APPROX_SIMPLE vertices and reported cv::contourArea, the polygon area
+	/// through the boundary pixel centers, which is smaller than the pixel count by about half
+	/// the perimeter (a 3x3 square has a contourArea of 4 and an area here of 9).
+	/// (origin_x, origin_y) is added to all output positions, which allows the mask to be an ROI.
+	/// Returns the number of blobs written.
+	int extractBiggestNBlobs(
+		const uint8_t *mask, int mask_stride,
+		int width, int height,
+		int origin_x, int origin_y,
+		int min_blob_area,
+		TrackerBlob *out_blobs,
+		int max_blob_count);
+
+private:
+	struct Run
+	{
+		int16_t start_x, end_x; // inclusive
+		int16_t y;
+		int label;
+	};
+
+	struct BlobAccumulator
+	{
+		int64_t area;
+		int64_t sum_x, sum_y;
+		int64_t sum_xx, sum_yy, sum_xy;
+		int min_x, min_y, max_x, max_y;
+	};
+
+	int allocateLabel();
+	int findRootLabel(int label);
+	void mergeLabels(int label_a, int label_b);
+
+	std::vector<Run> m_runs;
+	std::vector<int> m_labelParents;
+	std::vector<int> m_labelToBlob;
+	std::vector<BlobAccumulator> m_blobAccumulators;
+	std::vector<int> m_sortedBlobs;
+};
+
+#endif // TRACKER_BLOB_EXTRACTOR_H
@@ -0,0 +1,485 @@
+//-- includes -----
+#include "TrackerImageProcessing.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define USE_SSE2_HSV_KERNEL
+#endif
+
+//-- constants -----
+// Hue is stored as [0, 180) in 8-bit HSV images (OpenCV convention)
+static const int k_hue_8u_max= 180;
+
+// Fixed point precision of the saturation and hue divide tables.
+// Same tables and rounding as OpenCV's 8-bit BGR2HSV, so masks match cvtColor + inRange bit for bit.
+static const int k_hsv_shift= 12;
+
+//-- private data -----
+struct HSVDivideTables
+{
+	int saturation[256]; // (255 << k_hsv_shift) / v
+	int hue[256]; // (180 << k_hsv_shift) / (6 * diff)
+
+	HSVDivideTables()
+	{
+		saturation[0]= hue[0]= 0;
+		for (int i= 1; i < 256; ++i)
+		{
+			saturation[i]= static_cast<int>(std::lrint((255 << k_hsv_shift) / static_cast<double>(i)));
+			hue[i]= static_cast<int>(std::lrint((k_hue_8u_max << k_hsv_shift) / (6.0*i)));
+		}
+	}
+};
+static const HSVDivideTables k_hsv_divide_tables;
+
+//-- private methods -----
+static inline int round_to_int(float x)
+{
+	// Round half to even, matching the saturate_cast OpenCV applies to inRange bounds
+	return static_cast<int>(std::lrintf(x));
+}
+
+static inline int clamp_round_to_int(float x, int min_value, int max_value)
+{
+	return std::min(std::max(round_to_int(x), min_value), max_value);
+}
+
+static inline bool is_in_range(int x, int min_value, int max_value)
+{
+	return x >= min_value && x <= max_value;
+}
+
+static inline void compute_hsv_for_pixel(
+	const int b, const int g, const int r,
+	int &out_h, int &out_s, int &out_v)
+{
+	const int v= std::max(b, std::max(g, r));
+	const int vmin= std::min(b, std::min(g, r));
+	const int diff= v - vmin;
+
+	int h_num;
+	if (v == r)
+		h_num= g - b;
+	else if (v == g)
+		h_num= b - r + 2*diff;
+	else
+		h_num= r - g + 4*diff;
+
+	const int k_round= 1 << (k_hsv_shift - 1);
+	const int s= (diff*k_hsv_divide_tables.saturation[v] + k_round) >> k_hsv_shift;
+	int h= (h_num*k_hsv_divide_tables.hue[diff] + k_round) >> k_hsv_shift;
+	if (h < 0)
+		h+= k_hue_8u_max;
+
+	out_h= h;
+	out_s= s;
+	out_v= v;
+}
+
+static inline uint8_t compute_hsv_mask_for_pixel(
+	const int h, const int s, const int v,
+	const HSVColorThresholds &t)
+{
+	const bool bInRange=
+		is_in_range(v, t.value_min, t.value_max) &&
+		is_in_range(s, t.saturation_min, t.saturation_max) &&
+		(is_in_range(h, t.hue_min[0], t.hue_max[0]) || is_in_range(h, t.hue_min[1], t.hue_max[1]));
+
+	return bInRange ? 0xFF : 0x00;
+}
+
+#ifdef USE_SSE2_HSV_KERNEL
+// SSE2 has no 32-bit mullo, so multiply the even and odd lanes separately and interleave the low halves
+static inline __m128i sse2_mullo_epi32(const __m128i a, const __m128i b)
+{
+	const __m128i even= _mm_mul_epu32(a, b);
+	const __m128i odd= _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+
+	return _mm_unpacklo_epi32(
+		_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+		_mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+static inline __m128i sse2_in_range_epi32(const __m128i x, const __m128i min_value, const __m128i max_value)
+{
+	// !(x < min) & !(x > max)
+	return _mm_andnot_si128(
+		_mm_or_si128(_mm_cmplt_epi32(x, min_value), _mm_cmpgt_epi32(x, max_value)),
+		_mm_set1_epi32(-1));
+}
+
+// Computes the 8-bit HSV values of 4 consecutive BGR pixels
+static inline void compute_hsv_for_4_pixels_sse2(
+	const uint8_t *bgr,
+	__m128i &out_h, __m128i &out_s, __m128i &out_v)
+{
+	const __m128 k_zero= _mm_setzero_ps();
+	const __m128 k_two= _mm_set1_ps(2.f);
+	const __m128 k_four= _mm_set1_ps(4.f);
+	const __m128i k_round= _mm_set1_epi32(1 << (k_hsv_shift - 1));
+
+	const __m128 b= _mm_cvtepi32_ps(_mm_setr_epi32(bgr[0], bgr[3], bgr[6], bgr[9]));
+	const __m128 g= _mm_cvtepi32_ps(_mm_setr_epi32(bgr[1], bgr[4], bgr[7], bgr[10]));
+	const __m128 r= _mm_cvtepi32_ps(_mm_setr_epi32(bgr[2], bgr[5], bgr[8], bgr[11]));
+
+	const __m128 v= _mm_max_ps(b, _mm_max_ps(g, r));
+	const __m128 vmin= _mm_min_ps(b, _mm_min_ps(g, r));
+	const __m128 diff= _mm_sub_ps(v, vmin);
+
+	// Select the hue numerator based on which channel holds the max value
+	const __m128 v_is_r= _mm_cmpeq_ps(v, r);
+	const __m128 v_is_g= _mm_andnot_ps(v_is_r, _mm_cmpeq_ps(v, g));
+	const __m128 v_is_b= _mm_andnot_ps(_mm_or_ps(v_is_r, v_is_g), _mm_cmpeq_ps(k_zero, k_zero));
+	const __m128 h_num=
+		_mm_or_ps(
+			_mm_and_ps(v_is_r, _mm_sub_ps(g, b)),
+			_mm_or_ps(
+				_mm_and_ps(v_is_g, _mm_add_ps(_mm_sub_ps(b, r), _mm_mul_ps(k_two, diff))),
+				_mm_and_ps(v_is_b, _mm_add_ps(_mm_sub_ps(r, g), _mm_mul_ps(k_four, diff)))));
+
+	// Everything above is a small integer, so the conversions back are exact
+	const __m128i vi= _mm_cvtps_epi32(v);
+	const __m128i diffi= _mm_cvtps_epi32(diff);
+
+	// No gather in SSE2, so look up the divide table entries lane by lane
+	int32_t v_lanes[4], diff_lanes[4];
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(v_lanes), vi);
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(diff_lanes), diffi);
+	const __m128i saturation_div=
+		_mm_setr_epi32(
+			k_hsv_divide_tables.saturation[v_lanes[0]], k_hsv_divide_tables.saturation[v_lanes[1]],
+			k_hsv_divide_tables.saturation[v_lanes[2]], k_hsv_divide_tables.saturation[v_lanes[3]]);
+	const __m128i hue_div=
+		_mm_setr_epi32(
+			k_hsv_divide_tables.hue[diff_lanes[0]], k_hsv_divide_tables.hue[diff_lanes[1]],
+			k_hsv_divide_tables.hue[diff_lanes[2]], k_hsv_divide_tables.hue[diff_lanes[3]]);
+
+	__m128i hi= _mm_srai_epi32(_mm_add_epi32(sse2_mullo_epi32(_mm_cvtps_epi32(h_num), hue_div), k_round), k_hsv_shift);
+	hi= _mm_add_epi32(hi, _mm_and_si128(_mm_cmplt_epi32(hi, _mm_setzero_si128()), _mm_set1_epi32(k_hue_8u_max)));
+
+	out_h= hi;
+	out_s= _mm_srai_epi32(_mm_add_epi32(sse2_mullo_epi32(diffi, saturation_div), k_round), k_hsv_shift);
+	out_v= vi;
+}
+
+// Writes the mask bytes of 4 pixels for the given thresholds
+static inline void compute_hsv_mask_for_4_pixels_sse2(
+	const __m128i hi, const __m128i si, const __m128i vi,
+	const HSVColorThresholds &t,
+	uint8_t *out_mask)
+{
+	const __m128i value_ok= sse2_in_range_epi32(vi, _mm_set1_epi32(t.value_min), _mm_set1_epi32(t.value_max));
+	const __m128i saturation_ok= sse2_in_range_epi32(si, _mm_set1_epi32(t.saturation_min), _mm_set1_epi32(t.saturation_max));
+	const __m128i hue_ok=
+		_mm_or_si128(
+			sse2_in_range_epi32(hi, _mm_set1_epi32(t.hue_min[0]), _mm_set1_epi32(t.hue_max[0])),
+			sse2_in_range_epi32(hi, _mm_set1_epi32(t.hue_min[1]), _mm_set1_epi32(t.hue_max[1])));
+	const __m128i mask= _mm_and_si128(value_ok, _mm_and_si128(saturation_ok, hue_ok));
+
+	// Narrow the 32-bit lane masks down to 4 mask bytes
+	const __m128i mask16= _mm_packs_epi32(mask, mask);
+	const __m128i mask8= _mm_packs_epi16(mask16, mask16);
+	const int32_t mask_bytes= _mm_cvtsi128_si32(mask8);
+	memcpy(out_mask, &mask_bytes, sizeof(mask_bytes));
+}
+#endif // USE_SSE2_HSV_KERNEL
+
+// Converts each pixel to HSV once and tests it against every set of thresholds
+static void compute_hsv_masks_for_bgr_row(
+	const uint8_t *bgr,
+	const int width,
+	const HSVColorThresholds *thresholds,
+	const int mask_count,
+	uint8_t * const *out_mask_rows)
+{
+	int x= 0;
+
+#ifdef USE_SSE2_HSV_KERNEL
+	for (; x + 4 <= width; x+= 4)
+	{
+		__m128i h, s, v;
+		compute_hsv_for_4_pixels_sse2(bgr + x*3, h, s, v);
+
+		for (int mask_index= 0; mask_index < mask_count; ++mask_index)
+		{
+			compute_hsv_mask_for_4_pixels_sse2(h, s, v, thresholds[mask_index], out_mask_rows[mask_index] + x);
+		}
+	}
+#endif
+
+	for (; x < width; ++x)
+	{
+		const uint8_t *pixel= bgr + x*3;
+		int h, s, v;
+		compute_hsv_for_pixel(pixel[0], pixel[1], pixel[2], h, s, v);
+
+		for (int mask_index= 0; mask_index < mask_count; ++mask_index)
+		{
+			out_mask_rows[mask_index][x]= compute_hsv_mask_for_pixel(h, s, v, thresholds[mask_index]);
+		}
+	}
+}
+
+static void debayer_grbg_row_to_bgr(
+	const uint8_t *bayer, const int frame_width, const int frame_height,
+	const int row, const int col_start, const int col_count,
+	uint8_t *out_bgr)
+{
+	// Edge rows and columns are replicated from their inner neighbors (same as debayerGRBGToBGR)
+	const int y= std::min(std::max(row, 1), frame_height-2);
+	const uint8_t *above= bayer + (y-1)*frame_width;
+	const uint8_t *center= bayer + y*frame_width;
+	const uint8_t *below= bayer + (y+1)*frame_width;
+
+	for (int i= 0; i < col_count; ++i)
+	{
+		const int x= std::min(std::max(col_start + i, 1), frame_width-2);
+		uint8_t *dest= out_bgr + i*3;
+		int b, g, r;
+
+		// GRBG:
+		// G R G R
+		// B G B G
+		switch (((y & 1) << 1) | (x & 1))
+		{
+		case 0: // Green pixel on a green/red row
+			b= (above[x] + below[x] + 1) >> 1;
+			g= center[x];
+			r= (center[x-1] + center[x+1] + 1) >> 1;
+			break;
+		case 1: // Red pixel
+			b= (above[x-1] + above[x+1] + below[x-1] + below[x+1] + 2) >> 2;
+			g= (above[x] + center[x-1] + center[x+1] + below[x] + 2) >> 2;
+			r= center[x];
+			break;
+		case 2: // Blue pixel
+			b= center[x];
+			g= (above[x] + center[x-1] + center[x+1] + below[x] + 2) >> 2;
+			r= (above[x-1] + above[x+1] + below[x-1] + below[x+1] + 2) >> 2;
+			break;
+		default: // Green pixel on a blue/green row
+			b= (center[x-1] + center[x+1] + 1) >> 1;
+			g= center[x];
+			r= (above[x] + below[x] + 1) >> 1;
+			break;
+		}
+
+		dest[0]= static_cast<uint8_t>(b);
+		dest[1]= static_cast<uint8_t>(g);
+		dest[2]= static_cast<uint8_t>(r);
+	}
+}
+
+//-- public interface -----
+HSVColorThresholds HSVColorThresholds::fromColorRange(const PSVR_HSVColorRange &hsvColorRange)
+{
+	HSVColorThresholds t;
+
+	const float hue_min = hsvColorRange.hue_range.center - hsvColorRange.hue_range.range;
+	const float hue_max = hsvColorRange.hue_range.center + hsvColorRange.hue_range.range;
+
+	t.saturation_min= clamp_round_to_int(hsvColorRange.saturation_range.center - hsvColorRange.saturation_range.range, 0, 255);
+	t.saturation_max= clamp_round_to_int(hsvColorRange.saturation_range.center + hsvColorRange.saturation_range.range, 0, 255);
+	t.value_min= clamp_round_to_int(hsvColorRange.value_range.center - hsvColorRange.value_range.range, 0, 255);
+	t.value_max= clamp_round_to_int(hsvColorRange.value_range.center + hsvColorRange.value_range.range, 0, 255);
+
+	// Split the hue range in two when it wraps around the hue angle
+	if (hue_min < 0)
+	{
+		t.hue_min[0]= 0;
+		t.hue_max[0]= clamp_round_to_int(hue_max, 0, k_hue_8u_max);
+		t.hue_min[1]= clamp_round_to_int(k_hue_8u_max + hue_min, 0, k_hue_8u_max);
+		t.hue_max[1]= k_hue_8u_max;
+	}
+	else if (hue_max > k_hue_8u_max)
+	{
+		t.hue_min[0]= 0;
+		t.hue_max[0]= clamp_round_to_int(hue_max - k_hue_8u_max, 0, k_hue_8u_max);
+		t.hue_min[1]= clamp_round_to_int(hue_min, 0, k_hue_8u_max);
+		t.hue_max[1]= k_hue_8u_max;
+	}
+	else
+	{
+		t.hue_min[0]= clamp_round_to_int(hue_min, 0, 255);
+		t.hue_max[0]= clamp_round_to_int(hue_max, 0, 255);
+		t.hue_min[1]= 1; // empty range
+		t.hue_max[1]= 0;
+	}
+
+	return t;
+}
+
+void debayerGRBGToBGR(int frame_width, int frame_height, const uint8_t* inBayer, uint8_t* outBuffer, bool inBGR)
+{
+	// PSMove output is in the following Bayer format (GRBG):
+	//
+	// G R G R G R
+	// B G B G B G
+	// G R G R G R
+	// B G B G B G
+	//
+	// This is the normal Bayer pattern shifted left one place.
+
+	int				num_output_channels	    = 3;
+	int				source_stride			= frame_width;
+	const uint8_t*	source_row				= inBayer;												// Start at first bayer pixel
+	int				dest_stride				= frame_width * num_output_channels;
+	uint8_t*		dest_row				= outBuffer + dest_stride + num_output_channels + 1; 	// We start outputting at the second pixel of the second row's G component
+	int				swap_br					= inBGR ? 1 : -1;
+
+	// Fill rows 1 to height-1 of the destination buffer. First and last row are filled separately (they are copied from the second row and second-to-last rows respectively)
+	for (int y = 0; y < frame_height-1; source_row += source_stride, dest_row += dest_stride, ++y)
+	{
+		const uint8_t* source		= source_row;
+		const uint8_t* source_end	= source + (source_stride-2);								// -2 to deal with the fact that we're starting at the second pixel of the row and should end at the second-to-last pixel of the row (first and last are filled separately)
+		uint8_t* dest				= dest_row;
+
+		// Row starting with Green
+		if (y % 2 == 0)
+		{
+			// Fill first pixel (green)
+			dest[-1*swap_br]	= (source[source_stride] + source[source_stride + 2] + 1) >> 1;
+			dest[0]				= source[source_stride + 1];
+			dest[1*swap_br]		= (source[1] + source[source_stride * 2 + 1] + 1) >> 1;
+
+			source++;
+			dest += num_output_channels;
+
+			// Fill remaining pixel
+			for (; source <= source_end - 2; source += 2, dest += num_output_channels * 2)
+			{
+				// Blue pixel
+				uint8_t* cur_pixel	= dest;
+				cur_pixel[-1*swap_br]	= source[source_stride + 1];
+				cur_pixel[0]			= (source[1] + source[source_stride] + source[source_stride + 2] + source[source_stride * 2 + 1] + 2) >> 2;
+				cur_pixel[1*swap_br]	= (source[0] + source[2] + source[source_stride * 2] + source[source_stride * 2 + 2] + 2) >> 2;
+
+				//  Green pixel
+				uint8_t* next_pixel		= cur_pixel+num_output_channels;
+				next_pixel[-1*swap_br]	= (source[source_stride + 1] + source[source_stride + 3] + 1) >> 1;
+				next_pixel[0]			= source[source_stride + 2];
+				next_pixel[1*swap_br]	= (source[2] + source[source_stride * 2 + 2] + 1) >> 1;
+			}
+		}
+		else
+		{
+			for (; source <= source_end - 2; source += 2, dest += num_output_channels * 2)
+			{
+				// Red pixel
+				uint8_t* cur_pixel	= dest;
+				cur_pixel[-1*swap_br]	= (source[0] + source[2] + source[source_stride * 2] + source[source_stride * 2 + 2] + 2) >> 2;;
+				cur_pixel[0]			= (source[1] + source[source_stride] + source[source_stride + 2] + source[source_stride * 2 + 1] + 2) >> 2;;
+				cur_pixel[1*swap_br]	= source[source_stride + 1];
+
+				// Green pixel
+				uint8_t* next_pixel		= cur_pixel+num_output_channels;
+				next_pixel[-1*swap_br]	= (source[2] + source[source_stride * 2 + 2] + 1) >> 1;
+				next_pixel[0]			= source[source_stride + 2];
+				next_pixel[1*swap_br]	= (source[source_stride + 1] + source[source_stride + 3] + 1) >> 1;
+			}
+		}
+
+		if (source < source_end)
+		{
+			dest[-1*swap_br]	= source[source_stride + 1];
+			dest[0]				= (source[1] + source[source_stride] + source[source_stride + 2] + source[source_stride * 2 + 1] + 2) >> 2;
+			dest[1*swap_br]		= (source[0] + source[2] + source[source_stride * 2] + source[source_stride * 2 + 2] + 2) >> 2;;
+
+			source++;
+			dest += num_output_channels;
+		}
+
+		// Fill first pixel of row (copy second pixel)
+		uint8_t* first_pixel		= dest_row-num_output_channels;
+		first_pixel[-1*swap_br]		= dest_row[-1*swap_br];
+		first_pixel[0]				= dest_row[0];
+		first_pixel[1*swap_br]		= dest_row[1*swap_br];
+
+		// Fill last pixel of row (copy second-to-last pixel). Note: dest row starts at the *second* pixel of the row, so dest_row + (width-2) * num_output_channels puts us at the last pixel of the row
+		uint8_t* last_pixel				= dest_row + (frame_width - 2)*num_output_channels;
+		uint8_t* second_to_last_pixel	= last_pixel - num_output_channels;
+
+		last_pixel[-1*swap_br]			= second_to_last_pixel[-1*swap_br];
+		last_pixel[0]					= second_to_last_pixel[0];
+		last_pixel[1*swap_br]			= second_to_last_pixel[1*swap_br];
+	}
+
+	// Fill first & last row
+	for (int i = 0; i < dest_stride; i++)
+	{
+		outBuffer[i]									= outBuffer[i + dest_stride];
+		outBuffer[i + (frame_height - 1)*dest_stride]	= outBuffer[i + (frame_height - 2)*dest_stride];
+	}
+}
+
+void computeHSVMaskFromBGR(
+	const uint8_t *bgr, int bgr_stride,
+	int width, int height,
+	const HSVColorThresholds &thresholds,
+	uint8_t *out_mask, int mask_stride)
+{
+	computeHSVMasksFromBGR(bgr, bgr_stride, width, height, &thresholds, 1, &out_mask, mask_stride);
+}
+
+void computeHSVMasksFromBGR(
+	const uint8_t *bgr, int bgr_stride,
+	int width, int height,
+	const HSVColorThresholds *thresholds, int mask_count,
+	uint8_t * const *out_masks, int mask_stride)
+{
+	assert(mask_count <= HSV_MASK_MAX_COUNT);
+	uint8_t *mask_rows[HSV_MASK_MAX_COUNT];
+
+	for (int y= 0; y < height; ++y)
+	{
+		for (int mask_index= 0; mask_index < mask_count; ++mask_index)
+		{
+			mask_rows[mask_index]= out_masks[mask_index] + y*mask_stride;
+		}
+
+		compute_hsv_masks_for_bgr_row(bgr + y*bgr_stride, width, thresholds, mask_count, mask_rows);
+	}
+}
+
+void computeHSVMaskFromBayerGRBG(
+	const uint8_t *bayer, int frame_width, int frame_height,
+	int roi_x, int roi_y, int roi_width, int roi_height,
+	const HSVColorThresholds &thresholds,
+	uint8_t *bgr_row_scratch,
+	uint8_t *out_mask, int mask_stride)
+{
+	computeHSVMasksFromBayerGRBG(
+		bayer, frame_width, frame_height,
+		roi_x, roi_y, roi_width, roi_height,
+		&thresholds, 1,
+		bgr_row_scratch,
+		&out_mask, mask_stride);
+}
+
+void computeHSVMasksFromBayerGRBG(
+	const uint8_t *bayer, int frame_width, int frame_height,
+	int roi_x, int roi_y, int roi_width, int roi_height,
+	const HSVColorThresholds *thresholds, int mask_count,
+	uint8_t *bgr_row_scratch,
+	uint8_t * const *out_masks, int mask_stride)
+{
+	assert(mask_count <= HSV_MASK_MAX_COUNT);
+	uint8_t *mask_rows[HSV_MASK_MAX_COUNT];
+
+	for (int y= 0; y < roi_height; ++y)
+	{
+		for (int mask_index= 0; mask_index < mask_count; ++mask_index)
+		{
+			mask_rows[mask_index]= out_masks[mask_index] + y*mask_stride;
+		}
+
+		// The demosaiced row stays in cache for the mask pass
+		debayer_grbg_row_to_bgr(bayer, frame_width, frame_height, roi_y + y, roi_x, roi_width, bgr_row_scratch);
+		compute_hsv_masks_for_bgr_row(bgr_row_scratch, roi_width, thresholds, mask_count, mask_rows);
+	}
+}
@@ -0,0 +1,74 @@
+#ifndef TRACKER_IMAGE_PROCESSING_H
+#define TRACKER_IMAGE_PROCESSING_H
+
+// -- includes -----
+#include "ClientColor_CAPI.h"
+
+#include <stdint.h>
+
+// -- constants -----
+// Max number of masks that can be computed in a single pass over a frame
+#define HSV_MASK_MAX_COUNT	8
+
+// -- definitions -----
+// HSV color range converted into the inclusive 8-bit bounds used by the segmentation kernels.
+// Hue follows the OpenCV 8-bit convention [0, 180]. A color range whose hue wraps around
+// 0/180 is split into two hue intervals. The second interval is left empty (min > max)
+// when the hue range doesn't wrap.
+struct HSVColorThresholds
+{
+	int hue_min[2];
+	int hue_max[2];
+	int saturation_min, saturation_max;
+	int value_min, value_max;
+
+	static HSVColorThresholds fromColorRange(const PSVR_HSVColorRange &hsvColorRange);
+};
+
+// -- interface -----
+/// Converts a GRBG Bayer frame into a full BGR (or RGB) frame.
+/// The first and last row and column of the output are copied from their neighbors.
+void debayerGRBGToBGR(
+	int frame_width, int frame_height,
+	const uint8_t* inBayer,
+	uint8_t* outBuffer,
+	bool inBGR);
+
+/// Writes a binary mask (0x00 or 0xFF per pixel) for every pixel in a BGR region
+/// whose HSV value falls within the given thresholds.
+/// The HSV conversion and the range test happen in a single pass; no HSV image is produced.
+void computeHSVMaskFromBGR(
+	const uint8_t *bgr, int bgr_stride,
+	int width, int height,
+	const HSVColorThresholds &thresholds,
+	uint8_t *out_mask, int mask_stride);
+
+/// Same as computeHSVMaskFromBGR() but tests every pixel against several sets of thresholds,
+/// writing one mask per set. Each pixel is only converted to HSV once.
+/// mask_count must not exceed HSV_MASK_MAX_COUNT. All masks share the same stride.
+void computeHSVMasksFromBGR(
+	const uint8_t *bgr, int bgr_stride,
+	int width, int height,
+	const HSVColorThresholds *thresholds, int mask_count,
+	uint8_t * const *out_masks, int mask_stride);
+
+/// Same as computeHSVMaskFromBGR() but reads directly from a GRBG Bayer frame.
+/// Only the region [roi_x, roi_x+roi_width) x [roi_y, roi_y+roi_height) is demosaiced,
+/// one row at a time into the caller provided scratch buffer (at least 3*roi_width bytes).
+/// The mask is written relative to the region origin.
+void computeHSVMaskFromBayerGRBG(
+	const uint8_t *bayer, int frame_width, int frame_height,
+	int roi_x, int roi_y, int roi_width, int roi_height,
+	const HSVColorThresholds &thresholds,
+	uint8_t *bgr_row_scratch,
+	uint8_t *out_mask, int mask_stride);
+
+/// Multiple mask version of computeHSVMaskFromBayerGRBG() (see computeHSVMasksFromBGR()).
+void computeHSVMasksFromBayerGRBG(
+	const uint8_t *bayer, int frame_width, int frame_height,
+	int roi_x, int roi_y, int roi_width, int roi_height,
+	const HSVColorThresholds *thresholds, int mask_count,
+	uint8_t *bgr_row_scratch,
+	uint8_t * const *out_masks, int mask_stride);
+
+#endif // TRACKER_IMAGE_PROCESSING_H
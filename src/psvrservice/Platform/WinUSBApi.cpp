@@ -911,6 +911,124 @@ eUSBResultCode WinUSBApi::submit_control_transfer(
     return result.payload.control_transfer.result_code;
 }
 
+// WinUSB control transfers are synchronous, so the whole batch runs right here on the worker thread.
+// Once it has run the result is posted from here, failed or not, and the batch is reported as completed.
+eUSBResultCode WinUSBApi::submit_control_transfer_batch(
+	const USBDeviceState* device_state,
+	const USBTransferRequestState *requestState)
+{
+	const WinUSBDeviceState *winusb_device_state = static_cast<const WinUSBDeviceState *>(device_state);
+    const USBRequestPayload_ControlTransferBatch &request = requestState->request.payload.control_transfer_batch;
+
+	if (request.ops == nullptr || request.op_count <= 0)
+	{
+		return _USBResultCode_GeneralError;
+	}
+
+	USBTransferResult result;
+	memset(&result, 0, sizeof(USBTransferResult));
+	result.result_type = _USBResultType_ControlTransferBatch;
+	result.payload.control_transfer_batch.usb_device_handle = request.usb_device_handle;
+
+    DWORD LastErrorCode= ERROR_SUCCESS;
+    for (int op_index = 0; op_index < request.op_count && LastErrorCode == ERROR_SUCCESS; ++op_index)
+    {
+        const USBControlTransferBatchOp &op = request.ops[op_index];
+        const bool bIsWrite = (op.op_type == _USBControlTransferBatchOp_Write);
+
+        WINUSB_SETUP_PACKET setupPacket;
+        memset(&setupPacket, 0, sizeof(WINUSB_SETUP_PACKET));
+        setupPacket.RequestType = (request.bmRequestType & ~USB_ENDPOINT_IN) | (bIsWrite ? USB_ENDPOINT_OUT : USB_ENDPOINT_IN);
+        setupPacket.Request = request.bRequest;
+        setupPacket.Index = op.wIndex;
+        setupPacket.Length = 1;
+        setupPacket.Value = request.wValue;
+
+        bool bGotReadValue= false;
+        for (int attempt = 0; ; ++attempt)
+        {
+            unsigned char data = bIsWrite ? op.value : 0;
+            ULONG bytesTransferred= 0;
+
+            if (WinUsb_ControlTransfer(
+                    winusb_device_state->interface_handle,
+                    setupPacket,
+                    &data,
+                    1,
+                    &bytesTransferred,
+                    NULL) == FALSE)
+            {
+                LastErrorCode= GetLastError();
+                break;
+            }
+
+            if (bIsWrite || bytesTransferred == 0)
+                break;
+
+            result.payload.control_transfer_batch.last_read_value = data;
+            bGotReadValue= true;
+
+            // Keep polling the register until it reads what we're waiting for (or reports a failure)
+            if (op.op_type != _USBControlTransferBatchOp_PollRead || data == op.value)
+                break;
+
+            if (data == op.fail_value || attempt + 1 >= op.max_attempts)
+            {
+                ++result.payload.control_transfer_batch.failed_poll_count;
+                break;
+            }
+        }
+
+        // Write the register back with the op's bits set or cleared
+        if (LastErrorCode == ERROR_SUCCESS && bGotReadValue &&
+            (op.op_type == _USBControlTransferBatchOp_SetBits || op.op_type == _USBControlTransferBatchOp_ClearBits))
+        {
+            unsigned char data = result.payload.control_transfer_batch.last_read_value;
+            ULONG bytesTransferred= 0;
+
+            data = (op.op_type == _USBControlTransferBatchOp_SetBits) ? (data | op.value) : (data & ~op.value);
+            setupPacket.RequestType = (request.bmRequestType & ~USB_ENDPOINT_IN) | USB_ENDPOINT_OUT;
+
+            if (WinUsb_ControlTransfer(
+                    winusb_device_state->interface_handle,
+                    setupPacket,
+                    &data,
+                    1,
+                    &bytesTransferred,
+                    NULL) == FALSE)
+            {
+                LastErrorCode= GetLastError();
+            }
+        }
+
+        if (LastErrorCode == ERROR_SUCCESS)
+        {
+            result.payload.control_transfer_batch.completed_op_count = op_index + 1;
+        }
+    }
+
+    switch (LastErrorCode)
+    {
+    case ERROR_SUCCESS:
+        result.payload.control_transfer_batch.result_code = _USBResultCode_Completed;
+        break;
+    case ERROR_INVALID_HANDLE:
+        result.payload.control_transfer_batch.result_code = _USBResultCode_BadHandle;
+        break;
+    case ERROR_NOT_ENOUGH_MEMORY:
+        result.payload.control_transfer_batch.result_code = _USBResultCode_NoMemory;
+        break;
+    default:
+        result.payload.control_transfer_batch.result_code = _USBResultCode_GeneralError;
+        break;
+    }
+
+	// Add the result to the outgoing result queue
+	usb_device_post_transfer_result(result, requestState->callback);
+
+    return _USBResultCode_Completed;
+}
+
 eUSBResultCode WinUSBApi::submit_bulk_transfer(
 	const USBDeviceState* device_state,
 	const USBTransferRequestState *requestState)
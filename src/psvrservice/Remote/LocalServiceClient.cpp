@@ -0,0 +1,228 @@
+//-- includes -----
+#include "LocalServiceClient.h"
+#include "Logger.h"
+
+#include <cstring>
+
+#include <errno.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+//-- constants -----
+#ifdef MSG_NOSIGNAL
+static const int k_send_flags= MSG_NOSIGNAL;
+#else
+static const int k_send_flags= 0; // SO_NOSIGPIPE is set on the socket instead
+#endif
+
+//-- implementation -----
+LocalServiceClient::LocalServiceClient()
+	: m_socket(-1)
+	, m_timeoutMs(0)
+	, m_nextRequestId(1)
+	, m_responseBytesRead(0)
+	, m_messageQueue()
+	, m_dataFrameBuffer()
+{
+	memset(&m_response, 0, sizeof(m_response));
+}
+
+LocalServiceClient::~LocalServiceClient()
+{
+	disconnect();
+}
+
+bool LocalServiceClient::connect(const std::string &socket_path, int timeout_ms)
+{
+	disconnect();
+
+	struct sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family= AF_UNIX;
+
+	if (socket_path.length() >= sizeof(address.sun_path))
+	{
+		PSVR_LOG_ERROR("LocalServiceClient::connect") << "Socket path too long: " << socket_path;
+		return false;
+	}
+	strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+
+	m_socket= socket(AF_UNIX, SOCK_STREAM, 0);
+	if (m_socket < 0)
+	{
+		PSVR_LOG_ERROR("LocalServiceClient::connect") << "Failed to create socket: " << strerror(errno);
+		return false;
+	}
+
+#if !defined(MSG_NOSIGNAL) && defined(SO_NOSIGPIPE)
+	int no_sigpipe= 1;
+	setsockopt(m_socket, SOL_SOCKET, SO_NOSIGPIPE, &no_sigpipe, sizeof(no_sigpipe));
+#endif
+
+	if (::connect(m_socket, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)) != 0)
+	{
+		PSVR_LOG_WARNING("LocalServiceClient::connect") << "No psvrservice listening on " << socket_path << ": " << strerror(errno);
+		disconnect();
+		return false;
+	}
+
+	// The daemon creates the data frame region before it starts listening
+	if (!m_dataFrameBuffer.open(PSVR_SHARED_DATA_FRAME_BUFFER_NAME))
+	{
+		PSVR_LOG_ERROR("LocalServiceClient::connect") << "Failed to open the psvrservice data frame buffer";
+		disconnect();
+		return false;
+	}
+
+	m_timeoutMs= timeout_ms;
+	m_responseBytesRead= 0;
+
+	return true;
+}
+
+void LocalServiceClient::disconnect()
+{
+	if (m_socket >= 0)
+	{
+		close(m_socket);
+		m_socket= -1;
+	}
+
+	m_dataFrameBuffer.dispose();
+	m_messageQueue.clear();
+	m_responseBytesRead= 0;
+}
+
+bool LocalServiceClient::sendRequest(LocalServiceRequest &request, LocalServiceResponse &out_response)
+{
+	if (m_socket < 0)
+		return false;
+
+	request.protocol_version= PSVR_LOCAL_SERVICE_PROTOCOL_VERSION;
+	request.request_id= m_nextRequestId++;
+	if (m_nextRequestId <= 0)
+	{
+		// 0 is reserved for notifications
+		m_nextRequestId= 1;
+	}
+
+	const unsigned char *request_bytes= reinterpret_cast<const unsigned char *>(&request);
+	size_t bytes_sent= 0;
+	while (bytes_sent < sizeof(LocalServiceRequest))
+	{
+		const ssize_t result= send(m_socket, request_bytes + bytes_sent, sizeof(LocalServiceRequest) - bytes_sent, k_send_flags);
+
+		if (result < 0)
+		{
+			if (errno == EINTR)
+				continue;
+
+			PSVR_LOG_ERROR("LocalServiceClient::sendRequest") << "Lost connection to psvrservice: " << strerror(errno);
+			disconnect();
+			return false;
+		}
+
+		bytes_sent+= static_cast<size_t>(result);
+	}
+
+	while (receiveResponse(true, out_response))
+	{
+		if (out_response.response_type == LocalServiceResponse_notification)
+		{
+			m_messageQueue.push_back(out_response.payload.event_message);
+		}
+		else if (out_response.request_id == request.request_id)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void LocalServiceClient::pollNotifications()
+{
+	LocalServiceResponse response;
+
+	while (receiveResponse(false, response))
+	{
+		if (response.response_type == LocalServiceResponse_notification)
+		{
+			m_messageQueue.push_back(response.payload.event_message);
+		}
+	}
+}
+
+bool LocalServiceClient::pollNextMessage(PSVREventMessage &out_message)
+{
+	if (m_messageQueue.empty())
+		return false;
+
+	out_message= m_messageQueue.front();
+	m_messageQueue.pop_front();
+
+	return true;
+}
+
+bool LocalServiceClient::receiveResponse(bool bBlocking, LocalServiceResponse &out_response)
+{
+	while (m_socket >= 0)
+	{
+		struct pollfd poll_fd;
+		poll_fd.fd= m_socket;
+		poll_fd.events= POLLIN;
+		poll_fd.revents= 0;
+
+		const int ready= ::poll(&poll_fd, 1, bBlocking ? m_timeoutMs : 0);
+		if (ready < 0 && errno == EINTR)
+			continue;
+
+		if (ready <= 0)
+		{
+			if (bBlocking)
+			{
+				PSVR_LOG_ERROR("LocalServiceClient::receiveResponse") << "Timed out waiting on psvrservice";
+			}
+
+			return false;
+		}
+
+		unsigned char *response_bytes= reinterpret_cast<unsigned char *>(&m_response);
+		const ssize_t bytes_read=
+			recv(m_socket,
+				response_bytes + m_responseBytesRead,
+				sizeof(LocalServiceResponse) - m_responseBytesRead,
+				0);
+
+		if (bytes_read <= 0)
+		{
+			if (bytes_read < 0 && errno == EINTR)
+				continue;
+
+			PSVR_LOG_ERROR("LocalServiceClient::receiveResponse") << "psvrservice closed the connection";
+			disconnect();
+			return false;
+		}
+
+		m_responseBytesRead+= static_cast<size_t>(bytes_read);
+		if (m_responseBytesRead == sizeof(LocalServiceResponse))
+		{
+			m_responseBytesRead= 0;
+
+			if (m_response.protocol_version != PSVR_LOCAL_SERVICE_PROTOCOL_VERSION)
+			{
+				PSVR_LOG_ERROR("LocalServiceClient::receiveResponse") << "psvrservice speaks protocol version "
+					<< m_response.protocol_version << " (expected " << PSVR_LOCAL_SERVICE_PROTOCOL_VERSION << ")";
+				disconnect();
+				return false;
+			}
+
+			out_response= m_response;
+			return true;
+		}
+	}
+
+	return false;
+}
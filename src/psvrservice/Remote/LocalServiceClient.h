@@ -0,0 +1,50 @@
+#ifndef LOCAL_SERVICE_CLIENT_H
+#define LOCAL_SERVICE_CLIENT_H
+
+//-- includes -----
+#include "LocalServiceProtocol.h"
+#include "SharedDataFrameBuffer.h"
+#include <deque>
+#include <string>
+
+//-- definitions -----
+// Talks to a psvrservice daemon running in another process (see LocalServiceServer).
+// Requests block until the daemon answers. Data frames are read straight out of the daemon's
+// shared data frame region, so sampling a pose never touches the socket.
+class LocalServiceClient
+{
+public:
+	LocalServiceClient();
+	~LocalServiceClient();
+
+	bool connect(const std::string &socket_path, int timeout_ms);
+	void disconnect();
+
+	inline bool getIsConnected() const { return m_socket >= 0; }
+
+	// Sends the request and waits for its response, queuing any notification that arrives first
+	bool sendRequest(LocalServiceRequest &request, LocalServiceResponse &out_response);
+
+	// Reads any notifications the daemon sent since the last call, without blocking
+	void pollNotifications();
+	bool pollNextMessage(PSVREventMessage &out_message);
+
+	inline const SharedDataFrameBuffer &getDataFrameBuffer() const { return m_dataFrameBuffer; }
+
+private:
+	// Reads until a whole response is buffered. Returns false on timeout/would block or a dropped connection.
+	bool receiveResponse(bool bBlocking, LocalServiceResponse &out_response);
+
+	int m_socket;
+	int m_timeoutMs;
+	int m_nextRequestId;
+	LocalServiceResponse m_response;
+	size_t m_responseBytesRead;
+	std::deque<PSVREventMessage> m_messageQueue;
+	SharedDataFrameBuffer m_dataFrameBuffer;
+
+	LocalServiceClient(const LocalServiceClient&);
+	void operator=(const LocalServiceClient&);
+};
+
+#endif // LOCAL_SERVICE_CLIENT_H
@@ -0,0 +1,103 @@
+#ifndef LOCAL_SERVICE_PROTOCOL_H
+#define LOCAL_SERVICE_PROTOCOL_H
+
+//-- includes -----
+#include "PSVRServiceInterface.h"
+#include <atomic>
+#include <stdint.h>
+
+//-- constants -----
+// Where the psvrservice daemon listens for local clients unless told otherwise
+#define PSVR_LOCAL_SERVICE_DEFAULT_SOCKET_PATH "/tmp/psvrservice.sock"
+
+// Name of the shared memory region the daemon publishes device data frames into (see SharedDataFrameBuffer)
+#define PSVR_SHARED_DATA_FRAME_BUFFER_NAME "data_frames"
+
+// Bumped whenever the request/response or data frame layouts below change.
+// Both ends are built from the same tree, so a mismatch just means a stale daemon or client.
+#define PSVR_LOCAL_SERVICE_PROTOCOL_VERSION 2
+
+#define PSVR_LOCAL_SERVICE_MAX_STREAM_NAME_LEN 64
+
+//-- definitions -----
+// Requests and responses are fixed size structs sent whole over a local stream socket.
+// The client sends one request at a time and blocks for the response with the same request_id.
+// The daemon also sends unsolicited notifications, as responses with a request_id of 0.
+enum LocalServiceRequestType
+{
+	LocalServiceRequest_getServiceVersion,
+	LocalServiceRequest_getTrackerList,
+	LocalServiceRequest_getHmdList,
+	LocalServiceRequest_startTrackerDataStream,
+	LocalServiceRequest_stopTrackerDataStream,
+	LocalServiceRequest_getTrackerVideoStreamName,
+	LocalServiceRequest_startHmdDataStream,
+	LocalServiceRequest_stopHmdDataStream,
+};
+
+enum LocalServiceResponseType
+{
+	LocalServiceResponse_result,
+	LocalServiceResponse_notification,
+};
+
+struct LocalServiceRequest
+{
+	uint32_t protocol_version;
+	int request_id;
+	LocalServiceRequestType request_type;
+	union
+	{
+		struct
+		{
+			PSVRTrackerID tracker_id;
+		} tracker_request;
+		struct
+		{
+			PSVRHmdID hmd_id;
+			unsigned int data_stream_flags;
+		} hmd_request;
+	} payload;
+};
+
+struct LocalServiceResponse
+{
+	uint32_t protocol_version;
+	int request_id;
+	LocalServiceResponseType response_type;
+	PSVRResult result;
+	union
+	{
+		PSVRServiceVersion service_version;
+		PSVRTrackerList tracker_list;
+		PSVRHmdList hmd_list;
+		char video_stream_name[PSVR_LOCAL_SERVICE_MAX_STREAM_NAME_LEN];
+		PSVREventMessage event_message;
+	} payload;
+};
+
+// Layout of the shared data frame region.
+// The header is followed by tracker_slot_count tracker slots and then hmd_slot_count hmd slots,
+// slot_size bytes apart starting at first_slot_offset.
+// Every slot holds the latest data frame of one device, guarded by a seqlock like the video frame slots:
+// the sequence is odd while the daemon is writing the frame and goes up by two for every frame written.
+#define PSVR_SHARED_DATA_FRAME_MAGIC 0x50535644 // "PSVD"
+
+struct SharedDataFrameSlot
+{
+	std::atomic<uint64_t> sequence;
+	DeviceOutputDataFrame data_frame;
+};
+
+struct SharedDataFrameHeader
+{
+	std::atomic<uint32_t> magic;
+	uint32_t version;
+	uint32_t tracker_slot_count;
+	uint32_t hmd_slot_count;
+	uint32_t data_frame_size;
+	uint32_t slot_size;
+	uint64_t first_slot_offset;
+};
+
+#endif // LOCAL_SERVICE_PROTOCOL_H
@@ -0,0 +1,480 @@
+//-- includes -----
+#include "LocalServiceServer.h"
+#include "Logger.h"
+#include "PSVRService.h"
+#include "ServiceRequestHandler.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+//-- constants -----
+// Pending connections the kernel queues up between calls to poll()
+static const int k_listen_backlog= 8;
+
+#ifdef MSG_NOSIGNAL
+static const int k_send_flags= MSG_NOSIGNAL;
+#else
+static const int k_send_flags= 0; // SO_NOSIGPIPE is set on each socket instead
+#endif
+
+//-- private methods -----
+static bool set_socket_non_blocking(int socket);
+static void set_socket_no_sigpipe(int socket);
+static bool remove_stale_socket(const struct sockaddr_un &address);
+
+//-- implementation -----
+LocalServiceServer::LocalServiceServer()
+	: m_socketPath()
+	, m_listenSocket(-1)
+	, m_connections()
+	, m_dataFrameBuffer()
+	, m_activeTrackerStreams()
+	, m_activeHmdStreams()
+{
+	memset(m_activeHmdStreamFlags, 0, sizeof(m_activeHmdStreamFlags));
+}
+
+LocalServiceServer::~LocalServiceServer()
+{
+	shutdown();
+}
+
+bool LocalServiceServer::startup(const std::string &socket_path)
+{
+	struct sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family= AF_UNIX;
+
+	if (socket_path.length() >= sizeof(address.sun_path))
+	{
+		PSVR_LOG_ERROR("LocalServiceServer::startup") << "Socket path too long: " << socket_path;
+		return false;
+	}
+	strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+
+	// Check before touching the shared data frame buffer, which another daemon would be using too
+	if (!remove_stale_socket(address))
+	{
+		PSVR_LOG_ERROR("LocalServiceServer::startup") << "Another psvrservice is already listening on " << socket_path;
+		return false;
+	}
+
+	if (!m_dataFrameBuffer.initialize(PSVR_SHARED_DATA_FRAME_BUFFER_NAME))
+	{
+		PSVR_LOG_ERROR("LocalServiceServer::startup") << "Failed to create the shared data frame buffer";
+		return false;
+	}
+
+	m_listenSocket= socket(AF_UNIX, SOCK_STREAM, 0);
+	if (m_listenSocket < 0)
+	{
+		PSVR_LOG_ERROR("LocalServiceServer::startup") << "Failed to create socket: " << strerror(errno);
+		shutdown();
+		return false;
+	}
+
+	if (bind(m_listenSocket, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)) != 0 ||
+		listen(m_listenSocket, k_listen_backlog) != 0 ||
+		!set_socket_non_blocking(m_listenSocket))
+	{
+		PSVR_LOG_ERROR("LocalServiceServer::startup") << "Failed to listen on " << socket_path << ": " << strerror(errno);
+		shutdown();
+		return false;
+	}
+
+	m_socketPath= socket_path;
+	PSVR_LOG_INFO("LocalServiceServer::startup") << "Listening for clients on " << socket_path;
+
+	return true;
+}
+
+void LocalServiceServer::poll()
+{
+	if (m_listenSocket < 0)
+		return;
+
+	acceptConnections();
+
+	for (Connection &connection : m_connections)
+	{
+		if (!readRequests(connection))
+		{
+			closeConnection(connection);
+		}
+	}
+
+	m_connections.erase(
+		std::remove_if(
+			m_connections.begin(), m_connections.end(),
+			[](const Connection &connection) { return connection.socket < 0; }),
+		m_connections.end());
+}
+
+void LocalServiceServer::shutdown()
+{
+	for (Connection &connection : m_connections)
+	{
+		closeConnection(connection);
+	}
+	m_connections.clear();
+
+	if (m_listenSocket >= 0)
+	{
+		close(m_listenSocket);
+		m_listenSocket= -1;
+	}
+
+	if (m_socketPath.length() > 0)
+	{
+		unlink(m_socketPath.c_str());
+		m_socketPath= "";
+	}
+
+	m_dataFrameBuffer.dispose();
+}
+
+// IDataFrameListener
+void LocalServiceServer::handle_data_frame(const DeviceOutputDataFrame &data_frame)
+{
+	// Clients sample the newest frame out of shared memory at their own rate
+	m_dataFrameBuffer.writeDataFrame(data_frame);
+}
+
+// INotificationListener
+void LocalServiceServer::handle_notification(const PSVREventMessage &event)
+{
+	LocalServiceResponse notification;
+	memset(&notification, 0, sizeof(notification));
+	notification.protocol_version= PSVR_LOCAL_SERVICE_PROTOCOL_VERSION;
+	notification.request_id= 0;
+	notification.response_type= LocalServiceResponse_notification;
+	notification.result= PSVRResult_Success;
+	notification.payload.event_message= event;
+
+	for (Connection &connection : m_connections)
+	{
+		if (connection.socket >= 0 && !sendResponse(connection, notification))
+		{
+			// We're inside PSVRService::update() here, so leave releasing the client's streams to poll().
+			// It sees the hung up socket on its next read.
+			::shutdown(connection.socket, SHUT_RDWR);
+		}
+	}
+}
+
+void LocalServiceServer::acceptConnections()
+{
+	for (;;)
+	{
+		const int client_socket= accept(m_listenSocket, nullptr, nullptr);
+		if (client_socket < 0)
+			break;
+
+		if (!set_socket_non_blocking(client_socket))
+		{
+			close(client_socket);
+			continue;
+		}
+		set_socket_no_sigpipe(client_socket);
+
+		Connection connection;
+		memset(&connection.request, 0, sizeof(connection.request));
+		connection.socket= client_socket;
+		connection.request_bytes_read= 0;
+		memset(connection.hmd_stream_flags, 0, sizeof(connection.hmd_stream_flags));
+		m_connections.push_back(connection);
+
+		PSVR_LOG_INFO("LocalServiceServer::acceptConnections") << "Client connected (" << m_connections.size() << " connected)";
+	}
+}
+
+bool LocalServiceServer::readRequests(Connection &connection)
+{
+	if (connection.socket < 0)
+		return true;
+
+	for (;;)
+	{
+		unsigned char *request_bytes= reinterpret_cast<unsigned char *>(&connection.request);
+		const ssize_t bytes_read=
+			recv(connection.socket,
+				request_bytes + connection.request_bytes_read,
+				sizeof(LocalServiceRequest) - connection.request_bytes_read,
+				0);
+
+		if (bytes_read == 0)
+		{
+			// Client hung up
+			return false;
+		}
+		else if (bytes_read < 0)
+		{
+			return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+		}
+
+		connection.request_bytes_read+= static_cast<size_t>(bytes_read);
+		if (connection.request_bytes_read < sizeof(LocalServiceRequest))
+			continue;
+
+		connection.request_bytes_read= 0;
+
+		LocalServiceResponse response;
+		memset(&response, 0, sizeof(response));
+		response.protocol_version= PSVR_LOCAL_SERVICE_PROTOCOL_VERSION;
+		response.request_id= connection.request.request_id;
+		response.response_type= LocalServiceResponse_result;
+		response.result= PSVRResult_Error;
+
+		if (connection.request.protocol_version != PSVR_LOCAL_SERVICE_PROTOCOL_VERSION)
+		{
+			PSVR_LOG_WARNING("LocalServiceServer::readRequests") << "Dropping client speaking protocol version "
+				<< connection.request.protocol_version << " (expected " << PSVR_LOCAL_SERVICE_PROTOCOL_VERSION << ")";
+			sendResponse(connection, response);
+			return false;
+		}
+
+		handleRequest(connection, connection.request, response);
+
+		if (!sendResponse(connection, response))
+			return false;
+	}
+}
+
+void LocalServiceServer::handleRequest(
+	Connection &connection,
+	const LocalServiceRequest &request,
+	LocalServiceResponse &response)
+{
+	ServiceRequestHandler *request_handler= PSVRService::getInstance()->getRequestHandler();
+
+	switch (request.request_type)
+	{
+	case LocalServiceRequest_getServiceVersion:
+		response.result=
+			request_handler->get_service_version(
+				response.payload.service_version.version_string,
+				sizeof(response.payload.service_version.version_string));
+		break;
+	case LocalServiceRequest_getTrackerList:
+		response.result= request_handler->get_tracker_list(&response.payload.tracker_list);
+		break;
+	case LocalServiceRequest_getHmdList:
+		response.result= request_handler->get_hmd_list(&response.payload.hmd_list);
+		break;
+	case LocalServiceRequest_startTrackerDataStream:
+	case LocalServiceRequest_stopTrackerDataStream:
+		{
+			const PSVRTrackerID tracker_id= request.payload.tracker_request.tracker_id;
+
+			if (tracker_id >= 0 && tracker_id < PSVRSERVICE_MAX_TRACKER_COUNT)
+			{
+				const bool bStart= request.request_type == LocalServiceRequest_startTrackerDataStream;
+
+				connection.tracker_streams.set(tracker_id, bStart);
+				updateTrackerStream(tracker_id);
+
+				// Stopping always succeeds for this client, other clients may keep the stream open
+				response.result=
+					(!bStart || m_activeTrackerStreams.test(tracker_id))
+					? PSVRResult_Success
+					: PSVRResult_Error;
+			}
+		} break;
+	case LocalServiceRequest_getTrackerVideoStreamName:
+		response.result=
+			request_handler->get_tracker_video_stream_name(
+				request.payload.tracker_request.tracker_id,
+				response.payload.video_stream_name,
+				sizeof(response.payload.video_stream_name));
+		break;
+	case LocalServiceRequest_startHmdDataStream:
+	case LocalServiceRequest_stopHmdDataStream:
+		{
+			const PSVRHmdID hmd_id= request.payload.hmd_request.hmd_id;
+
+			if (hmd_id >= 0 && hmd_id < PSVRSERVICE_MAX_HMD_COUNT)
+			{
+				const bool bStart= request.request_type == LocalServiceRequest_startHmdDataStream;
+
+				connection.hmd_streams.set(hmd_id, bStart);
+				connection.hmd_stream_flags[hmd_id]= bStart ? request.payload.hmd_request.data_stream_flags : 0;
+				updateHmdStream(hmd_id);
+
+				response.result=
+					(!bStart || m_activeHmdStreams.test(hmd_id))
+					? PSVRResult_Success
+					: PSVRResult_Error;
+			}
+		} break;
+	default:
+		PSVR_LOG_WARNING("LocalServiceServer::handleRequest") << "Unknown request type " << request.request_type;
+		break;
+	}
+}
+
+bool LocalServiceServer::sendResponse(Connection &connection, const LocalServiceResponse &response)
+{
+	const unsigned char *response_bytes= reinterpret_cast<const unsigned char *>(&response);
+	size_t bytes_sent= 0;
+
+	while (bytes_sent < sizeof(LocalServiceResponse))
+	{
+		const ssize_t result=
+			send(connection.socket, response_bytes + bytes_sent, sizeof(LocalServiceResponse) - bytes_sent, k_send_flags);
+
+		if (result < 0)
+		{
+			if (errno == EINTR)
+				continue;
+
+			// A full socket buffer means the client stopped reading its notifications.
+			// Don't let it stall the service loop, drop it instead.
+			PSVR_LOG_WARNING("LocalServiceServer::sendResponse") << "Dropping client: " << strerror(errno);
+			return false;
+		}
+
+		bytes_sent+= static_cast<size_t>(result);
+	}
+
+	return true;
+}
+
+void LocalServiceServer::closeConnection(Connection &connection)
+{
+	if (connection.socket < 0)
+		return;
+
+	close(connection.socket);
+	connection.socket= -1;
+
+	// Release whatever the client was still streaming
+	for (int tracker_id = 0; tracker_id < PSVRSERVICE_MAX_TRACKER_COUNT; ++tracker_id)
+	{
+		if (connection.tracker_streams.test(tracker_id))
+		{
+			connection.tracker_streams.reset(tracker_id);
+			updateTrackerStream(tracker_id);
+		}
+	}
+
+	for (int hmd_id = 0; hmd_id < PSVRSERVICE_MAX_HMD_COUNT; ++hmd_id)
+	{
+		if (connection.hmd_streams.test(hmd_id))
+		{
+			connection.hmd_streams.reset(hmd_id);
+			connection.hmd_stream_flags[hmd_id]= 0;
+			updateHmdStream(hmd_id);
+		}
+	}
+
+	PSVR_LOG_INFO("LocalServiceServer::closeConnection") << "Client disconnected";
+}
+
+void LocalServiceServer::updateTrackerStream(PSVRTrackerID tracker_id)
+{
+	bool bWanted= false;
+	for (const Connection &connection : m_connections)
+	{
+		bWanted|= connection.socket >= 0 && connection.tracker_streams.test(tracker_id);
+	}
+
+	if (bWanted == m_activeTrackerStreams.test(tracker_id))
+		return;
+
+	ServiceRequestHandler *request_handler= PSVRService::getInstance()->getRequestHandler();
+	const PSVRResult result=
+		bWanted
+		? request_handler->start_tracker_data_stream(tracker_id)
+		: request_handler->stop_tracker_data_stream(tracker_id);
+
+	if (result == PSVRResult_Success || !bWanted)
+	{
+		m_activeTrackerStreams.set(tracker_id, bWanted);
+	}
+}
+
+void LocalServiceServer::updateHmdStream(PSVRHmdID hmd_id)
+{
+	bool bWanted= false;
+	unsigned int wanted_flags= 0;
+	for (const Connection &connection : m_connections)
+	{
+		if (connection.socket >= 0 && connection.hmd_streams.test(hmd_id))
+		{
+			bWanted= true;
+			wanted_flags|= connection.hmd_stream_flags[hmd_id];
+		}
+	}
+
+	if (bWanted == m_activeHmdStreams.test(hmd_id) && wanted_flags == m_activeHmdStreamFlags[hmd_id])
+		return;
+
+	ServiceRequestHandler *request_handler= PSVRService::getInstance()->getRequestHandler();
+
+	// Restart the stream to change its flags, so the tracking and ROI refcounts in the hmd view stay balanced
+	if (m_activeHmdStreams.test(hmd_id))
+	{
+		request_handler->stop_hmd_data_stream(hmd_id);
+		m_activeHmdStreams.reset(hmd_id);
+		m_activeHmdStreamFlags[hmd_id]= 0;
+	}
+
+	if (bWanted && request_handler->start_hmd_data_stream(hmd_id, wanted_flags) == PSVRResult_Success)
+	{
+		m_activeHmdStreams.set(hmd_id);
+		m_activeHmdStreamFlags[hmd_id]= wanted_flags;
+	}
+}
+
+//-- private methods -----
+static bool set_socket_non_blocking(int socket)
+{
+	const int flags= fcntl(socket, F_GETFL, 0);
+
+	return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+static void set_socket_no_sigpipe(int socket)
+{
+#if !defined(MSG_NOSIGNAL) && defined(SO_NOSIGPIPE)
+	// A client going away mid send shouldn't take the daemon down with SIGPIPE
+	int value= 1;
+	setsockopt(socket, SOL_SOCKET, SO_NOSIGPIPE, &value, sizeof(value));
+#endif
+}
+
+// Clears out a socket left behind by a daemon that didn't shut down cleanly.
+// Returns false if a running daemon still accepts connections on it.
+static bool remove_stale_socket(const struct sockaddr_un &address)
+{
+	const int probe_socket= socket(AF_UNIX, SOCK_STREAM, 0);
+	if (probe_socket < 0)
+	{
+		// Can't tell, leave the socket alone and let bind() report it if it's in use
+		return true;
+	}
+
+	const bool bConnected=
+		connect(probe_socket, reinterpret_cast<const struct sockaddr *>(&address), sizeof(address)) == 0;
+	const int connect_error= errno;
+	close(probe_socket);
+
+	if (bConnected)
+	{
+		return false;
+	}
+
+	// Only a socket file with no listener behind it is stale
+	if (connect_error == ECONNREFUSED)
+	{
+		unlink(address.sun_path);
+	}
+
+	return true;
+}
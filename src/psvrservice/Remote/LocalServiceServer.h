@@ -0,0 +1,73 @@
+#ifndef LOCAL_SERVICE_SERVER_H
+#define LOCAL_SERVICE_SERVER_H
+
+//-- includes -----
+#include "LocalServiceProtocol.h"
+#include "SharedDataFrameBuffer.h"
+#include <bitset>
+#include <string>
+#include <vector>
+
+//-- definitions -----
+// Serves PSVRService to other processes on the same machine (the psvrservice daemon).
+// Data frames go into a SharedDataFrameBuffer that clients sample directly.
+// Requests and notifications go over a local stream socket.
+// Everything, including request dispatch, happens on the thread calling poll(),
+// which is the same thread that calls PSVRService::update(), so the request handler needs no locking.
+class LocalServiceServer : public IDataFrameListener, public INotificationListener
+{
+public:
+	LocalServiceServer();
+	virtual ~LocalServiceServer();
+
+	// Creates the data frame region and starts listening on the given socket path.
+	// Call before PSVRService::startup() so no data frame is missed.
+	bool startup(const std::string &socket_path);
+
+	// Accepts new clients, reads and answers pending requests and drops clients that went away
+	void poll();
+
+	void shutdown();
+
+	inline int getConnectionCount() const { return static_cast<int>(m_connections.size()); }
+
+	// IDataFrameListener
+	virtual void handle_data_frame(const DeviceOutputDataFrame &data_frame) override;
+
+	// INotificationListener
+	virtual void handle_notification(const PSVREventMessage &event) override;
+
+private:
+	struct Connection
+	{
+		int socket;
+		LocalServiceRequest request;
+		size_t request_bytes_read;
+		std::bitset<PSVRSERVICE_MAX_TRACKER_COUNT> tracker_streams;
+		std::bitset<PSVRSERVICE_MAX_HMD_COUNT> hmd_streams;
+		unsigned int hmd_stream_flags[PSVRSERVICE_MAX_HMD_COUNT];
+	};
+
+	void acceptConnections();
+	bool readRequests(Connection &connection);
+	void handleRequest(Connection &connection, const LocalServiceRequest &request, LocalServiceResponse &response);
+	bool sendResponse(Connection &connection, const LocalServiceResponse &response);
+	void closeConnection(Connection &connection);
+
+	// Several clients can stream the same device.
+	// The service stream stays open while any client wants it, with the union of every client's flags.
+	void updateTrackerStream(PSVRTrackerID tracker_id);
+	void updateHmdStream(PSVRHmdID hmd_id);
+
+	std::string m_socketPath;
+	int m_listenSocket;
+	std::vector<Connection> m_connections;
+	SharedDataFrameBuffer m_dataFrameBuffer;
+
+	// What the service is currently streaming on behalf of all connections
+	std::bitset<PSVRSERVICE_MAX_TRACKER_COUNT> m_activeTrackerStreams;
+	std::bitset<PSVRSERVICE_MAX_HMD_COUNT> m_activeHmdStreams;
+	unsigned int m_activeHmdStreamFlags[PSVRSERVICE_MAX_HMD_COUNT];
+};
+
+#endif // LOCAL_SERVICE_SERVER_H
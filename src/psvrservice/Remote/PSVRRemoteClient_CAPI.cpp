@@ -0,0 +1,272 @@
+// -- includes -----
+#include "PSVRRemoteClient_CAPI.h"
+#include "LocalServiceClient.h"
+#include "Logger.h"
+
+#include <cstring>
+
+#ifdef _MSC_VER
+	#pragma warning(disable:4996)  // ignore strncpy warning
+#endif
+
+// -- macros -----
+#define IS_VALID_TRACKER_INDEX(x) ((x) >= 0 && (x) < PSVRSERVICE_MAX_TRACKER_COUNT)
+#define IS_VALID_HMD_INDEX(x) ((x) >= 0 && (x) < PSVRSERVICE_MAX_HMD_COUNT)
+
+// -- constants ----
+static const int k_default_request_timeout_ms= 1000;
+
+// -- private data ---
+static LocalServiceClient *g_psvr_remote_client= nullptr;
+
+// -- private methods -----
+static PSVRResult send_request(LocalServiceRequestType request_type, LocalServiceRequest &request, LocalServiceResponse &out_response);
+static PSVRResult send_tracker_request(LocalServiceRequestType request_type, PSVRTrackerID tracker_id, LocalServiceResponse &out_response);
+
+// -- public interface -----
+PSVRResult PSVR_RemoteConnect(const char *socket_path, int timeout_ms, PSVRLogSeverityLevel log_level)
+{
+	if (g_psvr_remote_client != nullptr && g_psvr_remote_client->getIsConnected())
+		return PSVRResult_Success;
+
+	log_init(log_level);
+
+	if (g_psvr_remote_client == nullptr)
+	{
+		g_psvr_remote_client= new LocalServiceClient();
+	}
+
+	const std::string path= (socket_path != nullptr) ? socket_path : PSVR_LOCAL_SERVICE_DEFAULT_SOCKET_PATH;
+	const int request_timeout_ms= (timeout_ms > 0) ? timeout_ms : k_default_request_timeout_ms;
+
+	if (!g_psvr_remote_client->connect(path, request_timeout_ms))
+	{
+		delete g_psvr_remote_client;
+		g_psvr_remote_client= nullptr;
+
+		return PSVRResult_Error;
+	}
+
+	return PSVRResult_Success;
+}
+
+PSVRResult PSVR_RemoteDisconnect()
+{
+	if (g_psvr_remote_client == nullptr)
+		return PSVRResult_Error;
+
+	delete g_psvr_remote_client;
+	g_psvr_remote_client= nullptr;
+
+	log_dispose();
+
+	return PSVRResult_Success;
+}
+
+bool PSVR_RemoteGetIsConnected()
+{
+	return g_psvr_remote_client != nullptr && g_psvr_remote_client->getIsConnected();
+}
+
+PSVRResult PSVR_RemoteUpdate()
+{
+	if (!PSVR_RemoteGetIsConnected())
+		return PSVRResult_Error;
+
+	g_psvr_remote_client->pollNotifications();
+
+	return PSVR_RemoteGetIsConnected() ? PSVRResult_Success : PSVRResult_Error;
+}
+
+PSVRResult PSVR_RemotePollNextMessage(PSVREventMessage *out_message, size_t message_size)
+{
+	if (g_psvr_remote_client == nullptr || out_message == nullptr || message_size < sizeof(PSVREventMessage))
+		return PSVRResult_Error;
+
+	return g_psvr_remote_client->pollNextMessage(*out_message) ? PSVRResult_Success : PSVRResult_NoData;
+}
+
+PSVRResult PSVR_RemoteGetVersionString(char *out_version_string, size_t max_version_string)
+{
+	LocalServiceRequest request;
+	memset(&request, 0, sizeof(request));
+	LocalServiceResponse response;
+	PSVRResult result= send_request(LocalServiceRequest_getServiceVersion, request, response);
+
+	if (result == PSVRResult_Success)
+	{
+		if (strlen(response.payload.service_version.version_string) < max_version_string)
+		{
+			strncpy(out_version_string, response.payload.service_version.version_string, max_version_string);
+		}
+		else
+		{
+			result= PSVRResult_Error;
+		}
+	}
+
+	return result;
+}
+
+PSVRResult PSVR_RemoteGetTrackerList(PSVRTrackerList *out_tracker_list)
+{
+	LocalServiceRequest request;
+	memset(&request, 0, sizeof(request));
+	LocalServiceResponse response;
+	const PSVRResult result= send_request(LocalServiceRequest_getTrackerList, request, response);
+
+	if (result == PSVRResult_Success)
+	{
+		*out_tracker_list= response.payload.tracker_list;
+	}
+
+	return result;
+}
+
+PSVRResult PSVR_RemoteStartTrackerDataStream(PSVRTrackerID tracker_id)
+{
+	LocalServiceResponse response;
+
+	return send_tracker_request(LocalServiceRequest_startTrackerDataStream, tracker_id, response);
+}
+
+PSVRResult PSVR_RemoteStopTrackerDataStream(PSVRTrackerID tracker_id)
+{
+	LocalServiceResponse response;
+
+	return send_tracker_request(LocalServiceRequest_stopTrackerDataStream, tracker_id, response);
+}
+
+PSVRResult PSVR_RemoteGetTrackerVideoStreamName(PSVRTrackerID tracker_id, char *out_stream_name, size_t max_stream_name_length)
+{
+	LocalServiceResponse response;
+	PSVRResult result= send_tracker_request(LocalServiceRequest_getTrackerVideoStreamName, tracker_id, response);
+
+	if (result == PSVRResult_Success)
+	{
+		// The daemon always null terminates the name
+		if (strlen(response.payload.video_stream_name) < max_stream_name_length)
+		{
+			strncpy(out_stream_name, response.payload.video_stream_name, max_stream_name_length);
+		}
+		else
+		{
+			result= PSVRResult_Error;
+		}
+	}
+
+	return result;
+}
+
+PSVRResult PSVR_RemoteGetHmdList(PSVRHmdList *out_hmd_list)
+{
+	LocalServiceRequest request;
+	memset(&request, 0, sizeof(request));
+	LocalServiceResponse response;
+	const PSVRResult result= send_request(LocalServiceRequest_getHmdList, request, response);
+
+	if (result == PSVRResult_Success)
+	{
+		*out_hmd_list= response.payload.hmd_list;
+	}
+
+	return result;
+}
+
+PSVRResult PSVR_RemoteStartHmdDataStream(PSVRHmdID hmd_id, unsigned int data_stream_flags)
+{
+	if (!IS_VALID_HMD_INDEX(hmd_id))
+		return PSVRResult_Error;
+
+	LocalServiceRequest request;
+	memset(&request, 0, sizeof(request));
+	LocalServiceResponse response;
+	request.payload.hmd_request.hmd_id= hmd_id;
+	request.payload.hmd_request.data_stream_flags= data_stream_flags;
+
+	return send_request(LocalServiceRequest_startHmdDataStream, request, response);
+}
+
+PSVRResult PSVR_RemoteStopHmdDataStream(PSVRHmdID hmd_id)
+{
+	if (!IS_VALID_HMD_INDEX(hmd_id))
+		return PSVRResult_Error;
+
+	LocalServiceRequest request;
+	memset(&request, 0, sizeof(request));
+	LocalServiceResponse response;
+	request.payload.hmd_request.hmd_id= hmd_id;
+	request.payload.hmd_request.data_stream_flags= 0;
+
+	return send_request(LocalServiceRequest_stopHmdDataStream, request, response);
+}
+
+PSVRResult PSVR_RemoteGetHmdState(PSVRHmdID hmd_id, PSVRHeadMountedDisplay *out_hmd)
+{
+	if (!PSVR_RemoteGetIsConnected() || !IS_VALID_HMD_INDEX(hmd_id) || out_hmd == nullptr)
+		return PSVRResult_Error;
+
+	DeviceOutputDataFrame data_frame;
+	if (!g_psvr_remote_client->getDataFrameBuffer().readDataFrame(DeviceCategory_HMD, hmd_id, data_frame))
+		return PSVRResult_NoData;
+
+	// Ignore old packets
+	const HMDDataPacket &hmd_packet= data_frame.device.hmd_data_packet;
+	if (hmd_packet.output_sequence_num <= out_hmd->OutputSequenceNum)
+		return PSVRResult_NoData;
+
+	out_hmd->HmdID= hmd_packet.hmd_id;
+	out_hmd->HmdType= hmd_packet.hmd_type;
+	out_hmd->bValid= hmd_packet.is_valid;
+	out_hmd->OutputSequenceNum= hmd_packet.output_sequence_num;
+	out_hmd->IsConnected= hmd_packet.is_connected;
+	out_hmd->IMUSensorAgeMs= hmd_packet.imu_sensor_age_ms;
+	out_hmd->OpticalSensorAgeMs= hmd_packet.optical_sensor_age_ms;
+
+	// Don't bother updating the rest of the hmd state if it's not connected
+	if (out_hmd->IsConnected)
+	{
+		switch (out_hmd->HmdType)
+		{
+		case PSVRHmd_Morpheus:
+			out_hmd->HmdState.MorpheusState= hmd_packet.hmd_state.morpheus_state;
+			break;
+		case PSVRHmd_Virtual:
+			out_hmd->HmdState.VirtualHMDState= hmd_packet.hmd_state.virtual_hmd_state;
+			break;
+		default:
+			break;
+		}
+	}
+
+	return PSVRResult_Success;
+}
+
+// -- private methods -----
+static PSVRResult send_request(
+	LocalServiceRequestType request_type,
+	LocalServiceRequest &request,
+	LocalServiceResponse &out_response)
+{
+	if (!PSVR_RemoteGetIsConnected())
+		return PSVRResult_Error;
+
+	request.request_type= request_type;
+
+	return g_psvr_remote_client->sendRequest(request, out_response) ? out_response.result : PSVRResult_Error;
+}
+
+static PSVRResult send_tracker_request(
+	LocalServiceRequestType request_type,
+	PSVRTrackerID tracker_id,
+	LocalServiceResponse &out_response)
+{
+	if (!IS_VALID_TRACKER_INDEX(tracker_id))
+		return PSVRResult_Error;
+
+	LocalServiceRequest request;
+	memset(&request, 0, sizeof(request));
+	request.payload.tracker_request.tracker_id= tracker_id;
+
+	return send_request(request_type, request, out_response);
+}
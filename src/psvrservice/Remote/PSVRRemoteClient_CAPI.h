@@ -0,0 +1,119 @@
+/**
+\file
+*/
+
+#ifndef __PSVRREMOTECLIENT_CAPI_H
+#define __PSVRREMOTECLIENT_CAPI_H
+#include "PSVRClient_CAPI.h"
+//cut_before
+
+/**
+\brief Thin client interface for a psvrservice daemon running in another process
+\defgroup PSVRRemoteClient_CAPI Remote Client Interface
+\addtogroup PSVRRemoteClient_CAPI
+@{
+*/
+
+// Interface
+//----------
+
+/** \brief Connects to a running psvrservice daemon.
+	Several applications can be connected to the same daemon at once.
+	\param socket_path The daemon's socket, or NULL for the default (/tmp/psvrservice.sock)
+	\param timeout_ms How long a request waits on the daemon before giving up
+	\param log_level The level of logging to emit
+	\return PSVRResult_Success on success or PSVRResult_Error if no daemon is listening
+ */
+PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_RemoteConnect(const char *socket_path, int timeout_ms, PSVRLogSeverityLevel log_level);
+
+/** \brief Disconnects from the daemon.
+	Any data streams this client still has open are released by the daemon.
+	\return PSVRResult_Success on success or PSVRResult_Error if there was no connection
+ */
+PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_RemoteDisconnect();
+
+/** \brief Get the connection status
+	\return true if connected to a daemon
+ */
+PSVR_PUBLIC_FUNCTION(bool) PSVR_RemoteGetIsConnected();
+
+/** \brief Reads the notifications the daemon sent since the last update, without blocking.
+	The messages are extracted with \ref PSVR_RemotePollNextMessage().
+	\return PSVRResult_Success if still connected or PSVRResult_Error if the connection was lost
+ */
+PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_RemoteUpdate();
+
+/** \brief Retrieve the next message from the message queue.
+	\param[out] out_message The next \ref PSVREventMessage from the queue.
+	\param message_size The size of the message structure.
+	\return PSVRResult_Success or PSVRResult_NoData if no more messages are available.
+ */
+PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_RemotePollNextMessage(PSVREventMessage *out_message, size_t message_size);
+
+/** \brief Retrieve the daemon's version string
+	\param[out] out_version_string The string buffer to write the version into
+	\param max_version_string The size of the output buffer
+	\return PSVRResult_Success upon receiving result, PSVRResult_Error otherwise
+ */
+PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_RemoteGetVersionString(char *out_version_string, size_t max_version_string);
+
+/** \brief Requests a list of the trackers currently connected to the daemon
+	\param[out] out_tracker_list The tracker list to write the result into
+	\return PSVRResult_Success upon receiving result, PSVRResult_Error otherwise
+ */
+PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_RemoteGetTrackerList(PSVRTrackerList *out_tracker_list);
+
+/** \brief Requests the tracker's video frames be published to shared memory.
+	The frames are read with the SharedVideoFrameBuffer named by \ref PSVR_RemoteGetTrackerVideoStreamName().
+	\return PSVRResult_Success upon receiving result, PSVRResult_Error otherwise
+ */
+PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_RemoteStartTrackerDataStream(PSVRTrackerID tracker_id);
+
+/** \brief Releases this client's tracker stream
+	\return PSVRResult_Success upon receiving result, PSVRResult_Error otherwise
+ */
+PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_RemoteStopTrackerDataStream(PSVRTrackerID tracker_id);
+
+/** \brief Get the name of the shared memory region a streaming tracker's video frames are published to
+	\param tracker_id The id of the tracker
+	\param[out] out_stream_name The string buffer to write the name into
+	\param max_stream_name_length The size of the output buffer
+	\return PSVRResult_Success upon receiving result, PSVRResult_Error otherwise
+ */
+PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_RemoteGetTrackerVideoStreamName(PSVRTrackerID tracker_id, char *out_stream_name, size_t max_stream_name_length);
+
+/** \brief Requests a list of the HMDs currently connected to the daemon
+	\param[out] out_hmd_list The hmd list to write the result into
+	\return PSVRResult_Success upon receiving result, PSVRResult_Error otherwise
+ */
+PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_RemoteGetHmdList(PSVRHmdList *out_hmd_list);
+
+/** \brief Requests the HMD's state be published to shared memory.
+	When several clients stream the same HMD the daemon streams it with the union of their flags.
+	\param hmd_id The id of the hmd
+	\param data_stream_flags One or more of the PSMStreamFlags
+	\return PSVRResult_Success upon receiving result, PSVRResult_Error otherwise
+ */
+PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_RemoteStartHmdDataStream(PSVRHmdID hmd_id, unsigned int data_stream_flags);
+
+/** \brief Releases this client's HMD stream
+	\return PSVRResult_Success upon receiving result, PSVRResult_Error otherwise
+ */
+PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_RemoteStopHmdDataStream(PSVRHmdID hmd_id);
+
+/** \brief Samples the newest state the daemon published for a streaming HMD.
+	Reads straight out of shared memory, so it's cheap enough to call every frame at whatever rate the app runs.
+	The data frame receive statistics (DataFrameLastReceivedTime, DataFrameAverageFPS, ListenerCount) are left untouched.
+	\param hmd_id The id of the hmd
+	\param[in,out] out_hmd The hmd state to update, zero it before the first call
+	\return PSVRResult_Success on a new state, PSVRResult_NoData if nothing newer than out_hmd's OutputSequenceNum
+	        was published, or PSVRResult_Error if not connected
+ */
+PSVR_PUBLIC_FUNCTION(PSVRResult) PSVR_RemoteGetHmdState(PSVRHmdID hmd_id, PSVRHeadMountedDisplay *out_hmd);
+
+/**
+@}
+*/
+
+//cut_after
+#endif
@@ -0,0 +1,229 @@
+//-- includes -----
+#include "SharedDataFrameBuffer.h"
+#include "Logger.h"
+#include "SharedMemory.h"
+#include <cstring>
+
+//-- constants -----
+// Readers give up on a copy after this many torn attempts
+static const int k_max_data_frame_copy_attempts= 4;
+// Keep each device slot on its own cache lines so one device's writes don't stall readers of another
+static const size_t k_data_frame_alignment= 64;
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "The shared data frame slots need address free 64-bit atomics");
+
+//-- private methods -----
+static size_t align_data_frame_size(size_t size);
+
+//-- implementation -----
+SharedDataFrameBuffer::SharedDataFrameBuffer()
+	: m_shared_memory(nullptr)
+	, m_header(nullptr)
+	, m_buffer_name()
+{
+}
+
+SharedDataFrameBuffer::~SharedDataFrameBuffer()
+{
+	dispose();
+}
+
+bool SharedDataFrameBuffer::initialize(const char *buffer_name)
+{
+	bool bSuccess= false;
+
+	if (m_shared_memory == nullptr)
+	{
+		const size_t slot_size= align_data_frame_size(sizeof(SharedDataFrameSlot));
+		const size_t first_slot_offset= align_data_frame_size(sizeof(SharedDataFrameHeader));
+		const size_t slot_count= PSVRSERVICE_MAX_TRACKER_COUNT + PSVRSERVICE_MAX_HMD_COUNT;
+
+		m_shared_memory= new SharedMemory();
+		if (m_shared_memory->create(buffer_name, first_slot_offset + slot_size * slot_count))
+		{
+			// The region starts out zeroed, so every slot starts out with sequence 0 (never written)
+			m_header= reinterpret_cast<SharedDataFrameHeader *>(m_shared_memory->getData());
+			m_header->version= PSVR_LOCAL_SERVICE_PROTOCOL_VERSION;
+			m_header->tracker_slot_count= PSVRSERVICE_MAX_TRACKER_COUNT;
+			m_header->hmd_slot_count= PSVRSERVICE_MAX_HMD_COUNT;
+			m_header->data_frame_size= sizeof(DeviceOutputDataFrame);
+			m_header->slot_size= static_cast<uint32_t>(slot_size);
+			m_header->first_slot_offset= first_slot_offset;
+
+			// Readers don't touch the rest of the header until they see the magic number
+			m_header->magic.store(PSVR_SHARED_DATA_FRAME_MAGIC, std::memory_order_release);
+
+			m_buffer_name= buffer_name;
+			bSuccess= true;
+		}
+		else
+		{
+			dispose();
+		}
+	}
+
+	return bSuccess;
+}
+
+bool SharedDataFrameBuffer::open(const char *buffer_name)
+{
+	bool bSuccess= false;
+
+	if (m_shared_memory == nullptr)
+	{
+		m_shared_memory= new SharedMemory();
+
+		if (m_shared_memory->open(buffer_name, true) &&
+			m_shared_memory->getSize() >= sizeof(SharedDataFrameHeader))
+		{
+			SharedDataFrameHeader *header= reinterpret_cast<SharedDataFrameHeader *>(m_shared_memory->getData());
+
+			if (header->magic.load(std::memory_order_acquire) == PSVR_SHARED_DATA_FRAME_MAGIC &&
+				header->version == PSVR_LOCAL_SERVICE_PROTOCOL_VERSION &&
+				header->data_frame_size == sizeof(DeviceOutputDataFrame) &&
+				header->tracker_slot_count == PSVRSERVICE_MAX_TRACKER_COUNT &&
+				header->hmd_slot_count == PSVRSERVICE_MAX_HMD_COUNT &&
+				header->slot_size >= sizeof(SharedDataFrameSlot) &&
+				header->first_slot_offset +
+					static_cast<uint64_t>(header->slot_size) * (header->tracker_slot_count + header->hmd_slot_count) <= m_shared_memory->getSize())
+			{
+				m_header= header;
+				m_buffer_name= buffer_name;
+				bSuccess= true;
+			}
+			else
+			{
+				PSVR_LOG_WARNING("SharedDataFrameBuffer::open()") << "Data frame buffer " << buffer_name << " isn't a compatible data frame region";
+			}
+		}
+
+		if (!bSuccess)
+		{
+			dispose();
+		}
+	}
+
+	return bSuccess;
+}
+
+void SharedDataFrameBuffer::dispose()
+{
+	if (m_shared_memory != nullptr)
+	{
+		// Readers in other processes keep their mapping of the region until they close it too
+		delete m_shared_memory;
+		m_shared_memory= nullptr;
+		m_header= nullptr;
+		m_buffer_name= "";
+	}
+}
+
+void SharedDataFrameBuffer::writeDataFrame(const DeviceOutputDataFrame &data_frame)
+{
+	if (m_header == nullptr || !m_shared_memory->getIsOwner())
+		return;
+
+	const int device_id=
+		(data_frame.device_category == DeviceCategory_TRACKER)
+		? data_frame.device.tracker_data_packet.tracker_id
+		: data_frame.device.hmd_data_packet.hmd_id;
+	SharedDataFrameSlot *slot= getSlot(data_frame.device_category, device_id);
+	if (slot == nullptr)
+		return;
+
+	// Odd while the frame is being rewritten
+	const uint64_t sequence= slot->sequence.load(std::memory_order_relaxed);
+	slot->sequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	std::memcpy(&slot->data_frame, &data_frame, sizeof(DeviceOutputDataFrame));
+
+	// Even again: the slot holds a complete frame
+	slot->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+uint64_t SharedDataFrameBuffer::getDataFrameSequence(DeviceCategory device_category, int device_id) const
+{
+	const SharedDataFrameSlot *slot= getSlot(device_category, device_id);
+
+	// Round an in progress write down to the frame it is replacing
+	return (slot != nullptr) ? (slot->sequence.load(std::memory_order_acquire) & ~uint64_t(1)) : 0;
+}
+
+bool SharedDataFrameBuffer::readDataFrame(
+	DeviceCategory device_category, int device_id,
+	DeviceOutputDataFrame &out_data_frame, uint64_t *out_sequence) const
+{
+	const SharedDataFrameSlot *slot= getSlot(device_category, device_id);
+	if (slot == nullptr)
+		return false;
+
+	for (int attempt = 0; attempt < k_max_data_frame_copy_attempts; ++attempt)
+	{
+		const uint64_t sequence= slot->sequence.load(std::memory_order_acquire);
+		if (sequence == 0)
+		{
+			// Nothing published for this device yet
+			return false;
+		}
+
+		if ((sequence & 1) != 0)
+		{
+			// Mid write, the daemon is only ever in here for a memcpy's worth of time
+			continue;
+		}
+
+		std::memcpy(&out_data_frame, &slot->data_frame, sizeof(DeviceOutputDataFrame));
+
+		// Order the copy before the sequence re-check
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (slot->sequence.load(std::memory_order_relaxed) == sequence)
+		{
+			if (out_sequence != nullptr)
+			{
+				*out_sequence= sequence;
+			}
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+SharedDataFrameSlot *SharedDataFrameBuffer::getSlot(DeviceCategory device_category, int device_id) const
+{
+	if (m_header == nullptr)
+		return nullptr;
+
+	int slot_index= -1;
+	switch (device_category)
+	{
+	case DeviceCategory_TRACKER:
+		if (device_id >= 0 && device_id < static_cast<int>(m_header->tracker_slot_count))
+		{
+			slot_index= device_id;
+		}
+		break;
+	case DeviceCategory_HMD:
+		if (device_id >= 0 && device_id < static_cast<int>(m_header->hmd_slot_count))
+		{
+			slot_index= m_header->tracker_slot_count + device_id;
+		}
+		break;
+	}
+
+	if (slot_index < 0)
+		return nullptr;
+
+	unsigned char *base= reinterpret_cast<unsigned char *>(m_header);
+
+	return reinterpret_cast<SharedDataFrameSlot *>(
+		base + m_header->first_slot_offset + static_cast<size_t>(m_header->slot_size) * slot_index);
+}
+
+//-- private methods -----
+static size_t align_data_frame_size(size_t size)
+{
+	return (size + k_data_frame_alignment - 1) & ~(k_data_frame_alignment - 1);
+}
@@ -0,0 +1,50 @@
+#ifndef SHARED_DATA_FRAME_BUFFER_H
+#define SHARED_DATA_FRAME_BUFFER_H
+
+//-- includes -----
+#include "LocalServiceProtocol.h"
+#include <string>
+
+//-- definitions -----
+// The latest data frame of every tracker and HMD in a named shared memory region (see SharedDataFrameHeader).
+// The daemon is the only writer. Any number of local processes can map the region read-only
+// and sample the newest frame of a device whenever they like, without a round trip to the daemon.
+class SharedDataFrameBuffer
+{
+public:
+	SharedDataFrameBuffer();
+	~SharedDataFrameBuffer();
+
+	// Writer side
+	bool initialize(const char *buffer_name);
+	void writeDataFrame(const DeviceOutputDataFrame &data_frame);
+
+	// Reader side
+	bool open(const char *buffer_name);
+
+	// Sequence of the device's slot, which only changes when a new frame is written.
+	// 0 if nothing has been written yet. Lets a reader skip the copy when it already has the newest frame.
+	uint64_t getDataFrameSequence(DeviceCategory device_category, int device_id) const;
+
+	// Copies out the newest frame of the device.
+	// Fails if nothing has been written yet or the daemon kept rewriting the slot while we were copying it.
+	bool readDataFrame(
+		DeviceCategory device_category, int device_id,
+		DeviceOutputDataFrame &out_data_frame, uint64_t *out_sequence= nullptr) const;
+
+	void dispose();
+
+	inline bool getIsOpen() const { return m_header != nullptr; }
+
+private:
+	SharedDataFrameSlot *getSlot(DeviceCategory device_category, int device_id) const;
+
+	class SharedMemory *m_shared_memory;
+	SharedDataFrameHeader *m_header;
+	std::string m_buffer_name;
+
+	SharedDataFrameBuffer(const SharedDataFrameBuffer&);
+	void operator=(const SharedDataFrameBuffer&);
+};
+
+#endif // SHARED_DATA_FRAME_BUFFER_H
@@ -0,0 +1,112 @@
+// -- includes -----
+#include "ReplayHMD.h"
+#include "DeviceManager.h"
+#include "HMDDeviceEnumerator.h"
+#include "Logger.h"
+#include "ReplayHMDDeviceEnumerator.h"
+#include "SessionRecording.h"
+#include "SessionReplay.h"
+
+// -- Replay HMD -----
+ReplayHMD::ReplayHMD()
+    : MorpheusHMD()
+    , m_replay(nullptr)
+    , m_hmdIndex(-1)
+    , m_deviceIdentifier()
+    , m_hmdListener(nullptr)
+{
+}
+
+ReplayHMD::~ReplayHMD()
+{
+    if (getIsOpen())
+    {
+        PSVR_LOG_ERROR("~ReplayHMD") << "HMD deleted without calling close() first!";
+    }
+}
+
+bool ReplayHMD::open(
+    const DeviceEnumerator *enumerator)
+{
+    const HMDDeviceEnumerator *pEnum = static_cast<const HMDDeviceEnumerator *>(enumerator);
+    const ReplayHMDDeviceEnumerator *replay_enumerator = pEnum->get_replay_hmd_enumerator();
+    const char *cur_dev_path = pEnum->get_path();
+
+    if (getIsOpen())
+    {
+        PSVR_LOG_WARNING("ReplayHMD::open") << "ReplayHMD(" << cur_dev_path << ") already open. Ignoring request.";
+        return true;
+    }
+
+    SessionReplay *replay= DeviceManager::getInstance()->getSessionReplay();
+    const int hmd_index= (replay_enumerator != nullptr) ? replay_enumerator->get_hmd_index() : -1;
+
+    if (replay == nullptr || replay->getHMDDesc(hmd_index) == nullptr)
+    {
+        PSVR_LOG_ERROR("ReplayHMD::open") << "No recorded HMD for ReplayHMD(" << cur_dev_path << ")";
+        return false;
+    }
+
+    PSVR_LOG_INFO("ReplayHMD::open") << "Opening ReplayHMD(" << cur_dev_path << ").";
+
+    // The recorded sensor state is already calibrated,
+    // but the filter settings still come from the Morpheus config
+    MorpheusHMDConfig *cfg= getConfigMutable();
+    *cfg = MorpheusHMDConfig("MorpheusHMDConfig");
+    cfg->load();
+
+    m_deviceIdentifier= cur_dev_path;
+
+    // Start receiving sensor packets from the replay
+    m_replay= replay;
+    m_hmdIndex= hmd_index;
+    m_replay->setHMDListener(m_hmdIndex, m_hmdListener);
+
+    return true;
+}
+
+void ReplayHMD::close()
+{
+    if (m_replay != nullptr)
+    {
+        // Blocks until the replay thread is done with our listener
+        m_replay->setHMDListener(m_hmdIndex, nullptr);
+
+        m_replay= nullptr;
+        m_hmdIndex= -1;
+    }
+    else
+    {
+        PSVR_LOG_INFO("ReplayHMD::close") << "ReplayHMD already closed. Ignoring request.";
+    }
+}
+
+bool ReplayHMD::matchesDeviceEnumerator(const DeviceEnumerator *enumerator) const
+{
+    // Down-cast the enumerator so we can use the correct get_path.
+    const HMDDeviceEnumerator *pEnum = static_cast<const HMDDeviceEnumerator *>(enumerator);
+
+    return
+        pEnum->get_api_type() == HMDDeviceEnumerator::CommunicationType_REPLAY &&
+        m_deviceIdentifier == pEnum->get_path();
+}
+
+std::string ReplayHMD::getUSBDevicePath() const
+{
+    return m_deviceIdentifier;
+}
+
+bool ReplayHMD::getIsOpen() const
+{
+    return m_replay != nullptr;
+}
+
+void ReplayHMD::setHMDListener(IHMDListener *listener)
+{
+	m_hmdListener= listener;
+
+    if (m_replay != nullptr)
+    {
+        m_replay->setHMDListener(m_hmdIndex, m_hmdListener);
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef REPLAY_HMD_H
+#define REPLAY_HMD_H
+
+// -- includes -----
+#include "MorpheusHMD.h"
+
+// -- definitions -----
+/// A Morpheus HMD that plays back the IMU packets of an HMD in the session recording
+/// the DeviceManager was started with instead of reading them from the headset.
+/// It reports itself as a Morpheus so the HMD view filters the packets exactly like it did when they were recorded.
+class ReplayHMD : public MorpheusHMD
+{
+public:
+    ReplayHMD();
+    virtual ~ReplayHMD();
+
+    // -- IDeviceInterface
+    bool matchesDeviceEnumerator(const DeviceEnumerator *enumerator) const override;
+    bool open(const DeviceEnumerator *enumerator) override;
+    bool getIsOpen() const override;
+    void close() override;
+
+    // -- IHMDInterface
+    std::string getUSBDevicePath() const override;
+	void setHMDListener(IHMDListener *listener) override;
+
+private:
+	class SessionReplay *m_replay;
+	int m_hmdIndex;
+    std::string m_deviceIdentifier;
+
+	IHMDListener *m_hmdListener;
+};
+
+#endif // REPLAY_HMD_H
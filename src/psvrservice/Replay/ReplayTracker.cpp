@@ -0,0 +1,349 @@
+// -- includes -----
+#include "ReplayTracker.h"
+#include "DeviceManager.h"
+#include "Logger.h"
+#include "ReplayTrackerEnumerator.h"
+#include "SessionRecording.h"
+#include "SessionReplay.h"
+#include "TrackerDeviceEnumerator.h"
+#include "Utility.h"
+#include <assert.h>
+#include <string.h>
+
+#ifdef _MSC_VER
+    #pragma warning (disable: 4996) // 'This function or variable may be unsafe': strncpy
+#endif
+
+// -- Replay Tracker
+ReplayTracker::ReplayTracker()
+    : m_replay(nullptr)
+    , m_trackerIndex(-1)
+    , m_desc(nullptr)
+    , m_cfg()
+    , m_mode()
+    , m_deviceIdentifier()
+    , m_listener(nullptr)
+{
+    memset(&m_intrinsics, 0, sizeof(m_intrinsics));
+}
+
+ReplayTracker::~ReplayTracker()
+{
+    if (getIsOpen())
+    {
+        PSVR_LOG_ERROR("~ReplayTracker") << "Tracker deleted without calling close() first!";
+    }
+}
+
+// -- IDeviceInterface
+bool ReplayTracker::matchesDeviceEnumerator(const DeviceEnumerator *enumerator) const
+{
+    // Down-cast the enumerator so we can use the correct get_path.
+    const TrackerDeviceEnumerator *pEnum = static_cast<const TrackerDeviceEnumerator *>(enumerator);
+
+    return
+        pEnum->get_api_type() == TrackerDeviceEnumerator::CommunicationType_REPLAY &&
+        m_deviceIdentifier == pEnum->get_path();
+}
+
+bool ReplayTracker::open(const DeviceEnumerator *enumerator)
+{
+    const TrackerDeviceEnumerator *tracker_enumerator = static_cast<const TrackerDeviceEnumerator *>(enumerator);
+    const ReplayTrackerEnumerator *replay_enumerator = tracker_enumerator->get_replay_tracker_enumerator();
+    const char *cur_dev_path = tracker_enumerator->get_path();
+
+    if (getIsOpen())
+    {
+        PSVR_LOG_WARNING("ReplayTracker::open") << "ReplayTracker(" << cur_dev_path << ") already open. Ignoring request.";
+        return true;
+    }
+
+    SessionReplay *replay= DeviceManager::getInstance()->getSessionReplay();
+    const int tracker_index= (replay_enumerator != nullptr) ? replay_enumerator->get_tracker_index() : -1;
+    const SessionRecordingTrackerDesc *desc= (replay != nullptr) ? replay->getTrackerDesc(tracker_index) : nullptr;
+
+    if (desc == nullptr)
+    {
+        PSVR_LOG_ERROR("ReplayTracker::open") << "No recorded tracker for ReplayTracker(" << cur_dev_path << ")";
+        return false;
+    }
+
+    PSVR_LOG_INFO("ReplayTracker::open") << "Opening ReplayTracker(" << cur_dev_path << ", recorded "
+        << CommonSensorState::getDeviceTypeString((CommonSensorState::eDeviceType)desc->device_type) << ")";
+
+    m_deviceIdentifier= cur_dev_path;
+    m_desc= desc;
+    m_intrinsics= desc->intrinsics;
+
+    // Rebuild the mode the tracker was recorded in
+    m_mode.modeName= desc->mode_name;
+    m_mode.frameRate= desc->frame_rate;
+    m_mode.isFrameMirrored= desc->is_frame_mirrored != 0;
+    m_mode.isBufferMirrored= desc->is_buffer_mirrored != 0;
+    m_mode.bufferPixelWidth= desc->buffer_pixel_width;
+    m_mode.bufferPixelHeight= desc->buffer_pixel_height;
+    m_mode.bufferFormat=
+        (desc->frame_format == SessionRecordingFrame_Bayer)
+        ? CAMERA_BUFFER_FORMAT_BEYER
+        : CAMERA_BUFFER_FORMAT_MJPG;
+    m_mode.intrinsics= desc->intrinsics;
+    m_mode.frameSections.clear();
+    for (int section_index = 0; section_index < desc->frame_section_count; ++section_index)
+    {
+        TrackerFrameSectionInfo section;
+        section.x= desc->frame_section_x[section_index];
+        section.y= desc->frame_section_y[section_index];
+
+        m_mode.frameSections.push_back(section);
+    }
+
+    // Load the config file for the replay tracker.
+    // The first time this recorded tracker is replayed seed it with the recorded pose and color presets.
+    char config_name[256];
+    Utility::format_string(config_name, sizeof(config_name), "ReplayTrackerConfig_%d", tracker_index);
+
+    m_cfg = CommonTrackerConfig(config_name);
+    if (!m_cfg.load())
+    {
+        PSVR_HSVColorRangeTable *table= m_cfg.getOrAddColorRangeTable(desc->color_presets.table_name);
+
+        memcpy(table->color_presets, desc->color_presets.color_presets, sizeof(table->color_presets));
+        m_cfg.pose= desc->pose;
+        m_cfg.is_valid= true;
+    }
+    m_cfg.current_mode= m_mode.modeName;
+    m_cfg.save();
+
+    // Start receiving frames from the replay
+    m_replay= replay;
+    m_trackerIndex= tracker_index;
+    m_replay->setTrackerListener(m_trackerIndex, m_listener);
+
+    return true;
+}
+
+bool ReplayTracker::getIsOpen() const
+{
+    return m_replay != nullptr;
+}
+
+void ReplayTracker::close()
+{
+    if (m_replay != nullptr)
+    {
+        // Blocks until the replay thread is done with our listener
+        m_replay->setTrackerListener(m_trackerIndex, nullptr);
+
+        m_replay= nullptr;
+        m_trackerIndex= -1;
+    }
+}
+
+CommonSensorState::eDeviceType ReplayTracker::getDeviceType() const
+{
+    return
+        (m_desc != nullptr)
+        ? (CommonSensorState::eDeviceType)m_desc->device_type
+        : CommonSensorState::INVALID_DEVICE_TYPE;
+}
+
+ITrackerInterface::eDriverType ReplayTracker::getDriverType() const
+{
+    return ITrackerInterface::Replay;
+}
+
+std::string ReplayTracker::getUSBDevicePath() const
+{
+    return m_deviceIdentifier;
+}
+
+bool ReplayTracker::getVideoFrameDimensions(
+    int *out_width,
+    int *out_height,
+    int *out_stride) const
+{
+    if (out_width != nullptr)
+    {
+        int width = (int)m_intrinsics.intrinsics.stereo.pixel_width;
+
+        if (out_stride != nullptr)
+        {
+            *out_stride = 3 * width;
+        }
+
+        *out_width = width;
+    }
+
+    if (out_height != nullptr)
+    {
+        *out_height = (int)m_intrinsics.intrinsics.stereo.pixel_height;
+    }
+
+    return true;
+}
+
+bool ReplayTracker::getIsStereoCamera() const
+{
+    return m_desc != nullptr && m_desc->is_stereo != 0;
+}
+
+bool ReplayTracker::getIsFrameMirrored() const
+{
+    return m_mode.isFrameMirrored;
+}
+
+bool ReplayTracker::getIsBufferMirrored() const
+{
+    return m_mode.isBufferMirrored;
+}
+
+void ReplayTracker::loadSettings()
+{
+    m_cfg.load();
+}
+
+void ReplayTracker::saveSettings()
+{
+    m_cfg.save();
+}
+
+bool ReplayTracker::getAvailableTrackerModes(std::vector<std::string> &out_mode_names) const
+{
+    // Only the recorded mode is available
+    out_mode_names.push_back(m_mode.modeName);
+
+    return true;
+}
+
+const TrackerModeConfig *ReplayTracker::getTrackerMode() const
+{
+    return &m_mode;
+}
+
+bool ReplayTracker::setTrackerMode(const std::string mode_name)
+{
+    return false;
+}
+
+double ReplayTracker::getFrameWidth() const
+{
+    return (double)m_intrinsics.intrinsics.stereo.pixel_width;
+}
+
+double ReplayTracker::getFrameHeight() const
+{
+    return (double)m_intrinsics.intrinsics.stereo.pixel_height;
+}
+
+double ReplayTracker::getFrameRate() const
+{
+    return (double)m_mode.frameRate;
+}
+
+bool ReplayTracker::getVideoPropertyConstraint(const PSVRVideoPropertyType property_type, PSVRVideoPropertyConstraint &outConstraint) const
+{
+    // The recorded frames can't be adjusted
+    memset(&outConstraint, 0, sizeof(PSVRVideoPropertyConstraint));
+    outConstraint.is_supported= false;
+
+    return false;
+}
+
+void ReplayTracker::setVideoProperty(const PSVRVideoPropertyType property_type, int desired_value, bool bUpdateConfig)
+{
+    if (bUpdateConfig)
+    {
+        m_cfg.video_properties[property_type] = desired_value;
+    }
+
+    // No hardware to wait on
+    if (m_listener != nullptr)
+    {
+        m_listener->notifyVideoPropertyApplied(property_type, getVideoProperty(property_type), true);
+    }
+}
+
+int ReplayTracker::getVideoProperty(const PSVRVideoPropertyType property_type) const
+{
+    return m_cfg.video_properties[property_type];
+}
+
+void ReplayTracker::getCameraIntrinsics(
+    PSVRTrackerIntrinsics &out_tracker_intrinsics) const
+{
+    out_tracker_intrinsics= m_intrinsics;
+}
+
+void ReplayTracker::setCameraIntrinsics(
+    const PSVRTrackerIntrinsics &tracker_intrinsics)
+{
+    assert(tracker_intrinsics.intrinsics_type == m_intrinsics.intrinsics_type);
+    m_intrinsics= tracker_intrinsics;
+}
+
+PSVRPosef ReplayTracker::getTrackerPose() const
+{
+    return m_cfg.pose;
+}
+
+void ReplayTracker::setTrackerPose(
+    const PSVRPosef *pose)
+{
+    m_cfg.pose = *pose;
+    m_cfg.save();
+}
+
+void ReplayTracker::getFOV(float &outHFOV, float &outVFOV) const
+{
+    outHFOV = static_cast<float>(m_intrinsics.intrinsics.stereo.hfov);
+    outVFOV = static_cast<float>(m_intrinsics.intrinsics.stereo.vfov);
+}
+
+void ReplayTracker::getZRange(float &outZNear, float &outZFar) const
+{
+    outZNear = static_cast<float>(m_intrinsics.intrinsics.stereo.znear);
+    outZFar = static_cast<float>(m_intrinsics.intrinsics.stereo.zfar);
+}
+
+void ReplayTracker::gatherTrackingColorPresets(
+	const std::string &table_name,
+    PSVRClientTrackerSettings* settings) const
+{
+    settings->color_range_table= *m_cfg.getColorRangeTable(table_name);
+}
+
+void ReplayTracker::setTrackingColorPreset(
+	const std::string &table_name,
+    PSVRTrackingColorType color,
+    const PSVR_HSVColorRange *preset)
+{
+	PSVR_HSVColorRangeTable *table= m_cfg.getOrAddColorRangeTable(table_name);
+
+    table->color_presets[color] = *preset;
+    m_cfg.save();
+}
+
+void ReplayTracker::getTrackingColorPreset(
+	const std::string &table_name,
+    PSVRTrackingColorType color,
+    PSVR_HSVColorRange *out_preset) const
+{
+	const PSVR_HSVColorRangeTable *table= m_cfg.getColorRangeTable(table_name);
+
+    *out_preset = table->color_presets[color];
+}
+
+void ReplayTracker::setTrackerListener(ITrackerListener *listener)
+{
+	m_listener= listener;
+
+    if (m_replay != nullptr)
+    {
+        m_replay->setTrackerListener(m_trackerIndex, m_listener);
+    }
+}
+
+void ReplayTracker::getDeviceStatistics(PSVRTrackerStatistics &out_statistics) const
+{
+	// Recorded frames never touch USB
+}
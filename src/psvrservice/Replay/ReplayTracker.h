@@ -0,0 +1,74 @@
+#ifndef REPLAY_TRACKER_H
+#define REPLAY_TRACKER_H
+
+// -- includes -----
+#include "DeviceEnumerator.h"
+#include "DeviceInterface.h"
+#include "TrackerCapabilitiesConfig.h"
+#include "CommonTrackerConfig.h"
+#include <string>
+#include <vector>
+
+// -- definitions -----
+/// A tracker that plays back the video frames of a tracker in the session recording
+/// the DeviceManager was started with. It reports the device type of the recorded tracker
+/// so the tracker view processes the frames exactly like it did when they were recorded.
+class ReplayTracker : public ITrackerInterface {
+public:
+    ReplayTracker();
+    virtual ~ReplayTracker();
+
+    // -- IDeviceInterface
+    bool matchesDeviceEnumerator(const DeviceEnumerator *enumerator) const override;
+    bool open(const DeviceEnumerator *enumerator) override;
+    bool getIsOpen() const override;
+    void close() override;
+    CommonSensorState::eDeviceType getDeviceType() const override;
+
+    // -- ITrackerInterface
+    ITrackerInterface::eDriverType getDriverType() const override;
+    std::string getUSBDevicePath() const override;
+    bool getVideoFrameDimensions(int *out_width, int *out_height, int *out_stride) const override;
+    bool getIsStereoCamera() const override;
+	bool getIsFrameMirrored() const override;
+	bool getIsBufferMirrored() const override;
+    void loadSettings() override;
+    void saveSettings() override;
+	bool getAvailableTrackerModes(std::vector<std::string> &out_mode_names) const override;
+	const struct TrackerModeConfig *getTrackerMode() const override;
+	bool setTrackerMode(const std::string modeName) override;
+	double getFrameWidth() const override;
+	double getFrameHeight() const override;
+	double getFrameRate() const override;
+	bool getVideoPropertyConstraint(const PSVRVideoPropertyType property_type, PSVRVideoPropertyConstraint &outConstraint) const override;
+    void setVideoProperty(const PSVRVideoPropertyType property_type, int desired_value, bool save_setting) override;
+    int getVideoProperty(const PSVRVideoPropertyType property_type) const override;
+    void getCameraIntrinsics(PSVRTrackerIntrinsics &out_tracker_intrinsics) const override;
+    void setCameraIntrinsics(const PSVRTrackerIntrinsics &tracker_intrinsics) override;
+    PSVRPosef getTrackerPose() const override;
+    void setTrackerPose(const PSVRPosef *pose) override;
+    void getFOV(float &outHFOV, float &outVFOV) const override;
+    void getZRange(float &outZNear, float &outZFar) const override;
+    void gatherTrackingColorPresets(const std::string &table_name, PSVRClientTrackerSettings* settings) const override;
+    void setTrackingColorPreset(const std::string &table_name, PSVRTrackingColorType color, const PSVR_HSVColorRange *preset) override;
+    void getTrackingColorPreset(const std::string &table_name, PSVRTrackingColorType color, PSVR_HSVColorRange *out_preset) const override;
+	void setTrackerListener(ITrackerListener *listener) override;
+	void getDeviceStatistics(PSVRTrackerStatistics &out_statistics) const override;
+
+    // -- Getters
+    inline const CommonTrackerConfig &getConfig() const
+    { return m_cfg; }
+
+private:
+	class SessionReplay *m_replay;
+	int m_trackerIndex;
+	const struct SessionRecordingTrackerDesc *m_desc;
+
+    CommonTrackerConfig m_cfg;
+	TrackerModeConfig m_mode;
+	PSVRTrackerIntrinsics m_intrinsics;
+    std::string m_deviceIdentifier;
+
+	ITrackerListener *m_listener;
+};
+#endif // REPLAY_TRACKER_H
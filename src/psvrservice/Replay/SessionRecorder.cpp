@@ -0,0 +1,482 @@
+//-- includes -----
+#include "SessionRecorder.h"
+#include "SessionRecording.h"
+#include "DeviceManager.h"
+#include "HMDManager.h"
+#include "Logger.h"
+#include "MorpheusHMD.h"
+#include "ServerHMDView.h"
+#include "ServerTrackerView.h"
+#include "ServiceClock.h"
+#include "TrackerCapabilitiesConfig.h"
+#include "TrackerManager.h"
+#include "Utility.h"
+
+#include "readerwriterqueue.h" // lockfree queue
+
+#include <algorithm>
+#include <errno.h>
+#include <mutex>
+#include <string.h>
+#include <vector>
+
+//-- constants -----
+// Chunks in flight per device before the producer starts dropping them
+static const int k_tracker_chunk_slot_count= 8;
+static const int k_hmd_chunk_slot_count= 256;
+
+static const size_t k_file_buffer_size= 4*1024*1024;
+// Producers wake the writer thread as they post chunks, this is just a backstop
+static const std::chrono::milliseconds k_writer_wait_timeout(100);
+
+//-- private definitions -----
+struct SessionRecorderChunk
+{
+	SessionRecordingChunkHeader header;
+	unsigned char *payload;
+};
+
+typedef moodycamel::ReaderWriterQueue<SessionRecorderChunk *> t_recorder_chunk_queue;
+
+struct SessionRecorderSource
+{
+	std::mutex producer_mutex; // held by the producer thread while it records a chunk
+	int device_index; // index of the device in the recording, -1 if the device isn't recorded
+	uint32_t payload_size;
+	SessionRecorderChunk *chunks;
+	unsigned char *payload_buffer;
+	t_recorder_chunk_queue *free_chunks; // writer -> producer
+	t_recorder_chunk_queue *pending_chunks; // producer -> writer
+
+	SessionRecorderSource()
+		: device_index(-1)
+		, payload_size(0)
+		, chunks(nullptr)
+		, payload_buffer(nullptr)
+		, free_chunks(nullptr)
+		, pending_chunks(nullptr)
+	{}
+
+	void allocate(
+		const int in_device_index,
+		const eSessionRecordingChunkType chunk_type,
+		const uint32_t in_payload_size,
+		const int chunk_count)
+	{
+		const uint32_t padded_payload_size= session_recording_padded_size(in_payload_size);
+
+		device_index= in_device_index;
+		payload_size= in_payload_size;
+		chunks= new SessionRecorderChunk[chunk_count];
+		payload_buffer= new unsigned char[padded_payload_size*chunk_count];
+		free_chunks= new t_recorder_chunk_queue(chunk_count);
+		pending_chunks= new t_recorder_chunk_queue(chunk_count);
+
+		for (int chunk_index = 0; chunk_index < chunk_count; ++chunk_index)
+		{
+			SessionRecorderChunk *chunk= &chunks[chunk_index];
+
+			chunk->header.chunk_type= static_cast<uint16_t>(chunk_type);
+			chunk->header.device_index= static_cast<uint16_t>(device_index);
+			chunk->header.payload_size= payload_size;
+			chunk->header.timestamp_ns= 0;
+			chunk->payload= &payload_buffer[padded_payload_size*chunk_index];
+
+			free_chunks->enqueue(chunk);
+		}
+	}
+
+	void free()
+	{
+		delete pending_chunks;
+		delete free_chunks;
+		delete[] payload_buffer;
+		delete[] chunks;
+
+		device_index= -1;
+		payload_size= 0;
+		chunks= nullptr;
+		payload_buffer= nullptr;
+		free_chunks= nullptr;
+		pending_chunks= nullptr;
+	}
+};
+
+//-- private methods -----
+static void init_tracker_desc(
+	ServerTrackerView *tracker_view, const ServerHMDView *hmd_view, SessionRecordingTrackerDesc &out_desc);
+
+// -- public interface -----
+SessionRecorder::SessionRecorder()
+	: WorkerThread("SessionRecorder")
+	, m_file(nullptr)
+	, m_chunkCount(0)
+	, m_sources(nullptr)
+	, m_sourceCount(TrackerManager::k_max_devices + HMDManager::k_max_devices)
+	, m_bIsRecording({false})
+	, m_bWriteFailed({false})
+	, m_droppedChunkCount({0})
+{
+	m_sources= new SessionRecorderSource[m_sourceCount];
+}
+
+SessionRecorder::~SessionRecorder()
+{
+	stopRecording();
+
+	delete[] m_sources;
+}
+
+bool SessionRecorder::startRecording(const std::string &path)
+{
+	if (m_bIsRecording)
+	{
+		PSVR_LOG_WARNING("SessionRecorder::startRecording") << "Already recording a session. Ignoring request.";
+		return false;
+	}
+
+	if (m_file != nullptr)
+	{
+		// The previous recording stopped itself after a write failure, close out its file first
+		stopRecording();
+	}
+
+	DeviceManager *device_manager= DeviceManager::getInstance();
+	std::vector<SessionRecordingTrackerDesc> tracker_descs;
+	std::vector<SessionRecordingHMDDesc> hmd_descs;
+
+	// Record every open HMD that has an IMU
+	ServerHMDViewPtr first_hmd_view;
+	for (int hmd_id = 0; hmd_id < HMDManager::k_max_devices; ++hmd_id)
+	{
+		ServerHMDViewPtr hmd_view= device_manager->getHMDViewPtr(hmd_id);
+
+		if (hmd_view->getIsOpen() && hmd_view->getHMDDeviceType() == CommonSensorState::Morpheus)
+		{
+			SessionRecordingHMDDesc desc;
+			desc.device_type= hmd_view->getHMDDeviceType();
+			desc.tracking_color_id= hmd_view->getTrackingColorID();
+
+			m_sources[TrackerManager::k_max_devices + hmd_id].allocate(
+				static_cast<int>(hmd_descs.size()),
+				SessionRecordingChunk_HMDSensorState,
+				sizeof(MorpheusHMDSensorState),
+				k_hmd_chunk_slot_count);
+			hmd_descs.push_back(desc);
+
+			if (!first_hmd_view)
+			{
+				first_hmd_view= hmd_view;
+			}
+		}
+	}
+
+	// Record every open tracker
+	for (int tracker_id = 0; tracker_id < TrackerManager::k_max_devices; ++tracker_id)
+	{
+		ServerTrackerViewPtr tracker_view= device_manager->getTrackerViewPtr(tracker_id);
+
+		if (tracker_view->getIsOpen())
+		{
+			SessionRecordingTrackerDesc desc;
+			init_tracker_desc(tracker_view.get(), first_hmd_view.get(), desc);
+
+			m_sources[tracker_id].allocate(
+				static_cast<int>(tracker_descs.size()),
+				SessionRecordingChunk_TrackerFrame,
+				desc.frame_size,
+				k_tracker_chunk_slot_count);
+			tracker_descs.push_back(desc);
+		}
+	}
+
+	m_file= fopen(path.c_str(), "wb");
+	if (m_file == nullptr)
+	{
+		PSVR_LOG_ERROR("SessionRecorder::startRecording") << "Failed to open session recording file: " << path;
+		free_sources();
+		return false;
+	}
+
+	// Frames are large, so give the writes a big buffer
+	setvbuf(m_file, nullptr, _IOFBF, k_file_buffer_size);
+
+	SessionRecordingFileHeader header;
+	memset(&header, 0, sizeof(header));
+	strncpy(header.magic, SESSION_RECORDING_MAGIC, sizeof(header.magic));
+	header.version= SESSION_RECORDING_VERSION;
+	header.tracker_count= static_cast<uint32_t>(tracker_descs.size());
+	header.hmd_count= static_cast<uint32_t>(hmd_descs.size());
+	header.hmd_sensor_state_size= sizeof(MorpheusHMDSensorState);
+
+	bool bWroteHeader= fwrite(&header, sizeof(header), 1, m_file) == 1;
+	if (bWroteHeader && tracker_descs.size() > 0)
+	{
+		bWroteHeader=
+			fwrite(tracker_descs.data(), sizeof(SessionRecordingTrackerDesc), tracker_descs.size(), m_file)
+			== tracker_descs.size();
+	}
+	if (bWroteHeader && hmd_descs.size() > 0)
+	{
+		bWroteHeader=
+			fwrite(hmd_descs.data(), sizeof(SessionRecordingHMDDesc), hmd_descs.size(), m_file)
+			== hmd_descs.size();
+	}
+	if (!bWroteHeader)
+	{
+		PSVR_LOG_ERROR("SessionRecorder::startRecording") << "Failed to write session recording header to " << path << ": " << strerror(errno);
+		fclose(m_file);
+		m_file= nullptr;
+		free_sources();
+		return false;
+	}
+
+	m_chunkCount= 0;
+	m_droppedChunkCount= 0;
+	m_bWriteFailed= false;
+	m_startTimestamp= ServiceClock::now();
+
+	startThread();
+	m_bIsRecording= true;
+
+	PSVR_LOG_INFO("SessionRecorder::startRecording") << "Recording " << tracker_descs.size() << " trackers and "
+		<< hmd_descs.size() << " HMDs to " << path;
+
+	return true;
+}
+
+bool SessionRecorder::stopRecording()
+{
+	// A write failure clears m_bIsRecording but leaves the file open for us to close
+	if (m_file == nullptr)
+	{
+		return false;
+	}
+
+	m_bIsRecording= false;
+
+	// Wait out any producer that was in the middle of recording a chunk
+	for (int source_index = 0; source_index < m_sourceCount; ++source_index)
+	{
+		std::lock_guard<std::mutex> lock(m_sources[source_index].producer_mutex);
+	}
+
+	// Flush whatever the writer thread didn't get to
+	stopThread();
+	write_pending_chunks();
+
+	// Rewrite the header now that the totals are known
+	SessionRecordingFileHeader header;
+	memset(&header, 0, sizeof(header));
+	strncpy(header.magic, SESSION_RECORDING_MAGIC, sizeof(header.magic));
+	header.version= SESSION_RECORDING_VERSION;
+	header.hmd_sensor_state_size= sizeof(MorpheusHMDSensorState);
+	header.chunk_count= m_chunkCount;
+	header.duration_ns=
+		std::chrono::duration_cast<std::chrono::nanoseconds>(
+			ServiceClock::now() - m_startTimestamp).count();
+	for (int source_index = 0; source_index < m_sourceCount; ++source_index)
+	{
+		if (m_sources[source_index].device_index >= 0)
+		{
+			if (source_index < TrackerManager::k_max_devices)
+				++header.tracker_count;
+			else
+				++header.hmd_count;
+		}
+	}
+
+	bool bSuccess= !m_bWriteFailed;
+	if (bSuccess)
+	{
+		bSuccess=
+			fseek(m_file, 0, SEEK_SET) == 0 &&
+			fwrite(&header, sizeof(header), 1, m_file) == 1;
+		if (!bSuccess)
+		{
+			PSVR_LOG_ERROR("SessionRecorder::stopRecording") << "Failed to rewrite session recording header: " << strerror(errno);
+		}
+	}
+	if (fclose(m_file) != 0 && bSuccess)
+	{
+		PSVR_LOG_ERROR("SessionRecorder::stopRecording") << "Failed to flush session recording: " << strerror(errno);
+		bSuccess= false;
+	}
+	m_file= nullptr;
+
+	free_sources();
+
+	if (bSuccess)
+	{
+		PSVR_LOG_INFO("SessionRecorder::stopRecording") << "Wrote " << header.chunk_count << " chunks ("
+			<< m_droppedChunkCount << " dropped)";
+	}
+	else
+	{
+		PSVR_LOG_WARNING("SessionRecorder::stopRecording") << "Session recording is incomplete after "
+			<< header.chunk_count << " chunks";
+	}
+
+	return bSuccess;
+}
+
+void SessionRecorder::recordTrackerFrame(
+	const int tracker_id, 
+	const unsigned char *video_frame, 
+	const t_service_timepoint &capture_timestamp)
+{
+	if (m_bIsRecording && Utility::is_index_valid(tracker_id, TrackerManager::k_max_devices))
+	{
+		record_chunk(tracker_id, video_frame, capture_timestamp);
+	}
+}
+
+void SessionRecorder::recordHMDSensorState(
+	const int hmd_id, 
+	const MorpheusHMDSensorState *sensor_state, 
+	const t_service_timepoint &capture_timestamp)
+{
+	if (m_bIsRecording && Utility::is_index_valid(hmd_id, HMDManager::k_max_devices))
+	{
+		record_chunk(TrackerManager::k_max_devices + hmd_id, sensor_state, capture_timestamp);
+	}
+}
+
+// -- protected methods -----
+bool SessionRecorder::doWork()
+{
+	if (!write_pending_chunks())
+	{
+		// Wait for the tracker and HMD threads to hand over more chunks
+		waitForWork(k_writer_wait_timeout);
+	}
+
+	return true;
+}
+
+bool SessionRecorder::write_pending_chunks()
+{
+	static const unsigned char k_padding[SESSION_RECORDING_CHUNK_ALIGNMENT]= {0};
+	bool bWroteChunks= false;
+
+	// Once a write fails the file is unusable, leave the pending chunks for free_sources()
+	if (m_bWriteFailed)
+		return false;
+
+	for (int source_index = 0; source_index < m_sourceCount; ++source_index)
+	{
+		SessionRecorderSource &source= m_sources[source_index];
+
+		if (source.device_index < 0)
+			continue;
+
+		SessionRecorderChunk *chunk= nullptr;
+		while (source.pending_chunks->try_dequeue(chunk))
+		{
+			const uint32_t padding_size= session_recording_padded_size(source.payload_size) - source.payload_size;
+
+			const bool bWroteChunk=
+				fwrite(&chunk->header, sizeof(SessionRecordingChunkHeader), 1, m_file) == 1 &&
+				fwrite(chunk->payload, source.payload_size, 1, m_file) == 1 &&
+				(padding_size == 0 || fwrite(k_padding, padding_size, 1, m_file) == 1);
+
+			// Hand the chunk back to the producer
+			source.free_chunks->enqueue(chunk);
+
+			if (!bWroteChunk)
+			{
+				// Usually a full disk. Stop the producers, stopRecording() closes the file.
+				PSVR_MT_LOG_ERROR("SessionRecorder::write_pending_chunks") << "Failed to write session recording chunk "
+					<< m_chunkCount << ", stopping recording: " << strerror(errno);
+				m_bWriteFailed= true;
+				m_bIsRecording= false;
+				return bWroteChunks;
+			}
+
+			++m_chunkCount;
+			bWroteChunks= true;
+		}
+	}
+
+	return bWroteChunks;
+}
+
+void SessionRecorder::record_chunk(const int source_index, const void *payload, const t_service_timepoint &capture_timestamp)
+{
+	SessionRecorderSource &source= m_sources[source_index];
+	std::lock_guard<std::mutex> lock(source.producer_mutex);
+
+	// Recording may have stopped while we waited on the lock
+	if (!m_bIsRecording || source.device_index < 0)
+		return;
+
+	SessionRecorderChunk *chunk= nullptr;
+	if (!source.free_chunks->try_dequeue(chunk))
+	{
+		// The writer thread has fallen behind
+		++m_droppedChunkCount;
+		return;
+	}
+
+	// Store the capture time rather than the time we got here, so that a replay feeds the pipeline the same timestamps
+	chunk->header.timestamp_ns=
+		std::chrono::duration_cast<std::chrono::nanoseconds>(
+			capture_timestamp - m_startTimestamp).count();
+	memcpy(chunk->payload, payload, source.payload_size);
+
+	source.pending_chunks->enqueue(chunk);
+	signalWork();
+}
+
+void SessionRecorder::free_sources()
+{
+	for (int source_index = 0; source_index < m_sourceCount; ++source_index)
+	{
+		if (m_sources[source_index].device_index >= 0)
+		{
+			m_sources[source_index].free();
+		}
+	}
+}
+
+// -- private methods -----
+static void init_tracker_desc(
+	ServerTrackerView *tracker_view,
+	const ServerHMDView *hmd_view,
+	SessionRecordingTrackerDesc &out_desc)
+{
+	const TrackerModeConfig *mode= tracker_view->getTrackerMode();
+
+	memset(&out_desc, 0, sizeof(SessionRecordingTrackerDesc));
+	out_desc.device_type= tracker_view->getTrackerDeviceType();
+	out_desc.frame_format=
+		(mode->bufferFormat == CAMERA_BUFFER_FORMAT_BEYER)
+		? SessionRecordingFrame_Bayer
+		: SessionRecordingFrame_BGR;
+	out_desc.buffer_pixel_width= mode->bufferPixelWidth;
+	out_desc.buffer_pixel_height= mode->bufferPixelHeight;
+	out_desc.frame_size=
+		static_cast<uint32_t>(mode->bufferPixelWidth*mode->bufferPixelHeight) *
+		((out_desc.frame_format == SessionRecordingFrame_Bayer) ? 1 : 3);
+	out_desc.frame_rate= mode->frameRate;
+	out_desc.is_stereo= tracker_view->getIsStereoCamera() ? 1 : 0;
+	out_desc.is_frame_mirrored= mode->isFrameMirrored ? 1 : 0;
+	out_desc.is_buffer_mirrored= mode->isBufferMirrored ? 1 : 0;
+
+	const size_t section_count= std::min<size_t>(mode->frameSections.size(), 2);
+	out_desc.frame_section_count= static_cast<uint8_t>(section_count);
+	for (size_t section_index = 0; section_index < section_count; ++section_index)
+	{
+		out_desc.frame_section_x[section_index]= mode->frameSections[section_index].x;
+		out_desc.frame_section_y[section_index]= mode->frameSections[section_index].y;
+	}
+
+	strncpy(out_desc.mode_name, mode->modeName.c_str(), sizeof(out_desc.mode_name) - 1);
+	tracker_view->getCameraIntrinsics(out_desc.intrinsics);
+	out_desc.pose= tracker_view->getTrackerPose();
+
+	// The replay tracker uses the color presets the tracker had for the recorded HMD
+	PSVRClientTrackerSettings settings;
+	tracker_view->gatherTrackingColorPresets(hmd_view, &settings);
+	out_desc.color_presets= settings.color_range_table;
+}
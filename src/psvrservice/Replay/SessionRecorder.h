@@ -0,0 +1,61 @@
+#ifndef SESSION_RECORDER_H
+#define SESSION_RECORDER_H
+
+//-- includes -----
+#include "ServiceClock.h"
+#include "WorkerThread.h"
+#include <atomic>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+
+//-- definitions -----
+/// Records the raw tracker video frames and HMD IMU packets of the open devices into a session recording
+/// (see SessionRecording.h) that ReplayTracker and ReplayHMD can play back later.
+/// The tracker and HMD threads copy their data into preallocated chunks and hand them off to
+/// the recorder's thread, which does the file writing. If the writer falls behind the chunks are dropped.
+/// If a write fails (e.g. the disk is full) the recorder stops recording on its own.
+class SessionRecorder : public WorkerThread
+{
+public:
+	SessionRecorder();
+	virtual ~SessionRecorder();
+
+	/// Start recording the trackers and HMDs that are currently open (main thread)
+	bool startRecording(const std::string &path);
+
+	/// Stop recording and finish writing the file (main thread).
+	/// Also closes the file of a recording that stopped itself after a write failure.
+	/// Returns false if there was no file open or the file is incomplete.
+	bool stopRecording();
+
+	inline bool getIsRecording() const { return m_bIsRecording; }
+	inline uint64_t getDroppedChunkCount() const { return m_droppedChunkCount; }
+
+	/// Called from a tracker's video thread with the frame it's about to hand to the tracker view
+	void recordTrackerFrame(const int tracker_id, const unsigned char *video_frame, const t_service_timepoint &capture_timestamp);
+
+	/// Called from an HMD's sensor thread with the sensor state it's about to hand to the HMD view
+	void recordHMDSensorState(const int hmd_id, const struct MorpheusHMDSensorState *sensor_state, const t_service_timepoint &capture_timestamp);
+
+protected:
+	virtual bool doWork() override;
+
+	bool write_pending_chunks();
+	void record_chunk(const int source_index, const void *payload, const t_service_timepoint &capture_timestamp);
+	void free_sources();
+
+	// Writer State (recorder thread while recording, main thread otherwise)
+	FILE *m_file;
+	uint64_t m_chunkCount;
+
+	// Multithreaded state
+	struct SessionRecorderSource *m_sources; // one per tracker id, then one per hmd id
+	int m_sourceCount;
+	std::atomic_bool m_bIsRecording;
+	std::atomic_bool m_bWriteFailed; // set by the writer when fwrite fails, producers see m_bIsRecording cleared
+	std::atomic<uint64_t> m_droppedChunkCount;
+	t_service_timepoint m_startTimestamp;
+};
+
+#endif // SESSION_RECORDER_H
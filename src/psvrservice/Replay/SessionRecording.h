@@ -0,0 +1,83 @@
+#ifndef SESSION_RECORDING_H
+#define SESSION_RECORDING_H
+
+//-- includes -----
+#include "ClientColor_CAPI.h"
+#include "PSVRClient_CAPI.h"
+#include <stdint.h>
+
+//-- constants -----
+// A session recording is a header, a descriptor for every recorded tracker and HMD,
+// and then a stream of chunks (a chunk header followed by its payload).
+// Everything is written in native byte order and struct layout so the reader can use the
+// memory mapped file in place, which means a recording is only readable by a build for the same platform.
+#define SESSION_RECORDING_MAGIC "PSVRREC"
+#define SESSION_RECORDING_VERSION 1
+
+// Chunk payloads start on this alignment
+#define SESSION_RECORDING_CHUNK_ALIGNMENT 8
+
+enum eSessionRecordingChunkType
+{
+	SessionRecordingChunk_TrackerFrame= 1, // raw video frame as passed to ITrackerListener::notifyVideoFrameReceived
+	SessionRecordingChunk_HMDSensorState= 2, // MorpheusHMDSensorState as passed to IHMDListener::notifySensorDataReceived
+};
+
+enum eSessionRecordingFrameFormat
+{
+	SessionRecordingFrame_BGR= 0, // 3 bytes per pixel
+	SessionRecordingFrame_Bayer= 1, // 1 byte per pixel, GRBG
+};
+
+//-- definitions -----
+struct SessionRecordingFileHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t tracker_count;
+	uint32_t hmd_count;
+	uint32_t hmd_sensor_state_size; // sizeof(MorpheusHMDSensorState) in the recording build
+	uint64_t chunk_count; // 0 if the recording wasn't closed cleanly
+	int64_t duration_ns;
+};
+
+struct SessionRecordingTrackerDesc
+{
+	int32_t device_type; // CommonSensorState::eDeviceType of the recorded tracker
+	int32_t frame_format; // eSessionRecordingFrameFormat
+	int32_t buffer_pixel_width;
+	int32_t buffer_pixel_height;
+	uint32_t frame_size; // bytes per recorded frame
+	float frame_rate;
+	uint8_t is_stereo;
+	uint8_t is_frame_mirrored;
+	uint8_t is_buffer_mirrored;
+	uint8_t frame_section_count;
+	int32_t frame_section_x[2];
+	int32_t frame_section_y[2];
+	char mode_name[64];
+	PSVRTrackerIntrinsics intrinsics;
+	PSVRPosef pose;
+	PSVR_HSVColorRangeTable color_presets; // the presets the tracker used for the recorded HMDs
+};
+
+struct SessionRecordingHMDDesc
+{
+	int32_t device_type; // CommonSensorState::eDeviceType of the recorded HMD
+	int32_t tracking_color_id; // PSVRTrackingColorType
+};
+
+struct SessionRecordingChunkHeader
+{
+	uint16_t chunk_type; // eSessionRecordingChunkType
+	uint16_t device_index; // index into the tracker or HMD descriptors
+	uint32_t payload_size; // not including the alignment padding
+	int64_t timestamp_ns; // capture time relative to the start of the recording
+};
+
+inline uint32_t session_recording_padded_size(uint32_t size)
+{
+	return (size + (SESSION_RECORDING_CHUNK_ALIGNMENT - 1)) & ~static_cast<uint32_t>(SESSION_RECORDING_CHUNK_ALIGNMENT - 1);
+}
+
+#endif // SESSION_RECORDING_H
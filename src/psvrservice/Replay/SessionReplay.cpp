@@ -0,0 +1,368 @@
+//-- includes -----
+#include "SessionReplay.h"
+#include "SessionRecording.h"
+#include "DeviceInterface.h"
+#include "Logger.h"
+#include "MorpheusHMD.h"
+#include "Utility.h"
+
+#include <algorithm>
+#include <string.h>
+#include <thread>
+
+//-- constants -----
+// Longest the replay thread sleeps before checking for a stop request
+static const std::chrono::milliseconds k_max_replay_wait(10);
+
+//-- public interface -----
+SessionReplay::SessionReplay()
+	: WorkerThread("SessionReplay")
+	, m_file()
+	, m_header(nullptr)
+	, m_trackerDescs(nullptr)
+	, m_hmdDescs(nullptr)
+	, m_chunks()
+	, m_playbackSpeed(1.f)
+	, m_nextChunkIndex(0)
+	, m_bIsPlaying(false)
+	, m_clock(std::chrono::high_resolution_clock::now())
+	, m_clockStartTime()
+	, m_bIsFinished(false)
+{
+}
+
+SessionReplay::~SessionReplay()
+{
+	closeRecording();
+}
+
+bool SessionReplay::openRecording(const std::string &path, const float playback_speed)
+{
+	closeRecording();
+
+	if (!m_file.open(path))
+	{
+		PSVR_LOG_ERROR("SessionReplay::openRecording") << "Failed to map session recording: " << path;
+		return false;
+	}
+
+	const unsigned char *data= m_file.getData();
+	const size_t size= m_file.getSize();
+
+	if (size < sizeof(SessionRecordingFileHeader))
+	{
+		PSVR_LOG_ERROR("SessionReplay::openRecording") << "Session recording is too small: " << path;
+		m_file.close();
+		return false;
+	}
+
+	m_header= reinterpret_cast<const SessionRecordingFileHeader *>(data);
+	if (strncmp(m_header->magic, SESSION_RECORDING_MAGIC, sizeof(m_header->magic)) != 0 ||
+		m_header->version != SESSION_RECORDING_VERSION)
+	{
+		PSVR_LOG_ERROR("SessionReplay::openRecording") << "Not a version " << SESSION_RECORDING_VERSION << " session recording: " << path;
+		closeRecording();
+		return false;
+	}
+
+	if (m_header->hmd_sensor_state_size != sizeof(MorpheusHMDSensorState))
+	{
+		PSVR_LOG_ERROR("SessionReplay::openRecording") << "Session recording was made by an incompatible build: " << path;
+		closeRecording();
+		return false;
+	}
+
+	const size_t desc_size=
+		sizeof(SessionRecordingFileHeader) +
+		m_header->tracker_count*sizeof(SessionRecordingTrackerDesc) +
+		m_header->hmd_count*sizeof(SessionRecordingHMDDesc);
+	if (m_header->tracker_count > 0xffff || m_header->hmd_count > 0xffff || size < desc_size)
+	{
+		PSVR_LOG_ERROR("SessionReplay::openRecording") << "Session recording has a corrupt header: " << path;
+		closeRecording();
+		return false;
+	}
+
+	m_trackerDescs= reinterpret_cast<const SessionRecordingTrackerDesc *>(data + sizeof(SessionRecordingFileHeader));
+	m_hmdDescs= reinterpret_cast<const SessionRecordingHMDDesc *>(m_trackerDescs + m_header->tracker_count);
+
+	for (uint32_t tracker_index = 0; tracker_index < m_header->tracker_count; ++tracker_index)
+	{
+		const SessionRecordingTrackerDesc &desc= m_trackerDescs[tracker_index];
+		const uint32_t bytes_per_pixel= (desc.frame_format == SessionRecordingFrame_Bayer) ? 1 : 3;
+
+		if (desc.buffer_pixel_width <= 0 || desc.buffer_pixel_height <= 0 ||
+			desc.frame_size != static_cast<uint32_t>(desc.buffer_pixel_width*desc.buffer_pixel_height)*bytes_per_pixel)
+		{
+			PSVR_LOG_ERROR("SessionReplay::openRecording") << "Session recording has a corrupt tracker descriptor: " << path;
+			closeRecording();
+			return false;
+		}
+	}
+
+	if (!index_chunks())
+	{
+		PSVR_LOG_ERROR("SessionReplay::openRecording") << "Session recording has no chunks: " << path;
+		closeRecording();
+		return false;
+	}
+
+	m_trackerListeners.assign(m_header->tracker_count, nullptr);
+	m_hmdListeners.assign(m_header->hmd_count, nullptr);
+	m_playbackSpeed= std::max(playback_speed, 0.f);
+	m_nextChunkIndex= 0;
+	m_bIsPlaying= false;
+	m_bIsFinished= false;
+
+	// The pipeline runs on the recorded timeline from here on
+	m_clockStartTime= ServiceClock::now();
+	m_clock.advanceTo(m_clockStartTime);
+	ServiceClock::setClock(&m_clock);
+
+	if (m_playbackSpeed > 0.f)
+	{
+		PSVR_LOG_INFO("SessionReplay::openRecording") << "Replaying " << m_chunks.size() << " chunks from "
+			<< m_header->tracker_count << " trackers and " << m_header->hmd_count << " HMDs at "
+			<< m_playbackSpeed << "x speed: " << path;
+	}
+	else
+	{
+		PSVR_LOG_INFO("SessionReplay::openRecording") << "Replaying " << m_chunks.size() << " chunks from "
+			<< m_header->tracker_count << " trackers and " << m_header->hmd_count << " HMDs as fast as possible: " << path;
+	}
+
+	startThread();
+
+	return true;
+}
+
+void SessionReplay::closeRecording()
+{
+	stopThread();
+
+	if (ServiceClock::getClock() == &m_clock)
+	{
+		ServiceClock::setClock(nullptr);
+	}
+
+	m_chunks.clear();
+	m_trackerListeners.clear();
+	m_hmdListeners.clear();
+	m_header= nullptr;
+	m_trackerDescs= nullptr;
+	m_hmdDescs= nullptr;
+	m_file.close();
+}
+
+int SessionReplay::getTrackerCount() const
+{
+	return (m_header != nullptr) ? static_cast<int>(m_header->tracker_count) : 0;
+}
+
+int SessionReplay::getHMDCount() const
+{
+	return (m_header != nullptr) ? static_cast<int>(m_header->hmd_count) : 0;
+}
+
+const SessionRecordingTrackerDesc *SessionReplay::getTrackerDesc(const int tracker_index) const
+{
+	return Utility::is_index_valid(tracker_index, getTrackerCount()) ? &m_trackerDescs[tracker_index] : nullptr;
+}
+
+const SessionRecordingHMDDesc *SessionReplay::getHMDDesc(const int hmd_index) const
+{
+	return Utility::is_index_valid(hmd_index, getHMDCount()) ? &m_hmdDescs[hmd_index] : nullptr;
+}
+
+void SessionReplay::setTrackerListener(const int tracker_index, ITrackerListener *listener)
+{
+	std::lock_guard<std::mutex> lock(m_listenerMutex);
+
+	if (Utility::is_index_valid(tracker_index, static_cast<int>(m_trackerListeners.size())))
+	{
+		m_trackerListeners[tracker_index]= listener;
+	}
+}
+
+void SessionReplay::setHMDListener(const int hmd_index, IHMDListener *listener)
+{
+	std::lock_guard<std::mutex> lock(m_listenerMutex);
+
+	if (Utility::is_index_valid(hmd_index, static_cast<int>(m_hmdListeners.size())))
+	{
+		m_hmdListeners[hmd_index]= listener;
+	}
+}
+
+//-- protected methods -----
+bool SessionReplay::doWork()
+{
+	if (m_nextChunkIndex >= m_chunks.size())
+	{
+		// Playback finished, idle until the recording is closed
+		Utility::sleep_ms(static_cast<int>(k_max_replay_wait.count()));
+		return true;
+	}
+
+	if (!m_bIsPlaying)
+	{
+		// Wait for the replay devices to get opened
+		if (!all_devices_attached())
+		{
+			Utility::sleep_ms(static_cast<int>(k_max_replay_wait.count()));
+			return true;
+		}
+
+		PSVR_MT_LOG_INFO("SessionReplay::doWork") << "All replay devices attached. Starting playback.";
+		m_playbackStartTime= std::chrono::high_resolution_clock::now();
+		m_bIsPlaying= true;
+	}
+
+	const SessionRecordingChunkHeader *chunk_header= m_chunks[m_nextChunkIndex];
+	const std::chrono::nanoseconds chunk_offset(chunk_header->timestamp_ns - m_chunks[0]->timestamp_ns);
+
+	if (m_playbackSpeed > 0.f)
+	{
+		const std::chrono::nanoseconds wall_offset(static_cast<int64_t>(chunk_offset.count() / m_playbackSpeed));
+		const auto chunk_time= m_playbackStartTime + wall_offset;
+		const auto now= std::chrono::high_resolution_clock::now();
+
+		if (now < chunk_time)
+		{
+			const auto wait_duration= std::chrono::duration_cast<std::chrono::nanoseconds>(chunk_time - now);
+
+			std::this_thread::sleep_for(std::min<std::chrono::nanoseconds>(wait_duration, k_max_replay_wait));
+			return true;
+		}
+	}
+
+	// Packets from the chunk get stamped with its recorded time
+	m_clock.advanceTo(m_clockStartTime + std::chrono::duration_cast<t_service_duration>(chunk_offset));
+
+	dispatch_chunk(chunk_header);
+	++m_nextChunkIndex;
+
+	if (m_nextChunkIndex >= m_chunks.size())
+	{
+		const std::chrono::duration<double, std::milli> playback_duration=
+			std::chrono::high_resolution_clock::now() - m_playbackStartTime;
+
+		PSVR_MT_LOG_INFO("SessionReplay::doWork") << "Playback finished: " << m_chunks.size() << " chunks in "
+			<< playback_duration.count() << "ms";
+		m_bIsFinished= true;
+	}
+
+	return true;
+}
+
+bool SessionReplay::index_chunks()
+{
+	const unsigned char *data= m_file.getData();
+	const size_t size= m_file.getSize();
+	size_t offset=
+		sizeof(SessionRecordingFileHeader) +
+		m_header->tracker_count*sizeof(SessionRecordingTrackerDesc) +
+		m_header->hmd_count*sizeof(SessionRecordingHMDDesc);
+
+	m_chunks.clear();
+	if (m_header->chunk_count > 0)
+	{
+		m_chunks.reserve(static_cast<size_t>(m_header->chunk_count));
+	}
+
+	while (offset + sizeof(SessionRecordingChunkHeader) <= size)
+	{
+		const SessionRecordingChunkHeader *chunk_header= reinterpret_cast<const SessionRecordingChunkHeader *>(data + offset);
+		const size_t chunk_size= sizeof(SessionRecordingChunkHeader) + session_recording_padded_size(chunk_header->payload_size);
+
+		bool bIsValid= offset + chunk_size <= size;
+		switch (chunk_header->chunk_type)
+		{
+		case SessionRecordingChunk_TrackerFrame:
+			bIsValid&=
+				chunk_header->device_index < m_header->tracker_count &&
+				chunk_header->payload_size == m_trackerDescs[chunk_header->device_index].frame_size;
+			break;
+		case SessionRecordingChunk_HMDSensorState:
+			bIsValid&=
+				chunk_header->device_index < m_header->hmd_count &&
+				chunk_header->payload_size == m_header->hmd_sensor_state_size;
+			break;
+		default:
+			bIsValid= false;
+		}
+
+		if (!bIsValid)
+		{
+			// A recording that wasn't closed cleanly can end in a partially written chunk
+			PSVR_LOG_WARNING("SessionReplay::index_chunks") << "Ignoring session recording data after chunk " << m_chunks.size();
+			break;
+		}
+
+		m_chunks.push_back(chunk_header);
+		offset+= chunk_size;
+	}
+
+	// Chunks from different devices are written in the order the recorder thread drained them
+	std::stable_sort(
+		m_chunks.begin(), m_chunks.end(),
+		[](const SessionRecordingChunkHeader *a, const SessionRecordingChunkHeader *b) {
+			return a->timestamp_ns < b->timestamp_ns;
+		});
+
+	return m_chunks.size() > 0;
+}
+
+bool SessionReplay::all_devices_attached()
+{
+	std::lock_guard<std::mutex> lock(m_listenerMutex);
+
+	for (ITrackerListener *listener : m_trackerListeners)
+	{
+		if (listener == nullptr)
+			return false;
+	}
+
+	for (IHMDListener *listener : m_hmdListeners)
+	{
+		if (listener == nullptr)
+			return false;
+	}
+
+	return true;
+}
+
+void SessionReplay::dispatch_chunk(const SessionRecordingChunkHeader *chunk_header)
+{
+	const unsigned char *payload= reinterpret_cast<const unsigned char *>(chunk_header + 1);
+
+	// Hold the lock while dispatching so a device can't close underneath us
+	std::lock_guard<std::mutex> lock(m_listenerMutex);
+
+	switch (chunk_header->chunk_type)
+	{
+	case SessionRecordingChunk_TrackerFrame:
+		{
+			ITrackerListener *listener= m_trackerListeners[chunk_header->device_index];
+
+			if (listener != nullptr)
+			{
+				// Frames are handed over straight from the mapped file.
+				// The service clock was stepped to the recorded capture time of the chunk.
+				listener->notifyVideoFrameReceived(payload, ServiceClock::now());
+			}
+		} break;
+	case SessionRecordingChunk_HMDSensorState:
+		{
+			IHMDListener *listener= m_hmdListeners[chunk_header->device_index];
+
+			if (listener != nullptr)
+			{
+				MorpheusHMDSensorState sensor_state;
+
+				memcpy(&sensor_state, payload, sizeof(MorpheusHMDSensorState));
+				listener->notifySensorDataReceived(&sensor_state, ServiceClock::now());
+			}
+		} break;
+	}
+}
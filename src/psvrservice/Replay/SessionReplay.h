@@ -0,0 +1,76 @@
+#ifndef SESSION_REPLAY_H
+#define SESSION_REPLAY_H
+
+//-- includes -----
+#include "MemoryMappedFile.h"
+#include "ServiceClock.h"
+#include "WorkerThread.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//-- definitions -----
+/// Plays back a session recording (see SessionRecording.h) into the listeners of the
+/// ReplayTracker and ReplayHMD devices, either paced by the recorded timestamps (optionally sped up) or as fast as possible.
+/// While a recording is open the replay drives the service clock, so the pipeline sees the recorded
+/// timestamps no matter how fast the packets are played back.
+/// Playback starts once every recorded device has attached a listener.
+class SessionReplay : public WorkerThread
+{
+public:
+	SessionReplay();
+	virtual ~SessionReplay();
+
+	/// Map the recording and start the replay thread (main thread).
+	/// A playback_speed of 1 replays in real time, 10 at ten times real time, and 0 as fast as possible.
+	/// Must be called before any devices are opened since it swaps the service clock.
+	bool openRecording(const std::string &path, const float playback_speed);
+
+	/// Stop the replay thread and unmap the recording (main thread)
+	void closeRecording();
+
+	inline bool getIsOpen() const { return m_file.getIsOpen(); }
+	inline float getPlaybackSpeed() const { return m_playbackSpeed; }
+	/// True once every chunk in the recording has been dispatched
+	inline bool getIsFinished() const { return m_bIsFinished; }
+	int getTrackerCount() const;
+	int getHMDCount() const;
+	const struct SessionRecordingTrackerDesc *getTrackerDesc(const int tracker_index) const;
+	const struct SessionRecordingHMDDesc *getHMDDesc(const int hmd_index) const;
+
+	/// Attach or detach (nullptr) the listener of a recorded device
+	void setTrackerListener(const int tracker_index, class ITrackerListener *listener);
+	void setHMDListener(const int hmd_index, class IHMDListener *listener);
+
+protected:
+	virtual bool doWork() override;
+
+	bool index_chunks();
+	bool all_devices_attached();
+	void dispatch_chunk(const struct SessionRecordingChunkHeader *chunk_header);
+
+	// Main Thread State (constant while the replay thread runs)
+	MemoryMappedFile m_file;
+	const struct SessionRecordingFileHeader *m_header;
+	const struct SessionRecordingTrackerDesc *m_trackerDescs;
+	const struct SessionRecordingHMDDesc *m_hmdDescs;
+	std::vector<const struct SessionRecordingChunkHeader *> m_chunks; // sorted by timestamp
+	float m_playbackSpeed;
+
+	// Replay Thread State
+	size_t m_nextChunkIndex;
+	bool m_bIsPlaying;
+	std::chrono::time_point<std::chrono::high_resolution_clock> m_playbackStartTime;
+
+	// Multithreaded state
+	SteppedServiceClock m_clock; // stepped to the time of each chunk before it's dispatched
+	t_service_timepoint m_clockStartTime;
+	std::atomic_bool m_bIsFinished;
+	std::mutex m_listenerMutex;
+	std::vector<class ITrackerListener *> m_trackerListeners;
+	std::vector<class IHMDListener *> m_hmdListeners;
+};
+
+#endif // SESSION_REPLAY_H
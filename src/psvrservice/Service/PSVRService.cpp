@@ -5,6 +5,7 @@
 #include "Version.h"
 #include "Logger.h"
 #include "PSVRServiceInterface.h"
+#include "TimelineTrace.h"
 #include "TrackerManager.h"
 #include "USBDeviceManager.h"
 #include "ServiceVersion.h"
@@ -56,6 +57,9 @@ bool PSVRService::startup(
 	// initialize logging system
 	log_init(log_level, "PSVRSERVICE.log");
 
+	// PSVR_Update() gets called from the same thread that starts the service
+	PSVR_TRACE_THREAD_NAME("PSVR_Update");
+
 	// Start the service app
 	PSVR_LOG_INFO("main") << "Starting PSVRService v" << PSVR_SERVICE_VERSION_STRING;	   
    
@@ -95,11 +99,17 @@ bool PSVRService::startup(
 void PSVRService::update()
 {
 	// Process any async results from the USB transfer thread
-	m_usb_device_manager->update();
+	{
+		PSVR_TRACE_ZONE("USB Results");
+		m_usb_device_manager->update();
+	}
 
 	// Update the list of active tracked devices
 	// Send device updates to the client
-	m_device_manager->update();
+	{
+		PSVR_TRACE_ZONE("Device Update");
+		m_device_manager->update();
+	}
 }
 
 void PSVRService::shutdown()
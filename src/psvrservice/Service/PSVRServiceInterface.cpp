@@ -1,19 +1,31 @@
 //-- includes -----
 #include "PSVRClient.h"
 #include "Logger.h"
+#include "SharedMemory.h"
+#include <cstring>
 #include <memory>
 
+//-- constants -----
+// Enough that a reader has a few frame times to use a frame in place before the writer comes back round to it
+static const int k_video_frame_slot_count= 4;
+// Readers give up on a copy after this many torn attempts (the writer is lapping them)
+static const int k_max_video_frame_copy_attempts= 4;
+// Keep each frame slot cache line aligned
+static const size_t k_video_frame_alignment= 64;
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "The shared video frame header needs address free 64-bit atomics");
+
+//-- private methods -----
+static size_t align_video_frame_size(size_t size);
+
 //-- implementation -----
 SharedVideoFrameBuffer::SharedVideoFrameBuffer()
 	: m_buffer_name()
-	, m_width(-1)
-	, m_height(-1)
-	, m_stride(-1)
-    , m_section_count(0)
-	, m_frame_index(-1)
+	, m_shared_memory(nullptr)
+	, m_header(nullptr)
+	, m_write_frame_index(0)
+	, m_bIsWritingFrame(false)
 {
-	m_buffer[0]= nullptr;
-	m_buffer[1]= nullptr;
 }
 
 SharedVideoFrameBuffer::~SharedVideoFrameBuffer()
@@ -25,25 +37,85 @@ bool SharedVideoFrameBuffer::initialize(const char *buffer_name, int width, int
 {
 	bool bSuccess = false;
 
-	if (m_buffer[0] == nullptr && m_buffer[1] == nullptr)
-	{			
-		PSVR_LOG_INFO("SharedVideoFrameBuffer::initialize()") << "Allocating video frame buffer: " << m_buffer_name;
-
-		size_t buffer_size= computeVideoBufferSize(section_count, stride, height);
-		m_buffer[0]= new unsigned char[buffer_size];
-		m_buffer[1]= new unsigned char[buffer_size];
-		std::memset(m_buffer[0], 0, buffer_size);
-		std::memset(m_buffer[1], 0, buffer_size);
-		
-		m_buffer_name = buffer_name;
-	   
-		m_width = width;
-		m_height = height;
-		m_stride = stride;
-        m_section_count = section_count;
-		m_frame_index = 0;
-
-		bSuccess = true;
+	if (m_shared_memory == nullptr && section_count > 0 && section_count <= PSVR_SHARED_VIDEO_FRAME_MAX_SECTIONS)
+	{
+		PSVR_LOG_INFO("SharedVideoFrameBuffer::initialize()") << "Allocating video frame buffer: " << buffer_name;
+
+		const size_t section_size= computeVideoBufferSize(1, stride, height);
+		const size_t slot_size= align_video_frame_size(section_size * section_count);
+		const size_t first_slot_offset= align_video_frame_size(sizeof(SharedVideoFrameHeader));
+		const size_t total_size= first_slot_offset + slot_size * k_video_frame_slot_count;
+
+		m_shared_memory= new SharedMemory();
+		if (m_shared_memory->create(buffer_name, total_size))
+		{
+			// The region starts out zeroed, so every slot sequence starts out even (not being written)
+			m_header= reinterpret_cast<SharedVideoFrameHeader *>(m_shared_memory->getData());
+			m_header->version= PSVR_SHARED_VIDEO_FRAME_VERSION;
+			m_header->width= width;
+			m_header->height= height;
+			m_header->stride= stride;
+			m_header->section_count= section_count;
+			m_header->slot_count= k_video_frame_slot_count;
+			for (int section_index = 0; section_index < PSVR_SHARED_VIDEO_FRAME_MAX_SECTIONS; ++section_index)
+			{
+				m_header->section_offsets[section_index]= section_size * section_index;
+			}
+			m_header->slot_size= slot_size;
+			m_header->first_slot_offset= first_slot_offset;
+			m_header->published_frame_count.store(0, std::memory_order_relaxed);
+
+			// Readers don't touch the rest of the header until they see the magic number
+			m_header->magic.store(PSVR_SHARED_VIDEO_FRAME_MAGIC, std::memory_order_release);
+
+			m_buffer_name = buffer_name;
+			m_write_frame_index= 0;
+			m_bIsWritingFrame= false;
+
+			bSuccess = true;
+		}
+		else
+		{
+			dispose();
+		}
+	}
+
+	return bSuccess;
+}
+
+bool SharedVideoFrameBuffer::open(const char *buffer_name)
+{
+	bool bSuccess = false;
+
+	if (m_shared_memory == nullptr)
+	{
+		m_shared_memory= new SharedMemory();
+
+		if (m_shared_memory->open(buffer_name, true) &&
+			m_shared_memory->getSize() >= sizeof(SharedVideoFrameHeader))
+		{
+			SharedVideoFrameHeader *header= reinterpret_cast<SharedVideoFrameHeader *>(m_shared_memory->getData());
+
+			if (header->magic.load(std::memory_order_acquire) == PSVR_SHARED_VIDEO_FRAME_MAGIC &&
+				header->version == PSVR_SHARED_VIDEO_FRAME_VERSION &&
+				header->section_count > 0 && header->section_count <= PSVR_SHARED_VIDEO_FRAME_MAX_SECTIONS &&
+				header->slot_count > 0 && header->slot_count <= PSVR_SHARED_VIDEO_FRAME_MAX_SLOTS &&
+				header->first_slot_offset + header->slot_size * header->slot_count <= m_shared_memory->getSize())
+			{
+				m_header= header;
+				m_buffer_name= buffer_name;
+				bSuccess= true;
+			}
+			else
+			{
+				PSVR_LOG_WARNING("SharedVideoFrameBuffer::open()") << "Video frame buffer " << buffer_name << " isn't a compatible frame ring";
+			}
+		}
+
+		if (!bSuccess)
+		{
+			dispose();
+		}
 	}
 
 	return bSuccess;
@@ -51,51 +123,183 @@ bool SharedVideoFrameBuffer::initialize(const char *buffer_name, int width, int
 
 void SharedVideoFrameBuffer::dispose()
 {
-	if (m_buffer[0] != nullptr && m_buffer[1] != nullptr)
+	if (m_shared_memory != nullptr)
 	{
-		PSVR_LOG_INFO("SharedVideoFrameBuffer::dispose()") << "Deallocating video frame buffer: " << m_buffer_name;
-		
-		delete[] m_buffer[0];
-		delete[] m_buffer[1];
-		m_buffer[0] = nullptr;
-		m_buffer[1] = nullptr;
-		
+		if (m_shared_memory->getIsOwner())
+		{
+			PSVR_LOG_INFO("SharedVideoFrameBuffer::dispose()") << "Deallocating video frame buffer: " << m_buffer_name;
+		}
+
+		// Readers in other processes keep their mapping of the region until they close it too
+		delete m_shared_memory;
+		m_shared_memory= nullptr;
+		m_header= nullptr;
+
 		m_buffer_name= "";
-		m_width= -1;
-		m_height= -1;
-		m_stride= -1;
-        m_section_count= 0;
-		m_frame_index= -1;
+		m_write_frame_index= 0;
+		m_bIsWritingFrame= false;
 	}
 }
 
 void SharedVideoFrameBuffer::writeVideoFrame(PSVRVideoFrameSection section, const unsigned char *buffer)
 {
-	const size_t buffer_size = computeVideoBufferSize(1, m_stride, m_height);
-    const size_t buffer_offset = computeVideoBufferSize(section, m_stride, m_height);
-	const int write_buffer_index= m_frame_index % 2;
+	if (m_header == nullptr || !m_shared_memory->getIsOwner() || section >= m_header->section_count)
+		return;
+
+	const int slot_index= static_cast<int>(m_write_frame_index % m_header->slot_count);
+	SharedVideoFrameSlotHeader &slot= m_header->slots[slot_index];
+
+	if (!m_bIsWritingFrame)
+	{
+		// Make the sequence odd before touching the slot so readers know it's being rewritten
+		slot.sequence.store(slot.sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		m_bIsWritingFrame= true;
+	}
+
+	const size_t buffer_size = computeVideoBufferSize(1, m_header->stride, m_header->height);
+	std::memcpy(const_cast<unsigned char *>(getSlotSection(slot_index, section)), buffer, buffer_size);
+}
+
+void SharedVideoFrameBuffer::finalizeVideoFrameWrite(const std::chrono::nanoseconds &capture_time)
+{
+	if (m_header == nullptr || !m_bIsWritingFrame)
+		return;
+
+	const int slot_index= static_cast<int>(m_write_frame_index % m_header->slot_count);
+	SharedVideoFrameSlotHeader &slot= m_header->slots[slot_index];
 
-	std::memcpy(m_buffer[write_buffer_index]+buffer_offset, buffer, buffer_size);
+	slot.frame_index.store(m_write_frame_index, std::memory_order_relaxed);
+	slot.capture_time_ns.store(capture_time.count(), std::memory_order_relaxed);
+
+	// Even again: the slot holds a complete frame
+	slot.sequence.store(slot.sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+
+	++m_write_frame_index;
+	m_header->published_frame_count.store(m_write_frame_index, std::memory_order_release);
+	m_bIsWritingFrame= false;
 }
 
-void SharedVideoFrameBuffer::finalizeVideoFrameWrite()
+int SharedVideoFrameBuffer::getFrameIndex() const
 {
-	++m_frame_index;
+	return
+		m_header != nullptr
+		? static_cast<int>(m_header->published_frame_count.load(std::memory_order_acquire))
+		: -1;
 }
 
-const unsigned char *SharedVideoFrameBuffer::getBuffer(PSVRVideoFrameSection section) const
+bool SharedVideoFrameBuffer::getLatestVideoFrame(SharedVideoFrameView &out_view) const
+{
+	if (m_header == nullptr)
+		return false;
+
+	const uint64_t published_frame_count= m_header->published_frame_count.load(std::memory_order_acquire);
+	if (published_frame_count == 0)
+		return false;
+
+	const uint64_t frame_index= published_frame_count - 1;
+	const int slot_index= static_cast<int>(frame_index % m_header->slot_count);
+	const SharedVideoFrameSlotHeader &slot= m_header->slots[slot_index];
+
+	const uint64_t sequence= slot.sequence.load(std::memory_order_acquire);
+	if ((sequence & 1) != 0)
+	{
+		// The writer lapped us and is already refilling the slot
+		return false;
+	}
+
+	out_view.section_count= m_header->section_count;
+	out_view.slot_index= slot_index;
+	out_view.sequence= sequence;
+	out_view.frame_index= slot.frame_index.load(std::memory_order_relaxed);
+	out_view.capture_time_ns= slot.capture_time_ns.load(std::memory_order_relaxed);
+	for (int section_index = 0; section_index < PSVR_SHARED_VIDEO_FRAME_MAX_SECTIONS; ++section_index)
+	{
+		out_view.sections[section_index]=
+			(section_index < m_header->section_count) ? getSlotSection(slot_index, section_index) : nullptr;
+	}
+
+	// The slot metadata we just read has to belong to the same frame
+	return isVideoFrameViewValid(out_view);
+}
+
+bool SharedVideoFrameBuffer::isVideoFrameViewValid(const SharedVideoFrameView &view) const
 {
-	const int read_buffer_index= (m_frame_index + 1) % 2;
+	if (m_header == nullptr)
+		return false;
+
+	// Order the caller's reads of the frame before the sequence re-check
+	std::atomic_thread_fence(std::memory_order_acquire);
+
+	return m_header->slots[view.slot_index].sequence.load(std::memory_order_relaxed) == view.sequence;
+}
+
+bool SharedVideoFrameBuffer::copyLatestVideoFrame(
+	unsigned char *out_buffer,
+	size_t buffer_size,
+	SharedVideoFrameView *out_view) const
+{
+	if (m_header == nullptr)
+		return false;
+
+	const size_t section_size= computeVideoBufferSize(1, m_header->stride, m_header->height);
+	if (buffer_size < section_size * m_header->section_count)
+		return false;
+
+	for (int attempt = 0; attempt < k_max_video_frame_copy_attempts; ++attempt)
+	{
+		SharedVideoFrameView view;
+		if (!getLatestVideoFrame(view))
+			continue;
+
+		for (int section_index = 0; section_index < view.section_count; ++section_index)
+		{
+			std::memcpy(out_buffer + section_size * section_index, view.sections[section_index], section_size);
+		}
+
+		if (isVideoFrameViewValid(view))
+		{
+			if (out_view != nullptr)
+			{
+				*out_view= view;
+			}
+
+			return true;
+		}
+	}
 
-	return m_buffer[read_buffer_index] + computeVideoBufferSize(static_cast<int>(section), m_stride, m_height);
+	return false;
 }
 
-unsigned char *SharedVideoFrameBuffer::getBufferMutable(PSVRVideoFrameSection section)
+const unsigned char *SharedVideoFrameBuffer::getBuffer(PSVRVideoFrameSection section) const
 {
-	return const_cast<unsigned char *>(getBuffer(section));
+	SharedVideoFrameView view;
+
+	if (getLatestVideoFrame(view) && section < view.section_count)
+	{
+		return view.sections[section];
+	}
+
+	return nullptr;
 }
 
 size_t SharedVideoFrameBuffer::computeVideoBufferSize(int section_count, int stride, int height)
 {
 	return section_count*stride*height;
-}
\ No newline at end of file
+}
+
+const unsigned char *SharedVideoFrameBuffer::getSlotSection(int slot_index, int section_index) const
+{
+	const unsigned char *base= reinterpret_cast<const unsigned char *>(m_header);
+
+	return
+		base + m_header->first_slot_offset +
+		m_header->slot_size * slot_index +
+		m_header->section_offsets[section_index];
+}
+
+//-- private methods -----
+static size_t align_video_frame_size(size_t size)
+{
+	return (size + k_video_frame_alignment - 1) & ~(k_video_frame_alignment - 1);
+}
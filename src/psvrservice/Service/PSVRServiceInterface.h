@@ -4,6 +4,9 @@
 //-- includes -----
 #include "PSVRClient_CAPI.h"
 #include <atomic>
+#include <chrono>
+#include <string>
+#include <stdint.h>
 
 //-- definitions -----
 enum DeviceCategory
@@ -32,6 +35,8 @@ struct HMDDataPacket
     bool            is_valid;
     int             output_sequence_num;
     bool            is_connected;
+    float           imu_sensor_age_ms; // -1 if no IMU measurement has been fused yet
+    float           optical_sensor_age_ms; // -1 if no optical measurement has been fused yet
 };	
 	
 struct DeviceOutputDataFrame
@@ -43,30 +48,97 @@ struct DeviceOutputDataFrame
 	DeviceCategory device_category;
 };
 
+// Layout of a tracker's video frame shared memory region (see SharedVideoFrameBuffer).
+// The header is followed by slot_count frame slots of slot_size bytes each, starting at first_slot_offset.
+// Each slot holds section_count BGR images of height rows x stride bytes, at the section_offsets within the slot.
+//
+// Each slot is guarded by a sequence counter (a seqlock): it is odd while the service is writing the slot
+// and goes up by two for every frame written to it. A reader notes the sequence before reading a slot and
+// checks it is unchanged afterwards to know the frame wasn't torn. With several slots the writer only comes
+// back round to a slot every slot_count frames, so a reader has that long to use a frame in place.
+#define PSVR_SHARED_VIDEO_FRAME_MAGIC 0x50535646 // "PSVF"
+#define PSVR_SHARED_VIDEO_FRAME_VERSION 1
+#define PSVR_SHARED_VIDEO_FRAME_MAX_SLOTS 8
+#define PSVR_SHARED_VIDEO_FRAME_MAX_SECTIONS 2
+
+struct SharedVideoFrameSlotHeader
+{
+	std::atomic<uint64_t> sequence;
+	std::atomic<uint64_t> frame_index;	// Number of frames written before this one
+	std::atomic<int64_t> capture_time_ns; // Service clock time the camera delivered the frame
+};
+
+struct SharedVideoFrameHeader
+{
+	std::atomic<uint32_t> magic; // Set to PSVR_SHARED_VIDEO_FRAME_MAGIC once the rest of the header is filled in
+	uint32_t version;
+	int32_t width;
+	int32_t height;
+	int32_t stride;
+	int32_t section_count;
+	int32_t slot_count;
+	uint64_t section_offsets[PSVR_SHARED_VIDEO_FRAME_MAX_SECTIONS];
+	uint64_t slot_size;
+	uint64_t first_slot_offset;
+	std::atomic<uint64_t> published_frame_count;
+	SharedVideoFrameSlotHeader slots[PSVR_SHARED_VIDEO_FRAME_MAX_SLOTS];
+};
+
+// A frame in place in one of the shared memory slots
+struct SharedVideoFrameView
+{
+	const unsigned char *sections[PSVR_SHARED_VIDEO_FRAME_MAX_SECTIONS];
+	int section_count;
+	int slot_index;
+	uint64_t sequence;
+	uint64_t frame_index;
+	int64_t capture_time_ns;
+};
+
+// A tracker's video frames in a named shared memory ring (keyed by ServerTrackerView::getSharedMemoryStreamName()).
+// The service creates it with initialize() and is the only writer.
+// Readers in the service process or any other process (open()) read frames in place without locks or copies.
 class SharedVideoFrameBuffer
 {
 public:
     SharedVideoFrameBuffer();
     ~SharedVideoFrameBuffer();
 
+	// Writer side
     bool initialize(const char *buffer_name, int width, int height, int stride, int section_count);
-    void dispose();
     void writeVideoFrame(PSVRVideoFrameSection section, const unsigned char *buffer);
-	void finalizeVideoFrameWrite();
-    inline int getSectionCount() const { return m_section_count; }
-	inline int getFrameIndex() const { return m_frame_index; } 
+	void finalizeVideoFrameWrite(const std::chrono::nanoseconds &capture_time);
+
+	// Reader side: maps a buffer made by initialize(), possibly in another process
+	bool open(const char *buffer_name);
+
+    void dispose();
+
+    inline int getWidth() const { return m_header != nullptr ? m_header->width : 0; }
+    inline int getHeight() const { return m_header != nullptr ? m_header->height : 0; }
+    inline int getStride() const { return m_header != nullptr ? m_header->stride : 0; }
+    inline int getSectionCount() const { return m_header != nullptr ? m_header->section_count : 0; }
+	int getFrameIndex() const;
+
+	// Finds the newest complete frame. Its contents stay good until isVideoFrameViewValid() says otherwise.
+	bool getLatestVideoFrame(SharedVideoFrameView &out_view) const;
+	// True if the writer hasn't started reusing the view's slot (check after reading the frame)
+	bool isVideoFrameViewValid(const SharedVideoFrameView &view) const;
+	// Copies the newest frame's sections back to back into the given buffer, retrying if the copy got torn
+	bool copyLatestVideoFrame(unsigned char *out_buffer, size_t buffer_size, SharedVideoFrameView *out_view= nullptr) const;
+
+	// The newest complete frame's section
     const unsigned char *getBuffer(PSVRVideoFrameSection section) const;
-    unsigned char *getBufferMutable(PSVRVideoFrameSection section);
     static size_t computeVideoBufferSize(int section_count, int stride, int height);
 
 private:
     std::string m_buffer_name;
-	int m_width;
-    int m_height;
-    int m_stride;
-    int m_section_count;
-	unsigned char *m_buffer[2];
-	std::atomic_int m_frame_index;
+	class SharedMemory *m_shared_memory;
+	SharedVideoFrameHeader *m_header;
+	uint64_t m_write_frame_index;
+	bool m_bIsWritingFrame;
+
+	const unsigned char *getSlotSection(int slot_index, int section_index) const;
 };
 
 //-- interface -----
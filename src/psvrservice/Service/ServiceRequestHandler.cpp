@@ -14,6 +14,8 @@
 #include "ServerTrackerView.h"
 #include "ServerHMDView.h"
 #include "ServiceVersion.h"
+#include "SessionRecorder.h"
+#include "TimelineTrace.h"
 #include "TrackerManager.h"
 #include "TrackerCapabilitiesConfig.h"
 #include "Utility.h"
@@ -178,6 +180,12 @@ PSVRResult ServiceRequestHandler::get_tracker_list(PSVRTrackerList *out_tracker_
             case ITrackerInterface::WindowsMediaFramework:
                 tracker_info->tracker_driver= PSVRDriver_WINDOWSMEDIAFRAMEWORK;
                 break;
+            case ITrackerInterface::Replay:
+                tracker_info->tracker_driver= PSVRDriver_REPLAY;
+                break;
+            case ITrackerInterface::Synthetic:
+                tracker_info->tracker_driver= PSVRDriver_SYNTHETIC;
+                break;
             default:
                 assert(0 && "Unhandled tracker type");
             }
@@ -302,6 +310,28 @@ PSVRResult ServiceRequestHandler::get_shared_video_frame_buffer(PSVRTrackerID tr
 	return result;		
 }
 
+PSVRResult ServiceRequestHandler::get_tracker_video_stream_name(PSVRTrackerID tracker_id, char *out_stream_name, size_t max_stream_name_length)
+{
+	PSVRResult result= PSVRResult_Error;
+
+	if (Utility::is_index_valid(tracker_id, m_deviceManager->getTrackerViewMaxCount()))
+    {
+        ServerTrackerViewPtr tracker_view = m_deviceManager->getTrackerViewPtr(tracker_id);
+        if (tracker_view->getIsOpen() && tracker_view->getSharedVideoFrameBuffer() != nullptr)
+        {
+			const std::string stream_name= tracker_view->getSharedMemoryStreamName();
+
+			if (stream_name.length() < max_stream_name_length)
+			{
+				strncpy(out_stream_name, stream_name.c_str(), max_stream_name_length);
+				result= PSVRResult_Success;
+			}
+        }
+    }
+		
+	return result;		
+}
+
 PSVRResult ServiceRequestHandler::get_tracker_settings(PSVRTrackerID tracker_id, PSVRHmdID hmd_id, PSVRClientTrackerSettings *out_settings)
 {
 	PSVRResult result= PSVRResult_Error;
@@ -391,7 +421,8 @@ PSVRResult ServiceRequestHandler::set_tracker_video_property(
                 m_peristentRequestState->active_tracker_stream_info[tracker_id].has_temp_settings_override = true;
             }
 
-            // Return back the actual property value that got set
+            // Return back the property value that got set.
+            // Trackers may apply it asynchronously (see PSVREvent_trackerVideoPropertyApplied).
             *out_value= tracker_view->getVideoProperty(property_type);
 
             result= PSVRResult_Success;
@@ -514,6 +545,25 @@ PSVRResult ServiceRequestHandler::set_tracker_debug_flags(PSMTrackerDebugFlags f
 	return PSVRResult_Success;
 }
 
+PSVRResult ServiceRequestHandler::get_tracker_statistics(
+	const PSVRTrackerID tracker_id,
+	PSVRTrackerStatistics *out_statistics)
+{
+	PSVRResult result= PSVRResult_Error;
+
+	if (Utility::is_index_valid(tracker_id, m_deviceManager->getTrackerViewMaxCount()))
+    {
+        ServerTrackerViewPtr tracker_view = m_deviceManager->getTrackerViewPtr(tracker_id);
+        if (tracker_view->getIsOpen())
+        {
+			tracker_view->getStatistics(*out_statistics);
+            result= PSVRResult_Success;
+        }
+    }
+
+	return result;
+}
+
 // -- hmd requests -----
 ServerHMDView *ServiceRequestHandler::get_hmd_view_or_null(PSVRHmdID hmd_id)
 {
@@ -598,6 +648,28 @@ PSVRResult ServiceRequestHandler::get_hmd_tracking_shape(PSVRHmdID hmd_id, PSVRT
 	return result;
 }
 
+PSVRResult ServiceRequestHandler::get_hmd_filtered_pose(
+	const PSVRHmdID hmd_id, 
+	PSVRPosef *out_pose,
+	bool *out_is_valid)
+{
+	PSVRResult result= PSVRResult_Error;
+	ServerHMDView *hmd_view = get_hmd_view_or_null(hmd_id);
+
+	// Only HMDs with a filter thread have filter output fresher than the last published data frame
+	if (hmd_view != nullptr && hmd_view->getHasFilterThread())
+	{
+		HMDFilteredState filtered_state;
+		hmd_view->fetchClientFilteredState(filtered_state);
+
+		*out_pose= filtered_state.pose_cm;
+		*out_is_valid= filtered_state.bIsValid;
+		result= PSVRResult_Success;
+	}
+
+	return result;
+}
+
 PSVRResult ServiceRequestHandler::start_hmd_data_stream(
     const PSVRHmdID hmd_id,
     unsigned int data_stream_flags)
@@ -742,7 +814,6 @@ PSVRResult ServiceRequestHandler::set_hmd_accelerometer_calibration(
     if (HMDView && HMDView->getHMDDeviceType() == CommonSensorState::Morpheus)
     {
         MorpheusHMD *hmd = HMDView->castChecked<MorpheusHMD>();
-        IPoseFilter *poseFilter = HMDView->getPoseFilterMutable();
         MorpheusHMDConfig *config = hmd->getConfigMutable();
 
         // Compute the bias as 1g subtracted from the measured direction of gravity
@@ -758,7 +829,7 @@ PSVRResult ServiceRequestHandler::set_hmd_accelerometer_calibration(
         config->save();
 
         // Reset the orientation filter state the calibration changed
-        poseFilter->resetState();
+        HMDView->resetPoseFilterState();
 
         result= PSVRResult_Success;
     }
@@ -787,7 +858,7 @@ PSVRResult ServiceRequestHandler::set_hmd_gyroscope_calibration(
         config->save();
 
         // Reset the orientation filter state the calibration changed
-        HMDView->getPoseFilterMutable()->resetState();
+        HMDView->resetPoseFilterState();
 
         result= PSVRResult_Success;
     }
@@ -948,6 +1019,85 @@ PSVRResult ServiceRequestHandler::set_hmd_data_stream_tracker_index(
 	return result;
 }
 
+PSVRResult ServiceRequestHandler::get_hmd_statistics(
+	const PSVRHmdID hmd_id,
+	PSVRHmdStatistics *out_statistics)
+{
+	PSVRResult result= PSVRResult_Error;
+	ServerHMDView *hmd_view = get_hmd_view_or_null(hmd_id);
+
+	if (hmd_view != nullptr)
+	{
+		hmd_view->getStatistics(*out_statistics);
+		result= PSVRResult_Success;
+	}
+
+	return result;
+}
+
+PSVRResult ServiceRequestHandler::get_hmd_motion_to_pose_latency(
+	const PSVRHmdID hmd_id,
+	PSVRHmdMotionToPoseLatency *out_latency)
+{
+	PSVRResult result= PSVRResult_Error;
+	ServerHMDView *hmd_view = get_hmd_view_or_null(hmd_id);
+
+	if (hmd_view != nullptr)
+	{
+		hmd_view->getMotionToPoseLatency(*out_latency);
+		result= PSVRResult_Success;
+	}
+
+	return result;
+}
+
+// -- session requests -----
+PSVRResult ServiceRequestHandler::start_session_recording(const std::string &path)
+{
+    SessionRecorder *recorder= m_deviceManager->getSessionRecorder();
+
+    return recorder->startRecording(path) ? PSVRResult_Success : PSVRResult_Error;
+}
+
+PSVRResult ServiceRequestHandler::stop_session_recording()
+{
+    SessionRecorder *recorder= m_deviceManager->getSessionRecorder();
+
+    // Fails if nothing was recording or the recording stopped early on a write failure
+    return recorder->stopRecording() ? PSVRResult_Success : PSVRResult_Error;
+}
+
+// -- timeline trace requests -----
+PSVRResult ServiceRequestHandler::start_timeline_trace()
+{
+    PSVRResult result= PSVRResult_Error;
+
+    if (TimelineTrace::isEnabled())
+    {
+        TimelineTrace::startRecording();
+        result= PSVRResult_Success;
+    }
+
+    return result;
+}
+
+PSVRResult ServiceRequestHandler::stop_timeline_trace(const std::string &path)
+{
+    PSVRResult result= PSVRResult_Error;
+
+    if (TimelineTrace::getIsRecording())
+    {
+        TimelineTrace::stopRecording();
+
+        if (TimelineTrace::writeChromeTrace(path))
+        {
+            result= PSVRResult_Success;
+        }
+    }
+
+    return result;
+}
+
 PSVRResult ServiceRequestHandler::get_service_version(
     char *out_version_string, 
 	size_t max_version_string)
@@ -139,6 +139,7 @@ public:
     PSVRResult start_tracker_data_stream(PSVRTrackerID tracker_id);
     PSVRResult stop_tracker_data_stream(PSVRTrackerID tracker_id);
 	PSVRResult get_shared_video_frame_buffer(PSVRTrackerID tracker_id, const SharedVideoFrameBuffer **out_shared_buffer);
+	PSVRResult get_tracker_video_stream_name(PSVRTrackerID tracker_id, char *out_stream_name, size_t max_stream_name_length);
     PSVRResult get_tracker_settings(
 		PSVRTrackerID tracker_id, PSVRHmdID hmd_id, 
 		PSVRClientTrackerSettings *out_settings);
@@ -157,11 +158,13 @@ public:
     PSVRResult reload_tracker_settings(const PSVRTrackerID tracker_id);
 	PSVRResult get_tracker_debug_flags(PSMTrackerDebugFlags *out_flags) const;
 	PSVRResult set_tracker_debug_flags(PSMTrackerDebugFlags flags);
+	PSVRResult get_tracker_statistics(const PSVRTrackerID tracker_id, PSVRTrackerStatistics *out_statistics);
 	
     // -- hmd requests -----
     ServerHMDView *get_hmd_view_or_null(PSVRHmdID hmd_id);
     PSVRResult get_hmd_list(PSVRHmdList *out_hmd_list);
 	PSVRResult get_hmd_tracking_shape(PSVRHmdID hmd_id, PSVRTrackingShape *out_shape);
+	PSVRResult get_hmd_filtered_pose(const PSVRHmdID hmd_id, PSVRPosef *out_pose, bool *out_is_valid);
     PSVRResult start_hmd_data_stream(const PSVRHmdID hmd_id, unsigned int data_stream_flags);
     PSVRResult stop_hmd_data_stream(const PSVRHmdID hmd_id);
     PSVRResult set_hmd_led_tracking_color(const PSVRHmdID hmd_id, const PSVRTrackingColorType new_color_id);
@@ -173,6 +176,16 @@ public:
     PSVRResult set_hmd_position_filter(const PSVRHmdID hmd_id, const std::string position_filter);
     PSVRResult set_hmd_prediction_time(const PSVRHmdID hmd_id, const float hmd_prediction_time);
     PSVRResult set_hmd_data_stream_tracker_index(const PSVRTrackerID tracker_id, const PSVRHmdID hmd_id);
+	PSVRResult get_hmd_statistics(const PSVRHmdID hmd_id, PSVRHmdStatistics *out_statistics);
+	PSVRResult get_hmd_motion_to_pose_latency(const PSVRHmdID hmd_id, PSVRHmdMotionToPoseLatency *out_latency);
+
+    // -- session requests -----
+    PSVRResult start_session_recording(const std::string &path);
+    PSVRResult stop_session_recording();
+
+    // -- timeline trace requests -----
+    PSVRResult start_timeline_trace();
+    PSVRResult stop_timeline_trace(const std::string &path);
 	
 	// -- general requests -----
     PSVRResult get_service_version(char *out_version_string, size_t max_version_string);		
@@ -0,0 +1,549 @@
+//-- includes -----
+#include "SyntheticScene.h"
+#include "DeviceManager.h"
+#include "Logger.h"
+#include "MathGLM.h"
+#include "ServerHMDView.h"
+#include "Utility.h"
+
+#include <glm/gtc/quaternion.hpp>
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+//-- constants -----
+// Brightness of the (unlit) background
+static const unsigned char k_background_intensity= 12;
+
+// Most blobs a single frame can have in it
+static const int k_max_scene_blobs= PSVRSERVICE_MAX_HMD_COUNT*MAX_POINT_CLOUD_POINT_COUNT;
+
+//-- private definitions -----
+struct SceneBlob
+{
+	float x, y; // pixels
+	float radius; // pixels
+	float depth; // cm
+	float bgr[3];
+};
+
+//-- prototypes -----
+static PSVRPosef glm_pose_to_PSVR_posef(const glm::quat &orientation, const glm::vec3 &position);
+static glm::mat4 PSVR_posef_to_glm_transform(const PSVRPosef &pose);
+static void hsv_to_bgr(const PSVR_HSVColorRange &hsv_range, float out_bgr[3]);
+static bool project_point(
+	const PSVRMonoTrackerIntrinsics &intrinsics, const glm::vec3 &tracker_relative_point, float &out_x, float &out_y);
+static void draw_blob(
+	const SceneBlob &blob, const int width, const int height, const bool bIsBayer, unsigned char *buffer);
+
+//-- Synthetic Scene Config -----
+const int SyntheticSceneConfig::CONFIG_VERSION = 1;
+
+SyntheticSceneConfig::SyntheticSceneConfig(const std::string &fnamebase)
+    : PSVRConfig(fnamebase)
+	, version(CONFIG_VERSION)
+	, tracker_count(0)
+	, frame_rate(60.f)
+	, frame_width(640)
+	, frame_height(480)
+	, is_bayer(true)
+	, hfov(75.f)
+	, tracker_ring_radius(200.f)
+	, tracker_height(30.f)
+	, hmd_spacing(40.f)
+	, path_amplitude(20.f)
+	, path_period(8.f)
+	, path_yaw_amplitude(30.f)
+	, path_pitch_amplitude(10.f)
+	, led_radius(0.4f)
+	, error_log_interval(5.f)
+{
+	memset(&distortion_coefficients, 0, sizeof(distortion_coefficients));
+}
+
+const configuru::Config
+SyntheticSceneConfig::writeToJSON()
+{
+    configuru::Config pt{
+        {"version", SyntheticSceneConfig::CONFIG_VERSION},
+        {"tracker_count", tracker_count},
+        {"frame_rate", frame_rate},
+        {"frame_width", frame_width},
+        {"frame_height", frame_height},
+        {"is_bayer", is_bayer},
+        {"hfov", hfov},
+        {"distortion.k1", distortion_coefficients.k1},
+        {"distortion.k2", distortion_coefficients.k2},
+        {"distortion.k3", distortion_coefficients.k3},
+        {"distortion.p1", distortion_coefficients.p1},
+        {"distortion.p2", distortion_coefficients.p2},
+        {"tracker_ring_radius", tracker_ring_radius},
+        {"tracker_height", tracker_height},
+        {"hmd_spacing", hmd_spacing},
+        {"path_amplitude", path_amplitude},
+        {"path_period", path_period},
+        {"path_yaw_amplitude", path_yaw_amplitude},
+        {"path_pitch_amplitude", path_pitch_amplitude},
+        {"led_radius", led_radius},
+        {"error_log_interval", error_log_interval}
+    };
+
+    return pt;
+}
+
+void
+SyntheticSceneConfig::readFromJSON(const configuru::Config &pt)
+{
+    version = pt.get_or<int>("version", 0);
+
+    if (version == SyntheticSceneConfig::CONFIG_VERSION)
+    {
+        tracker_count = std::min(std::max(pt.get_or<int>("tracker_count", tracker_count), 0), PSVRSERVICE_MAX_TRACKER_COUNT);
+        frame_rate = std::max(pt.get_or<float>("frame_rate", frame_rate), 1.f);
+        frame_width = std::max(pt.get_or<int>("frame_width", frame_width), 2);
+        frame_height = std::max(pt.get_or<int>("frame_height", frame_height), 2);
+        is_bayer = pt.get_or<bool>("is_bayer", is_bayer);
+        hfov = pt.get_or<float>("hfov", hfov);
+        distortion_coefficients.k1 = pt.get_or<double>("distortion.k1", distortion_coefficients.k1);
+        distortion_coefficients.k2 = pt.get_or<double>("distortion.k2", distortion_coefficients.k2);
+        distortion_coefficients.k3 = pt.get_or<double>("distortion.k3", distortion_coefficients.k3);
+        distortion_coefficients.p1 = pt.get_or<double>("distortion.p1", distortion_coefficients.p1);
+        distortion_coefficients.p2 = pt.get_or<double>("distortion.p2", distortion_coefficients.p2);
+        tracker_ring_radius = pt.get_or<float>("tracker_ring_radius", tracker_ring_radius);
+        tracker_height = pt.get_or<float>("tracker_height", tracker_height);
+        hmd_spacing = pt.get_or<float>("hmd_spacing", hmd_spacing);
+        path_amplitude = pt.get_or<float>("path_amplitude", path_amplitude);
+        path_period = std::max(pt.get_or<float>("path_period", path_period), 0.1f);
+        path_yaw_amplitude = pt.get_or<float>("path_yaw_amplitude", path_yaw_amplitude);
+        path_pitch_amplitude = pt.get_or<float>("path_pitch_amplitude", path_pitch_amplitude);
+        led_radius = pt.get_or<float>("led_radius", led_radius);
+        error_log_interval = pt.get_or<float>("error_log_interval", error_log_interval);
+    }
+    else
+    {
+        PSVR_LOG_WARNING("SyntheticSceneConfig") <<
+            "Config version " << version << " does not match expected version " <<
+            SyntheticSceneConfig::CONFIG_VERSION << ", Using defaults.";
+    }
+}
+
+//-- Synthetic Scene -----
+SyntheticScene::SyntheticScene()
+	: m_cfg()
+	, m_startTime()
+	, m_lastErrorLogTime()
+{
+	memset(m_hmds, 0, sizeof(m_hmds));
+
+	for (int hmd_id = 0; hmd_id < PSVRSERVICE_MAX_HMD_COUNT; ++hmd_id)
+	{
+		m_errorStats[hmd_id].clear();
+	}
+}
+
+void SyntheticScene::startup()
+{
+	m_cfg.load();
+	m_cfg.save();
+
+	// The scripted paths start over every time the service starts
+	m_startTime= ServiceClock::now();
+	m_lastErrorLogTime= m_startTime;
+
+	if (m_cfg.tracker_count > 0)
+	{
+		PSVR_LOG_INFO("SyntheticScene::startup") << "Rendering " << m_cfg.tracker_count << " synthetic trackers at "
+			<< m_cfg.frame_width << "x" << m_cfg.frame_height << "@" << m_cfg.frame_rate << "fps ("
+			<< (m_cfg.is_bayer ? "bayer" : "BGR") << ")";
+	}
+}
+
+void SyntheticScene::update()
+{
+	if (m_cfg.tracker_count > 0)
+	{
+		publish_hmds();
+		sample_tracking_error();
+	}
+}
+
+void SyntheticScene::shutdown()
+{
+	if (m_cfg.tracker_count > 0)
+	{
+		log_tracking_error();
+	}
+}
+
+int SyntheticScene::getTrackerCount() const
+{
+	return m_cfg.tracker_count;
+}
+
+PSVRPosef SyntheticScene::computeTrackerPose(const int tracker_index) const
+{
+	const float ring_angle= k_real_two_pi*static_cast<float>(tracker_index)/static_cast<float>(std::max(m_cfg.tracker_count, 1));
+	const glm::vec3 position(
+		m_cfg.tracker_ring_radius*cosf(ring_angle),
+		m_cfg.tracker_height,
+		m_cfg.tracker_ring_radius*sinf(ring_angle));
+
+	// Tracker relative space is the OpenCV camera space: +Z looks at the origin and +Y is down
+	glm::vec3 forward= -position;
+	glm_vec3_normalize_with_default(forward, glm::vec3(0.f, 0.f, 1.f));
+	glm::vec3 right= glm::cross(glm::vec3(0.f, -1.f, 0.f), forward);
+	glm_vec3_normalize_with_default(right, glm::vec3(1.f, 0.f, 0.f));
+	const glm::vec3 down= glm::cross(forward, right);
+
+	return glm_pose_to_PSVR_posef(glm::quat_cast(glm::mat3(right, down, forward)), position);
+}
+
+PSVRMonoTrackerIntrinsics SyntheticScene::computeTrackerIntrinsics() const
+{
+	const float width= static_cast<float>(m_cfg.frame_width);
+	const float height= static_cast<float>(m_cfg.frame_height);
+	const float focal_length= 0.5f*width/tanf(0.5f*m_cfg.hfov*k_degrees_to_radians);
+
+	PSVRMonoTrackerIntrinsics intrinsics;
+	memset(&intrinsics, 0, sizeof(intrinsics));
+	intrinsics.pixel_width= width;
+	intrinsics.pixel_height= height;
+	intrinsics.hfov= m_cfg.hfov;
+	intrinsics.vfov= 2.f*atanf(0.5f*height/focal_length)*k_radians_to_degreees;
+	intrinsics.znear= 10.f;
+	intrinsics.zfar= 2.f*m_cfg.tracker_ring_radius + 200.f;
+	intrinsics.distortion_coefficients= m_cfg.distortion_coefficients;
+
+	double *m= (double *)intrinsics.camera_matrix.m;
+	m[0]= focal_length; m[1]= 0.0; m[2]= 0.5*width;
+	m[3]= 0.0; m[4]= focal_length; m[5]= 0.5*height;
+	m[6]= 0.0; m[7]= 0.0; m[8]= 1.0;
+
+	return intrinsics;
+}
+
+PSVRPosef SyntheticScene::computeHMDPose(const int hmd_id, const t_service_timepoint &time) const
+{
+	const float t= std::chrono::duration<float>(time - m_startTime).count();
+	const float w= k_real_two_pi/m_cfg.path_period;
+	const float phase= static_cast<float>(hmd_id)*k_real_half_pi;
+
+	// The path centers are laid out on a grid, two to a row
+	const float column= static_cast<float>(hmd_id % 2) - 0.5f;
+	const float row= static_cast<float>(hmd_id / 2) - 0.5f;
+	const glm::vec3 center(column*m_cfg.hmd_spacing, 0.f, row*m_cfg.hmd_spacing);
+
+	const float a= m_cfg.path_amplitude;
+	const glm::vec3 position= center + glm::vec3(
+		a*sinf(w*t + phase),
+		0.5f*a*sinf(2.f*w*t + phase),
+		0.5f*a*cosf(w*t + phase));
+
+	const float yaw= m_cfg.path_yaw_amplitude*k_degrees_to_radians*sinf(0.5f*w*t + phase);
+	const float pitch= m_cfg.path_pitch_amplitude*k_degrees_to_radians*sinf(1.5f*w*t + phase);
+	const glm::quat orientation= glm::quat(glm::vec3(pitch, yaw, 0.f));
+
+	return glm_pose_to_PSVR_posef(orientation, position);
+}
+
+void SyntheticScene::renderFrame(
+	const PSVRPosef &tracker_pose,
+	const PSVRMonoTrackerIntrinsics &intrinsics,
+	const t_service_timepoint &time,
+	unsigned char *out_buffer) const
+{
+	SceneHMD hmds[PSVRSERVICE_MAX_HMD_COUNT];
+	{
+		std::lock_guard<std::mutex> lock(m_hmdMutex);
+		memcpy(hmds, m_hmds, sizeof(hmds));
+	}
+
+	const glm::mat4 world_to_tracker= glm::inverse(PSVR_posef_to_glm_transform(tracker_pose));
+	const float focal_length= static_cast<float>(intrinsics.camera_matrix.m[0][0]);
+
+	// Project every LED into the frame
+	SceneBlob blobs[k_max_scene_blobs];
+	int blob_count= 0;
+
+	for (int hmd_id = 0; hmd_id < PSVRSERVICE_MAX_HMD_COUNT; ++hmd_id)
+	{
+		const SceneHMD &hmd= hmds[hmd_id];
+
+		if (!hmd.bIsVisible)
+			continue;
+
+		const glm::mat4 hmd_to_tracker= world_to_tracker*PSVR_posef_to_glm_transform(computeHMDPose(hmd_id, time));
+		const PSVRVector3f *led_positions= nullptr;
+		int led_count= 0;
+		float led_radius= 0.f;
+
+		switch (hmd.shape.shape_type)
+		{
+		case PSVRTrackingShape_Sphere:
+			led_positions= &hmd.shape.shape.sphere.center;
+			led_count= 1;
+			led_radius= hmd.shape.shape.sphere.radius;
+			break;
+		case PSVRTrackingShape_PointCloud:
+			led_positions= hmd.shape.shape.pointcloud.points;
+			led_count= hmd.shape.shape.pointcloud.point_count;
+			led_radius= m_cfg.led_radius;
+			break;
+		default:
+			// Light bars aren't rendered
+			break;
+		}
+
+		float bgr[3];
+		hsv_to_bgr(k_default_color_presets[hmd.color], bgr);
+
+		for (int led_index = 0; led_index < led_count && blob_count < k_max_scene_blobs; ++led_index)
+		{
+			const PSVRVector3f &p= led_positions[led_index];
+			const glm::vec3 tracker_relative_point(hmd_to_tracker*glm::vec4(p.x, p.y, p.z, 1.f));
+			SceneBlob &blob= blobs[blob_count];
+
+			if (tracker_relative_point.z < intrinsics.znear ||
+				!project_point(intrinsics, tracker_relative_point, blob.x, blob.y))
+				continue;
+
+			blob.radius= std::max(focal_length*led_radius/tracker_relative_point.z, 0.75f);
+			blob.depth= tracker_relative_point.z;
+			blob.bgr[0]= bgr[0];
+			blob.bgr[1]= bgr[1];
+			blob.bgr[2]= bgr[2];
+			++blob_count;
+		}
+	}
+
+	// Draw back to front so the nearer LEDs cover the farther ones.
+	// Nothing else occludes: LEDs facing away from the tracker still show up.
+	std::sort(blobs, blobs + blob_count, [](const SceneBlob &a, const SceneBlob &b) {
+		return a.depth > b.depth;
+	});
+
+	const int width= m_cfg.frame_width;
+	const int height= m_cfg.frame_height;
+	const size_t buffer_size= static_cast<size_t>(width*height)*(m_cfg.is_bayer ? 1 : 3);
+
+	memset(out_buffer, k_background_intensity, buffer_size);
+	for (int blob_index = 0; blob_index < blob_count; ++blob_index)
+	{
+		draw_blob(blobs[blob_index], width, height, m_cfg.is_bayer, out_buffer);
+	}
+}
+
+void SyntheticScene::publish_hmds()
+{
+	DeviceManager *device_manager= DeviceManager::getInstance();
+	SceneHMD hmds[PSVRSERVICE_MAX_HMD_COUNT];
+
+	memset(hmds, 0, sizeof(hmds));
+	for (int hmd_id = 0; hmd_id < PSVRSERVICE_MAX_HMD_COUNT; ++hmd_id)
+	{
+		ServerHMDViewPtr hmd_view= device_manager->getHMDViewPtr(hmd_id);
+		SceneHMD &hmd= hmds[hmd_id];
+
+		if (hmd_view && hmd_view->getIsOpen() && hmd_view->getIsTrackingEnabled())
+		{
+			hmd.bIsVisible= hmd_view->getTrackingShape(hmd.shape);
+			hmd.color= hmd_view->getTrackingColorID();
+			hmd.bIsVisible&= (hmd.color >= 0 && hmd.color < PSVRTrackingColorType_MaxColorTypes);
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(m_hmdMutex);
+	memcpy(m_hmds, hmds, sizeof(m_hmds));
+}
+
+void SyntheticScene::sample_tracking_error()
+{
+	DeviceManager *device_manager= DeviceManager::getInstance();
+	const t_service_timepoint now= ServiceClock::now();
+
+	for (int hmd_id = 0; hmd_id < PSVRSERVICE_MAX_HMD_COUNT; ++hmd_id)
+	{
+		ServerHMDViewPtr hmd_view= device_manager->getHMDViewPtr(hmd_id);
+
+		if (!hmd_view || !hmd_view->getIsOpen() || !hmd_view->getIsFilteredStateValid())
+			continue;
+
+		// Compared against where the HMD is right now,
+		// so the error includes whatever latency the filter doesn't predict away
+		const PSVRPosef filtered_pose= hmd_view->getFilteredPose();
+		const PSVRPosef true_pose= computeHMDPose(hmd_id, now);
+
+		const float position_error= glm::length(
+			glm::vec3(filtered_pose.Position.x, filtered_pose.Position.y, filtered_pose.Position.z) -
+			glm::vec3(true_pose.Position.x, true_pose.Position.y, true_pose.Position.z));
+		const float quat_dot= fabsf(
+			filtered_pose.Orientation.w*true_pose.Orientation.w +
+			filtered_pose.Orientation.x*true_pose.Orientation.x +
+			filtered_pose.Orientation.y*true_pose.Orientation.y +
+			filtered_pose.Orientation.z*true_pose.Orientation.z);
+		const float angle_error= 2.f*acosf(std::min(quat_dot, 1.f))*k_radians_to_degreees;
+
+		TrackingErrorStats &stats= m_errorStats[hmd_id];
+		++stats.sample_count;
+		stats.position_error_sq_sum+= position_error*position_error;
+		stats.max_position_error= std::max(stats.max_position_error, position_error);
+		stats.angle_error_sq_sum+= angle_error*angle_error;
+		stats.max_angle_error= std::max(stats.max_angle_error, angle_error);
+	}
+
+	if (std::chrono::duration<float>(now - m_lastErrorLogTime).count() >= m_cfg.error_log_interval)
+	{
+		log_tracking_error();
+		m_lastErrorLogTime= now;
+	}
+}
+
+void SyntheticScene::log_tracking_error()
+{
+	for (int hmd_id = 0; hmd_id < PSVRSERVICE_MAX_HMD_COUNT; ++hmd_id)
+	{
+		TrackingErrorStats &stats= m_errorStats[hmd_id];
+
+		if (stats.sample_count > 0)
+		{
+			const float sample_count= static_cast<float>(stats.sample_count);
+
+			PSVR_LOG_INFO("SyntheticScene") << "HMD " << hmd_id << " tracking error over " << stats.sample_count << " samples:"
+				<< " position rms " << sqrtf(stats.position_error_sq_sum/sample_count) << "cm (max " << stats.max_position_error << "cm),"
+				<< " orientation rms " << sqrtf(stats.angle_error_sq_sum/sample_count) << "deg (max " << stats.max_angle_error << "deg)";
+		}
+
+		stats.clear();
+	}
+}
+
+void SyntheticScene::TrackingErrorStats::clear()
+{
+	sample_count= 0;
+	position_error_sq_sum= 0.f;
+	max_position_error= 0.f;
+	angle_error_sq_sum= 0.f;
+	max_angle_error= 0.f;
+}
+
+//-- private functions -----
+static PSVRPosef glm_pose_to_PSVR_posef(const glm::quat &orientation, const glm::vec3 &position)
+{
+	PSVRPosef pose;
+	pose.Orientation.w= orientation.w;
+	pose.Orientation.x= orientation.x;
+	pose.Orientation.y= orientation.y;
+	pose.Orientation.z= orientation.z;
+	pose.Position.x= position.x;
+	pose.Position.y= position.y;
+	pose.Position.z= position.z;
+
+	return pose;
+}
+
+static glm::mat4 PSVR_posef_to_glm_transform(const PSVRPosef &pose)
+{
+	const glm::quat orientation(pose.Orientation.w, pose.Orientation.x, pose.Orientation.y, pose.Orientation.z);
+	const glm::vec3 position(pose.Position.x, pose.Position.y, pose.Position.z);
+
+	return glm_mat4_from_pose(orientation, position);
+}
+
+// Converts the center of an OpenCV style HSV range (hue in [0, 180]) to a BGR color
+static void hsv_to_bgr(const PSVR_HSVColorRange &hsv_range, float out_bgr[3])
+{
+	const float hue= fmodf(std::max(hsv_range.hue_range.center, 0.f)*2.f, 360.f)/60.f;
+	const float saturation= std::min(std::max(hsv_range.saturation_range.center, 0.f), 255.f)/255.f;
+	const float value= std::min(std::max(hsv_range.value_range.center, 0.f), 255.f);
+
+	const float chroma= value*saturation;
+	const float x= chroma*(1.f - fabsf(fmodf(hue, 2.f) - 1.f));
+	const float m= value - chroma;
+	float r= 0.f, g= 0.f, b= 0.f;
+
+	switch (static_cast<int>(hue))
+	{
+	case 0: r= chroma; g= x; break;
+	case 1: r= x; g= chroma; break;
+	case 2: g= chroma; b= x; break;
+	case 3: g= x; b= chroma; break;
+	case 4: r= x; b= chroma; break;
+	default: r= chroma; b= x; break;
+	}
+
+	out_bgr[0]= b + m;
+	out_bgr[1]= g + m;
+	out_bgr[2]= r + m;
+}
+
+// Same pinhole and distortion model as cv::projectPoints
+static bool project_point(
+	const PSVRMonoTrackerIntrinsics &intrinsics,
+	const glm::vec3 &tracker_relative_point,
+	float &out_x,
+	float &out_y)
+{
+	const PSVRDistortionCoefficients &d= intrinsics.distortion_coefficients;
+	const double *m= (const double *)intrinsics.camera_matrix.m;
+
+	const double x= tracker_relative_point.x/tracker_relative_point.z;
+	const double y= tracker_relative_point.y/tracker_relative_point.z;
+	const double r2= x*x + y*y;
+	const double radial= 1.0 + r2*(d.k1 + r2*(d.k2 + r2*d.k3));
+	const double xd= x*radial + 2.0*d.p1*x*y + d.p2*(r2 + 2.0*x*x);
+	const double yd= y*radial + d.p1*(r2 + 2.0*y*y) + 2.0*d.p2*x*y;
+
+	out_x= static_cast<float>(m[0]*xd + m[2]);
+	out_y= static_cast<float>(m[4]*yd + m[5]);
+
+	return
+		out_x > -intrinsics.pixel_width && out_x < 2.f*intrinsics.pixel_width &&
+		out_y > -intrinsics.pixel_height && out_y < 2.f*intrinsics.pixel_height;
+}
+
+// Draw an anti-aliased disc, blending over whatever is already in the buffer
+static void draw_blob(
+	const SceneBlob &blob,
+	const int width,
+	const int height,
+	const bool bIsBayer,
+	unsigned char *buffer)
+{
+	const int x0= std::max(static_cast<int>(floorf(blob.x - blob.radius - 1.f)), 0);
+	const int x1= std::min(static_cast<int>(ceilf(blob.x + blob.radius + 1.f)), width - 1);
+	const int y0= std::max(static_cast<int>(floorf(blob.y - blob.radius - 1.f)), 0);
+	const int y1= std::min(static_cast<int>(ceilf(blob.y + blob.radius + 1.f)), height - 1);
+
+	for (int y = y0; y <= y1; ++y)
+	{
+		const float dy= static_cast<float>(y) - blob.y;
+
+		for (int x = x0; x <= x1; ++x)
+		{
+			const float dx= static_cast<float>(x) - blob.x;
+			const float coverage= std::min(std::max(blob.radius + 0.5f - sqrtf(dx*dx + dy*dy), 0.f), 1.f);
+
+			if (coverage <= 0.f)
+				continue;
+
+			if (bIsBayer)
+			{
+				// GRBG: even rows are G R G R..., odd rows are B G B G...
+				const int channel= ((y & 1) == 0) ? (((x & 1) == 0) ? 1 : 2) : (((x & 1) == 0) ? 0 : 1);
+				unsigned char &pixel= buffer[y*width + x];
+
+				pixel= static_cast<unsigned char>(pixel + (blob.bgr[channel] - pixel)*coverage);
+			}
+			else
+			{
+				unsigned char *pixel= &buffer[3*(y*width + x)];
+
+				for (int channel = 0; channel < 3; ++channel)
+				{
+					pixel[channel]= static_cast<unsigned char>(pixel[channel] + (blob.bgr[channel] - pixel[channel])*coverage);
+				}
+			}
+		}
+	}
+}
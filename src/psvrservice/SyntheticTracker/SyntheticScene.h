@@ -0,0 +1,121 @@
+#ifndef SYNTHETIC_SCENE_H
+#define SYNTHETIC_SCENE_H
+
+//-- includes -----
+#include "PSVRConfig.h"
+#include "ServiceClock.h"
+#include <mutex>
+#include <string>
+
+//-- definitions -----
+class SyntheticSceneConfig : public PSVRConfig
+{
+public:
+    static const int CONFIG_VERSION;
+
+    SyntheticSceneConfig(const std::string &fnamebase = "SyntheticSceneConfig");
+
+    virtual const configuru::Config writeToJSON();
+    virtual void readFromJSON(const configuru::Config &pt);
+
+    long version;
+
+	// Number of synthetic trackers to create (0 = no synthetic scene)
+	int tracker_count;
+
+	// The camera mode every synthetic tracker renders in
+	float frame_rate;
+	int frame_width;
+	int frame_height;
+	bool is_bayer; // GRBG bayer frames rather than BGR
+	float hfov; // degrees
+	PSVRDistortionCoefficients distortion_coefficients;
+
+	// The trackers sit evenly spaced on a ring around the origin, looking at it (cm)
+	float tracker_ring_radius;
+	float tracker_height;
+
+	// Every HMD follows a looping lissajous path around a spot of its own
+	float hmd_spacing; // cm between the path centers
+	float path_amplitude; // cm
+	float path_period; // seconds
+	float path_yaw_amplitude; // degrees
+	float path_pitch_amplitude; // degrees
+
+	// Physical radius of a point cloud LED (cm)
+	float led_radius;
+	// How often the tracking error against the ground truth gets logged (seconds)
+	float error_log_interval;
+};
+
+/// A CPU-only stand-in for the real world, used for load and accuracy testing.
+/// The synthetic trackers render the tracking shapes of the open HMDs as colored blobs,
+/// with each HMD moving along a scripted path. Since the scene knows where every HMD really is
+/// it also measures how far the filtered HMD poses are off.
+/// Best used with virtual HMDs, since there's no IMU data to go with the scripted motion.
+class SyntheticScene
+{
+public:
+	SyntheticScene();
+
+	// -- System (main thread) ----
+	void startup(); /**< Load the scene config. */
+	void update(); /**< Pick up the open HMDs and measure their tracking error. */
+	void shutdown();
+
+	// -- Accessors ---
+	inline const SyntheticSceneConfig &getConfig() const { return m_cfg; }
+	int getTrackerCount() const;
+
+	// -- Queries ---
+	// Where the given synthetic tracker sits in the scene
+	PSVRPosef computeTrackerPose(const int tracker_index) const;
+	// The intrinsics every synthetic tracker renders with
+	PSVRMonoTrackerIntrinsics computeTrackerIntrinsics() const;
+	// Ground truth pose of the given HMD at the given time
+	PSVRPosef computeHMDPose(const int hmd_id, const t_service_timepoint &time) const;
+
+	// Render the LEDs of every tracked HMD as seen from the given tracker pose at the given time
+	// into a frame_width x frame_height bayer or BGR buffer. Safe to call from any thread.
+	void renderFrame(
+		const PSVRPosef &tracker_pose,
+		const PSVRMonoTrackerIntrinsics &intrinsics,
+		const t_service_timepoint &time,
+		unsigned char *out_buffer) const;
+
+private:
+	struct SceneHMD
+	{
+		bool bIsVisible;
+		PSVRTrackingShape shape;
+		PSVRTrackingColorType color;
+	};
+
+	struct TrackingErrorStats
+	{
+		int sample_count;
+		float position_error_sq_sum;
+		float max_position_error;
+		float angle_error_sq_sum;
+		float max_angle_error;
+
+		void clear();
+	};
+
+	void publish_hmds();
+	void sample_tracking_error();
+	void log_tracking_error();
+
+	SyntheticSceneConfig m_cfg;
+	t_service_timepoint m_startTime;
+
+	// Copied out by the tracker threads every frame
+	mutable std::mutex m_hmdMutex;
+	SceneHMD m_hmds[PSVRSERVICE_MAX_HMD_COUNT];
+
+	// Main thread state
+	TrackingErrorStats m_errorStats[PSVRSERVICE_MAX_HMD_COUNT];
+	t_service_timepoint m_lastErrorLogTime;
+};
+
+#endif // SYNTHETIC_SCENE_H
@@ -0,0 +1,411 @@
+// -- includes -----
+#include "SyntheticTracker.h"
+#include "DeviceManager.h"
+#include "Logger.h"
+#include "ServiceClock.h"
+#include "SyntheticScene.h"
+#include "SyntheticTrackerEnumerator.h"
+#include "TrackerDeviceEnumerator.h"
+#include "Utility.h"
+#include "WorkerThread.h"
+#include <assert.h>
+#include <atomic>
+#include <chrono>
+#include <string.h>
+#include <thread>
+
+#ifdef _MSC_VER
+    #pragma warning (disable: 4996) // 'This function or variable may be unsafe': strncpy
+#endif
+
+// -- constants -----
+static const char *k_synthetic_mode_name= "synthetic";
+
+// -- private definitions -----
+/// Renders the scene from the tracker's point of view at the scene frame rate
+/// and hands the frames to the tracker listener
+class SyntheticVideoDevice : public WorkerThread
+{
+public:
+	SyntheticVideoDevice(
+		const SyntheticScene *scene,
+		const int tracker_index,
+		ITrackerListener *listener)
+		: WorkerThread("SyntheticVideoDevice")
+		, m_scene(scene)
+		, m_trackerPose(scene->computeTrackerPose(tracker_index))
+		, m_intrinsics(scene->computeTrackerIntrinsics())
+		, m_framePeriod(std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(
+			std::chrono::duration<double>(1.0/scene->getConfig().frame_rate)))
+		, m_frameBuffer(
+			static_cast<size_t>(scene->getConfig().frame_width*scene->getConfig().frame_height)*
+			(scene->getConfig().is_bayer ? 1 : 3))
+		, m_nextFrameTime()
+		, m_listener(listener)
+	{
+	}
+
+	virtual ~SyntheticVideoDevice()
+	{
+		stopThread();
+	}
+
+	inline void setListener(ITrackerListener *listener) { m_listener= listener; }
+
+protected:
+	void onThreadStarted() override
+	{
+		m_nextFrameTime= std::chrono::high_resolution_clock::now();
+	}
+
+	bool doWork() override
+	{
+		const auto now= std::chrono::high_resolution_clock::now();
+
+		if (now < m_nextFrameTime)
+		{
+			std::this_thread::sleep_for(m_nextFrameTime - now);
+			return true;
+		}
+
+		// Skip the frames we fell behind on, like a camera would drop them
+		m_nextFrameTime+= m_framePeriod;
+		if (m_nextFrameTime < now)
+		{
+			m_nextFrameTime= now + m_framePeriod;
+		}
+
+		ITrackerListener *listener= m_listener.load();
+		if (listener != nullptr)
+		{
+			const t_service_timepoint capture_timestamp= ServiceClock::now();
+
+			m_scene->renderFrame(m_trackerPose, m_intrinsics, capture_timestamp, m_frameBuffer.data());
+			listener->notifyVideoFrameReceived(m_frameBuffer.data(), capture_timestamp);
+		}
+
+		return true;
+	}
+
+	// Constant while the thread runs
+	const SyntheticScene *m_scene;
+	const PSVRPosef m_trackerPose;
+	const PSVRMonoTrackerIntrinsics m_intrinsics;
+	const std::chrono::high_resolution_clock::duration m_framePeriod;
+
+	// Render thread state
+	std::vector<unsigned char> m_frameBuffer;
+	std::chrono::time_point<std::chrono::high_resolution_clock> m_nextFrameTime;
+
+	// Multithreaded state
+	std::atomic<ITrackerListener *> m_listener;
+};
+
+// -- Synthetic Tracker
+SyntheticTracker::SyntheticTracker()
+    : m_cfg()
+    , m_mode()
+    , m_deviceIdentifier()
+    , m_videoDevice(nullptr)
+    , m_listener(nullptr)
+{
+    memset(&m_intrinsics, 0, sizeof(m_intrinsics));
+}
+
+SyntheticTracker::~SyntheticTracker()
+{
+    if (getIsOpen())
+    {
+        PSVR_LOG_ERROR("~SyntheticTracker") << "Tracker deleted without calling close() first!";
+    }
+}
+
+// -- IDeviceInterface
+bool SyntheticTracker::matchesDeviceEnumerator(const DeviceEnumerator *enumerator) const
+{
+    // Down-cast the enumerator so we can use the correct get_path.
+    const TrackerDeviceEnumerator *pEnum = static_cast<const TrackerDeviceEnumerator *>(enumerator);
+
+    return
+        pEnum->get_api_type() == TrackerDeviceEnumerator::CommunicationType_SYNTHETIC &&
+        m_deviceIdentifier == pEnum->get_path();
+}
+
+bool SyntheticTracker::open(const DeviceEnumerator *enumerator)
+{
+    const TrackerDeviceEnumerator *tracker_enumerator = static_cast<const TrackerDeviceEnumerator *>(enumerator);
+    const SyntheticTrackerEnumerator *synthetic_enumerator = tracker_enumerator->get_synthetic_tracker_enumerator();
+    const char *cur_dev_path = tracker_enumerator->get_path();
+
+    if (getIsOpen())
+    {
+        PSVR_LOG_WARNING("SyntheticTracker::open") << "SyntheticTracker(" << cur_dev_path << ") already open. Ignoring request.";
+        return true;
+    }
+
+    const SyntheticScene *scene= DeviceManager::getInstance()->getSyntheticScene();
+    const int tracker_index= (synthetic_enumerator != nullptr) ? synthetic_enumerator->get_tracker_index() : -1;
+
+    if (!Utility::is_index_valid(tracker_index, scene->getTrackerCount()))
+    {
+        PSVR_LOG_ERROR("SyntheticTracker::open") << "No synthetic tracker for SyntheticTracker(" << cur_dev_path << ")";
+        return false;
+    }
+
+    const SyntheticSceneConfig &scene_cfg= scene->getConfig();
+
+    PSVR_LOG_INFO("SyntheticTracker::open") << "Opening SyntheticTracker(" << cur_dev_path << ")";
+
+    m_deviceIdentifier= cur_dev_path;
+    m_intrinsics.intrinsics_type= PSVR_MONO_TRACKER_INTRINSICS;
+    m_intrinsics.intrinsics.mono= scene->computeTrackerIntrinsics();
+
+    m_mode.modeName= k_synthetic_mode_name;
+    m_mode.frameRate= scene_cfg.frame_rate;
+    m_mode.isFrameMirrored= false;
+    m_mode.isBufferMirrored= false;
+    m_mode.bufferPixelWidth= scene_cfg.frame_width;
+    m_mode.bufferPixelHeight= scene_cfg.frame_height;
+    m_mode.bufferFormat= scene_cfg.is_bayer ? CAMERA_BUFFER_FORMAT_BEYER : CAMERA_BUFFER_FORMAT_MJPG;
+    m_mode.intrinsics= m_intrinsics;
+    m_mode.frameSections.clear();
+
+    // Load the config file for the synthetic tracker.
+    // The scene decides where the tracker is, so the pose is always reset to the true one.
+    char config_name[256];
+    Utility::format_string(config_name, sizeof(config_name), "SyntheticTrackerConfig_%d", tracker_index);
+
+    m_cfg = CommonTrackerConfig(config_name);
+    m_cfg.load();
+    m_cfg.pose= scene->computeTrackerPose(tracker_index);
+    m_cfg.current_mode= m_mode.modeName;
+    m_cfg.is_valid= true;
+    m_cfg.save();
+
+    // Start rendering frames
+    m_videoDevice= new SyntheticVideoDevice(scene, tracker_index, m_listener);
+    m_videoDevice->startThread();
+
+    return true;
+}
+
+bool SyntheticTracker::getIsOpen() const
+{
+    return m_videoDevice != nullptr;
+}
+
+void SyntheticTracker::close()
+{
+    if (m_videoDevice != nullptr)
+    {
+        // Blocks until the render thread is done with our listener
+        delete m_videoDevice;
+        m_videoDevice= nullptr;
+    }
+}
+
+CommonSensorState::eDeviceType SyntheticTracker::getDeviceType() const
+{
+    return CommonSensorState::WMFMonoCamera;
+}
+
+ITrackerInterface::eDriverType SyntheticTracker::getDriverType() const
+{
+    return ITrackerInterface::Synthetic;
+}
+
+std::string SyntheticTracker::getUSBDevicePath() const
+{
+    return m_deviceIdentifier;
+}
+
+bool SyntheticTracker::getVideoFrameDimensions(
+    int *out_width,
+    int *out_height,
+    int *out_stride) const
+{
+    if (out_width != nullptr)
+    {
+        int width = (int)m_intrinsics.intrinsics.mono.pixel_width;
+
+        if (out_stride != nullptr)
+        {
+            *out_stride = 3 * width;
+        }
+
+        *out_width = width;
+    }
+
+    if (out_height != nullptr)
+    {
+        *out_height = (int)m_intrinsics.intrinsics.mono.pixel_height;
+    }
+
+    return true;
+}
+
+bool SyntheticTracker::getIsStereoCamera() const
+{
+    return false;
+}
+
+bool SyntheticTracker::getIsFrameMirrored() const
+{
+    return m_mode.isFrameMirrored;
+}
+
+bool SyntheticTracker::getIsBufferMirrored() const
+{
+    return m_mode.isBufferMirrored;
+}
+
+void SyntheticTracker::loadSettings()
+{
+    m_cfg.load();
+}
+
+void SyntheticTracker::saveSettings()
+{
+    m_cfg.save();
+}
+
+bool SyntheticTracker::getAvailableTrackerModes(std::vector<std::string> &out_mode_names) const
+{
+    // Only the mode from the scene config is available
+    out_mode_names.push_back(m_mode.modeName);
+
+    return true;
+}
+
+const TrackerModeConfig *SyntheticTracker::getTrackerMode() const
+{
+    return &m_mode;
+}
+
+bool SyntheticTracker::setTrackerMode(const std::string mode_name)
+{
+    return mode_name == m_mode.modeName;
+}
+
+double SyntheticTracker::getFrameWidth() const
+{
+    return (double)m_intrinsics.intrinsics.mono.pixel_width;
+}
+
+double SyntheticTracker::getFrameHeight() const
+{
+    return (double)m_intrinsics.intrinsics.mono.pixel_height;
+}
+
+double SyntheticTracker::getFrameRate() const
+{
+    return (double)m_mode.frameRate;
+}
+
+bool SyntheticTracker::getVideoPropertyConstraint(const PSVRVideoPropertyType property_type, PSVRVideoPropertyConstraint &outConstraint) const
+{
+    // The rendered frames can't be adjusted
+    memset(&outConstraint, 0, sizeof(PSVRVideoPropertyConstraint));
+    outConstraint.is_supported= false;
+
+    return false;
+}
+
+void SyntheticTracker::setVideoProperty(const PSVRVideoPropertyType property_type, int desired_value, bool bUpdateConfig)
+{
+    if (bUpdateConfig)
+    {
+        m_cfg.video_properties[property_type] = desired_value;
+    }
+
+    // No hardware to wait on
+    if (m_listener != nullptr)
+    {
+        m_listener->notifyVideoPropertyApplied(property_type, getVideoProperty(property_type), true);
+    }
+}
+
+int SyntheticTracker::getVideoProperty(const PSVRVideoPropertyType property_type) const
+{
+    return m_cfg.video_properties[property_type];
+}
+
+void SyntheticTracker::getCameraIntrinsics(
+    PSVRTrackerIntrinsics &out_tracker_intrinsics) const
+{
+    out_tracker_intrinsics= m_intrinsics;
+}
+
+void SyntheticTracker::setCameraIntrinsics(
+    const PSVRTrackerIntrinsics &tracker_intrinsics)
+{
+    assert(tracker_intrinsics.intrinsics_type == m_intrinsics.intrinsics_type);
+    m_intrinsics= tracker_intrinsics;
+}
+
+PSVRPosef SyntheticTracker::getTrackerPose() const
+{
+    return m_cfg.pose;
+}
+
+void SyntheticTracker::setTrackerPose(
+    const PSVRPosef *pose)
+{
+    m_cfg.pose = *pose;
+    m_cfg.save();
+}
+
+void SyntheticTracker::getFOV(float &outHFOV, float &outVFOV) const
+{
+    outHFOV = static_cast<float>(m_intrinsics.intrinsics.mono.hfov);
+    outVFOV = static_cast<float>(m_intrinsics.intrinsics.mono.vfov);
+}
+
+void SyntheticTracker::getZRange(float &outZNear, float &outZFar) const
+{
+    outZNear = static_cast<float>(m_intrinsics.intrinsics.mono.znear);
+    outZFar = static_cast<float>(m_intrinsics.intrinsics.mono.zfar);
+}
+
+void SyntheticTracker::gatherTrackingColorPresets(
+	const std::string &table_name,
+    PSVRClientTrackerSettings* settings) const
+{
+    settings->color_range_table= *m_cfg.getColorRangeTable(table_name);
+}
+
+void SyntheticTracker::setTrackingColorPreset(
+	const std::string &table_name,
+    PSVRTrackingColorType color,
+    const PSVR_HSVColorRange *preset)
+{
+	PSVR_HSVColorRangeTable *table= m_cfg.getOrAddColorRangeTable(table_name);
+
+    table->color_presets[color] = *preset;
+    m_cfg.save();
+}
+
+void SyntheticTracker::getTrackingColorPreset(
+	const std::string &table_name,
+    PSVRTrackingColorType color,
+    PSVR_HSVColorRange *out_preset) const
+{
+	const PSVR_HSVColorRangeTable *table= m_cfg.getColorRangeTable(table_name);
+
+    *out_preset = table->color_presets[color];
+}
+
+void SyntheticTracker::setTrackerListener(ITrackerListener *listener)
+{
+	m_listener= listener;
+
+    if (m_videoDevice != nullptr)
+    {
+        m_videoDevice->setListener(m_listener);
+    }
+}
+
+void SyntheticTracker::getDeviceStatistics(PSVRTrackerStatistics &out_statistics) const
+{
+	// Rendered frames never touch USB
+}
@@ -0,0 +1,54 @@
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <new>
+
+FrameArena::FrameArena(size_t capacity_bytes)
+	: m_buffer(static_cast<unsigned char *>(::operator new(capacity_bytes)))
+	, m_capacity(capacity_bytes)
+	, m_usedBytes(0)
+	, m_highWaterMark(0)
+	, m_overflowCount(0)
+{
+}
+
+FrameArena::~FrameArena()
+{
+	::operator delete(m_buffer);
+}
+
+void *FrameArena::allocate(size_t size_bytes, size_t alignment)
+{
+	const uintptr_t base= reinterpret_cast<uintptr_t>(m_buffer);
+	const uintptr_t aligned_start= (base + m_usedBytes + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+	const size_t new_used_bytes= static_cast<size_t>(aligned_start - base) + size_bytes;
+
+	if (new_used_bytes <= m_capacity)
+	{
+		m_usedBytes= new_used_bytes;
+		m_highWaterMark= std::max(m_highWaterMark, m_usedBytes);
+
+		return reinterpret_cast<void *>(aligned_start);
+	}
+	else
+	{
+		// Out of room for this frame, fall back to the heap
+		++m_overflowCount;
+
+		return ::operator new(size_bytes);
+	}
+}
+
+void FrameArena::deallocate(void *p)
+{
+	// Arena allocations are all freed at once by reset()
+	if (p != nullptr && !owns(p))
+	{
+		::operator delete(p);
+	}
+}
+
+void FrameArena::reset()
+{
+	m_usedBytes= 0;
+}
@@ -0,0 +1,91 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// A bump allocator for scratch data that only lives for the duration of one tracking frame.
+// The owner reset()s the arena at the start of each frame, which frees everything allocated from it at once.
+// Allocations that don't fit in the arena overflow onto the heap (and are counted so the arena can be sized up).
+//
+// Like StackContainer, this is meant for array-like containers that reserve() up front.
+// An arena is not thread safe, so each thread working on a frame needs its own arena.
+class FrameArena
+{
+public:
+	FrameArena(size_t capacity_bytes);
+	~FrameArena();
+
+	void *allocate(size_t size_bytes, size_t alignment);
+	void deallocate(void *p);
+
+	// Frees everything allocated from the arena.
+	// WATCH OUT: any container still using the arena must be gone by the time this is called.
+	void reset();
+
+	inline size_t getCapacity() const { return m_capacity; }
+	inline size_t getUsedBytes() const { return m_usedBytes; }
+	inline size_t getHighWaterMark() const { return m_highWaterMark; }
+	inline uint64_t getOverflowCount() const { return m_overflowCount; }
+
+private:
+	inline bool owns(const void *p) const
+	{
+		return p >= m_buffer && p < m_buffer + m_capacity;
+	}
+
+	unsigned char *m_buffer;
+	size_t m_capacity;
+	size_t m_usedBytes;
+	size_t m_highWaterMark;
+	uint64_t m_overflowCount;
+
+	FrameArena(const FrameArena&);
+	void operator=(const FrameArena&);
+};
+
+// STL allocator backed by a FrameArena.
+// Copies of the allocator share the same arena.
+template<typename T>
+class FrameArenaAllocator
+{
+public:
+	typedef T value_type;
+
+	explicit FrameArenaAllocator(FrameArena *arena) : m_arena(arena) {}
+
+	template<typename U>
+	FrameArenaAllocator(const FrameArenaAllocator<U> &other) : m_arena(other.getArena()) {}
+
+	T* allocate(size_t n)
+	{
+		return static_cast<T *>(m_arena->allocate(n*sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T *p, size_t n)
+	{
+		m_arena->deallocate(p);
+	}
+
+	FrameArena *getArena() const { return m_arena; }
+
+	template<typename U>
+	bool operator==(const FrameArenaAllocator<U> &other) const { return m_arena == other.getArena(); }
+	template<typename U>
+	bool operator!=(const FrameArenaAllocator<U> &other) const { return m_arena != other.getArena(); }
+
+private:
+	FrameArena *m_arena;
+};
+
+// FrameArenaVector
+//
+// Example:
+//   FrameArenaVector<int> foo(FrameArenaAllocator<int>(&arena));
+//   foo.reserve(16);
+//   foo.push_back(22);
+template<typename T>
+using FrameArenaVector= std::vector<T, FrameArenaAllocator<T> >;
+
+#endif // FRAME_ARENA_H
@@ -0,0 +1,75 @@
+#include "HeapAllocationCounter.h"
+
+#ifdef PSVR_COUNT_HEAP_ALLOCATIONS
+#include <cstdlib>
+#include <new>
+
+static thread_local uint64_t g_threadAllocationCount= 0;
+
+void *operator new(size_t size)
+{
+	++g_threadAllocationCount;
+
+	if (void *p= std::malloc(size != 0 ? size : 1))
+		return p;
+
+	throw std::bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+	++g_threadAllocationCount;
+
+	return std::malloc(size != 0 ? size : 1);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &tag) noexcept
+{
+	return operator new(size, tag);
+}
+
+void operator delete(void *p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+	std::free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+	std::free(p);
+}
+
+bool HeapAllocationCounter::isEnabled()
+{
+	return true;
+}
+
+uint64_t HeapAllocationCounter::getThreadAllocationCount()
+{
+	return g_threadAllocationCount;
+}
+#else
+bool HeapAllocationCounter::isEnabled()
+{
+	return false;
+}
+
+uint64_t HeapAllocationCounter::getThreadAllocationCount()
+{
+	return 0;
+}
+#endif // PSVR_COUNT_HEAP_ALLOCATIONS
@@ -0,0 +1,41 @@
+#ifndef HEAP_ALLOCATION_COUNTER_H
+#define HEAP_ALLOCATION_COUNTER_H
+
+#include <stdint.h>
+
+// Debug aid for keeping the steady state tracking path allocation free.
+// When the service is built with PSVR_COUNT_HEAP_ALLOCATIONS the global operator new is replaced
+// with one that counts the allocations made by each thread. Otherwise the counts are always zero.
+// Only operator new/new[] (including the nothrow forms) is counted. Allocations that bypass it are not:
+// - malloc/calloc/realloc, including cv::fastMalloc and so the pixel data of every cv::Mat
+//   (the UMatData that OpenCV's default allocator news up for each buffer is counted, and so are
+//   the temporaries inside calls like cv::solvePnP)
+// - allocations made inside other libraries' own allocators (libusb, the C runtime)
+// - allocations made on other threads on the counting thread's behalf (e.g. TaskPool workers)
+// A zero count therefore means no C++ container or new'd object growth on that thread, not zero heap traffic.
+namespace HeapAllocationCounter
+{
+	bool isEnabled();
+
+	// Number of heap allocations made by the calling thread so far
+	uint64_t getThreadAllocationCount();
+};
+
+// Counts the heap allocations the calling thread makes while the scope is alive
+class HeapAllocationScope
+{
+public:
+	HeapAllocationScope()
+		: m_startCount(HeapAllocationCounter::getThreadAllocationCount())
+	{}
+
+	uint64_t getAllocationCount() const
+	{
+		return HeapAllocationCounter::getThreadAllocationCount() - m_startCount;
+	}
+
+private:
+	uint64_t m_startCount;
+};
+
+#endif // HEAP_ALLOCATION_COUNTER_H
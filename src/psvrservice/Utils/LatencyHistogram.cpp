@@ -0,0 +1,151 @@
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+//-- constants -----
+static const uint64_t k_no_min_microseconds= UINT64_MAX;
+
+//-- private methods -----
+static int find_highest_bit(uint64_t value);
+
+//-- LatencyHistogram -----
+LatencyHistogram::LatencyHistogram()
+	: m_totalMicroseconds(0)
+	, m_minMicroseconds(k_no_min_microseconds)
+	, m_maxMicroseconds(0)
+{
+	for (int bucket_index = 0; bucket_index < k_bucket_count; ++bucket_index)
+	{
+		m_bucketCounts[bucket_index]= 0;
+	}
+}
+
+void LatencyHistogram::recordMicroseconds(uint64_t microseconds)
+{
+	microseconds= std::min(microseconds, k_max_recordable_microseconds);
+
+	// Single writer, so a relaxed load + store is enough (and avoids a locked read-modify-write)
+	std::atomic<uint64_t> &bucket= m_bucketCounts[computeBucketIndex(microseconds)];
+	bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+	m_totalMicroseconds.store(m_totalMicroseconds.load(std::memory_order_relaxed) + microseconds, std::memory_order_relaxed);
+
+	if (microseconds < m_minMicroseconds.load(std::memory_order_relaxed))
+	{
+		m_minMicroseconds.store(microseconds, std::memory_order_relaxed);
+	}
+
+	if (microseconds > m_maxMicroseconds.load(std::memory_order_relaxed))
+	{
+		m_maxMicroseconds.store(microseconds, std::memory_order_relaxed);
+	}
+}
+
+int LatencyHistogram::computeBucketIndex(uint64_t microseconds)
+{
+	// Values below k_sub_bucket_count get a bucket each.
+	// Above that each power of two is split into k_sub_bucket_count/2 buckets of width 2^shift.
+	const int shift= std::max(find_highest_bit(microseconds) - k_sub_bucket_bits, 0);
+
+	return (shift << k_sub_bucket_bits) + static_cast<int>(microseconds >> shift);
+}
+
+uint64_t LatencyHistogram::computeBucketHighestValue(int bucket_index)
+{
+	const int shift= std::max((bucket_index >> k_sub_bucket_bits) - 1, 0);
+	const uint64_t mantissa= static_cast<uint64_t>(bucket_index - (shift << k_sub_bucket_bits));
+
+	return (mantissa << shift) + ((uint64_t(1) << shift) - 1);
+}
+
+//-- LatencyHistogramSnapshot -----
+LatencyHistogramSnapshot::LatencyHistogramSnapshot()
+	: m_sampleCount(0)
+	, m_totalMicroseconds(0)
+	, m_minMicroseconds(k_no_min_microseconds)
+	, m_maxMicroseconds(0)
+{
+	memset(m_bucketCounts, 0, sizeof(m_bucketCounts));
+}
+
+void LatencyHistogramSnapshot::add(const LatencyHistogram &histogram)
+{
+	// The writer may be part way through a record, so the sample count comes from the buckets we actually copied
+	for (int bucket_index = 0; bucket_index < LatencyHistogram::k_bucket_count; ++bucket_index)
+	{
+		const uint64_t bucket_count= histogram.m_bucketCounts[bucket_index].load(std::memory_order_relaxed);
+
+		m_bucketCounts[bucket_index]+= bucket_count;
+		m_sampleCount+= bucket_count;
+	}
+
+	m_totalMicroseconds+= histogram.m_totalMicroseconds.load(std::memory_order_relaxed);
+	m_minMicroseconds= std::min(m_minMicroseconds, histogram.m_minMicroseconds.load(std::memory_order_relaxed));
+	m_maxMicroseconds= std::max(m_maxMicroseconds, histogram.m_maxMicroseconds.load(std::memory_order_relaxed));
+}
+
+uint64_t LatencyHistogramSnapshot::getValueAtPercentile(double percentile) const
+{
+	if (m_sampleCount == 0)
+	{
+		return 0;
+	}
+
+	const double clamped_percentile= std::min(std::max(percentile, 0.0), 100.0);
+	const uint64_t target_count=
+		std::max(static_cast<uint64_t>(ceil(clamped_percentile / 100.0 * static_cast<double>(m_sampleCount))), uint64_t(1));
+
+	uint64_t cumulative_count= 0;
+	for (int bucket_index = 0; bucket_index < LatencyHistogram::k_bucket_count; ++bucket_index)
+	{
+		cumulative_count+= m_bucketCounts[bucket_index];
+
+		if (cumulative_count >= target_count)
+		{
+			// Never report more than was actually recorded
+			return std::min(LatencyHistogram::computeBucketHighestValue(bucket_index), m_maxMicroseconds);
+		}
+	}
+
+	return m_maxMicroseconds;
+}
+
+void LatencyHistogramSnapshot::getStatistics(PSVRLatencyStatistics &out_statistics) const
+{
+	const float k_microseconds_to_milliseconds= 0.001f;
+
+	memset(&out_statistics, 0, sizeof(PSVRLatencyStatistics));
+	out_statistics.sample_count= m_sampleCount;
+
+	if (m_sampleCount > 0)
+	{
+		out_statistics.min_ms= static_cast<float>(m_minMicroseconds) * k_microseconds_to_milliseconds;
+		out_statistics.mean_ms=
+			static_cast<float>(static_cast<double>(m_totalMicroseconds) / static_cast<double>(m_sampleCount)) * k_microseconds_to_milliseconds;
+		out_statistics.p50_ms= static_cast<float>(getValueAtPercentile(50.0)) * k_microseconds_to_milliseconds;
+		out_statistics.p90_ms= static_cast<float>(getValueAtPercentile(90.0)) * k_microseconds_to_milliseconds;
+		out_statistics.p99_ms= static_cast<float>(getValueAtPercentile(99.0)) * k_microseconds_to_milliseconds;
+		out_statistics.p999_ms= static_cast<float>(getValueAtPercentile(99.9)) * k_microseconds_to_milliseconds;
+		out_statistics.max_ms= static_cast<float>(m_maxMicroseconds) * k_microseconds_to_milliseconds;
+	}
+}
+
+//-- private methods -----
+static int find_highest_bit(uint64_t value)
+{
+	// Index of the highest set bit (0 for a value of 0)
+	int bit= 0;
+
+	for (int step = 32; step > 0; step >>= 1)
+	{
+		if ((value >> step) != 0)
+		{
+			value>>= step;
+			bit+= step;
+		}
+	}
+
+	return bit;
+}
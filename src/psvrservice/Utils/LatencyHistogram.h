@@ -0,0 +1,95 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+//-- includes -----
+#include "PSVRClient_CAPI.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+
+//-- definitions -----
+// Always-on latency recording for the tracking pipeline.
+// Values are bucketed HDR style: 32 linear sub-buckets per power of two microseconds,
+// so every recorded latency keeps ~3% precision from 1us up to a minute without any allocation.
+//
+// Lock free with a single writer: only one thread may record into a given histogram
+// (use one histogram per thread and merge them with LatencyHistogramSnapshot), while any thread can read it.
+class LatencyHistogram
+{
+public:
+	static const int k_sub_bucket_bits= 5;
+	static const int k_sub_bucket_count= 1 << k_sub_bucket_bits;
+	static const int k_max_shift= 20;
+	static const int k_bucket_count= (k_max_shift + 2) * k_sub_bucket_count;
+	static const uint64_t k_max_recordable_microseconds= (uint64_t(k_sub_bucket_count) << (k_max_shift + 1)) - 1;
+
+	LatencyHistogram();
+
+	// Longer latencies are clamped to k_max_recordable_microseconds
+	void recordMicroseconds(uint64_t microseconds);
+
+	inline void recordDuration(const std::chrono::high_resolution_clock::duration &duration)
+	{
+		const int64_t microseconds= std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+
+		recordMicroseconds(microseconds > 0 ? static_cast<uint64_t>(microseconds) : 0);
+	}
+
+	static int computeBucketIndex(uint64_t microseconds);
+	static uint64_t computeBucketHighestValue(int bucket_index);
+
+private:
+	friend class LatencyHistogramSnapshot;
+
+	std::atomic<uint64_t> m_bucketCounts[k_bucket_count];
+	std::atomic<uint64_t> m_totalMicroseconds;
+	std::atomic<uint64_t> m_minMicroseconds;
+	std::atomic<uint64_t> m_maxMicroseconds;
+
+	LatencyHistogram(const LatencyHistogram&);
+	void operator=(const LatencyHistogram&);
+};
+
+// A plain copy of one or more histograms, taken for reporting
+class LatencyHistogramSnapshot
+{
+public:
+	LatencyHistogramSnapshot();
+
+	// Merge the current contents of the given histogram into the snapshot
+	void add(const LatencyHistogram &histogram);
+
+	inline uint64_t getSampleCount() const { return m_sampleCount; }
+	uint64_t getValueAtPercentile(double percentile) const;
+
+	void getStatistics(PSVRLatencyStatistics &out_statistics) const;
+
+private:
+	uint64_t m_bucketCounts[LatencyHistogram::k_bucket_count];
+	uint64_t m_sampleCount;
+	uint64_t m_totalMicroseconds;
+	uint64_t m_minMicroseconds;
+	uint64_t m_maxMicroseconds;
+};
+
+// Records the time from construction to destruction into a histogram
+class LatencyScope
+{
+public:
+	LatencyScope(LatencyHistogram &histogram)
+		: m_histogram(histogram)
+		, m_startTime(std::chrono::high_resolution_clock::now())
+	{}
+
+	~LatencyScope()
+	{
+		m_histogram.recordDuration(std::chrono::high_resolution_clock::now() - m_startTime);
+	}
+
+private:
+	LatencyHistogram &m_histogram;
+	std::chrono::high_resolution_clock::time_point m_startTime;
+};
+
+#endif // LATENCY_HISTOGRAM_H
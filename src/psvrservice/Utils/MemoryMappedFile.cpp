@@ -0,0 +1,125 @@
+// -- includes -----
+#include "MemoryMappedFile.h"
+
+#if defined WIN32 || defined _WIN32 || defined WINCE
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+// -- public interface -----
+MemoryMappedFile::MemoryMappedFile()
+	: m_data(nullptr)
+	, m_size(0)
+#if defined WIN32 || defined _WIN32 || defined WINCE
+	, m_fileHandle(INVALID_HANDLE_VALUE)
+	, m_mappingHandle(nullptr)
+#endif
+{
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+	close();
+}
+
+#if defined WIN32 || defined _WIN32 || defined WINCE
+bool MemoryMappedFile::open(const std::string &path)
+{
+	close();
+
+	m_fileHandle= CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (m_fileHandle == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(m_fileHandle, &file_size) || file_size.QuadPart == 0)
+	{
+		close();
+		return false;
+	}
+
+	m_mappingHandle= CreateFileMappingA(m_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_mappingHandle == nullptr)
+	{
+		close();
+		return false;
+	}
+
+	m_data= static_cast<const unsigned char *>(MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if (m_data == nullptr)
+	{
+		close();
+		return false;
+	}
+
+	m_size= static_cast<size_t>(file_size.QuadPart);
+
+	return true;
+}
+
+void MemoryMappedFile::close()
+{
+	if (m_data != nullptr)
+	{
+		UnmapViewOfFile(m_data);
+		m_data= nullptr;
+	}
+
+	if (m_mappingHandle != nullptr)
+	{
+		CloseHandle(m_mappingHandle);
+		m_mappingHandle= nullptr;
+	}
+
+	if (m_fileHandle != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(m_fileHandle);
+		m_fileHandle= INVALID_HANDLE_VALUE;
+	}
+
+	m_size= 0;
+}
+#else
+bool MemoryMappedFile::open(const std::string &path)
+{
+	close();
+
+	const int fd= ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0)
+	{
+		::close(fd);
+		return false;
+	}
+
+	// The mapping stays valid after the descriptor is closed
+	void *data= mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+
+	if (data == MAP_FAILED)
+		return false;
+
+	m_data= static_cast<const unsigned char *>(data);
+	m_size= static_cast<size_t>(file_stat.st_size);
+
+	return true;
+}
+
+void MemoryMappedFile::close()
+{
+	if (m_data != nullptr)
+	{
+		munmap(const_cast<unsigned char *>(m_data), m_size);
+		m_data= nullptr;
+	}
+
+	m_size= 0;
+}
+#endif
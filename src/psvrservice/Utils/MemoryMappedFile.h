@@ -0,0 +1,36 @@
+#ifndef MEMORY_MAPPED_FILE_H
+#define MEMORY_MAPPED_FILE_H
+
+//-- includes -----
+#include <stddef.h>
+#include <string>
+
+//-- definitions -----
+// Read-only view of a whole file mapped into memory
+class MemoryMappedFile
+{
+public:
+	MemoryMappedFile();
+	~MemoryMappedFile();
+
+	bool open(const std::string &path);
+	void close();
+
+	inline bool getIsOpen() const { return m_data != nullptr; }
+	inline const unsigned char *getData() const { return m_data; }
+	inline size_t getSize() const { return m_size; }
+
+private:
+	const unsigned char *m_data;
+	size_t m_size;
+
+#if defined WIN32 || defined _WIN32 || defined WINCE
+	void *m_fileHandle;
+	void *m_mappingHandle;
+#endif
+
+	MemoryMappedFile(const MemoryMappedFile&);
+	void operator=(const MemoryMappedFile&);
+};
+
+#endif // MEMORY_MAPPED_FILE_H
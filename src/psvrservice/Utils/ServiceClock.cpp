@@ -0,0 +1,45 @@
+#include "ServiceClock.h"
+
+//-- globals -----
+static RealtimeServiceClock g_realtime_clock;
+static std::atomic<IServiceClock *> g_service_clock(&g_realtime_clock);
+
+//-- SteppedServiceClock -----
+SteppedServiceClock::SteppedServiceClock(const t_service_timepoint start_time)
+	: m_nowTicks(start_time.time_since_epoch().count())
+{
+}
+
+t_service_timepoint SteppedServiceClock::now() const
+{
+	return t_service_timepoint(t_service_duration(m_nowTicks.load()));
+}
+
+void SteppedServiceClock::advanceTo(const t_service_timepoint new_time)
+{
+	const int64_t new_ticks= new_time.time_since_epoch().count();
+	int64_t old_ticks= m_nowTicks.load();
+
+	while (new_ticks > old_ticks && !m_nowTicks.compare_exchange_weak(old_ticks, new_ticks))
+	{
+	}
+}
+
+void SteppedServiceClock::advanceBy(const t_service_duration delta_time)
+{
+	if (delta_time.count() > 0)
+	{
+		m_nowTicks.fetch_add(delta_time.count());
+	}
+}
+
+//-- ServiceClock -----
+IServiceClock *ServiceClock::getClock()
+{
+	return g_service_clock.load();
+}
+
+void ServiceClock::setClock(IServiceClock *clock)
+{
+	g_service_clock.store((clock != nullptr) ? clock : &g_realtime_clock);
+}
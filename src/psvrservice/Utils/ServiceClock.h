@@ -0,0 +1,64 @@
+#ifndef SERVICE_CLOCK_H
+#define SERVICE_CLOCK_H
+
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+
+typedef std::chrono::time_point<std::chrono::high_resolution_clock> t_service_timepoint;
+typedef t_service_timepoint::duration t_service_duration;
+
+// The time source for every timestamp in the tracking pipeline
+// (sensor packets, tracker frames, optical pose estimates and filtered poses).
+// Timing that has nothing to do with the tracked data (reconnect intervals, profiling) uses the wall clock directly.
+class IServiceClock
+{
+public:
+	virtual ~IServiceClock() {}
+
+	virtual t_service_timepoint now() const = 0;
+};
+
+// The wall clock. This is the default service clock.
+class RealtimeServiceClock : public IServiceClock
+{
+public:
+	t_service_timepoint now() const override
+	{
+		return std::chrono::high_resolution_clock::now();
+	}
+};
+
+// A clock that only moves when it's told to.
+// Lets a session replay stamp packets with their recorded times no matter how fast it plays them back.
+// Time never goes backwards: requests to step the clock into the past are ignored.
+class SteppedServiceClock : public IServiceClock
+{
+public:
+	SteppedServiceClock(const t_service_timepoint start_time);
+
+	t_service_timepoint now() const override;
+
+	void advanceTo(const t_service_timepoint new_time);
+	void advanceBy(const t_service_duration delta_time);
+
+private:
+	std::atomic<int64_t> m_nowTicks; // t_service_duration ticks since the clock epoch
+};
+
+namespace ServiceClock
+{
+	// Returns the clock the pipeline is currently using
+	IServiceClock *getClock();
+
+	// Swap in a different clock (nullptr restores the realtime clock).
+	// Only do this while no devices are open: mixing timestamps from two clocks confuses the filters.
+	void setClock(IServiceClock *clock);
+
+	inline t_service_timepoint now()
+	{
+		return getClock()->now();
+	}
+};
+
+#endif // SERVICE_CLOCK_H
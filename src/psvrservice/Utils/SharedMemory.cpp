@@ -0,0 +1,231 @@
+// -- includes -----
+#include "SharedMemory.h"
+#include "Logger.h"
+
+#include <string.h>
+
+#if defined WIN32 || defined _WIN32 || defined WINCE
+    #include <windows.h>
+#else
+    #include <errno.h>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+// -- public interface -----
+SharedMemory::SharedMemory()
+	: m_name()
+	, m_data(nullptr)
+	, m_size(0)
+	, m_bIsOwner(false)
+#if defined WIN32 || defined _WIN32 || defined WINCE
+	, m_mappingHandle(nullptr)
+#endif
+{
+}
+
+SharedMemory::~SharedMemory()
+{
+	close();
+}
+
+#if defined WIN32 || defined _WIN32 || defined WINCE
+std::string SharedMemory::getSystemName(const std::string &name)
+{
+	// Session local, so no special privileges are needed to create it
+	return std::string("Local\\psvr_") + name;
+}
+
+bool SharedMemory::create(const std::string &name, size_t size)
+{
+	close();
+
+	const std::string system_name= getSystemName(name);
+	const unsigned long long mapping_size= static_cast<unsigned long long>(size);
+
+	// A pagefile backed mapping starts out zero filled and goes away with the last handle,
+	// so there is never a stale region to clean up
+	m_mappingHandle= CreateFileMappingA(
+		INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+		static_cast<DWORD>(mapping_size >> 32), static_cast<DWORD>(mapping_size & 0xffffffff),
+		system_name.c_str());
+	if (m_mappingHandle == nullptr)
+	{
+		PSVR_LOG_ERROR("SharedMemory::create") << "Failed to create shared memory " << system_name << " (error " << GetLastError() << ")";
+		return false;
+	}
+
+	if (GetLastError() == ERROR_ALREADY_EXISTS)
+	{
+		PSVR_LOG_ERROR("SharedMemory::create") << "Shared memory " << system_name << " is already in use";
+		close();
+		return false;
+	}
+
+	m_data= static_cast<unsigned char *>(MapViewOfFile(m_mappingHandle, FILE_MAP_ALL_ACCESS, 0, 0, size));
+	if (m_data == nullptr)
+	{
+		close();
+		return false;
+	}
+
+	m_name= name;
+	m_size= size;
+	m_bIsOwner= true;
+
+	return true;
+}
+
+bool SharedMemory::open(const std::string &name, bool bReadOnly)
+{
+	close();
+
+	const std::string system_name= getSystemName(name);
+	const DWORD access= bReadOnly ? FILE_MAP_READ : FILE_MAP_ALL_ACCESS;
+
+	m_mappingHandle= OpenFileMappingA(access, FALSE, system_name.c_str());
+	if (m_mappingHandle == nullptr)
+		return false;
+
+	m_data= static_cast<unsigned char *>(MapViewOfFile(m_mappingHandle, access, 0, 0, 0));
+	if (m_data == nullptr)
+	{
+		close();
+		return false;
+	}
+
+	// The view is rounded up to whole pages, which is as close to the created size as Windows will tell us
+	MEMORY_BASIC_INFORMATION memory_info;
+	if (VirtualQuery(m_data, &memory_info, sizeof(memory_info)) == 0)
+	{
+		close();
+		return false;
+	}
+
+	m_name= name;
+	m_size= static_cast<size_t>(memory_info.RegionSize);
+	m_bIsOwner= false;
+
+	return true;
+}
+
+void SharedMemory::close()
+{
+	if (m_data != nullptr)
+	{
+		UnmapViewOfFile(m_data);
+		m_data= nullptr;
+	}
+
+	if (m_mappingHandle != nullptr)
+	{
+		CloseHandle(m_mappingHandle);
+		m_mappingHandle= nullptr;
+	}
+
+	m_name= "";
+	m_size= 0;
+	m_bIsOwner= false;
+}
+#else
+std::string SharedMemory::getSystemName(const std::string &name)
+{
+	// POSIX names are a single path component with a leading slash
+	return std::string("/psvr_") + name;
+}
+
+bool SharedMemory::create(const std::string &name, size_t size)
+{
+	close();
+
+	const std::string system_name= getSystemName(name);
+
+	// Clear out a region left behind by a service that didn't shut down cleanly
+	shm_unlink(system_name.c_str());
+
+	const int fd= shm_open(system_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+	if (fd < 0)
+	{
+		PSVR_LOG_ERROR("SharedMemory::create") << "Failed to create shared memory " << system_name << ": " << strerror(errno);
+		return false;
+	}
+
+	// A freshly sized shm object reads back as zeros
+	if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+	{
+		PSVR_LOG_ERROR("SharedMemory::create") << "Failed to size shared memory " << system_name << ": " << strerror(errno);
+		::close(fd);
+		shm_unlink(system_name.c_str());
+		return false;
+	}
+
+	// The mapping stays valid after the descriptor is closed
+	void *data= mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+
+	if (data == MAP_FAILED)
+	{
+		shm_unlink(system_name.c_str());
+		return false;
+	}
+
+	m_name= name;
+	m_data= static_cast<unsigned char *>(data);
+	m_size= size;
+	m_bIsOwner= true;
+
+	return true;
+}
+
+bool SharedMemory::open(const std::string &name, bool bReadOnly)
+{
+	close();
+
+	const std::string system_name= getSystemName(name);
+
+	const int fd= shm_open(system_name.c_str(), bReadOnly ? O_RDONLY : O_RDWR, 0);
+	if (fd < 0)
+		return false;
+
+	struct stat shm_stat;
+	if (fstat(fd, &shm_stat) != 0 || shm_stat.st_size == 0)
+	{
+		::close(fd);
+		return false;
+	}
+
+	const size_t size= static_cast<size_t>(shm_stat.st_size);
+	void *data= mmap(nullptr, size, bReadOnly ? PROT_READ : (PROT_READ | PROT_WRITE), MAP_SHARED, fd, 0);
+	::close(fd);
+
+	if (data == MAP_FAILED)
+		return false;
+
+	m_name= name;
+	m_data= static_cast<unsigned char *>(data);
+	m_size= size;
+	m_bIsOwner= false;
+
+	return true;
+}
+
+void SharedMemory::close()
+{
+	if (m_data != nullptr)
+	{
+		munmap(m_data, m_size);
+		m_data= nullptr;
+
+		if (m_bIsOwner)
+		{
+			shm_unlink(getSystemName(m_name).c_str());
+		}
+	}
+
+	m_name= "";
+	m_size= 0;
+	m_bIsOwner= false;
+}
+#endif
@@ -0,0 +1,48 @@
+#ifndef SHARED_MEMORY_H
+#define SHARED_MEMORY_H
+
+//-- includes -----
+#include <stddef.h>
+#include <string>
+
+//-- definitions -----
+// A named region of memory that other processes can map by the same name
+// (POSIX shm_open on Linux/OSX, a pagefile backed file mapping on Windows)
+class SharedMemory
+{
+public:
+	SharedMemory();
+	~SharedMemory();
+
+	// Creates a zero filled read/write region, replacing any stale region of the same name.
+	// The name is removed again when the creator closes it (processes that already mapped it keep their view).
+	bool create(const std::string &name, size_t size);
+
+	// Maps an existing region made by another SharedMemory::create()
+	bool open(const std::string &name, bool bReadOnly);
+
+	void close();
+
+	inline bool getIsOpen() const { return m_data != nullptr; }
+	inline bool getIsOwner() const { return m_bIsOwner; }
+	inline unsigned char *getData() const { return m_data; }
+	inline size_t getSize() const { return m_size; }
+
+	// The platform name the region is actually registered under
+	static std::string getSystemName(const std::string &name);
+
+private:
+	std::string m_name;
+	unsigned char *m_data;
+	size_t m_size;
+	bool m_bIsOwner;
+
+#if defined WIN32 || defined _WIN32 || defined WINCE
+	void *m_mappingHandle;
+#endif
+
+	SharedMemory(const SharedMemory&);
+	void operator=(const SharedMemory&);
+};
+
+#endif // SHARED_MEMORY_H
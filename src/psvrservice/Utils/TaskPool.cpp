@@ -0,0 +1,128 @@
+#include "TaskPool.h"
+#include "Utility.h"
+#include "Logger.h"
+#include "TimelineTrace.h"
+
+#include <algorithm>
+
+TaskPool::TaskPool(const std::string &pool_name, int worker_count)
+	: m_poolName(pool_name)
+	, m_exitSignaled(false)
+{
+	PSVR_LOG_INFO("TaskPool::TaskPool") << "Starting task pool " << m_poolName << " with " << worker_count << " workers";
+
+	for (int worker_index = 0; worker_index < worker_count; ++worker_index)
+	{
+		m_workerThreads.push_back(std::thread(&TaskPool::workerThreadFunc, this, worker_index));
+	}
+}
+
+TaskPool::~TaskPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_exitSignaled= true;
+	}
+	m_batchPostedCondition.notify_all();
+
+	for (std::thread &worker_thread : m_workerThreads)
+	{
+		worker_thread.join();
+	}
+
+	PSVR_LOG_INFO("TaskPool::~TaskPool") << "Stopped task pool " << m_poolName;
+}
+
+void TaskPool::parallelFor(int task_count, const std::function<void(int)> &task)
+{
+	parallelForWithSlots(task_count, [&task](int task_index, int worker_slot) {
+		task(task_index);
+	});
+}
+
+void TaskPool::parallelForWithSlots(int task_count, const std::function<void(int, int)> &task)
+{
+	// Not worth waking anyone up
+	if (task_count <= 1 || m_workerThreads.empty())
+	{
+		for (int task_index = 0; task_index < task_count; ++task_index)
+		{
+			task(task_index, 0);
+		}
+
+		return;
+	}
+
+	TaskBatch batch;
+	batch.task= &task;
+	batch.task_count= task_count;
+	batch.next_task_index= 0;
+	batch.active_worker_count= 0;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_pendingBatches.push_back(&batch);
+	}
+	m_batchPostedCondition.notify_all();
+
+	// Help out rather than sit idle
+	runBatchTasks(&batch, 0);
+
+	// Every task has been claimed at this point.
+	// Take the batch out of the queue so no new worker picks it up,
+	// then wait for the workers still running one of its tasks.
+	std::unique_lock<std::mutex> lock(m_mutex);
+	auto it= std::find(m_pendingBatches.begin(), m_pendingBatches.end(), &batch);
+	if (it != m_pendingBatches.end())
+	{
+		m_pendingBatches.erase(it);
+	}
+	m_batchFinishedCondition.wait(lock, [&batch] { return batch.active_worker_count == 0; });
+}
+
+void TaskPool::workerThreadFunc(int worker_index)
+{
+	char thread_name[32];
+	Utility::format_string(thread_name, sizeof(thread_name), "%s%d", m_poolName.c_str(), worker_index);
+	Utility::set_current_thread_name(thread_name);
+	PSVR_TRACE_THREAD_NAME(thread_name);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (true)
+	{
+		m_batchPostedCondition.wait(lock, [this] { return m_exitSignaled || !m_pendingBatches.empty(); });
+
+		if (m_exitSignaled)
+			break;
+
+		TaskBatch *batch= m_pendingBatches.front();
+		++batch->active_worker_count;
+
+		lock.unlock();
+		{
+			PSVR_TRACE_ZONE("Task Batch");
+			runBatchTasks(batch, worker_index + 1);
+		}
+		lock.lock();
+
+		// All of the batch's tasks are claimed, don't let other workers pick it up again
+		if (!m_pendingBatches.empty() && m_pendingBatches.front() == batch)
+		{
+			m_pendingBatches.pop_front();
+		}
+
+		--batch->active_worker_count;
+		m_batchFinishedCondition.notify_all();
+	}
+}
+
+void TaskPool::runBatchTasks(TaskBatch *batch, int worker_slot)
+{
+	int task_index= batch->next_task_index++;
+
+	while (task_index < batch->task_count)
+	{
+		(*batch->task)(task_index, worker_slot);
+		task_index= batch->next_task_index++;
+	}
+}
@@ -0,0 +1,63 @@
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// A fixed set of worker threads that fork-join batches of small tasks.
+// Several threads may submit batches at the same time; the batches are worked off in order.
+class TaskPool
+{
+public:
+	TaskPool(const std::string &pool_name, int worker_count);
+	~TaskPool();
+
+	inline int getWorkerCount() const
+	{
+		return static_cast<int>(m_workerThreads.size());
+	}
+
+	// Number of distinct worker slots a parallelForWithSlots() task can be handed (workers + the caller)
+	inline int getSlotCount() const
+	{
+		return getWorkerCount() + 1;
+	}
+
+	// Runs task(0) ... task(task_count-1) on the pool workers and the calling thread.
+	// Blocks until every task has finished.
+	void parallelFor(int task_count, const std::function<void(int)> &task);
+
+	// Same as parallelFor(), but also passes each task the slot of the thread running it:
+	// 0 for the calling thread, [1, getSlotCount()) for the pool workers.
+	// No two tasks of the same call run on the same slot at once, so slots can index per-thread scratch data.
+	void parallelForWithSlots(int task_count, const std::function<void(int task_index, int worker_slot)> &task);
+
+private:
+	struct TaskBatch
+	{
+		const std::function<void(int, int)> *task;
+		int task_count;
+		std::atomic_int next_task_index;
+		int active_worker_count; // guarded by m_mutex
+	};
+
+	void workerThreadFunc(int worker_index);
+	static void runBatchTasks(TaskBatch *batch, int worker_slot);
+
+	const std::string m_poolName;
+	std::vector<std::thread> m_workerThreads;
+
+	std::mutex m_mutex;
+	std::condition_variable m_batchPostedCondition;
+	std::condition_variable m_batchFinishedCondition;
+	std::deque<TaskBatch *> m_pendingBatches;
+	bool m_exitSignaled;
+};
+
+#endif // TASK_POOL_H
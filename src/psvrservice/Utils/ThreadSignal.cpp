@@ -0,0 +1,68 @@
+//-- includes -----
+#include "ThreadSignal.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif !defined(__x86_64__) && !defined(__i386__) && !defined(__aarch64__)
+#include <thread>
+#endif
+
+//-- private methods -----
+// Tells the core we're in a spin loop (cheaper for a hyperthreaded sibling than hammering the cache line)
+static inline void cpu_relax()
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	_mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__)
+	asm volatile("yield");
+#else
+	std::this_thread::yield();
+#endif
+}
+
+//-- implementation -----
+ThreadSignal::ThreadSignal()
+	: m_bSignaled(false)
+	, m_waiterCount(0)
+{
+}
+
+void ThreadSignal::notify()
+{
+	m_bSignaled.store(true);
+
+	// The waiter bumps the count before it checks the signal under the lock,
+	// so either it sees the signal or we see it waiting
+	if (m_waiterCount.load() > 0)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_condition.notify_one();
+	}
+}
+
+bool ThreadSignal::wait(const std::chrono::microseconds &timeout, int spin_count)
+{
+	// A producer that's about to post is usually only a few microseconds away
+	for (int spin = 0; spin < spin_count; ++spin)
+	{
+		if (m_bSignaled.exchange(false))
+		{
+			return true;
+		}
+
+		cpu_relax();
+	}
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	++m_waiterCount;
+	const bool bSignaled=
+		m_condition.wait_for(lock, timeout, [this]() {
+			return m_bSignaled.exchange(false);
+		});
+	--m_waiterCount;
+
+	return bSignaled;
+}
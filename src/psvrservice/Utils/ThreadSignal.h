@@ -0,0 +1,43 @@
+#ifndef THREAD_SIGNAL_H
+#define THREAD_SIGNAL_H
+
+//-- includes -----
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+//-- definitions -----
+// Auto-reset event that one consumer thread waits on and any number of producer threads notify.
+// A notify() that arrives while nobody is waiting is latched, so the next wait() returns right away
+// (notifies that pile up before the consumer gets to them collapse into one wakeup).
+// notify() only takes the lock when the consumer is actually parked, so producers can afford
+// to call it for every item they post.
+class ThreadSignal
+{
+public:
+	ThreadSignal();
+
+	void notify();
+
+	// Spins for up to spin_count checks of the signal before parking the thread on a condition variable.
+	// Returns true if signaled, false if the timeout ran out first.
+	bool wait(const std::chrono::microseconds &timeout, int spin_count= 0);
+
+	// Drops a pending signal
+	inline void reset()
+	{
+		m_bSignaled.store(false);
+	}
+
+private:
+	std::atomic_bool m_bSignaled;
+	std::atomic_int m_waiterCount;
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+
+	ThreadSignal(const ThreadSignal &copy) = delete;
+	ThreadSignal &operator=(const ThreadSignal &copy) = delete;
+};
+
+#endif // THREAD_SIGNAL_H
@@ -0,0 +1,400 @@
+//-- includes -----
+#include "TimelineTrace.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _MSC_VER
+#pragma warning (disable: 4996) // 'This function or variable may be unsafe': fopen, strncpy
+#endif
+
+//-- statics -----
+std::atomic<bool> TimelineTrace::g_bIsRecording(false);
+
+#ifdef PSVR_ENABLE_TIMELINE_TRACE
+
+//-- constants -----
+static const uint64_t k_trace_event_capacity= 16384;
+static const int k_max_traced_threads= 64;
+static const size_t k_max_thread_name_length= 32;
+static const int64_t k_instant_event_duration= -1;
+
+//-- definitions -----
+struct TimelineTraceEvent
+{
+	const char *name;
+	int64_t start_ns;
+	int64_t duration_ns; // k_instant_event_duration for instant events
+};
+
+struct TimelineTraceThreadBuffer
+{
+	char thread_name[k_max_thread_name_length];
+	int thread_index;
+	// Cleared when the owning thread exits so another thread can take the buffer over
+	std::atomic<bool> bInUse;
+	// The recording the events in the ring belong to
+	std::atomic<uint32_t> generation;
+	// Total events written for this generation, the ring holds the newest k_trace_event_capacity of them
+	std::atomic<uint64_t> write_count;
+	TimelineTraceEvent events[k_trace_event_capacity];
+};
+
+// Per thread state, hands the buffer back for reuse when the thread exits
+struct TimelineTraceThreadState
+{
+	TimelineTraceThreadBuffer *buffer;
+	char thread_name[k_max_thread_name_length];
+	bool bOutOfBuffers;
+
+	TimelineTraceThreadState()
+		: buffer(nullptr)
+		, bOutOfBuffers(false)
+	{
+		thread_name[0]= '\0';
+	}
+
+	~TimelineTraceThreadState()
+	{
+		if (buffer != nullptr)
+		{
+			buffer->bInUse.store(false, std::memory_order_release);
+		}
+	}
+};
+
+//-- globals -----
+static std::mutex g_threadBufferMutex;
+static std::vector<TimelineTraceThreadBuffer *> g_threadBuffers;
+static std::atomic<uint32_t> g_recordingGeneration(0);
+static std::atomic<int64_t> g_recordingStartTime(0);
+static thread_local TimelineTraceThreadState g_threadState;
+
+//-- private methods -----
+static TimelineTraceThreadBuffer *get_thread_buffer();
+static void copy_thread_name(char *out_name, const char *thread_name);
+static void record_event(const char *name, int64_t start_ns, int64_t duration_ns);
+static void write_thread_events(FILE *fp, const TimelineTraceThreadBuffer *buffer, uint32_t generation, int64_t start_time, bool &bFirstEvent);
+static void write_json_string(FILE *fp, const char *text);
+
+//-- public methods -----
+bool TimelineTrace::isEnabled()
+{
+	return true;
+}
+
+void TimelineTrace::startRecording()
+{
+	// Writers notice the new generation on their next event and restart their rings
+	g_recordingStartTime.store(getTimestampNanoseconds(), std::memory_order_relaxed);
+	g_recordingGeneration.fetch_add(1, std::memory_order_release);
+	g_bIsRecording.store(true, std::memory_order_relaxed);
+}
+
+void TimelineTrace::stopRecording()
+{
+	g_bIsRecording.store(false, std::memory_order_relaxed);
+}
+
+bool TimelineTrace::writeChromeTrace(const std::string &path)
+{
+	FILE *fp= fopen(path.c_str(), "wt");
+	if (fp == nullptr)
+	{
+		PSVR_LOG_ERROR("TimelineTrace::writeChromeTrace") << "Failed to open " << path << " for writing";
+		return false;
+	}
+
+	const uint32_t generation= g_recordingGeneration.load(std::memory_order_acquire);
+	const int64_t start_time= g_recordingStartTime.load(std::memory_order_relaxed);
+
+	fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+	bool bFirstEvent= true;
+	{
+		std::lock_guard<std::mutex> lock(g_threadBufferMutex);
+
+		for (const TimelineTraceThreadBuffer *buffer : g_threadBuffers)
+		{
+			write_thread_events(fp, buffer, generation, start_time, bFirstEvent);
+		}
+	}
+
+	fprintf(fp, "\n]}\n");
+
+	const bool bSuccess= ferror(fp) == 0;
+	fclose(fp);
+
+	if (bSuccess)
+	{
+		PSVR_LOG_INFO("TimelineTrace::writeChromeTrace") << "Wrote timeline trace to " << path;
+	}
+	else
+	{
+		PSVR_LOG_ERROR("TimelineTrace::writeChromeTrace") << "Failed writing timeline trace to " << path;
+	}
+
+	return bSuccess;
+}
+
+void TimelineTrace::setThreadName(const char *thread_name)
+{
+	copy_thread_name(g_threadState.thread_name, thread_name);
+
+	// writeChromeTrace reads the names of registered buffers under the same lock
+	if (g_threadState.buffer != nullptr)
+	{
+		std::lock_guard<std::mutex> lock(g_threadBufferMutex);
+
+		copy_thread_name(g_threadState.buffer->thread_name, thread_name);
+	}
+}
+
+void TimelineTrace::recordZone(const char *zone_name, int64_t start_ns, int64_t end_ns)
+{
+	record_event(zone_name, start_ns, std::max(end_ns - start_ns, int64_t(0)));
+}
+
+void TimelineTrace::recordInstant(const char *event_name)
+{
+	if (getIsRecording())
+	{
+		record_event(event_name, getTimestampNanoseconds(), k_instant_event_duration);
+	}
+}
+
+//-- private methods -----
+static TimelineTraceThreadBuffer *get_thread_buffer()
+{
+	if (g_threadState.buffer == nullptr && !g_threadState.bOutOfBuffers)
+	{
+		std::lock_guard<std::mutex> lock(g_threadBufferMutex);
+		TimelineTraceThreadBuffer *buffer= nullptr;
+
+		// Take over the buffer of a thread that has exited, before making a new one.
+		// Buffers still holding events of the current recording are left alone so they make it into the trace.
+		const uint32_t generation= g_recordingGeneration.load(std::memory_order_acquire);
+		for (TimelineTraceThreadBuffer *existing_buffer : g_threadBuffers)
+		{
+			if (!existing_buffer->bInUse.load(std::memory_order_acquire) &&
+				existing_buffer->generation.load(std::memory_order_relaxed) != generation)
+			{
+				buffer= existing_buffer;
+				break;
+			}
+		}
+
+		if (buffer == nullptr && static_cast<int>(g_threadBuffers.size()) < k_max_traced_threads)
+		{
+			buffer= new TimelineTraceThreadBuffer;
+			buffer->thread_index= static_cast<int>(g_threadBuffers.size());
+			g_threadBuffers.push_back(buffer);
+		}
+
+		if (buffer != nullptr)
+		{
+			if (g_threadState.thread_name[0] != '\0')
+			{
+				copy_thread_name(buffer->thread_name, g_threadState.thread_name);
+			}
+			else
+			{
+				snprintf(buffer->thread_name, sizeof(buffer->thread_name), "Thread %d", buffer->thread_index);
+			}
+
+			// Generation 0 never matches a recording, so the reused ring reads as empty until the first write
+			buffer->generation.store(0, std::memory_order_relaxed);
+			buffer->write_count.store(0, std::memory_order_relaxed);
+			buffer->bInUse.store(true, std::memory_order_relaxed);
+
+			g_threadState.buffer= buffer;
+		}
+		else
+		{
+			PSVR_LOG_WARNING("TimelineTrace") << "More than " << k_max_traced_threads << " traced threads, ignoring the rest";
+			g_threadState.bOutOfBuffers= true;
+		}
+	}
+
+	return g_threadState.buffer;
+}
+
+static void copy_thread_name(char *out_name, const char *thread_name)
+{
+	strncpy(out_name, thread_name, k_max_thread_name_length - 1);
+	out_name[k_max_thread_name_length - 1]= '\0';
+}
+
+static void record_event(const char *name, int64_t start_ns, int64_t duration_ns)
+{
+	TimelineTraceThreadBuffer *buffer= get_thread_buffer();
+	if (buffer == nullptr)
+	{
+		return;
+	}
+
+	const uint32_t generation= g_recordingGeneration.load(std::memory_order_acquire);
+	if (buffer->generation.load(std::memory_order_relaxed) != generation)
+	{
+		// First event of a new recording, drop whatever the ring held from the last one
+		buffer->write_count.store(0, std::memory_order_relaxed);
+		buffer->generation.store(generation, std::memory_order_release);
+	}
+
+	// Single writer, so a plain load + store of the count is enough
+	const uint64_t write_count= buffer->write_count.load(std::memory_order_relaxed);
+	TimelineTraceEvent &event= buffer->events[write_count % k_trace_event_capacity];
+	event.name= name;
+	event.start_ns= start_ns;
+	event.duration_ns= duration_ns;
+
+	// Publish the event to the reader
+	buffer->write_count.store(write_count + 1, std::memory_order_release);
+}
+
+static void write_thread_events(
+	FILE *fp,
+	const TimelineTraceThreadBuffer *buffer,
+	uint32_t generation,
+	int64_t start_time,
+	bool &bFirstEvent)
+{
+	if (buffer->generation.load(std::memory_order_acquire) != generation)
+	{
+		return;
+	}
+
+	// Copy the ring out first, then throw away any slot the writer may have lapped while we were copying
+	const uint64_t end_index= buffer->write_count.load(std::memory_order_acquire);
+	const uint64_t begin_index= end_index > k_trace_event_capacity ? end_index - k_trace_event_capacity : 0;
+
+	std::vector<TimelineTraceEvent> events;
+	events.reserve(static_cast<size_t>(end_index - begin_index));
+	for (uint64_t event_index = begin_index; event_index < end_index; ++event_index)
+	{
+		events.push_back(buffer->events[event_index % k_trace_event_capacity]);
+	}
+
+	std::atomic_thread_fence(std::memory_order_acquire);
+	if (buffer->generation.load(std::memory_order_relaxed) != generation)
+	{
+		return;
+	}
+
+	const uint64_t lapped_end_index= buffer->write_count.load(std::memory_order_relaxed);
+	const uint64_t valid_begin_index=
+		std::max(begin_index, lapped_end_index > k_trace_event_capacity ? lapped_end_index - k_trace_event_capacity : 0);
+
+	fprintf(fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":",
+		bFirstEvent ? "" : ",\n", buffer->thread_index);
+	write_json_string(fp, buffer->thread_name);
+	fputs("}}", fp);
+	bFirstEvent= false;
+
+	for (uint64_t event_index = valid_begin_index; event_index < end_index; ++event_index)
+	{
+		const TimelineTraceEvent &event= events[static_cast<size_t>(event_index - begin_index)];
+
+		// Zones started before the recording did would show up at negative times
+		if (event.start_ns < start_time)
+		{
+			continue;
+		}
+
+		const double timestamp_us= static_cast<double>(event.start_ns - start_time) / 1000.0;
+
+		fputs(",\n{\"name\":", fp);
+		write_json_string(fp, event.name);
+		if (event.duration_ns == k_instant_event_duration)
+		{
+			fprintf(fp, ",\"cat\":\"psvr\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%d,\"ts\":%.3f}",
+				buffer->thread_index, timestamp_us);
+		}
+		else
+		{
+			fprintf(fp, ",\"cat\":\"psvr\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+				buffer->thread_index, timestamp_us, static_cast<double>(event.duration_ns) / 1000.0);
+		}
+	}
+}
+
+// Writes the text as a quoted JSON string.
+// Thread and zone names are whatever the caller passed in, so escape anything JSON doesn't allow in a string.
+static void write_json_string(FILE *fp, const char *text)
+{
+	fputc('"', fp);
+	for (const char *c = text; *c != '\0'; ++c)
+	{
+		const unsigned char ch= static_cast<unsigned char>(*c);
+
+		switch (ch)
+		{
+		case '"':
+			fputs("\\\"", fp);
+			break;
+		case '\\':
+			fputs("\\\\", fp);
+			break;
+		case '\n':
+			fputs("\\n", fp);
+			break;
+		case '\r':
+			fputs("\\r", fp);
+			break;
+		case '\t':
+			fputs("\\t", fp);
+			break;
+		default:
+			if (ch < 0x20)
+			{
+				fprintf(fp, "\\u%04x", ch);
+			}
+			else
+			{
+				fputc(ch, fp);
+			}
+			break;
+		}
+	}
+	fputc('"', fp);
+}
+
+#else
+
+//-- public methods -----
+bool TimelineTrace::isEnabled()
+{
+	return false;
+}
+
+void TimelineTrace::startRecording()
+{
+	PSVR_LOG_WARNING("TimelineTrace::startRecording") << "Service built without PSVR_ENABLE_TIMELINE_TRACE, nothing will be recorded";
+}
+
+void TimelineTrace::stopRecording()
+{
+}
+
+bool TimelineTrace::writeChromeTrace(const std::string &path)
+{
+	return false;
+}
+
+void TimelineTrace::setThreadName(const char *thread_name)
+{
+}
+
+void TimelineTrace::recordZone(const char *zone_name, int64_t start_ns, int64_t end_ns)
+{
+}
+
+void TimelineTrace::recordInstant(const char *event_name)
+{
+}
+
+#endif // PSVR_ENABLE_TIMELINE_TRACE
@@ -0,0 +1,85 @@
+#ifndef TIMELINE_TRACE_H
+#define TIMELINE_TRACE_H
+
+//-- includes -----
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+#include <string>
+
+//-- definitions -----
+// Timeline tracing of the service threads, viewable in chrome://tracing or ui.perfetto.dev.
+// Every thread records its zones into its own fixed size ring buffer (single writer, no locks),
+// so a recording always holds the most recent ~16k zones per thread.
+// The zones are only compiled in when the service is built with PSVR_ENABLE_TIMELINE_TRACE,
+// and even then a zone costs a single relaxed load while no recording is running.
+namespace TimelineTrace
+{
+	bool isEnabled();
+
+	// Discards anything recorded so far and starts a new recording
+	void startRecording();
+	void stopRecording();
+
+	extern std::atomic<bool> g_bIsRecording;
+	inline bool getIsRecording()
+	{
+		return g_bIsRecording.load(std::memory_order_relaxed);
+	}
+
+	// Writes the zones recorded by every thread as Chrome trace event JSON.
+	// Safe to call while the recording is still running.
+	bool writeChromeTrace(const std::string &path);
+
+	// Name shown for the calling thread's track in the timeline
+	void setThreadName(const char *thread_name);
+
+	// Zone names must be string literals (only the pointer is stored)
+	void recordZone(const char *zone_name, int64_t start_ns, int64_t end_ns);
+	void recordInstant(const char *event_name);
+
+	inline int64_t getTimestampNanoseconds()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+	}
+};
+
+// Records the time from construction to destruction as a zone on the calling thread's track
+class TimelineTraceZone
+{
+public:
+	TimelineTraceZone(const char *zone_name)
+		: m_zoneName(TimelineTrace::getIsRecording() ? zone_name : nullptr)
+		, m_startTime(m_zoneName != nullptr ? TimelineTrace::getTimestampNanoseconds() : 0)
+	{}
+
+	~TimelineTraceZone()
+	{
+		if (m_zoneName != nullptr)
+		{
+			TimelineTrace::recordZone(m_zoneName, m_startTime, TimelineTrace::getTimestampNanoseconds());
+		}
+	}
+
+private:
+	const char *m_zoneName;
+	int64_t m_startTime;
+
+	TimelineTraceZone(const TimelineTraceZone&);
+	void operator=(const TimelineTraceZone&);
+};
+
+#ifdef PSVR_ENABLE_TIMELINE_TRACE
+	#define PSVR_TRACE_CONCAT_INNER(a, b) a##b
+	#define PSVR_TRACE_CONCAT(a, b) PSVR_TRACE_CONCAT_INNER(a, b)
+	#define PSVR_TRACE_ZONE(zone_name) TimelineTraceZone PSVR_TRACE_CONCAT(trace_zone_, __LINE__)(zone_name)
+	#define PSVR_TRACE_INSTANT(event_name) TimelineTrace::recordInstant(event_name)
+	#define PSVR_TRACE_THREAD_NAME(thread_name) TimelineTrace::setThreadName(thread_name)
+#else
+	#define PSVR_TRACE_ZONE(zone_name)
+	#define PSVR_TRACE_INSTANT(event_name)
+	#define PSVR_TRACE_THREAD_NAME(thread_name)
+#endif
+
+#endif // TIMELINE_TRACE_H
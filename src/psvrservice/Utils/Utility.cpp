@@ -29,6 +29,8 @@
 	#include <dirent.h>
 	#include <time.h>
 	#include <unistd.h>
+	#include <pthread.h>
+	#include <sched.h>
 
 	#if defined __MACH__ && defined __APPLE__
 		#include <mach/mach.h>
@@ -144,6 +146,36 @@ namespace Utility
     }
 #endif
 
+#if defined WIN32 || defined _WIN32 || defined WINCE
+    bool set_current_thread_affinity(int cpu_index)
+    {
+        if (cpu_index < 0 || cpu_index >= static_cast<int>(sizeof(DWORD_PTR)*8))
+            return false;
+
+        const DWORD_PTR affinity_mask= static_cast<DWORD_PTR>(1) << cpu_index;
+
+        return SetThreadAffinityMask(GetCurrentThread(), affinity_mask) != 0;
+    }
+#elif defined __linux__
+    bool set_current_thread_affinity(int cpu_index)
+    {
+        if (cpu_index < 0 || cpu_index >= CPU_SETSIZE)
+            return false;
+
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(cpu_index, &cpu_set);
+
+        return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0;
+    }
+#else
+    bool set_current_thread_affinity(int cpu_index)
+    {
+        // OSX only supports affinity hints (thread_policy_set), so leave the scheduler alone
+        return false;
+    }
+#endif
+
     void sleep_ms(int milliseconds)
     {
 #ifdef _MSC_VER
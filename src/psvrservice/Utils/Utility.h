@@ -57,6 +57,9 @@ namespace Utility
     /// Sets the name of the current thread
     void set_current_thread_name(const char* thread_name);
 
+    /// Pins the current thread to the given cpu core index. Returns false if not supported.
+    bool set_current_thread_affinity(int cpu_index);
+
     /// Sleeps the current thread for the given number of milliseconds
     void sleep_ms(int milliseconds);	
 
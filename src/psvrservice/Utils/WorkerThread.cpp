@@ -1,10 +1,14 @@
 #include "WorkerThread.h"
 #include "Utility.h"
 #include "Logger.h"
+#include "TimelineTrace.h"
 
 WorkerThread::WorkerThread(const std::string thread_name) 
 	: m_threadName(thread_name)
 	, m_exitSignaled({ false })
+	, m_cpuAffinity(-1)
+	, m_spinWaitCount(0)
+	, m_workSignal()
     , m_threadStarted(false)
 	, m_workerThread()
 {
@@ -15,6 +19,7 @@ void WorkerThread::startThread()
     if (!m_threadStarted)
     {
 		m_exitSignaled= false;
+		m_workSignal.reset();
 
         PSVR_LOG_INFO("WorkerThread::start") << "Starting worker thread: " << m_threadName;
 		onThreadStarted();
@@ -33,6 +38,7 @@ void WorkerThread::stopThread()
             PSVR_LOG_INFO("WorkerThread::stop") << "Stopping worker thread: " << m_threadName;
 			// Set the atomic exit flag
             m_exitSignaled.store(true);
+			m_workSignal.notify();
 
 			// Give the thread a chance to set any state in response to the exit flag getting set
 			onThreadHaltBegin();
@@ -57,6 +63,12 @@ void WorkerThread::stopThread()
 void WorkerThread::threadFunc()
 {
     Utility::set_current_thread_name(m_threadName.c_str());
+    PSVR_TRACE_THREAD_NAME(m_threadName.c_str());
+
+	if (m_cpuAffinity >= 0 && !Utility::set_current_thread_affinity(m_cpuAffinity))
+	{
+		PSVR_MT_LOG_WARNING("WorkerThread::threadFunc") << "Failed to set cpu affinity " << m_cpuAffinity << " for thread: " << m_threadName;
+	}
 
     // Stay in the poll loop until asked to exit by the main thread
     while (!m_exitSignaled)
@@ -1,7 +1,10 @@
 #ifndef WORKER_THREAD_H
 #define WORKER_THREAD_H
 
+#include "ThreadSignal.h"
+
 #include <atomic>
+#include <chrono>
 #include <string>
 #include <thread>
 
@@ -18,12 +21,39 @@ public:
     void startThread();
     void stopThread();
 
+	// Pin the worker thread to the given cpu core index (-1 = no affinity).
+	// Takes effect the next time the thread is started.
+	inline void setThreadAffinity(int cpu_index)
+	{
+		m_cpuAffinity= cpu_index;
+	}
+
+	// Number of times waitForWork() checks for a signal before parking the thread (0 = park right away).
+	// Spinning trades a little cpu for a faster wakeup when work arrives at a high rate.
+	inline void setSpinWaitCount(int spin_count)
+	{
+		m_spinWaitCount= spin_count;
+	}
+
+	// Wakes the worker thread if it's waiting in waitForWork(). Safe to call from any thread.
+	inline void signalWork()
+	{
+		m_workSignal.notify();
+	}
+
 protected:
 	virtual void onThreadStarted() { }
 	virtual void onThreadHaltBegin() { }
 	virtual void onThreadHaltComplete() { }
 	virtual bool doWork() = 0;
 
+	// Blocks the worker thread until signalWork() is called, the timeout runs out or the thread is stopped.
+	// Returns true if woken by a signal.
+	inline bool waitForWork(const std::chrono::microseconds &timeout)
+	{
+		return m_workSignal.wait(timeout, m_spinWaitCount);
+	}
+
 private:
 	void threadFunc();
 
@@ -31,6 +61,9 @@ protected:
     // Multithreaded state
 	const std::string m_threadName;
     std::atomic_bool m_exitSignaled;
+	int m_cpuAffinity;
+	int m_spinWaitCount;
+	ThreadSignal m_workSignal;
 
 	// Main Thread State
     bool m_threadStarted;
@@ -78,6 +78,7 @@ WMFMonoTracker::WMFMonoTracker()
     : m_cfg()
 	, m_videoDevice(nullptr)
     , m_DriverType(WMFMonoTracker::WindowsMediaFramework)
+	, m_listener(nullptr)
 {
 }
 
@@ -390,6 +391,12 @@ void WMFMonoTracker::setVideoProperty(const PSVRVideoPropertyType property_type,
 	{
 		m_cfg.video_properties[property_type] = desired_value;
 	}
+
+	// Media Foundation applies the property before returning
+	if (m_listener != nullptr)
+	{
+		m_listener->notifyVideoPropertyApplied(property_type, m_videoDevice->getVideoProperty(property_type), true);
+	}
 }
 
 int WMFMonoTracker::getVideoProperty(const PSVRVideoPropertyType property_type) const
@@ -466,4 +473,9 @@ void WMFMonoTracker::getTrackingColorPreset(
 void WMFMonoTracker::setTrackerListener(ITrackerListener *listener)
 {
 	m_listener= listener;
+}
+
+void WMFMonoTracker::getDeviceStatistics(PSVRTrackerStatistics &out_statistics) const
+{
+	// Windows Media Foundation doesn't expose its USB transfers
 }
\ No newline at end of file
@@ -111,6 +111,7 @@ WMFStereoTracker::WMFStereoTracker()
     : m_cfg()
 	, m_videoDevice(nullptr)
     , m_DriverType(WMFStereoTracker::WindowsMediaFramework)
+	, m_listener(nullptr)
 {
 }
 
@@ -422,6 +423,12 @@ void WMFStereoTracker::setVideoProperty(const PSVRVideoPropertyType property_typ
 	{
 		m_cfg.video_properties[property_type] = desired_value;
 	}
+
+	// Media Foundation applies the property before returning
+	if (m_listener != nullptr)
+	{
+		m_listener->notifyVideoPropertyApplied(property_type, m_videoDevice->getVideoProperty(property_type), true);
+	}
 }
 
 int WMFStereoTracker::getVideoProperty(const PSVRVideoPropertyType property_type) const
@@ -498,4 +505,9 @@ void WMFStereoTracker::getTrackingColorPreset(
 void WMFStereoTracker::setTrackerListener(ITrackerListener *listener)
 {
 	m_listener= listener;
+}
+
+void WMFStereoTracker::getDeviceStatistics(PSVRTrackerStatistics &out_statistics) const
+{
+	// Windows Media Foundation doesn't expose its USB transfers
 }
\ No newline at end of file
@@ -76,6 +76,7 @@ public:
     void setTrackingColorPreset(const std::string &controller_serial, PSVRTrackingColorType color, const PSVR_HSVColorRange *preset) override;
     void getTrackingColorPreset(const std::string &controller_serial, PSVRTrackingColorType color, PSVR_HSVColorRange *out_preset) const override;
 	void setTrackerListener(ITrackerListener *listener) override;
+	void getDeviceStatistics(PSVRTrackerStatistics &out_statistics) const override;
 
     // -- Getters
     inline const WMFStereoTrackerConfig &getConfig() const
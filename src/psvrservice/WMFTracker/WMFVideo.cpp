@@ -932,7 +932,9 @@ STDMETHODIMP WMFVideoFrameProcessor::OnProcessSample(REFGUID guidMajorMediaType,
 {
 	if (m_trackerListener)
 	{
-		m_trackerListener->notifyVideoFrameReceived(static_cast<const unsigned char *>(pSampleBuffer));
+		// Media Foundation sample times are relative to the start of the stream on its own clock,
+		// so the arrival of the sample is the best capture time we can put on the service clock
+		m_trackerListener->notifyVideoFrameReceived(static_cast<const unsigned char *>(pSampleBuffer), ServiceClock::now());
 	}
 
 	return S_OK;
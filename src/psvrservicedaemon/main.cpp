@@ -0,0 +1,112 @@
+//-- includes -----
+#include "LocalServiceServer.h"
+#include "PSVRService.h"
+#include <atomic>
+#include <chrono>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+
+//-- globals -----
+static std::atomic<bool> g_bExitRequested(false);
+
+//-- prototypes -----
+static void handle_exit_signal(int signal_number);
+static void print_usage();
+
+//-- entry point -----
+int
+main(int argc, char* argv[])
+{
+	std::string socket_path(PSVR_LOCAL_SERVICE_DEFAULT_SOCKET_PATH);
+	PSVRLogSeverityLevel log_level= PSVRLogSeverityLevel_info;
+	int update_interval_ms= 1;
+
+	for (int arg_index = 1; arg_index < argc; ++arg_index)
+	{
+		const char *arg= argv[arg_index];
+		const char *value= (arg_index + 1 < argc) ? argv[arg_index + 1] : nullptr;
+
+		if (strcmp(arg, "--help") == 0)
+		{
+			print_usage();
+			return EXIT_SUCCESS;
+		}
+		else if (value == nullptr)
+		{
+			fprintf(stderr, "Missing value for %s\n", arg);
+			print_usage();
+			return EXIT_FAILURE;
+		}
+		else if (strcmp(arg, "--socket") == 0)
+			socket_path= value;
+		else if (strcmp(arg, "--update-ms") == 0)
+			update_interval_ms= atoi(value);
+		else if (strcmp(arg, "--log-level") == 0)
+			log_level= static_cast<PSVRLogSeverityLevel>(atoi(value));
+		else
+		{
+			fprintf(stderr, "Unknown option %s\n", arg);
+			print_usage();
+			return EXIT_FAILURE;
+		}
+
+		++arg_index;
+	}
+
+	signal(SIGINT, handle_exit_signal);
+	signal(SIGTERM, handle_exit_signal);
+	// A client vanishing mid send shows up as a send error instead
+	signal(SIGPIPE, SIG_IGN);
+
+	PSVRService service;
+	LocalServiceServer server;
+
+	// The data frame region has to exist before the service publishes into it
+	if (!server.startup(socket_path))
+	{
+		fprintf(stderr, "Failed to start listening on %s\n", socket_path.c_str());
+		return EXIT_FAILURE;
+	}
+
+	if (!service.startup(log_level, &server, &server))
+	{
+		fprintf(stderr, "Failed to start PSVRService\n");
+		server.shutdown();
+		return EXIT_FAILURE;
+	}
+
+	// Requests are answered on the same thread that updates the service,
+	// so a client is never more than one update interval away from a response
+	while (!g_bExitRequested)
+	{
+		service.update();
+		server.poll();
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(update_interval_ms));
+	}
+
+	// Release every client's streams while the service can still act on it
+	server.shutdown();
+	service.shutdown();
+
+	return EXIT_SUCCESS;
+}
+
+//-- private functions -----
+static void handle_exit_signal(int signal_number)
+{
+	g_bExitRequested= true;
+}
+
+static void print_usage()
+{
+	fprintf(stdout,
+		"usage: psvrservice [options]\n"
+		"  --socket <path>      Local socket clients connect to (default " PSVR_LOCAL_SERVICE_DEFAULT_SOCKET_PATH ")\n"
+		"  --update-ms <ms>     Sleep between service updates (default 1)\n"
+		"  --log-level <level>  0=trace .. 5=fatal (default 2=info)\n");
+}
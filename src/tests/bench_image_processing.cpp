@@ -0,0 +1,163 @@
+//-- includes -----
+#include "benchmark.h"
+#include "PSVRConfig.h"
+#include "TrackerBlobExtractor.h"
+#include "TrackerImageProcessing.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+//-- constants -----
+static const int k_frame_width= 640;
+static const int k_frame_height= 480;
+static const int k_roi_width= 160;
+static const int k_roi_height= 120;
+static const int k_led_count= MAX_POINT_CLOUD_POINT_COUNT;
+static const int k_led_radius= 4;
+static const int k_mask_count= 4;
+
+//-- prototypes -----
+static void render_test_frame(std::vector<uint8_t> &out_bgr, std::vector<uint8_t> &out_bayer);
+
+//-- public interface -----
+// Micro-benchmarks for the per-frame segmentation stages (see ServerTrackerView::segmentFrame).
+// Runs on a fixed PS3Eye sized frame of blue LED blobs over a noisy background.
+void run_image_processing_benchmarks(BenchmarkSuite &suite)
+{
+	fprintf(stdout, "[image_processing]\n");
+
+	std::vector<uint8_t> bgr;
+	std::vector<uint8_t> bayer;
+	render_test_frame(bgr, bayer);
+
+	std::vector<uint8_t> debayered(k_frame_width*k_frame_height*3);
+	std::vector<uint8_t> bgr_row_scratch(k_frame_width*3);
+
+	// Blue is what the LEDs are drawn in. The other colors only add work, like extra tracked HMDs would.
+	const PSVRTrackingColorType mask_colors[k_mask_count]= {
+		PSVRTrackingColorType_Blue, PSVRTrackingColorType_Green, PSVRTrackingColorType_Red, PSVRTrackingColorType_Magenta
+	};
+	HSVColorThresholds thresholds[k_mask_count];
+	std::vector<uint8_t> mask_storage[k_mask_count];
+	uint8_t *masks[k_mask_count];
+	for (int mask_index = 0; mask_index < k_mask_count; ++mask_index)
+	{
+		thresholds[mask_index]= HSVColorThresholds::fromColorRange(k_default_color_presets[mask_colors[mask_index]]);
+		mask_storage[mask_index].resize(k_frame_width*k_frame_height);
+		masks[mask_index]= mask_storage[mask_index].data();
+	}
+
+	suite.runMicroBenchmark("image.debayer_grbg_to_bgr", [&]() {
+		debayerGRBGToBGR(k_frame_width, k_frame_height, bayer.data(), debayered.data(), true);
+	});
+
+	suite.runMicroBenchmark("image.hsv_mask_from_bgr", [&]() {
+		computeHSVMaskFromBGR(
+			bgr.data(), k_frame_width*3, k_frame_width, k_frame_height,
+			thresholds[0], masks[0], k_frame_width);
+	});
+
+	suite.runMicroBenchmark("image.hsv_masks_from_bgr_x4", [&]() {
+		computeHSVMasksFromBGR(
+			bgr.data(), k_frame_width*3, k_frame_width, k_frame_height,
+			thresholds, k_mask_count, masks, k_frame_width);
+	});
+
+	suite.runMicroBenchmark("image.hsv_masks_from_bayer_x4", [&]() {
+		computeHSVMasksFromBayerGRBG(
+			bayer.data(), k_frame_width, k_frame_height,
+			0, 0, k_frame_width, k_frame_height,
+			thresholds, k_mask_count, bgr_row_scratch.data(), masks, k_frame_width);
+	});
+
+	// Tracking with a valid ROI only segments a window around the predicted projection
+	const int roi_x= (k_frame_width - k_roi_width) / 2;
+	const int roi_y= (k_frame_height - k_roi_height) / 2;
+	suite.runMicroBenchmark("image.hsv_masks_from_bayer_roi_x4", [&]() {
+		computeHSVMasksFromBayerGRBG(
+			bayer.data(), k_frame_width, k_frame_height,
+			roi_x, roi_y, k_roi_width, k_roi_height,
+			thresholds, k_mask_count, bgr_row_scratch.data(), masks, k_frame_width);
+	});
+
+	// What OpenCVBufferState::computeBiggestNContours runs on every mask
+	computeHSVMaskFromBGR(
+		bgr.data(), k_frame_width*3, k_frame_width, k_frame_height,
+		thresholds[0], masks[0], k_frame_width);
+
+	TrackerBlobExtractor blob_extractor;
+	TrackerBlob blobs[k_led_count];
+	int blob_count= 0;
+	suite.runMicroBenchmark("image.extract_biggest_n_blobs", [&]() {
+		blob_count= blob_extractor.extractBiggestNBlobs(
+			masks[0], k_frame_width, k_frame_width, k_frame_height, 0, 0,
+			6, blobs, k_led_count);
+	});
+	if (blob_count != 0 && blob_count != k_led_count)
+	{
+		fprintf(stderr, "  Expected %d blobs in the test frame, found %d\n", k_led_count, blob_count);
+	}
+}
+
+//-- private functions -----
+static void render_test_frame(std::vector<uint8_t> &out_bgr, std::vector<uint8_t> &out_bayer)
+{
+	out_bgr.resize(k_frame_width*k_frame_height*3);
+	out_bayer.resize(k_frame_width*k_frame_height);
+
+	// Dim, slightly noisy background (deterministic so runs are comparable)
+	uint32_t seed= 12345;
+	for (size_t byte_index = 0; byte_index < out_bgr.size(); ++byte_index)
+	{
+		seed= seed*1664525u + 1013904223u;
+		out_bgr[byte_index]= static_cast<uint8_t>(32 + ((seed >> 24) & 0x1f));
+	}
+
+	// Saturated blue LED blobs, roughly arranged like the front of a headset
+	for (int led_index = 0; led_index < k_led_count; ++led_index)
+	{
+		const float angle= static_cast<float>(led_index) * 2.f * 3.14159265f / static_cast<float>(k_led_count);
+		const int center_x= k_frame_width/2 + static_cast<int>(120.f*cosf(angle));
+		const int center_y= k_frame_height/2 + static_cast<int>(80.f*sinf(angle));
+
+		for (int y = center_y - k_led_radius; y <= center_y + k_led_radius; ++y)
+		{
+			for (int x = center_x - k_led_radius; x <= center_x + k_led_radius; ++x)
+			{
+				const int dx= x - center_x;
+				const int dy= y - center_y;
+
+				if (dx*dx + dy*dy <= k_led_radius*k_led_radius)
+				{
+					uint8_t *pixel= &out_bgr[(y*k_frame_width + x)*3];
+					pixel[0]= 255;
+					pixel[1]= 16;
+					pixel[2]= 16;
+				}
+			}
+		}
+	}
+
+	// Mosaic into the GRBG layout the PS3Eye delivers
+	for (int y = 0; y < k_frame_height; ++y)
+	{
+		for (int x = 0; x < k_frame_width; ++x)
+		{
+			const uint8_t *pixel= &out_bgr[(y*k_frame_width + x)*3];
+			int channel;
+
+			if ((y & 1) == 0)
+			{
+				channel= ((x & 1) == 0) ? 1 : 2; // G R
+			}
+			else
+			{
+				channel= ((x & 1) == 0) ? 0 : 1; // B G
+			}
+
+			out_bayer[y*k_frame_width + x]= pixel[channel];
+		}
+	}
+}
@@ -0,0 +1,451 @@
+//-- includes -----
+#include "benchmark.h"
+#include "DeviceManager.h"
+#include "HeapAllocationCounter.h"
+#include "HMDManager.h"
+#include "PSVRConfig.h"
+#include "PSVRService.h"
+#include "PSVRServiceInterface.h"
+#include "ServerHMDView.h"
+#include "ServerTrackerView.h"
+#include "ServiceRequestHandler.h"
+#include "SessionReplay.h"
+#include "SyntheticScene.h"
+#include "Utility.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+//-- constants -----
+// How often the benchmark updates the service, like a client polling once per 90Hz display frame
+static const int k_service_update_interval_ms= 11;
+
+// Time the devices get to connect and settle before anything gets measured
+static const double k_service_warmup_time= 3.0;
+
+// Give up on a replay that hasn't finished after this long
+static const double k_replay_timeout= 600.0;
+
+//-- prototypes -----
+void run_tracking_model_benchmarks(BenchmarkSuite &suite);
+
+//-- definitions -----
+// Stands in for the client API. Counts the HMD data frames the service publishes.
+class BenchServiceListener : public IDataFrameListener, public INotificationListener
+{
+public:
+	BenchServiceListener()
+		: m_hmdDataFrameCount(0)
+	{}
+
+	virtual void handle_data_frame(const DeviceOutputDataFrame &data_frame) override
+	{
+		if (data_frame.device_category == DeviceCategory_HMD)
+		{
+			++m_hmdDataFrameCount;
+		}
+	}
+
+	virtual void handle_notification(const PSVREventMessage &response) override
+	{
+	}
+
+	inline uint64_t getHMDDataFrameCount() const { return m_hmdDataFrameCount; }
+
+private:
+	uint64_t m_hmdDataFrameCount;
+};
+
+// Sum of the pipeline counters of every open tracker
+struct BenchTrackerCounters
+{
+	int tracker_count;
+	uint64_t solved_frame_count;
+	uint64_t dropped_frame_count;
+	uint64_t heap_allocating_frame_count;
+};
+
+// DeviceManagerConfig is private to DeviceManager.cpp.
+// This writes the same file with just the replay keys; the service keeps its defaults for the rest.
+class BenchDeviceManagerConfig : public PSVRConfig
+{
+public:
+	static const int CONFIG_VERSION= 1;
+
+	BenchDeviceManagerConfig()
+		: PSVRConfig("DeviceManagerConfig")
+		, replay_session_path("")
+	{}
+
+	virtual const configuru::Config writeToJSON() override
+	{
+		configuru::Config pt{
+			{"version", BenchDeviceManagerConfig::CONFIG_VERSION+0},
+			{"replay_session_path", replay_session_path},
+			{"replay_speed", 0.f} // as fast as possible
+		};
+
+		return pt;
+	}
+
+	virtual void readFromJSON(const configuru::Config &pt) override
+	{
+	}
+
+	std::string replay_session_path;
+};
+
+// Runs the service in-process for a single benchmark session
+class BenchServiceSession
+{
+public:
+	BenchServiceSession()
+		: m_service(nullptr)
+		, m_listener()
+		, m_updateDurationsMs()
+	{}
+
+	~BenchServiceSession()
+	{
+		shutdown();
+	}
+
+	bool startup(
+		const BenchmarkOptions &options,
+		const int synthetic_tracker_count,
+		const int virtual_hmd_count,
+		const std::string &replay_path);
+	void shutdown();
+
+	/// Update the service for the given number of seconds (or until done() returns true).
+	/// Returns the number of seconds that passed.
+	double run(const double duration, const std::function<bool()> &done= nullptr);
+
+	void startHMDDataStreams();
+	void getTrackerCounters(BenchTrackerCounters &out_counters) const;
+	inline uint64_t getHMDDataFrameCount() const { return m_listener.getHMDDataFrameCount(); }
+
+	inline void clearUpdateDurations() { m_updateDurationsMs.clear(); }
+	double getMeanUpdateDurationMs() const;
+	double getUpdateDurationPercentileMs(const double percentile) const;
+
+private:
+	PSVRService *m_service;
+	BenchServiceListener m_listener;
+	std::vector<double> m_updateDurationsMs;
+};
+
+//-- prototypes -----
+static void write_device_manager_config(const std::string &replay_path);
+static void record_session_counters(
+	BenchmarkSuite &suite,
+	const std::string &prefix,
+	const BenchServiceSession &session,
+	const BenchTrackerCounters &start_counters,
+	const uint64_t start_hmd_data_frame_count,
+	const double duration);
+
+//-- public interface -----
+// Macro-benchmarks that run the whole service in-process: the synthetic scene (see SyntheticScene.h)
+// and, if one was given, a session recording replayed as fast as possible.
+// Also hosts the tracking model micro-benchmarks, since those need open tracker views.
+void run_service_benchmarks(BenchmarkSuite &suite)
+{
+	const BenchmarkOptions &options= suite.getOptions();
+
+	// Never touch the user's own service configs
+	Utility::create_directory(options.config_directory);
+	PSVRConfig::setConfigDirectoryOverride(options.config_directory);
+
+	// Tracking models, against synthetic trackers with no HMDs in view.
+	// With nothing to track the pipeline threads stay idle, so they don't skew the timings.
+	if (suite.shouldRun("model.mono_point_cloud_predicted") ||
+		suite.shouldRun("model.mono_point_cloud_brute_force"))
+	{
+		BenchServiceSession session;
+
+		fprintf(stdout, "[service] Starting with %d synthetic trackers\n", 1);
+		if (session.startup(options, 1, 0, ""))
+		{
+			session.run(k_service_warmup_time);
+			run_tracking_model_benchmarks(suite);
+		}
+		else
+		{
+			fprintf(stderr, "Failed to start the service\n");
+		}
+	}
+
+	// The whole pipeline tracking synthetic HMDs in real time
+	const std::string synthetic_prefix("service.synthetic.");
+	if (suite.shouldRun(synthetic_prefix + "update_mean"))
+	{
+		BenchServiceSession session;
+
+		fprintf(stdout, "[service] Starting with %d synthetic trackers and %d virtual HMDs\n",
+			options.synthetic_tracker_count, options.synthetic_hmd_count);
+		if (session.startup(options, options.synthetic_tracker_count, options.synthetic_hmd_count, ""))
+		{
+			session.run(k_service_warmup_time);
+			session.startHMDDataStreams();
+			session.clearUpdateDurations();
+
+			BenchTrackerCounters start_counters;
+			session.getTrackerCounters(start_counters);
+			const uint64_t start_hmd_data_frame_count= session.getHMDDataFrameCount();
+
+			const double duration= session.run(options.service_time);
+
+			record_session_counters(suite, synthetic_prefix, session, start_counters, start_hmd_data_frame_count, duration);
+		}
+		else
+		{
+			fprintf(stderr, "Failed to start the service\n");
+		}
+	}
+
+	// A recorded session played back as fast as the pipeline can take it
+	const std::string replay_prefix("service.replay.");
+	if (!options.replay_path.empty() && suite.shouldRun(replay_prefix + "playback_duration"))
+	{
+		BenchServiceSession session;
+
+		fprintf(stdout, "[service] Replaying %s\n", options.replay_path.c_str());
+		if (session.startup(options, 0, 0, options.replay_path))
+		{
+			const SessionReplay *replay= DeviceManager::getInstance()->getSessionReplay();
+
+			if (replay != nullptr && replay->getIsOpen())
+			{
+				session.startHMDDataStreams();
+
+				BenchTrackerCounters start_counters;
+				session.getTrackerCounters(start_counters);
+				const uint64_t start_hmd_data_frame_count= session.getHMDDataFrameCount();
+
+				// Includes the time it takes the replay devices to attach
+				const double duration= session.run(k_replay_timeout, [replay]() { return replay->getIsFinished(); });
+
+				if (replay->getIsFinished())
+				{
+					suite.addResult(replay_prefix + "playback_duration", "s", duration, BenchmarkDirection_LowerIsBetter);
+					record_session_counters(suite, replay_prefix, session, start_counters, start_hmd_data_frame_count, duration);
+				}
+				else
+				{
+					fprintf(stderr, "Replay didn't finish within %.0fs\n", k_replay_timeout);
+				}
+
+				// The recording may have come from a stereo camera
+				run_tracking_model_benchmarks(suite);
+			}
+			else
+			{
+				fprintf(stderr, "Failed to open session recording %s\n", options.replay_path.c_str());
+			}
+		}
+		else
+		{
+			fprintf(stderr, "Failed to start the service\n");
+		}
+	}
+	else
+	{
+		suite.skipBenchmark(replay_prefix + "playback_duration", "no --replay recording given");
+	}
+
+	PSVRConfig::setConfigDirectoryOverride("");
+}
+
+//-- BenchServiceSession -----
+bool BenchServiceSession::startup(
+	const BenchmarkOptions &options,
+	const int synthetic_tracker_count,
+	const int virtual_hmd_count,
+	const std::string &replay_path)
+{
+	// The service loads these when it starts up
+	write_device_manager_config(replay_path);
+
+	HMDManagerConfig hmd_manager_config;
+	hmd_manager_config.load();
+	hmd_manager_config.virtual_hmd_count= virtual_hmd_count;
+	hmd_manager_config.save();
+
+	SyntheticSceneConfig scene_config;
+	scene_config.load();
+	scene_config.tracker_count= synthetic_tracker_count;
+	scene_config.save();
+
+	m_service= new PSVRService();
+	if (!m_service->startup(PSVRLogSeverityLevel_warning, &m_listener, &m_listener))
+	{
+		shutdown();
+		return false;
+	}
+
+	return true;
+}
+
+void BenchServiceSession::shutdown()
+{
+	if (m_service != nullptr)
+	{
+		m_service->shutdown();
+		delete m_service;
+		m_service= nullptr;
+	}
+}
+
+double BenchServiceSession::run(const double duration, const std::function<bool()> &done)
+{
+	typedef std::chrono::high_resolution_clock t_clock;
+
+	const t_clock::time_point start_time= t_clock::now();
+	std::chrono::duration<double> elapsed(0.0);
+
+	while (elapsed.count() < duration && !(done && done()))
+	{
+		const t_clock::time_point update_start= t_clock::now();
+		m_service->update();
+		const t_clock::time_point update_end= t_clock::now();
+
+		m_updateDurationsMs.push_back(std::chrono::duration<double, std::milli>(update_end - update_start).count());
+
+		Utility::sleep_ms(k_service_update_interval_ms);
+		elapsed= t_clock::now() - start_time;
+	}
+
+	return elapsed.count();
+}
+
+void BenchServiceSession::startHMDDataStreams()
+{
+	DeviceManager *device_manager= DeviceManager::getInstance();
+	ServiceRequestHandler *request_handler= m_service->getRequestHandler();
+
+	for (int hmd_id = 0; hmd_id < device_manager->getHMDViewMaxCount(); ++hmd_id)
+	{
+		ServerHMDViewPtr hmd_view= device_manager->getHMDViewPtr(hmd_id);
+
+		if (hmd_view && hmd_view->getIsOpen())
+		{
+			request_handler->start_hmd_data_stream(hmd_id, PSMStreamFlags_includePositionData);
+		}
+	}
+}
+
+void BenchServiceSession::getTrackerCounters(BenchTrackerCounters &out_counters) const
+{
+	DeviceManager *device_manager= DeviceManager::getInstance();
+
+	out_counters.tracker_count= 0;
+	out_counters.solved_frame_count= 0;
+	out_counters.dropped_frame_count= 0;
+	out_counters.heap_allocating_frame_count= 0;
+
+	for (int tracker_id = 0; tracker_id < device_manager->getTrackerViewMaxCount(); ++tracker_id)
+	{
+		ServerTrackerViewPtr tracker_view= device_manager->getTrackerViewPtr(tracker_id);
+
+		if (tracker_view && tracker_view->getIsOpen())
+		{
+			TrackerPipelineStatistics stats;
+			tracker_view->getPipelineStatistics(stats);
+
+			++out_counters.tracker_count;
+			out_counters.solved_frame_count+= stats.processed_frame_count[TrackerPipelineStage_Solve];
+			for (int stage = 0; stage < TrackerPipelineStage_COUNT; ++stage)
+			{
+				out_counters.dropped_frame_count+= stats.dropped_frame_count[stage];
+				out_counters.heap_allocating_frame_count+= stats.heap_allocating_frame_count[stage];
+			}
+		}
+	}
+}
+
+double BenchServiceSession::getMeanUpdateDurationMs() const
+{
+	double total= 0.0;
+	for (const double update_duration : m_updateDurationsMs)
+	{
+		total+= update_duration;
+	}
+
+	return m_updateDurationsMs.empty() ? 0.0 : total / static_cast<double>(m_updateDurationsMs.size());
+}
+
+double BenchServiceSession::getUpdateDurationPercentileMs(const double percentile) const
+{
+	if (m_updateDurationsMs.empty())
+	{
+		return 0.0;
+	}
+
+	std::vector<double> sorted_durations(m_updateDurationsMs);
+	std::sort(sorted_durations.begin(), sorted_durations.end());
+
+	const size_t index= std::min(
+		static_cast<size_t>(percentile * static_cast<double>(sorted_durations.size())),
+		sorted_durations.size() - 1);
+
+	return sorted_durations[index];
+}
+
+//-- private functions -----
+static void write_device_manager_config(const std::string &replay_path)
+{
+	BenchDeviceManagerConfig config;
+	config.replay_session_path= replay_path;
+	config.save();
+}
+
+static void record_session_counters(
+	BenchmarkSuite &suite,
+	const std::string &prefix,
+	const BenchServiceSession &session,
+	const BenchTrackerCounters &start_counters,
+	const uint64_t start_hmd_data_frame_count,
+	const double duration)
+{
+	BenchTrackerCounters end_counters;
+	session.getTrackerCounters(end_counters);
+
+	const uint64_t solved_frame_count= end_counters.solved_frame_count - start_counters.solved_frame_count;
+	const uint64_t dropped_frame_count= end_counters.dropped_frame_count - start_counters.dropped_frame_count;
+	const uint64_t hmd_data_frame_count= session.getHMDDataFrameCount() - start_hmd_data_frame_count;
+	const int tracker_count= std::max(end_counters.tracker_count, 1);
+
+	suite.addResult(prefix + "update_mean", "ms", session.getMeanUpdateDurationMs(), BenchmarkDirection_LowerIsBetter);
+	suite.addResult(prefix + "update_p99", "ms", session.getUpdateDurationPercentileMs(0.99), BenchmarkDirection_LowerIsBetter);
+	suite.addResult(
+		prefix + "tracker_solve_rate", "fps",
+		static_cast<double>(solved_frame_count) / (duration * static_cast<double>(tracker_count)),
+		BenchmarkDirection_HigherIsBetter);
+	suite.addResult(
+		prefix + "hmd_data_frame_rate", "fps",
+		static_cast<double>(hmd_data_frame_count) / duration,
+		BenchmarkDirection_HigherIsBetter);
+	suite.addResult(
+		prefix + "tracker_dropped_frames", "frames",
+		static_cast<double>(dropped_frame_count),
+		BenchmarkDirection_Informational);
+
+	// Only reported for now: OpenCV still allocates through operator new on every frame
+	// (the UMatData behind each cv::Mat buffer and solvePnP internals, see HeapAllocationCounter.h),
+	// so a counting build doesn't read zero yet even once the pipeline is warmed up.
+	if (HeapAllocationCounter::isEnabled())
+	{
+		const uint64_t heap_allocating_frame_count= 
+			end_counters.heap_allocating_frame_count - start_counters.heap_allocating_frame_count;
+
+		suite.addResult(
+			prefix + "tracker_heap_allocating_frames", "frames",
+			static_cast<double>(heap_allocating_frame_count),
+			BenchmarkDirection_Informational);
+	}
+}
@@ -0,0 +1,463 @@
+//-- includes -----
+#include "benchmark.h"
+#include "DeviceManager.h"
+#include "KalmanPoseFilter.h"
+#include "MathAlignment.h"
+#include "MathTypeConversion.h"
+#include "MonoPointCloudTrackingModel.h"
+#include "MorpheusHMD.h"
+#include "ServerTrackerView.h"
+#include "StereoPointCloudTrackingModel.h"
+#include "TrackerMath.h"
+
+#include <chrono>
+#include <functional>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+//-- constants -----
+static const float k_pi= 3.14159265f;
+
+// The headset loops through the same motion every k_motion_frame_count frames
+static const int k_motion_frame_count= 120;
+static const float k_motion_frame_rate= 60.f;
+static const float k_motion_distance= 120.f; // cm in front of the tracker
+
+// Approximate pixel area of one LED blob at k_motion_distance
+static const float k_led_screen_area= 12.f;
+
+//-- definitions -----
+typedef std::chrono::time_point<std::chrono::high_resolution_clock> t_high_resolution_timepoint;
+typedef std::vector<PoseFilterPacket, Eigen::aligned_allocator<PoseFilterPacket>> t_filter_packet_list; // has Eigen quaternions
+
+// One frame of the scripted headset motion, as seen by a tracker
+struct BenchTrackingFrame
+{
+	PSVRTrackingProjection projection;
+	PSVRPosef world_pose_cm;
+};
+
+//-- prototypes -----
+static void compute_tracker_relative_motion_pose(const int frame_index, Eigen::Vector3f &out_position_cm, Eigen::Quaternionf &out_orientation);
+static void build_tracking_frames(
+	const ServerTrackerView *tracker_view,
+	const PSVRTrackingShape &shape,
+	std::vector<BenchTrackingFrame> &out_frames);
+static bool project_visible_points(
+	const PSVRTrackingShape &shape,
+	const Eigen::Vector3f &position_cm,
+	const Eigen::Quaternionf &orientation,
+	const std::function<Eigen::Vector2f (const Eigen::Vector3f &)> &project,
+	const float frame_width, const float frame_height,
+	PSVRTrackingProjectionData &out_projection);
+static const ServerTrackerView *find_open_tracker_view(const bool bIsStereo);
+static void make_motion_filter_packets(const PSVRTrackingShape &shape, t_filter_packet_list &out_packets);
+
+//-- public interface -----
+// Micro-benchmarks for the pose estimation stages that don't need a running service
+void run_pose_estimation_benchmarks(BenchmarkSuite &suite)
+{
+	fprintf(stdout, "[pose_estimation]\n");
+
+	// Contour of an LED sphere 1m from the tracker, like ServerTrackerView::computeProjectionForHmdInSection fits
+	{
+		const float sphere_radius= 2.25f;
+		const float focal_length= 554.f;
+		const Eigen::Vector3f sphere_center(8.f, -5.f, 100.f);
+		const float projected_radius= focal_length * sphere_radius / sqrtf(sphere_center.squaredNorm() - sphere_radius*sphere_radius);
+		const Eigen::Vector2f projected_center(
+			focal_length * sphere_center.x() / sphere_center.z(),
+			focal_length * sphere_center.y() / sphere_center.z());
+
+		std::vector<Eigen::Vector2f> contour;
+		for (int point_index = 0; point_index < 48; ++point_index)
+		{
+			const float angle= static_cast<float>(point_index) * 2.f * k_pi / 48.f;
+
+			contour.push_back(projected_center + projected_radius*Eigen::Vector2f(cosf(angle), sinf(angle)));
+		}
+
+		Eigen::Vector3f fit_center;
+		EigenFitEllipse fit_ellipse;
+		suite.runMicroBenchmark("alignment.fit_focal_cone_to_sphere", [&]() {
+			eigen_alignment_fit_focal_cone_to_sphere(
+				contour.data(), static_cast<int>(contour.size()),
+				sphere_radius, focal_length, &fit_center, &fit_ellipse);
+		});
+	}
+
+	// Pose filters fed the IMU at 120Hz and the optical tracker at every other IMU packet
+	{
+		const MorpheusHMDConfig hmd_config;
+		MorpheusHMD morpheus;
+
+		PoseFilterConstants constants;
+		constants.clear();
+		morpheus.getTrackingShape(constants.shape);
+
+		const PSVRVector3f accel_var= hmd_config.get_calibrated_accelerometer_variance();
+		const PSVRVector3f gyro_var= hmd_config.get_calibrated_gyro_variance();
+		const PSVRVector3f gyro_drift= hmd_config.get_calibrated_gyro_drift();
+		constants.orientation_constants.gravity_calibration_direction= Eigen::Vector3f(0.f, 1.f, 0.f);
+		constants.orientation_constants.accelerometer_variance= Eigen::Vector3f(accel_var.x, accel_var.y, accel_var.z);
+		constants.orientation_constants.gyro_drift= Eigen::Vector3f(gyro_drift.x, gyro_drift.y, gyro_drift.z);
+		constants.orientation_constants.gyro_variance= Eigen::Vector3f(gyro_var.x, gyro_var.y, gyro_var.z);
+		constants.orientation_constants.mean_update_time_delta= hmd_config.mean_update_time_delta;
+		constants.orientation_constants.orientation_variance_curve.A= hmd_config.orientation_variance;
+		constants.orientation_constants.orientation_variance_curve.MaxValue= 1.f;
+		constants.position_constants.gravity_calibration_direction= Eigen::Vector3f(0.f, 1.f, 0.f);
+		constants.position_constants.accelerometer_variance= Eigen::Vector3f(accel_var.x, accel_var.y, accel_var.z);
+		constants.position_constants.max_velocity= hmd_config.max_velocity;
+		constants.position_constants.mean_update_time_delta= hmd_config.mean_update_time_delta;
+		constants.position_constants.position_variance_curve.A= hmd_config.position_variance_exp_fit_a;
+		constants.position_constants.position_variance_curve.B= hmd_config.position_variance_exp_fit_b;
+		constants.position_constants.position_variance_curve.MaxValue= 1.f;
+
+		t_filter_packet_list packets;
+		make_motion_filter_packets(constants.shape, packets);
+
+		const float delta_time= 1.f / (2.f*k_motion_frame_rate);
+		size_t packet_index= 0;
+
+		KalmanPoseFilterMorpheus morpheus_filter;
+		morpheus_filter.init(constants, packets[0].optical_position_cm, packets[0].optical_orientation);
+		suite.runMicroBenchmark("filter.kalman_pose_morpheus_update", [&]() {
+			morpheus_filter.update(delta_time, packets[packet_index]);
+			packet_index= (packet_index + 1) % packets.size();
+		});
+
+		// The point cloud filter only gets optical packets
+		t_filter_packet_list optical_packets;
+		for (const PoseFilterPacket &packet : packets)
+		{
+			if (packet.has_optical_measurement())
+			{
+				PoseFilterPacket optical_packet= packet;
+				optical_packet.has_accelerometer_measurement= false;
+				optical_packet.has_gyroscope_measurement= false;
+				optical_packets.push_back(optical_packet);
+			}
+		}
+
+		packet_index= 0;
+		KalmanPoseFilterPointCloud point_cloud_filter;
+		point_cloud_filter.init(constants, optical_packets[0].optical_position_cm, optical_packets[0].optical_orientation);
+		suite.runMicroBenchmark("filter.kalman_pose_point_cloud_update", [&]() {
+			point_cloud_filter.update(2.f*delta_time, optical_packets[packet_index]);
+			packet_index= (packet_index + 1) % optical_packets.size();
+		});
+	}
+}
+
+// Micro-benchmarks for the point cloud tracking models.
+// These need a running service: the models ask the tracker view for its intrinsics and pose
+// and the mono model shares the tracker manager's reacquisition task pool.
+void run_tracking_model_benchmarks(BenchmarkSuite &suite)
+{
+	fprintf(stdout, "[tracking_models]\n");
+
+	MorpheusHMD morpheus;
+	PSVRTrackingShape shape;
+	morpheus.getTrackingShape(shape);
+
+	const ServerTrackerView *mono_tracker_view= find_open_tracker_view(false);
+	if (mono_tracker_view != nullptr)
+	{
+		std::vector<BenchTrackingFrame> frames;
+		build_tracking_frames(mono_tracker_view, shape, frames);
+
+		const t_high_resolution_timepoint start_time= std::chrono::high_resolution_clock::now();
+		const std::chrono::microseconds frame_duration(static_cast<int64_t>(1000000.f / k_motion_frame_rate));
+
+		// Tracking: the previous filtered pose predicts the new one and only nearby correspondences get tested
+		{
+			MonoPointCloudTrackingModel model;
+			model.init(&shape);
+
+			int frame_counter= 0;
+			int solve_count= 0;
+			suite.runMicroBenchmark("model.mono_point_cloud_predicted", [&]() {
+				const BenchTrackingFrame &prev_frame= frames[frame_counter % frames.size()];
+				const BenchTrackingFrame &frame= frames[(frame_counter + 1) % frames.size()];
+
+				ShapeTimestampedPose last_filtered_pose;
+				last_filtered_pose.timestamp= start_time + frame_counter*frame_duration;
+				last_filtered_pose.pose_cm= prev_frame.world_pose_cm;
+				last_filtered_pose.bIsValid= true;
+
+				++frame_counter;
+				if (model.applyShapeProjectionFromTracker(
+						start_time + frame_counter*frame_duration, mono_tracker_view, &last_filtered_pose, frame.projection))
+				{
+					++solve_count;
+				}
+			});
+
+			if (solve_count < frame_counter / 2)
+			{
+				fprintf(stderr, "  Predicted mono solve only succeeded %d/%d times\n", solve_count, frame_counter);
+			}
+		}
+
+		// Reacquisition: no filtered pose, so every frame runs the brute force correspondence search
+		{
+			MonoPointCloudTrackingModel model;
+			model.init(&shape);
+
+			const ShapeTimestampedPose no_filtered_pose;
+			int frame_counter= 0;
+			int solve_count= 0;
+			suite.runMicroBenchmark("model.mono_point_cloud_brute_force", [&]() {
+				const BenchTrackingFrame &frame= frames[frame_counter % frames.size()];
+
+				++frame_counter;
+				if (model.applyShapeProjectionFromTracker(
+						start_time + frame_counter*frame_duration, mono_tracker_view, &no_filtered_pose, frame.projection))
+				{
+					++solve_count;
+				}
+			});
+
+			if (solve_count < frame_counter / 2)
+			{
+				fprintf(stderr, "  Brute force mono solve only succeeded %d/%d times\n", solve_count, frame_counter);
+			}
+		}
+	}
+	else
+	{
+		suite.skipBenchmark("model.mono_point_cloud_predicted", "no mono tracker open");
+		suite.skipBenchmark("model.mono_point_cloud_brute_force", "no mono tracker open");
+	}
+
+	const ServerTrackerView *stereo_tracker_view= find_open_tracker_view(true);
+	if (stereo_tracker_view != nullptr)
+	{
+		std::vector<BenchTrackingFrame> frames;
+		build_tracking_frames(stereo_tracker_view, shape, frames);
+
+		const t_high_resolution_timepoint start_time= std::chrono::high_resolution_clock::now();
+		const std::chrono::microseconds frame_duration(static_cast<int64_t>(1000000.f / k_motion_frame_rate));
+
+		// Triangulation of the left/right point clouds followed by the ICP fit of the model
+		StereoPointCloudTrackingModel model;
+		model.init(&shape);
+
+		const ShapeTimestampedPose no_filtered_pose;
+		int frame_counter= 0;
+		suite.runMicroBenchmark("model.stereo_point_cloud", [&]() {
+			const BenchTrackingFrame &frame= frames[frame_counter % frames.size()];
+
+			++frame_counter;
+			model.applyShapeProjectionFromTracker(
+				start_time + frame_counter*frame_duration, stereo_tracker_view, &no_filtered_pose, frame.projection);
+		});
+	}
+	else
+	{
+		suite.skipBenchmark("model.stereo_point_cloud", "no stereo tracker open");
+	}
+}
+
+//-- private functions -----
+// Tracker relative space: +X right, +Y up, +Z away from the tracker (see compute_image_point_camera_rays)
+static void compute_tracker_relative_motion_pose(const int frame_index, Eigen::Vector3f &out_position_cm, Eigen::Quaternionf &out_orientation)
+{
+	const float phase= 2.f * k_pi * static_cast<float>(frame_index % k_motion_frame_count) / static_cast<float>(k_motion_frame_count);
+	const float yaw= 0.4f * sinf(phase);
+	const float pitch= 0.15f * sinf(2.f*phase);
+
+	out_position_cm= Eigen::Vector3f(10.f*sinf(phase), 5.f*sinf(2.f*phase), k_motion_distance);
+	out_orientation=
+		Eigen::AngleAxisf(yaw, Eigen::Vector3f::UnitY()) *
+		Eigen::AngleAxisf(pitch, Eigen::Vector3f::UnitX());
+}
+
+static void build_tracking_frames(
+	const ServerTrackerView *tracker_view,
+	const PSVRTrackingShape &shape,
+	std::vector<BenchTrackingFrame> &out_frames)
+{
+	const ITrackerInterface *tracker_device= tracker_view->getTrackerDevice();
+	const float frame_width= static_cast<float>(tracker_view->getFrameWidth());
+	const float frame_height= static_cast<float>(tracker_view->getFrameHeight());
+	const bool bIsStereo= tracker_view->getIsStereoCamera();
+
+	// Mono: pinhole projection with the tracker's own intrinsics (the models undistort the points again)
+	cv::Matx33f intrinsic_matrix;
+	cv::Matx<float, 5, 1> distortion_coefficients;
+	computeOpenCVCameraIntrinsicMatrix(tracker_device, PSVRVideoFrameSection_Primary, intrinsic_matrix, distortion_coefficients);
+	float fx, fy, cx, cy;
+	extractCameraIntrinsicMatrixParameters(intrinsic_matrix, fx, fy, cx, cy);
+
+	const auto project_mono= [fx, fy, cx, cy](const Eigen::Vector3f &p) {
+		return Eigen::Vector2f(cx + fx*p.x()/p.z(), cy - fy*p.y()/p.z());
+	};
+
+	// Stereo: rectified projection, the inverse of the triangulation in StereoPointCloudTrackingModel.
+	// The reprojection matrix works in millimeters with a flipped Y axis.
+	cv::Matx33d rectification_rotations[STEREO_PROJECTION_COUNT];
+	cv::Matx34d rectification_projections[STEREO_PROJECTION_COUNT];
+	if (bIsStereo)
+	{
+		computeOpenCVCameraRectification(tracker_device, PSVRVideoFrameSection_Left, rectification_rotations[LEFT_PROJECTION_INDEX], rectification_projections[LEFT_PROJECTION_INDEX]);
+		computeOpenCVCameraRectification(tracker_device, PSVRVideoFrameSection_Right, rectification_rotations[RIGHT_PROJECTION_INDEX], rectification_projections[RIGHT_PROJECTION_INDEX]);
+	}
+
+	out_frames.resize(k_motion_frame_count);
+	for (int frame_index = 0; frame_index < k_motion_frame_count; ++frame_index)
+	{
+		BenchTrackingFrame &frame= out_frames[frame_index];
+		memset(&frame.projection, 0, sizeof(PSVRTrackingProjection));
+
+		Eigen::Vector3f position_cm;
+		Eigen::Quaternionf orientation;
+		compute_tracker_relative_motion_pose(frame_index, position_cm, orientation);
+
+		frame.projection.shape_type= PSVRShape_PointCloud;
+		if (bIsStereo)
+		{
+			frame.projection.projection_count= STEREO_PROJECTION_COUNT;
+			for (int section = 0; section < STEREO_PROJECTION_COUNT; ++section)
+			{
+				const cv::Matx34d &P= rectification_projections[section];
+				const auto project_stereo= [&P](const Eigen::Vector3f &p) {
+					const cv::Vec4d point_mm(p.x()*10.0, -p.y()*10.0, p.z()*10.0, 1.0);
+					const cv::Vec3d pixel= P * point_mm;
+					return Eigen::Vector2f(static_cast<float>(pixel[0]/pixel[2]), static_cast<float>(pixel[1]/pixel[2]));
+				};
+
+				project_visible_points(shape, position_cm, orientation, project_stereo, frame_width, frame_height, frame.projection.projections[section]);
+			}
+		}
+		else
+		{
+			frame.projection.projection_count= MONO_PROJECTION_COUNT;
+			project_visible_points(shape, position_cm, orientation, project_mono, frame_width, frame_height, frame.projection.projections[0]);
+		}
+
+		const PSVRVector3f tracker_position= eigen_vector3f_to_PSVR_vector3f(position_cm);
+		const PSVRQuatf tracker_orientation= eigen_quaternionf_to_PSVR_quatf(orientation);
+		frame.world_pose_cm.Position= tracker_view->computeWorldPosition(&tracker_position);
+		frame.world_pose_cm.Orientation= tracker_view->computeWorldOrientation(&tracker_orientation);
+	}
+}
+
+static bool project_visible_points(
+	const PSVRTrackingShape &shape,
+	const Eigen::Vector3f &position_cm,
+	const Eigen::Quaternionf &orientation,
+	const std::function<Eigen::Vector2f (const Eigen::Vector3f &)> &project,
+	const float frame_width, const float frame_height,
+	PSVRTrackingProjectionData &out_projection)
+{
+	Eigen::Vector2f bbox_min(frame_width, frame_height);
+	Eigen::Vector2f bbox_max(0.f, 0.f);
+	int point_count= 0;
+
+	for (int model_index = 0; model_index < shape.shape.pointcloud.point_count; ++model_index)
+	{
+		const Eigen::Vector3f point= orientation * PSVR_vector3f_to_eigen_vector3(shape.shape.pointcloud.points[model_index]) + position_cm;
+		const Eigen::Vector3f normal= orientation * PSVR_vector3f_to_eigen_vector3(shape.shape.pointcloud.normals[model_index]);
+
+		// Skip LEDs facing away from the tracker
+		if (point.z() <= 0.f || normal.dot(-point) <= 0.f)
+			continue;
+
+		const Eigen::Vector2f pixel= project(point);
+		if (pixel.x() < 0.f || pixel.y() < 0.f || pixel.x() >= frame_width || pixel.y() >= frame_height)
+			continue;
+
+		out_projection.shape.pointcloud.points[point_count]= {pixel.x(), pixel.y()};
+		out_projection.shape.pointcloud.screen_area[point_count]= k_led_screen_area;
+		out_projection.shape.pointcloud.shape_point_index[point_count]= -1;
+		bbox_min= bbox_min.cwiseMin(pixel);
+		bbox_max= bbox_max.cwiseMax(pixel);
+		++point_count;
+	}
+
+	out_projection.shape.pointcloud.point_count= point_count;
+	out_projection.screen_area= k_led_screen_area * static_cast<float>(point_count);
+	out_projection.screen_bbox_center= {0.5f*(bbox_min.x() + bbox_max.x()), 0.5f*(bbox_min.y() + bbox_max.y())};
+	out_projection.screen_bbox_half_extents= {0.5f*(bbox_max.x() - bbox_min.x()), 0.5f*(bbox_max.y() - bbox_min.y())};
+
+	return point_count >= 3;
+}
+
+static const ServerTrackerView *find_open_tracker_view(const bool bIsStereo)
+{
+	DeviceManager *device_manager= DeviceManager::getInstance();
+
+	if (device_manager != nullptr)
+	{
+		for (int tracker_id = 0; tracker_id < device_manager->getTrackerViewMaxCount(); ++tracker_id)
+		{
+			ServerTrackerViewPtr tracker_view= device_manager->getTrackerViewPtr(tracker_id);
+
+			if (tracker_view && tracker_view->getIsOpen() && tracker_view->getIsStereoCamera() == bIsStereo)
+			{
+				return tracker_view.get();
+			}
+		}
+	}
+
+	return nullptr;
+}
+
+// IMU packets at twice the tracker frame rate, every other one also carrying the optical pose
+static void make_motion_filter_packets(const PSVRTrackingShape &shape, t_filter_packet_list &out_packets)
+{
+	const int packet_count= 2*k_motion_frame_count;
+
+	out_packets.resize(packet_count);
+	for (int packet_index = 0; packet_index < packet_count; ++packet_index)
+	{
+		PoseFilterPacket &packet= out_packets[packet_index];
+		packet.clear();
+
+		// Same motion as the tracking model benchmarks, sampled twice per frame
+		Eigen::Vector3f position_cm, next_position_cm;
+		Eigen::Quaternionf orientation, next_orientation;
+		compute_tracker_relative_motion_pose(packet_index / 2, position_cm, orientation);
+		compute_tracker_relative_motion_pose(packet_index / 2 + 1, next_position_cm, next_orientation);
+
+		const Eigen::AngleAxisf frame_rotation(orientation.conjugate() * next_orientation);
+
+		packet.has_gyroscope_measurement= true;
+		packet.imu_gyroscope_rad_per_sec= frame_rotation.axis() * frame_rotation.angle() * k_motion_frame_rate;
+		packet.has_accelerometer_measurement= true;
+		packet.imu_accelerometer_g_units= orientation.conjugate() * Eigen::Vector3f(0.f, 1.f, 0.f);
+		packet.current_orientation= orientation;
+		packet.current_position_cm= position_cm;
+		packet.current_linear_velocity_cm_s= (next_position_cm - position_cm) * k_motion_frame_rate;
+		packet.world_accelerometer= Eigen::Vector3f(0.f, 1.f, 0.f);
+
+		if ((packet_index % 2) == 0)
+		{
+			packet.tracker_id= 0;
+			packet.optical_position_cm= position_cm;
+			packet.optical_orientation= orientation;
+
+			packet.optical_tracking_shape_cm.shape_type= PSVRTrackingShape_PointCloud;
+			packet.optical_tracking_shape_cm.shape.pointcloud.point_count= shape.shape.pointcloud.point_count;
+			packet.optical_tracking_projection.shape_type= PSVRShape_PointCloud;
+			packet.optical_tracking_projection.projection_count= MONO_PROJECTION_COUNT;
+
+			PSVRTrackingProjectionData &projection= packet.optical_tracking_projection.projections[0];
+			for (int point_index = 0; point_index < shape.shape.pointcloud.point_count; ++point_index)
+			{
+				const Eigen::Vector3f point=
+					orientation * PSVR_vector3f_to_eigen_vector3(shape.shape.pointcloud.points[point_index]) + position_cm;
+
+				packet.optical_tracking_shape_cm.shape.pointcloud.points[point_index]= eigen_vector3f_to_PSVR_vector3f(point);
+				projection.shape.pointcloud.points[point_index]= {0.f, 0.f};
+				projection.shape.pointcloud.screen_area[point_index]= k_led_screen_area;
+				projection.shape.pointcloud.shape_point_index[point_index]= point_index;
+			}
+			projection.shape.pointcloud.point_count= shape.shape.pointcloud.point_count;
+			projection.screen_area= k_led_screen_area * static_cast<float>(shape.shape.pointcloud.point_count);
+		}
+	}
+}
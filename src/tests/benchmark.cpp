@@ -0,0 +1,273 @@
+//-- includes -----
+#include "benchmark.h"
+#include "PSVRConfig.h"
+#include "Utility.h"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <stdio.h>
+
+//-- constants -----
+static const int k_results_version= 1;
+
+// Calls are grouped into batches of at least this long so the timer resolution doesn't matter
+static const std::chrono::microseconds k_min_batch_duration(1000);
+static const int k_warmup_call_count= 3;
+static const int k_min_batch_count= 5;
+
+//-- prototypes -----
+static const char *direction_to_string(const eBenchmarkDirection direction);
+static eBenchmarkDirection string_to_direction(const std::string &direction);
+
+//-- public interface -----
+BenchmarkSuite::BenchmarkSuite(const BenchmarkOptions &options)
+	: m_options(options)
+	, m_results()
+{
+}
+
+bool BenchmarkSuite::shouldRun(const std::string &name) const
+{
+	if (!m_options.filter.empty() && name.find(m_options.filter) == std::string::npos)
+	{
+		return false;
+	}
+
+	for (const BenchmarkResult &result : m_results)
+	{
+		if (result.name == name)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void BenchmarkSuite::runMicroBenchmark(const std::string &name, const std::function<void()> &iteration)
+{
+	typedef std::chrono::high_resolution_clock t_clock;
+
+	if (!shouldRun(name))
+	{
+		return;
+	}
+
+	// Warm up the caches and any lazily allocated scratch buffers
+	for (int call_index = 0; call_index < k_warmup_call_count; ++call_index)
+	{
+		iteration();
+	}
+
+	// Pick a batch size that makes a batch take at least k_min_batch_duration
+	int batch_size= 1;
+	for (;;)
+	{
+		const t_clock::time_point batch_start= t_clock::now();
+		for (int call_index = 0; call_index < batch_size; ++call_index)
+		{
+			iteration();
+		}
+
+		if (t_clock::now() - batch_start >= k_min_batch_duration || batch_size >= (1 << 20))
+		{
+			break;
+		}
+
+		batch_size*= 2;
+	}
+
+	// Sample batches until the time budget runs out
+	std::vector<double> call_durations_us;
+	const t_clock::time_point sampling_start= t_clock::now();
+	const std::chrono::duration<double> sampling_duration(m_options.micro_time);
+	while (static_cast<int>(call_durations_us.size()) < k_min_batch_count || t_clock::now() - sampling_start < sampling_duration)
+	{
+		const t_clock::time_point batch_start= t_clock::now();
+		for (int call_index = 0; call_index < batch_size; ++call_index)
+		{
+			iteration();
+		}
+		const std::chrono::duration<double, std::micro> batch_duration= t_clock::now() - batch_start;
+
+		call_durations_us.push_back(batch_duration.count() / static_cast<double>(batch_size));
+	}
+
+	// The median is much less sensitive to the occasional context switch than the mean
+	std::sort(call_durations_us.begin(), call_durations_us.end());
+	const double median_us= call_durations_us[call_durations_us.size() / 2];
+
+	addResult(
+		name, "us", median_us, BenchmarkDirection_LowerIsBetter,
+		static_cast<int>(call_durations_us.size()) * batch_size);
+}
+
+void BenchmarkSuite::addResult(
+	const std::string &name, const std::string &unit, const double value,
+	const eBenchmarkDirection direction, const int sample_count)
+{
+	BenchmarkResult result;
+	result.name= name;
+	result.unit= unit;
+	result.value= value;
+	result.direction= direction;
+	result.sample_count= sample_count;
+	m_results.push_back(result);
+
+	fprintf(stdout, "  %-48s %12.3f %s\n", name.c_str(), value, unit.c_str());
+}
+
+void BenchmarkSuite::skipBenchmark(const std::string &name, const std::string &reason)
+{
+	if (shouldRun(name))
+	{
+		fprintf(stdout, "  %-48s SKIPPED (%s)\n", name.c_str(), reason.c_str());
+	}
+}
+
+bool BenchmarkSuite::writeResults(const std::string &path) const
+{
+	configuru::Config results= configuru::Config::object();
+	for (const BenchmarkResult &result : m_results)
+	{
+		results[result.name]= configuru::Config{
+			{"value", result.value},
+			{"unit", result.unit},
+			{"direction", direction_to_string(result.direction)},
+			{"samples", result.sample_count}
+		};
+	}
+
+	configuru::Config pt{
+		{"version", k_results_version},
+		{"results", results}
+	};
+
+	try
+	{
+		configuru::dump_file(path, pt, configuru::JSON);
+	}
+	catch (const std::exception &e)
+	{
+		fprintf(stderr, "Failed to write benchmark results to %s: %s\n", path.c_str(), e.what());
+		return false;
+	}
+
+	return true;
+}
+
+int BenchmarkSuite::compareToBaseline(const std::string &path, const double tolerance) const
+{
+	if (!Utility::file_exists(path))
+	{
+		fprintf(stderr, "Benchmark baseline %s doesn't exist\n", path.c_str());
+		return -1;
+	}
+
+	configuru::Config baseline;
+	try
+	{
+		baseline= configuru::parse_file(path, configuru::JSON);
+	}
+	catch (const std::exception &e)
+	{
+		fprintf(stderr, "Failed to parse benchmark baseline %s: %s\n", path.c_str(), e.what());
+		return -1;
+	}
+
+	if (baseline.get_or<int>("version", 0) != k_results_version || !baseline.has_key("results"))
+	{
+		fprintf(stderr, "Benchmark baseline %s has an unsupported format\n", path.c_str());
+		return -1;
+	}
+
+	const configuru::Config &baseline_results= baseline["results"];
+	int regression_count= 0;
+
+	fprintf(stdout, "Comparing against %s (tolerance %.1f%%)\n", path.c_str(), tolerance*100.0);
+	for (const BenchmarkResult &result : m_results)
+	{
+		if (result.direction == BenchmarkDirection_Informational)
+		{
+			continue;
+		}
+
+		if (!baseline_results.has_key(result.name))
+		{
+			fprintf(stdout, "  %-48s NEW\n", result.name.c_str());
+			continue;
+		}
+
+		const configuru::Config &baseline_result= baseline_results[result.name];
+		const double baseline_value= baseline_result.get_or<double>("value", 0.0);
+		const eBenchmarkDirection baseline_direction=
+			string_to_direction(baseline_result.get_or<std::string>("direction", ""));
+
+		if (baseline_direction != result.direction || baseline_value <= 0.0)
+		{
+			fprintf(stdout, "  %-48s NOT COMPARABLE\n", result.name.c_str());
+			continue;
+		}
+
+		// Positive change = worse
+		const double change=
+			(result.direction == BenchmarkDirection_LowerIsBetter)
+			? (result.value - baseline_value) / baseline_value
+			: (baseline_value - result.value) / baseline_value;
+		const bool bRegressed= change > tolerance;
+
+		fprintf(stdout, "  %-48s %12.3f -> %12.3f %s (%+.1f%%)%s\n",
+			result.name.c_str(), baseline_value, result.value, result.unit.c_str(),
+			change*100.0, bRegressed ? " REGRESSED" : "");
+
+		if (bRegressed)
+		{
+			++regression_count;
+		}
+	}
+
+	for (const auto &iter : baseline_results.as_object())
+	{
+		const std::string &baseline_name= iter.key();
+		const bool bWasRun=
+			std::any_of(m_results.begin(), m_results.end(),
+				[&baseline_name](const BenchmarkResult &result) { return result.name == baseline_name; });
+
+		if (!bWasRun)
+		{
+			fprintf(stdout, "  %-48s NOT RUN\n", baseline_name.c_str());
+		}
+	}
+
+	return regression_count;
+}
+
+//-- private functions -----
+static const char *direction_to_string(const eBenchmarkDirection direction)
+{
+	switch (direction)
+	{
+	case BenchmarkDirection_LowerIsBetter:
+		return "lower_is_better";
+	case BenchmarkDirection_HigherIsBetter:
+		return "higher_is_better";
+	case BenchmarkDirection_Informational:
+	default:
+		return "informational";
+	}
+}
+
+static eBenchmarkDirection string_to_direction(const std::string &direction)
+{
+	if (direction == "lower_is_better")
+	{
+		return BenchmarkDirection_LowerIsBetter;
+	}
+	else if (direction == "higher_is_better")
+	{
+		return BenchmarkDirection_HigherIsBetter;
+	}
+
+	return BenchmarkDirection_Informational;
+}
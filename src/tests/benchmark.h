@@ -0,0 +1,91 @@
+/* Performance measurement structures and functions */
+#ifndef __BENCHMARK_H
+#define __BENCHMARK_H
+
+//-- includes -----
+#include <functional>
+#include <string>
+#include <vector>
+
+//-- definitions -----
+enum eBenchmarkDirection
+{
+	BenchmarkDirection_LowerIsBetter,
+	BenchmarkDirection_HigherIsBetter,
+	BenchmarkDirection_Informational // reported, but never compared against the baseline
+};
+
+struct BenchmarkResult
+{
+	std::string name;
+	std::string unit;
+	double value;
+	eBenchmarkDirection direction;
+	int sample_count;
+};
+
+struct BenchmarkOptions
+{
+	// Only run the benchmarks whose name contains this string (empty = all)
+	std::string filter;
+	// How long each micro-benchmark keeps sampling (seconds)
+	double micro_time;
+	// How long each service macro-benchmark runs once every device is up (seconds)
+	double service_time;
+	// Synthetic scene the service macro-benchmark runs against
+	int synthetic_tracker_count;
+	int synthetic_hmd_count;
+	// Session recording replayed by the replay macro-benchmark (empty = skip it)
+	std::string replay_path;
+	// Where the service configs used by the macro-benchmarks are written.
+	// Kept apart from the user's real config directory.
+	std::string config_directory;
+
+	BenchmarkOptions()
+		: filter()
+		, micro_time(1.0)
+		, service_time(10.0)
+		, synthetic_tracker_count(2)
+		, synthetic_hmd_count(2)
+		, replay_path()
+		, config_directory("psvr_bench_config")
+	{}
+};
+
+class BenchmarkSuite
+{
+public:
+	BenchmarkSuite(const BenchmarkOptions &options);
+
+	inline const BenchmarkOptions &getOptions() const { return m_options; }
+	inline const std::vector<BenchmarkResult> &getResults() const { return m_results; }
+
+	/// True if the named benchmark passes the name filter and hasn't been recorded yet
+	bool shouldRun(const std::string &name) const;
+
+	/// Calls the given function back to back in batches for options.micro_time seconds
+	/// and records the median time of a single call (microseconds).
+	void runMicroBenchmark(const std::string &name, const std::function<void()> &iteration);
+
+	void addResult(
+		const std::string &name, const std::string &unit, const double value,
+		const eBenchmarkDirection direction, const int sample_count= 1);
+	void skipBenchmark(const std::string &name, const std::string &reason);
+
+	/// Write all of the results to a JSON file (also used as the baseline format)
+	bool writeResults(const std::string &path) const;
+
+	/// Compare the results to a baseline written by writeResults().
+	/// Timings are machine specific, so no baseline ships with the repo: record one with
+	/// psvr_bench --save-baseline on the machine that will run the comparison.
+	/// A result regresses when it's worse than its baseline value by more than the given fraction
+	/// (e.g. 0.1 = 10% slower). Benchmarks missing from either side are only reported.
+	/// Returns the number of regressions, or -1 if the baseline couldn't be loaded.
+	int compareToBaseline(const std::string &path, const double tolerance) const;
+
+private:
+	BenchmarkOptions m_options;
+	std::vector<BenchmarkResult> m_results;
+};
+
+#endif // __BENCHMARK_H
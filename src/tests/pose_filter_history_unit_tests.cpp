@@ -0,0 +1,349 @@
+//-- includes -----
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include <chrono>
+#include <vector>
+
+#include "PoseFilterHistory.h"
+#include "unit_test.h"
+
+//-- constants -----
+static const int k_test_history_capacity= 32;
+static const int k_test_imu_packet_count= 240;
+static const int k_test_imu_period_us= 2500; // 400Hz
+static const int k_test_optical_period= 4; // one optical packet every 4 IMU packets
+static const int k_test_optical_offset_us= 1000; // optical frames are captured between IMU packets
+static const int k_test_optical_delay= 3; // optical packets show up after the next 3 IMU packets
+
+//-- definitions -----
+typedef std::chrono::time_point<std::chrono::high_resolution_clock> t_test_timepoint;
+typedef std::vector<PoseSensorPacket, Eigen::aligned_allocator<PoseSensorPacket>> t_test_packet_list;
+
+// State of the test filter below
+struct TestPoseFilterState
+{
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+	Eigen::Quaternionf orientation;
+	Eigen::Vector3f position;
+	Eigen::Vector3f velocity;
+	Eigen::Vector3f acceleration;
+	double time;
+	int update_count;
+
+	bool operator==(const TestPoseFilterState &other) const
+	{
+		return
+			orientation.coeffs() == other.orientation.coeffs() &&
+			position == other.position &&
+			velocity == other.velocity &&
+			acceleration == other.acceleration &&
+			time == other.time &&
+			update_count == other.update_count;
+	}
+};
+
+struct TestPoseFilterSnapshot : public IStateFilterSnapshot
+{
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+	TestPoseFilterState state;
+};
+
+// Simple complementary pose filter.
+// The result depends on the order and the time deltas of the packets it sees,
+// which is all the history has to get right, and it's bit for bit deterministic.
+class TestPoseFilter : public IPoseFilter
+{
+public:
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+	TestPoseFilter() { resetState(); }
+
+	inline const TestPoseFilterState &getState() const { return m_state; }
+
+	// -- IStateFilter
+	bool getIsStateValid() const override { return m_state.update_count > 0; }
+	double getTimeInSeconds() const override { return m_state.time; }
+	void update(const float delta_time, const PoseFilterPacket &packet) override
+	{
+		if (packet.has_gyroscope_measurement)
+		{
+			const Eigen::Vector3f omega= packet.imu_gyroscope_rad_per_sec * (0.5f * delta_time);
+			const Eigen::Quaternionf q_delta(1.f, omega.x(), omega.y(), omega.z());
+			m_state.orientation= (m_state.orientation * q_delta).normalized();
+		}
+
+		if (packet.has_accelerometer_measurement)
+		{
+			m_state.acceleration= packet.world_accelerometer * k_g_units_to_gal;
+			m_state.velocity+= m_state.acceleration * delta_time;
+		}
+
+		m_state.position+= m_state.velocity * delta_time;
+
+		if (packet.has_optical_measurement())
+		{
+			// Pull the estimate toward the optical measurement
+			m_state.velocity+= (packet.optical_position_cm - m_state.position) * 0.5f;
+			m_state.position+= (packet.optical_position_cm - m_state.position) * 0.25f;
+			m_state.orientation= m_state.orientation.slerp(0.25f, packet.optical_orientation);
+		}
+
+		m_state.time+= delta_time;
+		++m_state.update_count;
+	}
+	void resetState() override
+	{
+		m_state.orientation= Eigen::Quaternionf::Identity();
+		m_state.position= Eigen::Vector3f::Zero();
+		m_state.velocity= Eigen::Vector3f::Zero();
+		m_state.acceleration= Eigen::Vector3f::Zero();
+		m_state.time= 0.0;
+		m_state.update_count= 0;
+	}
+	void recenterOrientation(const Eigen::Quaternionf& q_pose) override {}
+
+	IStateFilterSnapshot *allocateStateSnapshot() const override { return new TestPoseFilterSnapshot(); }
+	void saveStateSnapshot(IStateFilterSnapshot *snapshot) const override
+	{
+		static_cast<TestPoseFilterSnapshot *>(snapshot)->state= m_state;
+	}
+	void restoreStateSnapshot(const IStateFilterSnapshot *snapshot) override
+	{
+		m_state= static_cast<const TestPoseFilterSnapshot *>(snapshot)->state;
+	}
+
+	// -- IPoseFilter
+	bool getIsPositionStateValid() const override { return getIsStateValid(); }
+	bool getIsOrientationStateValid() const override { return getIsStateValid(); }
+	Eigen::Quaternionf getOrientation(float time = 0.f) const override { return m_state.orientation; }
+	Eigen::Vector3f getAngularVelocityRadPerSec() const override { return Eigen::Vector3f::Zero(); }
+	Eigen::Vector3f getAngularAccelerationRadPerSecSqr() const override { return Eigen::Vector3f::Zero(); }
+	Eigen::Vector3f getPositionCm(float time = 0.f) const override { return m_state.position + m_state.velocity*time; }
+	Eigen::Vector3f getVelocityCmPerSec() const override { return m_state.velocity; }
+	Eigen::Vector3f getAccelerationCmPerSecSqr() const override { return m_state.acceleration; }
+
+private:
+	TestPoseFilterState m_state;
+};
+
+//-- private methods -----
+static void make_test_packets(t_test_packet_list &out_packets);
+static void make_arrival_order(const t_test_packet_list &packets, t_test_packet_list &out_arrival_order);
+static void apply_packets_in_order(const t_test_packet_list &packets, TestPoseFilter &filter);
+static int apply_packets_with_rewind(const t_test_packet_list &arrival_order, const int capacity, TestPoseFilter &filter);
+
+//-- public interface -----
+bool run_pose_filter_history_unit_tests()
+{
+	UNIT_TEST_MODULE_BEGIN("pose_filter_history")
+		UNIT_TEST_MODULE_CALL_TEST(pose_filter_history_test_rewind_matches_in_order);
+		UNIT_TEST_MODULE_CALL_TEST(pose_filter_history_test_late_packet_without_rewind_differs);
+		UNIT_TEST_MODULE_CALL_TEST(pose_filter_history_test_replay_count);
+	UNIT_TEST_MODULE_END()
+}
+
+//-- private functions -----
+// Optical packets that arrive after newer IMU packets get rewound in,
+// which has to leave the filter exactly where in-order filtering would
+bool
+pose_filter_history_test_rewind_matches_in_order()
+{
+	UNIT_TEST_BEGIN("rewind matches in order")
+
+	t_test_packet_list packets;
+	t_test_packet_list arrival_order;
+	make_test_packets(packets);
+	make_arrival_order(packets, arrival_order);
+
+	TestPoseFilter in_order_filter;
+	apply_packets_in_order(packets, in_order_filter);
+
+	TestPoseFilter rewound_filter;
+	const int rewind_count= apply_packets_with_rewind(arrival_order, k_test_history_capacity, rewound_filter);
+
+	// Every optical packet gets overtaken by IMU packets
+	success= rewind_count == k_test_imu_packet_count / k_test_optical_period;
+	success&= rewound_filter.getState() == in_order_filter.getState();
+	assert(success);
+
+	UNIT_TEST_COMPLETE()
+}
+
+// Sanity check that the packet order matters to the test filter,
+// otherwise the test above couldn't catch a broken rewind
+bool
+pose_filter_history_test_late_packet_without_rewind_differs()
+{
+	UNIT_TEST_BEGIN("late packet without rewind differs")
+
+	t_test_packet_list packets;
+	t_test_packet_list arrival_order;
+	make_test_packets(packets);
+	make_arrival_order(packets, arrival_order);
+
+	TestPoseFilter in_order_filter;
+	apply_packets_in_order(packets, in_order_filter);
+
+	// A history without capacity can't rewind, so late packets are applied as they arrive
+	TestPoseFilter late_filter;
+	const int rewind_count= apply_packets_with_rewind(arrival_order, 0, late_filter);
+
+	success= rewind_count == 0;
+	success&= !(late_filter.getState() == in_order_filter.getState());
+	assert(success);
+
+	UNIT_TEST_COMPLETE()
+}
+
+bool
+pose_filter_history_test_replay_count()
+{
+	UNIT_TEST_BEGIN("replay count")
+
+	PoseFilterSpace filter_space;
+	TestPoseFilter filter;
+	PoseFilterHistory history(&filter, &filter_space, 4);
+	t_test_packet_list packets;
+	make_test_packets(packets);
+
+	success= history.getIsRewindSupported();
+	success&= history.computeReplayCount(packets[0]) == -1; // nothing applied yet
+
+	for (int packet_index= 1; packet_index <= 6; ++packet_index)
+	{
+		history.applySensorPacket(packets[packet_index]);
+	}
+
+	// Only the newest 4 packets (3..6) are kept
+	success&= !history.getIsLateSensorPacket(packets[7]);
+	success&= history.getIsLateSensorPacket(packets[5]);
+	success&= history.computeReplayCount(packets[6]) == 0; // same time as the newest packet
+	success&= history.computeReplayCount(packets[5]) == 1;
+	success&= history.computeReplayCount(packets[3]) == 3;
+	success&= history.computeReplayCount(packets[2]) == 4; // state before packet 3 is from packet 2
+	success&= history.computeReplayCount(packets[1]) == -1;
+	success&= history.computeReplayCount(packets[0]) == -1;
+
+	history.clear();
+	success&= history.computeReplayCount(packets[5]) == -1;
+	assert(success);
+
+	UNIT_TEST_COMPLETE()
+}
+
+// IMU and optical packets in time order
+static void make_test_packets(t_test_packet_list &out_packets)
+{
+	const t_test_timepoint start_time= t_test_timepoint() + std::chrono::seconds(1);
+
+	out_packets.clear();
+	for (int imu_packet_index= 0; imu_packet_index < k_test_imu_packet_count; ++imu_packet_index)
+	{
+		const int time_us= imu_packet_index * k_test_imu_period_us;
+		const float t= static_cast<float>(time_us) * 1e-6f;
+		PoseSensorPacket packet;
+
+		packet.clear();
+		packet.timestamp= start_time + std::chrono::microseconds(time_us);
+		packet.imu_gyroscope_rad_per_sec= Eigen::Vector3f(sinf(3.f*t), 0.5f*cosf(2.f*t), 0.25f);
+		packet.imu_accelerometer_g_units= Eigen::Vector3f(0.1f*cosf(5.f*t), 1.f, 0.05f*sinf(7.f*t));
+		packet.has_gyroscope_measurement= true;
+		packet.has_accelerometer_measurement= true;
+		out_packets.push_back(packet);
+
+		if (imu_packet_index % k_test_optical_period == 0)
+		{
+			const int optical_time_us= time_us + k_test_optical_offset_us;
+			const float optical_t= static_cast<float>(optical_time_us) * 1e-6f;
+
+			packet.clear();
+			packet.timestamp= start_time + std::chrono::microseconds(optical_time_us);
+			packet.tracker_id= 0;
+			packet.optical_tracking_projection.shape_type= PSVRShape_PointCloud;
+			packet.optical_tracking_projection.projection_count= MONO_PROJECTION_COUNT;
+			packet.optical_tracking_projection.projections[0].screen_area= 100.f;
+			packet.optical_position_cm= Eigen::Vector3f(10.f*sinf(optical_t), 5.f*cosf(optical_t), 100.f + optical_t);
+			packet.optical_orientation= Eigen::Quaternionf(Eigen::AngleAxisf(optical_t, Eigen::Vector3f::UnitY()));
+			out_packets.push_back(packet);
+		}
+	}
+}
+
+// The filter sees each optical packet after the next k_test_optical_delay IMU packets
+static void make_arrival_order(const t_test_packet_list &packets, t_test_packet_list &out_arrival_order)
+{
+	std::vector<int> delayed_packet_indices;
+	std::vector<int> delayed_imu_counts;
+
+	out_arrival_order.clear();
+	for (int packet_index= 0; packet_index < static_cast<int>(packets.size()); ++packet_index)
+	{
+		if (packets[packet_index].has_optical_measurement())
+		{
+			delayed_packet_indices.push_back(packet_index);
+			delayed_imu_counts.push_back(0);
+			continue;
+		}
+
+		out_arrival_order.push_back(packets[packet_index]);
+
+		for (int &imu_count : delayed_imu_counts)
+		{
+			++imu_count;
+		}
+
+		while (!delayed_packet_indices.empty() && delayed_imu_counts.front() >= k_test_optical_delay)
+		{
+			out_arrival_order.push_back(packets[delayed_packet_indices.front()]);
+			delayed_packet_indices.erase(delayed_packet_indices.begin());
+			delayed_imu_counts.erase(delayed_imu_counts.begin());
+		}
+	}
+
+	for (const int packet_index : delayed_packet_indices)
+	{
+		out_arrival_order.push_back(packets[packet_index]);
+	}
+}
+
+static void apply_packets_in_order(const t_test_packet_list &packets, TestPoseFilter &filter)
+{
+	PoseFilterSpace filter_space;
+	PoseFilterHistory history(&filter, &filter_space, 0);
+
+	for (const PoseSensorPacket &packet : packets)
+	{
+		history.applySensorPacket(packet);
+	}
+}
+
+// Same late packet handling as ServerHMDView::processPoseSensorPackets (without the replay budget)
+static int apply_packets_with_rewind(const t_test_packet_list &arrival_order, const int capacity, TestPoseFilter &filter)
+{
+	PoseFilterSpace filter_space;
+	PoseFilterHistory history(&filter, &filter_space, capacity);
+	int rewind_count= 0;
+
+	for (const PoseSensorPacket &packet : arrival_order)
+	{
+		if (history.getIsLateSensorPacket(packet))
+		{
+			const int replay_count= history.computeReplayCount(packet);
+
+			if (replay_count >= 0)
+			{
+				history.rewindAndApplySensorPacket(packet, replay_count);
+				++rewind_count;
+				continue;
+			}
+		}
+
+		history.applySensorPacket(packet);
+	}
+
+	return rewind_count;
+}
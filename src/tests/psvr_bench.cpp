@@ -0,0 +1,120 @@
+//-- includes -----
+#include "benchmark.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+//-- prototypes -----
+void run_image_processing_benchmarks(BenchmarkSuite &suite);
+void run_pose_estimation_benchmarks(BenchmarkSuite &suite);
+void run_service_benchmarks(BenchmarkSuite &suite);
+
+static void print_usage();
+
+//-- entry point -----
+int
+main(int argc, char* argv[])
+{
+	BenchmarkOptions options;
+	std::string output_path("psvr_bench_results.json");
+	std::string baseline_path;
+	std::string save_baseline_path;
+	double tolerance= 0.1;
+
+	for (int arg_index = 1; arg_index < argc; ++arg_index)
+	{
+		const char *arg= argv[arg_index];
+		const char *value= (arg_index + 1 < argc) ? argv[arg_index + 1] : nullptr;
+
+		if (strcmp(arg, "--help") == 0)
+		{
+			print_usage();
+			return EXIT_SUCCESS;
+		}
+		else if (value == nullptr)
+		{
+			fprintf(stderr, "Missing value for %s\n", arg);
+			print_usage();
+			return EXIT_FAILURE;
+		}
+		else if (strcmp(arg, "--filter") == 0)
+			options.filter= value;
+		else if (strcmp(arg, "--micro-time") == 0)
+			options.micro_time= atof(value);
+		else if (strcmp(arg, "--service-time") == 0)
+			options.service_time= atof(value);
+		else if (strcmp(arg, "--trackers") == 0)
+			options.synthetic_tracker_count= atoi(value);
+		else if (strcmp(arg, "--hmds") == 0)
+			options.synthetic_hmd_count= atoi(value);
+		else if (strcmp(arg, "--replay") == 0)
+			options.replay_path= value;
+		else if (strcmp(arg, "--config-dir") == 0)
+			options.config_directory= value;
+		else if (strcmp(arg, "--output") == 0)
+			output_path= value;
+		else if (strcmp(arg, "--baseline") == 0)
+			baseline_path= value;
+		else if (strcmp(arg, "--tolerance") == 0)
+			tolerance= atof(value);
+		else if (strcmp(arg, "--save-baseline") == 0)
+			save_baseline_path= value;
+		else
+		{
+			fprintf(stderr, "Unknown argument %s\n", arg);
+			print_usage();
+			return EXIT_FAILURE;
+		}
+
+		++arg_index; // consumed the value
+	}
+
+	BenchmarkSuite suite(options);
+	run_image_processing_benchmarks(suite);
+	run_pose_estimation_benchmarks(suite);
+	run_service_benchmarks(suite);
+
+	bool success= suite.writeResults(output_path);
+
+	if (!save_baseline_path.empty())
+	{
+		success&= suite.writeResults(save_baseline_path);
+	}
+
+	if (!baseline_path.empty())
+	{
+		const int regression_count= suite.compareToBaseline(baseline_path, tolerance);
+
+		if (regression_count != 0)
+		{
+			if (regression_count > 0)
+			{
+				fprintf(stderr, "%d benchmark(s) regressed\n", regression_count);
+			}
+			success= false;
+		}
+	}
+
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+//-- private functions -----
+static void print_usage()
+{
+	fprintf(stdout,
+		"usage: psvr_bench [options]\n"
+		"  --filter <text>          only run benchmarks whose name contains <text>\n"
+		"  --micro-time <seconds>   sampling time per micro-benchmark (default 1)\n"
+		"  --service-time <seconds> run time of the service macro-benchmark (default 10)\n"
+		"  --trackers <count>       synthetic trackers in the service macro-benchmark (default 2)\n"
+		"  --hmds <count>           virtual HMDs in the service macro-benchmark (default 2)\n"
+		"  --replay <recording>     also replay this session recording as fast as possible\n"
+		"  --config-dir <path>      where the service configs of the benchmark run are written\n"
+		"  --output <json>          results file (default psvr_bench_results.json)\n"
+		"  --save-baseline <json>   also write the results as a new baseline\n"
+		"  --baseline <json>        compare against a baseline and fail on regressions\n"
+		"  --tolerance <fraction>   allowed slowdown before a result regresses (default 0.1)\n"
+		"No baseline is checked in since timings are machine specific. Record one with\n"
+		"--save-baseline on the machine that runs the comparison, then pass it to --baseline.\n");
+}
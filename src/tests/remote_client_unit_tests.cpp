@@ -0,0 +1,334 @@
+//-- includes -----
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+
+#include <functional>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "PSVRRemoteClient_CAPI.h"
+#include "LocalServiceProtocol.h"
+#include "SharedDataFrameBuffer.h"
+#include "unit_test.h"
+
+//-- constants -----
+static const char *k_test_socket_path= "/tmp/psvr_remote_client_unit_test.sock";
+static const int k_test_timeout_ms= 1000;
+static const char *k_test_version_string= "remote_client_unit_test";
+
+//-- definitions -----
+typedef std::function<void(int client_socket)> t_fake_daemon_script;
+
+// Stands in for psvrservice on the other end of the socket.
+// Accepts a single client and runs the given script against it on its own thread.
+class FakeDaemon
+{
+public:
+	FakeDaemon()
+		: m_listenSocket(-1)
+		, m_thread()
+	{}
+
+	~FakeDaemon()
+	{
+		stop();
+	}
+
+	bool start(const t_fake_daemon_script &script)
+	{
+		struct sockaddr_un address;
+		memset(&address, 0, sizeof(address));
+		address.sun_family= AF_UNIX;
+		strncpy(address.sun_path, k_test_socket_path, sizeof(address.sun_path) - 1);
+
+		unlink(k_test_socket_path);
+		m_listenSocket= socket(AF_UNIX, SOCK_STREAM, 0);
+		if (m_listenSocket < 0 ||
+			bind(m_listenSocket, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)) != 0 ||
+			listen(m_listenSocket, 1) != 0)
+		{
+			stop();
+			return false;
+		}
+
+		const int listen_socket= m_listenSocket;
+		m_thread= std::thread([listen_socket, script]() {
+			const int client_socket= accept(listen_socket, nullptr, nullptr);
+
+			if (client_socket >= 0)
+			{
+				script(client_socket);
+				close(client_socket);
+			}
+		});
+
+		return true;
+	}
+
+	void stop()
+	{
+		// Wakes the script thread up if it's still waiting in accept()
+		if (m_listenSocket >= 0)
+		{
+			shutdown(m_listenSocket, SHUT_RDWR);
+		}
+
+		if (m_thread.joinable())
+		{
+			m_thread.join();
+		}
+
+		if (m_listenSocket >= 0)
+		{
+			close(m_listenSocket);
+			m_listenSocket= -1;
+			unlink(k_test_socket_path);
+		}
+	}
+
+private:
+	int m_listenSocket;
+	std::thread m_thread;
+};
+
+//-- globals -----
+// Stands in for the daemon's data frame region while the module runs
+static SharedDataFrameBuffer *g_test_data_frame_buffer= nullptr;
+
+//-- private methods -----
+static bool receive_request(int client_socket, LocalServiceRequest &out_request);
+static bool send_response(int client_socket, const LocalServiceResponse &response);
+static void init_response(const LocalServiceRequest &request, LocalServiceResponse &out_response);
+
+//-- public interface -----
+bool run_remote_client_unit_tests()
+{
+	UNIT_TEST_MODULE_BEGIN("remote_client")
+
+	// The client maps the daemon's data frame region, so the test has to publish it.
+	// Creating it would take it away from a daemon running on this machine, so back off if there is one.
+	SharedDataFrameBuffer data_frame_buffer;
+	if (data_frame_buffer.open(PSVR_SHARED_DATA_FRAME_BUFFER_NAME))
+	{
+		fprintf(stdout, "    skipped, a psvrservice daemon is already running\n");
+		data_frame_buffer.dispose();
+	}
+	else if (data_frame_buffer.initialize(PSVR_SHARED_DATA_FRAME_BUFFER_NAME))
+	{
+		g_test_data_frame_buffer= &data_frame_buffer;
+
+		UNIT_TEST_MODULE_CALL_TEST(remote_client_test_connect_without_daemon);
+		UNIT_TEST_MODULE_CALL_TEST(remote_client_test_request_round_trip);
+		UNIT_TEST_MODULE_CALL_TEST(remote_client_test_hmd_state_from_shared_buffer);
+		UNIT_TEST_MODULE_CALL_TEST(remote_client_test_daemon_hangs_up);
+
+		g_test_data_frame_buffer= nullptr;
+		data_frame_buffer.dispose();
+	}
+	else
+	{
+		fprintf(stdout, "    failed to create the data frame buffer\n");
+		success= false;
+	}
+
+	UNIT_TEST_MODULE_END()
+}
+
+//-- private functions -----
+// Connecting fails cleanly when nothing is listening
+bool
+remote_client_test_connect_without_daemon()
+{
+	UNIT_TEST_BEGIN("connect without daemon")
+
+	unlink(k_test_socket_path);
+
+	success=
+		PSVR_RemoteConnect(k_test_socket_path, k_test_timeout_ms, PSVRLogSeverityLevel_fatal) == PSVRResult_Error &&
+		!PSVR_RemoteGetIsConnected() &&
+		PSVR_RemoteGetVersionString(nullptr, 0) == PSVRResult_Error;
+	assert(success);
+
+	UNIT_TEST_COMPLETE()
+}
+
+// Responses get matched to their request, notifications in between get queued
+bool
+remote_client_test_request_round_trip()
+{
+	UNIT_TEST_BEGIN("request round trip")
+
+	FakeDaemon daemon;
+	success= daemon.start([](int client_socket) {
+		LocalServiceRequest request;
+		LocalServiceResponse response;
+
+		// Version request, with a notification sneaking in ahead of the response
+		if (!receive_request(client_socket, request) || request.request_type != LocalServiceRequest_getServiceVersion)
+			return;
+
+		memset(&response, 0, sizeof(response));
+		response.protocol_version= PSVR_LOCAL_SERVICE_PROTOCOL_VERSION;
+		response.request_id= 0;
+		response.response_type= LocalServiceResponse_notification;
+		response.payload.event_message.event_type= PSVREvent_trackerListUpdated;
+		send_response(client_socket, response);
+
+		init_response(request, response);
+		strncpy(response.payload.service_version.version_string, k_test_version_string, PSVRSERVICE_MAX_VERSION_STRING_LEN - 1);
+		send_response(client_socket, response);
+
+		// Tracker requests are answered with whatever result the daemon wants
+		if (!receive_request(client_socket, request) || request.request_type != LocalServiceRequest_startTrackerDataStream)
+			return;
+
+		init_response(request, response);
+		response.result= (request.payload.tracker_request.tracker_id == 1) ? PSVRResult_Success : PSVRResult_Error;
+		send_response(client_socket, response);
+	});
+
+	if (success)
+	{
+		char version_string[PSVRSERVICE_MAX_VERSION_STRING_LEN];
+		PSVREventMessage message;
+
+		success= PSVR_RemoteConnect(k_test_socket_path, k_test_timeout_ms, PSVRLogSeverityLevel_fatal) == PSVRResult_Success;
+		success&= PSVR_RemoteGetVersionString(version_string, sizeof(version_string)) == PSVRResult_Success;
+		success&= strcmp(version_string, k_test_version_string) == 0;
+
+		// The notification that arrived while waiting on the response was queued, not dropped
+		success&= PSVR_RemotePollNextMessage(&message, sizeof(message)) == PSVRResult_Success;
+		success&= message.event_type == PSVREvent_trackerListUpdated;
+		success&= PSVR_RemotePollNextMessage(&message, sizeof(message)) == PSVRResult_NoData;
+
+		success&= PSVR_RemoteStartTrackerDataStream(1) == PSVRResult_Success;
+
+		// Invalid ids never reach the daemon
+		success&= PSVR_RemoteStartTrackerDataStream(-1) == PSVRResult_Error;
+		success&= PSVR_RemoteStartHmdDataStream(PSVRSERVICE_MAX_HMD_COUNT, 0) == PSVRResult_Error;
+	}
+	assert(success);
+
+	PSVR_RemoteDisconnect();
+	daemon.stop();
+
+	UNIT_TEST_COMPLETE()
+}
+
+// HMD state is read straight out of the shared data frame region, not over the socket
+bool
+remote_client_test_hmd_state_from_shared_buffer()
+{
+	UNIT_TEST_BEGIN("hmd state from shared buffer")
+
+	FakeDaemon daemon;
+	success= daemon.start([](int client_socket) {
+		// Hold the connection open until the client hangs up
+		LocalServiceRequest request;
+		receive_request(client_socket, request);
+	});
+
+	if (success)
+	{
+		PSVRHeadMountedDisplay hmd;
+		memset(&hmd, 0, sizeof(hmd));
+		hmd.OutputSequenceNum= -1;
+
+		success= PSVR_RemoteConnect(k_test_socket_path, k_test_timeout_ms, PSVRLogSeverityLevel_fatal) == PSVRResult_Success;
+
+		// Nothing published for the hmd yet
+		success&= PSVR_RemoteGetHmdState(0, &hmd) == PSVRResult_NoData;
+
+		DeviceOutputDataFrame data_frame;
+		memset(&data_frame, 0, sizeof(data_frame));
+		data_frame.device_category= DeviceCategory_HMD;
+		data_frame.device.hmd_data_packet.hmd_id= 0;
+		data_frame.device.hmd_data_packet.hmd_type= PSVRHmd_Virtual;
+		data_frame.device.hmd_data_packet.is_valid= true;
+		data_frame.device.hmd_data_packet.is_connected= true;
+		data_frame.device.hmd_data_packet.output_sequence_num= 7;
+		data_frame.device.hmd_data_packet.imu_sensor_age_ms= -1.f;
+		data_frame.device.hmd_data_packet.optical_sensor_age_ms= 4.f;
+		g_test_data_frame_buffer->writeDataFrame(data_frame);
+
+		success&= PSVR_RemoteGetHmdState(0, &hmd) == PSVRResult_Success;
+		success&= hmd.HmdType == PSVRHmd_Virtual && hmd.IsConnected && hmd.bValid;
+		success&= hmd.OutputSequenceNum == 7 && hmd.OpticalSensorAgeMs == 4.f;
+
+		// Same frame again is reported as no new data
+		success&= PSVR_RemoteGetHmdState(0, &hmd) == PSVRResult_NoData;
+	}
+	assert(success);
+
+	PSVR_RemoteDisconnect();
+	daemon.stop();
+
+	UNIT_TEST_COMPLETE()
+}
+
+// A dropped connection fails the pending request and leaves the client disconnected
+bool
+remote_client_test_daemon_hangs_up()
+{
+	UNIT_TEST_BEGIN("daemon hangs up")
+
+	FakeDaemon daemon;
+	success= daemon.start([](int client_socket) {
+		// Drop the client without answering its request
+		LocalServiceRequest request;
+		receive_request(client_socket, request);
+	});
+
+	if (success)
+	{
+		PSVRTrackerList tracker_list;
+
+		success= PSVR_RemoteConnect(k_test_socket_path, k_test_timeout_ms, PSVRLogSeverityLevel_fatal) == PSVRResult_Success;
+		success&= PSVR_RemoteGetTrackerList(&tracker_list) == PSVRResult_Error;
+		success&= !PSVR_RemoteGetIsConnected();
+		success&= PSVR_RemoteUpdate() == PSVRResult_Error;
+	}
+	assert(success);
+
+	PSVR_RemoteDisconnect();
+	daemon.stop();
+
+	UNIT_TEST_COMPLETE()
+}
+
+static bool receive_request(int client_socket, LocalServiceRequest &out_request)
+{
+	unsigned char *request_bytes= reinterpret_cast<unsigned char *>(&out_request);
+	size_t bytes_read= 0;
+
+	while (bytes_read < sizeof(LocalServiceRequest))
+	{
+		const ssize_t result= recv(client_socket, request_bytes + bytes_read, sizeof(LocalServiceRequest) - bytes_read, 0);
+
+		if (result <= 0)
+			return false;
+
+		bytes_read+= static_cast<size_t>(result);
+	}
+
+	return out_request.protocol_version == PSVR_LOCAL_SERVICE_PROTOCOL_VERSION;
+}
+
+static bool send_response(int client_socket, const LocalServiceResponse &response)
+{
+	return send(client_socket, &response, sizeof(response), 0) == static_cast<ssize_t>(sizeof(response));
+}
+
+static void init_response(const LocalServiceRequest &request, LocalServiceResponse &out_response)
+{
+	memset(&out_response, 0, sizeof(out_response));
+	out_response.protocol_version= PSVR_LOCAL_SERVICE_PROTOCOL_VERSION;
+	out_response.request_id= request.request_id;
+	out_response.response_type= LocalServiceResponse_result;
+	out_response.result= PSVRResult_Success;
+}
@@ -0,0 +1,341 @@
+//-- includes -----
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "TrackerBlobExtractor.h"
+#include "unit_test.h"
+
+//-- constants -----
+static const int k_max_test_blob_count= 64;
+
+//-- private methods -----
+static std::vector<uint8_t> make_mask(const char **rows, int width, int height);
+static int extract_reference_blobs(
+	const uint8_t *mask, int width, int height, int origin_x, int origin_y, int min_blob_area,
+	TrackerBlob *out_blobs, int max_blob_count);
+static bool blobs_are_equal(const TrackerBlob &a, const TrackerBlob &b);
+
+//-- public interface -----
+bool run_tracker_blob_extractor_unit_tests()
+{
+	UNIT_TEST_MODULE_BEGIN("tracker_blob_extractor")
+		UNIT_TEST_MODULE_CALL_TEST(tracker_blob_extractor_test_touching_blobs);
+		UNIT_TEST_MODULE_CALL_TEST(tracker_blob_extractor_test_u_shapes);
+		UNIT_TEST_MODULE_CALL_TEST(tracker_blob_extractor_test_edge_rows);
+		UNIT_TEST_MODULE_CALL_TEST(tracker_blob_extractor_test_min_blob_area);
+		UNIT_TEST_MODULE_CALL_TEST(tracker_blob_extractor_test_random_masks);
+	UNIT_TEST_MODULE_END()
+}
+
+//-- private functions -----
+bool
+tracker_blob_extractor_test_touching_blobs()
+{
+	UNIT_TEST_BEGIN("touching blobs")
+
+	// Diagonal neighbors are 8-connected, so the left shape is one blob.
+	// The right square is separated from it by a one pixel gap.
+	const char *rows[]= {
+		"XX.......",
+		"XX....XX.",
+		"..X...XX.",
+		"...XX....",
+	};
+	const int width= 9, height= 4;
+	const std::vector<uint8_t> mask= make_mask(rows, width, height);
+
+	TrackerBlobExtractor extractor;
+	TrackerBlob blobs[k_max_test_blob_count];
+	const int blob_count= extractor.extractBiggestNBlobs(mask.data(), width, width, height, 0, 0, 1, blobs, k_max_test_blob_count);
+
+	success= blob_count == 2;
+	success&= blobs[0].area == 7 && blobs[0].min_x == 0 && blobs[0].max_x == 4 && blobs[0].min_y == 0 && blobs[0].max_y == 3;
+	success&= blobs[1].area == 4 && blobs[1].min_x == 6 && blobs[1].max_x == 7 && blobs[1].min_y == 1 && blobs[1].max_y == 2;
+	success&= blobs[1].center_x == 6.5f && blobs[1].center_y == 1.5f;
+	assert(success);
+
+	UNIT_TEST_COMPLETE()
+}
+
+bool
+tracker_blob_extractor_test_u_shapes()
+{
+	UNIT_TEST_BEGIN("u shapes")
+
+	// Arms are labeled separately and only merge on a later row (U),
+	// or start merged and then split (upside down U).
+	// The last shape chains several merges through one wide run.
+	const char *rows[]= {
+		"X...X..XXXXX..X.X.X.X",
+		"X...X..X...X..X.X.X.X",
+		"X...X..X...X..X.X.X.X",
+		"XXXXX..X...X..XXXXXXX",
+	};
+	const int width= 21, height= 4;
+	const std::vector<uint8_t> mask= make_mask(rows, width, height);
+
+	TrackerBlobExtractor extractor;
+	TrackerBlob blobs[k_max_test_blob_count];
+	const int blob_count= extractor.extractBiggestNBlobs(mask.data(), width, width, height, 0, 0, 1, blobs, k_max_test_blob_count);
+
+	TrackerBlob reference_blobs[k_max_test_blob_count];
+	const int reference_blob_count= extract_reference_blobs(mask.data(), width, height, 0, 0, 1, reference_blobs, k_max_test_blob_count);
+
+	success= blob_count == 3 && blob_count == reference_blob_count;
+	success&= blobs[0].area == 19 && blobs[1].area == 11 && blobs[2].area == 11;
+	// Equal areas come out in scan order
+	success&= blobs[1].min_x == 0 && blobs[2].min_x == 7;
+	for (int blob_index= 0; success && blob_index < blob_count; ++blob_index)
+	{
+		success= blobs_are_equal(blobs[blob_index], reference_blobs[blob_index]);
+	}
+	assert(success);
+
+	UNIT_TEST_COMPLETE()
+}
+
+bool
+tracker_blob_extractor_test_edge_rows()
+{
+	UNIT_TEST_BEGIN("edge rows")
+
+	// Blobs on the first and last rows and columns, in a mask wider than the
+	// 8 byte zero skip with a stride larger than the width and an ROI origin.
+	const char *rows[]= {
+		"XXX.........X......X",
+		"...................X",
+		"....................",
+		"X.......XX..........",
+		"X......XXXX.......XX",
+	};
+	const int width= 20, height= 5;
+	const int mask_stride= 32;
+	const int origin_x= 100, origin_y= 50;
+	const std::vector<uint8_t> tight_mask= make_mask(rows, width, height);
+
+	std::vector<uint8_t> mask(mask_stride*height, 0);
+	for (int y= 0; y < height; ++y)
+	{
+		for (int x= 0; x < width; ++x)
+		{
+			mask[y*mask_stride + x]= tight_mask[y*width + x];
+		}
+		// Padding past the width must be ignored
+		mask[y*mask_stride + width]= 0xFF;
+	}
+
+	TrackerBlobExtractor extractor;
+	TrackerBlob blobs[k_max_test_blob_count];
+	const int blob_count= extractor.extractBiggestNBlobs(mask.data(), mask_stride, width, height, origin_x, origin_y, 1, blobs, k_max_test_blob_count);
+
+	TrackerBlob reference_blobs[k_max_test_blob_count];
+	const int reference_blob_count= extract_reference_blobs(tight_mask.data(), width, height, origin_x, origin_y, 1, reference_blobs, k_max_test_blob_count);
+
+	success= blob_count == 6 && blob_count == reference_blob_count;
+	for (int blob_index= 0; success && blob_index < blob_count; ++blob_index)
+	{
+		success= blobs_are_equal(blobs[blob_index], reference_blobs[blob_index]);
+	}
+	success&= blobs[0].area == 6 && blobs[0].min_x == origin_x + 7 && blobs[0].max_y == origin_y + 4;
+	assert(success);
+
+	UNIT_TEST_COMPLETE()
+}
+
+bool
+tracker_blob_extractor_test_min_blob_area()
+{
+	UNIT_TEST_BEGIN("min blob area")
+
+	// min_blob_area is a pixel count: a blob with exactly min_blob_area pixels is kept
+	const char *rows[]= {
+		"XXX..XX...X",
+		"XXX..XX....",
+		".....X.....",
+	};
+	const int width= 11, height= 3;
+	const std::vector<uint8_t> mask= make_mask(rows, width, height);
+
+	TrackerBlobExtractor extractor;
+	TrackerBlob blobs[k_max_test_blob_count];
+
+	success= extractor.extractBiggestNBlobs(mask.data(), width, width, height, 0, 0, 5, blobs, k_max_test_blob_count) == 2;
+	success&= blobs[0].area == 6 && blobs[1].area == 5;
+	success&= extractor.extractBiggestNBlobs(mask.data(), width, width, height, 0, 0, 6, blobs, k_max_test_blob_count) == 1;
+	success&= extractor.extractBiggestNBlobs(mask.data(), width, width, height, 0, 0, 7, blobs, k_max_test_blob_count) == 0;
+	// max_blob_count keeps the biggest
+	success&= extractor.extractBiggestNBlobs(mask.data(), width, width, height, 0, 0, 1, blobs, 1) == 1;
+	success&= blobs[0].area == 6;
+	assert(success);
+
+	UNIT_TEST_COMPLETE()
+}
+
+// Random masks against a per pixel flood fill labeler, reusing one extractor
+// so stale working storage from a previous call would show up
+bool
+tracker_blob_extractor_test_random_masks()
+{
+	UNIT_TEST_BEGIN("random masks")
+
+	const int width= 45, height= 33;
+	std::vector<uint8_t> mask(width*height);
+	TrackerBlobExtractor extractor;
+	TrackerBlob blobs[k_max_test_blob_count];
+	TrackerBlob reference_blobs[k_max_test_blob_count];
+	unsigned int state= 42;
+
+	for (int iteration= 0; success && iteration < 200; ++iteration)
+	{
+		// Vary the fill rate so both sparse dots and large merged regions get covered
+		const unsigned int fill_threshold= 40 + (iteration % 5) * 30;
+		for (uint8_t &pixel : mask)
+		{
+			state= state*1664525u + 1013904223u;
+			pixel= ((state >> 24) < fill_threshold) ? 0xFF : 0x00;
+		}
+
+		const int min_blob_area= 1 + (iteration % 3);
+		const int max_blob_count= (iteration % 2 == 0) ? k_max_test_blob_count : 4;
+		const int blob_count= extractor.extractBiggestNBlobs(mask.data(), width, width, height, 3, 7, min_blob_area, blobs, max_blob_count);
+		const int reference_blob_count= extract_reference_blobs(mask.data(), width, height, 3, 7, min_blob_area, reference_blobs, max_blob_count);
+
+		success= blob_count == reference_blob_count;
+		for (int blob_index= 0; success && blob_index < blob_count; ++blob_index)
+		{
+			success= blobs_are_equal(blobs[blob_index], reference_blobs[blob_index]);
+		}
+
+		if (!success)
+		{
+			fprintf(stderr, "    iteration %d differs from the reference labeler\n", iteration);
+		}
+	}
+	assert(success);
+
+	UNIT_TEST_COMPLETE()
+}
+
+static std::vector<uint8_t> make_mask(const char **rows, int width, int height)
+{
+	std::vector<uint8_t> mask(width*height);
+
+	for (int y= 0; y < height; ++y)
+	{
+		for (int x= 0; x < width; ++x)
+		{
+			mask[y*width + x]= (rows[y][x] == 'X') ? 0xFF : 0x00;
+		}
+	}
+
+	return mask;
+}
+
+// Labels pixels with an 8-connected flood fill, seeded in scan order,
+// then sorts the blobs by area (ties in scan order) like the extractor does
+static int extract_reference_blobs(
+	const uint8_t *mask, int width, int height, int origin_x, int origin_y, int min_blob_area,
+	TrackerBlob *out_blobs, int max_blob_count)
+{
+	std::vector<int> labels(width*height, -1);
+	std::vector<TrackerBlob> blobs;
+	std::vector<int> stack;
+
+	for (int seed= 0; seed < width*height; ++seed)
+	{
+		if (mask[seed] == 0 || labels[seed] != -1)
+			continue;
+
+		const int label= static_cast<int>(blobs.size());
+		double sum_x= 0, sum_y= 0, sum_xx= 0, sum_yy= 0, sum_xy= 0;
+		TrackerBlob blob;
+		blob.area= 0;
+		blob.min_x= blob.max_x= seed % width;
+		blob.min_y= blob.max_y= seed / width;
+
+		labels[seed]= label;
+		stack.push_back(seed);
+		while (!stack.empty())
+		{
+			const int pixel= stack.back();
+			const int x= pixel % width;
+			const int y= pixel / width;
+			stack.pop_back();
+
+			++blob.area;
+			sum_x+= x; sum_y+= y;
+			sum_xx+= x*x; sum_yy+= y*y; sum_xy+= x*y;
+			blob.min_x= std::min(blob.min_x, x); blob.max_x= std::max(blob.max_x, x);
+			blob.min_y= std::min(blob.min_y, y); blob.max_y= std::max(blob.max_y, y);
+
+			for (int dy= -1; dy <= 1; ++dy)
+			{
+				for (int dx= -1; dx <= 1; ++dx)
+				{
+					const int nx= x + dx, ny= y + dy;
+					if (nx < 0 || nx >= width || ny < 0 || ny >= height)
+						continue;
+
+					const int neighbor= ny*width + nx;
+					if (mask[neighbor] != 0 && labels[neighbor] == -1)
+					{
+						labels[neighbor]= label;
+						stack.push_back(neighbor);
+					}
+				}
+			}
+		}
+
+		const double area= blob.area;
+		const double mean_x= sum_x / area;
+		const double mean_y= sum_y / area;
+		blob.center_x= static_cast<float>(mean_x + origin_x);
+		blob.center_y= static_cast<float>(mean_y + origin_y);
+		blob.min_x+= origin_x; blob.max_x+= origin_x;
+		blob.min_y+= origin_y; blob.max_y+= origin_y;
+		blob.mu20= static_cast<float>(sum_xx / area - mean_x*mean_x);
+		blob.mu11= static_cast<float>(sum_xy / area - mean_x*mean_y);
+		blob.mu02= static_cast<float>(sum_yy / area - mean_y*mean_y);
+
+		blobs.push_back(blob);
+	}
+
+	std::vector<int> sorted_blobs;
+	for (int blob_index= 0; blob_index < static_cast<int>(blobs.size()); ++blob_index)
+	{
+		if (blobs[blob_index].area >= min_blob_area)
+		{
+			sorted_blobs.push_back(blob_index);
+		}
+	}
+	std::stable_sort(
+		sorted_blobs.begin(), sorted_blobs.end(),
+		[&blobs](int a, int b) { return blobs[a].area > blobs[b].area; });
+
+	const int blob_count= std::min(max_blob_count, static_cast<int>(sorted_blobs.size()));
+	for (int blob_index= 0; blob_index < blob_count; ++blob_index)
+	{
+		out_blobs[blob_index]= blobs[sorted_blobs[blob_index]];
+	}
+
+	return blob_count;
+}
+
+static bool blobs_are_equal(const TrackerBlob &a, const TrackerBlob &b)
+{
+	const float k_tolerance= 1e-4f;
+
+	return
+		a.area == b.area &&
+		a.min_x == b.min_x && a.min_y == b.min_y && a.max_x == b.max_x && a.max_y == b.max_y &&
+		std::fabs(a.center_x - b.center_x) <= k_tolerance &&
+		std::fabs(a.center_y - b.center_y) <= k_tolerance &&
+		std::fabs(a.mu20 - b.mu20) <= k_tolerance &&
+		std::fabs(a.mu11 - b.mu11) <= k_tolerance &&
+		std::fabs(a.mu02 - b.mu02) <= k_tolerance;
+}
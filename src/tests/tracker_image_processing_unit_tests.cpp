@@ -0,0 +1,349 @@
+//-- includes -----
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "TrackerImageProcessing.h"
+#include "unit_test.h"
+
+//-- constants -----
+static const int k_test_frame_width= 61; // Not a multiple of 4, so every row also runs the scalar tail
+static const int k_test_frame_height= 37;
+
+//-- private methods -----
+static std::vector<PSVR_HSVColorRange> make_test_color_ranges();
+static void fill_random_bytes(std::vector<uint8_t> &buffer, unsigned int seed);
+static void compute_legacy_hsv_mask(
+	const uint8_t *bgr, int pixel_count, const PSVR_HSVColorRange &hsvColorRange, uint8_t *out_mask);
+
+//-- public interface -----
+bool run_tracker_image_processing_unit_tests()
+{
+	UNIT_TEST_MODULE_BEGIN("tracker_image_processing")
+		UNIT_TEST_MODULE_CALL_TEST(tracker_image_processing_test_mask_matches_legacy_all_colors);
+		UNIT_TEST_MODULE_CALL_TEST(tracker_image_processing_test_simd_matches_scalar);
+		UNIT_TEST_MODULE_CALL_TEST(tracker_image_processing_test_multi_mask_matches_single_mask);
+		UNIT_TEST_MODULE_CALL_TEST(tracker_image_processing_test_bayer_matches_debayered_bgr);
+	UNIT_TEST_MODULE_END()
+}
+
+//-- private functions -----
+// Every 8-bit BGR color against the old cv::cvtColor(COLOR_BGR2HSV) + cv::inRange path,
+// including hue ranges that wrap below 0 and above 180
+bool
+tracker_image_processing_test_mask_matches_legacy_all_colors()
+{
+	UNIT_TEST_BEGIN("mask matches legacy cvtColor + inRange (all colors)")
+
+	const std::vector<PSVR_HSVColorRange> color_ranges= make_test_color_ranges();
+
+	// One 256x256 plane of (g, r) colors per blue value
+	const int k_plane_pixel_count= 256*256;
+	std::vector<uint8_t> bgr(k_plane_pixel_count*3);
+	std::vector<uint8_t> mask(k_plane_pixel_count);
+	std::vector<uint8_t> legacy_mask(k_plane_pixel_count);
+
+	for (size_t range_index= 0; success && range_index < color_ranges.size(); ++range_index)
+	{
+		const PSVR_HSVColorRange &color_range= color_ranges[range_index];
+		const HSVColorThresholds thresholds= HSVColorThresholds::fromColorRange(color_range);
+
+		for (int b= 0; success && b < 256; ++b)
+		{
+			for (int i= 0; i < k_plane_pixel_count; ++i)
+			{
+				bgr[i*3 + 0]= static_cast<uint8_t>(b);
+				bgr[i*3 + 1]= static_cast<uint8_t>(i >> 8);
+				bgr[i*3 + 2]= static_cast<uint8_t>(i & 0xFF);
+			}
+
+			computeHSVMaskFromBGR(bgr.data(), 256*3, 256, 256, thresholds, mask.data(), 256);
+			compute_legacy_hsv_mask(bgr.data(), k_plane_pixel_count, color_range, legacy_mask.data());
+
+			success= (mask == legacy_mask);
+		}
+
+		if (!success)
+		{
+			fprintf(stderr, "    color range %d differs from the legacy mask\n", static_cast<int>(range_index));
+		}
+	}
+	assert(success);
+
+	UNIT_TEST_COMPLETE()
+}
+
+// A one pixel wide region never reaches the SSE2 loop, so it exercises the scalar path on its own
+bool
+tracker_image_processing_test_simd_matches_scalar()
+{
+	UNIT_TEST_BEGIN("simd matches scalar")
+
+	const std::vector<PSVR_HSVColorRange> color_ranges= make_test_color_ranges();
+	const int k_bgr_stride= k_test_frame_width*3;
+
+	std::vector<uint8_t> bgr(k_bgr_stride*k_test_frame_height);
+	std::vector<uint8_t> mask(k_test_frame_width*k_test_frame_height);
+	fill_random_bytes(bgr, 1234);
+
+	for (size_t range_index= 0; success && range_index < color_ranges.size(); ++range_index)
+	{
+		const HSVColorThresholds thresholds= HSVColorThresholds::fromColorRange(color_ranges[range_index]);
+
+		computeHSVMaskFromBGR(
+			bgr.data(), k_bgr_stride, k_test_frame_width, k_test_frame_height,
+			thresholds, mask.data(), k_test_frame_width);
+
+		for (int y= 0; success && y < k_test_frame_height; ++y)
+		{
+			for (int x= 0; success && x < k_test_frame_width; ++x)
+			{
+				uint8_t scalar_mask= 0;
+				computeHSVMaskFromBGR(bgr.data() + y*k_bgr_stride + x*3, k_bgr_stride, 1, 1, thresholds, &scalar_mask, 1);
+
+				success= (scalar_mask == mask[y*k_test_frame_width + x]);
+			}
+		}
+	}
+	assert(success);
+
+	UNIT_TEST_COMPLETE()
+}
+
+bool
+tracker_image_processing_test_multi_mask_matches_single_mask()
+{
+	UNIT_TEST_BEGIN("multi mask matches single mask")
+
+	const std::vector<PSVR_HSVColorRange> color_ranges= make_test_color_ranges();
+	const int mask_count= std::min(static_cast<int>(color_ranges.size()), HSV_MASK_MAX_COUNT);
+	const int k_bgr_stride= k_test_frame_width*3;
+	const int k_mask_size= k_test_frame_width*k_test_frame_height;
+
+	std::vector<uint8_t> bgr(k_bgr_stride*k_test_frame_height);
+	fill_random_bytes(bgr, 5678);
+
+	HSVColorThresholds thresholds[HSV_MASK_MAX_COUNT];
+	std::vector<uint8_t> masks(k_mask_size*mask_count);
+	uint8_t *mask_pointers[HSV_MASK_MAX_COUNT];
+	for (int mask_index= 0; mask_index < mask_count; ++mask_index)
+	{
+		thresholds[mask_index]= HSVColorThresholds::fromColorRange(color_ranges[mask_index]);
+		mask_pointers[mask_index]= masks.data() + mask_index*k_mask_size;
+	}
+
+	computeHSVMasksFromBGR(
+		bgr.data(), k_bgr_stride, k_test_frame_width, k_test_frame_height,
+		thresholds, mask_count, mask_pointers, k_test_frame_width);
+
+	std::vector<uint8_t> single_mask(k_mask_size);
+	for (int mask_index= 0; success && mask_index < mask_count; ++mask_index)
+	{
+		computeHSVMaskFromBGR(
+			bgr.data(), k_bgr_stride, k_test_frame_width, k_test_frame_height,
+			thresholds[mask_index], single_mask.data(), k_test_frame_width);
+
+		success= std::equal(single_mask.begin(), single_mask.end(), masks.begin() + mask_index*k_mask_size);
+	}
+	assert(success);
+
+	UNIT_TEST_COMPLETE()
+}
+
+// The row-at-a-time demosaic has to give the same mask as debayering the whole frame first,
+// including the replicated first/last rows and columns
+bool
+tracker_image_processing_test_bayer_matches_debayered_bgr()
+{
+	UNIT_TEST_BEGIN("bayer matches debayered bgr")
+
+	const std::vector<PSVR_HSVColorRange> color_ranges= make_test_color_ranges();
+	const int k_frame_width= 64;
+	const int k_frame_height= 48;
+	const int k_bgr_stride= k_frame_width*3;
+
+	std::vector<uint8_t> bayer(k_frame_width*k_frame_height);
+	fill_random_bytes(bayer, 4321);
+
+	std::vector<uint8_t> bgr(k_bgr_stride*k_frame_height);
+	debayerGRBGToBGR(k_frame_width, k_frame_height, bayer.data(), bgr.data(), true);
+
+	// Whole frame (touches every edge) and an odd sized interior region
+	const int k_roi_count= 2;
+	const int rois[k_roi_count][4]= {
+		{0, 0, k_frame_width, k_frame_height},
+		{5, 3, 31, 17}
+	};
+
+	std::vector<uint8_t> scratch(k_frame_width*3);
+	std::vector<uint8_t> bayer_mask(k_frame_width*k_frame_height);
+	std::vector<uint8_t> bgr_mask(k_frame_width*k_frame_height);
+
+	for (size_t range_index= 0; success && range_index < color_ranges.size(); ++range_index)
+	{
+		const HSVColorThresholds thresholds= HSVColorThresholds::fromColorRange(color_ranges[range_index]);
+
+		for (int roi_index= 0; success && roi_index < k_roi_count; ++roi_index)
+		{
+			const int roi_x= rois[roi_index][0], roi_y= rois[roi_index][1];
+			const int roi_width= rois[roi_index][2], roi_height= rois[roi_index][3];
+
+			computeHSVMaskFromBayerGRBG(
+				bayer.data(), k_frame_width, k_frame_height,
+				roi_x, roi_y, roi_width, roi_height,
+				thresholds, scratch.data(), bayer_mask.data(), roi_width);
+			computeHSVMaskFromBGR(
+				bgr.data() + roi_y*k_bgr_stride + roi_x*3, k_bgr_stride, roi_width, roi_height,
+				thresholds, bgr_mask.data(), roi_width);
+
+			success= std::equal(bayer_mask.begin(), bayer_mask.begin() + roi_width*roi_height, bgr_mask.begin());
+		}
+	}
+	assert(success);
+
+	UNIT_TEST_COMPLETE()
+}
+
+static PSVRRangef make_range(float center, float range)
+{
+	PSVRRangef result= {center, range};
+	return result;
+}
+
+static std::vector<PSVR_HSVColorRange> make_test_color_ranges()
+{
+	std::vector<PSVR_HSVColorRange> color_ranges;
+	PSVR_HSVColorRange color_range;
+
+	// Magenta-ish, no wrap
+	color_range.hue_range= make_range(150.f, 10.f);
+	color_range.saturation_range= make_range(255.f, 32.f);
+	color_range.value_range= make_range(255.f, 32.f);
+	color_ranges.push_back(color_range);
+
+	// Red around 0, wraps below 0
+	color_range.hue_range= make_range(2.f, 10.f);
+	color_range.saturation_range= make_range(200.f, 55.f);
+	color_range.value_range= make_range(180.f, 75.f);
+	color_ranges.push_back(color_range);
+
+	// Red around 180, wraps above 180
+	color_range.hue_range= make_range(175.f, 12.f);
+	color_range.saturation_range= make_range(150.f, 105.f);
+	color_range.value_range= make_range(128.f, 127.f);
+	color_ranges.push_back(color_range);
+
+	// Fractional bounds land on rounding ties (x.5)
+	color_range.hue_range= make_range(60.5f, 8.f);
+	color_range.saturation_range= make_range(100.5f, 40.f);
+	color_range.value_range= make_range(90.5f, 30.f);
+	color_ranges.push_back(color_range);
+
+	// Bounds past the ends of the 8-bit range get clamped
+	color_range.hue_range= make_range(90.f, 45.f);
+	color_range.saturation_range= make_range(20.f, 60.f);
+	color_range.value_range= make_range(240.f, 40.f);
+	color_ranges.push_back(color_range);
+
+	return color_ranges;
+}
+
+static void fill_random_bytes(std::vector<uint8_t> &buffer, unsigned int seed)
+{
+	// Small LCG so the test data is the same on every platform
+	unsigned int state= seed;
+	for (uint8_t &byte : buffer)
+	{
+		state= state*1664525u + 1013904223u;
+		byte= static_cast<uint8_t>(state >> 24);
+	}
+}
+
+// OpenCV's 8-bit BGR2HSV (color_hsv.simd.hpp) with its fixed point divide tables
+static void compute_legacy_hsv_for_pixel(int b, int g, int r, int &out_h, int &out_s, int &out_v)
+{
+	const int k_hsv_shift= 12;
+	static int sdiv_table[256], hdiv_table[256];
+	static bool bTablesInitialized= false;
+
+	if (!bTablesInitialized)
+	{
+		sdiv_table[0]= hdiv_table[0]= 0;
+		for (int i= 1; i < 256; ++i)
+		{
+			sdiv_table[i]= static_cast<int>(std::lrint((255 << k_hsv_shift) / (1.0*i)));
+			hdiv_table[i]= static_cast<int>(std::lrint((180 << k_hsv_shift) / (6.0*i)));
+		}
+		bTablesInitialized= true;
+	}
+
+	const int v= std::max(b, std::max(g, r));
+	const int vmin= std::min(b, std::min(g, r));
+	const int diff= v - vmin;
+	const int vr= (v == r) ? -1 : 0;
+	const int vg= (v == g) ? -1 : 0;
+
+	int h= (vr & (g - b)) + (~vr & ((vg & (b - r + 2*diff)) + ((~vg) & (r - g + 4*diff))));
+	h= (h*hdiv_table[diff] + (1 << (k_hsv_shift - 1))) >> k_hsv_shift;
+	h+= (h < 0) ? 180 : 0;
+
+	out_h= h;
+	out_s= (diff*sdiv_table[v] + (1 << (k_hsv_shift - 1))) >> k_hsv_shift;
+	out_v= v;
+}
+
+// cv::inRange on an 8-bit image rounds the cv::Scalar bounds to the nearest integer (saturate_cast)
+static bool legacy_in_range(int x, double min_value, double max_value)
+{
+	return x >= static_cast<int>(std::lrint(min_value)) && x <= static_cast<int>(std::lrint(max_value));
+}
+
+static float legacy_clampf(float x, float min_value, float max_value)
+{
+	return std::min(std::max(x, min_value), max_value);
+}
+
+// The range test computeBiggestNContours ran on the cvtColor output before the fused kernel
+static void compute_legacy_hsv_mask(
+	const uint8_t *bgr, int pixel_count, const PSVR_HSVColorRange &hsvColorRange, uint8_t *out_mask)
+{
+	const float hue_min = hsvColorRange.hue_range.center - hsvColorRange.hue_range.range;
+	const float hue_max = hsvColorRange.hue_range.center + hsvColorRange.hue_range.range;
+	const float saturation_min = legacy_clampf(hsvColorRange.saturation_range.center - hsvColorRange.saturation_range.range, 0, 255);
+	const float saturation_max = legacy_clampf(hsvColorRange.saturation_range.center + hsvColorRange.saturation_range.range, 0, 255);
+	const float value_min = legacy_clampf(hsvColorRange.value_range.center - hsvColorRange.value_range.range, 0, 255);
+	const float value_max = legacy_clampf(hsvColorRange.value_range.center + hsvColorRange.value_range.range, 0, 255);
+
+	for (int i= 0; i < pixel_count; ++i)
+	{
+		int h, s, v;
+		compute_legacy_hsv_for_pixel(bgr[i*3 + 0], bgr[i*3 + 1], bgr[i*3 + 2], h, s, v);
+
+		const bool bSaturationValueInRange=
+			legacy_in_range(s, saturation_min, saturation_max) && legacy_in_range(v, value_min, value_max);
+		bool bHueInRange;
+
+		if (hue_min < 0)
+		{
+			bHueInRange=
+				legacy_in_range(h, 0, legacy_clampf(hue_max, 0, 180)) ||
+				legacy_in_range(h, legacy_clampf(180 + hue_min, 0, 180), 180);
+		}
+		else if (hue_max > 180)
+		{
+			bHueInRange=
+				legacy_in_range(h, 0, legacy_clampf(hue_max - 180, 0, 180)) ||
+				legacy_in_range(h, legacy_clampf(hue_min, 0, 180), 180);
+		}
+		else
+		{
+			bHueInRange= legacy_in_range(h, hue_min, hue_max);
+		}
+
+		out_mask[i]= (bSaturationValueInRange && bHueInRange) ? 0xFF : 0x00;
+	}
+}
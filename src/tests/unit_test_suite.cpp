@@ -13,6 +13,12 @@ main(int argc, char* argv[])
 		UNIT_TEST_SUITE_CALL_CPP_MODULE(run_math_alignment_unit_tests);
 		UNIT_TEST_SUITE_CALL_CPP_MODULE(run_math_eigen_unit_tests);
 		UNIT_TEST_SUITE_CALL_CPP_MODULE(run_math_utility_unit_tests);
+		UNIT_TEST_SUITE_CALL_CPP_MODULE(run_pose_filter_history_unit_tests);
+		UNIT_TEST_SUITE_CALL_CPP_MODULE(run_tracker_image_processing_unit_tests);
+		UNIT_TEST_SUITE_CALL_CPP_MODULE(run_tracker_blob_extractor_unit_tests);
+#ifndef _WIN32
+		UNIT_TEST_SUITE_CALL_CPP_MODULE(run_remote_client_unit_tests);
+#endif
 	UNIT_TEST_SUITE_END()
 
 	return success ? EXIT_SUCCESS : EXIT_FAILURE;